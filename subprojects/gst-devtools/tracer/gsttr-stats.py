@@ -11,6 +11,10 @@ python3 gsttr-stats.py trace.log
 
 3) print selected entries only
 python3 gsttr-stats.py -c latency trace.log
+
+Binary trace files are read as well:
+GST_TRACERS="stats;rusage;latency" GST_TRACER_BINARY_FILE=trace.bin <application>
+python3 gsttr-stats.py trace.bin
 '''
 # TODO:
 # more options
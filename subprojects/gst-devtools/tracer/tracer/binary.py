@@ -0,0 +1,214 @@
+import mmap
+import struct
+import sys
+
+# Reader for the binary trace files written when GST_TRACER_BINARY_FILE is
+# set, see gst/gsttracerrecord.c for the layout.
+
+MAGIC = b'GSTTRBIN'
+VERSION = 2
+
+KIND_INT32 = 1
+KIND_UINT32 = 2
+KIND_INT64 = 3
+KIND_UINT64 = 4
+KIND_DOUBLE = 5
+KIND_POINTER = 6
+KIND_STRING = 7
+
+_KIND_FORMATS = {
+    KIND_INT32: ('i', 4),
+    KIND_UINT32: ('I', 4),
+    KIND_INT64: ('q', 8),
+    KIND_UINT64: ('Q', 8),
+    KIND_DOUBLE: ('d', 8),
+    KIND_POINTER: ('Q', 8),
+}
+
+BLOCK_HEADER_SIZE = 8
+RECORD_HEADER_SIZE = 32
+
+
+def is_binary_log(filename):
+    with open(filename, 'rb') as f:
+        return f.read(len(MAGIC)) == MAGIC
+
+
+def _format_time(ts):
+    return '%u:%02u:%02u.%09u' % (ts // (3600 * 10**9),
+                                  (ts // (60 * 10**9)) % 60,
+                                  (ts // 10**9) % 60, ts % 10**9)
+
+
+def _format_value(kind, value):
+    if kind == KIND_DOUBLE:
+        return '%f' % value
+    if kind == KIND_POINTER:
+        return '0x%x' % value
+    return str(value)
+
+
+def _read_cstring(data, pos):
+    end = data.find(b'\0', pos)
+    return data[pos:end].decode('utf-8', 'replace'), end + 1
+
+
+class Schema(object):
+    """
+    Description of the fields of one tracer record.
+    """
+
+    def __init__(self, id, ts, name, desc, fields):
+        self.id = id
+        self.ts = ts
+        self.name = name
+        self.desc = desc
+        # list of (kind, name, type name)
+        self.fields = fields
+
+
+class BinaryLog(object):
+    """
+    Iterates a binary trace file.
+
+    Produces the same event lists as Parser does for a text log: first one
+    class event per record schema, then the entries in the order they were
+    written.
+    """
+
+    def __init__(self, filename):
+        self.filename = filename
+        with open(filename, 'rb') as f:
+            self.data = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        self._parse_header()
+        self._parse_schemas()
+        self.events = self._events()
+
+    def close(self):
+        self.data.close()
+
+    def __iter__(self):
+        return self
+
+    def __next__(self):
+        return next(self.events)
+
+    def _parse_header(self):
+        data = self.data
+        if data[:8] != MAGIC:
+            raise ValueError('%s is not a binary trace file' % self.filename)
+        if struct.unpack_from('<I', data, 12)[0] == 0x01020304:
+            self.bo = '<'
+        else:
+            self.bo = '>'
+        (version, _, self.header_size, self.schema_area_size,
+         self.block_size, self.n_blocks, self.pid, self.schema_used,
+         self.dropped) = struct.unpack_from(self.bo + 'IIIIIIQII', data, 8)
+        if version != VERSION:
+            raise ValueError('unsupported binary trace version %d' % version)
+
+    def _parse_schemas(self):
+        data = self.data
+        self.schemas = {}
+        pos = self.header_size
+        end = self.header_size + self.schema_used
+        while pos < end:
+            size, id, n_fields, ts = struct.unpack_from(self.bo + 'IHHQ', data,
+                                                        pos)
+            p = pos + 16
+            name, p = _read_cstring(data, p)
+            desc, p = _read_cstring(data, p)
+            fields = []
+            for i in range(n_fields):
+                kind = data[p]
+                fname, p = _read_cstring(data, p + 1)
+                tname, p = _read_cstring(data, p)
+                fields.append((kind, fname, tname))
+            self.schemas[id] = Schema(id, ts, name, desc, fields)
+            pos += size
+
+    def _blocks(self):
+        """
+        Returns (seq, offset) of the used blocks, oldest first.
+        """
+        ring = self.header_size + self.schema_area_size
+        blocks = []
+        for i in range(self.n_blocks):
+            offset = ring + i * self.block_size
+            seq = struct.unpack_from(self.bo + 'Q', self.data, offset)[0]
+            if seq:
+                blocks.append((seq, offset))
+        blocks.sort()
+        return blocks
+
+    def _decode_record(self, schema, pos, end):
+        data = self.data
+        bo = self.bo
+        values = []
+        for kind, fname, tname in schema.fields:
+            if kind == KIND_STRING:
+                length = struct.unpack_from(bo + 'I', data, pos)[0]
+                pos += 4
+                if pos + length > end:
+                    return None
+                value = data[pos:pos + length].decode('utf-8', 'replace')
+                pos += length
+            else:
+                fmt, size = _KIND_FORMATS[kind]
+                if pos + size > end:
+                    return None
+                value = struct.unpack_from(bo + fmt, data, pos)[0]
+                pos += size
+            values.append('%s=(%s)%s' % (fname, tname,
+                                         _format_value(kind, value)))
+        return '%s, %s;' % (schema.name, ', '.join(values))
+
+    def _events(self):
+        pid = self.pid
+        for schema in sorted(self.schemas.values(), key=lambda s: s.ts):
+            yield [_format_time(schema.ts), pid, '0x0', 'TRACE', 'GST_TRACER',
+                   'gsttracerrecord.c', 0, 'gst_tracer_record_build_format',
+                   None, schema.desc]
+
+        data = self.data
+        bo = self.bo
+        for seq, offset in self._blocks():
+            pos = offset + BLOCK_HEADER_SIZE
+            end = offset + self.block_size
+            while pos + RECORD_HEADER_SIZE <= end:
+                size, id, _, rseq, ts, thread = struct.unpack_from(
+                    bo + 'IHHQQQ', data, pos)
+                # the rest of the block is unused, stale or being written
+                if (size < RECORD_HEADER_SIZE or pos + size > end
+                        or rseq != seq or id not in self.schemas):
+                    break
+                message = self._decode_record(self.schemas[id],
+                                              pos + RECORD_HEADER_SIZE,
+                                              pos + size)
+                if message is None:
+                    break
+                yield [_format_time(ts), pid, '0x%x' % thread, 'TRACE',
+                       'GST_TRACER', '', 0, '', None, message]
+                pos += size
+
+
+def main():
+    """
+    Converts a binary trace file to a text log.
+    """
+    import argparse
+    parser = argparse.ArgumentParser()
+    parser.add_argument('file', help='binary trace file')
+    args = parser.parse_args()
+
+    log = BinaryLog(args.file)
+    for event in log:
+        sys.stdout.write('%s %5d %14s %s %20s %s:%d:%s:%s %s\n' % (
+            event[0], event[1], event[2], event[3], event[4], event[5],
+            event[6], event[7], '' if event[8] is None else '<%s>' % event[8],
+            event[9]))
+    log.close()
+
+
+if __name__ == '__main__':
+    main()
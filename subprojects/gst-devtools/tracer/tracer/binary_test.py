@@ -0,0 +1,123 @@
+import os
+import struct
+import tempfile
+import unittest
+
+from tracer.binary import BinaryLog, KIND_STRING, KIND_UINT32, KIND_UINT64
+from tracer.parser import Parser
+from tracer.structure import Structure
+
+HEADER_SIZE = 4096
+SCHEMA_AREA_SIZE = 1024
+BLOCK_SIZE = 256
+N_BLOCKS = 3
+
+CLASS_DESC = 'test.class, value=(structure)"value\\,\\ type\\=\\(type\\)guint\\;";'
+
+
+def _cstring(s):
+    return s.encode('utf-8') + b'\0'
+
+
+def _schema():
+    body = _cstring('test') + _cstring(CLASS_DESC)
+    for kind, name, tname in ((KIND_STRING, 'name', 'string'),
+                              (KIND_UINT32, 'value', 'uint'),
+                              (KIND_UINT64, 'ts', 'guint64')):
+        body += bytes([kind]) + _cstring(name) + _cstring(tname)
+    size = (16 + len(body) + 7) & ~7
+    data = struct.pack('<IHHQ', size, 1, 3, 1000) + body
+    return data + b'\0' * (size - len(data))
+
+
+def _record(seq, ts, name, value, field_ts):
+    body = struct.pack('<I', len(name)) + name.encode('utf-8')
+    body += struct.pack('<IQ', value, field_ts)
+    size = (32 + len(body) + 7) & ~7
+    data = struct.pack('<IHHQQQ', size, 1, 0, seq, ts, 0x1234)
+    data += body
+    return data + b'\0' * (size - len(data))
+
+
+def _block(seq, records):
+    data = struct.pack('<Q', seq) + b''.join(records)
+    return data + b'\0' * (BLOCK_SIZE - len(data))
+
+
+def _write_file(blocks, dropped=0):
+    schema = _schema()
+    header = struct.pack('<8sIIIIIIQII', b'GSTTRBIN', 2, 0x01020304,
+                         HEADER_SIZE, SCHEMA_AREA_SIZE, BLOCK_SIZE, N_BLOCKS,
+                         42, len(schema), dropped)
+    data = header + b'\0' * (HEADER_SIZE - len(header))
+    data += schema + b'\0' * (SCHEMA_AREA_SIZE - len(schema))
+    for block in blocks:
+        data += block
+    f = tempfile.NamedTemporaryFile(suffix='.bin', delete=False)
+    f.write(data)
+    f.close()
+    return f.name
+
+
+class TestBinaryLog(unittest.TestCase):
+
+    def setUp(self):
+        # the ring wrapped, the block with sequence number 5 still has a
+        # record from the earlier round, when it was the 2nd block
+        blocks = [
+            _block(4, [_record(4, 4000, 'd', 4, 40)]),
+            _block(5, [_record(5, 5000, 'e', 5, 50),
+                       _record(5 - N_BLOCKS, 2000, 'b', 2, 20)]),
+            _block(3, [_record(3, 3000, 'c', 3, 30)]),
+        ]
+        self.filename = _write_file(blocks)
+
+    def tearDown(self):
+        os.unlink(self.filename)
+
+    def test_class_comes_first(self):
+        log = BinaryLog(self.filename)
+        event = next(log)
+        log.close()
+        self.assertEqual(event[Parser.F_FILENAME], 'gsttracerrecord.c')
+        self.assertEqual(event[Parser.F_MESSAGE], CLASS_DESC)
+        self.assertEqual(Structure(event[Parser.F_MESSAGE]).name, 'test.class')
+
+    def test_records_in_order(self):
+        with Parser(self.filename) as log:
+            events = list(log)
+        self.assertEqual(len(events), 4)
+        names = [Structure(e[Parser.F_MESSAGE]).values['name']
+                 for e in events[1:]]
+        self.assertEqual(names, ['c', 'd', 'e'])
+
+    def test_record_values(self):
+        with Parser(self.filename) as log:
+            events = list(log)
+        event = events[1]
+        self.assertEqual(event[Parser.F_TIME], '0:00:00.000003000')
+        self.assertEqual(event[Parser.F_PID], 42)
+        self.assertEqual(event[Parser.F_THREAD], '0x1234')
+        self.assertEqual(event[Parser.F_LINE], 0)
+        s = Structure(event[Parser.F_MESSAGE])
+        self.assertEqual(s.name, 'test')
+        self.assertEqual(s.values['value'], 3)
+        self.assertEqual(s.values['ts'], '30')
+
+    def test_stale_record_same_low_bits(self):
+        # a record from 0x10000 blocks earlier is still stale
+        blocks = [
+            _block(0x10003, [_record(0x10003, 9000, 'x', 9, 90),
+                             _record(3, 3000, 'c', 3, 30)]),
+            _block(0x10001, [_record(0x10001, 7000, 'v', 7, 70)]),
+            _block(0x10002, [_record(0x10002, 8000, 'w', 8, 80)]),
+        ]
+        filename = _write_file(blocks, dropped=7)
+        log = BinaryLog(filename)
+        events = list(log)
+        self.assertEqual(log.dropped, 7)
+        log.close()
+        os.unlink(filename)
+        names = [Structure(e[Parser.F_MESSAGE]).values['name']
+                 for e in events[1:]]
+        self.assertEqual(names, ['v', 'w', 'x'])
@@ -2,6 +2,11 @@ import os
 import re
 import sys
 
+try:
+    from tracer.binary import BinaryLog, is_binary_log
+except BaseException:
+    from binary import BinaryLog, is_binary_log
+
 
 def _log_line_regex():
 
@@ -34,7 +39,8 @@ class Parser(object):
     """
     Helper to parse a tracer log.
 
-    Implements context manager and iterator.
+    Implements context manager and iterator. Binary trace files, as written
+    with GST_TRACER_BINARY_FILE, are read as well.
     """
 
     # record fields
@@ -55,10 +61,12 @@ class Parser(object):
         self.file = None
 
     def __enter__(self):
-        if self.filename != '-':
-            self.file = open(self.filename, 'rt')
-        else:
+        if self.filename == '-':
             self.file = sys.stdin
+        elif is_binary_log(self.filename):
+            self.file = BinaryLog(self.filename)
+        else:
+            self.file = open(self.filename, 'rt')
         return self
 
     def __exit__(self, *args):
@@ -72,6 +80,8 @@ class Parser(object):
     def __next__(self):
         log_regex = self.log_regex
         data = self.file
+        if isinstance(data, BinaryLog):
+            return next(data)
         while True:
             line = next(data)
             match = log_regex.match(line)
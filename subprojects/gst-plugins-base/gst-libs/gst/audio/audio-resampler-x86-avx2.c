@@ -0,0 +1,717 @@
+/* GStreamer
+ * Copyright (C) 2022 GStreamer developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "audio-resampler-x86-avx2.h"
+
+#if defined (HAVE_IMMINTRIN_H) && defined (__AVX2__) && defined (__FMA__)
+#include <immintrin.h>
+
+/* The filter length is a multiple of 8 for all the sinc based methods, the
+ * loops below handle 16 samples per iteration where that fits and finish
+ * with a half-width step so that we never read taps beyond the next multiple
+ * of 8, like the SSE versions. */
+
+static inline __m128
+hsum_ps_256 (__m256 v)
+{
+  __m128 s;
+
+  s = _mm_add_ps (_mm256_castps256_ps128 (v), _mm256_extractf128_ps (v, 1));
+  s = _mm_add_ps (s, _mm_movehl_ps (s, s));
+  return _mm_add_ss (s, _mm_shuffle_ps (s, s, 0x55));
+}
+
+static inline __m128d
+hsum_pd_256 (__m256d v)
+{
+  __m128d s;
+
+  s = _mm_add_pd (_mm256_castpd256_pd128 (v), _mm256_extractf128_pd (v, 1));
+  return _mm_add_sd (s, _mm_unpackhi_pd (s, s));
+}
+
+static inline __m128i
+fold_epi32_256 (__m256i v)
+{
+  return _mm_add_epi32 (_mm256_castsi256_si128 (v),
+      _mm256_extracti128_si256 (v, 1));
+}
+
+static inline __m128i
+fold_epi64_256 (__m256i v)
+{
+  return _mm_add_epi64 (_mm256_castsi256_si128 (v),
+      _mm256_extracti128_si256 (v, 1));
+}
+
+static inline void
+inner_product_gfloat_full_1_avx2 (gfloat * o, const gfloat * a,
+    const gfloat * b, gint len, const gfloat * icoeff, gint bstride)
+{
+  gint i = 0;
+  __m256 sum[2];
+
+  sum[0] = sum[1] = _mm256_setzero_ps ();
+
+  for (; i + 16 <= len; i += 16) {
+    sum[0] = _mm256_fmadd_ps (_mm256_loadu_ps (a + i + 0),
+        _mm256_load_ps (b + i + 0), sum[0]);
+    sum[1] = _mm256_fmadd_ps (_mm256_loadu_ps (a + i + 8),
+        _mm256_load_ps (b + i + 8), sum[1]);
+  }
+  if (i < len)
+    sum[0] = _mm256_fmadd_ps (_mm256_loadu_ps (a + i),
+        _mm256_load_ps (b + i), sum[0]);
+
+  _mm_store_ss (o, hsum_ps_256 (_mm256_add_ps (sum[0], sum[1])));
+}
+
+static inline void
+inner_product_gfloat_linear_1_avx2 (gfloat * o, const gfloat * a,
+    const gfloat * b, gint len, const gfloat * icoeff, gint bstride)
+{
+  gint i = 0;
+  __m256 sum[2], t;
+  const gfloat *c[2] = { (gfloat *) ((gint8 *) b + 0 * bstride),
+    (gfloat *) ((gint8 *) b + 1 * bstride)
+  };
+
+  sum[0] = sum[1] = _mm256_setzero_ps ();
+
+  for (; i < len; i += 8) {
+    t = _mm256_loadu_ps (a + i);
+    sum[0] = _mm256_fmadd_ps (t, _mm256_load_ps (c[0] + i), sum[0]);
+    sum[1] = _mm256_fmadd_ps (t, _mm256_load_ps (c[1] + i), sum[1]);
+  }
+  sum[0] = _mm256_fmadd_ps (_mm256_sub_ps (sum[0], sum[1]),
+      _mm256_broadcast_ss (icoeff), sum[1]);
+
+  _mm_store_ss (o, hsum_ps_256 (sum[0]));
+}
+
+static inline void
+inner_product_gfloat_cubic_1_avx2 (gfloat * o, const gfloat * a,
+    const gfloat * b, gint len, const gfloat * icoeff, gint bstride)
+{
+  gint i = 0;
+  __m256 sum[4], t;
+  const gfloat *c[4] = { (gfloat *) ((gint8 *) b + 0 * bstride),
+    (gfloat *) ((gint8 *) b + 1 * bstride),
+    (gfloat *) ((gint8 *) b + 2 * bstride),
+    (gfloat *) ((gint8 *) b + 3 * bstride)
+  };
+
+  sum[0] = sum[1] = sum[2] = sum[3] = _mm256_setzero_ps ();
+
+  for (; i < len; i += 8) {
+    t = _mm256_loadu_ps (a + i);
+    sum[0] = _mm256_fmadd_ps (t, _mm256_load_ps (c[0] + i), sum[0]);
+    sum[1] = _mm256_fmadd_ps (t, _mm256_load_ps (c[1] + i), sum[1]);
+    sum[2] = _mm256_fmadd_ps (t, _mm256_load_ps (c[2] + i), sum[2]);
+    sum[3] = _mm256_fmadd_ps (t, _mm256_load_ps (c[3] + i), sum[3]);
+  }
+  sum[0] = _mm256_mul_ps (sum[0], _mm256_broadcast_ss (icoeff + 0));
+  sum[0] = _mm256_fmadd_ps (sum[1], _mm256_broadcast_ss (icoeff + 1), sum[0]);
+  sum[0] = _mm256_fmadd_ps (sum[2], _mm256_broadcast_ss (icoeff + 2), sum[0]);
+  sum[0] = _mm256_fmadd_ps (sum[3], _mm256_broadcast_ss (icoeff + 3), sum[0]);
+
+  _mm_store_ss (o, hsum_ps_256 (sum[0]));
+}
+
+static inline void
+inner_product_gdouble_full_1_avx2 (gdouble * o, const gdouble * a,
+    const gdouble * b, gint len, const gdouble * icoeff, gint bstride)
+{
+  gint i = 0;
+  __m256d sum[2];
+
+  sum[0] = sum[1] = _mm256_setzero_pd ();
+
+  for (; i < len; i += 8) {
+    sum[0] = _mm256_fmadd_pd (_mm256_loadu_pd (a + i + 0),
+        _mm256_load_pd (b + i + 0), sum[0]);
+    sum[1] = _mm256_fmadd_pd (_mm256_loadu_pd (a + i + 4),
+        _mm256_load_pd (b + i + 4), sum[1]);
+  }
+  _mm_store_sd (o, hsum_pd_256 (_mm256_add_pd (sum[0], sum[1])));
+}
+
+static inline void
+inner_product_gdouble_linear_1_avx2 (gdouble * o, const gdouble * a,
+    const gdouble * b, gint len, const gdouble * icoeff, gint bstride)
+{
+  gint i = 0;
+  __m256d sum[2], t;
+  const gdouble *c[2] = { (gdouble *) ((gint8 *) b + 0 * bstride),
+    (gdouble *) ((gint8 *) b + 1 * bstride)
+  };
+
+  sum[0] = sum[1] = _mm256_setzero_pd ();
+
+  for (; i < len; i += 4) {
+    t = _mm256_loadu_pd (a + i);
+    sum[0] = _mm256_fmadd_pd (t, _mm256_load_pd (c[0] + i), sum[0]);
+    sum[1] = _mm256_fmadd_pd (t, _mm256_load_pd (c[1] + i), sum[1]);
+  }
+  sum[0] = _mm256_fmadd_pd (_mm256_sub_pd (sum[0], sum[1]),
+      _mm256_broadcast_sd (icoeff), sum[1]);
+
+  _mm_store_sd (o, hsum_pd_256 (sum[0]));
+}
+
+static inline void
+inner_product_gdouble_cubic_1_avx2 (gdouble * o, const gdouble * a,
+    const gdouble * b, gint len, const gdouble * icoeff, gint bstride)
+{
+  gint i = 0;
+  __m256d sum[4], t;
+  const gdouble *c[4] = { (gdouble *) ((gint8 *) b + 0 * bstride),
+    (gdouble *) ((gint8 *) b + 1 * bstride),
+    (gdouble *) ((gint8 *) b + 2 * bstride),
+    (gdouble *) ((gint8 *) b + 3 * bstride)
+  };
+
+  sum[0] = sum[1] = sum[2] = sum[3] = _mm256_setzero_pd ();
+
+  for (; i < len; i += 4) {
+    t = _mm256_loadu_pd (a + i);
+    sum[0] = _mm256_fmadd_pd (t, _mm256_load_pd (c[0] + i), sum[0]);
+    sum[1] = _mm256_fmadd_pd (t, _mm256_load_pd (c[1] + i), sum[1]);
+    sum[2] = _mm256_fmadd_pd (t, _mm256_load_pd (c[2] + i), sum[2]);
+    sum[3] = _mm256_fmadd_pd (t, _mm256_load_pd (c[3] + i), sum[3]);
+  }
+  sum[0] = _mm256_mul_pd (sum[0], _mm256_broadcast_sd (icoeff + 0));
+  sum[0] = _mm256_fmadd_pd (sum[1], _mm256_broadcast_sd (icoeff + 1), sum[0]);
+  sum[0] = _mm256_fmadd_pd (sum[2], _mm256_broadcast_sd (icoeff + 2), sum[0]);
+  sum[0] = _mm256_fmadd_pd (sum[3], _mm256_broadcast_sd (icoeff + 3), sum[0]);
+
+  _mm_store_sd (o, hsum_pd_256 (sum[0]));
+}
+
+static inline void
+inner_product_gint16_full_1_avx2 (gint16 * o, const gint16 * a,
+    const gint16 * b, gint len, const gint16 * icoeff, gint bstride)
+{
+  gint i = 0;
+  __m256i sum256;
+  __m128i sum;
+
+  sum256 = _mm256_setzero_si256 ();
+  sum = _mm_setzero_si128 ();
+
+  for (; i + 16 <= len; i += 16) {
+    sum256 =
+        _mm256_add_epi32 (sum256,
+        _mm256_madd_epi16 (_mm256_loadu_si256 ((__m256i *) (a + i)),
+            _mm256_load_si256 ((__m256i *) (b + i))));
+  }
+  if (i < len) {
+    sum =
+        _mm_madd_epi16 (_mm_loadu_si128 ((__m128i *) (a + i)),
+        _mm_load_si128 ((__m128i *) (b + i)));
+  }
+  sum = _mm_add_epi32 (sum, fold_epi32_256 (sum256));
+  sum = _mm_add_epi32 (sum, _mm_shuffle_epi32 (sum, _MM_SHUFFLE (2, 3, 2, 3)));
+  sum = _mm_add_epi32 (sum, _mm_shuffle_epi32 (sum, _MM_SHUFFLE (1, 1, 1, 1)));
+
+  sum = _mm_add_epi32 (sum, _mm_set1_epi32 (1 << (PRECISION_S16 - 1)));
+  sum = _mm_srai_epi32 (sum, PRECISION_S16);
+  sum = _mm_packs_epi32 (sum, sum);
+  *o = _mm_extract_epi16 (sum, 0);
+}
+
+static inline void
+inner_product_gint16_linear_1_avx2 (gint16 * o, const gint16 * a,
+    const gint16 * b, gint len, const gint16 * icoeff, gint bstride)
+{
+  gint i = 0;
+  __m256i acc[2], t256;
+  __m128i sum[2], t;
+  __m128i f = _mm_set_epi64x (0, *((gint64 *) icoeff));
+  const gint16 *c[2] = { (gint16 *) ((gint8 *) b + 0 * bstride),
+    (gint16 *) ((gint8 *) b + 1 * bstride)
+  };
+
+  acc[0] = acc[1] = _mm256_setzero_si256 ();
+  sum[0] = sum[1] = _mm_setzero_si128 ();
+  f = _mm_unpacklo_epi16 (f, sum[0]);
+
+  for (; i + 16 <= len; i += 16) {
+    t256 = _mm256_loadu_si256 ((__m256i *) (a + i));
+    acc[0] =
+        _mm256_add_epi32 (acc[0], _mm256_madd_epi16 (t256,
+            _mm256_load_si256 ((__m256i *) (c[0] + i))));
+    acc[1] =
+        _mm256_add_epi32 (acc[1], _mm256_madd_epi16 (t256,
+            _mm256_load_si256 ((__m256i *) (c[1] + i))));
+  }
+  if (i < len) {
+    t = _mm_loadu_si128 ((__m128i *) (a + i));
+    sum[0] = _mm_madd_epi16 (t, _mm_load_si128 ((__m128i *) (c[0] + i)));
+    sum[1] = _mm_madd_epi16 (t, _mm_load_si128 ((__m128i *) (c[1] + i)));
+  }
+  sum[0] = _mm_add_epi32 (sum[0], fold_epi32_256 (acc[0]));
+  sum[1] = _mm_add_epi32 (sum[1], fold_epi32_256 (acc[1]));
+
+  sum[0] = _mm_srai_epi32 (sum[0], PRECISION_S16);
+  sum[1] = _mm_srai_epi32 (sum[1], PRECISION_S16);
+
+  sum[0] =
+      _mm_madd_epi16 (sum[0], _mm_shuffle_epi32 (f, _MM_SHUFFLE (0, 0, 0, 0)));
+  sum[1] =
+      _mm_madd_epi16 (sum[1], _mm_shuffle_epi32 (f, _MM_SHUFFLE (1, 1, 1, 1)));
+  sum[0] = _mm_add_epi32 (sum[0], sum[1]);
+
+  sum[0] =
+      _mm_add_epi32 (sum[0], _mm_shuffle_epi32 (sum[0], _MM_SHUFFLE (2, 3, 2,
+              3)));
+  sum[0] =
+      _mm_add_epi32 (sum[0], _mm_shuffle_epi32 (sum[0], _MM_SHUFFLE (1, 1, 1,
+              1)));
+
+  sum[0] = _mm_add_epi32 (sum[0], _mm_set1_epi32 (1 << (PRECISION_S16 - 1)));
+  sum[0] = _mm_srai_epi32 (sum[0], PRECISION_S16);
+  sum[0] = _mm_packs_epi32 (sum[0], sum[0]);
+  *o = _mm_extract_epi16 (sum[0], 0);
+}
+
+static inline void
+inner_product_gint16_cubic_1_avx2 (gint16 * o, const gint16 * a,
+    const gint16 * b, gint len, const gint16 * icoeff, gint bstride)
+{
+  gint i = 0;
+  __m256i acc[4], t256;
+  __m128i sum[4], t[4];
+  __m128i f = _mm_set_epi64x (0, *((long long *) icoeff));
+  const gint16 *c[4] = { (gint16 *) ((gint8 *) b + 0 * bstride),
+    (gint16 *) ((gint8 *) b + 1 * bstride),
+    (gint16 *) ((gint8 *) b + 2 * bstride),
+    (gint16 *) ((gint8 *) b + 3 * bstride)
+  };
+
+  acc[0] = acc[1] = acc[2] = acc[3] = _mm256_setzero_si256 ();
+  sum[0] = sum[1] = sum[2] = sum[3] = _mm_setzero_si128 ();
+  f = _mm_unpacklo_epi16 (f, sum[0]);
+
+  for (; i + 16 <= len; i += 16) {
+    t256 = _mm256_loadu_si256 ((__m256i *) (a + i));
+    acc[0] =
+        _mm256_add_epi32 (acc[0], _mm256_madd_epi16 (t256,
+            _mm256_load_si256 ((__m256i *) (c[0] + i))));
+    acc[1] =
+        _mm256_add_epi32 (acc[1], _mm256_madd_epi16 (t256,
+            _mm256_load_si256 ((__m256i *) (c[1] + i))));
+    acc[2] =
+        _mm256_add_epi32 (acc[2], _mm256_madd_epi16 (t256,
+            _mm256_load_si256 ((__m256i *) (c[2] + i))));
+    acc[3] =
+        _mm256_add_epi32 (acc[3], _mm256_madd_epi16 (t256,
+            _mm256_load_si256 ((__m256i *) (c[3] + i))));
+  }
+  if (i < len) {
+    t[0] = _mm_loadu_si128 ((__m128i *) (a + i));
+    sum[0] = _mm_madd_epi16 (t[0], _mm_load_si128 ((__m128i *) (c[0] + i)));
+    sum[1] = _mm_madd_epi16 (t[0], _mm_load_si128 ((__m128i *) (c[1] + i)));
+    sum[2] = _mm_madd_epi16 (t[0], _mm_load_si128 ((__m128i *) (c[2] + i)));
+    sum[3] = _mm_madd_epi16 (t[0], _mm_load_si128 ((__m128i *) (c[3] + i)));
+  }
+  sum[0] = _mm_add_epi32 (sum[0], fold_epi32_256 (acc[0]));
+  sum[1] = _mm_add_epi32 (sum[1], fold_epi32_256 (acc[1]));
+  sum[2] = _mm_add_epi32 (sum[2], fold_epi32_256 (acc[2]));
+  sum[3] = _mm_add_epi32 (sum[3], fold_epi32_256 (acc[3]));
+
+  t[0] = _mm_unpacklo_epi32 (sum[0], sum[1]);
+  t[1] = _mm_unpacklo_epi32 (sum[2], sum[3]);
+  t[2] = _mm_unpackhi_epi32 (sum[0], sum[1]);
+  t[3] = _mm_unpackhi_epi32 (sum[2], sum[3]);
+
+  sum[0] =
+      _mm_add_epi32 (_mm_unpacklo_epi64 (t[0], t[1]), _mm_unpackhi_epi64 (t[0],
+          t[1]));
+  sum[2] =
+      _mm_add_epi32 (_mm_unpacklo_epi64 (t[2], t[3]), _mm_unpackhi_epi64 (t[2],
+          t[3]));
+  sum[0] = _mm_add_epi32 (sum[0], sum[2]);
+
+  sum[0] = _mm_srai_epi32 (sum[0], PRECISION_S16);
+  sum[0] = _mm_madd_epi16 (sum[0], f);
+
+  sum[0] =
+      _mm_add_epi32 (sum[0], _mm_shuffle_epi32 (sum[0], _MM_SHUFFLE (2, 3, 2,
+              3)));
+  sum[0] =
+      _mm_add_epi32 (sum[0], _mm_shuffle_epi32 (sum[0], _MM_SHUFFLE (1, 1, 1,
+              1)));
+
+  sum[0] = _mm_add_epi32 (sum[0], _mm_set1_epi32 (1 << (PRECISION_S16 - 1)));
+  sum[0] = _mm_srai_epi32 (sum[0], PRECISION_S16);
+  sum[0] = _mm_packs_epi32 (sum[0], sum[0]);
+  *o = _mm_extract_epi16 (sum[0], 0);
+}
+
+#if defined (__x86_64__)
+/* multiply the even and odd 32 bits samples and accumulate in 64 bits */
+static inline __m256i
+madd_epi32_256 (__m256i sum, __m256i a, __m256i b)
+{
+  sum = _mm256_add_epi64 (sum, _mm256_mul_epi32 (_mm256_unpacklo_epi32 (a, a),
+          _mm256_unpacklo_epi32 (b, b)));
+  return _mm256_add_epi64 (sum, _mm256_mul_epi32 (_mm256_unpackhi_epi32 (a, a),
+          _mm256_unpackhi_epi32 (b, b)));
+}
+
+static inline void
+inner_product_gint32_full_1_avx2 (gint32 * o, const gint32 * a,
+    const gint32 * b, gint len, const gint32 * icoeff, gint bstride)
+{
+  gint i = 0;
+  __m256i sum;
+  __m128i res128;
+  gint64 res;
+
+  sum = _mm256_setzero_si256 ();
+
+  for (; i < len; i += 8) {
+    sum = madd_epi32_256 (sum, _mm256_loadu_si256 ((__m256i *) (a + i)),
+        _mm256_load_si256 ((__m256i *) (b + i)));
+  }
+  res128 = fold_epi64_256 (sum);
+  res128 = _mm_add_epi64 (res128, _mm_unpackhi_epi64 (res128, res128));
+  res = _mm_cvtsi128_si64 (res128);
+
+  res = (res + (1 << (PRECISION_S32 - 1))) >> PRECISION_S32;
+  *o = CLAMP (res, G_MININT32, G_MAXINT32);
+}
+
+static inline void
+inner_product_gint32_linear_1_avx2 (gint32 * o, const gint32 * a,
+    const gint32 * b, gint len, const gint32 * icoeff, gint bstride)
+{
+  gint i = 0;
+  gint64 res;
+  __m256i acc[2], ta;
+  __m128i sum[2];
+  __m128i f = _mm_loadu_si128 ((__m128i *) icoeff);
+  const gint32 *c[2] = { (gint32 *) ((gint8 *) b + 0 * bstride),
+    (gint32 *) ((gint8 *) b + 1 * bstride)
+  };
+
+  acc[0] = acc[1] = _mm256_setzero_si256 ();
+
+  for (; i < len; i += 8) {
+    ta = _mm256_loadu_si256 ((__m256i *) (a + i));
+    acc[0] = madd_epi32_256 (acc[0], ta,
+        _mm256_load_si256 ((__m256i *) (c[0] + i)));
+    acc[1] = madd_epi32_256 (acc[1], ta,
+        _mm256_load_si256 ((__m256i *) (c[1] + i)));
+  }
+  sum[0] = _mm_srli_epi64 (fold_epi64_256 (acc[0]), PRECISION_S32);
+  sum[1] = _mm_srli_epi64 (fold_epi64_256 (acc[1]), PRECISION_S32);
+  sum[0] =
+      _mm_mul_epi32 (sum[0], _mm_shuffle_epi32 (f, _MM_SHUFFLE (0, 0, 0, 0)));
+  sum[1] =
+      _mm_mul_epi32 (sum[1], _mm_shuffle_epi32 (f, _MM_SHUFFLE (1, 1, 1, 1)));
+  sum[0] = _mm_add_epi64 (sum[0], sum[1]);
+  sum[0] = _mm_add_epi64 (sum[0], _mm_unpackhi_epi64 (sum[0], sum[0]));
+  res = _mm_cvtsi128_si64 (sum[0]);
+
+  res = (res + (1 << (PRECISION_S32 - 1))) >> PRECISION_S32;
+  *o = CLAMP (res, G_MININT32, G_MAXINT32);
+}
+
+static inline void
+inner_product_gint32_cubic_1_avx2 (gint32 * o, const gint32 * a,
+    const gint32 * b, gint len, const gint32 * icoeff, gint bstride)
+{
+  gint i = 0;
+  gint64 res;
+  __m256i acc[4], ta;
+  __m128i sum[4];
+  __m128i f = _mm_loadu_si128 ((__m128i *) icoeff);
+  const gint32 *c[4] = { (gint32 *) ((gint8 *) b + 0 * bstride),
+    (gint32 *) ((gint8 *) b + 1 * bstride),
+    (gint32 *) ((gint8 *) b + 2 * bstride),
+    (gint32 *) ((gint8 *) b + 3 * bstride)
+  };
+
+  acc[0] = acc[1] = acc[2] = acc[3] = _mm256_setzero_si256 ();
+
+  for (; i < len; i += 8) {
+    ta = _mm256_loadu_si256 ((__m256i *) (a + i));
+    acc[0] = madd_epi32_256 (acc[0], ta,
+        _mm256_load_si256 ((__m256i *) (c[0] + i)));
+    acc[1] = madd_epi32_256 (acc[1], ta,
+        _mm256_load_si256 ((__m256i *) (c[1] + i)));
+    acc[2] = madd_epi32_256 (acc[2], ta,
+        _mm256_load_si256 ((__m256i *) (c[2] + i)));
+    acc[3] = madd_epi32_256 (acc[3], ta,
+        _mm256_load_si256 ((__m256i *) (c[3] + i)));
+  }
+  sum[0] = _mm_srli_epi64 (fold_epi64_256 (acc[0]), PRECISION_S32);
+  sum[1] = _mm_srli_epi64 (fold_epi64_256 (acc[1]), PRECISION_S32);
+  sum[2] = _mm_srli_epi64 (fold_epi64_256 (acc[2]), PRECISION_S32);
+  sum[3] = _mm_srli_epi64 (fold_epi64_256 (acc[3]), PRECISION_S32);
+  sum[0] =
+      _mm_mul_epi32 (sum[0], _mm_shuffle_epi32 (f, _MM_SHUFFLE (0, 0, 0, 0)));
+  sum[1] =
+      _mm_mul_epi32 (sum[1], _mm_shuffle_epi32 (f, _MM_SHUFFLE (1, 1, 1, 1)));
+  sum[2] =
+      _mm_mul_epi32 (sum[2], _mm_shuffle_epi32 (f, _MM_SHUFFLE (2, 2, 2, 2)));
+  sum[3] =
+      _mm_mul_epi32 (sum[3], _mm_shuffle_epi32 (f, _MM_SHUFFLE (3, 3, 3, 3)));
+  sum[0] = _mm_add_epi64 (sum[0], sum[1]);
+  sum[2] = _mm_add_epi64 (sum[2], sum[3]);
+  sum[0] = _mm_add_epi64 (sum[0], sum[2]);
+  sum[0] = _mm_add_epi64 (sum[0], _mm_unpackhi_epi64 (sum[0], sum[0]));
+  res = _mm_cvtsi128_si64 (sum[0]);
+
+  res = (res + (1 << (PRECISION_S32 - 1))) >> PRECISION_S32;
+  *o = CLAMP (res, G_MININT32, G_MAXINT32);
+}
+
+MAKE_RESAMPLE_FUNC (gint32, full, 1, avx2);
+MAKE_RESAMPLE_FUNC (gint32, linear, 1, avx2);
+MAKE_RESAMPLE_FUNC (gint32, cubic, 1, avx2);
+#endif
+
+MAKE_RESAMPLE_FUNC (gint16, full, 1, avx2);
+MAKE_RESAMPLE_FUNC (gint16, linear, 1, avx2);
+MAKE_RESAMPLE_FUNC (gint16, cubic, 1, avx2);
+
+MAKE_RESAMPLE_FUNC (gfloat, full, 1, avx2);
+MAKE_RESAMPLE_FUNC (gfloat, linear, 1, avx2);
+MAKE_RESAMPLE_FUNC (gfloat, cubic, 1, avx2);
+
+MAKE_RESAMPLE_FUNC (gdouble, full, 1, avx2);
+MAKE_RESAMPLE_FUNC (gdouble, linear, 1, avx2);
+MAKE_RESAMPLE_FUNC (gdouble, cubic, 1, avx2);
+
+void
+interpolate_gint16_linear_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i = 0;
+  gint16 *o = op, *a = ap, *ic = icp;
+  __m256i ta, tb, t1, t2;
+  __m256i f = _mm256_set1_epi32 (*((gint32 *) ic));
+  __m256i round = _mm256_set1_epi32 (1 << (PRECISION_S16 - 1));
+  const gint16 *c[2] = { (gint16 *) ((gint8 *) a + 0 * astride),
+    (gint16 *) ((gint8 *) a + 1 * astride)
+  };
+
+  /* unpack and pack both work inside the 128 bits lanes so the samples
+   * end up back in their original order */
+  for (; i + 16 <= len; i += 16) {
+    ta = _mm256_load_si256 ((__m256i *) (c[0] + i));
+    tb = _mm256_load_si256 ((__m256i *) (c[1] + i));
+
+    t1 = _mm256_madd_epi16 (_mm256_unpacklo_epi16 (ta, tb), f);
+    t2 = _mm256_madd_epi16 (_mm256_unpackhi_epi16 (ta, tb), f);
+
+    t1 = _mm256_srai_epi32 (_mm256_add_epi32 (t1, round), PRECISION_S16);
+    t2 = _mm256_srai_epi32 (_mm256_add_epi32 (t2, round), PRECISION_S16);
+
+    _mm256_store_si256 ((__m256i *) (o + i), _mm256_packs_epi32 (t1, t2));
+  }
+  if (i < len) {
+    __m128i sa, sb, s1, s2;
+    __m128i sf = _mm256_castsi256_si128 (f);
+    __m128i sround = _mm256_castsi256_si128 (round);
+
+    sa = _mm_load_si128 ((__m128i *) (c[0] + i));
+    sb = _mm_load_si128 ((__m128i *) (c[1] + i));
+
+    s1 = _mm_madd_epi16 (_mm_unpacklo_epi16 (sa, sb), sf);
+    s2 = _mm_madd_epi16 (_mm_unpackhi_epi16 (sa, sb), sf);
+
+    s1 = _mm_srai_epi32 (_mm_add_epi32 (s1, sround), PRECISION_S16);
+    s2 = _mm_srai_epi32 (_mm_add_epi32 (s2, sround), PRECISION_S16);
+
+    _mm_store_si128 ((__m128i *) (o + i), _mm_packs_epi32 (s1, s2));
+  }
+}
+
+void
+interpolate_gint16_cubic_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i = 0;
+  gint16 *o = op, *a = ap, *ic = icp;
+  __m256i ta, tb, tl1, tl2, th1, th2;
+  __m256i f[2];
+  __m256i round = _mm256_set1_epi32 (1 << (PRECISION_S16 - 1));
+  const gint16 *c[4] = { (gint16 *) ((gint8 *) a + 0 * astride),
+    (gint16 *) ((gint8 *) a + 1 * astride),
+    (gint16 *) ((gint8 *) a + 2 * astride),
+    (gint16 *) ((gint8 *) a + 3 * astride)
+  };
+
+  f[0] = _mm256_set1_epi32 (*((gint32 *) (ic + 0)));
+  f[1] = _mm256_set1_epi32 (*((gint32 *) (ic + 2)));
+
+  for (; i + 16 <= len; i += 16) {
+    ta = _mm256_load_si256 ((__m256i *) (c[0] + i));
+    tb = _mm256_load_si256 ((__m256i *) (c[1] + i));
+
+    tl1 = _mm256_madd_epi16 (_mm256_unpacklo_epi16 (ta, tb), f[0]);
+    th1 = _mm256_madd_epi16 (_mm256_unpackhi_epi16 (ta, tb), f[0]);
+
+    ta = _mm256_load_si256 ((__m256i *) (c[2] + i));
+    tb = _mm256_load_si256 ((__m256i *) (c[3] + i));
+
+    tl2 = _mm256_madd_epi16 (_mm256_unpacklo_epi16 (ta, tb), f[1]);
+    th2 = _mm256_madd_epi16 (_mm256_unpackhi_epi16 (ta, tb), f[1]);
+
+    tl1 = _mm256_add_epi32 (_mm256_add_epi32 (tl1, tl2), round);
+    th1 = _mm256_add_epi32 (_mm256_add_epi32 (th1, th2), round);
+
+    tl1 = _mm256_srai_epi32 (tl1, PRECISION_S16);
+    th1 = _mm256_srai_epi32 (th1, PRECISION_S16);
+
+    _mm256_store_si256 ((__m256i *) (o + i), _mm256_packs_epi32 (tl1, th1));
+  }
+  if (i < len) {
+    __m128i sa, sb, sl1, sl2, sh1, sh2;
+    __m128i sf0 = _mm256_castsi256_si128 (f[0]);
+    __m128i sf1 = _mm256_castsi256_si128 (f[1]);
+    __m128i sround = _mm256_castsi256_si128 (round);
+
+    sa = _mm_load_si128 ((__m128i *) (c[0] + i));
+    sb = _mm_load_si128 ((__m128i *) (c[1] + i));
+
+    sl1 = _mm_madd_epi16 (_mm_unpacklo_epi16 (sa, sb), sf0);
+    sh1 = _mm_madd_epi16 (_mm_unpackhi_epi16 (sa, sb), sf0);
+
+    sa = _mm_load_si128 ((__m128i *) (c[2] + i));
+    sb = _mm_load_si128 ((__m128i *) (c[3] + i));
+
+    sl2 = _mm_madd_epi16 (_mm_unpacklo_epi16 (sa, sb), sf1);
+    sh2 = _mm_madd_epi16 (_mm_unpackhi_epi16 (sa, sb), sf1);
+
+    sl1 = _mm_add_epi32 (_mm_add_epi32 (sl1, sl2), sround);
+    sh1 = _mm_add_epi32 (_mm_add_epi32 (sh1, sh2), sround);
+
+    sl1 = _mm_srai_epi32 (sl1, PRECISION_S16);
+    sh1 = _mm_srai_epi32 (sh1, PRECISION_S16);
+
+    _mm_store_si128 ((__m128i *) (o + i), _mm_packs_epi32 (sl1, sh1));
+  }
+}
+
+void
+interpolate_gfloat_linear_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gfloat *o = op, *a = ap, *ic = icp;
+  __m256 f[2], t;
+  const gfloat *c[2] = { (gfloat *) ((gint8 *) a + 0 * astride),
+    (gfloat *) ((gint8 *) a + 1 * astride)
+  };
+
+  f[0] = _mm256_broadcast_ss (ic + 0);
+  f[1] = _mm256_broadcast_ss (ic + 1);
+
+  for (i = 0; i < len; i += 8) {
+    t = _mm256_mul_ps (_mm256_load_ps (c[0] + i), f[0]);
+    t = _mm256_fmadd_ps (_mm256_load_ps (c[1] + i), f[1], t);
+    _mm256_store_ps (o + i, t);
+  }
+}
+
+void
+interpolate_gfloat_cubic_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gfloat *o = op, *a = ap, *ic = icp;
+  __m256 f[4], t[2];
+  const gfloat *c[4] = { (gfloat *) ((gint8 *) a + 0 * astride),
+    (gfloat *) ((gint8 *) a + 1 * astride),
+    (gfloat *) ((gint8 *) a + 2 * astride),
+    (gfloat *) ((gint8 *) a + 3 * astride)
+  };
+
+  f[0] = _mm256_broadcast_ss (ic + 0);
+  f[1] = _mm256_broadcast_ss (ic + 1);
+  f[2] = _mm256_broadcast_ss (ic + 2);
+  f[3] = _mm256_broadcast_ss (ic + 3);
+
+  for (i = 0; i < len; i += 8) {
+    t[0] = _mm256_mul_ps (_mm256_load_ps (c[0] + i), f[0]);
+    t[1] = _mm256_mul_ps (_mm256_load_ps (c[2] + i), f[2]);
+    t[0] = _mm256_fmadd_ps (_mm256_load_ps (c[1] + i), f[1], t[0]);
+    t[1] = _mm256_fmadd_ps (_mm256_load_ps (c[3] + i), f[3], t[1]);
+    _mm256_store_ps (o + i, _mm256_add_ps (t[0], t[1]));
+  }
+}
+
+void
+interpolate_gdouble_linear_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gdouble *o = op, *a = ap, *ic = icp;
+  __m256d f[2], t;
+  const gdouble *c[2] = { (gdouble *) ((gint8 *) a + 0 * astride),
+    (gdouble *) ((gint8 *) a + 1 * astride)
+  };
+
+  f[0] = _mm256_broadcast_sd (ic + 0);
+  f[1] = _mm256_broadcast_sd (ic + 1);
+
+  for (i = 0; i < len; i += 4) {
+    t = _mm256_mul_pd (_mm256_load_pd (c[0] + i), f[0]);
+    t = _mm256_fmadd_pd (_mm256_load_pd (c[1] + i), f[1], t);
+    _mm256_store_pd (o + i, t);
+  }
+}
+
+void
+interpolate_gdouble_cubic_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gdouble *o = op, *a = ap, *ic = icp;
+  __m256d f[4], t[2];
+  const gdouble *c[4] = { (gdouble *) ((gint8 *) a + 0 * astride),
+    (gdouble *) ((gint8 *) a + 1 * astride),
+    (gdouble *) ((gint8 *) a + 2 * astride),
+    (gdouble *) ((gint8 *) a + 3 * astride)
+  };
+
+  f[0] = _mm256_broadcast_sd (ic + 0);
+  f[1] = _mm256_broadcast_sd (ic + 1);
+  f[2] = _mm256_broadcast_sd (ic + 2);
+  f[3] = _mm256_broadcast_sd (ic + 3);
+
+  for (i = 0; i < len; i += 4) {
+    t[0] = _mm256_mul_pd (_mm256_load_pd (c[0] + i), f[0]);
+    t[1] = _mm256_mul_pd (_mm256_load_pd (c[2] + i), f[2]);
+    t[0] = _mm256_fmadd_pd (_mm256_load_pd (c[1] + i), f[1], t[0]);
+    t[1] = _mm256_fmadd_pd (_mm256_load_pd (c[3] + i), f[3], t[1]);
+    _mm256_store_pd (o + i, _mm256_add_pd (t[0], t[1]));
+  }
+}
+
+#endif
@@ -21,6 +21,8 @@
 #include "audio-resampler-x86-sse.h"
 #include "audio-resampler-x86-sse2.h"
 #include "audio-resampler-x86-sse41.h"
+#include "audio-resampler-x86-avx2.h"
+#include "audio-resampler-x86-avx512.h"
 
 static void
 audio_resampler_check_x86 (const gchar *option)
@@ -69,3 +71,73 @@ audio_resampler_check_x86 (const gchar *option)
 #endif
   }
 }
+
+/* orc does not know about the wider instruction sets so ask the CPU
+ * directly. This runs after the orc flags were checked so that the AVX
+ * versions replace the SSE ones. */
+static void
+audio_resampler_check_x86_avx (void)
+{
+#if defined (__GNUC__) && defined (HAVE_IMMINTRIN_H)
+  __builtin_cpu_init ();
+
+#if HAVE_AVX2
+  if (__builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma")) {
+    GST_DEBUG ("enable AVX2 optimisations");
+    resample_gint16_full_1 = resample_gint16_full_1_avx2;
+    resample_gint16_linear_1 = resample_gint16_linear_1_avx2;
+    resample_gint16_cubic_1 = resample_gint16_cubic_1_avx2;
+
+    interpolate_gint16_linear = interpolate_gint16_linear_avx2;
+    interpolate_gint16_cubic = interpolate_gint16_cubic_avx2;
+
+#if defined (__x86_64__)
+    resample_gint32_full_1 = resample_gint32_full_1_avx2;
+    resample_gint32_linear_1 = resample_gint32_linear_1_avx2;
+    resample_gint32_cubic_1 = resample_gint32_cubic_1_avx2;
+#endif
+
+    resample_gfloat_full_1 = resample_gfloat_full_1_avx2;
+    resample_gfloat_linear_1 = resample_gfloat_linear_1_avx2;
+    resample_gfloat_cubic_1 = resample_gfloat_cubic_1_avx2;
+
+    interpolate_gfloat_linear = interpolate_gfloat_linear_avx2;
+    interpolate_gfloat_cubic = interpolate_gfloat_cubic_avx2;
+
+    resample_gdouble_full_1 = resample_gdouble_full_1_avx2;
+    resample_gdouble_linear_1 = resample_gdouble_linear_1_avx2;
+    resample_gdouble_cubic_1 = resample_gdouble_cubic_1_avx2;
+
+    interpolate_gdouble_linear = interpolate_gdouble_linear_avx2;
+    interpolate_gdouble_cubic = interpolate_gdouble_cubic_avx2;
+  } else {
+    GST_DEBUG ("AVX2 not supported by this CPU");
+  }
+#else
+  GST_DEBUG ("AVX2 optimisations not enabled");
+#endif
+
+#if HAVE_AVX512
+  if (__builtin_cpu_supports ("avx512f")) {
+    GST_DEBUG ("enable AVX-512 optimisations");
+    resample_gfloat_full_1 = resample_gfloat_full_1_avx512;
+    resample_gfloat_linear_1 = resample_gfloat_linear_1_avx512;
+    resample_gfloat_cubic_1 = resample_gfloat_cubic_1_avx512;
+
+    interpolate_gfloat_linear = interpolate_gfloat_linear_avx512;
+    interpolate_gfloat_cubic = interpolate_gfloat_cubic_avx512;
+
+    resample_gdouble_full_1 = resample_gdouble_full_1_avx512;
+    resample_gdouble_linear_1 = resample_gdouble_linear_1_avx512;
+    resample_gdouble_cubic_1 = resample_gdouble_cubic_1_avx512;
+
+    interpolate_gdouble_linear = interpolate_gdouble_linear_avx512;
+    interpolate_gdouble_cubic = interpolate_gdouble_cubic_avx512;
+  } else {
+    GST_DEBUG ("AVX-512 not supported by this CPU");
+  }
+#else
+  GST_DEBUG ("AVX-512 optimisations not enabled");
+#endif
+#endif
+}
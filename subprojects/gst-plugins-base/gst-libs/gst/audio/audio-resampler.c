@@ -34,7 +34,8 @@
 #include "audio-resampler-macros.h"
 
 #define MEM_ALIGN(m,a) ((gint8 *)((guintptr)((gint8 *)(m) + ((a)-1)) & ~((a)-1)))
-#define ALIGN 16
+/* enough for aligned AVX loads, the taps stride is a multiple of this */
+#define ALIGN 32
 #define TAPS_OVERREAD 16
 
 GST_DEBUG_CATEGORY_STATIC (audio_resampler_debug);
@@ -874,6 +875,9 @@ audio_resampler_init (void)
         }
       }
     }
+#ifdef CHECK_X86
+    audio_resampler_check_x86_avx ();
+#endif
 #endif
     g_once_init_leave (&init_gonce, 1);
   }
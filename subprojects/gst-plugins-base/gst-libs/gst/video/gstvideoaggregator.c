@@ -33,6 +33,12 @@
  * Zorder for each input stream can be configured on the
  * #GstVideoAggregatorPad.
  *
+ * The frames of pads that only implement
+ * #GstVideoAggregatorPadClass::prepare_frame are prepared one after another
+ * by default. With #GstVideoAggregator:parallel-prepare they are prepared
+ * concurrently instead, which requires that the implementations of all pads
+ * can be called from different threads at the same time.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
@@ -73,6 +79,18 @@ struct _GstVideoAggregatorPrivate
   GPtrArray *supported_formats;
 
   GstTaskPool *task_pool;
+
+  /* separate from task_pool, as preparing a frame can wait for tasks on
+   * task_pool */
+  GstTaskPool *prepare_pool;
+  gboolean parallel_prepare;
+};
+
+#define DEFAULT_PARALLEL_PREPARE FALSE
+enum
+{
+  PROP_0,
+  PROP_PARALLEL_PREPARE,
 };
 
 /****************************************
@@ -2051,12 +2069,119 @@ prepare_frames_start (GstElement * agg, GstPad * pad, gpointer user_data)
   return TRUE;
 }
 
+typedef struct
+{
+  GstVideoAggregator *vagg;
+  GstVideoAggregatorPad *pad;
+  gpointer id;
+  gboolean res;
+} PrepareFrameTask;
+
+static void
+prepare_frame_task_func (PrepareFrameTask * task)
+{
+  GstVideoAggregatorPad *vpad = task->pad;
+  GstVideoAggregatorPadClass *vaggpad_class =
+      GST_VIDEO_AGGREGATOR_PAD_GET_CLASS (vpad);
+
+  task->res = vaggpad_class->prepare_frame (vpad, task->vagg,
+      vpad->priv->buffer, &vpad->priv->prepared_frame);
+}
+
+/* Collects the pads that only implement prepare_frame */
+static gboolean
+collect_prepare_tasks (GstElement * agg, GstPad * pad, gpointer user_data)
+{
+  GstVideoAggregatorPad *vpad = GST_VIDEO_AGGREGATOR_PAD_CAST (pad);
+  GstVideoAggregatorPadClass *vaggpad_class =
+      GST_VIDEO_AGGREGATOR_PAD_GET_CLASS (pad);
+  GArray *tasks = user_data;
+  PrepareFrameTask task = { NULL, };
+
+  if (vpad->priv->buffer == NULL || !vaggpad_class->prepare_frame
+      || (vaggpad_class->prepare_frame_start
+          && vaggpad_class->prepare_frame_finish))
+    return TRUE;
+
+  /* GAP event, nothing to do */
+  if (gst_buffer_get_size (vpad->priv->buffer) == 0 &&
+      GST_BUFFER_FLAG_IS_SET (vpad->priv->buffer, GST_BUFFER_FLAG_GAP)) {
+    return TRUE;
+  }
+
+  task.vagg = GST_VIDEO_AGGREGATOR_CAST (agg);
+  task.pad = gst_object_ref (vpad);
+  g_array_append_val (tasks, task);
+
+  return TRUE;
+}
+
+/* Prepares the frames of all pads that only implement prepare_frame
+ * concurrently. Only the preparation runs in parallel, the frames are still
+ * aggregated in the order of the pads afterwards. */
+static void
+prepare_frames_parallel (GstVideoAggregator * vagg)
+{
+  GstTaskPool *pool;
+  GArray *tasks;
+  guint i;
+
+  tasks = g_array_new (FALSE, FALSE, sizeof (PrepareFrameTask));
+  gst_element_foreach_sink_pad (GST_ELEMENT_CAST (vagg), collect_prepare_tasks,
+      tasks);
+
+  /* only needed once there is something to prepare concurrently, it is
+   * only accessed from the aggregate thread */
+  if (tasks->len > 1 && !vagg->priv->prepare_pool) {
+    vagg->priv->prepare_pool = gst_shared_task_pool_new ();
+    gst_shared_task_pool_set_max_threads (GST_SHARED_TASK_POOL (vagg->
+            priv->prepare_pool), g_get_num_processors ());
+    gst_task_pool_prepare (vagg->priv->prepare_pool, NULL);
+  }
+  pool = vagg->priv->prepare_pool;
+
+  /* the first pad is prepared in this thread, the others on the pool */
+  for (i = 1; i < tasks->len; i++) {
+    PrepareFrameTask *task = &g_array_index (tasks, PrepareFrameTask, i);
+
+    task->id = gst_task_pool_push (pool,
+        (GstTaskPoolFunction) prepare_frame_task_func, task, NULL);
+    if (!task->id)
+      prepare_frame_task_func (task);
+  }
+  if (tasks->len > 0)
+    prepare_frame_task_func (&g_array_index (tasks, PrepareFrameTask, 0));
+
+  for (i = 0; i < tasks->len; i++) {
+    PrepareFrameTask *task = &g_array_index (tasks, PrepareFrameTask, i);
+
+    if (task->id)
+      gst_task_pool_join (pool, task->id);
+
+    /* the pad is left out of this output buffer */
+    if (!task->res) {
+      GstVideoAggregatorPadClass *vaggpad_class =
+          GST_VIDEO_AGGREGATOR_PAD_GET_CLASS (task->pad);
+
+      GST_WARNING_OBJECT (task->pad, "Failed to prepare frame, dropping it");
+      if (vaggpad_class->clean_frame)
+        vaggpad_class->clean_frame (task->pad, vagg,
+            &task->pad->priv->prepared_frame);
+      memset (&task->pad->priv->prepared_frame, 0, sizeof (GstVideoFrame));
+    }
+    gst_object_unref (task->pad);
+  }
+
+  g_array_free (tasks, TRUE);
+}
+
 static gboolean
 prepare_frames_finish (GstElement * agg, GstPad * pad, gpointer user_data)
 {
   GstVideoAggregatorPad *vpad = GST_VIDEO_AGGREGATOR_PAD_CAST (pad);
   GstVideoAggregatorPadClass *vaggpad_class =
       GST_VIDEO_AGGREGATOR_PAD_GET_CLASS (pad);
+  gboolean parallel = GPOINTER_TO_INT (user_data);
 
   if (vpad->priv->buffer == NULL || (!vaggpad_class->prepare_frame
           && !vaggpad_class->prepare_frame_start))
@@ -2073,6 +2198,9 @@ prepare_frames_finish (GstElement * agg, GstPad * pad, gpointer user_data)
     vaggpad_class->prepare_frame_finish (vpad, GST_VIDEO_AGGREGATOR_CAST (agg),
         &vpad->priv->prepared_frame);
     return TRUE;
+  } else if (parallel) {
+    /* already done by prepare_frames_parallel() */
+    return TRUE;
   } else {
     return vaggpad_class->prepare_frame (vpad, GST_VIDEO_AGGREGATOR_CAST (agg),
         vpad->priv->buffer, &vpad->priv->prepared_frame);
@@ -2106,6 +2234,7 @@ gst_video_aggregator_do_aggregate (GstVideoAggregator * vagg,
   GstVideoAggregatorClass *vagg_klass = (GstVideoAggregatorClass *) klass;
   GstClockTime out_stream_time;
   GstSegment *agg_segment = &GST_AGGREGATOR_PAD (agg->srcpad)->segment;
+  gboolean parallel;
 
   g_assert (vagg_klass->aggregate_frames != NULL);
   g_assert (vagg_klass->create_output_buffer != NULL);
@@ -2142,11 +2271,17 @@ gst_video_aggregator_do_aggregate (GstVideoAggregator * vagg,
   gst_aggregator_selected_samples (agg, GST_BUFFER_PTS (*outbuf),
       GST_BUFFER_DTS (*outbuf), GST_BUFFER_DURATION (*outbuf), NULL);
 
+  GST_OBJECT_LOCK (vagg);
+  parallel = vagg->priv->parallel_prepare;
+  GST_OBJECT_UNLOCK (vagg);
+
   /* Convert all the frames the subclass has before aggregating */
   gst_element_foreach_sink_pad (GST_ELEMENT_CAST (vagg), prepare_frames_start,
       NULL);
+  if (parallel)
+    prepare_frames_parallel (vagg);
   gst_element_foreach_sink_pad (GST_ELEMENT_CAST (vagg), prepare_frames_finish,
-      NULL);
+      GINT_TO_POINTER (parallel));
 
   ret = vagg_klass->aggregate_frames (vagg, *outbuf);
 
@@ -2994,6 +3129,10 @@ gst_video_aggregator_finalize (GObject * o)
     gst_task_pool_cleanup (vagg->priv->task_pool);
   gst_clear_object (&vagg->priv->task_pool);
 
+  if (vagg->priv->prepare_pool)
+    gst_task_pool_cleanup (vagg->priv->prepare_pool);
+  gst_clear_object (&vagg->priv->prepare_pool);
+
   G_OBJECT_CLASS (gst_video_aggregator_parent_class)->finalize (o);
 }
 
@@ -3011,7 +3150,14 @@ static void
 gst_video_aggregator_get_property (GObject * object,
     guint prop_id, GValue * value, GParamSpec * pspec)
 {
+  GstVideoAggregator *vagg = GST_VIDEO_AGGREGATOR (object);
+
   switch (prop_id) {
+    case PROP_PARALLEL_PREPARE:
+      GST_OBJECT_LOCK (vagg);
+      g_value_set_boolean (value, vagg->priv->parallel_prepare);
+      GST_OBJECT_UNLOCK (vagg);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3022,7 +3168,14 @@ static void
 gst_video_aggregator_set_property (GObject * object,
     guint prop_id, const GValue * value, GParamSpec * pspec)
 {
+  GstVideoAggregator *vagg = GST_VIDEO_AGGREGATOR (object);
+
   switch (prop_id) {
+    case PROP_PARALLEL_PREPARE:
+      GST_OBJECT_LOCK (vagg);
+      vagg->priv->parallel_prepare = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (vagg);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3052,6 +3205,27 @@ gst_video_aggregator_class_init (GstVideoAggregatorClass * klass)
   gobject_class->get_property = gst_video_aggregator_get_property;
   gobject_class->set_property = gst_video_aggregator_set_property;
 
+  /**
+   * GstVideoAggregator:parallel-prepare:
+   *
+   * Prepare the frames of all pads that implement
+   * #GstVideoAggregatorPadClass::prepare_frame concurrently instead of one
+   * after another, e.g. to convert and scale the frames of many
+   * #GstVideoAggregatorConvertPad in parallel. The frames are aggregated in
+   * the same order either way.
+   *
+   * Only enable this if the prepare_frame implementations of all pads can be
+   * called from multiple threads at the same time.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_PARALLEL_PREPARE,
+      g_param_spec_boolean ("parallel-prepare", "Parallel Prepare",
+          "Prepare the frames of all pads concurrently",
+          DEFAULT_PARALLEL_PREPARE,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
+          G_PARAM_STATIC_STRINGS));
+
   gstelement_class->request_new_pad =
       GST_DEBUG_FUNCPTR (gst_video_aggregator_request_new_pad);
   gstelement_class->release_pad =
@@ -3136,4 +3310,6 @@ gst_video_aggregator_init (GstVideoAggregator * vagg,
   gst_shared_task_pool_set_max_threads (GST_SHARED_TASK_POOL (vagg->
           priv->task_pool), g_get_num_processors ());
   gst_task_pool_prepare (vagg->priv->task_pool, NULL);
+
+  vagg->priv->parallel_prepare = DEFAULT_PARALLEL_PREPARE;
 }
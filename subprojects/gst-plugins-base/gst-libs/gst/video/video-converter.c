@@ -465,6 +465,7 @@ struct _GstVideoConverter
   gint fout_height[4];
   gint fsplane[4];
   gint ffill[4];
+  guint16 fmax[4];
 
   struct
   {
@@ -2817,10 +2818,22 @@ video_converter_compute_matrix (GstVideoConverter * convert)
   MatrixData *dst = &convert->convert_matrix;
 
   color_matrix_set_identity (dst);
+  /* scale for the difference in bits like chain_convert() does, the high
+   * bit depth fastpaths use the same integer matrix as the generic path */
+  if (convert->unpack_bits < convert->pack_bits) {
+    gint scale = 1 << (convert->pack_bits - convert->unpack_bits);
+    color_matrix_scale_components (dst,
+        1 / (float) scale, 1 / (float) scale, 1 / (float) scale);
+  }
   compute_matrix_to_RGB (convert, dst);
   compute_matrix_to_YUV (convert, dst, FALSE);
+  if (convert->unpack_bits > convert->pack_bits) {
+    gint scale = 1 << (convert->unpack_bits - convert->pack_bits);
+    color_matrix_scale_components (dst,
+        (float) scale, (float) scale, (float) scale);
+  }
 
-  convert->current_bits = 8;
+  convert->current_bits = MAX (convert->unpack_bits, convert->pack_bits);
   prepare_matrix (convert, dst);
 }
 
@@ -4032,6 +4045,7 @@ typedef struct
   gint dstride, dustride, dvstride;
   gint width, height;
   gint alpha;
+  gint shift;
   MatrixData *data;
 } FConvertPlaneTask;
 
@@ -5768,36 +5782,51 @@ convert_Y42B_v210 (GstVideoConverter * convert, const GstVideoFrame * src,
 }
 
 static void
-convert_Y444_YUY2_task (FConvertPlaneTask * task)
+convert_P010_I420_10LE_task (FConvertPlaneTask * task)
 {
-  video_orc_convert_Y444_YUY2 (task->d, task->dstride, task->s,
-      task->sstride,
-      task->su,
-      task->sustride, task->sv, task->svstride, task->width / 2, task->height);
+  gint i, j;
+  gint width = task->width, cwidth = (task->width + 1) >> 1;
+  gint shift = task->shift;
+
+  for (i = 0; i < task->height; i++) {
+    const guint16 *s = (const guint16 *) (task->s + i * task->sstride);
+    guint16 *d = (guint16 *) (task->d + i * task->dstride);
+
+    for (j = 0; j < width; j++)
+      GST_WRITE_UINT16_LE (d + j, GST_READ_UINT16_LE (s + j) >> shift);
+  }
+
+  for (i = 0; i < (task->height + 1) >> 1; i++) {
+    const guint16 *suv = (const guint16 *) (task->su + i * task->sustride);
+    guint16 *du = (guint16 *) (task->du + i * task->dustride);
+    guint16 *dv = (guint16 *) (task->dv + i * task->dvstride);
+
+    for (j = 0; j < cwidth; j++) {
+      GST_WRITE_UINT16_LE (du + j, GST_READ_UINT16_LE (suv + 2 * j) >> shift);
+      GST_WRITE_UINT16_LE (dv + j,
+          GST_READ_UINT16_LE (suv + 2 * j + 1) >> shift);
+    }
+  }
 }
 
 static void
-convert_Y444_YUY2 (GstVideoConverter * convert, const GstVideoFrame * src,
+convert_P010_I420_10LE (GstVideoConverter * convert, const GstVideoFrame * src,
     GstVideoFrame * dest)
 {
   gint width = convert->in_width;
   gint height = convert->in_height;
-  guint8 *sy, *su, *sv, *d;
+  guint8 *sy, *suv, *dy, *du, *dv;
   FConvertPlaneTask *tasks;
   FConvertPlaneTask **tasks_p;
   gint n_threads;
   gint lines_per_thread;
   gint i;
 
-  sy = FRAME_GET_Y_LINE (src, convert->in_y);
-  sy += convert->in_x;
-  su = FRAME_GET_U_LINE (src, convert->in_y);
-  su += convert->in_x;
-  sv = FRAME_GET_V_LINE (src, convert->in_y);
-  sv += convert->in_x;
-
-  d = FRAME_GET_LINE (dest, convert->out_y);
-  d += (GST_ROUND_UP_2 (convert->out_x) * 2);
+  sy = FRAME_GET_Y_LINE (src, 0);
+  suv = FRAME_GET_PLANE_LINE (src, 1, 0);
+  dy = FRAME_GET_Y_LINE (dest, 0);
+  du = FRAME_GET_U_LINE (dest, 0);
+  dv = FRAME_GET_V_LINE (dest, 0);
 
   n_threads = convert->conversion_runner->n_threads;
   tasks = convert->tasks[0] =
@@ -5805,63 +5834,82 @@ convert_Y444_YUY2 (GstVideoConverter * convert, const GstVideoFrame * src,
   tasks_p = convert->tasks_p[0] =
       g_renew (FConvertPlaneTask *, convert->tasks_p[0], n_threads);
 
-  lines_per_thread = (height + n_threads - 1) / n_threads;
+  /* keep the chroma lines of a line pair in the same task */
+  lines_per_thread = GST_ROUND_UP_2 ((height + n_threads - 1) / n_threads);
 
   for (i = 0; i < n_threads; i++) {
-    tasks[i].dstride = FRAME_GET_STRIDE (dest);
     tasks[i].sstride = FRAME_GET_Y_STRIDE (src);
-    tasks[i].sustride = FRAME_GET_U_STRIDE (src);
-    tasks[i].svstride = FRAME_GET_V_STRIDE (src);
-    tasks[i].d = d + i * lines_per_thread * tasks[i].dstride;
+    tasks[i].sustride = FRAME_GET_PLANE_STRIDE (src, 1);
+    tasks[i].dstride = FRAME_GET_Y_STRIDE (dest);
+    tasks[i].dustride = FRAME_GET_U_STRIDE (dest);
+    tasks[i].dvstride = FRAME_GET_V_STRIDE (dest);
     tasks[i].s = sy + i * lines_per_thread * tasks[i].sstride;
-    tasks[i].su = su + i * lines_per_thread * tasks[i].sustride;
-    tasks[i].sv = sv + i * lines_per_thread * tasks[i].svstride;
+    tasks[i].su = suv + i * (lines_per_thread / 2) * tasks[i].sustride;
+    tasks[i].d = dy + i * lines_per_thread * tasks[i].dstride;
+    tasks[i].du = du + i * (lines_per_thread / 2) * tasks[i].dustride;
+    tasks[i].dv = dv + i * (lines_per_thread / 2) * tasks[i].dvstride;
 
     tasks[i].width = width;
     tasks[i].height = (i + 1) * lines_per_thread;
     tasks[i].height = MIN (tasks[i].height, height);
     tasks[i].height -= i * lines_per_thread;
+    /* P01x keeps the samples in the high bits */
+    tasks[i].shift = 16 - GST_VIDEO_FORMAT_INFO_DEPTH (src->info.finfo, 0);
 
     tasks_p[i] = &tasks[i];
   }
 
   gst_parallelized_task_runner_run (convert->conversion_runner,
-      (GstParallelizedTaskFunc) convert_Y444_YUY2_task, (gpointer) tasks_p);
-
-  convert_fill_border (convert, dest);
+      (GstParallelizedTaskFunc) convert_P010_I420_10LE_task,
+      (gpointer) tasks_p);
 }
 
 static void
-convert_Y444_UYVY_task (FConvertPlaneTask * task)
+convert_I420_10LE_P010_task (FConvertPlaneTask * task)
 {
-  video_orc_convert_Y444_UYVY (task->d, task->dstride, task->s,
-      task->sstride,
-      task->su,
-      task->sustride, task->sv, task->svstride, task->width / 2, task->height);
+  gint i, j;
+  gint width = task->width, cwidth = (task->width + 1) >> 1;
+  gint shift = task->shift;
+
+  for (i = 0; i < task->height; i++) {
+    const guint16 *s = (const guint16 *) (task->s + i * task->sstride);
+    guint16 *d = (guint16 *) (task->d + i * task->dstride);
+
+    for (j = 0; j < width; j++)
+      GST_WRITE_UINT16_LE (d + j, GST_READ_UINT16_LE (s + j) << shift);
+  }
+
+  for (i = 0; i < (task->height + 1) >> 1; i++) {
+    const guint16 *su = (const guint16 *) (task->su + i * task->sustride);
+    const guint16 *sv = (const guint16 *) (task->sv + i * task->svstride);
+    guint16 *duv = (guint16 *) (task->du + i * task->dustride);
+
+    for (j = 0; j < cwidth; j++) {
+      GST_WRITE_UINT16_LE (duv + 2 * j, GST_READ_UINT16_LE (su + j) << shift);
+      GST_WRITE_UINT16_LE (duv + 2 * j + 1,
+          GST_READ_UINT16_LE (sv + j) << shift);
+    }
+  }
 }
 
 static void
-convert_Y444_UYVY (GstVideoConverter * convert, const GstVideoFrame * src,
+convert_I420_10LE_P010 (GstVideoConverter * convert, const GstVideoFrame * src,
     GstVideoFrame * dest)
 {
   gint width = convert->in_width;
   gint height = convert->in_height;
-  guint8 *sy, *su, *sv, *d;
+  guint8 *sy, *su, *sv, *dy, *duv;
   FConvertPlaneTask *tasks;
   FConvertPlaneTask **tasks_p;
   gint n_threads;
   gint lines_per_thread;
   gint i;
 
-  sy = FRAME_GET_Y_LINE (src, convert->in_y);
-  sy += convert->in_x;
-  su = FRAME_GET_U_LINE (src, convert->in_y);
-  su += convert->in_x;
-  sv = FRAME_GET_V_LINE (src, convert->in_y);
-  sv += convert->in_x;
-
-  d = FRAME_GET_LINE (dest, convert->out_y);
-  d += (GST_ROUND_UP_2 (convert->out_x) * 2);
+  sy = FRAME_GET_Y_LINE (src, 0);
+  su = FRAME_GET_U_LINE (src, 0);
+  sv = FRAME_GET_V_LINE (src, 0);
+  dy = FRAME_GET_Y_LINE (dest, 0);
+  duv = FRAME_GET_PLANE_LINE (dest, 1, 0);
 
   n_threads = convert->conversion_runner->n_threads;
   tasks = convert->tasks[0] =
@@ -5869,65 +5917,78 @@ convert_Y444_UYVY (GstVideoConverter * convert, const GstVideoFrame * src,
   tasks_p = convert->tasks_p[0] =
       g_renew (FConvertPlaneTask *, convert->tasks_p[0], n_threads);
 
-  lines_per_thread = (height + n_threads - 1) / n_threads;
+  /* keep the chroma lines of a line pair in the same task */
+  lines_per_thread = GST_ROUND_UP_2 ((height + n_threads - 1) / n_threads);
 
   for (i = 0; i < n_threads; i++) {
-    tasks[i].dstride = FRAME_GET_STRIDE (dest);
     tasks[i].sstride = FRAME_GET_Y_STRIDE (src);
     tasks[i].sustride = FRAME_GET_U_STRIDE (src);
     tasks[i].svstride = FRAME_GET_V_STRIDE (src);
-    tasks[i].d = d + i * lines_per_thread * tasks[i].dstride;
+    tasks[i].dstride = FRAME_GET_Y_STRIDE (dest);
+    tasks[i].dustride = FRAME_GET_PLANE_STRIDE (dest, 1);
     tasks[i].s = sy + i * lines_per_thread * tasks[i].sstride;
-    tasks[i].su = su + i * lines_per_thread * tasks[i].sustride;
-    tasks[i].sv = sv + i * lines_per_thread * tasks[i].svstride;
+    tasks[i].su = su + i * (lines_per_thread / 2) * tasks[i].sustride;
+    tasks[i].sv = sv + i * (lines_per_thread / 2) * tasks[i].svstride;
+    tasks[i].d = dy + i * lines_per_thread * tasks[i].dstride;
+    tasks[i].du = duv + i * (lines_per_thread / 2) * tasks[i].dustride;
 
     tasks[i].width = width;
     tasks[i].height = (i + 1) * lines_per_thread;
     tasks[i].height = MIN (tasks[i].height, height);
     tasks[i].height -= i * lines_per_thread;
+    tasks[i].shift = 16 - GST_VIDEO_FORMAT_INFO_DEPTH (dest->info.finfo, 0);
 
     tasks_p[i] = &tasks[i];
   }
 
   gst_parallelized_task_runner_run (convert->conversion_runner,
-      (GstParallelizedTaskFunc) convert_Y444_UYVY_task, (gpointer) tasks_p);
-
-  convert_fill_border (convert, dest);
+      (GstParallelizedTaskFunc) convert_I420_10LE_P010_task,
+      (gpointer) tasks_p);
 }
 
 static void
-convert_Y444_AYUV_task (FConvertPlaneTask * task)
+convert_NV12_P010_task (FConvertPlaneTask * task)
 {
-  video_orc_convert_Y444_AYUV (task->d, task->dstride, task->s,
-      task->sstride,
-      task->su,
-      task->sustride,
-      task->sv, task->svstride, task->alpha, task->width, task->height);
+  gint i, j;
+  gint width = GST_ROUND_UP_2 (task->width);
+  guint16 mask = 0xffff << task->shift;
+
+  /* the chroma plane has the same number of samples per line as the luma
+   * plane, except for odd widths */
+  for (i = 0; i < task->height; i++) {
+    const guint8 *s = task->s + i * task->sstride;
+    guint16 *d = (guint16 *) (task->d + i * task->dstride);
+
+    for (j = 0; j < task->width; j++)
+      GST_WRITE_UINT16_LE (d + j, ((s[j] << 8) | s[j]) & mask);
+  }
+
+  for (i = 0; i < (task->height + 1) >> 1; i++) {
+    const guint8 *s = task->su + i * task->sustride;
+    guint16 *d = (guint16 *) (task->du + i * task->dustride);
+
+    for (j = 0; j < width; j++)
+      GST_WRITE_UINT16_LE (d + j, ((s[j] << 8) | s[j]) & mask);
+  }
 }
 
 static void
-convert_Y444_AYUV (GstVideoConverter * convert, const GstVideoFrame * src,
+convert_NV12_P010 (GstVideoConverter * convert, const GstVideoFrame * src,
     GstVideoFrame * dest)
 {
   gint width = convert->in_width;
   gint height = convert->in_height;
-  guint8 *sy, *su, *sv, *d;
-  guint8 alpha = MIN (convert->alpha_value, 255);
+  guint8 *sy, *suv, *dy, *duv;
   FConvertPlaneTask *tasks;
   FConvertPlaneTask **tasks_p;
   gint n_threads;
   gint lines_per_thread;
   gint i;
 
-  sy = FRAME_GET_Y_LINE (src, convert->in_y);
-  sy += convert->in_x;
-  su = FRAME_GET_U_LINE (src, convert->in_y);
-  su += convert->in_x;
-  sv = FRAME_GET_V_LINE (src, convert->in_y);
-  sv += convert->in_x;
-
-  d = FRAME_GET_LINE (dest, convert->out_y);
-  d += convert->out_x * 4;
+  sy = FRAME_GET_Y_LINE (src, 0);
+  suv = FRAME_GET_PLANE_LINE (src, 1, 0);
+  dy = FRAME_GET_Y_LINE (dest, 0);
+  duv = FRAME_GET_PLANE_LINE (dest, 1, 0);
 
   n_threads = convert->conversion_runner->n_threads;
   tasks = convert->tasks[0] =
@@ -5935,61 +5996,71 @@ convert_Y444_AYUV (GstVideoConverter * convert, const GstVideoFrame * src,
   tasks_p = convert->tasks_p[0] =
       g_renew (FConvertPlaneTask *, convert->tasks_p[0], n_threads);
 
-  lines_per_thread = (height + n_threads - 1) / n_threads;
+  lines_per_thread = GST_ROUND_UP_2 ((height + n_threads - 1) / n_threads);
 
   for (i = 0; i < n_threads; i++) {
-    tasks[i].dstride = FRAME_GET_STRIDE (dest);
     tasks[i].sstride = FRAME_GET_Y_STRIDE (src);
-    tasks[i].sustride = FRAME_GET_U_STRIDE (src);
-    tasks[i].svstride = FRAME_GET_V_STRIDE (src);
-    tasks[i].d = d + i * lines_per_thread * tasks[i].dstride;
+    tasks[i].sustride = FRAME_GET_PLANE_STRIDE (src, 1);
+    tasks[i].dstride = FRAME_GET_Y_STRIDE (dest);
+    tasks[i].dustride = FRAME_GET_PLANE_STRIDE (dest, 1);
     tasks[i].s = sy + i * lines_per_thread * tasks[i].sstride;
-    tasks[i].su = su + i * lines_per_thread * tasks[i].sustride;
-    tasks[i].sv = sv + i * lines_per_thread * tasks[i].svstride;
+    tasks[i].su = suv + i * (lines_per_thread / 2) * tasks[i].sustride;
+    tasks[i].d = dy + i * lines_per_thread * tasks[i].dstride;
+    tasks[i].du = duv + i * (lines_per_thread / 2) * tasks[i].dustride;
 
     tasks[i].width = width;
     tasks[i].height = (i + 1) * lines_per_thread;
     tasks[i].height = MIN (tasks[i].height, height);
     tasks[i].height -= i * lines_per_thread;
-    tasks[i].alpha = alpha;
+    tasks[i].shift = 16 - GST_VIDEO_FORMAT_INFO_DEPTH (dest->info.finfo, 0);
 
     tasks_p[i] = &tasks[i];
   }
 
   gst_parallelized_task_runner_run (convert->conversion_runner,
-      (GstParallelizedTaskFunc) convert_Y444_AYUV_task, (gpointer) tasks_p);
-
-  convert_fill_border (convert, dest);
+      (GstParallelizedTaskFunc) convert_NV12_P010_task, (gpointer) tasks_p);
 }
 
-#if G_BYTE_ORDER == G_LITTLE_ENDIAN
 static void
-convert_AYUV_ARGB_task (FConvertPlaneTask * task)
+convert_P010_NV12_task (FConvertPlaneTask * task)
 {
-  video_orc_convert_AYUV_ARGB (task->d, task->dstride, task->s,
-      task->sstride, task->data->im[0][0], task->data->im[0][2],
-      task->data->im[2][1], task->data->im[1][1], task->data->im[1][2],
-      task->width, task->height);
+  gint i, j;
+  gint width = GST_ROUND_UP_2 (task->width);
+
+  for (i = 0; i < task->height; i++) {
+    const guint16 *s = (const guint16 *) (task->s + i * task->sstride);
+    guint8 *d = task->d + i * task->dstride;
+
+    for (j = 0; j < task->width; j++)
+      d[j] = GST_READ_UINT16_LE (s + j) >> 8;
+  }
+
+  for (i = 0; i < (task->height + 1) >> 1; i++) {
+    const guint16 *s = (const guint16 *) (task->su + i * task->sustride);
+    guint8 *d = task->du + i * task->dustride;
+
+    for (j = 0; j < width; j++)
+      d[j] = GST_READ_UINT16_LE (s + j) >> 8;
+  }
 }
 
 static void
-convert_AYUV_ARGB (GstVideoConverter * convert, const GstVideoFrame * src,
+convert_P010_NV12 (GstVideoConverter * convert, const GstVideoFrame * src,
     GstVideoFrame * dest)
 {
   gint width = convert->in_width;
   gint height = convert->in_height;
-  MatrixData *data = &convert->convert_matrix;
-  guint8 *s, *d;
+  guint8 *sy, *suv, *dy, *duv;
   FConvertPlaneTask *tasks;
   FConvertPlaneTask **tasks_p;
   gint n_threads;
   gint lines_per_thread;
   gint i;
 
-  s = FRAME_GET_LINE (src, convert->in_y);
-  s += (convert->in_x * 4);
-  d = FRAME_GET_LINE (dest, convert->out_y);
-  d += (convert->out_x * 4);
+  sy = FRAME_GET_Y_LINE (src, 0);
+  suv = FRAME_GET_PLANE_LINE (src, 1, 0);
+  dy = FRAME_GET_Y_LINE (dest, 0);
+  duv = FRAME_GET_PLANE_LINE (dest, 1, 0);
 
   n_threads = convert->conversion_runner->n_threads;
   tasks = convert->tasks[0] =
@@ -5997,103 +6068,88 @@ convert_AYUV_ARGB (GstVideoConverter * convert, const GstVideoFrame * src,
   tasks_p = convert->tasks_p[0] =
       g_renew (FConvertPlaneTask *, convert->tasks_p[0], n_threads);
 
-  lines_per_thread = (height + n_threads - 1) / n_threads;
+  lines_per_thread = GST_ROUND_UP_2 ((height + n_threads - 1) / n_threads);
 
   for (i = 0; i < n_threads; i++) {
-    tasks[i].dstride = FRAME_GET_STRIDE (dest);
-    tasks[i].sstride = FRAME_GET_STRIDE (src);
-    tasks[i].d = d + i * lines_per_thread * tasks[i].dstride;
-    tasks[i].s = s + i * lines_per_thread * tasks[i].sstride;
+    tasks[i].sstride = FRAME_GET_Y_STRIDE (src);
+    tasks[i].sustride = FRAME_GET_PLANE_STRIDE (src, 1);
+    tasks[i].dstride = FRAME_GET_Y_STRIDE (dest);
+    tasks[i].dustride = FRAME_GET_PLANE_STRIDE (dest, 1);
+    tasks[i].s = sy + i * lines_per_thread * tasks[i].sstride;
+    tasks[i].su = suv + i * (lines_per_thread / 2) * tasks[i].sustride;
+    tasks[i].d = dy + i * lines_per_thread * tasks[i].dstride;
+    tasks[i].du = duv + i * (lines_per_thread / 2) * tasks[i].dustride;
 
     tasks[i].width = width;
     tasks[i].height = (i + 1) * lines_per_thread;
     tasks[i].height = MIN (tasks[i].height, height);
     tasks[i].height -= i * lines_per_thread;
-    tasks[i].data = data;
 
     tasks_p[i] = &tasks[i];
   }
 
   gst_parallelized_task_runner_run (convert->conversion_runner,
-      (GstParallelizedTaskFunc) convert_AYUV_ARGB_task, (gpointer) tasks_p);
-
-  convert_fill_border (convert, dest);
-}
-
-static void
-convert_AYUV_BGRA_task (FConvertPlaneTask * task)
-{
-  video_orc_convert_AYUV_BGRA (task->d, task->dstride, task->s,
-      task->sstride, task->data->im[0][0], task->data->im[0][2],
-      task->data->im[2][1], task->data->im[1][1], task->data->im[1][2],
-      task->width, task->height);
+      (GstParallelizedTaskFunc) convert_P010_NV12_task, (gpointer) tasks_p);
 }
 
 static void
-convert_AYUV_BGRA (GstVideoConverter * convert, const GstVideoFrame * src,
-    GstVideoFrame * dest)
+convert_v210_I422_10LE_task (FConvertPlaneTask * task)
 {
-  gint width = convert->in_width;
-  gint height = convert->in_height;
-  MatrixData *data = &convert->convert_matrix;
-  guint8 *s, *d;
-  FConvertPlaneTask *tasks;
-  FConvertPlaneTask **tasks_p;
-  gint n_threads;
-  gint lines_per_thread;
-  gint i;
-
-  s = FRAME_GET_LINE (src, convert->in_y);
-  s += (convert->in_x * 4);
-  d = FRAME_GET_LINE (dest, convert->out_y);
-  d += (convert->out_x * 4);
+  gint i, j;
+  guint16 *d_y, *d_u, *d_v;
+  const guint8 *s;
+  guint32 a0, a1, a2, a3;
 
-  n_threads = convert->conversion_runner->n_threads;
-  tasks = convert->tasks[0] =
-      g_renew (FConvertPlaneTask, convert->tasks[0], n_threads);
-  tasks_p = convert->tasks_p[0] =
-      g_renew (FConvertPlaneTask *, convert->tasks_p[0], n_threads);
+  for (i = 0; i < task->height; i++) {
+    d_y = (guint16 *) (task->d + i * task->dstride);
+    d_u = (guint16 *) (task->du + i * task->dustride);
+    d_v = (guint16 *) (task->dv + i * task->dvstride);
+    s = task->s + i * task->sstride;
 
-  lines_per_thread = (height + n_threads - 1) / n_threads;
+    for (j = 0; j < task->width; j += 6) {
+      a0 = GST_READ_UINT32_LE (s + (j / 6) * 16 + 0);
+      a1 = GST_READ_UINT32_LE (s + (j / 6) * 16 + 4);
+      a2 = GST_READ_UINT32_LE (s + (j / 6) * 16 + 8);
+      a3 = GST_READ_UINT32_LE (s + (j / 6) * 16 + 12);
 
-  for (i = 0; i < n_threads; i++) {
-    tasks[i].dstride = FRAME_GET_STRIDE (dest);
-    tasks[i].sstride = FRAME_GET_STRIDE (src);
-    tasks[i].d = d + i * lines_per_thread * tasks[i].dstride;
-    tasks[i].s = s + i * lines_per_thread * tasks[i].sstride;
+      GST_WRITE_UINT16_LE (d_y + j, (a0 >> 10) & 0x3ff);
+      GST_WRITE_UINT16_LE (d_u + j / 2, a0 & 0x3ff);
+      GST_WRITE_UINT16_LE (d_v + j / 2, (a0 >> 20) & 0x3ff);
 
-    tasks[i].width = width;
-    tasks[i].height = (i + 1) * lines_per_thread;
-    tasks[i].height = MIN (tasks[i].height, height);
-    tasks[i].height -= i * lines_per_thread;
-    tasks[i].data = data;
+      if (j < task->width - 1) {
+        GST_WRITE_UINT16_LE (d_y + j + 1, a1 & 0x3ff);
+      }
 
-    tasks_p[i] = &tasks[i];
-  }
+      if (j < task->width - 2) {
+        GST_WRITE_UINT16_LE (d_y + j + 2, (a1 >> 20) & 0x3ff);
+        GST_WRITE_UINT16_LE (d_u + j / 2 + 1, (a1 >> 10) & 0x3ff);
+        GST_WRITE_UINT16_LE (d_v + j / 2 + 1, a2 & 0x3ff);
+      }
 
-  gst_parallelized_task_runner_run (convert->conversion_runner,
-      (GstParallelizedTaskFunc) convert_AYUV_BGRA_task, (gpointer) tasks_p);
+      if (j < task->width - 3) {
+        GST_WRITE_UINT16_LE (d_y + j + 3, (a2 >> 10) & 0x3ff);
+      }
 
-  convert_fill_border (convert, dest);
-}
+      if (j < task->width - 4) {
+        GST_WRITE_UINT16_LE (d_y + j + 4, a3 & 0x3ff);
+        GST_WRITE_UINT16_LE (d_u + j / 2 + 2, (a2 >> 20) & 0x3ff);
+        GST_WRITE_UINT16_LE (d_v + j / 2 + 2, (a3 >> 10) & 0x3ff);
+      }
 
-static void
-convert_AYUV_ABGR_task (FConvertPlaneTask * task)
-{
-  video_orc_convert_AYUV_ABGR (task->d, task->dstride, task->s,
-      task->sstride, task->data->im[0][0], task->data->im[0][2],
-      task->data->im[2][1], task->data->im[1][1], task->data->im[1][2],
-      task->width, task->height);
+      if (j < task->width - 5) {
+        GST_WRITE_UINT16_LE (d_y + j + 5, (a3 >> 20) & 0x3ff);
+      }
+    }
+  }
 }
 
 static void
-convert_AYUV_ABGR (GstVideoConverter * convert, const GstVideoFrame * src,
+convert_v210_I422_10LE (GstVideoConverter * convert, const GstVideoFrame * src,
     GstVideoFrame * dest)
 {
   gint width = convert->in_width;
   gint height = convert->in_height;
-  MatrixData *data = &convert->convert_matrix;
-  guint8 *s, *d;
+  guint8 *s, *dy, *du, *dv;
   FConvertPlaneTask *tasks;
   FConvertPlaneTask **tasks_p;
   gint n_threads;
@@ -6101,9 +6157,9 @@ convert_AYUV_ABGR (GstVideoConverter * convert, const GstVideoFrame * src,
   gint i;
 
   s = FRAME_GET_LINE (src, convert->in_y);
-  s += (convert->in_x * 4);
-  d = FRAME_GET_LINE (dest, convert->out_y);
-  d += (convert->out_x * 4);
+  dy = FRAME_GET_Y_LINE (dest, convert->out_y);
+  du = FRAME_GET_U_LINE (dest, convert->out_y);
+  dv = FRAME_GET_V_LINE (dest, convert->out_y);
 
   n_threads = convert->conversion_runner->n_threads;
   tasks = convert->tasks[0] =
@@ -6114,30 +6170,665 @@ convert_AYUV_ABGR (GstVideoConverter * convert, const GstVideoFrame * src,
   lines_per_thread = (height + n_threads - 1) / n_threads;
 
   for (i = 0; i < n_threads; i++) {
-    tasks[i].dstride = FRAME_GET_STRIDE (dest);
+    tasks[i].dstride = FRAME_GET_Y_STRIDE (dest);
+    tasks[i].dustride = FRAME_GET_U_STRIDE (dest);
+    tasks[i].dvstride = FRAME_GET_V_STRIDE (dest);
     tasks[i].sstride = FRAME_GET_STRIDE (src);
-    tasks[i].d = d + i * lines_per_thread * tasks[i].dstride;
+    tasks[i].d = dy + i * lines_per_thread * tasks[i].dstride;
+    tasks[i].du = du + i * lines_per_thread * tasks[i].dustride;
+    tasks[i].dv = dv + i * lines_per_thread * tasks[i].dvstride;
     tasks[i].s = s + i * lines_per_thread * tasks[i].sstride;
 
     tasks[i].width = width;
     tasks[i].height = (i + 1) * lines_per_thread;
     tasks[i].height = MIN (tasks[i].height, height);
     tasks[i].height -= i * lines_per_thread;
-    tasks[i].data = data;
 
     tasks_p[i] = &tasks[i];
   }
 
   gst_parallelized_task_runner_run (convert->conversion_runner,
-      (GstParallelizedTaskFunc) convert_AYUV_ABGR_task, (gpointer) tasks_p);
-
-  convert_fill_border (convert, dest);
+      (GstParallelizedTaskFunc) convert_v210_I422_10LE_task,
+      (gpointer) tasks_p);
 }
 
 static void
-convert_AYUV_RGBA_task (FConvertPlaneTask * task)
+convert_I422_10LE_v210_task (FConvertPlaneTask * task)
 {
-  video_orc_convert_AYUV_RGBA (task->d, task->dstride, task->s,
+  gint i, j;
+  guint8 *d;
+  const guint16 *s_y, *s_u, *s_v;
+  guint32 a0, a1, a2, a3;
+  guint16 y0, y1, y2, y3, y4, y5;
+  guint16 u0, u2, u4;
+  guint16 v0, v2, v4;
+
+  for (i = 0; i < task->height; i++) {
+    d = task->d + i * task->dstride;
+    s_y = (const guint16 *) (task->s + i * task->sstride);
+    s_u = (const guint16 *) (task->su + i * task->sustride);
+    s_v = (const guint16 *) (task->sv + i * task->svstride);
+
+    for (j = 0; j < task->width; j += 6) {
+      y1 = y2 = y3 = y4 = y5 = 0;
+      u2 = u4 = v2 = v4 = 0;
+
+      y0 = GST_READ_UINT16_LE (s_y + j) & 0x3ff;
+      u0 = GST_READ_UINT16_LE (s_u + j / 2) & 0x3ff;
+      v0 = GST_READ_UINT16_LE (s_v + j / 2) & 0x3ff;
+
+      if (j < task->width - 1) {
+        y1 = GST_READ_UINT16_LE (s_y + j + 1) & 0x3ff;
+      }
+
+      if (j < task->width - 2) {
+        y2 = GST_READ_UINT16_LE (s_y + j + 2) & 0x3ff;
+        u2 = GST_READ_UINT16_LE (s_u + j / 2 + 1) & 0x3ff;
+        v2 = GST_READ_UINT16_LE (s_v + j / 2 + 1) & 0x3ff;
+      }
+
+      if (j < task->width - 3) {
+        y3 = GST_READ_UINT16_LE (s_y + j + 3) & 0x3ff;
+      }
+
+      if (j < task->width - 4) {
+        y4 = GST_READ_UINT16_LE (s_y + j + 4) & 0x3ff;
+        u4 = GST_READ_UINT16_LE (s_u + j / 2 + 2) & 0x3ff;
+        v4 = GST_READ_UINT16_LE (s_v + j / 2 + 2) & 0x3ff;
+      }
+
+      if (j < task->width - 5) {
+        y5 = GST_READ_UINT16_LE (s_y + j + 5) & 0x3ff;
+      }
+
+      a0 = u0 | (y0 << 10) | (v0 << 20);
+      a1 = y1 | (u2 << 10) | (y2 << 20);
+      a2 = v2 | (y3 << 10) | (u4 << 20);
+      a3 = y4 | (v4 << 10) | (y5 << 20);
+
+      GST_WRITE_UINT32_LE (d + (j / 6) * 16 + 0, a0);
+      GST_WRITE_UINT32_LE (d + (j / 6) * 16 + 4, a1);
+      GST_WRITE_UINT32_LE (d + (j / 6) * 16 + 8, a2);
+      GST_WRITE_UINT32_LE (d + (j / 6) * 16 + 12, a3);
+    }
+  }
+}
+
+static void
+convert_I422_10LE_v210 (GstVideoConverter * convert, const GstVideoFrame * src,
+    GstVideoFrame * dest)
+{
+  gint width = convert->in_width;
+  gint height = convert->in_height;
+  guint8 *d, *sy, *su, *sv;
+  FConvertPlaneTask *tasks;
+  FConvertPlaneTask **tasks_p;
+  gint n_threads;
+  gint lines_per_thread;
+  gint i;
+
+  d = FRAME_GET_LINE (dest, convert->out_y);
+  sy = FRAME_GET_Y_LINE (src, convert->in_y);
+  su = FRAME_GET_U_LINE (src, convert->in_y);
+  sv = FRAME_GET_V_LINE (src, convert->in_y);
+
+  n_threads = convert->conversion_runner->n_threads;
+  tasks = convert->tasks[0] =
+      g_renew (FConvertPlaneTask, convert->tasks[0], n_threads);
+  tasks_p = convert->tasks_p[0] =
+      g_renew (FConvertPlaneTask *, convert->tasks_p[0], n_threads);
+
+  lines_per_thread = (height + n_threads - 1) / n_threads;
+
+  for (i = 0; i < n_threads; i++) {
+    tasks[i].dstride = FRAME_GET_STRIDE (dest);
+    tasks[i].sstride = FRAME_GET_Y_STRIDE (src);
+    tasks[i].sustride = FRAME_GET_U_STRIDE (src);
+    tasks[i].svstride = FRAME_GET_V_STRIDE (src);
+    tasks[i].d = d + i * lines_per_thread * tasks[i].dstride;
+    tasks[i].s = sy + i * lines_per_thread * tasks[i].sstride;
+    tasks[i].su = su + i * lines_per_thread * tasks[i].sustride;
+    tasks[i].sv = sv + i * lines_per_thread * tasks[i].svstride;
+
+    tasks[i].width = width;
+    tasks[i].height = (i + 1) * lines_per_thread;
+    tasks[i].height = MIN (tasks[i].height, height);
+    tasks[i].height -= i * lines_per_thread;
+
+    tasks_p[i] = &tasks[i];
+  }
+
+  gst_parallelized_task_runner_run (convert->conversion_runner,
+      (GstParallelizedTaskFunc) convert_I422_10LE_v210_task,
+      (gpointer) tasks_p);
+}
+
+static void
+convert_Y210_I422_10LE_task (FConvertPlaneTask * task)
+{
+  gint i, j;
+  gint width = task->width;
+
+  for (i = 0; i < task->height; i++) {
+    const guint16 *s = (const guint16 *) (task->s + i * task->sstride);
+    guint16 *d_y = (guint16 *) (task->d + i * task->dstride);
+    guint16 *d_u = (guint16 *) (task->du + i * task->dustride);
+    guint16 *d_v = (guint16 *) (task->dv + i * task->dvstride);
+
+    for (j = 0; j < width / 2; j++) {
+      GST_WRITE_UINT16_LE (d_y + 2 * j, GST_READ_UINT16_LE (s + 4 * j) >> 6);
+      GST_WRITE_UINT16_LE (d_u + j, GST_READ_UINT16_LE (s + 4 * j + 1) >> 6);
+      GST_WRITE_UINT16_LE (d_y + 2 * j + 1,
+          GST_READ_UINT16_LE (s + 4 * j + 2) >> 6);
+      GST_WRITE_UINT16_LE (d_v + j, GST_READ_UINT16_LE (s + 4 * j + 3) >> 6);
+    }
+    if (width & 1) {
+      GST_WRITE_UINT16_LE (d_y + 2 * j, GST_READ_UINT16_LE (s + 4 * j) >> 6);
+      GST_WRITE_UINT16_LE (d_u + j, GST_READ_UINT16_LE (s + 4 * j + 1) >> 6);
+      GST_WRITE_UINT16_LE (d_v + j, GST_READ_UINT16_LE (s + 4 * j + 3) >> 6);
+    }
+  }
+}
+
+static void
+convert_Y210_I422_10LE (GstVideoConverter * convert, const GstVideoFrame * src,
+    GstVideoFrame * dest)
+{
+  gint width = convert->in_width;
+  gint height = convert->in_height;
+  guint8 *s, *dy, *du, *dv;
+  FConvertPlaneTask *tasks;
+  FConvertPlaneTask **tasks_p;
+  gint n_threads;
+  gint lines_per_thread;
+  gint i;
+
+  s = FRAME_GET_LINE (src, convert->in_y);
+  dy = FRAME_GET_Y_LINE (dest, convert->out_y);
+  du = FRAME_GET_U_LINE (dest, convert->out_y);
+  dv = FRAME_GET_V_LINE (dest, convert->out_y);
+
+  n_threads = convert->conversion_runner->n_threads;
+  tasks = convert->tasks[0] =
+      g_renew (FConvertPlaneTask, convert->tasks[0], n_threads);
+  tasks_p = convert->tasks_p[0] =
+      g_renew (FConvertPlaneTask *, convert->tasks_p[0], n_threads);
+
+  lines_per_thread = (height + n_threads - 1) / n_threads;
+
+  for (i = 0; i < n_threads; i++) {
+    tasks[i].dstride = FRAME_GET_Y_STRIDE (dest);
+    tasks[i].dustride = FRAME_GET_U_STRIDE (dest);
+    tasks[i].dvstride = FRAME_GET_V_STRIDE (dest);
+    tasks[i].sstride = FRAME_GET_STRIDE (src);
+    tasks[i].d = dy + i * lines_per_thread * tasks[i].dstride;
+    tasks[i].du = du + i * lines_per_thread * tasks[i].dustride;
+    tasks[i].dv = dv + i * lines_per_thread * tasks[i].dvstride;
+    tasks[i].s = s + i * lines_per_thread * tasks[i].sstride;
+
+    tasks[i].width = width;
+    tasks[i].height = (i + 1) * lines_per_thread;
+    tasks[i].height = MIN (tasks[i].height, height);
+    tasks[i].height -= i * lines_per_thread;
+
+    tasks_p[i] = &tasks[i];
+  }
+
+  gst_parallelized_task_runner_run (convert->conversion_runner,
+      (GstParallelizedTaskFunc) convert_Y210_I422_10LE_task,
+      (gpointer) tasks_p);
+}
+
+static void
+convert_I422_10LE_Y210_task (FConvertPlaneTask * task)
+{
+  gint i, j;
+  gint width = task->width;
+
+  for (i = 0; i < task->height; i++) {
+    const guint16 *s_y = (const guint16 *) (task->s + i * task->sstride);
+    const guint16 *s_u = (const guint16 *) (task->su + i * task->sustride);
+    const guint16 *s_v = (const guint16 *) (task->sv + i * task->svstride);
+    guint16 *d = (guint16 *) (task->d + i * task->dstride);
+
+    for (j = 0; j < width / 2; j++) {
+      GST_WRITE_UINT16_LE (d + 4 * j, GST_READ_UINT16_LE (s_y + 2 * j) << 6);
+      GST_WRITE_UINT16_LE (d + 4 * j + 1, GST_READ_UINT16_LE (s_u + j) << 6);
+      GST_WRITE_UINT16_LE (d + 4 * j + 2,
+          GST_READ_UINT16_LE (s_y + 2 * j + 1) << 6);
+      GST_WRITE_UINT16_LE (d + 4 * j + 3, GST_READ_UINT16_LE (s_v + j) << 6);
+    }
+    /* like the pack function, repeat the last luma sample */
+    if (width & 1) {
+      GST_WRITE_UINT16_LE (d + 4 * j, GST_READ_UINT16_LE (s_y + 2 * j) << 6);
+      GST_WRITE_UINT16_LE (d + 4 * j + 1, GST_READ_UINT16_LE (s_u + j) << 6);
+      GST_WRITE_UINT16_LE (d + 4 * j + 2,
+          GST_READ_UINT16_LE (s_y + 2 * j) << 6);
+      GST_WRITE_UINT16_LE (d + 4 * j + 3, GST_READ_UINT16_LE (s_v + j) << 6);
+    }
+  }
+}
+
+static void
+convert_I422_10LE_Y210 (GstVideoConverter * convert, const GstVideoFrame * src,
+    GstVideoFrame * dest)
+{
+  gint width = convert->in_width;
+  gint height = convert->in_height;
+  guint8 *d, *sy, *su, *sv;
+  FConvertPlaneTask *tasks;
+  FConvertPlaneTask **tasks_p;
+  gint n_threads;
+  gint lines_per_thread;
+  gint i;
+
+  d = FRAME_GET_LINE (dest, convert->out_y);
+  sy = FRAME_GET_Y_LINE (src, convert->in_y);
+  su = FRAME_GET_U_LINE (src, convert->in_y);
+  sv = FRAME_GET_V_LINE (src, convert->in_y);
+
+  n_threads = convert->conversion_runner->n_threads;
+  tasks = convert->tasks[0] =
+      g_renew (FConvertPlaneTask, convert->tasks[0], n_threads);
+  tasks_p = convert->tasks_p[0] =
+      g_renew (FConvertPlaneTask *, convert->tasks_p[0], n_threads);
+
+  lines_per_thread = (height + n_threads - 1) / n_threads;
+
+  for (i = 0; i < n_threads; i++) {
+    tasks[i].dstride = FRAME_GET_STRIDE (dest);
+    tasks[i].sstride = FRAME_GET_Y_STRIDE (src);
+    tasks[i].sustride = FRAME_GET_U_STRIDE (src);
+    tasks[i].svstride = FRAME_GET_V_STRIDE (src);
+    tasks[i].d = d + i * lines_per_thread * tasks[i].dstride;
+    tasks[i].s = sy + i * lines_per_thread * tasks[i].sstride;
+    tasks[i].su = su + i * lines_per_thread * tasks[i].sustride;
+    tasks[i].sv = sv + i * lines_per_thread * tasks[i].svstride;
+
+    tasks[i].width = width;
+    tasks[i].height = (i + 1) * lines_per_thread;
+    tasks[i].height = MIN (tasks[i].height, height);
+    tasks[i].height -= i * lines_per_thread;
+
+    tasks_p[i] = &tasks[i];
+  }
+
+  gst_parallelized_task_runner_run (convert->conversion_runner,
+      (GstParallelizedTaskFunc) convert_I422_10LE_Y210_task,
+      (gpointer) tasks_p);
+}
+
+static void
+convert_Y444_YUY2_task (FConvertPlaneTask * task)
+{
+  video_orc_convert_Y444_YUY2 (task->d, task->dstride, task->s,
+      task->sstride,
+      task->su,
+      task->sustride, task->sv, task->svstride, task->width / 2, task->height);
+}
+
+static void
+convert_Y444_YUY2 (GstVideoConverter * convert, const GstVideoFrame * src,
+    GstVideoFrame * dest)
+{
+  gint width = convert->in_width;
+  gint height = convert->in_height;
+  guint8 *sy, *su, *sv, *d;
+  FConvertPlaneTask *tasks;
+  FConvertPlaneTask **tasks_p;
+  gint n_threads;
+  gint lines_per_thread;
+  gint i;
+
+  sy = FRAME_GET_Y_LINE (src, convert->in_y);
+  sy += convert->in_x;
+  su = FRAME_GET_U_LINE (src, convert->in_y);
+  su += convert->in_x;
+  sv = FRAME_GET_V_LINE (src, convert->in_y);
+  sv += convert->in_x;
+
+  d = FRAME_GET_LINE (dest, convert->out_y);
+  d += (GST_ROUND_UP_2 (convert->out_x) * 2);
+
+  n_threads = convert->conversion_runner->n_threads;
+  tasks = convert->tasks[0] =
+      g_renew (FConvertPlaneTask, convert->tasks[0], n_threads);
+  tasks_p = convert->tasks_p[0] =
+      g_renew (FConvertPlaneTask *, convert->tasks_p[0], n_threads);
+
+  lines_per_thread = (height + n_threads - 1) / n_threads;
+
+  for (i = 0; i < n_threads; i++) {
+    tasks[i].dstride = FRAME_GET_STRIDE (dest);
+    tasks[i].sstride = FRAME_GET_Y_STRIDE (src);
+    tasks[i].sustride = FRAME_GET_U_STRIDE (src);
+    tasks[i].svstride = FRAME_GET_V_STRIDE (src);
+    tasks[i].d = d + i * lines_per_thread * tasks[i].dstride;
+    tasks[i].s = sy + i * lines_per_thread * tasks[i].sstride;
+    tasks[i].su = su + i * lines_per_thread * tasks[i].sustride;
+    tasks[i].sv = sv + i * lines_per_thread * tasks[i].svstride;
+
+    tasks[i].width = width;
+    tasks[i].height = (i + 1) * lines_per_thread;
+    tasks[i].height = MIN (tasks[i].height, height);
+    tasks[i].height -= i * lines_per_thread;
+
+    tasks_p[i] = &tasks[i];
+  }
+
+  gst_parallelized_task_runner_run (convert->conversion_runner,
+      (GstParallelizedTaskFunc) convert_Y444_YUY2_task, (gpointer) tasks_p);
+
+  convert_fill_border (convert, dest);
+}
+
+static void
+convert_Y444_UYVY_task (FConvertPlaneTask * task)
+{
+  video_orc_convert_Y444_UYVY (task->d, task->dstride, task->s,
+      task->sstride,
+      task->su,
+      task->sustride, task->sv, task->svstride, task->width / 2, task->height);
+}
+
+static void
+convert_Y444_UYVY (GstVideoConverter * convert, const GstVideoFrame * src,
+    GstVideoFrame * dest)
+{
+  gint width = convert->in_width;
+  gint height = convert->in_height;
+  guint8 *sy, *su, *sv, *d;
+  FConvertPlaneTask *tasks;
+  FConvertPlaneTask **tasks_p;
+  gint n_threads;
+  gint lines_per_thread;
+  gint i;
+
+  sy = FRAME_GET_Y_LINE (src, convert->in_y);
+  sy += convert->in_x;
+  su = FRAME_GET_U_LINE (src, convert->in_y);
+  su += convert->in_x;
+  sv = FRAME_GET_V_LINE (src, convert->in_y);
+  sv += convert->in_x;
+
+  d = FRAME_GET_LINE (dest, convert->out_y);
+  d += (GST_ROUND_UP_2 (convert->out_x) * 2);
+
+  n_threads = convert->conversion_runner->n_threads;
+  tasks = convert->tasks[0] =
+      g_renew (FConvertPlaneTask, convert->tasks[0], n_threads);
+  tasks_p = convert->tasks_p[0] =
+      g_renew (FConvertPlaneTask *, convert->tasks_p[0], n_threads);
+
+  lines_per_thread = (height + n_threads - 1) / n_threads;
+
+  for (i = 0; i < n_threads; i++) {
+    tasks[i].dstride = FRAME_GET_STRIDE (dest);
+    tasks[i].sstride = FRAME_GET_Y_STRIDE (src);
+    tasks[i].sustride = FRAME_GET_U_STRIDE (src);
+    tasks[i].svstride = FRAME_GET_V_STRIDE (src);
+    tasks[i].d = d + i * lines_per_thread * tasks[i].dstride;
+    tasks[i].s = sy + i * lines_per_thread * tasks[i].sstride;
+    tasks[i].su = su + i * lines_per_thread * tasks[i].sustride;
+    tasks[i].sv = sv + i * lines_per_thread * tasks[i].svstride;
+
+    tasks[i].width = width;
+    tasks[i].height = (i + 1) * lines_per_thread;
+    tasks[i].height = MIN (tasks[i].height, height);
+    tasks[i].height -= i * lines_per_thread;
+
+    tasks_p[i] = &tasks[i];
+  }
+
+  gst_parallelized_task_runner_run (convert->conversion_runner,
+      (GstParallelizedTaskFunc) convert_Y444_UYVY_task, (gpointer) tasks_p);
+
+  convert_fill_border (convert, dest);
+}
+
+static void
+convert_Y444_AYUV_task (FConvertPlaneTask * task)
+{
+  video_orc_convert_Y444_AYUV (task->d, task->dstride, task->s,
+      task->sstride,
+      task->su,
+      task->sustride,
+      task->sv, task->svstride, task->alpha, task->width, task->height);
+}
+
+static void
+convert_Y444_AYUV (GstVideoConverter * convert, const GstVideoFrame * src,
+    GstVideoFrame * dest)
+{
+  gint width = convert->in_width;
+  gint height = convert->in_height;
+  guint8 *sy, *su, *sv, *d;
+  guint8 alpha = MIN (convert->alpha_value, 255);
+  FConvertPlaneTask *tasks;
+  FConvertPlaneTask **tasks_p;
+  gint n_threads;
+  gint lines_per_thread;
+  gint i;
+
+  sy = FRAME_GET_Y_LINE (src, convert->in_y);
+  sy += convert->in_x;
+  su = FRAME_GET_U_LINE (src, convert->in_y);
+  su += convert->in_x;
+  sv = FRAME_GET_V_LINE (src, convert->in_y);
+  sv += convert->in_x;
+
+  d = FRAME_GET_LINE (dest, convert->out_y);
+  d += convert->out_x * 4;
+
+  n_threads = convert->conversion_runner->n_threads;
+  tasks = convert->tasks[0] =
+      g_renew (FConvertPlaneTask, convert->tasks[0], n_threads);
+  tasks_p = convert->tasks_p[0] =
+      g_renew (FConvertPlaneTask *, convert->tasks_p[0], n_threads);
+
+  lines_per_thread = (height + n_threads - 1) / n_threads;
+
+  for (i = 0; i < n_threads; i++) {
+    tasks[i].dstride = FRAME_GET_STRIDE (dest);
+    tasks[i].sstride = FRAME_GET_Y_STRIDE (src);
+    tasks[i].sustride = FRAME_GET_U_STRIDE (src);
+    tasks[i].svstride = FRAME_GET_V_STRIDE (src);
+    tasks[i].d = d + i * lines_per_thread * tasks[i].dstride;
+    tasks[i].s = sy + i * lines_per_thread * tasks[i].sstride;
+    tasks[i].su = su + i * lines_per_thread * tasks[i].sustride;
+    tasks[i].sv = sv + i * lines_per_thread * tasks[i].svstride;
+
+    tasks[i].width = width;
+    tasks[i].height = (i + 1) * lines_per_thread;
+    tasks[i].height = MIN (tasks[i].height, height);
+    tasks[i].height -= i * lines_per_thread;
+    tasks[i].alpha = alpha;
+
+    tasks_p[i] = &tasks[i];
+  }
+
+  gst_parallelized_task_runner_run (convert->conversion_runner,
+      (GstParallelizedTaskFunc) convert_Y444_AYUV_task, (gpointer) tasks_p);
+
+  convert_fill_border (convert, dest);
+}
+
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+static void
+convert_AYUV_ARGB_task (FConvertPlaneTask * task)
+{
+  video_orc_convert_AYUV_ARGB (task->d, task->dstride, task->s,
+      task->sstride, task->data->im[0][0], task->data->im[0][2],
+      task->data->im[2][1], task->data->im[1][1], task->data->im[1][2],
+      task->width, task->height);
+}
+
+static void
+convert_AYUV_ARGB (GstVideoConverter * convert, const GstVideoFrame * src,
+    GstVideoFrame * dest)
+{
+  gint width = convert->in_width;
+  gint height = convert->in_height;
+  MatrixData *data = &convert->convert_matrix;
+  guint8 *s, *d;
+  FConvertPlaneTask *tasks;
+  FConvertPlaneTask **tasks_p;
+  gint n_threads;
+  gint lines_per_thread;
+  gint i;
+
+  s = FRAME_GET_LINE (src, convert->in_y);
+  s += (convert->in_x * 4);
+  d = FRAME_GET_LINE (dest, convert->out_y);
+  d += (convert->out_x * 4);
+
+  n_threads = convert->conversion_runner->n_threads;
+  tasks = convert->tasks[0] =
+      g_renew (FConvertPlaneTask, convert->tasks[0], n_threads);
+  tasks_p = convert->tasks_p[0] =
+      g_renew (FConvertPlaneTask *, convert->tasks_p[0], n_threads);
+
+  lines_per_thread = (height + n_threads - 1) / n_threads;
+
+  for (i = 0; i < n_threads; i++) {
+    tasks[i].dstride = FRAME_GET_STRIDE (dest);
+    tasks[i].sstride = FRAME_GET_STRIDE (src);
+    tasks[i].d = d + i * lines_per_thread * tasks[i].dstride;
+    tasks[i].s = s + i * lines_per_thread * tasks[i].sstride;
+
+    tasks[i].width = width;
+    tasks[i].height = (i + 1) * lines_per_thread;
+    tasks[i].height = MIN (tasks[i].height, height);
+    tasks[i].height -= i * lines_per_thread;
+    tasks[i].data = data;
+
+    tasks_p[i] = &tasks[i];
+  }
+
+  gst_parallelized_task_runner_run (convert->conversion_runner,
+      (GstParallelizedTaskFunc) convert_AYUV_ARGB_task, (gpointer) tasks_p);
+
+  convert_fill_border (convert, dest);
+}
+
+static void
+convert_AYUV_BGRA_task (FConvertPlaneTask * task)
+{
+  video_orc_convert_AYUV_BGRA (task->d, task->dstride, task->s,
+      task->sstride, task->data->im[0][0], task->data->im[0][2],
+      task->data->im[2][1], task->data->im[1][1], task->data->im[1][2],
+      task->width, task->height);
+}
+
+static void
+convert_AYUV_BGRA (GstVideoConverter * convert, const GstVideoFrame * src,
+    GstVideoFrame * dest)
+{
+  gint width = convert->in_width;
+  gint height = convert->in_height;
+  MatrixData *data = &convert->convert_matrix;
+  guint8 *s, *d;
+  FConvertPlaneTask *tasks;
+  FConvertPlaneTask **tasks_p;
+  gint n_threads;
+  gint lines_per_thread;
+  gint i;
+
+  s = FRAME_GET_LINE (src, convert->in_y);
+  s += (convert->in_x * 4);
+  d = FRAME_GET_LINE (dest, convert->out_y);
+  d += (convert->out_x * 4);
+
+  n_threads = convert->conversion_runner->n_threads;
+  tasks = convert->tasks[0] =
+      g_renew (FConvertPlaneTask, convert->tasks[0], n_threads);
+  tasks_p = convert->tasks_p[0] =
+      g_renew (FConvertPlaneTask *, convert->tasks_p[0], n_threads);
+
+  lines_per_thread = (height + n_threads - 1) / n_threads;
+
+  for (i = 0; i < n_threads; i++) {
+    tasks[i].dstride = FRAME_GET_STRIDE (dest);
+    tasks[i].sstride = FRAME_GET_STRIDE (src);
+    tasks[i].d = d + i * lines_per_thread * tasks[i].dstride;
+    tasks[i].s = s + i * lines_per_thread * tasks[i].sstride;
+
+    tasks[i].width = width;
+    tasks[i].height = (i + 1) * lines_per_thread;
+    tasks[i].height = MIN (tasks[i].height, height);
+    tasks[i].height -= i * lines_per_thread;
+    tasks[i].data = data;
+
+    tasks_p[i] = &tasks[i];
+  }
+
+  gst_parallelized_task_runner_run (convert->conversion_runner,
+      (GstParallelizedTaskFunc) convert_AYUV_BGRA_task, (gpointer) tasks_p);
+
+  convert_fill_border (convert, dest);
+}
+
+static void
+convert_AYUV_ABGR_task (FConvertPlaneTask * task)
+{
+  video_orc_convert_AYUV_ABGR (task->d, task->dstride, task->s,
+      task->sstride, task->data->im[0][0], task->data->im[0][2],
+      task->data->im[2][1], task->data->im[1][1], task->data->im[1][2],
+      task->width, task->height);
+}
+
+static void
+convert_AYUV_ABGR (GstVideoConverter * convert, const GstVideoFrame * src,
+    GstVideoFrame * dest)
+{
+  gint width = convert->in_width;
+  gint height = convert->in_height;
+  MatrixData *data = &convert->convert_matrix;
+  guint8 *s, *d;
+  FConvertPlaneTask *tasks;
+  FConvertPlaneTask **tasks_p;
+  gint n_threads;
+  gint lines_per_thread;
+  gint i;
+
+  s = FRAME_GET_LINE (src, convert->in_y);
+  s += (convert->in_x * 4);
+  d = FRAME_GET_LINE (dest, convert->out_y);
+  d += (convert->out_x * 4);
+
+  n_threads = convert->conversion_runner->n_threads;
+  tasks = convert->tasks[0] =
+      g_renew (FConvertPlaneTask, convert->tasks[0], n_threads);
+  tasks_p = convert->tasks_p[0] =
+      g_renew (FConvertPlaneTask *, convert->tasks_p[0], n_threads);
+
+  lines_per_thread = (height + n_threads - 1) / n_threads;
+
+  for (i = 0; i < n_threads; i++) {
+    tasks[i].dstride = FRAME_GET_STRIDE (dest);
+    tasks[i].sstride = FRAME_GET_STRIDE (src);
+    tasks[i].d = d + i * lines_per_thread * tasks[i].dstride;
+    tasks[i].s = s + i * lines_per_thread * tasks[i].sstride;
+
+    tasks[i].width = width;
+    tasks[i].height = (i + 1) * lines_per_thread;
+    tasks[i].height = MIN (tasks[i].height, height);
+    tasks[i].height -= i * lines_per_thread;
+    tasks[i].data = data;
+
+    tasks_p[i] = &tasks[i];
+  }
+
+  gst_parallelized_task_runner_run (convert->conversion_runner,
+      (GstParallelizedTaskFunc) convert_AYUV_ABGR_task, (gpointer) tasks_p);
+
+  convert_fill_border (convert, dest);
+}
+
+static void
+convert_AYUV_RGBA_task (FConvertPlaneTask * task)
+{
+  video_orc_convert_AYUV_RGBA (task->d, task->dstride, task->s,
       task->sstride, task->data->im[0][0], task->data->im[0][2],
       task->data->im[2][1], task->data->im[1][1], task->data->im[1][2],
       task->width, task->height);
@@ -6601,6 +7292,117 @@ convert_A420_BGRA (GstVideoConverter * convert, const GstVideoFrame * src,
   convert_fill_border (convert, dest);
 }
 
+static void
+convert_I420_10LE_pack_ARGB_task (FConvertTask * task)
+{
+  gint i, j;
+  gpointer d[GST_VIDEO_MAX_PLANES];
+  const GstVideoFormatInfo *finfo = task->src->info.finfo;
+  gint depth, shift, cstep;
+  gint in_x = task->in_x;
+  MatrixData *data = task->data;
+
+  d[0] = FRAME_GET_LINE (task->dest, 0);
+  d[0] =
+      (guint8 *) d[0] +
+      task->out_x * GST_VIDEO_FORMAT_INFO_PSTRIDE (task->dest->info.finfo, 0);
+
+  /* expand the samples to 16 bits like the unpack functions do, P01x keeps
+   * them in the high bits already and interleaves the chroma samples */
+  depth = GST_VIDEO_FORMAT_INFO_DEPTH (finfo, 0);
+  shift = 16 - depth - GST_VIDEO_FORMAT_INFO_SHIFT (finfo, 0);
+  cstep = GST_VIDEO_FORMAT_INFO_N_PLANES (finfo) == 2 ? 2 : 1;
+
+  for (i = task->height_0; i < task->height_1; i++) {
+    const guint16 *sy, *su, *sv;
+    guint8 *t = (guint8 *) task->tmpline;
+
+    sy = FRAME_GET_Y_LINE (task->src, i + task->in_y);
+    su = FRAME_GET_U_LINE (task->src, (i + task->in_y) >> 1);
+    sv = FRAME_GET_V_LINE (task->src, (i + task->in_y) >> 1);
+
+    for (j = 0; j < task->width; j++) {
+      gint c = ((in_x + j) >> 1) * cstep;
+      guint16 y, u, v;
+      gint r, g, b;
+
+      y = GST_READ_UINT16_LE (sy + in_x + j) << shift;
+      u = GST_READ_UINT16_LE (su + c) << shift;
+      v = GST_READ_UINT16_LE (sv + c) << shift;
+      y |= y >> depth;
+      u |= u >> depth;
+      v |= v >> depth;
+
+      /* same as the 16 bits matrix followed by the reduction to 8 bits */
+      r = (data->im[0][0] * y + data->im[0][1] * u +
+          data->im[0][2] * v + data->im[0][3]) >> SCALE;
+      g = (data->im[1][0] * y + data->im[1][1] * u +
+          data->im[1][2] * v + data->im[1][3]) >> SCALE;
+      b = (data->im[2][0] * y + data->im[2][1] * u +
+          data->im[2][2] * v + data->im[2][3]) >> SCALE;
+
+      t[j * 4 + 0] = 0xff;
+      t[j * 4 + 1] = CLAMP (r, 0, 65535) >> 8;
+      t[j * 4 + 2] = CLAMP (g, 0, 65535) >> 8;
+      t[j * 4 + 3] = CLAMP (b, 0, 65535) >> 8;
+    }
+
+    task->dest->info.finfo->pack_func (task->dest->info.finfo,
+        (GST_VIDEO_FRAME_IS_INTERLACED (task->dest) ?
+            GST_VIDEO_PACK_FLAG_INTERLACED :
+            GST_VIDEO_PACK_FLAG_NONE),
+        task->tmpline, 0, d, task->dest->info.stride,
+        task->dest->info.chroma_site, i + task->out_y, task->width);
+  }
+}
+
+static void
+convert_I420_10LE_pack_ARGB (GstVideoConverter * convert,
+    const GstVideoFrame * src, GstVideoFrame * dest)
+{
+  int i;
+  gint width = convert->in_width;
+  gint height = convert->in_height;
+  MatrixData *data = &convert->convert_matrix;
+  FConvertTask *tasks;
+  FConvertTask **tasks_p;
+  gint n_threads;
+  gint lines_per_thread;
+
+  n_threads = convert->conversion_runner->n_threads;
+  tasks = convert->tasks[0] =
+      g_renew (FConvertTask, convert->tasks[0], n_threads);
+  tasks_p = convert->tasks_p[0] =
+      g_renew (FConvertTask *, convert->tasks_p[0], n_threads);
+
+  lines_per_thread = (height + n_threads - 1) / n_threads;
+
+  for (i = 0; i < n_threads; i++) {
+    tasks[i].src = src;
+    tasks[i].dest = dest;
+
+    tasks[i].width = width;
+    tasks[i].data = data;
+    tasks[i].in_x = convert->in_x;
+    tasks[i].in_y = convert->in_y;
+    tasks[i].out_x = convert->out_x;
+    tasks[i].out_y = convert->out_y;
+    tasks[i].tmpline = convert->tmpline[i];
+
+    tasks[i].height_0 = i * lines_per_thread;
+    tasks[i].height_1 = tasks[i].height_0 + lines_per_thread;
+    tasks[i].height_1 = MIN (height, tasks[i].height_1);
+
+    tasks_p[i] = &tasks[i];
+  }
+
+  gst_parallelized_task_runner_run (convert->conversion_runner,
+      (GstParallelizedTaskFunc) convert_I420_10LE_pack_ARGB_task,
+      (gpointer) tasks_p);
+
+  convert_fill_border (convert, dest);
+}
+
 static void
 memset_u24 (guint8 * data, guint8 col[3], unsigned int n)
 {
@@ -7138,6 +7940,7 @@ typedef struct
   guint8 *d;
   gint sstride, dstride;
   guint x, y, w, h;
+  guint16 max;
 } FScaleTask;
 
 static void
@@ -7146,6 +7949,20 @@ convert_plane_hv_task (FScaleTask * task)
   gst_video_scaler_2d (task->h_scaler, task->v_scaler, task->format,
       (guint8 *) task->s, task->sstride,
       task->d, task->dstride, task->x, task->y, task->w, task->h);
+
+  /* the filters can overshoot the range of samples with less than 16 bits
+   * and set their unused low bits, bring them back to valid values */
+  if (task->max) {
+    guint i, j, n;
+
+    n = task->w * (task->format == GST_VIDEO_FORMAT_P016_LE ? 2 : 1);
+    for (i = task->y; i < task->h; i++) {
+      guint16 *d = (guint16 *) (task->d + i * task->dstride);
+
+      for (j = 0; j < n; j++)
+        d[j] = MIN (d[j], task->max) & task->max;
+    }
+  }
 }
 
 static void
@@ -7197,6 +8014,7 @@ convert_plane_hv (GstVideoConverter * convert,
     tasks[i].d = d;
     tasks[i].sstride = sstride;
     tasks[i].dstride = dstride;
+    tasks[i].max = convert->fmax[plane];
 
     tasks[i].x = 0;
     tasks[i].w = out_width;
@@ -7251,6 +8069,19 @@ get_scale_format (GstVideoFormat format, gint plane)
     case GST_VIDEO_FORMAT_GRAY16_LE:
       res = GST_VIDEO_FORMAT_GRAY16_BE;
       break;
+    case GST_VIDEO_FORMAT_I420_10LE:
+    case GST_VIDEO_FORMAT_I422_10LE:
+    case GST_VIDEO_FORMAT_Y444_10LE:
+    case GST_VIDEO_FORMAT_I420_12LE:
+    case GST_VIDEO_FORMAT_I422_12LE:
+    case GST_VIDEO_FORMAT_Y444_12LE:
+      res = GST_VIDEO_FORMAT_GRAY16_LE;
+      break;
+    case GST_VIDEO_FORMAT_P010_10LE:
+    case GST_VIDEO_FORMAT_P012_LE:
+    case GST_VIDEO_FORMAT_P016_LE:
+      res = plane == 0 ? GST_VIDEO_FORMAT_GRAY16_LE : GST_VIDEO_FORMAT_P016_LE;
+      break;
     case GST_VIDEO_FORMAT_YUY2:
     case GST_VIDEO_FORMAT_UYVY:
     case GST_VIDEO_FORMAT_VYUY:
@@ -7309,17 +8140,11 @@ get_scale_format (GstVideoFormat format, gint plane)
     case GST_VIDEO_FORMAT_IYU1:
     case GST_VIDEO_FORMAT_r210:
     case GST_VIDEO_FORMAT_I420_10BE:
-    case GST_VIDEO_FORMAT_I420_10LE:
     case GST_VIDEO_FORMAT_I422_10BE:
-    case GST_VIDEO_FORMAT_I422_10LE:
     case GST_VIDEO_FORMAT_Y444_10BE:
-    case GST_VIDEO_FORMAT_Y444_10LE:
     case GST_VIDEO_FORMAT_I420_12BE:
-    case GST_VIDEO_FORMAT_I420_12LE:
     case GST_VIDEO_FORMAT_I422_12BE:
-    case GST_VIDEO_FORMAT_I422_12LE:
     case GST_VIDEO_FORMAT_Y444_12BE:
-    case GST_VIDEO_FORMAT_Y444_12LE:
     case GST_VIDEO_FORMAT_GBR_10BE:
     case GST_VIDEO_FORMAT_GBR_10LE:
     case GST_VIDEO_FORMAT_GBRA_10BE:
@@ -7339,7 +8164,6 @@ get_scale_format (GstVideoFormat format, gint plane)
     case GST_VIDEO_FORMAT_A444_10BE:
     case GST_VIDEO_FORMAT_A444_10LE:
     case GST_VIDEO_FORMAT_P010_10BE:
-    case GST_VIDEO_FORMAT_P010_10LE:
     case GST_VIDEO_FORMAT_GRAY10_LE32:
     case GST_VIDEO_FORMAT_NV12_10LE32:
     case GST_VIDEO_FORMAT_NV16_10LE32:
@@ -7349,9 +8173,7 @@ get_scale_format (GstVideoFormat format, gint plane)
     case GST_VIDEO_FORMAT_Y444_16BE:
     case GST_VIDEO_FORMAT_Y444_16LE:
     case GST_VIDEO_FORMAT_P016_BE:
-    case GST_VIDEO_FORMAT_P016_LE:
     case GST_VIDEO_FORMAT_P012_BE:
-    case GST_VIDEO_FORMAT_P012_LE:
     case GST_VIDEO_FORMAT_Y212_BE:
     case GST_VIDEO_FORMAT_Y212_LE:
     case GST_VIDEO_FORMAT_Y412_BE:
@@ -7422,6 +8244,15 @@ setup_scale (GstVideoConverter * convert)
     case GST_VIDEO_FORMAT_GRAY16_BE:
 #else
     case GST_VIDEO_FORMAT_GRAY16_LE:
+    case GST_VIDEO_FORMAT_I420_10LE:
+    case GST_VIDEO_FORMAT_I422_10LE:
+    case GST_VIDEO_FORMAT_Y444_10LE:
+    case GST_VIDEO_FORMAT_I420_12LE:
+    case GST_VIDEO_FORMAT_I422_12LE:
+    case GST_VIDEO_FORMAT_Y444_12LE:
+    case GST_VIDEO_FORMAT_P010_10LE:
+    case GST_VIDEO_FORMAT_P012_LE:
+    case GST_VIDEO_FORMAT_P016_LE:
 #endif
       if (method != GST_VIDEO_RESAMPLER_METHOD_NEAREST) {
         GST_DEBUG ("%s only with nearest resampling",
@@ -7668,6 +8499,20 @@ setup_scale (GstVideoConverter * convert)
 
       gst_structure_free (config);
       convert->fformat[i] = get_scale_format (in_format, i);
+
+      /* samples with less than 16 bits need to be clamped after filtering */
+      if ((need_h_scaler || need_v_scaler)
+          && resample_method != GST_VIDEO_RESAMPLER_METHOD_NEAREST
+          && (convert->fformat[i] == GST_VIDEO_FORMAT_GRAY16_LE
+              || convert->fformat[i] == GST_VIDEO_FORMAT_P016_LE)) {
+        gint depth, shift;
+
+        depth = GST_VIDEO_FORMAT_INFO_DEPTH (out_finfo, out_comp[0]);
+        shift = GST_VIDEO_FORMAT_INFO_SHIFT (out_finfo, out_comp[0]);
+        if (depth < 16)
+          convert->fmax[i] = ((1 << depth) - 1) << shift;
+        GST_DEBUG ("plane %d: clamp to %04x", i, convert->fmax[i]);
+      }
     }
   }
 
@@ -8098,6 +8943,169 @@ static const VideoTransform transforms[] = {
   {GST_VIDEO_FORMAT_A420, GST_VIDEO_FORMAT_BGR16, FALSE, TRUE, TRUE, TRUE,
       TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_pack_ARGB},
 
+  /* high bit depth */
+  {GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_I420_10LE, TRUE, FALSE, TRUE,
+      FALSE, FALSE, FALSE, FALSE, FALSE, 0, 0, convert_P010_I420_10LE},
+  {GST_VIDEO_FORMAT_P012_LE, GST_VIDEO_FORMAT_I420_12LE, TRUE, FALSE, TRUE,
+      FALSE, FALSE, FALSE, FALSE, FALSE, 0, 0, convert_P010_I420_10LE},
+  {GST_VIDEO_FORMAT_I420_10LE, GST_VIDEO_FORMAT_P010_10LE, TRUE, FALSE, TRUE,
+      FALSE, FALSE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_P010},
+  {GST_VIDEO_FORMAT_I420_12LE, GST_VIDEO_FORMAT_P012_LE, TRUE, FALSE, TRUE,
+      FALSE, FALSE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_P010},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_P010_10LE, TRUE, FALSE, TRUE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_NV12_P010},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_P012_LE, TRUE, FALSE, TRUE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_NV12_P010},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_P016_LE, TRUE, FALSE, TRUE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_NV12_P010},
+  {GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_NV12, TRUE, FALSE, TRUE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_P010_NV12},
+  {GST_VIDEO_FORMAT_P012_LE, GST_VIDEO_FORMAT_NV12, TRUE, FALSE, TRUE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_P010_NV12},
+  {GST_VIDEO_FORMAT_P016_LE, GST_VIDEO_FORMAT_NV12, TRUE, FALSE, TRUE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_P010_NV12},
+  {GST_VIDEO_FORMAT_v210, GST_VIDEO_FORMAT_I422_10LE, TRUE, FALSE, TRUE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_v210_I422_10LE},
+  {GST_VIDEO_FORMAT_I422_10LE, GST_VIDEO_FORMAT_v210, TRUE, FALSE, TRUE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_I422_10LE_v210},
+  {GST_VIDEO_FORMAT_Y210, GST_VIDEO_FORMAT_I422_10LE, TRUE, FALSE, TRUE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_Y210_I422_10LE},
+  {GST_VIDEO_FORMAT_I422_10LE, GST_VIDEO_FORMAT_Y210, TRUE, FALSE, TRUE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_I422_10LE_Y210},
+
+  {GST_VIDEO_FORMAT_I420_10LE, GST_VIDEO_FORMAT_ARGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_I420_10LE, GST_VIDEO_FORMAT_xRGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_I420_10LE, GST_VIDEO_FORMAT_ABGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_I420_10LE, GST_VIDEO_FORMAT_xBGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_I420_10LE, GST_VIDEO_FORMAT_RGBA, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_I420_10LE, GST_VIDEO_FORMAT_RGBx, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_I420_10LE, GST_VIDEO_FORMAT_BGRA, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_I420_10LE, GST_VIDEO_FORMAT_BGRx, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_I420_10LE, GST_VIDEO_FORMAT_RGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_I420_10LE, GST_VIDEO_FORMAT_BGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+
+  {GST_VIDEO_FORMAT_I420_12LE, GST_VIDEO_FORMAT_ARGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_I420_12LE, GST_VIDEO_FORMAT_xRGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_I420_12LE, GST_VIDEO_FORMAT_ABGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_I420_12LE, GST_VIDEO_FORMAT_xBGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_I420_12LE, GST_VIDEO_FORMAT_RGBA, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_I420_12LE, GST_VIDEO_FORMAT_RGBx, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_I420_12LE, GST_VIDEO_FORMAT_BGRA, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_I420_12LE, GST_VIDEO_FORMAT_BGRx, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_I420_12LE, GST_VIDEO_FORMAT_RGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_I420_12LE, GST_VIDEO_FORMAT_BGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+
+  {GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_ARGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_xRGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_ABGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_xBGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_RGBA, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_RGBx, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_BGRA, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_BGRx, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_RGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_BGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+
+  {GST_VIDEO_FORMAT_P012_LE, GST_VIDEO_FORMAT_ARGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_P012_LE, GST_VIDEO_FORMAT_xRGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_P012_LE, GST_VIDEO_FORMAT_ABGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_P012_LE, GST_VIDEO_FORMAT_xBGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_P012_LE, GST_VIDEO_FORMAT_RGBA, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_P012_LE, GST_VIDEO_FORMAT_RGBx, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_P012_LE, GST_VIDEO_FORMAT_BGRA, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_P012_LE, GST_VIDEO_FORMAT_BGRx, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_P012_LE, GST_VIDEO_FORMAT_RGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+  {GST_VIDEO_FORMAT_P012_LE, GST_VIDEO_FORMAT_BGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_10LE_pack_ARGB},
+
+  {GST_VIDEO_FORMAT_I420_10LE, GST_VIDEO_FORMAT_I420_10LE, TRUE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+  {GST_VIDEO_FORMAT_I420_10LE, GST_VIDEO_FORMAT_I422_10LE, FALSE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+  {GST_VIDEO_FORMAT_I420_10LE, GST_VIDEO_FORMAT_Y444_10LE, FALSE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+
+  {GST_VIDEO_FORMAT_I422_10LE, GST_VIDEO_FORMAT_I420_10LE, FALSE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+  {GST_VIDEO_FORMAT_I422_10LE, GST_VIDEO_FORMAT_I422_10LE, TRUE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+  {GST_VIDEO_FORMAT_I422_10LE, GST_VIDEO_FORMAT_Y444_10LE, FALSE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+
+  {GST_VIDEO_FORMAT_Y444_10LE, GST_VIDEO_FORMAT_I420_10LE, FALSE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+  {GST_VIDEO_FORMAT_Y444_10LE, GST_VIDEO_FORMAT_I422_10LE, FALSE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+  {GST_VIDEO_FORMAT_Y444_10LE, GST_VIDEO_FORMAT_Y444_10LE, TRUE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+
+  {GST_VIDEO_FORMAT_I420_12LE, GST_VIDEO_FORMAT_I420_12LE, TRUE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+  {GST_VIDEO_FORMAT_I420_12LE, GST_VIDEO_FORMAT_I422_12LE, FALSE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+  {GST_VIDEO_FORMAT_I420_12LE, GST_VIDEO_FORMAT_Y444_12LE, FALSE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+
+  {GST_VIDEO_FORMAT_I422_12LE, GST_VIDEO_FORMAT_I420_12LE, FALSE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+  {GST_VIDEO_FORMAT_I422_12LE, GST_VIDEO_FORMAT_I422_12LE, TRUE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+  {GST_VIDEO_FORMAT_I422_12LE, GST_VIDEO_FORMAT_Y444_12LE, FALSE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+
+  {GST_VIDEO_FORMAT_Y444_12LE, GST_VIDEO_FORMAT_I420_12LE, FALSE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+  {GST_VIDEO_FORMAT_Y444_12LE, GST_VIDEO_FORMAT_I422_12LE, FALSE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+  {GST_VIDEO_FORMAT_Y444_12LE, GST_VIDEO_FORMAT_Y444_12LE, TRUE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+
+  {GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_P010_10LE, TRUE, FALSE, FALSE,
+      TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+  {GST_VIDEO_FORMAT_P012_LE, GST_VIDEO_FORMAT_P012_LE, TRUE, FALSE, FALSE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+  {GST_VIDEO_FORMAT_P016_LE, GST_VIDEO_FORMAT_P016_LE, TRUE, FALSE, FALSE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+
   /* scalers */
   {GST_VIDEO_FORMAT_GBR, GST_VIDEO_FORMAT_GBR, TRUE, FALSE, FALSE, TRUE,
       TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
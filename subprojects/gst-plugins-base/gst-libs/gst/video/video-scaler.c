@@ -790,6 +790,17 @@ video_scale_h_ntap_u16 (GstVideoScaler * scale,
       d = (guint16 *) dest + dest_offset;
       break;
     }
+    case 2:
+    {
+      guint32 *p32 = (guint32 *) pixels;
+      guint32 *s = (guint32 *) src;
+
+      for (i = 0; i < count; i++)
+        p32[i] = s[offset_n[i]];
+
+      d = (guint32 *) dest + dest_offset;
+      break;
+    }
     case 4:
     {
       guint64 *p64 = (guint64 *) pixels;
@@ -1257,6 +1268,11 @@ get_functions (GstVideoScaler * hscale, GstVideoScaler * vscale,
       *n_elems = 1;
       mono = TRUE;
       break;
+    case GST_VIDEO_FORMAT_P016_LE:
+    case GST_VIDEO_FORMAT_P016_BE:
+      *bits = 16;
+      *n_elems = 2;
+      break;
     case GST_VIDEO_FORMAT_NV12:
     case GST_VIDEO_FORMAT_NV16:
     case GST_VIDEO_FORMAT_NV21:
@@ -1317,6 +1333,8 @@ get_functions (GstVideoScaler * hscale, GstVideoScaler * vscale,
       case 1:
         if (*n_elems == 1)
           *hfunc = video_scale_h_near_u16;
+        else if (*n_elems == 2)
+          *hfunc = video_scale_h_near_u32;
         else
           *hfunc = video_scale_h_near_u64;
         break;
@@ -49,10 +49,28 @@
  * * "mute": Whether to mute the pad or not (#gboolean)
  * * "volume": The volume of the pad, between 0.0 and 10.0 (#gdouble)
  *
+ * With the #GstAudioMixer:mix-minus property enabled every requested sink pad
+ * `sink_N` gets a companion `minus_N` source pad that carries the mix of all
+ * other inputs, as needed for conferencing where participants must not hear
+ * themselves. The full mix is summed only once and the (volume scaled)
+ * contribution of each pad is subtracted from it before clamping, so the cost
+ * grows linearly with the number of pads instead of quadratically. Muted pads
+ * and GAP buffers don't contribute. The minus pads always use the caps of the
+ * main source pad and don't handle seeks, those have to go to the main source
+ * pad. All source pads are pushed from the same thread, so like with tee
+ * every output branch needs its own queue. A failing branch, e.g. because its
+ * sink was shut down, does not stop the other outputs.
+ *
  * ## Example launch line
  * |[
  * gst-launch-1.0 audiotestsrc freq=100 ! audiomixer name=mix ! audioconvert ! alsasink audiotestsrc freq=500 ! mix.
  * ]| This pipeline produces two sine waves mixed together.
+ * |[
+ * gst-launch-1.0 audiomixer name=mix mix-minus=true ! queue ! fakesink \
+ *     audiotestsrc freq=100 ! mix.sink_0 audiotestsrc freq=500 ! mix.sink_1 \
+ *     mix.minus_0 ! queue ! audioconvert ! autoaudiosink
+ * ]| This pipeline plays what the first input gets to hear, the 500Hz sine
+ * wave.
  *
  */
 
@@ -60,6 +78,9 @@
 #include "config.h"
 #endif
 
+#include <math.h>
+#include <string.h>
+
 #include "gstaudiomixerelements.h"
 #include "gstaudiomixerorc.h"
 
@@ -87,6 +108,7 @@ enum
   PROP_PAD_MUTE
 };
 
+#define gst_audiomixer_pad_parent_class pad_parent_class
 G_DEFINE_TYPE (GstAudioMixerPad, gst_audiomixer_pad,
     GST_TYPE_AUDIO_AGGREGATOR_CONVERT_PAD);
 GST_ELEMENT_REGISTER_DEFINE_WITH_CODE (audiomixer, "audiomixer",
@@ -137,6 +159,16 @@ gst_audiomixer_pad_set_property (GObject * object, guint prop_id,
   }
 }
 
+static void
+gst_audiomixer_pad_finalize (GObject * object)
+{
+  GstAudioMixerPad *pad = GST_AUDIO_MIXER_PAD (object);
+
+  g_free (pad->contrib);
+
+  G_OBJECT_CLASS (pad_parent_class)->finalize (object);
+}
+
 static void
 gst_audiomixer_pad_class_init (GstAudioMixerPadClass * klass)
 {
@@ -144,6 +176,7 @@ gst_audiomixer_pad_class_init (GstAudioMixerPadClass * klass)
 
   gobject_class->set_property = gst_audiomixer_pad_set_property;
   gobject_class->get_property = gst_audiomixer_pad_get_property;
+  gobject_class->finalize = gst_audiomixer_pad_finalize;
 
   g_object_class_install_property (gobject_class, PROP_PAD_VOLUME,
       g_param_spec_double ("volume", "Volume", "Volume of this pad",
@@ -162,9 +195,12 @@ gst_audiomixer_pad_init (GstAudioMixerPad * pad)
   pad->mute = DEFAULT_PAD_MUTE;
 }
 
+#define DEFAULT_MIX_MINUS FALSE
+
 enum
 {
-  PROP_0
+  PROP_0,
+  PROP_MIX_MINUS
 };
 
 /* These are the formats we can mix natively */
@@ -186,6 +222,13 @@ GST_STATIC_PAD_TEMPLATE ("src",
     GST_STATIC_CAPS (CAPS)
     );
 
+static GstStaticPadTemplate gst_audiomixer_minus_template =
+GST_STATIC_PAD_TEMPLATE ("minus_%u",
+    GST_PAD_SRC,
+    GST_PAD_SOMETIMES,
+    GST_STATIC_CAPS (CAPS)
+    );
+
 #define SINK_CAPS \
   GST_STATIC_CAPS (GST_AUDIO_CAPS_MAKE (GST_AUDIO_FORMATS_ALL) \
       ", layout=interleaved")
@@ -208,6 +251,17 @@ static GstPad *gst_audiomixer_request_new_pad (GstElement * element,
     GstPadTemplate * temp, const gchar * req_name, const GstCaps * caps);
 static void gst_audiomixer_release_pad (GstElement * element, GstPad * pad);
 
+static void gst_audiomixer_finalize (GObject * object);
+static void gst_audiomixer_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_audiomixer_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+
+static gboolean gst_audiomixer_start (GstAggregator * agg);
+static GstFlowReturn gst_audiomixer_finish_buffer (GstAggregator * agg,
+    GstBuffer * buffer);
+static GstBuffer *gst_audiomixer_create_output_buffer (GstAudioAggregator *
+    aagg, guint num_frames);
 static gboolean
 gst_audiomixer_aggregate_one_buffer (GstAudioAggregator * aagg,
     GstAudioAggregatorPad * aaggpad, GstBuffer * inbuf, guint in_offset,
@@ -217,13 +271,37 @@ gst_audiomixer_aggregate_one_buffer (GstAudioAggregator * aagg,
 static void
 gst_audiomixer_class_init (GstAudioMixerClass * klass)
 {
+  GObjectClass *gobject_class = (GObjectClass *) klass;
   GstElementClass *gstelement_class = (GstElementClass *) klass;
+  GstAggregatorClass *agg_class = (GstAggregatorClass *) klass;
   GstAudioAggregatorClass *aagg_class = (GstAudioAggregatorClass *) klass;
 
+  gobject_class->finalize = gst_audiomixer_finalize;
+  gobject_class->set_property = gst_audiomixer_set_property;
+  gobject_class->get_property = gst_audiomixer_get_property;
+
+  /**
+   * GstAudioMixer:mix-minus:
+   *
+   * Expose a `minus_N` source pad for every requested `sink_N` pad, which
+   * outputs the mix of all sink pads except `sink_N`. Only affects sink pads
+   * requested after the property was set.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_MIX_MINUS,
+      g_param_spec_boolean ("mix-minus", "Mix minus",
+          "Expose a mix of all other inputs for every sink pad",
+          DEFAULT_MIX_MINUS,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_static_pad_template_with_gtype (gstelement_class,
       &gst_audiomixer_src_template, GST_TYPE_AUDIO_AGGREGATOR_CONVERT_PAD);
   gst_element_class_add_static_pad_template_with_gtype (gstelement_class,
       &gst_audiomixer_sink_template, GST_TYPE_AUDIO_MIXER_PAD);
+  gst_element_class_add_static_pad_template (gstelement_class,
+      &gst_audiomixer_minus_template);
   gst_element_class_set_static_metadata (gstelement_class, "AudioMixer",
       "Generic/Audio", "Mixes multiple audio streams",
       "Sebastian Dröge <sebastian@centricular.com>");
@@ -233,6 +311,10 @@ gst_audiomixer_class_init (GstAudioMixerClass * klass)
   gstelement_class->release_pad =
       GST_DEBUG_FUNCPTR (gst_audiomixer_release_pad);
 
+  agg_class->start = GST_DEBUG_FUNCPTR (gst_audiomixer_start);
+  agg_class->finish_buffer = GST_DEBUG_FUNCPTR (gst_audiomixer_finish_buffer);
+
+  aagg_class->create_output_buffer = gst_audiomixer_create_output_buffer;
   aagg_class->aggregate_one_buffer = gst_audiomixer_aggregate_one_buffer;
 
   gst_type_mark_as_plugin_api (GST_TYPE_AUDIO_MIXER_PAD, 0);
@@ -241,6 +323,287 @@ gst_audiomixer_class_init (GstAudioMixerClass * klass)
 static void
 gst_audiomixer_init (GstAudioMixer * audiomixer)
 {
+  audiomixer->mix_minus = DEFAULT_MIX_MINUS;
+  audiomixer->flow_combiner = gst_flow_combiner_new ();
+  gst_flow_combiner_add_pad (audiomixer->flow_combiner,
+      GST_AGGREGATOR_SRC_PAD (audiomixer));
+}
+
+static void
+gst_audiomixer_finalize (GObject * object)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (object);
+
+  gst_flow_combiner_free (audiomixer->flow_combiner);
+  g_free (audiomixer->mix);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_audiomixer_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (object);
+
+  switch (prop_id) {
+    case PROP_MIX_MINUS:
+      GST_OBJECT_LOCK (audiomixer);
+      audiomixer->mix_minus = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (audiomixer);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_audiomixer_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (object);
+
+  switch (prop_id) {
+    case PROP_MIX_MINUS:
+      GST_OBJECT_LOCK (audiomixer);
+      g_value_set_boolean (value, audiomixer->mix_minus);
+      GST_OBJECT_UNLOCK (audiomixer);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+/* Returns a new reference to the event that has to go out on @minus_pad for
+ * @event on the main source pad, or %NULL if there is nothing to send */
+static GstEvent *
+gst_audiomixer_make_minus_event (GstPad * minus_pad, GstEvent * event)
+{
+  const gchar *stream_id;
+  GstEvent *new_event, *current;
+  gchar *minus_stream_id;
+  guint group_id;
+
+  if (GST_EVENT_TYPE (event) != GST_EVENT_STREAM_START)
+    return gst_event_ref (event);
+
+  /* every minus pad is a stream of its own, derive its id from the main one.
+   * The seqnum tells us if we already did so for this stream-start */
+  current = gst_pad_get_sticky_event (minus_pad, GST_EVENT_STREAM_START, 0);
+  if (current) {
+    gboolean same = gst_event_get_seqnum (current) ==
+        gst_event_get_seqnum (event);
+
+    gst_event_unref (current);
+    if (same)
+      return NULL;
+  }
+
+  gst_event_parse_stream_start (event, &stream_id);
+  minus_stream_id = g_strdup_printf ("%s/%s", stream_id,
+      GST_OBJECT_NAME (minus_pad));
+  new_event = gst_event_new_stream_start (minus_stream_id);
+  g_free (minus_stream_id);
+
+  if (gst_event_parse_group_id (event, &group_id))
+    gst_event_set_group_id (new_event, group_id);
+  gst_event_set_seqnum (new_event, gst_event_get_seqnum (event));
+
+  return new_event;
+}
+
+static GList *
+gst_audiomixer_get_minus_pads (GstAudioMixer * audiomixer)
+{
+  GList *minus_pads = NULL, *l;
+
+  GST_OBJECT_LOCK (audiomixer);
+  for (l = GST_ELEMENT_CAST (audiomixer)->sinkpads; l; l = l->next) {
+    GstAudioMixerPad *pad = l->data;
+
+    if (pad->minus_pad)
+      minus_pads = g_list_prepend (minus_pads, gst_object_ref (pad->minus_pad));
+  }
+  GST_OBJECT_UNLOCK (audiomixer);
+
+  return minus_pads;
+}
+
+/* Forwards everything the aggregator sends downstream on its source pad to
+ * the minus pads, so they see the same caps, segments, EOS and flushes */
+static GstPadProbeReturn
+gst_audiomixer_src_event_probe (GstPad * srcpad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (user_data);
+  GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info);
+  GList *minus_pads, *l;
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP) {
+    GST_OBJECT_LOCK (audiomixer);
+    gst_flow_combiner_reset (audiomixer->flow_combiner);
+    GST_OBJECT_UNLOCK (audiomixer);
+  }
+
+  minus_pads = gst_audiomixer_get_minus_pads (audiomixer);
+  for (l = minus_pads; l; l = l->next) {
+    GstEvent *minus_event = gst_audiomixer_make_minus_event (l->data, event);
+
+    if (minus_event)
+      gst_pad_push_event (l->data, minus_event);
+  }
+  g_list_free_full (minus_pads, gst_object_unref);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static gboolean
+gst_audiomixer_copy_sticky_event (GstPad * srcpad, GstEvent ** event,
+    gpointer user_data)
+{
+  GstPad *minus_pad = user_data;
+  GstEvent *minus_event = gst_audiomixer_make_minus_event (minus_pad, *event);
+
+  if (minus_event) {
+    gst_pad_store_sticky_event (minus_pad, minus_event);
+    gst_event_unref (minus_event);
+  }
+
+  return TRUE;
+}
+
+static gboolean
+gst_audiomixer_minus_src_query (GstPad * pad, GstObject * parent,
+    GstQuery * query)
+{
+  GstAggregator *agg = GST_AGGREGATOR (parent);
+  gboolean res;
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+    {
+      GstCaps *filter, *caps;
+
+      /* we can only output whatever was negotiated on the main source pad */
+      caps = gst_pad_get_current_caps (agg->srcpad);
+      if (caps == NULL)
+        caps = gst_pad_get_pad_template_caps (pad);
+
+      gst_query_parse_caps (query, &filter);
+      if (filter) {
+        GstCaps *tmp = caps;
+
+        caps = gst_caps_intersect_full (filter, tmp, GST_CAPS_INTERSECT_FIRST);
+        gst_caps_unref (tmp);
+      }
+
+      gst_query_set_caps_result (query, caps);
+      gst_caps_unref (caps);
+      res = TRUE;
+      break;
+    }
+    case GST_QUERY_ACCEPT_CAPS:
+      res = gst_pad_query_default (pad, parent, query);
+      break;
+    default:
+      /* latency, position, duration etc. are the same as for the full mix */
+      res = gst_pad_query (agg->srcpad, query);
+      break;
+  }
+
+  return res;
+}
+
+static gboolean
+gst_audiomixer_minus_src_event (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  GST_DEBUG_OBJECT (pad, "dropping upstream %" GST_PTR_FORMAT
+      ", only handled on the main source pad", event);
+  gst_event_unref (event);
+
+  return FALSE;
+}
+
+static void
+gst_audiomixer_add_minus_pad (GstAudioMixer * audiomixer,
+    GstAudioMixerPad * pad)
+{
+  GstElement *element = GST_ELEMENT_CAST (audiomixer);
+  GstPad *srcpad = GST_AGGREGATOR_SRC_PAD (audiomixer);
+  GstPadTemplate *templ;
+  const gchar *name = GST_OBJECT_NAME (pad);
+  GstPad *minus_pad;
+  gchar *minus_name;
+
+  if (g_str_has_prefix (name, "sink_"))
+    name += strlen ("sink_");
+  minus_name = g_strdup_printf ("minus_%s", name);
+  templ = gst_element_get_pad_template (element, "minus_%u");
+  minus_pad = gst_pad_new_from_template (templ, minus_name);
+  g_free (minus_name);
+
+  gst_pad_set_query_function (minus_pad,
+      GST_DEBUG_FUNCPTR (gst_audiomixer_minus_src_query));
+  gst_pad_set_event_function (minus_pad,
+      GST_DEBUG_FUNCPTR (gst_audiomixer_minus_src_event));
+
+  GST_OBJECT_LOCK (audiomixer);
+  pad->minus_pad = gst_object_ref (minus_pad);
+  gst_flow_combiner_add_pad (audiomixer->flow_combiner, minus_pad);
+  if (audiomixer->src_probe_id == 0)
+    audiomixer->src_probe_id = gst_pad_add_probe (srcpad,
+        GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM | GST_PAD_PROBE_TYPE_EVENT_FLUSH,
+        gst_audiomixer_src_event_probe, audiomixer, NULL);
+  GST_OBJECT_UNLOCK (audiomixer);
+
+  gst_element_add_pad (element, minus_pad);
+
+  /* catch up with the stream if we are added while running */
+  if (gst_pad_is_active (minus_pad))
+    gst_pad_sticky_events_foreach (srcpad, gst_audiomixer_copy_sticky_event,
+        minus_pad);
+
+  GST_DEBUG_OBJECT (audiomixer, "added %s:%s for %s:%s",
+      GST_DEBUG_PAD_NAME (minus_pad), GST_DEBUG_PAD_NAME (pad));
+}
+
+static void
+gst_audiomixer_remove_minus_pad (GstAudioMixer * audiomixer,
+    GstAudioMixerPad * pad)
+{
+  GstPad *minus_pad;
+
+  GST_OBJECT_LOCK (audiomixer);
+  minus_pad = pad->minus_pad;
+  pad->minus_pad = NULL;
+  if (minus_pad)
+    gst_flow_combiner_remove_pad (audiomixer->flow_combiner, minus_pad);
+  GST_OBJECT_UNLOCK (audiomixer);
+
+  if (minus_pad == NULL)
+    return;
+
+  GST_DEBUG_OBJECT (audiomixer, "removing %s:%s",
+      GST_DEBUG_PAD_NAME (minus_pad));
+
+  gst_pad_set_active (minus_pad, FALSE);
+  gst_element_remove_pad (GST_ELEMENT_CAST (audiomixer), minus_pad);
+  gst_object_unref (minus_pad);
+}
+
+static gboolean
+gst_audiomixer_start (GstAggregator * agg)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (agg);
+
+  GST_OBJECT_LOCK (audiomixer);
+  gst_flow_combiner_reset (audiomixer->flow_combiner);
+  GST_OBJECT_UNLOCK (audiomixer);
+
+  return GST_AGGREGATOR_CLASS (parent_class)->start (agg);
 }
 
 static GstPad *
@@ -248,6 +611,7 @@ gst_audiomixer_request_new_pad (GstElement * element, GstPadTemplate * templ,
     const gchar * req_name, const GstCaps * caps)
 {
   GstAudioMixerPad *newpad;
+  gboolean mix_minus;
 
   newpad = (GstAudioMixerPad *)
       GST_ELEMENT_CLASS (parent_class)->request_new_pad (element,
@@ -256,6 +620,13 @@ gst_audiomixer_request_new_pad (GstElement * element, GstPadTemplate * templ,
   if (newpad == NULL)
     goto could_not_create;
 
+  GST_OBJECT_LOCK (element);
+  mix_minus = GST_AUDIO_MIXER (element)->mix_minus;
+  GST_OBJECT_UNLOCK (element);
+
+  if (mix_minus)
+    gst_audiomixer_add_minus_pad (GST_AUDIO_MIXER (element), newpad);
+
   gst_child_proxy_child_added (GST_CHILD_PROXY (element), G_OBJECT (newpad),
       GST_OBJECT_NAME (newpad));
 
@@ -277,12 +648,127 @@ gst_audiomixer_release_pad (GstElement * element, GstPad * pad)
 
   GST_DEBUG_OBJECT (audiomixer, "release pad %s:%s", GST_DEBUG_PAD_NAME (pad));
 
+  gst_audiomixer_remove_minus_pad (audiomixer, GST_AUDIO_MIXER_PAD (pad));
+
   gst_child_proxy_child_removed (GST_CHILD_PROXY (audiomixer), G_OBJECT (pad),
       GST_OBJECT_NAME (pad));
 
   GST_ELEMENT_CLASS (parent_class)->release_pad (element, pad);
 }
 
+static GstBuffer *
+gst_audiomixer_create_output_buffer (GstAudioAggregator * aagg,
+    guint num_frames)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (aagg);
+  GstAudioAggregatorPad *srcpad =
+      GST_AUDIO_AGGREGATOR_PAD (GST_AGGREGATOR_SRC_PAD (aagg));
+  GstBuffer *outbuf;
+
+  outbuf = GST_AUDIO_AGGREGATOR_CLASS (parent_class)->create_output_buffer
+      (aagg, num_frames);
+
+  GST_OBJECT_LOCK (aagg);
+  if (audiomixer->mix_minus) {
+    gsize size = (gsize) num_frames * GST_AUDIO_INFO_CHANNELS (&srcpad->info);
+
+    if (size > audiomixer->mix_alloc) {
+      g_free (audiomixer->mix);
+      audiomixer->mix = g_new (gdouble, size);
+      audiomixer->mix_alloc = size;
+    }
+    memset (audiomixer->mix, 0, size * sizeof (gdouble));
+    audiomixer->mix_size = size;
+    audiomixer->mix_format = GST_AUDIO_INFO_FORMAT (&srcpad->info);
+    audiomixer->mix_channels = GST_AUDIO_INFO_CHANNELS (&srcpad->info);
+    audiomixer->mix_valid = TRUE;
+    audiomixer->n_mixed = 0;
+    /* invalidates the contributions of all pads */
+    audiomixer->mix_cookie++;
+  }
+  GST_OBJECT_UNLOCK (aagg);
+
+  return outbuf;
+}
+
+#define ACCUMULATE(type,bias) G_STMT_START {             \
+  const type *src = in;                                  \
+  for (i = 0; i < n_samples; i++) {                      \
+    gdouble v = ((gdouble) src[i] - (bias)) * volume;    \
+    contrib[i] += v;                                     \
+    mix[i] += v;                                         \
+  }                                                      \
+} G_STMT_END
+
+/* Adds the volume scaled input of @pad to the full mix and to the pad's own
+ * contribution. Must be called with the object locks of the element and the
+ * pad held */
+static void
+gst_audiomixer_accumulate (GstAudioMixer * audiomixer, GstAudioMixerPad * pad,
+    GstAudioFormat format, gint channels, gconstpointer in, guint out_offset,
+    guint num_frames)
+{
+  gsize offset = (gsize) out_offset * channels;
+  gsize n_samples = (gsize) num_frames * channels;
+  gdouble volume = pad->volume;
+  gdouble *contrib, *mix;
+  gsize i;
+
+  if (!audiomixer->mix_valid || format != audiomixer->mix_format
+      || channels != audiomixer->mix_channels
+      || offset + n_samples > audiomixer->mix_size) {
+    /* the output format changed in the middle of the output buffer */
+    GST_DEBUG_OBJECT (audiomixer, "format changed, no mix-minus output");
+    audiomixer->mix_valid = FALSE;
+    return;
+  }
+
+  if (pad->contrib_cookie != audiomixer->mix_cookie) {
+    if (audiomixer->mix_size > pad->contrib_alloc) {
+      g_free (pad->contrib);
+      pad->contrib = g_new (gdouble, audiomixer->mix_size);
+      pad->contrib_alloc = audiomixer->mix_size;
+    }
+    memset (pad->contrib, 0, audiomixer->mix_size * sizeof (gdouble));
+    pad->contrib_cookie = audiomixer->mix_cookie;
+    audiomixer->n_mixed++;
+  }
+
+  contrib = pad->contrib + offset;
+  mix = audiomixer->mix + offset;
+
+  switch (format) {
+    case GST_AUDIO_FORMAT_U8:
+      ACCUMULATE (guint8, 128.0);
+      break;
+    case GST_AUDIO_FORMAT_S8:
+      ACCUMULATE (gint8, 0.0);
+      break;
+    case GST_AUDIO_FORMAT_U16:
+      ACCUMULATE (guint16, 32768.0);
+      break;
+    case GST_AUDIO_FORMAT_S16:
+      ACCUMULATE (gint16, 0.0);
+      break;
+    case GST_AUDIO_FORMAT_U32:
+      ACCUMULATE (guint32, 2147483648.0);
+      break;
+    case GST_AUDIO_FORMAT_S32:
+      ACCUMULATE (gint32, 0.0);
+      break;
+    case GST_AUDIO_FORMAT_F32:
+      ACCUMULATE (gfloat, 0.0);
+      break;
+    case GST_AUDIO_FORMAT_F64:
+      ACCUMULATE (gdouble, 0.0);
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+  }
+}
+
+#undef ACCUMULATE
 
 static gboolean
 gst_audiomixer_aggregate_one_buffer (GstAudioAggregator * aagg,
@@ -407,6 +893,12 @@ gst_audiomixer_aggregate_one_buffer (GstAudioAggregator * aagg,
         break;
     }
   }
+
+  if (GST_AUDIO_MIXER (aagg)->mix_minus)
+    gst_audiomixer_accumulate (GST_AUDIO_MIXER (aagg), pad,
+        srcpad->info.finfo->format, srcpad->info.channels,
+        inmap.data + in_offset * bpf, out_offset, num_frames);
+
   gst_buffer_unmap (inbuf, &inmap);
   gst_buffer_unmap (outbuf, &outmap);
 
@@ -416,6 +908,173 @@ gst_audiomixer_aggregate_one_buffer (GstAudioAggregator * aagg,
   return TRUE;
 }
 
+#define WRITE_MINUS_INT(type,bias,min,max) G_STMT_START {      \
+  type *dst = (type *) map.data;                               \
+  for (i = 0; i < n_samples; i++) {                            \
+    gdouble v = mix[i] - (contrib ? contrib[i] : 0.0);         \
+    v = floor (v + 0.5);                                       \
+    dst[i] = (type) (CLAMP (v, (min), (max)) + (bias));        \
+  }                                                            \
+} G_STMT_END
+
+#define WRITE_MINUS_FLOAT(type) G_STMT_START {                 \
+  type *dst = (type *) map.data;                               \
+  for (i = 0; i < n_samples; i++)                              \
+    dst[i] = mix[i] - (contrib ? contrib[i] : 0.0);            \
+} G_STMT_END
+
+/* Creates the output for the minus pad of @pad: the full mix without the
+ * contribution of @pad, clamped only after the subtraction */
+static GstBuffer *
+gst_audiomixer_make_minus_buffer (GstAudioMixer * audiomixer,
+    GstAudioMixerPad * pad, GstBuffer * outbuf, const GstAudioInfo * info)
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  const gdouble *mix = audiomixer->mix;
+  const gdouble *contrib = NULL;
+  gsize n_samples, i;
+  gboolean gap;
+
+  buffer = gst_buffer_new_allocate (NULL, gst_buffer_get_size (outbuf), NULL);
+  gst_buffer_copy_into (buffer, outbuf,
+      GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+
+  n_samples = gst_buffer_get_size (outbuf) / GST_AUDIO_INFO_BPS (info);
+
+  if (pad->contrib_cookie == audiomixer->mix_cookie)
+    contrib = pad->contrib;
+
+  /* nobody else contributed anything: silence */
+  gap = GST_BUFFER_FLAG_IS_SET (outbuf, GST_BUFFER_FLAG_GAP)
+      || !audiomixer->mix_valid || audiomixer->n_mixed == 0
+      || (contrib != NULL && audiomixer->n_mixed == 1)
+      || GST_AUDIO_INFO_FORMAT (info) != audiomixer->mix_format
+      || GST_AUDIO_INFO_CHANNELS (info) != audiomixer->mix_channels
+      || n_samples > audiomixer->mix_size;
+
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  if (gap) {
+    gst_audio_format_info_fill_silence (info->finfo, map.data, map.size);
+    GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_GAP);
+  } else {
+    switch (GST_AUDIO_INFO_FORMAT (info)) {
+      case GST_AUDIO_FORMAT_U8:
+        WRITE_MINUS_INT (guint8, 128.0, -128.0, 127.0);
+        break;
+      case GST_AUDIO_FORMAT_S8:
+        WRITE_MINUS_INT (gint8, 0.0, -128.0, 127.0);
+        break;
+      case GST_AUDIO_FORMAT_U16:
+        WRITE_MINUS_INT (guint16, 32768.0, -32768.0, 32767.0);
+        break;
+      case GST_AUDIO_FORMAT_S16:
+        WRITE_MINUS_INT (gint16, 0.0, -32768.0, 32767.0);
+        break;
+      case GST_AUDIO_FORMAT_U32:
+        WRITE_MINUS_INT (guint32, 2147483648.0, -2147483648.0, 2147483647.0);
+        break;
+      case GST_AUDIO_FORMAT_S32:
+        WRITE_MINUS_INT (gint32, 0.0, -2147483648.0, 2147483647.0);
+        break;
+      case GST_AUDIO_FORMAT_F32:
+        WRITE_MINUS_FLOAT (gfloat);
+        break;
+      case GST_AUDIO_FORMAT_F64:
+        WRITE_MINUS_FLOAT (gdouble);
+        break;
+      default:
+        g_assert_not_reached ();
+        break;
+    }
+    GST_BUFFER_FLAG_UNSET (buffer, GST_BUFFER_FLAG_GAP);
+  }
+  gst_buffer_unmap (buffer, &map);
+
+  return buffer;
+}
+
+#undef WRITE_MINUS_INT
+#undef WRITE_MINUS_FLOAT
+
+static GstFlowReturn
+gst_audiomixer_finish_buffer (GstAggregator * agg, GstBuffer * buffer)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (agg);
+  GstAudioAggregatorPad *srcpad = GST_AUDIO_AGGREGATOR_PAD (agg->srcpad);
+  GPtrArray *sink_pads, *minus_pads, *minus_buffers;
+  GstAudioInfo info;
+  GstFlowReturn ret;
+  GList *l;
+  guint i;
+
+  if (!audiomixer->mix_minus)
+    return GST_AGGREGATOR_CLASS (parent_class)->finish_buffer (agg, buffer);
+
+  sink_pads = g_ptr_array_new_with_free_func (gst_object_unref);
+  minus_pads = g_ptr_array_new_with_free_func (gst_object_unref);
+  minus_buffers = g_ptr_array_new ();
+
+  GST_OBJECT_LOCK (audiomixer);
+  info = srcpad->info;
+  for (l = GST_ELEMENT_CAST (audiomixer)->sinkpads; l; l = l->next) {
+    GstAudioMixerPad *pad = l->data;
+
+    if (pad->minus_pad == NULL)
+      continue;
+
+    g_ptr_array_add (sink_pads, gst_object_ref (pad));
+    g_ptr_array_add (minus_pads, gst_object_ref (pad->minus_pad));
+    g_ptr_array_add (minus_buffers,
+        gst_audiomixer_make_minus_buffer (audiomixer, pad, buffer, &info));
+  }
+  GST_OBJECT_UNLOCK (audiomixer);
+
+  /* the main source pad goes first so that the sticky events it pushes
+   * reach the minus pads before their buffers */
+  ret = GST_AGGREGATOR_CLASS (parent_class)->finish_buffer (agg, buffer);
+
+  GST_OBJECT_LOCK (audiomixer);
+  ret = gst_flow_combiner_update_pad_flow (audiomixer->flow_combiner,
+      agg->srcpad, ret);
+  GST_OBJECT_UNLOCK (audiomixer);
+
+  for (i = 0; i < minus_pads->len; i++) {
+    GstAudioMixerPad *pad = g_ptr_array_index (sink_pads, i);
+    GstPad *minus_pad = g_ptr_array_index (minus_pads, i);
+    GstFlowReturn minus_ret;
+
+    minus_ret = gst_pad_push (minus_pad, g_ptr_array_index (minus_buffers, i));
+    GST_LOG_OBJECT (minus_pad, "pushed buffer, result = %s",
+        gst_flow_get_name (minus_ret));
+
+    /* A failing branch only concerns its participant and must not stop the
+     * mixer for everybody else, e.g. when its sink was shut down or the pad
+     * is released right now. Only a flush of the element itself stops us */
+    if (minus_ret < GST_FLOW_EOS && (minus_ret != GST_FLOW_FLUSHING ||
+            !GST_PAD_IS_FLUSHING (agg->srcpad))) {
+      if (minus_ret != GST_FLOW_FLUSHING)
+        GST_WARNING_OBJECT (minus_pad, "branch failed: %s",
+            gst_flow_get_name (minus_ret));
+      minus_ret = GST_FLOW_NOT_LINKED;
+    }
+
+    GST_OBJECT_LOCK (audiomixer);
+    /* skip pads that were released while pushing, they are not part of the
+     * flow combiner anymore */
+    if (pad->minus_pad == minus_pad)
+      ret = gst_flow_combiner_update_pad_flow (audiomixer->flow_combiner,
+          minus_pad, minus_ret);
+    GST_OBJECT_UNLOCK (audiomixer);
+  }
+
+  g_ptr_array_unref (minus_buffers);
+  g_ptr_array_unref (minus_pads);
+  g_ptr_array_unref (sink_pads);
+
+  return ret;
+}
+
 
 /* GstChildProxy implementation */
 static GObject *
@@ -27,6 +27,7 @@
 #include <gst/gst.h>
 #include <gst/audio/audio.h>
 #include <gst/audio/gstaudioaggregator.h>
+#include <gst/base/gstflowcombiner.h>
 
 G_BEGIN_DECLS
 
@@ -41,6 +42,22 @@ G_DECLARE_FINAL_TYPE (GstAudioMixer, gst_audiomixer, GST, AUDIO_MIXER,
  */
 struct _GstAudioMixer {
   GstAudioAggregator element;
+
+  /*< private >*/
+  gboolean mix_minus;
+  GstFlowCombiner *flow_combiner;
+  gulong src_probe_id;
+
+  /* unclipped sum of all pads for the current output buffer, in
+   * samples of the output format with the unsigned bias removed */
+  gdouble *mix;
+  gsize mix_size;
+  gsize mix_alloc;
+  GstAudioFormat mix_format;
+  gint mix_channels;
+  gboolean mix_valid;
+  guint n_mixed;
+  guint64 mix_cookie;
 };
 
 #define GST_TYPE_AUDIO_MIXER_PAD (gst_audiomixer_pad_get_type())
@@ -55,6 +72,16 @@ struct _GstAudioMixerPad {
   gint volume_i16;
   gint volume_i8;
   gboolean mute;
+
+  /*< private >*/
+  /* protected by the element's object lock */
+  GstPad *minus_pad;
+
+  /* contribution of this pad to the current mix, valid if
+   * contrib_cookie matches the mixer's mix_cookie */
+  gdouble *contrib;
+  gsize contrib_alloc;
+  guint64 contrib_cookie;
 };
 
 G_END_DECLS
@@ -28,6 +28,7 @@
 
 #include "gstvideoscale.h"
 #include "gstvideoconvert.h"
+#include "gstvideomultiscale.h"
 
 static gboolean
 plugin_init (GstPlugin * plugin)
@@ -41,6 +42,9 @@ plugin_init (GstPlugin * plugin)
   if (!GST_ELEMENT_REGISTER (videoconvertscale, plugin))
     return FALSE;
 
+  if (!GST_ELEMENT_REGISTER (videomultiscale, plugin))
+    return FALSE;
+
   return TRUE;
 }
 
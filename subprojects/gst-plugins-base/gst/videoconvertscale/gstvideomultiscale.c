@@ -0,0 +1,1373 @@
+/* GStreamer
+ * Copyright (C) 2022 GStreamer developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:element-videomultiscale
+ * @title: videomultiscale
+ * @see_also: videoconvertscale, tee
+ *
+ * This element scales one video stream to several resolutions at once, for
+ * example to produce all renditions of an adaptive streaming ladder. Every
+ * request src pad negotiates its own width, height and pixel aspect ratio
+ * with downstream, all other fields, including the format, are the ones of
+ * the input. When downstream only constrains the width or the height, the
+ * other dimension is chosen to keep the display aspect ratio.
+ *
+ * Compared to a tee followed by one videoconvertscale per branch, the input
+ * is read only once for formats with 8-bit components in separate planes
+ * (I420, Y42B, Y444, A420, GBR, ...) and for packed formats with four 8-bit
+ * components (AYUV, RGBA, BGRx, ...): every input line is scaled
+ * horizontally for all renditions while it is in the cache and the vertical
+ * filters of the renditions run on these scaled lines. The frame is split
+ * into horizontal bands that are scaled in parallel.
+ *
+ * Other formats, and interlaced video, are scaled with one converter per
+ * rendition which reads the whole input frame once per rendition. There
+ * the renditions are only scaled in parallel, without saving memory
+ * bandwidth, unless #GstVideoMultiScale:cascade is enabled, which scales
+ * every rendition from the nearest larger rendition so the full resolution
+ * frame is only read for the largest renditions.
+ *
+ * ## Example pipeline
+ * |[
+ * gst-launch-1.0 videotestsrc ! video/x-raw,width=1920,height=1080 ! videomultiscale name=s \
+ *     s. ! video/x-raw,width=1280,height=720 ! queue ! fakesink \
+ *     s. ! video/x-raw,width=640,height=360 ! queue ! fakesink \
+ *     s. ! video/x-raw,width=320 ! queue ! fakesink
+ * ]|
+ *  Scales the test video to three renditions, the height of the last one is
+ * chosen to keep the aspect ratio.
+ *
+ * Since: 1.22
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+
+#include <gst/video/gstvideopool.h>
+
+#include "gstvideomultiscale.h"
+
+GST_DEBUG_CATEGORY_STATIC (video_multiscale_debug);
+#define GST_CAT_DEFAULT video_multiscale_debug
+
+#define DEFAULT_PROP_METHOD GST_VIDEO_RESAMPLER_METHOD_LINEAR
+#define DEFAULT_PROP_CASCADE FALSE
+#define DEFAULT_PROP_N_THREADS 0
+
+enum
+{
+  PROP_0,
+  PROP_METHOD,
+  PROP_CASCADE,
+  PROP_N_THREADS,
+};
+
+#undef GST_VIDEO_SIZE_RANGE
+#define GST_VIDEO_SIZE_RANGE "(int) [ 1, 32767]"
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE (GST_VIDEO_FORMATS_ALL)));
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src_%u",
+    GST_PAD_SRC,
+    GST_PAD_REQUEST,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE (GST_VIDEO_FORMATS_ALL)));
+
+struct _GstVideoMultiScalePad
+{
+  GstPad parent;
+
+  /* only used from the streaming thread */
+  GstVideoInfo info;
+  gboolean negotiated;
+  GstBufferPool *pool;
+
+  GstVideoConverter *convert;
+  GstVideoInfo convert_info;
+  GstVideoResamplerMethod convert_method;
+  guint convert_threads;
+
+  /* scalers of the single pass, one pair for every band and component */
+  GstVideoScaler **hscale;
+  GstVideoScaler **vscale;
+  guint n_scalers;
+  GstVideoInfo scaler_info;
+  GstVideoResamplerMethod scaler_method;
+
+  /* state of the buffer being processed */
+  GstVideoMultiScalePad *source;
+  guint level;
+  GstBuffer *outbuf;
+  GstVideoFrame frame;
+  GstVideoFrame *src_frame;
+  GstFlowReturn flow;
+};
+
+G_DEFINE_TYPE (GstVideoMultiScalePad, gst_video_multi_scale_pad,
+    GST_TYPE_PAD);
+
+static void
+gst_video_multi_scale_pad_free_scalers (GstVideoMultiScalePad * pad)
+{
+  guint i;
+
+  for (i = 0; i < pad->n_scalers; i++) {
+    if (pad->hscale[i])
+      gst_video_scaler_free (pad->hscale[i]);
+    if (pad->vscale[i])
+      gst_video_scaler_free (pad->vscale[i]);
+  }
+  g_clear_pointer (&pad->hscale, g_free);
+  g_clear_pointer (&pad->vscale, g_free);
+  pad->n_scalers = 0;
+}
+
+static void
+gst_video_multi_scale_pad_reset (GstVideoMultiScalePad * pad)
+{
+  if (pad->convert) {
+    gst_video_converter_free (pad->convert);
+    pad->convert = NULL;
+  }
+  gst_video_multi_scale_pad_free_scalers (pad);
+  if (pad->pool) {
+    gst_buffer_pool_set_active (pad->pool, FALSE);
+    gst_object_unref (pad->pool);
+    pad->pool = NULL;
+  }
+  pad->negotiated = FALSE;
+}
+
+static void
+gst_video_multi_scale_pad_finalize (GObject * object)
+{
+  gst_video_multi_scale_pad_reset (GST_VIDEO_MULTI_SCALE_PAD (object));
+
+  G_OBJECT_CLASS (gst_video_multi_scale_pad_parent_class)->finalize (object);
+}
+
+static void
+gst_video_multi_scale_pad_class_init (GstVideoMultiScalePadClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+
+  gobject_class->finalize = gst_video_multi_scale_pad_finalize;
+}
+
+static void
+gst_video_multi_scale_pad_init (GstVideoMultiScalePad * pad)
+{
+  gst_video_info_init (&pad->info);
+}
+
+#define gst_video_multi_scale_parent_class parent_class
+G_DEFINE_TYPE (GstVideoMultiScale, gst_video_multi_scale, GST_TYPE_ELEMENT);
+GST_ELEMENT_REGISTER_DEFINE (videomultiscale, "videomultiscale",
+    GST_RANK_NONE, GST_TYPE_VIDEO_MULTI_SCALE);
+
+static void gst_video_multi_scale_finalize (GObject * object);
+static void gst_video_multi_scale_set_property (GObject * object,
+    guint prop_id, const GValue * value, GParamSpec * pspec);
+static void gst_video_multi_scale_get_property (GObject * object,
+    guint prop_id, GValue * value, GParamSpec * pspec);
+
+static GstStateChangeReturn gst_video_multi_scale_change_state (GstElement *
+    element, GstStateChange transition);
+static GstPad *gst_video_multi_scale_request_new_pad (GstElement * element,
+    GstPadTemplate * templ, const gchar * name, const GstCaps * caps);
+static void gst_video_multi_scale_release_pad (GstElement * element,
+    GstPad * pad);
+
+static GstFlowReturn gst_video_multi_scale_chain (GstPad * pad,
+    GstObject * parent, GstBuffer * buffer);
+static gboolean gst_video_multi_scale_sink_event (GstPad * pad,
+    GstObject * parent, GstEvent * event);
+static gboolean gst_video_multi_scale_sink_query (GstPad * pad,
+    GstObject * parent, GstQuery * query);
+static gboolean gst_video_multi_scale_src_query (GstPad * pad,
+    GstObject * parent, GstQuery * query);
+
+static void
+gst_video_multi_scale_class_init (GstVideoMultiScaleClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+  GstElementClass *element_class = (GstElementClass *) klass;
+
+  GST_DEBUG_CATEGORY_INIT (video_multiscale_debug, "videomultiscale", 0,
+      "videomultiscale element");
+
+  gobject_class->finalize = gst_video_multi_scale_finalize;
+  gobject_class->set_property = gst_video_multi_scale_set_property;
+  gobject_class->get_property = gst_video_multi_scale_get_property;
+
+  /**
+   * GstVideoMultiScale:method:
+   *
+   * The resampler method used for all renditions.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_METHOD,
+      g_param_spec_enum ("method", "Method", "Resampler method",
+          gst_video_resampler_method_get_type (), DEFAULT_PROP_METHOD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_PLAYING));
+
+  /**
+   * GstVideoMultiScale:cascade:
+   *
+   * Scale every rendition from the nearest larger rendition instead of from
+   * the input. For the formats that are not scaled in a single pass over
+   * the input this reads a lot less memory when there are many renditions,
+   * at the cost of filtering the smaller renditions more than once. When
+   * enabled, the single pass is not used for any format.
+   *
+   * A rendition can only be scaled once the one it is scaled from is done.
+   * For a typical ladder, where every rendition is smaller than the previous
+   * one, this makes all renditions run one after another with only the
+   * threads of a single converter working on each.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_CASCADE,
+      g_param_spec_boolean ("cascade", "Cascade",
+          "Scale renditions from the nearest larger rendition",
+          DEFAULT_PROP_CASCADE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_PLAYING));
+
+  /**
+   * GstVideoMultiScale:n-threads:
+   *
+   * Maximum number of threads used for scaling, 0 uses one thread per
+   * processor. Renditions that don't depend on each other are scaled in
+   * parallel, the remaining threads are used to split up each rendition.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Threads",
+          "Maximum number of threads to use (0 = number of processors)", 0,
+          G_MAXUINT, DEFAULT_PROP_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  element_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_video_multi_scale_change_state);
+  element_class->request_new_pad =
+      GST_DEBUG_FUNCPTR (gst_video_multi_scale_request_new_pad);
+  element_class->release_pad =
+      GST_DEBUG_FUNCPTR (gst_video_multi_scale_release_pad);
+
+  gst_element_class_set_static_metadata (element_class,
+      "Video multi-resolution scaler", "Filter/Converter/Video/Scaler",
+      "Scales video to several resolutions at once",
+      "GStreamer developers <gstreamer-devel@lists.freedesktop.org>");
+
+  gst_element_class_add_static_pad_template (element_class, &sink_template);
+  gst_element_class_add_static_pad_template_with_gtype (element_class,
+      &src_template, GST_TYPE_VIDEO_MULTI_SCALE_PAD);
+
+  gst_type_mark_as_plugin_api (GST_TYPE_VIDEO_MULTI_SCALE_PAD, 0);
+}
+
+static void
+gst_video_multi_scale_init (GstVideoMultiScale * self)
+{
+  self->sinkpad = gst_pad_new_from_static_template (&sink_template, "sink");
+  gst_pad_set_chain_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_video_multi_scale_chain));
+  gst_pad_set_event_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_video_multi_scale_sink_event));
+  gst_pad_set_query_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_video_multi_scale_sink_query));
+  gst_element_add_pad (GST_ELEMENT_CAST (self), self->sinkpad);
+
+  self->method = DEFAULT_PROP_METHOD;
+  self->cascade = DEFAULT_PROP_CASCADE;
+  self->n_threads = DEFAULT_PROP_N_THREADS;
+
+  self->flow_combiner = gst_flow_combiner_new ();
+  gst_video_info_init (&self->in_info);
+}
+
+static void
+gst_video_multi_scale_finalize (GObject * object)
+{
+  GstVideoMultiScale *self = GST_VIDEO_MULTI_SCALE (object);
+
+  gst_flow_combiner_free (self->flow_combiner);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_video_multi_scale_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstVideoMultiScale *self = GST_VIDEO_MULTI_SCALE (object);
+
+  GST_OBJECT_LOCK (self);
+  switch (prop_id) {
+    case PROP_METHOD:
+      self->method = g_value_get_enum (value);
+      break;
+    case PROP_CASCADE:
+      self->cascade = g_value_get_boolean (value);
+      break;
+    case PROP_N_THREADS:
+      self->n_threads = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+static void
+gst_video_multi_scale_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstVideoMultiScale *self = GST_VIDEO_MULTI_SCALE (object);
+
+  GST_OBJECT_LOCK (self);
+  switch (prop_id) {
+    case PROP_METHOD:
+      g_value_set_enum (value, self->method);
+      break;
+    case PROP_CASCADE:
+      g_value_set_boolean (value, self->cascade);
+      break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, self->n_threads);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+static GList *
+gst_video_multi_scale_get_srcpads (GstVideoMultiScale * self)
+{
+  GList *pads;
+
+  GST_OBJECT_LOCK (self);
+  pads = g_list_copy_deep (GST_ELEMENT_CAST (self)->srcpads,
+      (GCopyFunc) gst_object_ref, NULL);
+  GST_OBJECT_UNLOCK (self);
+
+  return pads;
+}
+
+/* the renditions can have any size, everything else is the same as on the
+ * sinkpad */
+static GstCaps *
+gst_video_multi_scale_strip_size (GstCaps * caps)
+{
+  GstCaps *res;
+  guint i, n;
+
+  if (gst_caps_is_any (caps))
+    return gst_caps_ref (caps);
+
+  res = gst_caps_new_empty ();
+  n = gst_caps_get_size (caps);
+  for (i = 0; i < n; i++) {
+    GstStructure *s = gst_caps_get_structure (caps, i);
+    GstCapsFeatures *f = gst_caps_get_features (caps, i);
+
+    if (i > 0 && gst_caps_is_subset_structure_full (res, s, f))
+      continue;
+
+    s = gst_structure_copy (s);
+    gst_structure_set (s, "width", GST_TYPE_INT_RANGE, 1, 32767,
+        "height", GST_TYPE_INT_RANGE, 1, 32767, NULL);
+    gst_structure_remove_field (s, "pixel-aspect-ratio");
+    gst_caps_append_structure_full (res, s, gst_caps_features_copy (f));
+  }
+
+  return res;
+}
+
+static GstCaps *
+gst_video_multi_scale_sink_getcaps (GstVideoMultiScale * self,
+    GstCaps * filter)
+{
+  GstCaps *res;
+  GList *pads, *l;
+
+  res = gst_pad_get_pad_template_caps (self->sinkpad);
+
+  /* only the formats all linked renditions can handle */
+  pads = gst_video_multi_scale_get_srcpads (self);
+  for (l = pads; l && !gst_caps_is_empty (res); l = l->next) {
+    GstPad *pad = l->data;
+    GstCaps *peercaps, *tmp;
+
+    if (!gst_pad_is_linked (pad))
+      continue;
+
+    peercaps = gst_pad_peer_query_caps (pad, NULL);
+    tmp = gst_video_multi_scale_strip_size (peercaps);
+    gst_caps_take (&res, gst_caps_intersect (res, tmp));
+    gst_caps_unref (tmp);
+    gst_caps_unref (peercaps);
+  }
+  g_list_free_full (pads, gst_object_unref);
+
+  if (filter)
+    gst_caps_take (&res,
+        gst_caps_intersect_full (filter, res, GST_CAPS_INTERSECT_FIRST));
+
+  return res;
+}
+
+static GstCaps *
+gst_video_multi_scale_fixate (GstVideoMultiScale * self, GstCaps * incaps,
+    GstCaps * caps)
+{
+  GstStructure *ins, *s;
+  gint in_w = 0, in_h = 0, in_par_n = 1, in_par_d = 1, par_n, par_d;
+  gint num, den, w, h;
+  gboolean has_w, has_h;
+
+  caps = gst_caps_truncate (caps);
+  caps = gst_caps_make_writable (caps);
+  s = gst_caps_get_structure (caps, 0);
+  ins = gst_caps_get_structure (incaps, 0);
+
+  gst_structure_get_int (ins, "width", &in_w);
+  gst_structure_get_int (ins, "height", &in_h);
+  gst_structure_get_fraction (ins, "pixel-aspect-ratio", &in_par_n,
+      &in_par_d);
+
+  /* keep the pixel aspect ratio of the input if downstream allows it */
+  if (gst_structure_has_field (s, "pixel-aspect-ratio"))
+    gst_structure_fixate_field_nearest_fraction (s, "pixel-aspect-ratio",
+        in_par_n, in_par_d);
+  else
+    gst_structure_set (s, "pixel-aspect-ratio", GST_TYPE_FRACTION, in_par_n,
+        in_par_d, NULL);
+  gst_structure_get_fraction (s, "pixel-aspect-ratio", &par_n, &par_d);
+
+  /* width / height of the output that keeps the display aspect ratio */
+  if (!gst_util_fraction_multiply (in_w, in_h, in_par_n, in_par_d, &num,
+          &den) || !gst_util_fraction_multiply (num, den, par_d, par_n, &num,
+          &den)) {
+    GST_WARNING_OBJECT (self, "can't calculate the display aspect ratio");
+    num = in_w;
+    den = in_h;
+  }
+
+  has_w = gst_structure_get_int (s, "width", &w);
+  has_h = gst_structure_get_int (s, "height", &h);
+  if (!has_w && !has_h) {
+    /* nothing requested, keep the size of the input */
+    gst_structure_fixate_field_nearest_int (s, "width", in_w);
+    has_w = gst_structure_get_int (s, "width", &w);
+  }
+  if (has_w && !has_h)
+    gst_structure_fixate_field_nearest_int (s, "height",
+        gst_util_uint64_scale_int_round (w, den, num));
+  else if (!has_w && has_h)
+    gst_structure_fixate_field_nearest_int (s, "width",
+        gst_util_uint64_scale_int_round (h, num, den));
+
+  return gst_caps_fixate (caps);
+}
+
+static gboolean
+gst_video_multi_scale_decide_allocation (GstVideoMultiScale * self,
+    GstVideoMultiScalePad * pad, GstCaps * caps)
+{
+  GstBufferPool *pool = NULL;
+  GstStructure *config;
+  GstQuery *query;
+  guint size, min = 0, max = 0;
+
+  query = gst_query_new_allocation (caps, TRUE);
+  if (!gst_pad_peer_query (GST_PAD_CAST (pad), query))
+    GST_DEBUG_OBJECT (pad, "allocation query failed");
+
+  if (gst_query_get_n_allocation_pools (query) > 0)
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
+  gst_query_unref (query);
+
+  size = pad->info.size;
+
+  if (pool) {
+    config = gst_buffer_pool_get_config (pool);
+    gst_buffer_pool_config_set_params (config, caps, size, min, max);
+    if (!gst_buffer_pool_set_config (pool, config)) {
+      GST_DEBUG_OBJECT (pad, "downstream pool rejected our config");
+      gst_object_unref (pool);
+      pool = NULL;
+    }
+  }
+
+  if (pool == NULL) {
+    pool = gst_video_buffer_pool_new ();
+    config = gst_buffer_pool_get_config (pool);
+    gst_buffer_pool_config_set_params (config, caps, size, min, max);
+    if (!gst_buffer_pool_set_config (pool, config)) {
+      gst_object_unref (pool);
+      return FALSE;
+    }
+  }
+
+  if (pad->pool) {
+    gst_buffer_pool_set_active (pad->pool, FALSE);
+    gst_object_unref (pad->pool);
+  }
+  pad->pool = pool;
+
+  return gst_buffer_pool_set_active (pool, TRUE);
+}
+
+static gboolean
+store_stream_start (GstPad * pad, GstEvent ** event, gpointer user_data)
+{
+  if (GST_EVENT_TYPE (*event) < GST_EVENT_CAPS)
+    gst_pad_store_sticky_event (GST_PAD_CAST (user_data), *event);
+
+  return TRUE;
+}
+
+static gboolean
+store_sticky_event (GstPad * pad, GstEvent ** event, gpointer user_data)
+{
+  GstEventType type = GST_EVENT_TYPE (*event);
+
+  if (type > GST_EVENT_CAPS && type != GST_EVENT_EOS)
+    gst_pad_store_sticky_event (GST_PAD_CAST (user_data), *event);
+
+  return TRUE;
+}
+
+static gboolean
+gst_video_multi_scale_negotiate_pad (GstVideoMultiScale * self,
+    GstVideoMultiScalePad * pad)
+{
+  GstCaps *incaps, *filter, *caps;
+  GstVideoInfo info;
+  gboolean ret = FALSE;
+
+  incaps = gst_pad_get_current_caps (self->sinkpad);
+  if (incaps == NULL)
+    return FALSE;
+
+  filter = gst_video_multi_scale_strip_size (incaps);
+  caps = gst_pad_peer_query_caps (GST_PAD_CAST (pad), filter);
+  gst_caps_unref (filter);
+
+  if (gst_caps_is_empty (caps)) {
+    GST_WARNING_OBJECT (pad, "downstream accepts none of %" GST_PTR_FORMAT,
+        incaps);
+    gst_caps_unref (caps);
+    goto done;
+  }
+
+  caps = gst_video_multi_scale_fixate (self, incaps, caps);
+  GST_DEBUG_OBJECT (pad, "fixated to %" GST_PTR_FORMAT, caps);
+
+  if (!gst_video_info_from_caps (&info, caps)) {
+    GST_WARNING_OBJECT (pad, "invalid caps %" GST_PTR_FORMAT, caps);
+    gst_caps_unref (caps);
+    goto done;
+  }
+
+  if (gst_pad_set_caps (GST_PAD_CAST (pad), caps)) {
+    pad->info = info;
+    ret = gst_video_multi_scale_decide_allocation (self, pad, caps);
+  }
+  gst_caps_unref (caps);
+
+  if (pad->convert) {
+    gst_video_converter_free (pad->convert);
+    pad->convert = NULL;
+  }
+  gst_video_multi_scale_pad_free_scalers (pad);
+
+done:
+  pad->negotiated = ret;
+  if (ret)
+    gst_pad_sticky_events_foreach (self->sinkpad, store_sticky_event, pad);
+  else
+    gst_pad_mark_reconfigure (GST_PAD_CAST (pad));
+  gst_caps_unref (incaps);
+
+  return ret;
+}
+
+static gboolean
+gst_video_multi_scale_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  GstVideoMultiScale *self = GST_VIDEO_MULTI_SCALE (parent);
+  GList *pads, *l;
+
+  GST_DEBUG_OBJECT (pad, "received event %" GST_PTR_FORMAT, event);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CAPS:
+    {
+      GstCaps *caps;
+      GstVideoInfo info;
+
+      gst_event_parse_caps (event, &caps);
+      if (!gst_video_info_from_caps (&info, caps)) {
+        GST_WARNING_OBJECT (self, "invalid caps %" GST_PTR_FORMAT, caps);
+        gst_event_unref (event);
+        return FALSE;
+      }
+      self->in_info = info;
+      self->negotiated = TRUE;
+      gst_event_unref (event);
+
+      /* the caps must be on the srcpads before the segment, so negotiate
+       * all linked renditions now */
+      pads = gst_video_multi_scale_get_srcpads (self);
+      for (l = pads; l; l = l->next) {
+        GstVideoMultiScalePad *srcpad = l->data;
+
+        srcpad->negotiated = FALSE;
+        if (gst_pad_is_linked (GST_PAD_CAST (srcpad))) {
+          gst_pad_check_reconfigure (GST_PAD_CAST (srcpad));
+          gst_video_multi_scale_negotiate_pad (self, srcpad);
+        }
+      }
+      g_list_free_full (pads, gst_object_unref);
+
+      return TRUE;
+    }
+    case GST_EVENT_FLUSH_STOP:
+      GST_OBJECT_LOCK (self);
+      gst_flow_combiner_reset (self->flow_combiner);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      break;
+  }
+
+  if (GST_EVENT_IS_STICKY (event) && GST_EVENT_TYPE (event) > GST_EVENT_CAPS
+      && GST_EVENT_TYPE (event) != GST_EVENT_EOS) {
+    /* renditions without caps get these when they are negotiated */
+    pads = gst_video_multi_scale_get_srcpads (self);
+    for (l = pads; l; l = l->next) {
+      GstPad *srcpad = l->data;
+
+      if (gst_pad_has_current_caps (srcpad))
+        gst_pad_push_event (srcpad, gst_event_ref (event));
+    }
+    g_list_free_full (pads, gst_object_unref);
+    gst_event_unref (event);
+
+    return TRUE;
+  }
+
+  return gst_pad_event_default (pad, parent, event);
+}
+
+static gboolean
+gst_video_multi_scale_sink_query (GstPad * pad, GstObject * parent,
+    GstQuery * query)
+{
+  GstVideoMultiScale *self = GST_VIDEO_MULTI_SCALE (parent);
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+    {
+      GstCaps *filter, *caps;
+
+      gst_query_parse_caps (query, &filter);
+      caps = gst_video_multi_scale_sink_getcaps (self, filter);
+      gst_query_set_caps_result (query, caps);
+      gst_caps_unref (caps);
+
+      return TRUE;
+    }
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+static gboolean
+gst_video_multi_scale_src_query (GstPad * pad, GstObject * parent,
+    GstQuery * query)
+{
+  GstVideoMultiScale *self = GST_VIDEO_MULTI_SCALE (parent);
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+    {
+      GstCaps *filter, *caps, *res;
+
+      gst_query_parse_caps (query, &filter);
+      caps = gst_pad_get_current_caps (self->sinkpad);
+      if (caps) {
+        res = gst_video_multi_scale_strip_size (caps);
+        gst_caps_unref (caps);
+      } else {
+        res = gst_pad_get_pad_template_caps (pad);
+      }
+
+      if (filter)
+        gst_caps_take (&res,
+            gst_caps_intersect_full (filter, res, GST_CAPS_INTERSECT_FIRST));
+
+      gst_query_set_caps_result (query, res);
+      gst_caps_unref (res);
+
+      return TRUE;
+    }
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+static gint
+compare_area (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+  const GstVideoMultiScalePad *pa = *(const GstVideoMultiScalePad **) a;
+  const GstVideoMultiScalePad *pb = *(const GstVideoMultiScalePad **) b;
+  gint64 area_a = (gint64) pa->info.width * pa->info.height;
+  gint64 area_b = (gint64) pb->info.width * pb->info.height;
+
+  /* largest first */
+  return area_a < area_b ? 1 : area_a > area_b ? -1 : 0;
+}
+
+static gboolean
+gst_video_multi_scale_setup_converter (GstVideoMultiScale * self,
+    GstVideoMultiScalePad * pad, GstVideoResamplerMethod method,
+    guint n_threads)
+{
+  GstVideoInfo *in_info = pad->source ? &pad->source->info : &self->in_info;
+  GstStructure *options;
+
+  if (pad->convert && pad->convert_method == method
+      && pad->convert_threads == n_threads
+      && gst_video_info_is_equal (&pad->convert_info, in_info))
+    return TRUE;
+
+  if (pad->convert)
+    gst_video_converter_free (pad->convert);
+
+  GST_DEBUG_OBJECT (pad, "scaling %dx%d -> %dx%d from %s with %u threads",
+      in_info->width, in_info->height, pad->info.width, pad->info.height,
+      pad->source ? GST_PAD_NAME (pad->source) : "the input", n_threads);
+
+  options = gst_structure_new ("GstVideoMultiScale",
+      GST_VIDEO_CONVERTER_OPT_RESAMPLER_METHOD,
+      GST_TYPE_VIDEO_RESAMPLER_METHOD, method,
+      GST_VIDEO_CONVERTER_OPT_DITHER_METHOD, GST_TYPE_VIDEO_DITHER_METHOD,
+      GST_VIDEO_DITHER_NONE, GST_VIDEO_CONVERTER_OPT_THREADS, G_TYPE_UINT,
+      n_threads, NULL);
+
+  pad->convert = gst_video_converter_new (in_info, &pad->info, options);
+  pad->convert_info = *in_info;
+  pad->convert_method = method;
+  pad->convert_threads = n_threads;
+
+  return pad->convert != NULL;
+}
+
+static void
+gst_video_multi_scale_convert_func (gpointer data)
+{
+  GstVideoMultiScalePad *pad = data;
+
+  gst_video_converter_frame (pad->convert, pad->src_frame, &pad->frame);
+}
+
+/* Checks if all renditions can be scaled in a single pass over the input.
+ * That is done with one scaler per component for formats with every 8-bit
+ * component in its own plane, and with one scaler for all components of
+ * packed formats with four 8-bit components, like the converter does. */
+static gboolean
+gst_video_multi_scale_single_pass_format (const GstVideoInfo * info,
+    GstVideoFormat * format, guint * n_comps)
+{
+  const GstVideoFormatInfo *finfo = info->finfo;
+  guint i, n = GST_VIDEO_FORMAT_INFO_N_COMPONENTS (finfo);
+  gboolean planar, packed;
+
+  if (GST_VIDEO_INFO_IS_INTERLACED (info)
+      || GST_VIDEO_FORMAT_INFO_IS_TILED (finfo)
+      || GST_VIDEO_FORMAT_INFO_HAS_PALETTE (finfo)
+      || GST_VIDEO_FORMAT_INFO_IS_COMPLEX (finfo))
+    return FALSE;
+
+  planar = GST_VIDEO_FORMAT_INFO_N_PLANES (finfo) == n;
+  packed = GST_VIDEO_FORMAT_INFO_N_PLANES (finfo) == 1 && n > 1;
+  for (i = 0; i < n; i++) {
+    if (GST_VIDEO_FORMAT_INFO_DEPTH (finfo, i) != 8
+        || GST_VIDEO_FORMAT_INFO_SHIFT (finfo, i) != 0)
+      return FALSE;
+    if (GST_VIDEO_FORMAT_INFO_PSTRIDE (finfo, i) != 1)
+      planar = FALSE;
+    if (GST_VIDEO_FORMAT_INFO_PSTRIDE (finfo, i) != 4
+        || GST_VIDEO_FORMAT_INFO_W_SUB (finfo, i) != 0
+        || GST_VIDEO_FORMAT_INFO_H_SUB (finfo, i) != 0)
+      packed = FALSE;
+  }
+
+  if (planar) {
+    *format = GST_VIDEO_FORMAT_GRAY8;
+    *n_comps = n;
+  } else if (packed) {
+    /* scaling doesn't care about the order of the components */
+    *format = GST_VIDEO_FORMAT_AYUV;
+    *n_comps = 1;
+  }
+
+  return planar || packed;
+}
+
+static gboolean
+gst_video_multi_scale_setup_scalers (GstVideoMultiScale * self,
+    GstVideoMultiScalePad * pad, GstVideoResamplerMethod method,
+    guint n_comps, guint n_bands)
+{
+  GstVideoInfo *in_info = &self->in_info;
+  guint band, c;
+
+  if (pad->hscale && pad->scaler_method == method
+      && pad->n_scalers == n_bands * GST_VIDEO_MAX_COMPONENTS
+      && gst_video_info_is_equal (&pad->scaler_info, in_info))
+    return TRUE;
+
+  gst_video_multi_scale_pad_free_scalers (pad);
+
+  GST_DEBUG_OBJECT (pad, "scaling %dx%d -> %dx%d in a single pass with %u "
+      "bands", in_info->width, in_info->height, pad->info.width,
+      pad->info.height, n_bands);
+
+  /* the scalers keep temporary lines, so every band gets its own */
+  pad->n_scalers = n_bands * GST_VIDEO_MAX_COMPONENTS;
+  pad->hscale = g_new0 (GstVideoScaler *, pad->n_scalers);
+  pad->vscale = g_new0 (GstVideoScaler *, pad->n_scalers);
+  pad->scaler_info = *in_info;
+  pad->scaler_method = method;
+
+  for (band = 0; band < n_bands; band++) {
+    for (c = 0; c < n_comps; c++) {
+      guint i = band * GST_VIDEO_MAX_COMPONENTS + c;
+
+      pad->hscale[i] = gst_video_scaler_new (method,
+          GST_VIDEO_SCALER_FLAG_NONE, 0, GST_VIDEO_INFO_COMP_WIDTH (in_info, c),
+          GST_VIDEO_INFO_COMP_WIDTH (&pad->info, c), NULL);
+      pad->vscale[i] = gst_video_scaler_new (method,
+          GST_VIDEO_SCALER_FLAG_NONE, 0,
+          GST_VIDEO_INFO_COMP_HEIGHT (in_info, c),
+          GST_VIDEO_INFO_COMP_HEIGHT (&pad->info, c), NULL);
+      if (pad->hscale[i] == NULL || pad->vscale[i] == NULL) {
+        gst_video_multi_scale_pad_free_scalers (pad);
+        return FALSE;
+      }
+    }
+  }
+
+  return TRUE;
+}
+
+/* one component of a horizontal band of all renditions */
+typedef struct
+{
+  GstVideoMultiScalePad **outputs;
+  guint n_outputs;
+  GstVideoFrame *in_frame;
+  GstVideoFormat format;
+  guint comp;
+  guint band;
+  guint n_bands;
+} GstVideoMultiScaleBand;
+
+typedef struct
+{
+  GstVideoScaler *hscale;
+  GstVideoScaler *vscale;
+  guint8 *dest;
+  gint dest_stride;
+  guint width;
+  guint y, end;
+
+  /* the last horizontally scaled input lines */
+  guint8 *lines;
+  gsize line_size;
+  guint n_lines;
+  gpointer *taps;
+} GstVideoMultiScaleBandOutput;
+
+#define BAND_LINE(o,l) ((o)->lines + ((l) % (o)->n_lines) * (o)->line_size)
+
+static void
+gst_video_multi_scale_band_func (gpointer data)
+{
+  GstVideoMultiScaleBand *band = data;
+  GstVideoFrame *in_frame = band->in_frame;
+  GstVideoMultiScaleBandOutput *outs;
+  guint c = band->comp, idx = band->band * GST_VIDEO_MAX_COMPONENTS + c;
+  guint in_height = GST_VIDEO_FRAME_COMP_HEIGHT (in_frame, c);
+  guint8 *in_data = GST_VIDEO_FRAME_PLANE_DATA (in_frame,
+      GST_VIDEO_FRAME_COMP_PLANE (in_frame, c));
+  gint in_stride = GST_VIDEO_FRAME_COMP_STRIDE (in_frame, c);
+  guint pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (in_frame, c);
+  guint first = G_MAXUINT, last = 0, in_offset, n_taps, i, j, y;
+
+  outs = g_newa (GstVideoMultiScaleBandOutput, band->n_outputs);
+  for (i = 0; i < band->n_outputs; i++) {
+    GstVideoMultiScalePad *pad = band->outputs[i];
+    GstVideoMultiScaleBandOutput *o = &outs[i];
+    guint out_height = GST_VIDEO_FRAME_COMP_HEIGHT (&pad->frame, c);
+
+    o->hscale = pad->hscale[idx];
+    o->vscale = pad->vscale[idx];
+    o->dest = GST_VIDEO_FRAME_PLANE_DATA (&pad->frame,
+        GST_VIDEO_FRAME_COMP_PLANE (&pad->frame, c));
+    o->dest_stride = GST_VIDEO_FRAME_COMP_STRIDE (&pad->frame, c);
+    o->width = GST_VIDEO_FRAME_COMP_WIDTH (&pad->frame, c);
+    o->y = out_height * band->band / band->n_bands;
+    o->end = out_height * (band->band + 1) / band->n_bands;
+    o->n_lines = gst_video_scaler_get_max_taps (o->vscale);
+    o->line_size = o->width * pstride;
+    o->lines = g_malloc (o->n_lines * o->line_size);
+    o->taps = g_new (gpointer, o->n_lines);
+
+    if (o->y < o->end) {
+      gst_video_scaler_get_coeff (o->vscale, o->y, &in_offset, NULL);
+      first = MIN (first, in_offset);
+      gst_video_scaler_get_coeff (o->vscale, o->end - 1, &in_offset, &n_taps);
+      last = MAX (last, MIN (in_offset + n_taps, in_height) - 1);
+    }
+  }
+
+  /* Every input line of the band is read once and scaled horizontally for
+   * all renditions that need it while it is in the cache. An output line is
+   * filtered vertically as soon as all its input lines are scaled, the
+   * vertical filters only read the few lines kept for each rendition. */
+  for (y = first; first <= last && y <= last; y++) {
+    guint8 *src = in_data + y * in_stride;
+
+    for (i = 0; i < band->n_outputs; i++) {
+      GstVideoMultiScaleBandOutput *o = &outs[i];
+
+      if (o->y >= o->end)
+        continue;
+
+      /* the input lines before the first tap are skipped */
+      gst_video_scaler_get_coeff (o->vscale, o->y, &in_offset, NULL);
+      if (y < in_offset)
+        continue;
+
+      gst_video_scaler_horizontal (o->hscale, band->format, src,
+          BAND_LINE (o, y), 0, o->width);
+
+      while (o->y < o->end) {
+        gst_video_scaler_get_coeff (o->vscale, o->y, &in_offset, &n_taps);
+        if (MIN (in_offset + n_taps, in_height) - 1 > y)
+          break;
+
+        /* taps past the last line repeat it */
+        for (j = 0; j < n_taps; j++)
+          o->taps[j] = BAND_LINE (o, MIN (in_offset + j, in_height - 1));
+        gst_video_scaler_vertical (o->vscale, band->format, o->taps,
+            o->dest + o->y * o->dest_stride, o->y, o->width);
+        o->y++;
+      }
+    }
+  }
+
+  for (i = 0; i < band->n_outputs; i++) {
+    g_free (outs[i].lines);
+    g_free (outs[i].taps);
+  }
+}
+
+static void
+gst_video_multi_scale_run (GstVideoMultiScale * self,
+    GstTaskPoolFunction func, gpointer * jobs, guint n_jobs)
+{
+  gpointer *handles;
+  guint i;
+
+  if (n_jobs == 0)
+    return;
+
+  /* one job runs in this thread, the others in the pool */
+  handles = g_newa (gpointer, n_jobs);
+  for (i = 1; i < n_jobs; i++) {
+    GError *err = NULL;
+
+    handles[i] = gst_task_pool_push (self->task_pool, func, jobs[i], &err);
+    if (err) {
+      GST_WARNING_OBJECT (self, "failed to push task: %s", err->message);
+      g_clear_error (&err);
+      func (jobs[i]);
+    }
+  }
+
+  func (jobs[0]);
+
+  for (i = 1; i < n_jobs; i++) {
+    if (handles[i])
+      gst_task_pool_join (self->task_pool, handles[i]);
+  }
+}
+
+static GstFlowReturn
+gst_video_multi_scale_chain (GstPad * sinkpad, GstObject * parent,
+    GstBuffer * buffer)
+{
+  GstVideoMultiScale *self = GST_VIDEO_MULTI_SCALE (parent);
+  GstVideoMultiScalePad **outputs;
+  GstVideoResamplerMethod method;
+  GstVideoFormat scale_format = GST_VIDEO_FORMAT_UNKNOWN;
+  GstVideoFrame in_frame;
+  GstFlowReturn ret = GST_FLOW_NOT_LINKED;
+  GList *pads, *l;
+  guint i, j, level, n_outputs = 0, n_levels = 0, n_threads;
+  guint n_comps = 0, n_bands = 1;
+  guint *level_size;
+  gpointer *jobs;
+  gboolean cascade, single_pass;
+
+  if (!self->negotiated)
+    goto not_negotiated;
+
+  GST_OBJECT_LOCK (self);
+  method = self->method;
+  cascade = self->cascade;
+  n_threads = self->n_threads;
+  GST_OBJECT_UNLOCK (self);
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  pads = gst_video_multi_scale_get_srcpads (self);
+  outputs = g_new (GstVideoMultiScalePad *, g_list_length (pads) + 1);
+  level_size = g_new0 (guint, g_list_length (pads) + 1);
+
+  for (l = pads; l; l = l->next) {
+    GstVideoMultiScalePad *pad = l->data;
+
+    pad->outbuf = NULL;
+    pad->flow = GST_FLOW_OK;
+
+    if (!gst_pad_is_linked (GST_PAD_CAST (pad))) {
+      pad->flow = GST_FLOW_NOT_LINKED;
+      continue;
+    }
+
+    if ((gst_pad_check_reconfigure (GST_PAD_CAST (pad)) || !pad->negotiated)
+        && !gst_video_multi_scale_negotiate_pad (self, pad)) {
+      if (GST_PAD_IS_FLUSHING (pad))
+        pad->flow = GST_FLOW_FLUSHING;
+      else
+        pad->flow = GST_FLOW_NOT_NEGOTIATED;
+      continue;
+    }
+
+    outputs[n_outputs++] = pad;
+  }
+
+  /* Process the renditions from the largest to the smallest, each one is
+   * scaled from the smallest already scaled rendition that is at least as
+   * large or from the input. Renditions that only depend on renditions of
+   * an earlier level are scaled in parallel. */
+  g_qsort_with_data (outputs, n_outputs, sizeof (GstVideoMultiScalePad *),
+      compare_area, NULL);
+
+  for (i = 0; i < n_outputs; i++) {
+    GstVideoMultiScalePad *pad = outputs[i];
+
+    pad->source = NULL;
+    pad->level = 0;
+    for (j = i; cascade && j > 0; j--) {
+      GstVideoMultiScalePad *larger = outputs[j - 1];
+
+      if (larger->info.width >= pad->info.width
+          && larger->info.height >= pad->info.height) {
+        pad->source = larger;
+        pad->level = larger->level + 1;
+        break;
+      }
+    }
+    level_size[pad->level]++;
+    n_levels = MAX (n_levels, pad->level + 1);
+  }
+
+  /* without cascading, all renditions are scaled in one pass over the input
+   * when the format allows it, split into bands of at least 64 lines */
+  single_pass = !cascade && n_outputs > 1
+      && gst_video_multi_scale_single_pass_format (&self->in_info,
+      &scale_format, &n_comps);
+  if (single_pass)
+    n_bands = CLAMP (GST_VIDEO_INFO_HEIGHT (&self->in_info) / 64, 1,
+        n_threads);
+
+  if (!gst_video_frame_map (&in_frame, &self->in_info, buffer, GST_MAP_READ))
+    goto invalid_buffer;
+
+  for (i = 0; i < n_outputs; i++) {
+    GstVideoMultiScalePad *pad = outputs[i];
+    gboolean setup;
+
+    if (pad->source && pad->source->flow != GST_FLOW_OK) {
+      pad->flow = pad->source->flow;
+      continue;
+    }
+
+    if (single_pass)
+      setup = gst_video_multi_scale_setup_scalers (self, pad, method, n_comps,
+          n_bands);
+    else
+      setup = gst_video_multi_scale_setup_converter (self, pad, method,
+          MAX (1, n_threads / level_size[pad->level]));
+
+    if (!setup) {
+      GST_ELEMENT_WARNING (self, CORE, NEGOTIATION, (NULL),
+          ("can't scale to %dx%d", pad->info.width, pad->info.height));
+      pad->flow = GST_FLOW_NOT_NEGOTIATED;
+      continue;
+    }
+
+    pad->flow = gst_buffer_pool_acquire_buffer (pad->pool, &pad->outbuf, NULL);
+    if (pad->flow != GST_FLOW_OK)
+      continue;
+
+    gst_buffer_copy_into (pad->outbuf, buffer,
+        GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+
+    /* mapped for reading too, smaller renditions can be scaled from it */
+    if (!gst_video_frame_map (&pad->frame, &pad->info, pad->outbuf,
+            GST_MAP_READWRITE)) {
+      gst_buffer_replace (&pad->outbuf, NULL);
+      pad->flow = GST_FLOW_ERROR;
+      continue;
+    }
+    pad->src_frame = pad->source ? &pad->source->frame : &in_frame;
+  }
+
+  if (single_pass) {
+    GstVideoMultiScalePad **active;
+    GstVideoMultiScaleBand *bands;
+    guint n_active = 0, n_jobs = 0;
+
+    active = g_newa (GstVideoMultiScalePad *, n_outputs + 1);
+    for (i = 0; i < n_outputs; i++) {
+      if (outputs[i]->outbuf)
+        active[n_active++] = outputs[i];
+    }
+
+    bands = g_newa (GstVideoMultiScaleBand, n_comps * n_bands);
+    jobs = g_newa (gpointer, n_comps * n_bands);
+    for (i = 0; i < n_comps && n_active > 0; i++) {
+      for (j = 0; j < n_bands; j++) {
+        GstVideoMultiScaleBand *band = &bands[n_jobs];
+
+        band->outputs = active;
+        band->n_outputs = n_active;
+        band->in_frame = &in_frame;
+        band->format = scale_format;
+        band->comp = i;
+        band->band = j;
+        band->n_bands = n_bands;
+        jobs[n_jobs++] = band;
+      }
+    }
+    gst_video_multi_scale_run (self, gst_video_multi_scale_band_func, jobs,
+        n_jobs);
+  } else {
+    jobs = g_newa (gpointer, n_outputs + 1);
+    for (level = 0; level < n_levels; level++) {
+      guint n_jobs = 0;
+
+      for (i = 0; i < n_outputs; i++) {
+        if (outputs[i]->level == level && outputs[i]->outbuf)
+          jobs[n_jobs++] = outputs[i];
+      }
+      gst_video_multi_scale_run (self, gst_video_multi_scale_convert_func,
+          jobs, n_jobs);
+    }
+  }
+
+  for (i = 0; i < n_outputs; i++) {
+    if (outputs[i]->outbuf)
+      gst_video_frame_unmap (&outputs[i]->frame);
+  }
+  gst_video_frame_unmap (&in_frame);
+  gst_buffer_unref (buffer);
+
+  for (l = pads; l; l = l->next) {
+    GstVideoMultiScalePad *pad = l->data;
+
+    if (pad->outbuf) {
+      pad->flow = gst_pad_push (GST_PAD_CAST (pad), pad->outbuf);
+      pad->outbuf = NULL;
+    }
+
+    /* pads released in the meantime don't count */
+    GST_OBJECT_LOCK (self);
+    if (GST_OBJECT_PARENT (pad) == GST_OBJECT_CAST (self))
+      ret = gst_flow_combiner_update_pad_flow (self->flow_combiner,
+          GST_PAD_CAST (pad), pad->flow);
+    GST_OBJECT_UNLOCK (self);
+  }
+
+  g_free (level_size);
+  g_free (outputs);
+  g_list_free_full (pads, gst_object_unref);
+
+  return ret;
+
+  /* ERRORS */
+not_negotiated:
+  {
+    GST_ELEMENT_ERROR (self, CORE, NEGOTIATION, (NULL),
+        ("received buffer before caps"));
+    gst_buffer_unref (buffer);
+    return GST_FLOW_NOT_NEGOTIATED;
+  }
+invalid_buffer:
+  {
+    GST_ELEMENT_ERROR (self, STREAM, FORMAT, (NULL),
+        ("failed to map the input buffer"));
+    gst_buffer_unref (buffer);
+    g_free (level_size);
+    g_free (outputs);
+    g_list_free_full (pads, gst_object_unref);
+    return GST_FLOW_ERROR;
+  }
+}
+
+static GstPad *
+gst_video_multi_scale_request_new_pad (GstElement * element,
+    GstPadTemplate * templ, const gchar * name, const GstCaps * caps)
+{
+  GstVideoMultiScale *self = GST_VIDEO_MULTI_SCALE (element);
+  GstPad *pad;
+  gchar *pad_name;
+  guint index;
+
+  if (name && (pad = gst_element_get_static_pad (element, name))) {
+    GST_WARNING_OBJECT (self, "pad %s already exists", name);
+    gst_object_unref (pad);
+    return NULL;
+  }
+
+  GST_OBJECT_LOCK (self);
+  if (name && sscanf (name, "src_%u", &index) == 1) {
+    self->pad_count = MAX (self->pad_count, index + 1);
+  } else {
+    index = self->pad_count++;
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  pad_name = g_strdup_printf ("src_%u", index);
+  pad = g_object_new (GST_TYPE_VIDEO_MULTI_SCALE_PAD, "name", pad_name,
+      "direction", templ->direction, "template", templ, NULL);
+  g_free (pad_name);
+
+  gst_pad_set_query_function (pad,
+      GST_DEBUG_FUNCPTR (gst_video_multi_scale_src_query));
+
+  /* only the stream-start, the rest follows once the pad has caps */
+  gst_pad_sticky_events_foreach (self->sinkpad, store_stream_start, pad);
+
+  GST_OBJECT_LOCK (self);
+  gst_flow_combiner_add_pad (self->flow_combiner, pad);
+  GST_OBJECT_UNLOCK (self);
+
+  gst_element_add_pad (element, pad);
+
+  return pad;
+}
+
+static void
+gst_video_multi_scale_release_pad (GstElement * element, GstPad * pad)
+{
+  GstVideoMultiScale *self = GST_VIDEO_MULTI_SCALE (element);
+
+  GST_OBJECT_LOCK (self);
+  gst_flow_combiner_remove_pad (self->flow_combiner, pad);
+  GST_OBJECT_UNLOCK (self);
+
+  gst_pad_set_active (pad, FALSE);
+  gst_element_remove_pad (element, pad);
+}
+
+static GstStateChangeReturn
+gst_video_multi_scale_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  GstVideoMultiScale *self = GST_VIDEO_MULTI_SCALE (element);
+  GstStateChangeReturn ret;
+  GList *pads, *l;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+    {
+      guint n_threads;
+
+      GST_OBJECT_LOCK (self);
+      gst_flow_combiner_reset (self->flow_combiner);
+      n_threads = self->n_threads;
+      GST_OBJECT_UNLOCK (self);
+      if (n_threads == 0)
+        n_threads = g_get_num_processors ();
+
+      self->task_pool = gst_shared_task_pool_new ();
+      gst_shared_task_pool_set_max_threads (GST_SHARED_TASK_POOL
+          (self->task_pool), n_threads);
+      gst_task_pool_prepare (self->task_pool, NULL);
+      break;
+    }
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      pads = gst_video_multi_scale_get_srcpads (self);
+      for (l = pads; l; l = l->next)
+        gst_video_multi_scale_pad_reset (l->data);
+      g_list_free_full (pads, gst_object_unref);
+
+      gst_task_pool_cleanup (self->task_pool);
+      gst_clear_object (&self->task_pool);
+      gst_video_info_init (&self->in_info);
+      self->negotiated = FALSE;
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
@@ -0,0 +1,59 @@
+/* GStreamer
+ * Copyright (C) 2022 GStreamer developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <gst/gst.h>
+#include <gst/base/gstflowcombiner.h>
+#include <gst/video/video.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_VIDEO_MULTI_SCALE_PAD (gst_video_multi_scale_pad_get_type())
+G_DECLARE_FINAL_TYPE (GstVideoMultiScalePad, gst_video_multi_scale_pad,
+    GST, VIDEO_MULTI_SCALE_PAD, GstPad);
+
+#define GST_TYPE_VIDEO_MULTI_SCALE (gst_video_multi_scale_get_type())
+G_DECLARE_FINAL_TYPE (GstVideoMultiScale, gst_video_multi_scale,
+    GST, VIDEO_MULTI_SCALE, GstElement);
+
+struct _GstVideoMultiScale
+{
+  GstElement parent;
+
+  GstPad *sinkpad;
+
+  /* properties */
+  GstVideoResamplerMethod method;
+  gboolean cascade;
+  guint n_threads;
+
+  /* protected by the object lock */
+  GstFlowCombiner *flow_combiner;
+  guint pad_count;
+
+  /* only used from the streaming thread */
+  GstVideoInfo in_info;
+  gboolean negotiated;
+  GstTaskPool *task_pool;
+};
+
+GST_ELEMENT_REGISTER_DECLARE (videomultiscale);
+
+G_END_DECLS
@@ -2220,6 +2220,398 @@ GST_START_TEST (test_qos_message_live)
 
 GST_END_TEST;
 
+static GstBuffer *
+new_buffer_s16 (gint16 value, guint num_samples, GstClockTime ts,
+    GstClockTime dur, GstBufferFlags flags)
+{
+  GstMapInfo map;
+  GstBuffer *buffer = gst_buffer_new_and_alloc (num_samples * 2);
+  gint16 *data;
+  guint i;
+
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  data = (gint16 *) map.data;
+  for (i = 0; i < num_samples; i++)
+    data[i] = flags & GST_BUFFER_FLAG_GAP ? 0 : value;
+  gst_buffer_unmap (buffer, &map);
+  GST_BUFFER_TIMESTAMP (buffer) = ts;
+  GST_BUFFER_DURATION (buffer) = dur;
+  if (flags)
+    GST_BUFFER_FLAG_SET (buffer, flags);
+  return buffer;
+}
+
+static void
+check_buffers_s16 (GList * received_buffers, const gint16 * expected)
+{
+  GstMapInfo map;
+  GList *l;
+  gsize i, j;
+
+  /* Should have 2 * 0.5s buffers */
+  fail_unless_equals_int (g_list_length (received_buffers), 2);
+  for (i = 0, l = received_buffers; l; l = l->next, i++) {
+    GstBuffer *buffer = l->data;
+    const gint16 *data;
+
+    fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buffer),
+        i * 500 * GST_MSECOND);
+
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    fail_unless_equals_int (map.size, 1000);
+    data = (const gint16 *) map.data;
+    for (j = 0; j < map.size / 2; j++)
+      fail_unless_equals_int (data[j], expected[i]);
+    gst_buffer_unmap (buffer, &map);
+  }
+}
+
+/* per 0.5s block, input 0 is mixed at half volume and input 2 is a gap in
+ * the second block */
+static const gint16 mix_minus_input[3][2] = {
+  {30000, 20000}, {-20000, 30000}, {10000, 0}
+};
+
+static void
+run_mix_minus_test (gint muted, const gint16 * expected_mix,
+    const gint16 expected_minus[3][2])
+{
+  GstSegment segment;
+  GstElement *bin, *audiomixer, *queue[3], *out_queue[4], *sink[4];
+  GstPad *sinkpad[3], *queue_sinkpad[3], *pad;
+  GList *received_buffers[4] = { NULL, };
+  GstStateChangeReturn state_res;
+  GstBus *bus;
+  GstCaps *caps;
+  GstEvent *event;
+  GstFlowReturn ret;
+  gint i;
+
+  bin = gst_pipeline_new ("pipeline");
+  bus = gst_element_get_bus (bin);
+  gst_bus_add_signal_watch_full (bus, G_PRIORITY_HIGH);
+
+  g_signal_connect (bus, "message::error", (GCallback) message_received, bin);
+  g_signal_connect (bus, "message::warning", (GCallback) message_received, bin);
+  g_signal_connect (bus, "message::eos", (GCallback) message_received, bin);
+
+  audiomixer = gst_element_factory_make ("audiomixer", "audiomixer");
+  g_object_set (audiomixer, "output-buffer-duration", 500 * GST_MSECOND,
+      "mix-minus", TRUE, NULL);
+  gst_bin_add (GST_BIN (bin), audiomixer);
+
+  /* sink[0] gets the full mix, sink[i + 1] what input i gets to hear. All
+   * outputs are pushed from the same thread, every branch needs a queue */
+  for (i = 0; i < 4; i++) {
+    out_queue[i] = gst_element_factory_make ("queue", NULL);
+    sink[i] = gst_element_factory_make ("fakesink", NULL);
+    g_object_set (sink[i], "signal-handoffs", TRUE, NULL);
+    g_signal_connect (sink[i], "handoff",
+        (GCallback) handoff_buffer_collect_cb, &received_buffers[i]);
+    gst_bin_add_many (GST_BIN (bin), out_queue[i], sink[i], NULL);
+    fail_unless (gst_element_link (out_queue[i], sink[i]));
+  }
+  fail_unless (gst_element_link (audiomixer, out_queue[0]));
+
+  state_res = gst_element_set_state (bin, GST_STATE_PAUSED);
+  ck_assert_int_ne (state_res, GST_STATE_CHANGE_FAILURE);
+
+  caps = gst_caps_new_simple ("audio/x-raw",
+      "format", G_TYPE_STRING, GST_AUDIO_NE (S16),
+      "layout", G_TYPE_STRING, "interleaved",
+      "rate", G_TYPE_INT, 1000, "channels", G_TYPE_INT, 1, NULL);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  event = gst_event_new_segment (&segment);
+
+  for (i = 0; i < 3; i++) {
+    gchar *name;
+
+    queue[i] = gst_element_factory_make ("queue", NULL);
+    gst_bin_add (GST_BIN (bin), queue[i]);
+    gst_element_sync_state_with_parent (queue[i]);
+
+    sinkpad[i] = gst_element_request_pad_simple (audiomixer, "sink_%u");
+    fail_if (sinkpad[i] == NULL, NULL);
+    pad = gst_element_get_static_pad (queue[i], "src");
+    fail_unless (gst_pad_link (pad, sinkpad[i]) == GST_PAD_LINK_OK);
+    gst_object_unref (pad);
+
+    /* the companion source pad appears together with the sink pad */
+    name = g_strdup_printf ("minus_%s", GST_OBJECT_NAME (sinkpad[i]) + 5);
+    pad = gst_element_get_static_pad (audiomixer, name);
+    fail_if (pad == NULL, NULL);
+    fail_unless (gst_element_link_pads (audiomixer, name, out_queue[i + 1],
+            "sink"));
+    gst_object_unref (pad);
+    g_free (name);
+
+    queue_sinkpad[i] = gst_element_get_static_pad (queue[i], "sink");
+    gst_pad_send_event (queue_sinkpad[i], gst_event_new_stream_start ("test"));
+    gst_pad_set_caps (queue_sinkpad[i], caps);
+    gst_pad_send_event (queue_sinkpad[i], gst_event_ref (event));
+  }
+  g_object_set (sinkpad[0], "volume", 0.5, NULL);
+  if (muted >= 0)
+    g_object_set (sinkpad[muted], "mute", TRUE, NULL);
+  gst_caps_unref (caps);
+  gst_event_unref (event);
+
+  for (i = 0; i < 3; i++) {
+    ret = gst_pad_chain (queue_sinkpad[i],
+        new_buffer_s16 (mix_minus_input[i][0], 500, 0, 500 * GST_MSECOND, 0));
+    ck_assert_int_eq (ret, GST_FLOW_OK);
+    ret = gst_pad_chain (queue_sinkpad[i],
+        new_buffer_s16 (mix_minus_input[i][1], 500, 500 * GST_MSECOND,
+            500 * GST_MSECOND, i == 2 ? GST_BUFFER_FLAG_GAP : 0));
+    ck_assert_int_eq (ret, GST_FLOW_OK);
+    gst_pad_send_event (queue_sinkpad[i], gst_event_new_eos ());
+  }
+
+  g_idle_add ((GSourceFunc) set_playing, bin);
+  g_main_loop_run (main_loop);
+
+  check_buffers_s16 (received_buffers[0], expected_mix);
+  for (i = 0; i < 3; i++)
+    check_buffers_s16 (received_buffers[i + 1], expected_minus[i]);
+
+  for (i = 0; i < 4; i++)
+    g_list_free_full (received_buffers[i], (GDestroyNotify) gst_buffer_unref);
+
+  for (i = 0; i < 3; i++) {
+    gst_element_release_request_pad (audiomixer, sinkpad[i]);
+    gst_object_unref (sinkpad[i]);
+    gst_object_unref (queue_sinkpad[i]);
+  }
+  /* the minus pads go away with their sink pads */
+  fail_unless_equals_int (GST_ELEMENT (audiomixer)->numsrcpads, 1);
+
+  gst_element_set_state (bin, GST_STATE_NULL);
+  gst_bus_remove_signal_watch (bus);
+  gst_object_unref (bus);
+  gst_object_unref (bin);
+}
+
+GST_START_TEST (test_mix_minus)
+{
+  static const gint16 expected_mix[2] = { 5000, G_MAXINT16 };
+  /* in the second block the minus outputs are clamped after subtracting,
+   * not computed from the clamped full mix */
+  static const gint16 expected_minus[3][2] = {
+    {-10000, 30000}, {25000, 10000}, {-5000, G_MAXINT16}
+  };
+
+  run_mix_minus_test (-1, expected_mix, expected_minus);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_mix_minus_mute)
+{
+  /* input 1 is muted: it is missing from the other outputs and itself gets
+   * the full mix. In the second block input 0 is the only one left, so its
+   * own output is silence */
+  static const gint16 expected_mix[2] = { 25000, 10000 };
+  static const gint16 expected_minus[3][2] = {
+    {10000, 0}, {25000, 10000}, {15000, 10000}
+  };
+
+  run_mix_minus_test (1, expected_mix, expected_minus);
+}
+
+GST_END_TEST;
+
+static gint mix_minus_counts[4];
+
+static void
+handoff_buffer_count_cb (GstElement * fakesink, GstBuffer * buffer,
+    GstPad * pad, gint * count)
+{
+  g_atomic_int_inc (count);
+}
+
+static gboolean
+wait_for_buffer_count (gint * count, gint target)
+{
+  gint64 end_time = g_get_monotonic_time () + 10 * G_TIME_SPAN_SECOND;
+
+  while (g_atomic_int_get (count) < target) {
+    if (g_get_monotonic_time () > end_time)
+      return FALSE;
+    g_usleep (1000);
+  }
+
+  return TRUE;
+}
+
+/* adds a branch with a queue and a counting fakesink to @srcpad */
+static GstElement *
+add_counting_branch (GstElement * bin, GstPad * srcpad, gint * count)
+{
+  GstElement *queue, *sink;
+  GstPad *sinkpad;
+
+  queue = gst_element_factory_make ("queue", NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "signal-handoffs", TRUE, "async", FALSE, NULL);
+  g_signal_connect (sink, "handoff", (GCallback) handoff_buffer_count_cb,
+      count);
+  gst_bin_add_many (GST_BIN (bin), queue, sink, NULL);
+  fail_unless (gst_element_link (queue, sink));
+
+  sinkpad = gst_element_get_static_pad (queue, "sink");
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+
+  gst_element_sync_state_with_parent (sink);
+  gst_element_sync_state_with_parent (queue);
+
+  return queue;
+}
+
+static GstElement *
+add_silence_source (GstElement * bin, GstElement * audiomixer,
+    GstPad ** sinkpad)
+{
+  GstElement *src;
+  GstPad *srcpad;
+
+  src = gst_element_factory_make ("audiotestsrc", NULL);
+  g_object_set (src, "wave", 4, NULL);
+  gst_bin_add (GST_BIN (bin), src);
+
+  *sinkpad = gst_element_request_pad_simple (audiomixer, "sink_%u");
+  fail_if (*sinkpad == NULL, NULL);
+  srcpad = gst_element_get_static_pad (src, "src");
+  fail_unless (gst_pad_link (srcpad, *sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (srcpad);
+
+  return src;
+}
+
+/* participants joining and leaving while the mixer is running */
+GST_START_TEST (test_mix_minus_dynamic)
+{
+  GstElement *bin, *audiomixer, *src[3], *branch[4];
+  GstPad *sinkpad[3], *pad, *minus_pad;
+  GstEvent *event, *main_event;
+  const gchar *stream_id, *main_stream_id;
+  gchar *expected_id;
+  guint group_id, main_group_id;
+  const GstSegment *segment;
+  GstCaps *caps, *main_caps;
+  GstMessage *msg;
+  GstBus *bus;
+  gint i, count;
+
+  bin = gst_pipeline_new ("pipeline");
+  bus = gst_element_get_bus (bin);
+  audiomixer = gst_element_factory_make ("audiomixer", NULL);
+  g_object_set (audiomixer, "mix-minus", TRUE, NULL);
+  gst_bin_add (GST_BIN (bin), audiomixer);
+
+  memset (mix_minus_counts, 0, sizeof (mix_minus_counts));
+
+  pad = gst_element_get_static_pad (audiomixer, "src");
+  branch[0] = add_counting_branch (bin, pad, &mix_minus_counts[0]);
+  gst_object_unref (pad);
+
+  for (i = 0; i < 2; i++) {
+    src[i] = add_silence_source (bin, audiomixer, &sinkpad[i]);
+    minus_pad = gst_element_get_static_pad (audiomixer,
+        i == 0 ? "minus_0" : "minus_1");
+    fail_unless (minus_pad != NULL);
+    branch[i + 1] = add_counting_branch (bin, minus_pad,
+        &mix_minus_counts[i + 1]);
+    gst_object_unref (minus_pad);
+  }
+
+  fail_unless (gst_element_set_state (bin, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+  for (i = 0; i < 3; i++)
+    fail_unless (wait_for_buffer_count (&mix_minus_counts[i], 10));
+
+  /* a participant joins while running, its minus pad starts with a
+   * stream-start of its own in the same group, caps and a segment */
+  src[2] = add_silence_source (bin, audiomixer, &sinkpad[2]);
+  minus_pad = gst_element_get_static_pad (audiomixer, "minus_2");
+  fail_unless (minus_pad != NULL);
+
+  pad = gst_element_get_static_pad (audiomixer, "src");
+  main_event = gst_pad_get_sticky_event (pad, GST_EVENT_STREAM_START, 0);
+  fail_unless (main_event != NULL);
+  event = gst_pad_get_sticky_event (minus_pad, GST_EVENT_STREAM_START, 0);
+  fail_unless (event != NULL);
+  gst_event_parse_stream_start (main_event, &main_stream_id);
+  gst_event_parse_stream_start (event, &stream_id);
+  expected_id = g_strdup_printf ("%s/minus_2", main_stream_id);
+  fail_unless_equals_string (stream_id, expected_id);
+  g_free (expected_id);
+  if (gst_event_parse_group_id (main_event, &main_group_id)) {
+    fail_unless (gst_event_parse_group_id (event, &group_id));
+    fail_unless_equals_int (group_id, main_group_id);
+  }
+  gst_event_unref (event);
+  gst_event_unref (main_event);
+
+  caps = gst_pad_get_current_caps (minus_pad);
+  main_caps = gst_pad_get_current_caps (pad);
+  fail_unless (caps != NULL);
+  fail_unless (gst_caps_is_equal (caps, main_caps));
+  gst_caps_unref (main_caps);
+  gst_caps_unref (caps);
+  event = gst_pad_get_sticky_event (minus_pad, GST_EVENT_SEGMENT, 0);
+  fail_unless (event != NULL);
+  gst_event_parse_segment (event, &segment);
+  fail_unless_equals_int (segment->format, GST_FORMAT_TIME);
+  gst_event_unref (event);
+  gst_object_unref (pad);
+
+  branch[3] = add_counting_branch (bin, minus_pad, &mix_minus_counts[3]);
+  gst_object_unref (minus_pad);
+  gst_element_sync_state_with_parent (src[2]);
+  fail_unless (wait_for_buffer_count (&mix_minus_counts[3], 10));
+
+  /* the branch of participant 1 is shut down, its minus pad now returns
+   * FLUSHING but everybody else keeps getting data */
+  gst_element_set_locked_state (branch[2], TRUE);
+  gst_element_set_state (branch[2], GST_STATE_NULL);
+  for (i = 0; i < 4; i++) {
+    if (i == 2)
+      continue;
+    count = g_atomic_int_get (&mix_minus_counts[i]);
+    fail_unless (wait_for_buffer_count (&mix_minus_counts[i], count + 10));
+  }
+
+  /* participant 1 leaves, taking its minus pad with it */
+  gst_element_set_locked_state (src[1], TRUE);
+  gst_element_set_state (src[1], GST_STATE_NULL);
+  gst_element_release_request_pad (audiomixer, sinkpad[1]);
+  gst_object_unref (sinkpad[1]);
+  minus_pad = gst_element_get_static_pad (audiomixer, "minus_1");
+  fail_unless (minus_pad == NULL);
+  gst_bin_remove (GST_BIN (bin), src[1]);
+
+  for (i = 0; i < 4; i++) {
+    if (i == 2)
+      continue;
+    count = g_atomic_int_get (&mix_minus_counts[i]);
+    fail_unless (wait_for_buffer_count (&mix_minus_counts[i], count + 10));
+  }
+
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_ERROR);
+  fail_unless (msg == NULL, "unexpected error %" GST_PTR_FORMAT, msg);
+
+  gst_element_set_state (bin, GST_STATE_NULL);
+  gst_element_release_request_pad (audiomixer, sinkpad[0]);
+  gst_object_unref (sinkpad[0]);
+  gst_element_release_request_pad (audiomixer, sinkpad[2]);
+  gst_object_unref (sinkpad[2]);
+  gst_object_unref (bus);
+  gst_object_unref (bin);
+}
+
+GST_END_TEST;
+
 static Suite *
 audiomixer_suite (void)
 {
@@ -2252,6 +2644,9 @@ audiomixer_suite (void)
   tcase_add_checked_fixture (tc_chain, test_setup, test_teardown);
   tcase_add_test (tc_chain, test_change_output_caps);
   tcase_add_test (tc_chain, test_change_output_caps_mid_output_buffer);
+  tcase_add_test (tc_chain, test_mix_minus);
+  tcase_add_test (tc_chain, test_mix_minus_mute);
+  tcase_add_test (tc_chain, test_mix_minus_dynamic);
 
   /* Use a longer timeout */
 #ifdef HAVE_VALGRIND
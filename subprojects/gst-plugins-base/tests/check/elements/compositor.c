@@ -2516,6 +2516,318 @@ GST_START_TEST (test_reverse)
 
 GST_END_TEST;
 
+/* A video aggregator with pads that only implement prepare_frame, which
+ * are the ones parallel-prepare applies to. Every pad is copied into its own
+ * vertical stripe of the GRAY8 output, in pad order. */
+#define PREPARE_N_PADS 4
+#define PREPARE_WIDTH 64
+#define PREPARE_HEIGHT 16
+#define PREPARE_STRIPE (PREPARE_WIDTH / PREPARE_N_PADS)
+#define PREPARE_N_BUFFERS 5
+
+static GMutex prepare_lock;
+static gint prepare_active, prepare_max_active, prepare_calls;
+/* name of the pad whose frames fail to prepare, if any */
+static const gchar *prepare_fail_pad;
+
+typedef GstVideoAggregatorConvertPad TestPrepareOnlyPad;
+typedef GstVideoAggregatorConvertPadClass TestPrepareOnlyPadClass;
+
+G_DEFINE_TYPE (TestPrepareOnlyPad, test_prepare_only_pad,
+    GST_TYPE_VIDEO_AGGREGATOR_CONVERT_PAD);
+
+static gboolean
+test_prepare_only_pad_prepare_frame (GstVideoAggregatorPad * pad,
+    GstVideoAggregator * vagg, GstBuffer * buffer,
+    GstVideoFrame * prepared_frame)
+{
+  GstVideoAggregatorPadClass *parent_class =
+      GST_VIDEO_AGGREGATOR_PAD_CLASS (test_prepare_only_pad_parent_class);
+  gboolean res;
+
+  g_mutex_lock (&prepare_lock);
+  prepare_active++;
+  prepare_max_active = MAX (prepare_max_active, prepare_active);
+  prepare_calls++;
+  g_mutex_unlock (&prepare_lock);
+
+  /* give the other pads a chance to overlap */
+  g_usleep (10 * 1000);
+  if (prepare_fail_pad && g_str_equal (GST_PAD_NAME (pad), prepare_fail_pad))
+    res = FALSE;
+  else
+    res = parent_class->prepare_frame (pad, vagg, buffer, prepared_frame);
+
+  g_mutex_lock (&prepare_lock);
+  prepare_active--;
+  g_mutex_unlock (&prepare_lock);
+
+  return res;
+}
+
+/* scale every input to the output size, so all pads need a conversion */
+static void
+test_prepare_only_pad_create_conversion_info (GstVideoAggregatorConvertPad *
+    pad, GstVideoAggregator * vagg, GstVideoInfo * convert_info)
+{
+  GST_VIDEO_AGGREGATOR_CONVERT_PAD_CLASS
+      (test_prepare_only_pad_parent_class)->create_conversion_info (pad, vagg,
+      convert_info);
+  if (!convert_info->finfo
+      || GST_VIDEO_INFO_FORMAT (convert_info) == GST_VIDEO_FORMAT_UNKNOWN)
+    return;
+
+  gst_video_info_set_format (convert_info, GST_VIDEO_INFO_FORMAT (&vagg->info),
+      GST_VIDEO_INFO_WIDTH (&vagg->info), GST_VIDEO_INFO_HEIGHT (&vagg->info));
+}
+
+static void
+test_prepare_only_pad_class_init (TestPrepareOnlyPadClass * klass)
+{
+  GstVideoAggregatorPadClass *vaggpad_class =
+      (GstVideoAggregatorPadClass *) klass;
+
+  vaggpad_class->prepare_frame = test_prepare_only_pad_prepare_frame;
+  klass->create_conversion_info = test_prepare_only_pad_create_conversion_info;
+}
+
+static void
+test_prepare_only_pad_init (TestPrepareOnlyPad * pad)
+{
+}
+
+typedef GstVideoAggregator TestPrepareAgg;
+typedef GstVideoAggregatorClass TestPrepareAggClass;
+
+G_DEFINE_TYPE (TestPrepareAgg, test_prepare_agg, GST_TYPE_VIDEO_AGGREGATOR);
+
+static GstStaticPadTemplate test_prepare_src_template =
+GST_STATIC_PAD_TEMPLATE ("src", GST_PAD_SRC, GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("GRAY8")));
+
+static GstStaticPadTemplate test_prepare_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink_%u", GST_PAD_SINK, GST_PAD_REQUEST,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("{ I420, GRAY8 }")));
+
+static GstFlowReturn
+test_prepare_agg_aggregate_frames (GstVideoAggregator * vagg,
+    GstBuffer * outbuf)
+{
+  GstVideoFrame out_frame;
+  GList *l;
+  guint stripe = 0, y;
+
+  if (!gst_video_frame_map (&out_frame, &vagg->info, outbuf, GST_MAP_WRITE))
+    return GST_FLOW_ERROR;
+
+  GST_OBJECT_LOCK (vagg);
+  for (l = GST_ELEMENT (vagg)->sinkpads; l; l = l->next, stripe++) {
+    GstVideoFrame *frame =
+        gst_video_aggregator_pad_get_prepared_frame (l->data);
+
+    for (y = 0; y < PREPARE_HEIGHT; y++) {
+      guint8 *out = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&out_frame, 0) +
+          y * GST_VIDEO_FRAME_PLANE_STRIDE (&out_frame, 0) +
+          stripe * PREPARE_STRIPE;
+
+      if (frame) {
+        memcpy (out, (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (frame, 0) +
+            y * GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0) +
+            stripe * PREPARE_STRIPE, PREPARE_STRIPE);
+      } else {
+        memset (out, 0, PREPARE_STRIPE);
+      }
+    }
+  }
+  GST_OBJECT_UNLOCK (vagg);
+
+  gst_video_frame_unmap (&out_frame);
+
+  return GST_FLOW_OK;
+}
+
+static void
+test_prepare_agg_class_init (TestPrepareAggClass * klass)
+{
+  GstElementClass *element_class = (GstElementClass *) klass;
+
+  gst_element_class_add_static_pad_template_with_gtype (element_class,
+      &test_prepare_src_template, GST_TYPE_AGGREGATOR_PAD);
+  gst_element_class_add_static_pad_template_with_gtype (element_class,
+      &test_prepare_sink_template, test_prepare_only_pad_get_type ());
+  gst_element_class_set_static_metadata (element_class,
+      "Test prepare aggregator", "Filter/Editor/Video/Compositor",
+      "Aggregator with prepare_frame only pads", "Test");
+
+  klass->aggregate_frames = test_prepare_agg_aggregate_frames;
+}
+
+static void
+test_prepare_agg_init (TestPrepareAgg * vagg)
+{
+}
+
+typedef struct
+{
+  GstClockTime pts;
+  guint8 stripes[PREPARE_N_PADS];
+} PrepareOutput;
+
+static void
+on_prepare_output_handoff (GstElement * sink, GstBuffer * buffer,
+    GstPad * pad, GArray * outputs)
+{
+  PrepareOutput output;
+  GstMapInfo map;
+  guint i, x, y;
+
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_READ));
+  fail_unless (map.size >= PREPARE_WIDTH * PREPARE_HEIGHT);
+
+  output.pts = GST_BUFFER_PTS (buffer);
+  for (i = 0; i < PREPARE_N_PADS; i++) {
+    output.stripes[i] = map.data[i * PREPARE_STRIPE];
+
+    /* every stripe is filled by exactly one pad */
+    for (y = 0; y < PREPARE_HEIGHT; y++) {
+      for (x = 0; x < PREPARE_STRIPE; x++)
+        fail_unless_equals_int (map.data[y * PREPARE_WIDTH +
+                i * PREPARE_STRIPE + x], output.stripes[i]);
+    }
+  }
+  gst_buffer_unmap (buffer, &map);
+
+  g_array_append_val (outputs, output);
+}
+
+static GArray *
+run_prepare_only_pipeline (gboolean parallel)
+{
+  GstElement *bin, *sink;
+  GstMessage *msg;
+  GstBus *bus;
+  GArray *outputs = g_array_new (FALSE, FALSE, sizeof (PrepareOutput));
+  GString *desc;
+  guint i;
+
+  fail_unless (gst_element_register (NULL, "testprepareagg", GST_RANK_NONE,
+          test_prepare_agg_get_type ()));
+
+  desc = g_string_new (NULL);
+  g_string_append_printf (desc, "testprepareagg name=m parallel-prepare=%d ! "
+      "video/x-raw,format=GRAY8,width=%d,height=%d ! "
+      "fakesink name=sink signal-handoffs=true", parallel, PREPARE_WIDTH,
+      PREPARE_HEIGHT);
+  /* increasingly bright inputs of different sizes and formats, so all of
+   * them need to be converted */
+  for (i = 0; i < PREPARE_N_PADS; i++) {
+    guint v = 0x30 + 0x30 * i;
+
+    g_string_append_printf (desc, " videotestsrc num-buffers=%d "
+        "pattern=solid-color foreground-color=0xff%02x%02x%02x ! "
+        "video/x-raw,format=I420,width=%d,height=%d ! m.sink_%u",
+        PREPARE_N_BUFFERS, v, v, v, 32 * (i + 1), 8 * (i + 1), i);
+  }
+  bin = gst_parse_launch (desc->str, NULL);
+  g_string_free (desc, TRUE);
+  fail_unless (bin != NULL);
+
+  sink = gst_bin_get_by_name (GST_BIN (bin), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (on_prepare_output_handoff),
+      outputs);
+  gst_object_unref (sink);
+
+  prepare_active = prepare_max_active = prepare_calls = 0;
+
+  fail_unless (gst_element_set_state (bin,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+
+  bus = gst_element_get_bus (bin);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (bin, GST_STATE_NULL);
+  gst_object_unref (bin);
+
+  return outputs;
+}
+
+/* the frames of pads that only implement prepare_frame are really prepared
+ * concurrently, and still end up in the right place */
+GST_START_TEST (test_parallel_prepare_frame_only)
+{
+  GArray *serial, *parallel;
+  guint i, j;
+
+  /* the pipelines are stopped, so the counters are not changing anymore */
+  serial = run_prepare_only_pipeline (FALSE);
+  fail_unless_equals_int (prepare_calls, PREPARE_N_PADS * PREPARE_N_BUFFERS);
+  fail_unless_equals_int (prepare_max_active, 1);
+
+  parallel = run_prepare_only_pipeline (TRUE);
+  fail_unless_equals_int (prepare_calls, PREPARE_N_PADS * PREPARE_N_BUFFERS);
+  fail_unless (prepare_max_active > 1);
+
+  fail_unless_equals_int (serial->len, PREPARE_N_BUFFERS);
+  fail_unless_equals_int (parallel->len, serial->len);
+  for (i = 0; i < parallel->len; i++) {
+    PrepareOutput *p = &g_array_index (parallel, PrepareOutput, i);
+    PrepareOutput *s = &g_array_index (serial, PrepareOutput, i);
+
+    if (i > 0)
+      fail_unless (p->pts > g_array_index (parallel, PrepareOutput,
+              i - 1).pts);
+    fail_unless_equals_uint64 (p->pts, s->pts);
+
+    for (j = 0; j < PREPARE_N_PADS; j++) {
+      fail_unless_equals_int (p->stripes[j], s->stripes[j]);
+      /* the stripes are in pad order */
+      if (j > 0)
+        fail_unless (p->stripes[j] > p->stripes[j - 1]);
+    }
+  }
+
+  g_array_unref (serial);
+  g_array_unref (parallel);
+}
+
+GST_END_TEST;
+
+/* a frame that fails to prepare is left out, like without parallel-prepare.
+ * That stops at the failing pad, so it is the last one here. */
+GST_START_TEST (test_parallel_prepare_failure)
+{
+  GArray *serial, *parallel;
+  guint i, j;
+
+  prepare_fail_pad = "sink_3";
+  serial = run_prepare_only_pipeline (FALSE);
+  parallel = run_prepare_only_pipeline (TRUE);
+  prepare_fail_pad = NULL;
+
+  fail_unless_equals_int (serial->len, PREPARE_N_BUFFERS);
+  fail_unless_equals_int (parallel->len, serial->len);
+  for (i = 0; i < parallel->len; i++) {
+    PrepareOutput *p = &g_array_index (parallel, PrepareOutput, i);
+    PrepareOutput *s = &g_array_index (serial, PrepareOutput, i);
+
+    fail_unless_equals_uint64 (p->pts, s->pts);
+    for (j = 0; j < PREPARE_N_PADS; j++)
+      fail_unless_equals_int (p->stripes[j], s->stripes[j]);
+    for (j = 0; j < PREPARE_N_PADS - 1; j++)
+      fail_unless (p->stripes[j] != 0);
+    fail_unless_equals_int (p->stripes[PREPARE_N_PADS - 1], 0);
+  }
+
+  g_array_unref (serial);
+  g_array_unref (parallel);
+}
+
+GST_END_TEST;
+
 static Suite *
 compositor_suite (void)
 {
@@ -2558,6 +2870,8 @@ compositor_suite (void)
   tcase_add_test (tc_chain, test_gap_events);
   tcase_add_test (tc_chain, test_signals);
   tcase_add_test (tc_chain, test_reverse);
+  tcase_add_test (tc_chain, test_parallel_prepare_frame_only);
+  tcase_add_test (tc_chain, test_parallel_prepare_failure);
 
   return s;
 }
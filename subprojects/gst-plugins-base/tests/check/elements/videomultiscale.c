@@ -0,0 +1,359 @@
+/* GStreamer
+ * Copyright (C) 2022 GStreamer developers
+ *
+ * videomultiscale.c: Unit test for the videomultiscale element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <gst/video/video.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+
+#define IN_CAPS "video/x-raw,format=I420,width=320,height=180," \
+    "pixel-aspect-ratio=1/1,framerate=30/1"
+
+static GstBuffer *
+create_frame (gboolean random, guint32 seed)
+{
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  GstBuffer *buffer;
+  GRand *rand = g_rand_new_with_seed (seed);
+  guint i, x, y;
+
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_I420, 320, 180);
+  buffer = gst_buffer_new_and_alloc (GST_VIDEO_INFO_SIZE (&info));
+  fail_unless (gst_video_frame_map (&frame, &info, buffer, GST_MAP_WRITE));
+
+  for (i = 0; i < GST_VIDEO_FRAME_N_COMPONENTS (&frame); i++) {
+    guint8 *data = GST_VIDEO_FRAME_COMP_DATA (&frame, i);
+    gint stride = GST_VIDEO_FRAME_COMP_STRIDE (&frame, i);
+
+    for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (&frame, i); y++) {
+      for (x = 0; x < GST_VIDEO_FRAME_COMP_WIDTH (&frame, i); x++) {
+        if (random)
+          data[y * stride + x] = g_rand_int_range (rand, 0, 256);
+        else
+          data[y * stride + x] = i == 0 ? 100 : 128;
+      }
+    }
+  }
+
+  gst_video_frame_unmap (&frame);
+  g_rand_free (rand);
+
+  GST_BUFFER_PTS (buffer) = 0;
+  GST_BUFFER_DURATION (buffer) = GST_SECOND / 30;
+
+  return buffer;
+}
+
+static GstHarness *
+add_rendition (GstHarness * h, const gchar * caps)
+{
+  GstHarness *r = gst_harness_new_with_element (h->element, NULL, "src_%u");
+
+  gst_harness_set_sink_caps_str (r, caps);
+
+  return r;
+}
+
+static void
+check_rendition (GstHarness * h, gint width, gint height)
+{
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  GstBuffer *buffer;
+  GstCaps *caps;
+  guint i, x, y;
+
+  buffer = gst_harness_pull (h);
+  fail_unless (buffer != NULL);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), 0);
+  fail_unless_equals_uint64 (GST_BUFFER_DURATION (buffer), GST_SECOND / 30);
+
+  caps = gst_pad_get_current_caps (h->sinkpad);
+  fail_unless (caps != NULL);
+  fail_unless (gst_video_info_from_caps (&info, caps));
+  gst_caps_unref (caps);
+  fail_unless_equals_int (GST_VIDEO_INFO_FORMAT (&info),
+      GST_VIDEO_FORMAT_I420);
+  fail_unless_equals_int (GST_VIDEO_INFO_WIDTH (&info), width);
+  fail_unless_equals_int (GST_VIDEO_INFO_HEIGHT (&info), height);
+  fail_unless_equals_int (GST_VIDEO_INFO_FPS_N (&info), 30);
+
+  /* a flat frame stays flat */
+  fail_unless (gst_video_frame_map (&frame, &info, buffer, GST_MAP_READ));
+  for (i = 0; i < GST_VIDEO_FRAME_N_COMPONENTS (&frame); i++) {
+    const guint8 *data = GST_VIDEO_FRAME_COMP_DATA (&frame, i);
+    gint stride = GST_VIDEO_FRAME_COMP_STRIDE (&frame, i);
+
+    for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (&frame, i); y++) {
+      for (x = 0; x < GST_VIDEO_FRAME_COMP_WIDTH (&frame, i); x++)
+        fail_unless_equals_int (data[y * stride + x], i == 0 ? 100 : 128);
+    }
+  }
+  gst_video_frame_unmap (&frame);
+  gst_buffer_unref (buffer);
+}
+
+GST_START_TEST (test_renditions)
+{
+  GstHarness *h, *r1, *r2;
+
+  h = gst_harness_new_with_padnames ("videomultiscale", "sink", "src_%u");
+  gst_harness_set_sink_caps_str (h, "video/x-raw,width=160,height=90");
+  /* only one dimension given, the other keeps the aspect ratio */
+  r1 = add_rendition (h, "video/x-raw,width=80");
+  r2 = add_rendition (h, "video/x-raw,height=120");
+
+  gst_harness_set_src_caps_str (h, IN_CAPS);
+  fail_unless_equals_int (gst_harness_push (h, create_frame (FALSE, 0)),
+      GST_FLOW_OK);
+
+  check_rendition (h, 160, 90);
+  check_rendition (r1, 80, 45);
+  check_rendition (r2, 213, 120);
+
+  gst_harness_teardown (r2);
+  gst_harness_teardown (r1);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_late_rendition)
+{
+  GstHarness *h, *r;
+  GstEvent *event;
+
+  h = gst_harness_new_with_padnames ("videomultiscale", "sink", "src_%u");
+  gst_harness_set_sink_caps_str (h, "video/x-raw,width=160,height=90");
+  gst_harness_set_src_caps_str (h, IN_CAPS);
+  fail_unless_equals_int (gst_harness_push (h, create_frame (FALSE, 0)),
+      GST_FLOW_OK);
+  check_rendition (h, 160, 90);
+
+  /* added while streaming, it must get the sticky events in order */
+  r = add_rendition (h, "video/x-raw,width=64,height=36");
+  fail_unless_equals_int (gst_harness_push (h, create_frame (FALSE, 0)),
+      GST_FLOW_OK);
+  check_rendition (h, 160, 90);
+  check_rendition (r, 64, 36);
+
+  event = gst_harness_pull_event (r);
+  fail_unless_equals_int (GST_EVENT_TYPE (event), GST_EVENT_STREAM_START);
+  gst_event_unref (event);
+  event = gst_harness_pull_event (r);
+  fail_unless_equals_int (GST_EVENT_TYPE (event), GST_EVENT_CAPS);
+  gst_event_unref (event);
+  event = gst_harness_pull_event (r);
+  fail_unless_equals_int (GST_EVENT_TYPE (event), GST_EVENT_SEGMENT);
+  gst_event_unref (event);
+
+  gst_harness_teardown (r);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static const gchar *ladder[] = {
+  "video/x-raw,width=240,height=135",
+  "video/x-raw,width=160,height=90",
+  "video/x-raw,width=160,height=90",
+  "video/x-raw,width=100,height=50",
+  "video/x-raw,width=80,height=45",
+};
+
+static void
+run_ladder (gboolean cascade, guint n_threads, GstBuffer ** outputs)
+{
+  GstHarness *h[G_N_ELEMENTS (ladder)];
+  guint i;
+
+  h[0] = gst_harness_new_with_padnames ("videomultiscale", "sink", "src_%u");
+  g_object_set (h[0]->element, "cascade", cascade, "n-threads", n_threads,
+      "method", GST_VIDEO_RESAMPLER_METHOD_CUBIC, NULL);
+  gst_harness_set_sink_caps_str (h[0], ladder[0]);
+  for (i = 1; i < G_N_ELEMENTS (ladder); i++)
+    h[i] = add_rendition (h[0], ladder[i]);
+
+  gst_harness_set_src_caps_str (h[0], IN_CAPS);
+  fail_unless_equals_int (gst_harness_push (h[0], create_frame (TRUE, 23)),
+      GST_FLOW_OK);
+
+  for (i = 0; i < G_N_ELEMENTS (ladder); i++)
+    outputs[i] = gst_harness_pull (h[i]);
+  for (i = G_N_ELEMENTS (ladder); i > 0; i--)
+    gst_harness_teardown (h[i - 1]);
+}
+
+static void
+check_equal (GstBuffer * a, GstBuffer * b)
+{
+  GstMapInfo map;
+
+  fail_unless_equals_int (gst_buffer_get_size (a), gst_buffer_get_size (b));
+  gst_buffer_map (a, &map, GST_MAP_READ);
+  fail_unless (gst_buffer_memcmp (b, 0, map.data, map.size) == 0);
+  gst_buffer_unmap (a, &map);
+}
+
+GST_START_TEST (test_threads)
+{
+  GstBuffer *single[G_N_ELEMENTS (ladder)], *multi[G_N_ELEMENTS (ladder)];
+  gint cascade;
+  guint i;
+
+  /* the renditions don't depend on how the work is split up */
+  for (cascade = 0; cascade < 2; cascade++) {
+    run_ladder (cascade, 1, single);
+    run_ladder (cascade, 4, multi);
+
+    for (i = 0; i < G_N_ELEMENTS (ladder); i++) {
+      check_equal (single[i], multi[i]);
+      gst_buffer_unref (single[i]);
+      gst_buffer_unref (multi[i]);
+    }
+  }
+}
+
+GST_END_TEST;
+
+/* scales a random frame with a converter per rendition */
+static void
+check_single_pass (GstVideoFormat format)
+{
+  GstHarness *h[G_N_ELEMENTS (ladder)];
+  GstVideoInfo in_info, out_info;
+  GstVideoFrame in_frame, ref_frame, out_frame;
+  GstVideoConverter *convert;
+  GstBuffer *in, *ref, *out;
+  GstMapInfo map;
+  GstCaps *caps;
+  GRand *rand;
+  guint i, j, p, x, y;
+
+  gst_video_info_set_format (&in_info, format, 320, 180);
+  in = gst_buffer_new_and_alloc (GST_VIDEO_INFO_SIZE (&in_info));
+  GST_BUFFER_PTS (in) = 0;
+  rand = g_rand_new_with_seed (42);
+  gst_buffer_map (in, &map, GST_MAP_WRITE);
+  for (j = 0; j < map.size; j++)
+    map.data[j] = g_rand_int_range (rand, 0, 256);
+  gst_buffer_unmap (in, &map);
+  g_rand_free (rand);
+
+  h[0] = gst_harness_new_with_padnames ("videomultiscale", "sink", "src_%u");
+  g_object_set (h[0]->element, "method", GST_VIDEO_RESAMPLER_METHOD_LINEAR,
+      NULL);
+  gst_harness_set_sink_caps_str (h[0], ladder[0]);
+  for (i = 1; i < G_N_ELEMENTS (ladder); i++)
+    h[i] = add_rendition (h[0], ladder[i]);
+
+  caps = gst_video_info_to_caps (&in_info);
+  gst_harness_set_src_caps (h[0], caps);
+  fail_unless_equals_int (gst_harness_push (h[0], gst_buffer_ref (in)),
+      GST_FLOW_OK);
+  fail_unless (gst_video_frame_map (&in_frame, &in_info, in, GST_MAP_READ));
+
+  for (i = 0; i < G_N_ELEMENTS (ladder); i++) {
+    out = gst_harness_pull (h[i]);
+    caps = gst_pad_get_current_caps (h[i]->sinkpad);
+    fail_unless (gst_video_info_from_caps (&out_info, caps));
+    gst_caps_unref (caps);
+
+    convert = gst_video_converter_new (&in_info, &out_info,
+        gst_structure_new ("options",
+            GST_VIDEO_CONVERTER_OPT_RESAMPLER_METHOD,
+            GST_TYPE_VIDEO_RESAMPLER_METHOD, GST_VIDEO_RESAMPLER_METHOD_LINEAR,
+            GST_VIDEO_CONVERTER_OPT_DITHER_METHOD,
+            GST_TYPE_VIDEO_DITHER_METHOD, GST_VIDEO_DITHER_NONE,
+            GST_VIDEO_CONVERTER_OPT_THREADS, G_TYPE_UINT, 1, NULL));
+    fail_unless (convert != NULL);
+    ref = gst_buffer_new_and_alloc (GST_VIDEO_INFO_SIZE (&out_info));
+    fail_unless (gst_video_frame_map (&ref_frame, &out_info, ref,
+            GST_MAP_WRITE));
+    gst_video_converter_frame (convert, &in_frame, &ref_frame);
+    gst_video_converter_free (convert);
+
+    /* the converter filters in another order, so only rounding differs */
+    fail_unless (gst_video_frame_map (&out_frame, &out_info, out,
+            GST_MAP_READ));
+    for (p = 0; p < GST_VIDEO_FRAME_N_PLANES (&out_frame); p++) {
+      const guint8 *a = GST_VIDEO_FRAME_PLANE_DATA (&out_frame, p);
+      const guint8 *b = GST_VIDEO_FRAME_PLANE_DATA (&ref_frame, p);
+      gint sa = GST_VIDEO_FRAME_PLANE_STRIDE (&out_frame, p);
+      gint sb = GST_VIDEO_FRAME_PLANE_STRIDE (&ref_frame, p);
+      gint comp[GST_VIDEO_MAX_COMPONENTS];
+      guint width, height;
+
+      gst_video_format_info_component (out_info.finfo, p, comp);
+      width = GST_VIDEO_FRAME_COMP_WIDTH (&out_frame, comp[0]) *
+          GST_VIDEO_FRAME_COMP_PSTRIDE (&out_frame, comp[0]);
+      height = GST_VIDEO_FRAME_COMP_HEIGHT (&out_frame, comp[0]);
+
+      for (y = 0; y < height; y++) {
+        for (x = 0; x < width; x++)
+          fail_unless (ABS (a[y * sa + x] - b[y * sb + x]) <= 2,
+              "%s rendition %u plane %u differs at %u,%u: %u != %u",
+              gst_video_format_to_string (format), i, p, x, y,
+              a[y * sa + x], b[y * sb + x]);
+      }
+    }
+    gst_video_frame_unmap (&out_frame);
+    gst_video_frame_unmap (&ref_frame);
+    gst_buffer_unref (ref);
+    gst_buffer_unref (out);
+  }
+
+  gst_video_frame_unmap (&in_frame);
+  gst_buffer_unref (in);
+  for (i = G_N_ELEMENTS (ladder); i > 0; i--)
+    gst_harness_teardown (h[i - 1]);
+}
+
+GST_START_TEST (test_single_pass)
+{
+  /* one scaler per plane, one for all components of a packed format */
+  check_single_pass (GST_VIDEO_FORMAT_I420);
+  check_single_pass (GST_VIDEO_FORMAT_Y444);
+  check_single_pass (GST_VIDEO_FORMAT_BGRA);
+}
+
+GST_END_TEST;
+
+static Suite *
+videomultiscale_suite (void)
+{
+  Suite *s = suite_create ("videomultiscale");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_renditions);
+  tcase_add_test (tc_chain, test_late_rendition);
+  tcase_add_test (tc_chain, test_threads);
+  tcase_add_test (tc_chain, test_single_pass);
+
+  return s;
+}
+
+GST_CHECK_MAIN (videomultiscale);
@@ -2872,6 +2872,233 @@ GST_START_TEST (test_video_convert_multithreading)
 
 GST_END_TEST;
 
+static GstBuffer *
+convert_buffer (GstVideoInfo * ininfo, GstVideoInfo * outinfo,
+    GstBuffer * inbuffer, GstStructure * options)
+{
+  GstVideoFrame inframe, outframe;
+  GstVideoConverter *convert;
+  GstBuffer *outbuffer;
+
+  outbuffer = gst_buffer_new_and_alloc (outinfo->size);
+  gst_buffer_memset (outbuffer, 0, 0, -1);
+
+  fail_unless (gst_video_frame_map (&inframe, ininfo, inbuffer, GST_MAP_READ));
+  fail_unless (gst_video_frame_map (&outframe, outinfo, outbuffer,
+          GST_MAP_WRITE));
+  convert = gst_video_converter_new (ininfo, outinfo, options);
+  fail_unless (convert != NULL);
+  gst_video_converter_frame (convert, &inframe, &outframe);
+  gst_video_converter_free (convert);
+  gst_video_frame_unmap (&outframe);
+  gst_video_frame_unmap (&inframe);
+
+  return outbuffer;
+}
+
+static const struct
+{
+  GstVideoFormat in_format;
+  GstVideoFormat out_format;
+} high_bit_depth_conversions[] = {
+  {GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_I420_10LE},
+  {GST_VIDEO_FORMAT_I420_10LE, GST_VIDEO_FORMAT_P010_10LE},
+  {GST_VIDEO_FORMAT_P012_LE, GST_VIDEO_FORMAT_I420_12LE},
+  {GST_VIDEO_FORMAT_I420_12LE, GST_VIDEO_FORMAT_P012_LE},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_P010_10LE},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_P016_LE},
+  {GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_NV12},
+  {GST_VIDEO_FORMAT_P012_LE, GST_VIDEO_FORMAT_NV12},
+  {GST_VIDEO_FORMAT_v210, GST_VIDEO_FORMAT_I422_10LE},
+  {GST_VIDEO_FORMAT_I422_10LE, GST_VIDEO_FORMAT_v210},
+  {GST_VIDEO_FORMAT_Y210, GST_VIDEO_FORMAT_I422_10LE},
+  {GST_VIDEO_FORMAT_I422_10LE, GST_VIDEO_FORMAT_Y210},
+  {GST_VIDEO_FORMAT_I420_10LE, GST_VIDEO_FORMAT_BGRA},
+  {GST_VIDEO_FORMAT_I420_10LE, GST_VIDEO_FORMAT_RGB},
+  {GST_VIDEO_FORMAT_I420_12LE, GST_VIDEO_FORMAT_xRGB},
+  {GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_BGRx},
+  {GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_RGBA},
+  {GST_VIDEO_FORMAT_P012_LE, GST_VIDEO_FORMAT_ABGR},
+};
+
+GST_START_TEST (test_video_convert_high_bit_depth)
+{
+  static const gint sizes[][2] = { {64, 48}, {70, 31}, {67, 33} };
+  GRand *rand = g_rand_new_with_seed (22);
+  gint i, j;
+
+  /* the fastpaths must give the same result as the generic path, which is
+   * used when dithering is disabled with a quantization that is not 1 */
+  for (i = 0; i < G_N_ELEMENTS (high_bit_depth_conversions); i++) {
+    for (j = 0; j < G_N_ELEMENTS (sizes); j++) {
+      GstVideoInfo ininfo, outinfo;
+      GstBuffer *inbuffer, *outbuffer, *refbuffer;
+      GstMapInfo map;
+      gsize k;
+
+      fail_unless (gst_video_info_set_format (&ininfo,
+              high_bit_depth_conversions[i].in_format, sizes[j][0],
+              sizes[j][1]));
+      fail_unless (gst_video_info_set_format (&outinfo,
+              high_bit_depth_conversions[i].out_format, sizes[j][0],
+              sizes[j][1]));
+
+      GST_DEBUG ("%s -> %s, %dx%d",
+          gst_video_format_to_string (high_bit_depth_conversions[i].in_format),
+          gst_video_format_to_string (high_bit_depth_conversions[i].
+              out_format), sizes[j][0], sizes[j][1]);
+
+      inbuffer = gst_buffer_new_and_alloc (ininfo.size);
+      fail_unless (gst_buffer_map (inbuffer, &map, GST_MAP_WRITE));
+      for (k = 0; k < map.size; k++)
+        map.data[k] = g_rand_int (rand);
+      gst_buffer_unmap (inbuffer, &map);
+
+      outbuffer = convert_buffer (&ininfo, &outinfo, inbuffer,
+          gst_structure_new ("options",
+              GST_VIDEO_CONVERTER_OPT_DITHER_METHOD,
+              GST_TYPE_VIDEO_DITHER_METHOD, GST_VIDEO_DITHER_NONE,
+              GST_VIDEO_CONVERTER_OPT_THREADS, G_TYPE_UINT, 3, NULL));
+      refbuffer = convert_buffer (&ininfo, &outinfo, inbuffer,
+          gst_structure_new ("options",
+              GST_VIDEO_CONVERTER_OPT_DITHER_METHOD,
+              GST_TYPE_VIDEO_DITHER_METHOD, GST_VIDEO_DITHER_NONE,
+              GST_VIDEO_CONVERTER_OPT_DITHER_QUANTIZATION, G_TYPE_UINT, 2,
+              GST_VIDEO_CONVERTER_OPT_CHROMA_MODE,
+              GST_TYPE_VIDEO_CHROMA_MODE, GST_VIDEO_CHROMA_MODE_NONE, NULL));
+
+      fail_unless (gst_buffer_map (outbuffer, &map, GST_MAP_READ));
+      fail_unless (gst_buffer_memcmp (refbuffer, 0, map.data, map.size) == 0);
+      gst_buffer_unmap (outbuffer, &map);
+
+      gst_buffer_unref (refbuffer);
+      gst_buffer_unref (outbuffer);
+      gst_buffer_unref (inbuffer);
+    }
+  }
+  g_rand_free (rand);
+}
+
+GST_END_TEST;
+
+typedef guint16 (*SampleFunc) (gint x, guint16 max);
+
+static guint16
+sample_flat (gint x, guint16 max)
+{
+  return 0x5a5a & max;
+}
+
+static guint16
+sample_stripes (gint x, guint16 max)
+{
+  return ((x / 3) & 1) ? max : 0;
+}
+
+/* writes the samples of @func to the 16 bits planes of @frame or checks
+ * them, without @func the samples are only checked to be in range */
+static void
+foreach_sample_u16 (GstVideoFrame * frame, SampleFunc func, gboolean write)
+{
+  const GstVideoFormatInfo *finfo = frame->info.finfo;
+  guint16 max;
+  gint plane, x, y;
+
+  max = ((1 << GST_VIDEO_FORMAT_INFO_DEPTH (finfo, 0)) - 1) <<
+      GST_VIDEO_FORMAT_INFO_SHIFT (finfo, 0);
+
+  for (plane = 0; plane < GST_VIDEO_FRAME_N_PLANES (frame); plane++) {
+    gint comp[GST_VIDEO_MAX_COMPONENTS];
+    gint width, height;
+
+    gst_video_format_info_component (finfo, plane, comp);
+    width = GST_VIDEO_FRAME_COMP_WIDTH (frame, comp[0]);
+    if (comp[1] != -1)
+      width *= 2;
+    height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, comp[0]);
+
+    for (y = 0; y < height; y++) {
+      guint16 *line = (guint16 *) ((guint8 *)
+          GST_VIDEO_FRAME_PLANE_DATA (frame, plane) +
+          y * GST_VIDEO_FRAME_PLANE_STRIDE (frame, plane));
+
+      for (x = 0; x < width; x++) {
+        if (write) {
+          GST_WRITE_UINT16_LE (line + x, func (x, max));
+        } else if (func) {
+          fail_unless_equals_int (GST_READ_UINT16_LE (line + x),
+              func (x, max));
+        } else {
+          /* in range and no bits set outside of the sample bits */
+          fail_unless_equals_int (GST_READ_UINT16_LE (line + x) & ~max, 0);
+        }
+      }
+    }
+  }
+}
+
+GST_START_TEST (test_video_convert_high_bit_depth_scale)
+{
+  static const GstVideoFormat formats[] = {
+    GST_VIDEO_FORMAT_I420_10LE, GST_VIDEO_FORMAT_I422_12LE,
+    GST_VIDEO_FORMAT_P010_10LE, GST_VIDEO_FORMAT_P012_LE
+  };
+  static const gint methods[] = {
+    GST_VIDEO_RESAMPLER_METHOD_LINEAR, GST_VIDEO_RESAMPLER_METHOD_CUBIC,
+    GST_VIDEO_RESAMPLER_METHOD_LANCZOS
+  };
+  gint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    for (j = 0; j < G_N_ELEMENTS (methods); j++) {
+      GstVideoInfo ininfo, outinfo;
+      GstVideoFrame frame;
+      GstBuffer *inbuffer, *outbuffer;
+
+      fail_unless (gst_video_info_set_format (&ininfo, formats[i], 64, 48));
+      fail_unless (gst_video_info_set_format (&outinfo, formats[i], 100, 70));
+      inbuffer = gst_buffer_new_and_alloc (ininfo.size);
+
+      /* a flat picture stays flat */
+      fail_unless (gst_video_frame_map (&frame, &ininfo, inbuffer,
+              GST_MAP_WRITE));
+      foreach_sample_u16 (&frame, sample_flat, TRUE);
+      gst_video_frame_unmap (&frame);
+
+      outbuffer = convert_buffer (&ininfo, &outinfo, inbuffer,
+          gst_structure_new ("options",
+              GST_VIDEO_CONVERTER_OPT_RESAMPLER_METHOD,
+              GST_TYPE_VIDEO_RESAMPLER_METHOD, methods[j],
+              GST_VIDEO_CONVERTER_OPT_THREADS, G_TYPE_UINT, 2, NULL));
+      fail_unless (gst_video_frame_map (&frame, &outinfo, outbuffer,
+              GST_MAP_READ));
+      foreach_sample_u16 (&frame, sample_flat, FALSE);
+      gst_video_frame_unmap (&frame);
+      gst_buffer_unref (outbuffer);
+
+      /* the overshoot of the filters on sharp edges is clamped */
+      fail_unless (gst_video_frame_map (&frame, &ininfo, inbuffer,
+              GST_MAP_WRITE));
+      foreach_sample_u16 (&frame, sample_stripes, TRUE);
+      gst_video_frame_unmap (&frame);
+
+      outbuffer = convert_buffer (&ininfo, &outinfo, inbuffer,
+          gst_structure_new ("options",
+              GST_VIDEO_CONVERTER_OPT_RESAMPLER_METHOD,
+              GST_TYPE_VIDEO_RESAMPLER_METHOD, methods[j], NULL));
+      fail_unless (gst_video_frame_map (&frame, &outinfo, outbuffer,
+              GST_MAP_READ));
+      foreach_sample_u16 (&frame, NULL, FALSE);
+      gst_video_frame_unmap (&frame);
+      gst_buffer_unref (outbuffer);
+
+      gst_buffer_unref (inbuffer);
+    }
+  }
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_video_transfer)
 {
   gint i, j;
@@ -4084,6 +4311,8 @@ video_suite (void)
   tcase_add_test (tc_chain, test_video_size_convert);
   tcase_add_test (tc_chain, test_video_convert);
   tcase_add_test (tc_chain, test_video_convert_multithreading);
+  tcase_add_test (tc_chain, test_video_convert_high_bit_depth);
+  tcase_add_test (tc_chain, test_video_convert_high_bit_depth_scale);
   tcase_add_test (tc_chain, test_video_transfer);
   tcase_add_test (tc_chain, test_overlay_blend);
   tcase_add_test (tc_chain, test_video_center_rect);
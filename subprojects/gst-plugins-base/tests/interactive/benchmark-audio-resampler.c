@@ -0,0 +1,228 @@
+/* GStreamer audio resampler benchmark
+ * Copyright (C) 2022 GStreamer developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+
+#include <gst/gst.h>
+#include <gst/audio/audio.h>
+
+/* 10ms at 48kHz, about what a conferencing mixer pushes around */
+#define DEFAULT_BLOCK_SIZE 480
+
+#define DEFAULT_DURATION 0.2
+
+static const GstAudioFormat formats[] = {
+  GST_AUDIO_FORMAT_S16,
+  GST_AUDIO_FORMAT_S32,
+  GST_AUDIO_FORMAT_F32,
+  GST_AUDIO_FORMAT_F64,
+};
+
+static const gint rates[][2] = {
+  {48000, 44100},
+  {44100, 48000},
+  {48000, 16000},
+  {16000, 48000},
+};
+
+static const gint channels[] = { 1, 2, 6 };
+
+static const GstAudioResamplerFilterMode filter_modes[] = {
+  GST_AUDIO_RESAMPLER_FILTER_MODE_FULL,
+  GST_AUDIO_RESAMPLER_FILTER_MODE_INTERPOLATED,
+};
+
+static void
+fill_block (const GstAudioFormatInfo * finfo, gpointer data, gint samples)
+{
+  gint i;
+
+  for (i = 0; i < samples; i++) {
+    gdouble v = 0.5 * sin (i * 0.01);
+
+    switch (GST_AUDIO_FORMAT_INFO_FORMAT (finfo)) {
+      case GST_AUDIO_FORMAT_S16:
+        ((gint16 *) data)[i] = v * G_MAXINT16;
+        break;
+      case GST_AUDIO_FORMAT_S32:
+        ((gint32 *) data)[i] = v * G_MAXINT32;
+        break;
+      case GST_AUDIO_FORMAT_F32:
+        ((gfloat *) data)[i] = v;
+        break;
+      case GST_AUDIO_FORMAT_F64:
+        ((gdouble *) data)[i] = v;
+        break;
+      default:
+        g_assert_not_reached ();
+    }
+  }
+}
+
+static void
+do_benchmark_resample (GstAudioFormat format, gint n_channels, gint in_rate,
+    gint out_rate, guint quality, GstAudioResamplerFilterMode filter_mode,
+    gint block_size, gdouble max_duration, GTimer * timer)
+{
+  const GstAudioFormatInfo *finfo = gst_audio_format_get_info (format);
+  gint bpf = GST_AUDIO_FORMAT_INFO_WIDTH (finfo) / 8 * n_channels;
+  GstAudioResampler *resampler;
+  GstStructure *options;
+  gpointer in, out;
+  gsize out_size;
+  guint64 frames = 0;
+  gdouble elapsed;
+  gint count = 0;
+
+  options = gst_structure_new_empty ("GstAudioResampler.options");
+  gst_audio_resampler_options_set_quality (GST_AUDIO_RESAMPLER_METHOD_KAISER,
+      quality, in_rate, out_rate, options);
+  gst_structure_set (options, GST_AUDIO_RESAMPLER_OPT_FILTER_MODE,
+      GST_TYPE_AUDIO_RESAMPLER_FILTER_MODE, filter_mode, NULL);
+
+  resampler = gst_audio_resampler_new (GST_AUDIO_RESAMPLER_METHOD_KAISER,
+      GST_AUDIO_RESAMPLER_FLAG_NONE, format, n_channels, in_rate, out_rate,
+      options);
+  gst_structure_free (options);
+
+  in = g_malloc (block_size * bpf);
+  fill_block (finfo, in, block_size * n_channels);
+
+  out_size = gst_audio_resampler_get_out_frames (resampler, block_size) + 1;
+  out = g_malloc (out_size * bpf);
+
+  g_timer_start (timer);
+  while (TRUE) {
+    gsize out_frames = gst_audio_resampler_get_out_frames (resampler,
+        block_size);
+
+    if (out_frames > out_size) {
+      out_size = out_frames;
+      out = g_realloc (out, out_size * bpf);
+    }
+    gst_audio_resampler_resample (resampler, &in, block_size, &out,
+        out_frames);
+    frames += block_size;
+    count++;
+
+    elapsed = g_timer_elapsed (timer, NULL);
+    if (elapsed >= max_duration)
+      break;
+  }
+
+  /* how many streams of this kind a single core could keep up with */
+  gst_println ("%8.1f x realtime %s %dch %5d -> %5d quality %2u %-12s "
+      "%d/%.5f", frames / (gdouble) in_rate / elapsed,
+      GST_AUDIO_FORMAT_INFO_NAME (finfo), n_channels, in_rate, out_rate,
+      quality, filter_mode == GST_AUDIO_RESAMPLER_FILTER_MODE_FULL ?
+      "full" : "interpolated", count, elapsed);
+
+  g_free (out);
+  g_free (in);
+  gst_audio_resampler_free (resampler);
+}
+
+int
+main (int argc, char **argv)
+{
+  GError *err = NULL;
+  gint block_size = DEFAULT_BLOCK_SIZE;
+  gdouble max_dur = DEFAULT_DURATION;
+  gint in_rate = 0, out_rate = 0, n_channels = 0, quality = -1;
+  gchar *format_str = NULL;
+  GOptionContext *ctx;
+  GOptionEntry options[] = {
+    {"format", 'f', 0, G_OPTION_ARG_STRING, &format_str,
+        "Only test this sample format (S16, S32, F32 or F64)", NULL},
+    {"in-rate", 'i', 0, G_OPTION_ARG_INT, &in_rate, "Input rate", NULL},
+    {"out-rate", 'o', 0, G_OPTION_ARG_INT, &out_rate, "Output rate", NULL},
+    {"channels", 'c', 0, G_OPTION_ARG_INT, &n_channels,
+        "Only test this number of channels", NULL},
+    {"quality", 'q', 0, G_OPTION_ARG_INT, &quality,
+        "Only test this quality level", NULL},
+    {"block-size", 'b', 0, G_OPTION_ARG_INT, &block_size,
+        "Input frames per resample call", NULL},
+    {"duration", 'd', 0, G_OPTION_ARG_DOUBLE, &max_dur,
+        "Benchmark duration for each run (in seconds)", NULL},
+    {NULL}
+  };
+  GTimer *timer;
+  guint f, r, c, m, q;
+
+  ctx = g_option_context_new ("");
+  g_option_context_add_main_entries (ctx, options, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_print ("Error initializing: %s\n", GST_STR_NULL (err->message));
+    g_option_context_free (ctx);
+    g_clear_error (&err);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  timer = g_timer_new ();
+
+  for (f = 0; f < G_N_ELEMENTS (formats); f++) {
+    const GstAudioFormatInfo *finfo = gst_audio_format_get_info (formats[f]);
+
+    /* accept both "F32" and the native endian "F32LE" */
+    if (format_str != NULL && !g_str_has_prefix (finfo->name, format_str))
+      continue;
+
+    for (r = 0; r < G_N_ELEMENTS (rates); r++) {
+      gint irate = in_rate > 0 ? in_rate : rates[r][0];
+      gint orate = out_rate > 0 ? out_rate : rates[r][1];
+
+      /* with both rates given only run that conversion */
+      if (in_rate > 0 && out_rate > 0 && r > 0)
+        break;
+      if (in_rate > 0 && out_rate <= 0 && rates[r][0] != in_rate)
+        continue;
+      if (out_rate > 0 && in_rate <= 0 && rates[r][1] != out_rate)
+        continue;
+
+      for (c = 0; c < G_N_ELEMENTS (channels); c++) {
+        gint ch = n_channels > 0 ? n_channels : channels[c];
+
+        if (n_channels > 0 && c > 0)
+          break;
+
+        for (m = 0; m < G_N_ELEMENTS (filter_modes); m++) {
+          for (q = GST_AUDIO_RESAMPLER_QUALITY_MIN;
+              q <= GST_AUDIO_RESAMPLER_QUALITY_MAX; q++) {
+            if (quality >= 0 && q != (guint) quality)
+              continue;
+
+            do_benchmark_resample (formats[f], ch, irate, orate, q,
+                filter_modes[m], block_size, max_dur, timer);
+          }
+        }
+      }
+    }
+  }
+
+  g_timer_destroy (timer);
+  g_free (format_str);
+
+  return 0;
+}
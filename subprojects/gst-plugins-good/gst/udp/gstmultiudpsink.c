@@ -44,6 +44,14 @@
 
 #include <gio/gnetworking.h>
 
+#ifdef __linux__
+#include <netinet/udp.h>
+/* older C libraries don't know about UDP GSO yet */
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#endif
+
 #include "gst/net/net.h"
 #include "gst/glib-compat-private.h"
 
@@ -52,6 +60,116 @@ GST_DEBUG_CATEGORY_STATIC (multiudpsink_debug);
 
 #define UDP_MAX_SIZE 65507
 
+/* maximum number of datagrams the kernel accepts in one UDP_SEGMENT send */
+#define UDP_MAX_SEGMENTS 64
+/* Datagrams bigger than the path MTU can't be segmented by the kernel, so only
+ * merge packets that fit into an Ethernet frame with IPv4 and IPv6 headers */
+#define UDP_MAX_SEGMENT_SIZE 1452
+
+#ifdef UDP_SEGMENT
+GType gst_udp_segment_message_get_type (void);
+
+#define GST_TYPE_UDP_SEGMENT_MESSAGE          (gst_udp_segment_message_get_type ())
+#define GST_UDP_SEGMENT_MESSAGE(o)            (G_TYPE_CHECK_INSTANCE_CAST ((o), GST_TYPE_UDP_SEGMENT_MESSAGE, GstUDPSegmentMessage))
+#define GST_UDP_SEGMENT_MESSAGE_CLASS(c)      (G_TYPE_CHECK_CLASS_CAST ((c), GST_TYPE_UDP_SEGMENT_MESSAGE, GstUDPSegmentMessageClass))
+#define GST_IS_UDP_SEGMENT_MESSAGE(o)         (G_TYPE_CHECK_INSTANCE_TYPE ((o), GST_TYPE_UDP_SEGMENT_MESSAGE))
+#define GST_IS_UDP_SEGMENT_MESSAGE_CLASS(c)   (G_TYPE_CHECK_CLASS_TYPE ((c), GST_TYPE_UDP_SEGMENT_MESSAGE))
+#define GST_UDP_SEGMENT_MESSAGE_GET_CLASS(o)  (G_TYPE_INSTANCE_GET_CLASS ((o), GST_TYPE_UDP_SEGMENT_MESSAGE, GstUDPSegmentMessageClass))
+
+typedef struct _GstUDPSegmentMessage GstUDPSegmentMessage;
+typedef struct _GstUDPSegmentMessageClass GstUDPSegmentMessageClass;
+
+struct _GstUDPSegmentMessageClass
+{
+  GSocketControlMessageClass parent_class;
+};
+
+struct _GstUDPSegmentMessage
+{
+  GSocketControlMessage parent;
+
+  /* size of each datagram, except for the last one */
+  guint16 segment_size;
+};
+
+G_DEFINE_TYPE (GstUDPSegmentMessage, gst_udp_segment_message,
+    G_TYPE_SOCKET_CONTROL_MESSAGE);
+
+static gsize
+gst_udp_segment_message_get_size (GSocketControlMessage * message)
+{
+  return sizeof (guint16);
+}
+
+static int
+gst_udp_segment_message_get_level (GSocketControlMessage * message)
+{
+  return IPPROTO_UDP;
+}
+
+static int
+gst_udp_segment_message_get_msg_type (GSocketControlMessage * message)
+{
+  return UDP_SEGMENT;
+}
+
+static void
+gst_udp_segment_message_serialize (GSocketControlMessage * message,
+    gpointer data)
+{
+  GstUDPSegmentMessage *msg = GST_UDP_SEGMENT_MESSAGE (message);
+
+  memcpy (data, &msg->segment_size, sizeof (guint16));
+}
+
+static GSocketControlMessage *
+gst_udp_segment_message_deserialize (gint level, gint type, gsize size,
+    gpointer data)
+{
+  GstUDPSegmentMessage *message;
+
+  if (level != IPPROTO_UDP || type != UDP_SEGMENT)
+    return NULL;
+
+  if (size < sizeof (guint16))
+    return NULL;
+
+  message = g_object_new (GST_TYPE_UDP_SEGMENT_MESSAGE, NULL);
+  memcpy (&message->segment_size, data, sizeof (guint16));
+
+  return G_SOCKET_CONTROL_MESSAGE (message);
+}
+
+static void
+gst_udp_segment_message_init (GstUDPSegmentMessage * message)
+{
+}
+
+static void
+gst_udp_segment_message_class_init (GstUDPSegmentMessageClass * class)
+{
+  GSocketControlMessageClass *scm_class;
+
+  scm_class = G_SOCKET_CONTROL_MESSAGE_CLASS (class);
+  scm_class->get_size = gst_udp_segment_message_get_size;
+  scm_class->get_level = gst_udp_segment_message_get_level;
+  scm_class->get_type = gst_udp_segment_message_get_msg_type;
+  scm_class->serialize = gst_udp_segment_message_serialize;
+  scm_class->deserialize = gst_udp_segment_message_deserialize;
+}
+
+static GSocketControlMessage *
+gst_udp_segment_message_new (guint16 segment_size)
+{
+  GstUDPSegmentMessage *message;
+
+  message = g_object_new (GST_TYPE_UDP_SEGMENT_MESSAGE, NULL);
+  message->segment_size = segment_size;
+
+  return G_SOCKET_CONTROL_MESSAGE (message);
+}
+#endif
+
 static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -92,6 +210,7 @@ enum
 #define DEFAULT_BUFFER_SIZE        0
 #define DEFAULT_BIND_ADDRESS       NULL
 #define DEFAULT_BIND_PORT          0
+#define DEFAULT_GSO                FALSE
 
 enum
 {
@@ -114,7 +233,8 @@ enum
   PROP_SEND_DUPLICATES,
   PROP_BUFFER_SIZE,
   PROP_BIND_ADDRESS,
-  PROP_BIND_PORT
+  PROP_BIND_PORT,
+  PROP_GSO
 };
 
 static void gst_multiudpsink_finalize (GObject * object);
@@ -351,6 +471,27 @@ gst_multiudpsink_class_init (GstMultiUDPSinkClass * klass)
           "Port to bind the socket to", 0, G_MAXUINT16,
           DEFAULT_BIND_PORT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstMultiUDPSink:gso:
+   *
+   * Use UDP generic segmentation offload when sending buffer lists. Runs of
+   * consecutive packets of the same size to the same client (only the last
+   * one may be smaller) are passed to the kernel in a single message, which
+   * is split into separate datagrams again by the kernel or the network card.
+   *
+   * Only packets of up to 1452 bytes are merged as bigger datagrams would
+   * need IP fragmentation, which is not possible with segmentation offload.
+   *
+   * This is only supported on Linux, the property is ignored elsewhere.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_GSO,
+      g_param_spec_boolean ("gso", "Generic Segmentation Offload",
+          "Send runs of equally sized packets to the same client with a "
+          "single UDP_SEGMENT message", DEFAULT_GSO,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_static_pad_template (gstelement_class, &sink_template);
 
   gst_element_class_set_static_metadata (gstelement_class, "UDP packet sender",
@@ -371,6 +512,10 @@ gst_multiudpsink_class_init (GstMultiUDPSinkClass * klass)
   klass->get_stats = gst_multiudpsink_get_stats;
 
   GST_DEBUG_CATEGORY_INIT (multiudpsink_debug, "multiudpsink", 0, "UDP sink");
+
+#ifdef UDP_SEGMENT
+  GST_TYPE_UDP_SEGMENT_MESSAGE;
+#endif
 }
 
 static void
@@ -419,6 +564,7 @@ gst_multiudpsink_init (GstMultiUDPSink * sink)
   sink->qos_dscp = DEFAULT_QOS_DSCP;
   sink->send_duplicates = DEFAULT_SEND_DUPLICATES;
   sink->multi_iface = g_strdup (DEFAULT_MULTICAST_IFACE);
+  sink->gso = DEFAULT_GSO;
 
   gst_multiudpsink_create_cancellable (sink);
 
@@ -557,6 +703,10 @@ gst_multiudpsink_finalize (GObject * object)
   sink->maps = NULL;
   g_free (sink->messages);
   sink->messages = NULL;
+  g_free (sink->gso_messages);
+  sink->gso_messages = NULL;
+  g_free (sink->gso_cmsgs);
+  sink->gso_cmsgs = NULL;
 
   g_free (sink->bind_address);
   sink->bind_address = NULL;
@@ -714,11 +864,86 @@ gst_multiudpsink_send_messages (GstMultiUDPSink * sink, GSocket * socket,
   return GST_FLOW_OK;
 }
 
+#ifdef UDP_SEGMENT
+/* Merges runs of messages to the same client that have the same size into a
+ * single message with an UDP_SEGMENT control message, which the kernel sends
+ * as separate datagrams again after going through the stack only once. Only
+ * the last message of a run may be smaller. @msgs contains @num_buffers
+ * messages per client, the merged messages of client i end up at indices
+ * msg_starts[i] to msg_starts[i + 1] of the returned array. */
+static GstOutputMessage *
+gst_multiudpsink_merge_gso (GstMultiUDPSink * sink, GstOutputMessage * msgs,
+    guint num_addr, guint num_buffers, guint * msg_starts)
+{
+  GstOutputMessage *out;
+  guint i, j, n = 0;
+
+  if (sink->n_gso_messages < num_addr * num_buffers) {
+    sink->n_gso_messages = GST_ROUND_UP_16 (num_addr * num_buffers);
+    g_free (sink->gso_messages);
+    sink->gso_messages = g_new (GstOutputMessage, sink->n_gso_messages);
+    g_free (sink->gso_cmsgs);
+    sink->gso_cmsgs = g_new0 (GSocketControlMessage *, sink->n_gso_messages);
+  }
+  out = sink->gso_messages;
+
+  for (i = 0; i < num_addr; ++i) {
+    GstOutputMessage *client_msgs = &msgs[i * num_buffers];
+
+    msg_starts[i] = n;
+
+    for (j = 0; j < num_buffers;) {
+      GstOutputMessage *run = &out[n];
+      gsize segment_size, run_size;
+      guint n_segments = 1;
+
+      *run = client_msgs[j++];
+      segment_size = run_size = gst_udp_calc_message_size (run);
+
+      while (j < num_buffers && n_segments < UDP_MAX_SEGMENTS
+          && segment_size > 0 && segment_size <= UDP_MAX_SEGMENT_SIZE) {
+        GstOutputMessage *next = &client_msgs[j];
+        gsize size = gst_udp_calc_message_size (next);
+
+        if (size == 0 || size > segment_size || run_size + size > UDP_MAX_SIZE)
+          break;
+
+        /* the vectors of consecutive buffers are consecutive too */
+        if (next->vectors != run->vectors + run->num_vectors)
+          break;
+
+        run->num_vectors += next->num_vectors;
+        run_size += size;
+        n_segments++;
+        j++;
+
+        /* only the last segment can be smaller */
+        if (size < segment_size)
+          break;
+      }
+
+      if (n_segments > 1) {
+        sink->gso_cmsgs[n] = gst_udp_segment_message_new (segment_size);
+        run->control_messages = &sink->gso_cmsgs[n];
+        run->num_control_messages = 1;
+      }
+      n++;
+    }
+  }
+  msg_starts[num_addr] = n;
+
+  GST_LOG_OBJECT (sink, "merged %u messages into %u", num_addr * num_buffers,
+      n);
+
+  return out;
+}
+#endif
+
 static GstFlowReturn
 gst_multiudpsink_render_buffers (GstMultiUDPSink * sink, GstBuffer ** buffers,
     guint num_buffers, guint8 * mem_nums, guint total_mem_num)
 {
-  GstOutputMessage *msgs;
+  GstOutputMessage *msgs, *send_msgs;
   gboolean send_duplicates;
   GstUDPClient **clients;
   GOutputVector *vecs;
@@ -726,6 +951,8 @@ gst_multiudpsink_render_buffers (GstMultiUDPSink * sink, GstBuffer ** buffers,
   GstFlowReturn flow_ret;
   guint num_addr_v4, num_addr_v6;
   guint num_addr, num_msgs;
+  guint num_send_msgs, num_send_msgs_v4;
+  guint *msg_starts = NULL;
   guint i, j, mem;
   gsize size = 0;
   GList *l;
@@ -808,25 +1035,36 @@ gst_multiudpsink_render_buffers (GstMultiUDPSink * sink, GstBuffer ** buffers,
     }
   }
 
+  send_msgs = msgs;
+  num_send_msgs = num_msgs;
+  num_send_msgs_v4 = num_buffers * num_addr_v4;
+
+#ifdef UDP_SEGMENT
+  if (sink->use_gso && num_buffers > 1) {
+    msg_starts = g_newa (guint, num_addr + 1);
+    send_msgs = gst_multiudpsink_merge_gso (sink, msgs, num_addr, num_buffers,
+        msg_starts);
+    num_send_msgs = msg_starts[num_addr];
+    num_send_msgs_v4 = msg_starts[num_addr_v4];
+  }
+#endif
+
   /* now send it! */
 
   /* no IPv4 socket? Send it all from the IPv6 socket then.. */
   if (sink->used_socket == NULL) {
     flow_ret = gst_multiudpsink_send_messages (sink, sink->used_socket_v6,
-        msgs, num_msgs);
+        send_msgs, num_send_msgs);
   } else {
-    guint num_msgs_v4 = num_buffers * num_addr_v4;
-    guint num_msgs_v6 = num_buffers * num_addr_v6;
-
     /* our client list is sorted with IPv4 clients first and IPv6 ones last */
     flow_ret = gst_multiudpsink_send_messages (sink, sink->used_socket,
-        msgs, num_msgs_v4);
+        send_msgs, num_send_msgs_v4);
 
     if (flow_ret != GST_FLOW_OK)
       goto cancelled;
 
     flow_ret = gst_multiudpsink_send_messages (sink, sink->used_socket_v6,
-        msgs + num_msgs_v4, num_msgs_v6);
+        send_msgs + num_send_msgs_v4, num_send_msgs - num_send_msgs_v4);
   }
 
   if (flow_ret != GST_FLOW_OK)
@@ -837,16 +1075,26 @@ gst_multiudpsink_render_buffers (GstMultiUDPSink * sink, GstBuffer ** buffers,
 
   for (i = 0; i < num_addr; ++i) {
     GstUDPClient *client = clients[i];
+    guint first, last;
 
-    for (j = 0; j < num_buffers; ++j) {
+    /* with GSO a message may have carried multiple packets */
+    if (msg_starts) {
+      first = msg_starts[i];
+      last = msg_starts[i + 1];
+    } else {
+      first = i * num_buffers;
+      last = first + num_buffers;
+    }
+
+    for (j = first; j < last; ++j) {
       gsize bytes_sent;
 
-      bytes_sent = msgs[i * num_buffers + j].bytes_sent;
+      bytes_sent = send_msgs[j].bytes_sent;
 
       client->bytes_sent += bytes_sent;
-      client->packets_sent++;
       sink->bytes_served += bytes_sent;
     }
+    client->packets_sent += num_buffers;
     gst_udp_client_unref (client);
   }
 
@@ -857,6 +1105,11 @@ out:
   for (i = 0; i < mem; ++i)
     gst_memory_unmap (map_infos[i].memory, &map_infos[i]);
 
+  if (msg_starts) {
+    for (i = 0; i < num_send_msgs; ++i)
+      g_clear_object (&sink->gso_cmsgs[i]);
+  }
+
   return flow_ret;
 
 no_clients:
@@ -1094,6 +1347,9 @@ gst_multiudpsink_set_property (GObject * object, guint prop_id,
     case PROP_BIND_PORT:
       udpsink->bind_port = g_value_get_int (value);
       break;
+    case PROP_GSO:
+      udpsink->gso = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1167,6 +1423,9 @@ gst_multiudpsink_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_BIND_PORT:
       g_value_set_int (value, udpsink->bind_port);
       break;
+    case PROP_GSO:
+      g_value_set_boolean (value, udpsink->gso);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1434,6 +1693,35 @@ gst_multiudpsink_start (GstBaseSink * bsink)
   if (sink->used_socket_v6)
     g_socket_set_broadcast (sink->used_socket_v6, TRUE);
 
+  sink->use_gso = FALSE;
+  if (sink->gso) {
+#ifdef UDP_SEGMENT
+    GError *opt_err = NULL;
+
+    /* check if the kernel knows about GSO, a segment size of 0 means that
+     * only messages with an UDP_SEGMENT control message get segmented */
+    sink->use_gso = TRUE;
+    if (sink->used_socket && !g_socket_set_option (sink->used_socket,
+            IPPROTO_UDP, UDP_SEGMENT, 0, &opt_err))
+      sink->use_gso = FALSE;
+    if (sink->use_gso && sink->used_socket_v6
+        && !g_socket_set_option (sink->used_socket_v6, IPPROTO_UDP,
+            UDP_SEGMENT, 0, &opt_err))
+      sink->use_gso = FALSE;
+
+    if (!sink->use_gso) {
+      GST_WARNING_OBJECT (sink, "Failed to enable UDP GSO: %s",
+          opt_err->message);
+      g_clear_error (&opt_err);
+    } else {
+      GST_DEBUG_OBJECT (sink, "UDP GSO enabled");
+    }
+#else
+    GST_WARNING_OBJECT (sink, "gso was requested but UDP_SEGMENT is not "
+        "defined");
+#endif
+  }
+
   sink->bytes_to_serve = 0;
   sink->bytes_served = 0;
 
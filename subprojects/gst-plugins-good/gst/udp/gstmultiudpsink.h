@@ -81,6 +81,9 @@ struct _GstMultiUDPSink {
   guint             n_maps;
   GstOutputMessage *messages;
   guint             n_messages;
+  GstOutputMessage *gso_messages;
+  GSocketControlMessage **gso_cmsgs;
+  guint             n_gso_messages;
 
   /* properties */
   guint64        bytes_to_serve;
@@ -102,6 +105,10 @@ struct _GstMultiUDPSink {
   gint           buffer_size;
   gchar         *bind_address;
   gint           bind_port;
+  gboolean       gso;
+
+  /* UDP_SEGMENT is supported by the sockets */
+  gboolean       use_gso;
 };
 
 struct _GstMultiUDPSinkClass {
@@ -65,6 +65,10 @@
  * udpsrc implements a #GstURIHandler interface that handles udp://host:port
  * type URIs.
  *
+ * For high packet rates the #GstUDPSrc:batch-size property can be used to
+ * read several packets with a single system call (recvmmsg() where available)
+ * and push them downstream as one #GstBufferList.
+ *
  * If the #GstUDPSrc:timeout property is set to a value bigger than 0, udpsrc
  * will generate an element message named `GstUDPSrcTimeout`
  * if no data was received in the given timeout.
@@ -127,6 +131,14 @@
 #include <netinet/ip.h>
 #endif
 
+#ifdef __linux__
+#include <netinet/udp.h>
+/* older C libraries don't know about UDP GRO yet */
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#endif
+
 /* Control messages for getting the destination address */
 #ifdef IP_PKTINFO
 GType gst_ip_pktinfo_message_get_type (void);
@@ -506,6 +518,89 @@ gst_socket_timestamp_message_class_init (GstSocketTimestampMessageClass * class)
 }
 #endif
 
+#ifdef UDP_GRO
+GType gst_udp_gro_message_get_type (void);
+
+#define GST_TYPE_UDP_GRO_MESSAGE          (gst_udp_gro_message_get_type ())
+#define GST_UDP_GRO_MESSAGE(o)            (G_TYPE_CHECK_INSTANCE_CAST ((o), GST_TYPE_UDP_GRO_MESSAGE, GstUDPGroMessage))
+#define GST_UDP_GRO_MESSAGE_CLASS(c)      (G_TYPE_CHECK_CLASS_CAST ((c), GST_TYPE_UDP_GRO_MESSAGE, GstUDPGroMessageClass))
+#define GST_IS_UDP_GRO_MESSAGE(o)         (G_TYPE_CHECK_INSTANCE_TYPE ((o), GST_TYPE_UDP_GRO_MESSAGE))
+#define GST_IS_UDP_GRO_MESSAGE_CLASS(c)   (G_TYPE_CHECK_CLASS_TYPE ((c), GST_TYPE_UDP_GRO_MESSAGE))
+#define GST_UDP_GRO_MESSAGE_GET_CLASS(o)  (G_TYPE_INSTANCE_GET_CLASS ((o), GST_TYPE_UDP_GRO_MESSAGE, GstUDPGroMessageClass))
+
+typedef struct _GstUDPGroMessage GstUDPGroMessage;
+typedef struct _GstUDPGroMessageClass GstUDPGroMessageClass;
+
+struct _GstUDPGroMessageClass
+{
+  GSocketControlMessageClass parent_class;
+};
+
+struct _GstUDPGroMessage
+{
+  GSocketControlMessage parent;
+
+  /* size of the coalesced datagrams, except for the last one */
+  gint segment_size;
+};
+
+G_DEFINE_TYPE (GstUDPGroMessage, gst_udp_gro_message,
+    G_TYPE_SOCKET_CONTROL_MESSAGE);
+
+static gsize
+gst_udp_gro_message_get_size (GSocketControlMessage * message)
+{
+  return sizeof (gint);
+}
+
+static int
+gst_udp_gro_message_get_level (GSocketControlMessage * message)
+{
+  return IPPROTO_UDP;
+}
+
+static int
+gst_udp_gro_message_get_msg_type (GSocketControlMessage * message)
+{
+  return UDP_GRO;
+}
+
+static GSocketControlMessage *
+gst_udp_gro_message_deserialize (gint level, gint type, gsize size,
+    gpointer data)
+{
+  GstUDPGroMessage *message;
+
+  if (level != IPPROTO_UDP || type != UDP_GRO)
+    return NULL;
+
+  if (size < sizeof (gint))
+    return NULL;
+
+  message = g_object_new (GST_TYPE_UDP_GRO_MESSAGE, NULL);
+  memcpy (&message->segment_size, data, sizeof (gint));
+
+  return G_SOCKET_CONTROL_MESSAGE (message);
+}
+
+static void
+gst_udp_gro_message_init (GstUDPGroMessage * message)
+{
+}
+
+static void
+gst_udp_gro_message_class_init (GstUDPGroMessageClass * class)
+{
+  GSocketControlMessageClass *scm_class;
+
+  scm_class = G_SOCKET_CONTROL_MESSAGE_CLASS (class);
+  scm_class->get_size = gst_udp_gro_message_get_size;
+  scm_class->get_level = gst_udp_gro_message_get_level;
+  scm_class->get_type = gst_udp_gro_message_get_msg_type;
+  scm_class->deserialize = gst_udp_gro_message_deserialize;
+}
+#endif
+
 static gboolean
 gst_udpsrc_decide_allocation (GstBaseSrc * bsrc, GstQuery * query)
 {
@@ -570,6 +665,18 @@ static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
 #define UDP_DEFAULT_LOOP               TRUE
 #define UDP_DEFAULT_RETRIEVE_SENDER_ADDRESS TRUE
 #define UDP_DEFAULT_MTU                (1492)
+#define UDP_DEFAULT_BATCH_SIZE         1
+#define UDP_DEFAULT_GRO                FALSE
+
+/* recvmmsg() doesn't take more messages than that */
+#define UDP_MAX_BATCH_SIZE             1024
+
+/* don't block for the rest of a batch once the first packet is there */
+#ifdef MSG_DONTWAIT
+#define UDP_BATCH_RECEIVE_FLAGS        MSG_DONTWAIT
+#else
+#define UDP_BATCH_RECEIVE_FLAGS        0
+#endif
 
 enum
 {
@@ -593,14 +700,18 @@ enum
   PROP_RETRIEVE_SENDER_ADDRESS,
   PROP_MTU,
   PROP_SOCKET_TIMESTAMP,
+  PROP_BATCH_SIZE,
+  PROP_GRO,
 };
 
 static void gst_udpsrc_uri_handler_init (gpointer g_iface, gpointer iface_data);
 
 static GstCaps *gst_udpsrc_getcaps (GstBaseSrc * src, GstCaps * filter);
 static gboolean gst_udpsrc_close (GstUDPSrc * src);
+static void gst_udpsrc_free_batch (GstUDPSrc * udpsrc);
 static gboolean gst_udpsrc_unlock (GstBaseSrc * bsrc);
 static gboolean gst_udpsrc_unlock_stop (GstBaseSrc * bsrc);
+static GstFlowReturn gst_udpsrc_create (GstPushSrc * psrc, GstBuffer ** buf);
 static GstFlowReturn gst_udpsrc_fill (GstPushSrc * psrc, GstBuffer * outbuf);
 
 static void gst_udpsrc_finalize (GObject * object);
@@ -646,6 +757,9 @@ gst_udpsrc_class_init (GstUDPSrcClass * klass)
 #ifdef SO_TIMESTAMPNS
   GST_TYPE_SOCKET_TIMESTAMP_MESSAGE;
 #endif
+#ifdef UDP_GRO
+  GST_TYPE_UDP_GRO_MESSAGE;
+#endif
 
   gobject_class->set_property = gst_udpsrc_set_property;
   gobject_class->get_property = gst_udpsrc_get_property;
@@ -779,6 +893,50 @@ gst_udpsrc_class_init (GstUDPSrcClass * klass)
           GST_SOCKET_TIMESTAMP_MODE, GST_SOCKET_TIMESTAMP_MODE_REALTIME,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstUDPSrc:batch-size:
+   *
+   * Maximum number of packets to read from the socket per wakeup. When bigger
+   * than 1, all packets that are already queued on the socket (up to this
+   * number) are read with a single system call into buffers acquired from the
+   * pool in advance, and pushed downstream in a single #GstBufferList.
+   *
+   * Batching is only available on platforms that support non-blocking
+   * receives per call (e.g. with MSG_DONTWAIT), it is ignored otherwise.
+   *
+   * The packets of a batch share the memory for data that does not fit into
+   * #GstUDPSrc:mtu, so the first time more than one packet of a batch
+   * exceeds it, all but the last of these are dropped. After that, or when
+   * GRO is used, every packet of a batch gets its own 64kB of memory for
+   * that. Set the mtu to the biggest expected packet size to avoid both.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_BATCH_SIZE,
+      g_param_spec_uint ("batch-size", "Batch Size",
+          "Maximum number of packets to read per wakeup and to push downstream "
+          "as one buffer list (1 = one buffer per packet)",
+          1, UDP_MAX_BATCH_SIZE, UDP_DEFAULT_BATCH_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstUDPSrc:gro:
+   *
+   * Enable UDP generic receive offload on the socket. The kernel then
+   * coalesces consecutive datagrams of the same size from the same sender
+   * into a single receive, which udpsrc splits into one buffer per datagram
+   * again without copying the data. All datagrams of a coalesced receive are
+   * pushed downstream in one #GstBufferList.
+   *
+   * This is only supported on Linux, the property is ignored elsewhere.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_GRO,
+      g_param_spec_boolean ("gro", "Generic Receive Offload",
+          "Let the kernel coalesce datagrams of the same size (UDP_GRO)",
+          UDP_DEFAULT_GRO, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_static_pad_template (gstelement_class, &src_template);
 
   gst_element_class_set_static_metadata (gstelement_class,
@@ -794,7 +952,7 @@ gst_udpsrc_class_init (GstUDPSrcClass * klass)
   gstbasesrc_class->get_caps = gst_udpsrc_getcaps;
   gstbasesrc_class->decide_allocation = gst_udpsrc_decide_allocation;
 
-  gstpushsrc_class->fill = gst_udpsrc_fill;
+  gstpushsrc_class->create = gst_udpsrc_create;
 
   gst_type_mark_as_plugin_api (GST_TYPE_SOCKET_TIMESTAMP_MODE, 0);
 }
@@ -821,6 +979,8 @@ gst_udpsrc_init (GstUDPSrc * udpsrc)
   udpsrc->loop = UDP_DEFAULT_LOOP;
   udpsrc->retrieve_sender_address = UDP_DEFAULT_RETRIEVE_SENDER_ADDRESS;
   udpsrc->mtu = UDP_DEFAULT_MTU;
+  udpsrc->batch_size = UDP_DEFAULT_BATCH_SIZE;
+  udpsrc->gro = UDP_DEFAULT_GRO;
 
   /* configure basesrc to be a live source */
   gst_base_src_set_live (GST_BASE_SRC (udpsrc), TRUE);
@@ -863,6 +1023,8 @@ gst_udpsrc_finalize (GObject * object)
     gst_memory_unref (udpsrc->extra_mem);
   udpsrc->extra_mem = NULL;
 
+  gst_udpsrc_free_batch (udpsrc);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -912,81 +1074,157 @@ gst_udpsrc_free_cancellable (GstUDPSrc * src)
   src->cancellable = NULL;
 }
 
-static GstFlowReturn
-gst_udpsrc_fill (GstPushSrc * psrc, GstBuffer * outbuf)
+static gboolean
+gst_udpsrc_wants_control_messages (GstUDPSrc * udpsrc)
 {
-  GstUDPSrc *udpsrc;
-  GSocketAddress *saddr = NULL;
-  GSocketAddress **p_saddr;
-  gint flags = G_SOCKET_MSG_NONE;
-  gboolean try_again;
-  GError *err = NULL;
-  gssize res;
-  gsize offset;
-  GSocketControlMessage **msgs = NULL;
-  GSocketControlMessage ***p_msgs;
-  gint n_msgs = 0, i;
-  GstMapInfo info;
-  GstMapInfo extra_info;
-  GInputVector ivec[2];
-
-  udpsrc = GST_UDPSRC_CAST (psrc);
+  gboolean res;
 
   /* optimization: use messages only in multicast mode and
    * if we can't let the kernel do the filtering for us */
-  p_msgs =
-      (g_inet_address_get_is_multicast (g_inet_socket_address_get_address
-          (udpsrc->addr))) ? &msgs : NULL;
+  res =
+      g_inet_address_get_is_multicast (g_inet_socket_address_get_address
+      (udpsrc->addr));
 #ifdef IP_MULTICAST_ALL
   if (g_inet_address_get_family (g_inet_socket_address_get_address
           (udpsrc->addr)) == G_SOCKET_FAMILY_IPV4)
-    p_msgs = NULL;
+    res = FALSE;
 #endif
 #ifdef SO_TIMESTAMPNS
   if (udpsrc->socket_timestamp_mode == GST_SOCKET_TIMESTAMP_MODE_REALTIME)
-    p_msgs = &msgs;
+    res = TRUE;
 #endif
+  /* the segment size of coalesced datagrams comes as control message */
+  if (udpsrc->use_gro)
+    res = TRUE;
 
-  /* Retrieve sender address unless we've been configured not to do so */
-  p_saddr = (udpsrc->retrieve_sender_address) ? &saddr : NULL;
+  return res;
+}
 
-  if (!gst_buffer_map (outbuf, &info, GST_MAP_READWRITE))
-    goto buffer_map_error;
+/* Parses the control messages received along with a packet. Sets the DTS of
+ * @outbuf from the socket timestamp if any, stores the GRO segment size in
+ * @segment_size if not NULL and returns TRUE if the packet was sent to a
+ * different multicast address and needs to be dropped */
+static gboolean
+gst_udpsrc_process_control_messages (GstUDPSrc * udpsrc, GstBuffer * outbuf,
+    GSocketControlMessage ** msgs, gint n_msgs, guint * segment_size)
+{
+  GInetAddress *iaddr = g_inet_socket_address_get_address (udpsrc->addr);
+  gboolean skip_packet = FALSE;
+  gsize iaddr_size = g_inet_address_get_native_size (iaddr);
+  const guint8 *iaddr_bytes = g_inet_address_to_bytes (iaddr);
+  gint i;
 
-  ivec[0].buffer = info.data;
-  ivec[0].size = info.size;
+  for (i = 0; i < n_msgs && !skip_packet; i++) {
+#ifdef IP_PKTINFO
+    if (GST_IS_IP_PKTINFO_MESSAGE (msgs[i])) {
+      GstIPPktinfoMessage *msg = GST_IP_PKTINFO_MESSAGE (msgs[i]);
 
-  /* Prepare memory in case the data size exceeds mtu */
-  if (udpsrc->extra_mem == NULL) {
-    GstBufferPool *pool;
-    GstStructure *config;
-    GstAllocator *allocator = NULL;
-    GstAllocationParams params;
+      if (sizeof (msg->addr) == iaddr_size
+          && memcmp (iaddr_bytes, &msg->addr, sizeof (msg->addr)))
+        skip_packet = TRUE;
+    }
+#endif
+#ifdef IPV6_PKTINFO
+    if (GST_IS_IPV6_PKTINFO_MESSAGE (msgs[i])) {
+      GstIPV6PktinfoMessage *msg = GST_IPV6_PKTINFO_MESSAGE (msgs[i]);
 
-    pool = gst_base_src_get_buffer_pool (GST_BASE_SRC_CAST (psrc));
-    config = gst_buffer_pool_get_config (pool);
-    gst_buffer_pool_config_get_allocator (config, &allocator, &params);
+      if (sizeof (msg->addr) == iaddr_size
+          && memcmp (iaddr_bytes, &msg->addr, sizeof (msg->addr)))
+        skip_packet = TRUE;
+    }
+#endif
+#ifdef IP_RECVDSTADDR
+    if (GST_IS_IP_RECVDSTADDR_MESSAGE (msgs[i])) {
+      GstIPRecvdstaddrMessage *msg = GST_IP_RECVDSTADDR_MESSAGE (msgs[i]);
 
-    udpsrc->extra_mem =
-        gst_allocator_alloc (allocator, MAX_IPV4_UDP_PACKET_SIZE, &params);
+      if (sizeof (msg->addr) == iaddr_size
+          && memcmp (iaddr_bytes, &msg->addr, sizeof (msg->addr)))
+        skip_packet = TRUE;
+    }
+#endif
+#ifdef SO_TIMESTAMPNS
+    if (GST_IS_SOCKET_TIMESTAMP_MESSAGE (msgs[i])) {
+      GstSocketTimestampMessage *msg = GST_SOCKET_TIMESTAMP_MESSAGE (msgs[i]);
+      GstClock *clock;
+      GstClockTime socket_ts;
+
+      socket_ts = GST_TIMESPEC_TO_TIME (msg->socket_ts);
+      GST_TRACE_OBJECT (udpsrc,
+          "Got SCM_TIMESTAMPNS %" GST_TIME_FORMAT " in msg",
+          GST_TIME_ARGS (socket_ts));
+
+      clock = gst_element_get_clock (GST_ELEMENT_CAST (udpsrc));
+      if (clock != NULL) {
+        gint64 adjust_dts, cur_sys_time, delta;
+        GstClockTime base_time, cur_gst_clk_time, running_time;
+
+        /*
+         * We use g_get_real_time as the time reference for SCM timestamps
+         * is always CLOCK_REALTIME.
+         */
+        cur_sys_time = g_get_real_time () * GST_USECOND;
+        cur_gst_clk_time = gst_clock_get_time (clock);
+
+        delta = (gint64) cur_sys_time - (gint64) socket_ts;
+        if (delta < 0) {
+          /*
+           * The current system time will always be greater than the SCM
+           * timestamp as the packet would have been timestamped at least
+           * some clock cycles before. If it is not, then the system time
+           * was adjusted. Since we cannot rely on the delta calculation in
+           * such a case, set the DTS to current pipeline clock when this
+           * happens.
+           */
+          GST_LOG_OBJECT (udpsrc,
+              "Current system time is behind SCM timestamp, setting DTS to pipeline clock");
+          GST_BUFFER_DTS (outbuf) = cur_gst_clk_time;
+        } else {
+          base_time = gst_element_get_base_time (GST_ELEMENT_CAST (udpsrc));
+          running_time = cur_gst_clk_time - base_time;
+          adjust_dts = (gint64) running_time - delta;
+          /*
+           * If the system time was adjusted much further ahead, we might
+           * end up with delta > cur_gst_clk_time. Set the DTS to current
+           * pipeline clock for this scenario as well.
+           */
+          if (adjust_dts < 0) {
+            GST_LOG_OBJECT (udpsrc,
+                "Current system time much ahead in time, setting DTS to pipeline clock");
+            GST_BUFFER_DTS (outbuf) = cur_gst_clk_time;
+          } else {
+            GST_BUFFER_DTS (outbuf) = adjust_dts;
+            GST_LOG_OBJECT (udpsrc, "Setting DTS to %" GST_TIME_FORMAT,
+                GST_TIME_ARGS (GST_BUFFER_DTS (outbuf)));
+          }
+        }
+        g_object_unref (clock);
+      } else {
+        GST_ERROR_OBJECT (udpsrc,
+            "Failed to get element clock, not setting DTS");
+      }
+    }
+#endif
+#ifdef UDP_GRO
+    if (GST_IS_UDP_GRO_MESSAGE (msgs[i])) {
+      GstUDPGroMessage *msg = GST_UDP_GRO_MESSAGE (msgs[i]);
 
-    gst_object_unref (pool);
-    gst_structure_free (config);
-    if (allocator)
-      gst_object_unref (allocator);
+      GST_TRACE_OBJECT (udpsrc, "Got GRO segment size %d", msg->segment_size);
+      if (segment_size && msg->segment_size > 0)
+        *segment_size = msg->segment_size;
+    }
+#endif
   }
 
-  if (!gst_memory_map (udpsrc->extra_mem, &extra_info, GST_MAP_READWRITE))
-    goto memory_map_error;
-
-  ivec[1].buffer = extra_info.data;
-  ivec[1].size = extra_info.size;
+  return skip_packet;
+}
 
-retry:
-  if (saddr != NULL) {
-    g_object_unref (saddr);
-    saddr = NULL;
-  }
+/* Waits until there is data to read on the socket, posting a timeout message
+ * every time the configured timeout expires in the meantime */
+static GstFlowReturn
+gst_udpsrc_wait_readable (GstUDPSrc * udpsrc)
+{
+  GError *err = NULL;
+  gboolean try_again;
 
   do {
     gint64 timeout;
@@ -1020,6 +1258,99 @@ retry:
     }
   } while (G_UNLIKELY (try_again));
 
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+select_error:
+  {
+    GST_ELEMENT_ERROR (udpsrc, RESOURCE, READ, (NULL),
+        ("select error: %s", err->message));
+    g_clear_error (&err);
+    return GST_FLOW_ERROR;
+  }
+stopped:
+  {
+    GST_DEBUG ("stop called");
+    g_clear_error (&err);
+    return GST_FLOW_FLUSHING;
+  }
+}
+
+/* Allocates the memory that is appended to packets bigger than the MTU */
+static GstMemory *
+gst_udpsrc_alloc_extra_mem (GstUDPSrc * udpsrc)
+{
+  GstBufferPool *pool;
+  GstStructure *config;
+  GstAllocator *allocator = NULL;
+  GstAllocationParams params;
+  GstMemory *mem;
+
+  pool = gst_base_src_get_buffer_pool (GST_BASE_SRC_CAST (udpsrc));
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_get_allocator (config, &allocator, &params);
+
+  mem = gst_allocator_alloc (allocator, MAX_IPV4_UDP_PACKET_SIZE, &params);
+
+  gst_object_unref (pool);
+  gst_structure_free (config);
+  if (allocator)
+    gst_object_unref (allocator);
+
+  return mem;
+}
+
+static GstFlowReturn
+gst_udpsrc_fill (GstPushSrc * psrc, GstBuffer * outbuf)
+{
+  GstUDPSrc *udpsrc;
+  GSocketAddress *saddr = NULL;
+  GSocketAddress **p_saddr;
+  gint flags = G_SOCKET_MSG_NONE;
+  GstFlowReturn ret;
+  GError *err = NULL;
+  gssize res;
+  gsize offset;
+  GSocketControlMessage **msgs = NULL;
+  GSocketControlMessage ***p_msgs;
+  gint n_msgs = 0, i;
+  GstMapInfo info;
+  GstMapInfo extra_info;
+  GInputVector ivec[2];
+
+  udpsrc = GST_UDPSRC_CAST (psrc);
+
+  p_msgs = gst_udpsrc_wants_control_messages (udpsrc) ? &msgs : NULL;
+
+  /* Retrieve sender address unless we've been configured not to do so */
+  p_saddr = (udpsrc->retrieve_sender_address) ? &saddr : NULL;
+
+  if (!gst_buffer_map (outbuf, &info, GST_MAP_READWRITE))
+    goto buffer_map_error;
+
+  ivec[0].buffer = info.data;
+  ivec[0].size = info.size;
+
+  /* Prepare memory in case the data size exceeds mtu */
+  if (udpsrc->extra_mem == NULL)
+    udpsrc->extra_mem = gst_udpsrc_alloc_extra_mem (udpsrc);
+
+  if (!gst_memory_map (udpsrc->extra_mem, &extra_info, GST_MAP_READWRITE))
+    goto memory_map_error;
+
+  ivec[1].buffer = extra_info.data;
+  ivec[1].size = extra_info.size;
+
+retry:
+  if (saddr != NULL) {
+    g_object_unref (saddr);
+    saddr = NULL;
+  }
+
+  ret = gst_udpsrc_wait_readable (udpsrc);
+  if (G_UNLIKELY (ret != GST_FLOW_OK))
+    goto wait_failed;
+
   res =
       g_socket_receive_message (udpsrc->used_socket, p_saddr, ivec, 2,
       p_msgs, &n_msgs, &flags, udpsrc->cancellable, &err);
@@ -1040,102 +1371,11 @@ retry:
   /* Retry if multicast and the destination address is not ours. We don't want
    * to receive arbitrary packets */
   if (p_msgs) {
-    GInetAddress *iaddr = g_inet_socket_address_get_address (udpsrc->addr);
-    gboolean skip_packet = FALSE;
-    gsize iaddr_size = g_inet_address_get_native_size (iaddr);
-    const guint8 *iaddr_bytes = g_inet_address_to_bytes (iaddr);
-
-    for (i = 0; i < n_msgs && !skip_packet; i++) {
-#ifdef IP_PKTINFO
-      if (GST_IS_IP_PKTINFO_MESSAGE (msgs[i])) {
-        GstIPPktinfoMessage *msg = GST_IP_PKTINFO_MESSAGE (msgs[i]);
-
-        if (sizeof (msg->addr) == iaddr_size
-            && memcmp (iaddr_bytes, &msg->addr, sizeof (msg->addr)))
-          skip_packet = TRUE;
-      }
-#endif
-#ifdef IPV6_PKTINFO
-      if (GST_IS_IPV6_PKTINFO_MESSAGE (msgs[i])) {
-        GstIPV6PktinfoMessage *msg = GST_IPV6_PKTINFO_MESSAGE (msgs[i]);
-
-        if (sizeof (msg->addr) == iaddr_size
-            && memcmp (iaddr_bytes, &msg->addr, sizeof (msg->addr)))
-          skip_packet = TRUE;
-      }
-#endif
-#ifdef IP_RECVDSTADDR
-      if (GST_IS_IP_RECVDSTADDR_MESSAGE (msgs[i])) {
-        GstIPRecvdstaddrMessage *msg = GST_IP_RECVDSTADDR_MESSAGE (msgs[i]);
+    gboolean skip_packet;
 
-        if (sizeof (msg->addr) == iaddr_size
-            && memcmp (iaddr_bytes, &msg->addr, sizeof (msg->addr)))
-          skip_packet = TRUE;
-      }
-#endif
-#ifdef SO_TIMESTAMPNS
-      if (GST_IS_SOCKET_TIMESTAMP_MESSAGE (msgs[i])) {
-        GstSocketTimestampMessage *msg = GST_SOCKET_TIMESTAMP_MESSAGE (msgs[i]);
-        GstClock *clock;
-        GstClockTime socket_ts;
-
-        socket_ts = GST_TIMESPEC_TO_TIME (msg->socket_ts);
-        GST_TRACE_OBJECT (udpsrc,
-            "Got SCM_TIMESTAMPNS %" GST_TIME_FORMAT " in msg",
-            GST_TIME_ARGS (socket_ts));
-
-        clock = gst_element_get_clock (GST_ELEMENT_CAST (udpsrc));
-        if (clock != NULL) {
-          gint64 adjust_dts, cur_sys_time, delta;
-          GstClockTime base_time, cur_gst_clk_time, running_time;
-
-          /*
-           * We use g_get_real_time as the time reference for SCM timestamps
-           * is always CLOCK_REALTIME.
-           */
-          cur_sys_time = g_get_real_time () * GST_USECOND;
-          cur_gst_clk_time = gst_clock_get_time (clock);
-
-          delta = (gint64) cur_sys_time - (gint64) socket_ts;
-          if (delta < 0) {
-            /*
-             * The current system time will always be greater than the SCM
-             * timestamp as the packet would have been timestamped at least
-             * some clock cycles before. If it is not, then the system time
-             * was adjusted. Since we cannot rely on the delta calculation in
-             * such a case, set the DTS to current pipeline clock when this
-             * happens.
-             */
-            GST_LOG_OBJECT (udpsrc,
-                "Current system time is behind SCM timestamp, setting DTS to pipeline clock");
-            GST_BUFFER_DTS (outbuf) = cur_gst_clk_time;
-          } else {
-            base_time = gst_element_get_base_time (GST_ELEMENT_CAST (udpsrc));
-            running_time = cur_gst_clk_time - base_time;
-            adjust_dts = (gint64) running_time - delta;
-            /*
-             * If the system time was adjusted much further ahead, we might
-             * end up with delta > cur_gst_clk_time. Set the DTS to current
-             * pipeline clock for this scenario as well.
-             */
-            if (adjust_dts < 0) {
-              GST_LOG_OBJECT (udpsrc,
-                  "Current system time much ahead in time, setting DTS to pipeline clock");
-              GST_BUFFER_DTS (outbuf) = cur_gst_clk_time;
-            } else {
-              GST_BUFFER_DTS (outbuf) = adjust_dts;
-              GST_LOG_OBJECT (udpsrc, "Setting DTS to %" GST_TIME_FORMAT,
-                  GST_TIME_ARGS (GST_BUFFER_DTS (outbuf)));
-            }
-          }
-          g_object_unref (clock);
-        } else {
-          GST_ERROR_OBJECT (udpsrc,
-              "Failed to get element clock, not setting DTS");
-        }
-      }
-#endif
-    }
+    skip_packet =
+        gst_udpsrc_process_control_messages (udpsrc, outbuf, msgs, n_msgs,
+        NULL);
 
     for (i = 0; i < n_msgs; i++) {
       g_object_unref (msgs[i]);
@@ -1192,22 +1432,11 @@ memory_map_error:
         ("Failed to map memory"));
     return GST_FLOW_ERROR;
   }
-select_error:
+wait_failed:
   {
     gst_buffer_unmap (outbuf, &info);
     gst_memory_unmap (udpsrc->extra_mem, &extra_info);
-    GST_ELEMENT_ERROR (udpsrc, RESOURCE, READ, (NULL),
-        ("select error: %s", err->message));
-    g_clear_error (&err);
-    return GST_FLOW_ERROR;
-  }
-stopped:
-  {
-    gst_buffer_unmap (outbuf, &info);
-    gst_memory_unmap (udpsrc->extra_mem, &extra_info);
-    GST_DEBUG ("stop called");
-    g_clear_error (&err);
-    return GST_FLOW_FLUSHING;
+    return ret;
   }
 receive_error:
   {
@@ -1234,6 +1463,451 @@ skip_error:
   }
 }
 
+static void
+gst_udpsrc_free_batch (GstUDPSrc * udpsrc)
+{
+  guint i;
+
+  for (i = 0; i < udpsrc->n_batch; i++) {
+    gst_clear_buffer (&udpsrc->batch_bufs[i]);
+    if (udpsrc->batch_extra_mems[i])
+      gst_memory_unref (udpsrc->batch_extra_mems[i]);
+  }
+
+  g_free (udpsrc->batch_msgs);
+  udpsrc->batch_msgs = NULL;
+  g_free (udpsrc->batch_vecs);
+  udpsrc->batch_vecs = NULL;
+  g_free (udpsrc->batch_maps);
+  udpsrc->batch_maps = NULL;
+  g_free (udpsrc->batch_bufs);
+  udpsrc->batch_bufs = NULL;
+  g_free (udpsrc->batch_extra_mems);
+  udpsrc->batch_extra_mems = NULL;
+  g_free (udpsrc->batch_saddrs);
+  udpsrc->batch_saddrs = NULL;
+  g_free (udpsrc->batch_cmsgs);
+  udpsrc->batch_cmsgs = NULL;
+  g_free (udpsrc->batch_n_cmsgs);
+  udpsrc->batch_n_cmsgs = NULL;
+  udpsrc->n_batch = 0;
+
+  if (udpsrc->batch_extra_mem) {
+    gst_memory_unref (udpsrc->batch_extra_mem);
+    udpsrc->batch_extra_mem = NULL;
+  }
+  udpsrc->batch_extra_per_packet = FALSE;
+}
+
+static void
+gst_udpsrc_ensure_batch (GstUDPSrc * udpsrc, guint batch_size)
+{
+  if (udpsrc->n_batch >= batch_size)
+    return;
+
+  gst_udpsrc_free_batch (udpsrc);
+
+  udpsrc->n_batch = batch_size;
+  udpsrc->batch_msgs = g_new0 (GInputMessage, batch_size);
+  /* one vector for the pool buffer and one for the extra memory */
+  udpsrc->batch_vecs = g_new0 (GInputVector, 2 * batch_size);
+  udpsrc->batch_maps = g_new0 (GstMapInfo, 2 * batch_size);
+  udpsrc->batch_bufs = g_new0 (GstBuffer *, batch_size);
+  udpsrc->batch_extra_mems = g_new0 (GstMemory *, batch_size);
+  udpsrc->batch_saddrs = g_new0 (GSocketAddress *, batch_size);
+  udpsrc->batch_cmsgs = g_new0 (GSocketControlMessage **, batch_size);
+  udpsrc->batch_n_cmsgs = g_new0 (guint, batch_size);
+}
+
+static void
+gst_udpsrc_unmap_batch (GstUDPSrc * udpsrc, guint n_mapped)
+{
+  guint i;
+
+  for (i = 0; i < n_mapped; i++) {
+    GstMapInfo *maps = &udpsrc->batch_maps[2 * i];
+
+    gst_buffer_unmap (udpsrc->batch_bufs[i], &maps[0]);
+    if (maps[1].memory) {
+      gst_memory_unmap (maps[1].memory, &maps[1]);
+      maps[1].memory = NULL;
+    }
+  }
+
+  if (udpsrc->batch_extra_map.memory) {
+    gst_memory_unmap (udpsrc->batch_extra_mem, &udpsrc->batch_extra_map);
+    udpsrc->batch_extra_map.memory = NULL;
+  }
+}
+
+/* Reads up to @batch_size packets with a single g_socket_receive_messages()
+ * call into buffers acquired from our pool and submits them downstream as a
+ * buffer list. Buffers that did not receive a packet are kept around for the
+ * next call.
+ *
+ * Giving every packet its own extra memory for data beyond the mtu would
+ * cost 64kB per packet of the batch. Instead all packets share one extra
+ * memory, which only works out when at most one packet of a batch is bigger
+ * than the mtu. Once that is not the case, the other big packets of that
+ * batch are lost and every packet gets its own extra memory from then on,
+ * as it is apparently needed. With GRO that is the case from the start. */
+static GstFlowReturn
+gst_udpsrc_fill_list (GstUDPSrc * udpsrc, guint batch_size)
+{
+  GstBaseSrc *bsrc = GST_BASE_SRC_CAST (udpsrc);
+  GstBufferPool *pool;
+  GstBufferList *list;
+  GstFlowReturn ret;
+  GError *err = NULL;
+  GstClockTime dts;
+  gboolean want_msgs, skip_error, per_packet;
+  guint n_mapped, n_received, n_big, last_big, i;
+  gint res;
+
+  pool = gst_base_src_get_buffer_pool (bsrc);
+  if (G_UNLIKELY (pool == NULL))
+    goto no_pool;
+
+  gst_udpsrc_ensure_batch (udpsrc, batch_size);
+  want_msgs = gst_udpsrc_wants_control_messages (udpsrc);
+
+retry:
+  n_mapped = 0;
+  per_packet = udpsrc->batch_extra_per_packet || udpsrc->use_gro;
+
+  /* Prepare memory in case the data size exceeds mtu */
+  if (!per_packet) {
+    if (udpsrc->batch_extra_mem == NULL)
+      udpsrc->batch_extra_mem = gst_udpsrc_alloc_extra_mem (udpsrc);
+    if (!gst_memory_map (udpsrc->batch_extra_mem, &udpsrc->batch_extra_map,
+            GST_MAP_READWRITE))
+      goto map_error;
+  }
+
+  for (i = 0; i < batch_size; i++) {
+    GInputMessage *msg = &udpsrc->batch_msgs[i];
+    GInputVector *ivec = &udpsrc->batch_vecs[2 * i];
+    GstMapInfo *maps = &udpsrc->batch_maps[2 * i];
+
+    /* the pool was renegotiated, don't hold on to buffers of the old one */
+    if (udpsrc->batch_bufs[i] && udpsrc->batch_bufs[i]->pool != pool)
+      gst_clear_buffer (&udpsrc->batch_bufs[i]);
+
+    if (udpsrc->batch_bufs[i] == NULL) {
+      ret = gst_buffer_pool_acquire_buffer (pool, &udpsrc->batch_bufs[i],
+          NULL);
+      if (G_UNLIKELY (ret != GST_FLOW_OK))
+        goto acquire_failed;
+    }
+
+    if (per_packet && udpsrc->batch_extra_mems[i] == NULL)
+      udpsrc->batch_extra_mems[i] = gst_udpsrc_alloc_extra_mem (udpsrc);
+
+    if (!gst_buffer_map (udpsrc->batch_bufs[i], &maps[0], GST_MAP_READWRITE))
+      goto map_error;
+
+    if (per_packet) {
+      if (!gst_memory_map (udpsrc->batch_extra_mems[i], &maps[1],
+              GST_MAP_READWRITE)) {
+        gst_buffer_unmap (udpsrc->batch_bufs[i], &maps[0]);
+        goto map_error;
+      }
+      ivec[1].buffer = maps[1].data;
+      ivec[1].size = maps[1].size;
+    } else {
+      ivec[1].buffer = udpsrc->batch_extra_map.data;
+      ivec[1].size = udpsrc->batch_extra_map.size;
+    }
+    n_mapped++;
+
+    ivec[0].buffer = maps[0].data;
+    ivec[0].size = maps[0].size;
+
+    /* Retrieve sender address unless we've been configured not to do so */
+    msg->address = udpsrc->retrieve_sender_address ?
+        &udpsrc->batch_saddrs[i] : NULL;
+    msg->vectors = ivec;
+    msg->num_vectors = 2;
+    msg->bytes_received = 0;
+    msg->flags = G_SOCKET_MSG_NONE;
+    msg->control_messages = want_msgs ? &udpsrc->batch_cmsgs[i] : NULL;
+    msg->num_control_messages = want_msgs ? &udpsrc->batch_n_cmsgs[i] : NULL;
+  }
+
+  ret = gst_udpsrc_wait_readable (udpsrc);
+  if (G_UNLIKELY (ret != GST_FLOW_OK))
+    goto wait_failed;
+
+  /* the socket is readable now, only collect what is already queued instead
+   * of blocking until the whole batch is filled */
+  res =
+      g_socket_receive_messages (udpsrc->used_socket, udpsrc->batch_msgs,
+      batch_size, UDP_BATCH_RECEIVE_FLAGS, udpsrc->cancellable, &err);
+
+  gst_udpsrc_unmap_batch (udpsrc, n_mapped);
+
+  if (G_UNLIKELY (res < 0)) {
+    /* see gst_udpsrc_fill() */
+    if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_HOST_UNREACHABLE) ||
+        g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CONNECTION_CLOSED)) {
+      g_clear_error (&err);
+      goto retry;
+    }
+    goto receive_error;
+  }
+  n_received = res;
+
+  /* the extra data of all but the last big packet was overwritten */
+  n_big = 0;
+  last_big = 0;
+  if (!per_packet) {
+    for (i = 0; i < n_received; i++) {
+      if (udpsrc->batch_msgs[i].bytes_received > udpsrc->mtu) {
+        n_big++;
+        last_big = i;
+      }
+    }
+    if (n_big > 1) {
+      GST_WARNING_OBJECT (udpsrc, "dropping %u packets bigger than the mtu "
+          "of %u bytes, consider increasing it", n_big - 1, udpsrc->mtu);
+      udpsrc->batch_extra_per_packet = TRUE;
+    }
+  }
+
+  /* all packets of a batch were received in the same wakeup, so they all get
+   * the same capture timestamp unless the socket provides one per packet */
+  dts = GST_CLOCK_TIME_NONE;
+  if (gst_base_src_get_do_timestamp (bsrc)) {
+    GstClock *clock;
+
+    clock = gst_element_get_clock (GST_ELEMENT_CAST (udpsrc));
+    if (clock != NULL) {
+      dts = gst_clock_get_time (clock) -
+          gst_element_get_base_time (GST_ELEMENT_CAST (udpsrc));
+      gst_object_unref (clock);
+    }
+  }
+
+  list = gst_buffer_list_new_sized (n_received);
+  skip_error = FALSE;
+
+  for (i = 0; i < n_received; i++) {
+    GInputMessage *msg = &udpsrc->batch_msgs[i];
+    GstBuffer *outbuf = udpsrc->batch_bufs[i];
+    GSocketAddress *saddr = udpsrc->batch_saddrs[i];
+    gboolean skip_packet = FALSE;
+    guint segment_size = 0;
+    gsize offset, last_size;
+
+    udpsrc->batch_saddrs[i] = NULL;
+
+    /* Drop the packet if multicast and the destination address is not ours */
+    if (msg->control_messages) {
+      GSocketControlMessage **msgs = udpsrc->batch_cmsgs[i];
+      guint j, n_msgs = udpsrc->batch_n_cmsgs[i];
+
+      skip_packet =
+          gst_udpsrc_process_control_messages (udpsrc, outbuf, msgs, n_msgs,
+          &segment_size);
+
+      for (j = 0; j < n_msgs; j++)
+        g_object_unref (msgs[j]);
+      g_free (msgs);
+      udpsrc->batch_cmsgs[i] = NULL;
+      udpsrc->batch_n_cmsgs[i] = 0;
+    }
+
+    if (skip_packet) {
+      GST_DEBUG_OBJECT (udpsrc,
+          "Dropping packet for a different multicast address");
+      /* keep the buffer around for the next batch */
+      GST_BUFFER_DTS (outbuf) = GST_CLOCK_TIME_NONE;
+      g_clear_object (&saddr);
+      continue;
+    }
+
+    if (!per_packet && msg->bytes_received > udpsrc->mtu && i != last_big) {
+      GST_BUFFER_DTS (outbuf) = GST_CLOCK_TIME_NONE;
+      g_clear_object (&saddr);
+      continue;
+    }
+
+    /* with GRO the kernel may have coalesced several datagrams, all of
+     * segment_size bytes except for the last one */
+    if (segment_size == 0 || segment_size >= msg->bytes_received)
+      segment_size = msg->bytes_received;
+    last_size = msg->bytes_received % segment_size;
+    if (last_size == 0)
+      last_size = segment_size;
+
+    offset = udpsrc->skip_first_bytes;
+    if (G_UNLIKELY (offset > 0 && last_size < offset)) {
+      /* still go over the other packets to release their resources */
+      skip_error = TRUE;
+      GST_BUFFER_DTS (outbuf) = GST_CLOCK_TIME_NONE;
+      g_clear_object (&saddr);
+      continue;
+    }
+
+    udpsrc->batch_bufs[i] = NULL;
+
+    /* If this is the case, the buffer will be freed once unreffed,
+     * and the buffer pool will have to reallocate a new one.
+     */
+    if (msg->bytes_received > udpsrc->mtu) {
+      if (per_packet) {
+        gst_buffer_append_memory (outbuf, udpsrc->batch_extra_mems[i]);
+        udpsrc->batch_extra_mems[i] = NULL;
+      } else {
+        gst_buffer_append_memory (outbuf, udpsrc->batch_extra_mem);
+        udpsrc->batch_extra_mem = NULL;
+      }
+    }
+
+    /* use buffer metadata so receivers can also track the address */
+    if (saddr) {
+      gst_buffer_add_net_address_meta (outbuf, saddr);
+      g_object_unref (saddr);
+    }
+
+    if (!GST_BUFFER_DTS_IS_VALID (outbuf))
+      GST_BUFFER_DTS (outbuf) = dts;
+    if (!GST_BUFFER_PTS_IS_VALID (outbuf))
+      GST_BUFFER_PTS (outbuf) = GST_BUFFER_DTS (outbuf);
+
+    if (segment_size < msg->bytes_received) {
+      gsize pos;
+
+      GST_LOG_OBJECT (udpsrc, "splitting %" G_GSIZE_FORMAT " bytes into "
+          "datagrams of %u bytes", msg->bytes_received, segment_size);
+
+      /* The sub-buffers share the memory of outbuf, which means it won't be
+       * writable anymore and gets discarded instead of being reused when it
+       * is released to the pool */
+      for (pos = 0; pos < msg->bytes_received; pos += segment_size) {
+        gsize size = MIN (segment_size, msg->bytes_received - pos);
+
+        gst_buffer_list_add (list, gst_buffer_copy_region (outbuf,
+                GST_BUFFER_COPY_ALL, pos + offset, size - offset));
+      }
+      gst_buffer_unref (outbuf);
+    } else {
+      gst_buffer_resize (outbuf, offset, msg->bytes_received - offset);
+      gst_buffer_list_add (list, outbuf);
+    }
+  }
+
+  if (G_UNLIKELY (skip_error)) {
+    gst_buffer_list_unref (list);
+    goto skip_error;
+  }
+
+  if (gst_buffer_list_length (list) == 0) {
+    gst_buffer_list_unref (list);
+    goto retry;
+  }
+
+  GST_LOG_OBJECT (udpsrc, "read %u packets out of %u",
+      gst_buffer_list_length (list), n_received);
+
+  gst_object_unref (pool);
+
+  gst_base_src_submit_buffer_list (bsrc, list);
+
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+no_pool:
+  {
+    GST_ELEMENT_ERROR (udpsrc, RESOURCE, READ, (NULL),
+        ("No buffer pool to receive packets into"));
+    return GST_FLOW_ERROR;
+  }
+acquire_failed:
+  {
+    gst_udpsrc_unmap_batch (udpsrc, n_mapped);
+    gst_object_unref (pool);
+    GST_DEBUG_OBJECT (udpsrc, "failed to acquire buffer: %s",
+        gst_flow_get_name (ret));
+    return ret;
+  }
+map_error:
+  {
+    gst_udpsrc_unmap_batch (udpsrc, n_mapped);
+    gst_object_unref (pool);
+    GST_ELEMENT_ERROR (udpsrc, RESOURCE, READ, (NULL),
+        ("Failed to map memory"));
+    return GST_FLOW_ERROR;
+  }
+wait_failed:
+  {
+    gst_udpsrc_unmap_batch (udpsrc, n_mapped);
+    gst_object_unref (pool);
+    return ret;
+  }
+receive_error:
+  {
+    gst_object_unref (pool);
+    if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_BUSY) ||
+        g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      g_clear_error (&err);
+      return GST_FLOW_FLUSHING;
+    } else {
+      GST_ELEMENT_ERROR (udpsrc, RESOURCE, READ, (NULL),
+          ("receive error %d: %s", res, err->message));
+      g_clear_error (&err);
+      return GST_FLOW_ERROR;
+    }
+  }
+skip_error:
+  {
+    gst_object_unref (pool);
+    GST_ELEMENT_ERROR (udpsrc, STREAM, DECODE, (NULL),
+        ("UDP buffer to small to skip header"));
+    return GST_FLOW_ERROR;
+  }
+}
+
+static GstFlowReturn
+gst_udpsrc_create (GstPushSrc * psrc, GstBuffer ** buf)
+{
+  GstUDPSrc *udpsrc = GST_UDPSRC_CAST (psrc);
+  GstBaseSrc *bsrc = GST_BASE_SRC_CAST (psrc);
+  GstBuffer *outbuf;
+  GstFlowReturn ret;
+  guint batch_size;
+
+  batch_size = udpsrc->batch_size;
+#ifndef MSG_DONTWAIT
+  /* we can't stop the receive call from blocking until the batch is full */
+  batch_size = 1;
+#endif
+
+  /* with GRO a single receive can result in multiple buffers */
+  if ((batch_size > 1 || udpsrc->use_gro) && *buf == NULL)
+    return gst_udpsrc_fill_list (udpsrc, batch_size);
+
+  /* one packet per buffer, as the default GstBaseSrc::create does */
+  outbuf = *buf;
+  if (outbuf == NULL) {
+    ret = GST_BASE_SRC_GET_CLASS (bsrc)->alloc (bsrc, -1,
+        gst_base_src_get_blocksize (bsrc), &outbuf);
+    if (G_UNLIKELY (ret != GST_FLOW_OK))
+      return ret;
+  }
+
+  ret = gst_udpsrc_fill (psrc, outbuf);
+  if (G_UNLIKELY (ret != GST_FLOW_OK)) {
+    if (*buf == NULL)
+      gst_buffer_unref (outbuf);
+    return ret;
+  }
+
+  *buf = outbuf;
+
+  return GST_FLOW_OK;
+}
+
 static gboolean
 gst_udpsrc_set_uri (GstUDPSrc * src, const gchar * uri, GError ** error)
 {
@@ -1374,6 +2048,12 @@ gst_udpsrc_set_property (GObject * object, guint prop_id, const GValue * value,
     case PROP_SOCKET_TIMESTAMP:
       udpsrc->socket_timestamp_mode = g_value_get_enum (value);
       break;
+    case PROP_BATCH_SIZE:
+      udpsrc->batch_size = g_value_get_uint (value);
+      break;
+    case PROP_GRO:
+      udpsrc->gro = g_value_get_boolean (value);
+      break;
     default:
       break;
   }
@@ -1440,6 +2120,12 @@ gst_udpsrc_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_SOCKET_TIMESTAMP:
       g_value_set_enum (value, udpsrc->socket_timestamp_mode);
       break;
+    case PROP_BATCH_SIZE:
+      g_value_set_uint (value, udpsrc->batch_size);
+      break;
+    case PROP_GRO:
+      g_value_set_boolean (value, udpsrc->gro);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1753,6 +2439,22 @@ gst_udpsrc_open (GstUDPSrc * src)
   }
 #endif
 
+  src->use_gro = FALSE;
+  if (src->gro) {
+#ifdef UDP_GRO
+    if (!g_socket_set_option (src->used_socket, IPPROTO_UDP, UDP_GRO, TRUE,
+            &err)) {
+      GST_WARNING_OBJECT (src, "Failed to enable UDP GRO: %s", err->message);
+      g_clear_error (&err);
+    } else {
+      GST_LOG_OBJECT (src, "UDP GRO enabled");
+      src->use_gro = TRUE;
+    }
+#else
+    GST_WARNING_OBJECT (src, "gro was requested but UDP_GRO is not defined");
+#endif
+  }
+
   /* NOTE: sockaddr_in.sin_port works for ipv4 and ipv6 because sin_port
    * follows ss_family on both */
   {
@@ -1929,6 +2631,10 @@ gst_udpsrc_change_state (GstElement * element, GstStateChange transition)
     goto failure;
 
   switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* give the buffers we acquired in advance back to the pool */
+      gst_udpsrc_free_batch (src);
+      break;
     case GST_STATE_CHANGE_READY_TO_NULL:
       gst_udpsrc_close (src);
       break;
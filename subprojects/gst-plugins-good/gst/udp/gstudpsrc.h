@@ -83,6 +83,7 @@ struct _GstUDPSrc {
   gboolean   reuse;
   gboolean   loop;
   GstSocketTimestampMode socket_timestamp_mode;
+  gboolean   gro;
 
   /* stats */
   guint      max_size;
@@ -90,12 +91,32 @@ struct _GstUDPSrc {
   gboolean   external_socket;
   gboolean   made_cancel_fd;
 
+  /* UDP_GRO could be enabled on the socket */
+  gboolean   use_gro;
+
   /* Initial size of buffers in the buffer pool */
   guint mtu;
 
   /* Extra memory for buffers with a size superior to max_packet_size */
   GstMemory *extra_mem;
 
+  /* batched receive, pre-allocated scrap space for up to n_batch packets */
+  guint      batch_size;
+  guint      n_batch;
+  GInputMessage *batch_msgs;
+  GInputVector *batch_vecs;
+  GstMapInfo *batch_maps;
+  GstBuffer **batch_bufs;
+  GstMemory **batch_extra_mems;
+  /* extra memory shared by all packets of a batch, until a batch had more
+   * than one packet bigger than the mtu */
+  GstMemory *batch_extra_mem;
+  GstMapInfo batch_extra_map;
+  gboolean   batch_extra_per_packet;
+  GSocketAddress **batch_saddrs;
+  GSocketControlMessage ***batch_cmsgs;
+  guint     *batch_n_cmsgs;
+
   gchar     *uri;
 };
 
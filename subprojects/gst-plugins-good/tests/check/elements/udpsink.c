@@ -22,6 +22,16 @@
 #include <gio/gio.h>
 #include <stdlib.h>
 
+#ifdef __linux__
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <string.h>
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#endif
+
 static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
@@ -239,6 +249,174 @@ GST_START_TEST (test_udpsink_dscp)
 
 GST_END_TEST;
 
+GST_START_TEST (test_udpsink_gso)
+{
+  static const gsize sizes[] = { 1000, 1000, 1000, 1000, 500 };
+  GstElement *udpsink;
+  GstPad *srcpad;
+  GstSegment segment;
+  GstBufferList *list;
+  GSocket *socket;
+  GSocketAddress *sa, *bound_sa;
+  GInetAddress *ia;
+  GError *err = NULL;
+  gchar data[2000];
+  guint16 port;
+  guint i;
+
+  /* receiving side, bound to a free port on the loopback interface */
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, &err);
+  fail_unless (socket != NULL && err == NULL);
+  ia = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  sa = g_inet_socket_address_new (ia, 0);
+  fail_unless (g_socket_bind (socket, sa, TRUE, &err));
+  bound_sa = g_socket_get_local_address (socket, &err);
+  fail_unless (bound_sa != NULL);
+  port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (bound_sa));
+  g_socket_set_timeout (socket, 5);
+
+  udpsink = gst_check_setup_element ("udpsink");
+  g_object_set (udpsink, "host", "127.0.0.1", "port", port, "gso", TRUE, NULL);
+  srcpad = gst_check_setup_src_pad_by_name (udpsink, &srctemplate, "sink");
+
+  gst_element_set_state (udpsink, GST_STATE_PLAYING);
+  gst_pad_set_active (srcpad, TRUE);
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("gso"));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  /* a run of equally sized packets and a smaller one at the end, which can
+   * all be sent with a single segmentation offload message */
+  list = gst_buffer_list_new ();
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+    GstBuffer *buf = gst_buffer_new_allocate (NULL, sizes[i], NULL);
+
+    gst_buffer_memset (buf, 0, i, sizes[i]);
+    gst_buffer_list_add (list, buf);
+  }
+  fail_unless_equals_int (gst_pad_push_list (srcpad, list), GST_FLOW_OK);
+
+  /* no matter if GSO is supported, the receiver sees separate datagrams */
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+    gssize received;
+
+    received = g_socket_receive (socket, data, sizeof (data), NULL, &err);
+    fail_unless (err == NULL);
+    fail_unless_equals_int (received, sizes[i]);
+    fail_unless_equals_int (data[0], i);
+    fail_unless_equals_int (data[received - 1], i);
+  }
+
+  gst_check_teardown_pad_by_name (udpsink, "sink");
+  gst_check_teardown_element (udpsink);
+
+  g_object_unref (bound_sa);
+  g_object_unref (sa);
+  g_object_unref (ia);
+  g_object_unref (socket);
+}
+
+GST_END_TEST;
+
+#ifdef __linux__
+/* with GRO enabled on the receiving socket, the kernel hands out datagrams
+ * sent with a single UDP_SEGMENT message in one piece again, so this shows
+ * whether udpsink actually merged them */
+GST_START_TEST (test_udpsink_gso_segments)
+{
+  static const gsize sizes[] = { 1000, 1000, 1000, 1000, 500 };
+  GstElement *udpsink;
+  GstPad *srcpad;
+  GstSegment segment;
+  GstBufferList *list;
+  GSocket *socket;
+  GSocketAddress *sa, *bound_sa;
+  GInetAddress *ia;
+  GError *err = NULL;
+  guint8 data[8000];
+  gchar control[CMSG_SPACE (sizeof (gint))];
+  struct iovec iov = { data, sizeof (data) };
+  struct msghdr msg = { 0, };
+  struct cmsghdr *cmsg;
+  gint segment_size = 0;
+  gssize received;
+  guint16 port;
+  guint i;
+  gsize pos;
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, &err);
+  fail_unless (socket != NULL && err == NULL);
+  if (!g_socket_set_option (socket, IPPROTO_UDP, UDP_GRO, 1, &err)) {
+    GST_INFO ("UDP GRO not supported, skipping test: %s", err->message);
+    g_clear_error (&err);
+    g_object_unref (socket);
+    return;
+  }
+  ia = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  sa = g_inet_socket_address_new (ia, 0);
+  fail_unless (g_socket_bind (socket, sa, TRUE, &err));
+  bound_sa = g_socket_get_local_address (socket, &err);
+  fail_unless (bound_sa != NULL);
+  port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (bound_sa));
+  g_socket_set_timeout (socket, 5);
+
+  udpsink = gst_check_setup_element ("udpsink");
+  g_object_set (udpsink, "host", "127.0.0.1", "port", port, "gso", TRUE, NULL);
+  srcpad = gst_check_setup_src_pad_by_name (udpsink, &srctemplate, "sink");
+
+  gst_element_set_state (udpsink, GST_STATE_PLAYING);
+  gst_pad_set_active (srcpad, TRUE);
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("gso"));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+    GstBuffer *buf = gst_buffer_new_allocate (NULL, sizes[i], NULL);
+
+    gst_buffer_memset (buf, 0, i, sizes[i]);
+    gst_buffer_list_add (list, buf);
+  }
+  fail_unless_equals_int (gst_pad_push_list (srcpad, list), GST_FLOW_OK);
+
+  fail_unless (g_socket_condition_timed_wait (socket, G_IO_IN,
+          5 * G_USEC_PER_SEC, NULL, NULL));
+
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof (control);
+  received = recvmsg (g_socket_get_fd (socket), &msg, 0);
+
+  /* one message with all packets and their segment size */
+  fail_unless_equals_int (received, 4500);
+  for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+    if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO)
+      memcpy (&segment_size, CMSG_DATA (cmsg), sizeof (segment_size));
+  }
+  fail_unless_equals_int (segment_size, 1000);
+
+  for (i = 0, pos = 0; i < G_N_ELEMENTS (sizes); pos += sizes[i], i++) {
+    fail_unless_equals_int (data[pos], i);
+    fail_unless_equals_int (data[pos + sizes[i] - 1], i);
+  }
+
+  gst_check_teardown_pad_by_name (udpsink, "sink");
+  gst_check_teardown_element (udpsink);
+
+  g_object_unref (bound_sa);
+  g_object_unref (sa);
+  g_object_unref (ia);
+  g_object_unref (socket);
+}
+
+GST_END_TEST;
+#endif
+
 static Suite *
 udpsink_suite (void)
 {
@@ -251,6 +429,10 @@ udpsink_suite (void)
   tcase_add_test (tc_chain, test_udpsink_bufferlist);
   tcase_add_test (tc_chain, test_udpsink_client_add_remove);
   tcase_add_test (tc_chain, test_udpsink_dscp);
+  tcase_add_test (tc_chain, test_udpsink_gso);
+#ifdef __linux__
+  tcase_add_test (tc_chain, test_udpsink_gso_segments);
+#endif
 
   return s;
 }
@@ -19,6 +19,19 @@
 #include <gst/check/gstcheck.h>
 #include <gio/gio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#endif
 
 static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
@@ -26,8 +39,9 @@ static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_STATIC_CAPS_ANY);
 
 static gboolean
-udpsrc_setup (GstElement ** udpsrc, GSocket ** socket,
-    GstPad ** sinkpad, GSocketAddress ** sa)
+udpsrc_setup_full (GstElement ** udpsrc, GSocket ** socket,
+    GstPad ** sinkpad, GSocketAddress ** sa, guint batch_size, gboolean gro,
+    GstState state)
 {
   GInetAddress *ia;
   int port = 0;
@@ -35,13 +49,14 @@ udpsrc_setup (GstElement ** udpsrc, GSocket ** socket,
 
   *udpsrc = gst_check_setup_element ("udpsrc");
   fail_unless (*udpsrc != NULL);
-  g_object_set (*udpsrc, "port", 0, NULL);
+  g_object_set (*udpsrc, "port", 0, "batch-size", batch_size, "gro", gro,
+      NULL);
 
   *sinkpad = gst_check_setup_sink_pad_by_name (*udpsrc, &sinktemplate, "src");
   fail_unless (*sinkpad != NULL);
   gst_pad_set_active (*sinkpad, TRUE);
 
-  gst_element_set_state (*udpsrc, GST_STATE_PLAYING);
+  gst_element_set_state (*udpsrc, state);
   g_object_get (*udpsrc, "port", &port, NULL);
   GST_INFO ("udpsrc port = %d", port);
 
@@ -63,6 +78,14 @@ udpsrc_setup (GstElement ** udpsrc, GSocket ** socket,
   return TRUE;
 }
 
+static gboolean
+udpsrc_setup (GstElement ** udpsrc, GSocket ** socket,
+    GstPad ** sinkpad, GSocketAddress ** sa, guint batch_size)
+{
+  return udpsrc_setup_full (udpsrc, socket, sinkpad, sa, batch_size, FALSE,
+      GST_STATE_PLAYING);
+}
+
 GST_START_TEST (test_udpsrc_empty_packet)
 {
   GSocketAddress *sa = NULL;
@@ -70,7 +93,7 @@ GST_START_TEST (test_udpsrc_empty_packet)
   GSocket *socket = NULL;
   GstPad *sinkpad = NULL;
 
-  if (!udpsrc_setup (&udpsrc, &socket, &sinkpad, &sa))
+  if (!udpsrc_setup (&udpsrc, &socket, &sinkpad, &sa, 1))
     goto no_socket;
 
   if (g_socket_send_to (socket, sa, "HeLL0", 0, NULL, NULL) == 0) {
@@ -135,12 +158,14 @@ no_socket:
 
 GST_END_TEST;
 
-GST_START_TEST (test_udpsrc)
+static void
+check_udpsrc_packets (guint batch_size)
 {
   GSocketAddress *sa = NULL;
   GstElement *udpsrc = NULL;
   GSocket *socket = NULL;
   GstPad *sinkpad = NULL;
+  static const gsize sizes[] = { 48000, 21000, 500, 1600, 1400 };
   GstBuffer *buf;
   GstMemory *mem;
   gchar data[48000];
@@ -152,38 +177,30 @@ GST_START_TEST (test_udpsrc)
   for (i = 0; i < G_N_ELEMENTS (data); ++i)
     data[i] = i & 0xff;
 
-  if (!udpsrc_setup (&udpsrc, &socket, &sinkpad, &sa))
+  if (!udpsrc_setup (&udpsrc, &socket, &sinkpad, &sa, batch_size))
     goto no_socket;
 
-  if ((sent = g_socket_send_to (socket, sa, data, 48000, NULL, &err)) == -1)
-    goto send_failure;
-  fail_unless_equals_int (sent, 48000);
-
-  if ((sent = g_socket_send_to (socket, sa, data, 21000, NULL, &err)) == -1)
-    goto send_failure;
-  fail_unless_equals_int (sent, 21000);
+  /* every packet is received before the next one is sent, batches sharing
+   * the memory for packets bigger than the mtu are tested separately */
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+    if ((sent = g_socket_send_to (socket, sa, data, sizes[i], NULL,
+                &err)) == -1)
+      goto send_failure;
+    fail_unless_equals_int (sent, sizes[i]);
 
-  if ((sent = g_socket_send_to (socket, sa, data, 500, NULL, &err)) == -1)
-    goto send_failure;
-  fail_unless_equals_int (sent, 500);
-
-  if ((sent = g_socket_send_to (socket, sa, data, 1600, NULL, &err)) == -1)
-    goto send_failure;
-  fail_unless_equals_int (sent, 1600);
-
-  if ((sent = g_socket_send_to (socket, sa, data, 1400, NULL, &err)) == -1)
-    goto send_failure;
-  fail_unless_equals_int (sent, 1400);
+    g_mutex_lock (&check_mutex);
+    len = g_list_length (buffers);
+    while (len < i + 1) {
+      g_cond_wait (&check_cond, &check_mutex);
+      len = g_list_length (buffers);
+      GST_INFO ("%u buffers", len);
+    }
+    g_mutex_unlock (&check_mutex);
+  }
 
   GST_INFO ("sent some packets");
 
   g_mutex_lock (&check_mutex);
-  len = g_list_length (buffers);
-  while (len < 5) {
-    g_cond_wait (&check_cond, &check_mutex);
-    len = g_list_length (buffers);
-    GST_INFO ("%u buffers", len);
-  }
 
   /* check that large packets are made up of multiple memory chunks and that
    * the first one is fairly small */
@@ -245,7 +262,339 @@ send_failure:
   g_object_unref (sa);
 }
 
+GST_START_TEST (test_udpsrc)
+{
+  check_udpsrc_packets (1);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_udpsrc_batch)
+{
+  /* packets are read in batches and pushed as buffer lists, which the check
+   * sink pad receives as individual buffers again */
+  check_udpsrc_packets (4);
+}
+
+GST_END_TEST;
+
+static GstPadProbeReturn
+list_length_probe (GstPad * pad, GstPadProbeInfo * info, GArray * lengths)
+{
+  guint len = gst_buffer_list_length (GST_PAD_PROBE_INFO_BUFFER_LIST (info));
+
+  g_mutex_lock (&check_mutex);
+  g_array_append_val (lengths, len);
+  g_mutex_unlock (&check_mutex);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+wait_for_buffers (guint n_buffers)
+{
+  g_mutex_lock (&check_mutex);
+  while (g_list_length (buffers) < n_buffers)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+}
+
+/* Queues packets of @sizes on the socket while udpsrc is paused, so they are
+ * all read with the first receive call once it is set to PLAYING */
+static gboolean
+send_queued_packets (GstElement * udpsrc, GSocket * socket,
+    GSocketAddress * sa, const gsize * sizes, guint n_packets)
+{
+  static gchar data[48000];
+  GError *err = NULL;
+  guint i;
+
+  for (i = 0; i < n_packets; i++) {
+    memset (data, i & 0xff, sizes[i]);
+    if (g_socket_send_to (socket, sa, data, sizes[i], NULL, &err) !=
+        (gssize) sizes[i]) {
+      GST_WARNING ("Socket send error, skipping test: %s",
+          err ? err->message : "short write");
+      g_clear_error (&err);
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+static void
+check_buffer_sizes (const gsize * sizes, guint n_packets, guint first)
+{
+  guint i;
+
+  g_mutex_lock (&check_mutex);
+  fail_unless_equals_int (g_list_length (buffers), first + n_packets);
+  for (i = 0; i < n_packets; i++) {
+    GstBuffer *buf = g_list_nth_data (buffers, first + i);
+
+    fail_unless_equals_int (gst_buffer_get_size (buf), sizes[i]);
+  }
+  g_mutex_unlock (&check_mutex);
+}
+
+static void
+udpsrc_teardown (GstElement * udpsrc, GSocket * socket, GSocketAddress * sa)
+{
+  gst_element_set_state (udpsrc, GST_STATE_NULL);
+
+  gst_check_drop_buffers ();
+  gst_check_teardown_pad_by_name (udpsrc, "src");
+  gst_check_teardown_element (udpsrc);
+
+  g_clear_object (&socket);
+  g_clear_object (&sa);
+}
+
+/* batches that are only partially filled are pushed right away, and the
+ * buffers of the unused slots are used for the next batch */
+GST_START_TEST (test_udpsrc_batch_partial)
+{
+  static const gsize first[] = { 100, 200, 300 };
+  static const gsize second[] = { 400, 500, 600, 700, 800 };
+  GSocketAddress *sa = NULL;
+  GstElement *udpsrc = NULL;
+  GSocket *socket = NULL;
+  GstPad *sinkpad = NULL, *srcpad;
+  GArray *lengths = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  if (!udpsrc_setup_full (&udpsrc, &socket, &sinkpad, &sa, 8,
+          FALSE, GST_STATE_PAUSED))
+    goto done;
+
+  srcpad = gst_element_get_static_pad (udpsrc, "src");
+  gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      (GstPadProbeCallback) list_length_probe, lengths, NULL);
+  gst_object_unref (srcpad);
+
+  if (!send_queued_packets (udpsrc, socket, sa, first, G_N_ELEMENTS (first)))
+    goto done;
+  gst_element_set_state (udpsrc, GST_STATE_PLAYING);
+  wait_for_buffers (G_N_ELEMENTS (first));
+  check_buffer_sizes (first, G_N_ELEMENTS (first), 0);
+
+  /* udpsrc is now waiting for the socket again, queue the second batch
+   * before it gets to read */
+  gst_element_set_state (udpsrc, GST_STATE_PAUSED);
+  if (!send_queued_packets (udpsrc, socket, sa, second,
+          G_N_ELEMENTS (second)))
+    goto done;
+  gst_element_set_state (udpsrc, GST_STATE_PLAYING);
+  wait_for_buffers (G_N_ELEMENTS (first) + G_N_ELEMENTS (second));
+  check_buffer_sizes (second, G_N_ELEMENTS (second), G_N_ELEMENTS (first));
+
+  g_mutex_lock (&check_mutex);
+  fail_unless_equals_int (lengths->len, 2);
+  fail_unless_equals_int (g_array_index (lengths, guint, 0),
+      G_N_ELEMENTS (first));
+  fail_unless_equals_int (g_array_index (lengths, guint, 1),
+      G_N_ELEMENTS (second));
+  g_mutex_unlock (&check_mutex);
+
+done:
+  udpsrc_teardown (udpsrc, socket, sa);
+  g_array_unref (lengths);
+}
+
+GST_END_TEST;
+
+/* the biggest batch size reads everything queued on the socket at once */
+GST_START_TEST (test_udpsrc_batch_large)
+{
+#define N_LARGE_BATCH_PACKETS 100
+  gsize sizes[N_LARGE_BATCH_PACKETS];
+  GSocketAddress *sa = NULL;
+  GstElement *udpsrc = NULL;
+  GSocket *socket = NULL;
+  GstPad *sinkpad = NULL, *srcpad;
+  GArray *lengths = g_array_new (FALSE, FALSE, sizeof (guint));
+  guint i;
+
+  /* small enough to fit into the default socket receive buffer */
+  for (i = 0; i < N_LARGE_BATCH_PACKETS; i++)
+    sizes[i] = 16 + i;
+
+  if (!udpsrc_setup_full (&udpsrc, &socket, &sinkpad, &sa, 1024,
+          FALSE, GST_STATE_PAUSED))
+    goto done;
+
+  srcpad = gst_element_get_static_pad (udpsrc, "src");
+  gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      (GstPadProbeCallback) list_length_probe, lengths, NULL);
+  gst_object_unref (srcpad);
+
+  if (!send_queued_packets (udpsrc, socket, sa, sizes, N_LARGE_BATCH_PACKETS))
+    goto done;
+  gst_element_set_state (udpsrc, GST_STATE_PLAYING);
+  wait_for_buffers (N_LARGE_BATCH_PACKETS);
+  check_buffer_sizes (sizes, N_LARGE_BATCH_PACKETS, 0);
+
+  g_mutex_lock (&check_mutex);
+  fail_unless_equals_int (lengths->len, 1);
+  fail_unless_equals_int (g_array_index (lengths, guint, 0),
+      N_LARGE_BATCH_PACKETS);
+  g_mutex_unlock (&check_mutex);
+
+done:
+  udpsrc_teardown (udpsrc, socket, sa);
+  g_array_unref (lengths);
+}
+
+GST_END_TEST;
+
+/* all packets of a batch share the memory for data beyond the mtu */
+GST_START_TEST (test_udpsrc_batch_big_packets)
+{
+  static const gsize one_big[] = { 100, 40000, 200 };
+  static const gsize two_big[] = { 100, 40000, 200, 30000 };
+  static const gsize two_big_received[] = { 100, 200, 30000 };
+  GSocketAddress *sa = NULL;
+  GstElement *udpsrc = NULL;
+  GSocket *socket = NULL;
+  GstPad *sinkpad = NULL;
+  GstBuffer *buf;
+
+  if (!udpsrc_setup_full (&udpsrc, &socket, &sinkpad, &sa, 8,
+          FALSE, GST_STATE_PAUSED))
+    goto done;
+
+  /* a single big packet per batch gets the shared memory */
+  if (!send_queued_packets (udpsrc, socket, sa, one_big,
+          G_N_ELEMENTS (one_big)))
+    goto done;
+  gst_element_set_state (udpsrc, GST_STATE_PLAYING);
+  wait_for_buffers (G_N_ELEMENTS (one_big));
+  check_buffer_sizes (one_big, G_N_ELEMENTS (one_big), 0);
+  buf = g_list_nth_data (buffers, 1);
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 2);
+  fail_unless (gst_buffer_memcmp (buf, 39999, "\1", 1) == 0);
+
+  /* with two of them, only the last one of the batch survives */
+  gst_element_set_state (udpsrc, GST_STATE_PAUSED);
+  if (!send_queued_packets (udpsrc, socket, sa, two_big,
+          G_N_ELEMENTS (two_big)))
+    goto done;
+  gst_element_set_state (udpsrc, GST_STATE_PLAYING);
+  wait_for_buffers (G_N_ELEMENTS (one_big) + G_N_ELEMENTS (two_big_received));
+  check_buffer_sizes (two_big_received, G_N_ELEMENTS (two_big_received),
+      G_N_ELEMENTS (one_big));
+  buf = g_list_nth_data (buffers, 5);
+  fail_unless (gst_buffer_memcmp (buf, 29999, "\3", 1) == 0);
+
+  /* and every packet gets its own memory from then on */
+  gst_element_set_state (udpsrc, GST_STATE_PAUSED);
+  if (!send_queued_packets (udpsrc, socket, sa, two_big,
+          G_N_ELEMENTS (two_big)))
+    goto done;
+  gst_element_set_state (udpsrc, GST_STATE_PLAYING);
+  wait_for_buffers (G_N_ELEMENTS (one_big) + G_N_ELEMENTS (two_big_received) +
+      G_N_ELEMENTS (two_big));
+  check_buffer_sizes (two_big, G_N_ELEMENTS (two_big),
+      G_N_ELEMENTS (one_big) + G_N_ELEMENTS (two_big_received));
+
+done:
+  udpsrc_teardown (udpsrc, socket, sa);
+}
+
+GST_END_TEST;
+
+#ifdef __linux__
+/* Datagrams sent with a single UDP_SEGMENT message reach a GRO socket in one
+ * piece, udpsrc has to split them again */
+GST_START_TEST (test_udpsrc_gro)
+{
+  static const gsize sizes[] = { 1000, 1000, 1000, 1000, 500 };
+  GSocketAddress *sa = NULL;
+  GstElement *udpsrc = NULL;
+  GSocket *socket = NULL, *probe_socket;
+  GstPad *sinkpad = NULL, *srcpad;
+  GArray *lengths = g_array_new (FALSE, FALSE, sizeof (guint));
+  GError *err = NULL;
+  struct sockaddr_storage native_sa;
+  guint8 data[4500];
+  gchar control[CMSG_SPACE (sizeof (guint16))] = { 0, };
+  struct iovec iov = { data, sizeof (data) };
+  struct msghdr msg = { 0, };
+  struct cmsghdr *cmsg;
+  guint16 segment_size = 1000;
+  gsize pos;
+  guint i;
+
+  probe_socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, NULL);
+  if (probe_socket == NULL
+      || !g_socket_set_option (probe_socket, IPPROTO_UDP, UDP_GRO, 1, &err)) {
+    GST_INFO ("UDP GRO not supported, skipping test");
+    g_clear_error (&err);
+    g_clear_object (&probe_socket);
+    g_array_unref (lengths);
+    return;
+  }
+  g_object_unref (probe_socket);
+
+  if (!udpsrc_setup_full (&udpsrc, &socket, &sinkpad, &sa, 1, TRUE,
+          GST_STATE_PLAYING))
+    goto done;
+
+  srcpad = gst_element_get_static_pad (udpsrc, "src");
+  gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      (GstPadProbeCallback) list_length_probe, lengths, NULL);
+  gst_object_unref (srcpad);
+
+  for (i = 0, pos = 0; i < G_N_ELEMENTS (sizes); pos += sizes[i], i++)
+    memset (data + pos, i, sizes[i]);
+
+  fail_unless (g_socket_address_to_native (sa, &native_sa,
+          sizeof (native_sa), NULL));
+  msg.msg_name = &native_sa;
+  msg.msg_namelen = g_socket_address_get_native_size (sa);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof (control);
+  cmsg = CMSG_FIRSTHDR (&msg);
+  cmsg->cmsg_level = IPPROTO_UDP;
+  cmsg->cmsg_type = UDP_SEGMENT;
+  cmsg->cmsg_len = CMSG_LEN (sizeof (segment_size));
+  memcpy (CMSG_DATA (cmsg), &segment_size, sizeof (segment_size));
+
+  if (sendmsg (g_socket_get_fd (socket), &msg, 0) != sizeof (data)) {
+    GST_INFO ("UDP GSO not supported, skipping test");
+    goto done;
+  }
+
+  wait_for_buffers (G_N_ELEMENTS (sizes));
+  check_buffer_sizes (sizes, G_N_ELEMENTS (sizes), 0);
+
+  g_mutex_lock (&check_mutex);
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+    GstBuffer *buf = g_list_nth_data (buffers, i);
+    guint8 first, last;
+
+    gst_buffer_extract (buf, 0, &first, 1);
+    gst_buffer_extract (buf, sizes[i] - 1, &last, 1);
+    fail_unless_equals_int (first, i);
+    fail_unless_equals_int (last, i);
+  }
+
+  /* received with a single read and split into a list */
+  fail_unless_equals_int (lengths->len, 1);
+  fail_unless_equals_int (g_array_index (lengths, guint, 0),
+      G_N_ELEMENTS (sizes));
+  g_mutex_unlock (&check_mutex);
+
+done:
+  udpsrc_teardown (udpsrc, socket, sa);
+  g_array_unref (lengths);
+}
+
 GST_END_TEST;
+#endif
 
 static Suite *
 udpsrc_suite (void)
@@ -256,6 +605,13 @@ udpsrc_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_udpsrc_empty_packet);
   tcase_add_test (tc_chain, test_udpsrc);
+  tcase_add_test (tc_chain, test_udpsrc_batch);
+  tcase_add_test (tc_chain, test_udpsrc_batch_partial);
+  tcase_add_test (tc_chain, test_udpsrc_batch_large);
+  tcase_add_test (tc_chain, test_udpsrc_batch_big_packets);
+#ifdef __linux__
+  tcase_add_test (tc_chain, test_udpsrc_gro);
+#endif
   return s;
 }
 
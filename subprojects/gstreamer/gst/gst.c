@@ -666,6 +666,7 @@ init_post (GOptionContext * context, GOptionGroup * group, gpointer data,
   }
 
   _priv_gst_mini_object_initialize ();
+  _priv_gst_slice_cache_initialize ();
   _priv_gst_quarks_initialize ();
   _priv_gst_allocator_initialize ();
   _priv_gst_memory_initialize ();
@@ -1135,17 +1136,20 @@ gst_deinit (void)
 
   _priv_gst_registry_cleanup ();
   _priv_gst_allocator_cleanup ();
+  _priv_gst_caps_cache_cleanup ();
 
   /* We want to destroy tracers as late as possible for the leaks tracer
    * but still need to keep the caps system alive as it may have to use
    * gst_caps_to_string() to display leaked caps. */
 #ifndef GST_DISABLE_GST_DEBUG
   _priv_gst_tracing_deinit ();
+  _priv_gst_tracer_record_cleanup ();
 #endif
 
   _priv_gst_caps_features_cleanup ();
   _priv_gst_caps_cleanup ();
   _priv_gst_meta_cleanup ();
+  _priv_gst_slice_cache_cleanup ();
 
   g_type_class_unref (g_type_class_peek (gst_object_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_pad_get_type ()));
@@ -96,6 +96,8 @@ _priv_plugin_get_features(GstRegistry *registry, GstPlugin *plugin);
 typedef struct _GstMetaItem GstMetaItem;
 struct _GstMetaItem {
   GstMetaItem *next;
+  /* next item with an API in the same index bucket of the buffer */
+  GstMetaItem *next_in_bucket;
   guint64 seq_num;
   GstMeta meta;
 };
@@ -114,6 +116,7 @@ G_GNUC_INTERNAL  gboolean _priv_plugin_deps_files_changed (GstPlugin * plugin);
 
 /* init functions called from gst_init(). */
 G_GNUC_INTERNAL  void  _priv_gst_quarks_initialize (void);
+G_GNUC_INTERNAL  void  _priv_gst_slice_cache_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_mini_object_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_memory_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_allocator_initialize (void);
@@ -138,15 +141,34 @@ G_GNUC_INTERNAL  void  _priv_gst_date_time_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_plugin_feature_rank_initialize (void);
 
 /* cleanup functions called from gst_deinit(). */
+G_GNUC_INTERNAL  void  _priv_gst_slice_cache_cleanup (void);
 G_GNUC_INTERNAL  void  _priv_gst_allocator_cleanup (void);
 G_GNUC_INTERNAL  void  _priv_gst_caps_features_cleanup (void);
 G_GNUC_INTERNAL  void  _priv_gst_caps_cleanup (void);
+G_GNUC_INTERNAL  void  _priv_gst_caps_cache_cleanup (void);
 G_GNUC_INTERNAL  void  _priv_gst_debug_cleanup (void);
 G_GNUC_INTERNAL  void  _priv_gst_meta_cleanup (void);
+G_GNUC_INTERNAL  void  _priv_gst_tracer_record_cleanup (void);
 
 /* called from gst_task_cleanup_all(). */
 G_GNUC_INTERNAL  void  _priv_gst_element_cleanup (void);
 
+/* Per-thread recycling of the structures of frequently created objects */
+typedef enum {
+  GST_SLICE_CACHE_BUFFER,
+  GST_SLICE_CACHE_EVENT,
+  GST_SLICE_CACHE_MEMORY,
+  GST_SLICE_CACHE_LAST
+} GstSliceCacheId;
+
+G_GNUC_INTERNAL gpointer _priv_gst_slice_cache_alloc (GstSliceCacheId id, gsize size);
+G_GNUC_INTERNAL void _priv_gst_slice_cache_free (GstSliceCacheId id, gsize size, gpointer block);
+G_GNUC_INTERNAL GstStructure * _priv_gst_slice_cache_get_stats (void);
+
+G_GNUC_INTERNAL GstStructure * _priv_gst_caps_cache_get_stats (void);
+
+G_GNUC_INTERNAL gsize _priv_gst_meta_get_max_size (void);
+
 /* Private registry functions */
 G_GNUC_INTERNAL
 gboolean _priv_gst_registry_remove_cache_plugins (GstRegistry *registry);
@@ -208,6 +230,12 @@ gboolean		priv_gst_registry_binary_read_cache	(GstRegistry * registry, const cha
 G_GNUC_INTERNAL
 gboolean		priv_gst_registry_binary_write_cache	(GstRegistry * registry, GList * plugins, const char *location);
 
+G_GNUC_INTERNAL
+void			_priv_gst_registry_chunks_load_details	(GstPluginFeature * feature);
+
+G_GNUC_INTERNAL
+void			_priv_gst_registry_chunks_unload_details	(GstPluginFeature * feature);
+
 
 G_GNUC_INTERNAL
 void      __gst_element_factory_add_static_pad_template (GstElementFactory    * elementfactory,
@@ -425,6 +453,10 @@ struct _GstTypeFindFactory {
   gpointer                      user_data;
   GDestroyNotify                user_data_notify;
 
+  /* registry cache the caps and extensions are loaded from on first use */
+  GBytes *                      registry_cache;
+  gpointer                      registry_chunk;
+
   gpointer _gst_reserved[GST_PADDING];
 };
 
@@ -472,6 +504,10 @@ struct _GstElementFactory {
 
   GList *               interfaces;             /* interface type names this element implements */
 
+  /* registry cache the fields above are loaded from on first use */
+  GBytes *              registry_cache;
+  gpointer              registry_chunk;
+
   /*< private >*/
   gpointer _gst_reserved[GST_PADDING];
 };
@@ -482,6 +518,14 @@ struct _GstElementFactoryClass {
   gpointer _gst_reserved[GST_PADDING];
 };
 
+/* Element and typefind factories read from the registry cache only parse
+ * their details when they are first needed */
+#define GST_FACTORY_LOAD_DETAILS(factory) G_STMT_START {                 \
+  if (G_UNLIKELY (g_atomic_pointer_get (&(factory)->registry_chunk)))    \
+    _priv_gst_registry_chunks_load_details (                             \
+        GST_PLUGIN_FEATURE_CAST (factory));                              \
+} G_STMT_END
+
 struct _GstDeviceProviderFactory {
   GstPluginFeature           feature;
   /* <private> */
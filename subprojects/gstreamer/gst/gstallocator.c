@@ -410,7 +410,7 @@ _sysmem_new (GstMemoryFlags flags,
 
   slice_size = sizeof (GstMemorySystem);
 
-  mem = g_slice_alloc (slice_size);
+  mem = _priv_gst_slice_cache_alloc (GST_SLICE_CACHE_MEMORY, slice_size);
   _sysmem_init (mem, flags, parent, slice_size,
       data, maxsize, align, offset, size, user_data, notify);
 
@@ -552,7 +552,10 @@ default_free (GstAllocator * allocator, GstMemory * mem)
   memset (mem, 0xff, sizeof (GstMemorySystem));
 #endif
 
-  g_slice_free1 (slice_size, mem);
+  if (slice_size == sizeof (GstMemorySystem))
+    _priv_gst_slice_cache_free (GST_SLICE_CACHE_MEMORY, slice_size, mem);
+  else
+    g_slice_free1 (slice_size, mem);
 }
 
 static void
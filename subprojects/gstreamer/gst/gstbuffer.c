@@ -144,6 +144,21 @@ GType _gst_buffer_type = 0;
 
 #define GST_BUFFER_MEM_MAX         16
 
+/* the first few metas that fit in a slot are stored in the meta store of the
+ * buffer. The slots are sized for the largest registered meta, up to
+ * GST_BUFFER_META_SLOT_MAX_SIZE */
+#define GST_BUFFER_META_SLOTS          4
+#define GST_BUFFER_META_SLOT_MAX_SIZE  256
+/* number of buckets in the per-buffer API type index, a power of 2 */
+#define GST_BUFFER_META_INDEX_BITS 3
+#define GST_BUFFER_META_INDEX_SIZE (1 << GST_BUFFER_META_INDEX_BITS)
+
+/* Fibonacci hash of the API GType, the low bits are always zero for
+ * dynamically registered types so drop them first */
+#define META_INDEX(api) \
+    ((((guint32) ((api) >> 3)) * 2654435761u) >> \
+        (32 - GST_BUFFER_META_INDEX_BITS))
+
 #define GST_BUFFER_SLICE_SIZE(b)   (((GstBufferImpl *)(b))->slice_size)
 #define GST_BUFFER_MEM_LEN(b)      (((GstBufferImpl *)(b))->len)
 #define GST_BUFFER_MEM_ARRAY(b)    (((GstBufferImpl *)(b))->mem)
@@ -152,6 +167,26 @@ GType _gst_buffer_type = 0;
 #define GST_BUFFER_META(b)         (((GstBufferImpl *)(b))->item)
 #define GST_BUFFER_TAIL_META(b)    (((GstBufferImpl *)(b))->tail_item)
 
+/* allocated on the first gst_buffer_add_meta() and kept until the buffer is
+ * freed, so buffers that are reused from a pool only allocate it once */
+typedef struct
+{
+  /* for each bucket, the first item of the chain of items whose API hashes
+   * to it, linked with next_in_bucket in list order */
+  GstMetaItem *index[GST_BUFFER_META_INDEX_SIZE];
+
+  gsize size;
+  gsize slot_size;
+  /* bit set when the slot is taken */
+  guint slots_used;
+  /* followed by GST_BUFFER_META_SLOTS slots of slot_size bytes */
+} GstBufferMetaStore;
+
+#define META_STORE_HEADER_SIZE GST_ROUND_UP_16 (sizeof (GstBufferMetaStore))
+#define META_STORE_SLOT(s,i) \
+    ((GstMetaItem *) ((guint8 *) (s) + META_STORE_HEADER_SIZE + \
+        (i) * (s)->slot_size))
+
 typedef struct
 {
   GstBuffer buffer;
@@ -165,10 +200,10 @@ typedef struct
   /* memory of the buffer when allocated from 1 chunk */
   GstMemory *bufmem;
 
-  /* FIXME, make metadata allocation more efficient by using part of the
-   * GstBufferImpl */
   GstMetaItem *item;
   GstMetaItem *tail_item;
+
+  GstBufferMetaStore *meta_store;
 } GstBufferImpl;
 
 static gint64 meta_seq;         /* 0 *//* ATOMIC */
@@ -207,6 +242,91 @@ gst_atomic_int64_inc (gint64 * atomic)
 }
 #endif
 
+static GstBufferMetaStore *
+_meta_store_new (void)
+{
+  GstBufferMetaStore *store;
+  gsize slot_size, size;
+
+  slot_size = _priv_gst_meta_get_max_size () + sizeof (GstMetaItem) -
+      sizeof (GstMeta);
+  slot_size = MIN (GST_ROUND_UP_16 (slot_size), GST_BUFFER_META_SLOT_MAX_SIZE);
+  size = META_STORE_HEADER_SIZE + GST_BUFFER_META_SLOTS * slot_size;
+
+  store = g_slice_alloc0 (size);
+  store->size = size;
+  store->slot_size = slot_size;
+
+  return store;
+}
+
+static GstMetaItem *
+_meta_item_alloc (GstBuffer * buffer, gsize size, gboolean zero)
+{
+  GstBufferImpl *impl = (GstBufferImpl *) buffer;
+  GstBufferMetaStore *store;
+  GstMetaItem *item;
+
+  if (G_UNLIKELY (impl->meta_store == NULL))
+    impl->meta_store = _meta_store_new ();
+  store = impl->meta_store;
+
+  if (size <= store->slot_size &&
+      store->slots_used != (1u << GST_BUFFER_META_SLOTS) - 1) {
+    gint i = g_bit_nth_lsf (~store->slots_used, -1);
+
+    store->slots_used |= 1u << i;
+    item = META_STORE_SLOT (store, i);
+    if (zero)
+      memset (item, 0, size);
+  } else if (zero) {
+    item = g_slice_alloc0 (size);
+  } else {
+    item = g_slice_alloc (size);
+  }
+  return item;
+}
+
+static void
+_meta_item_free (GstBuffer * buffer, GstMetaItem * item, gsize size)
+{
+  GstBufferMetaStore *store = ((GstBufferImpl *) buffer)->meta_store;
+  guint8 *slots = (guint8 *) store + META_STORE_HEADER_SIZE;
+
+  if ((guint8 *) item >= slots &&
+      (guint8 *) item < slots + GST_BUFFER_META_SLOTS * store->slot_size)
+    store->slots_used &= ~(1u << (((guint8 *) item - slots) /
+            store->slot_size));
+  else
+    g_slice_free1 (size, item);
+}
+
+/* call after appending @item to the meta list */
+static inline void
+_meta_index_add (GstBuffer * buffer, GstMetaItem * item)
+{
+  GstBufferMetaStore *store = ((GstBufferImpl *) buffer)->meta_store;
+  GstMetaItem **link = &store->index[META_INDEX (item->meta.info->api)];
+
+  /* the item is the last one in the list, so also in its chain */
+  while (*link)
+    link = &(*link)->next_in_bucket;
+  *link = item;
+  item->next_in_bucket = NULL;
+}
+
+/* call before unlinking @item from the meta list */
+static void
+_meta_index_remove (GstBuffer * buffer, GstMetaItem * item)
+{
+  GstBufferMetaStore *store = ((GstBufferImpl *) buffer)->meta_store;
+  GstMetaItem **link = &store->index[META_INDEX (item->meta.info->api)];
+
+  while (*link != item)
+    link = &(*link)->next_in_bucket;
+  *link = item->next_in_bucket;
+}
+
 static gboolean
 _is_span (GstMemory ** mem, gsize len, gsize * poffset, GstMemory ** parent)
 {
@@ -666,6 +786,13 @@ gst_buffer_copy_into (GstBuffer * dest, GstBuffer * src,
   }
 
   if (flags & GST_BUFFER_COPY_META) {
+    /* Don't copy memory metas if we only copied part of the buffer, didn't
+     * copy memories or merged memories. In all these cases the memory
+     * structure has changed and the memory meta becomes meaningless.
+     */
+    gboolean skip_memory_metas = region || !(flags & GST_BUFFER_COPY_MEMORY)
+        || (flags & GST_BUFFER_COPY_MERGE);
+
     /* NOTE: GstGLSyncMeta copying relies on the meta
      *       being copied now, after the buffer data,
      *       so this has to happen last */
@@ -673,12 +800,7 @@ gst_buffer_copy_into (GstBuffer * dest, GstBuffer * src,
       GstMeta *meta = &walk->meta;
       const GstMetaInfo *info = meta->info;
 
-      /* Don't copy memory metas if we only copied part of the buffer, didn't
-       * copy memories or merged memories. In all these cases the memory
-       * structure has changed and the memory meta becomes meaningless.
-       */
-      if ((region || !(flags & GST_BUFFER_COPY_MEMORY)
-              || (flags & GST_BUFFER_COPY_MERGE))
+      if (skip_memory_metas
           && gst_meta_api_type_has_tag (info->api, _gst_meta_tag_memory)) {
         GST_CAT_DEBUG (GST_CAT_BUFFER,
             "don't copy memory meta %p of API type %s", meta,
@@ -790,7 +912,12 @@ _gst_buffer_free (GstBuffer * buffer)
 
     next = walk->next;
     /* and free the slice */
-    g_slice_free1 (ITEM_SIZE (info), walk);
+    _meta_item_free (buffer, walk, ITEM_SIZE (info));
+  }
+  if (((GstBufferImpl *) buffer)->meta_store) {
+    GstBufferMetaStore *store = ((GstBufferImpl *) buffer)->meta_store;
+
+    g_slice_free1 (store->size, store);
   }
 
   /* get the size, when unreffing the memory, we could also unref the buffer
@@ -811,7 +938,10 @@ _gst_buffer_free (GstBuffer * buffer)
 #ifdef USE_POISONING
     memset (buffer, 0xff, msize);
 #endif
-    g_slice_free1 (msize, buffer);
+    if (msize == sizeof (GstBufferImpl))
+      _priv_gst_slice_cache_free (GST_SLICE_CACHE_BUFFER, msize, buffer);
+    else
+      g_slice_free1 (msize, buffer);
   } else {
     gst_memory_unref (GST_BUFFER_BUFMEM (buffer));
   }
@@ -836,6 +966,7 @@ gst_buffer_init (GstBufferImpl * buffer, gsize size)
 
   GST_BUFFER_MEM_LEN (buffer) = 0;
   GST_BUFFER_META (buffer) = NULL;
+  buffer->meta_store = NULL;
 }
 
 /**
@@ -850,7 +981,8 @@ gst_buffer_new (void)
 {
   GstBufferImpl *newbuf;
 
-  newbuf = g_slice_new (GstBufferImpl);
+  newbuf = _priv_gst_slice_cache_alloc (GST_SLICE_CACHE_BUFFER,
+      sizeof (GstBufferImpl));
   GST_CAT_LOG (GST_CAT_BUFFER, "new %p", newbuf);
 
   gst_buffer_init (newbuf, sizeof (GstBufferImpl));
@@ -2239,14 +2371,21 @@ gst_buffer_append_region (GstBuffer * buf1, GstBuffer * buf2, gssize offset,
 GstMeta *
 gst_buffer_get_meta (GstBuffer * buffer, GType api)
 {
+  GstBufferMetaStore *store;
   GstMetaItem *item;
   GstMeta *result = NULL;
 
   g_return_val_if_fail (buffer != NULL, NULL);
   g_return_val_if_fail (api != 0, NULL);
 
-  /* find GstMeta of the requested API */
-  for (item = GST_BUFFER_META (buffer); item; item = item->next) {
+  store = ((GstBufferImpl *) buffer)->meta_store;
+  if (store == NULL)
+    return NULL;
+
+  /* find GstMeta of the requested API in the chain of its index bucket, this
+   * only walks over items of APIs with the same hash */
+  for (item = store->index[META_INDEX (api)]; item;
+      item = item->next_in_bucket) {
     GstMeta *meta = &item->meta;
     if (meta->info->api == api) {
       result = meta;
@@ -2306,10 +2445,7 @@ gst_buffer_add_meta (GstBuffer * buffer, const GstMetaInfo * info,
    * init function but let's play safe here and prevent
    * uninitialized memory
    */
-  if (!info->init_func)
-    item = g_slice_alloc0 (size);
-  else
-    item = g_slice_alloc (size);
+  item = _meta_item_alloc (buffer, size, !info->init_func);
   result = &item->meta;
   result->info = info;
   result->flags = GST_META_FLAG_NONE;
@@ -2332,12 +2468,13 @@ gst_buffer_add_meta (GstBuffer * buffer, const GstMetaInfo * info,
     GST_BUFFER_TAIL_META (buffer)->next = item;
     GST_BUFFER_TAIL_META (buffer) = item;
   }
+  _meta_index_add (buffer, item);
 
   return result;
 
 init_failed:
   {
-    g_slice_free1 (size, item);
+    _meta_item_free (buffer, item, size);
     return NULL;
   }
 }
@@ -2370,6 +2507,8 @@ gst_buffer_remove_meta (GstBuffer * buffer, GstMeta * meta)
     if (m == meta) {
       const GstMetaInfo *info = meta->info;
 
+      _meta_index_remove (buffer, walk);
+
       /* remove from list */
       if (GST_BUFFER_TAIL_META (buffer) == walk) {
         if (prev != walk)
@@ -2388,7 +2527,7 @@ gst_buffer_remove_meta (GstBuffer * buffer, GstMeta * meta)
         info->free_func (m, buffer);
 
       /* and free the slice */
-      g_slice_free1 (ITEM_SIZE (info), walk);
+      _meta_item_free (buffer, walk, ITEM_SIZE (info));
       break;
     }
     prev = walk;
@@ -2458,15 +2597,20 @@ gst_buffer_iterate_meta_filtered (GstBuffer * buffer, gpointer * state,
   g_return_val_if_fail (state != NULL, NULL);
 
   meta = (GstMetaItem **) state;
-  if (*meta == NULL)
-    /* state NULL, move to first item */
-    *meta = GST_BUFFER_META (buffer);
-  else
-    /* state !NULL, move to next item in list */
-    *meta = (*meta)->next;
+  if (*meta == NULL) {
+    GstBufferMetaStore *store = ((GstBufferImpl *) buffer)->meta_store;
+
+    /* state NULL, move to first item of the index bucket */
+    if (store == NULL)
+      return NULL;
+    *meta = store->index[META_INDEX (meta_api_type)];
+  } else {
+    /* state !NULL, move to next item in the chain of the bucket */
+    *meta = (*meta)->next_in_bucket;
+  }
 
   while (*meta != NULL && (*meta)->meta.info->api != meta_api_type)
-    *meta = (*meta)->next;
+    *meta = (*meta)->next_in_bucket;
 
   if (*meta)
     return &(*meta)->meta;
@@ -2518,6 +2662,8 @@ gst_buffer_foreach_meta (GstBuffer * buffer, GstBufferForeachMetaFunc func,
       g_return_val_if_fail (!GST_META_FLAG_IS_SET (m, GST_META_FLAG_LOCKED),
           FALSE);
 
+      _meta_index_remove (buffer, walk);
+
       if (GST_BUFFER_TAIL_META (buffer) == walk) {
         if (prev != walk)
           GST_BUFFER_TAIL_META (buffer) = prev;
@@ -2536,7 +2682,7 @@ gst_buffer_foreach_meta (GstBuffer * buffer, GstBufferForeachMetaFunc func,
         info->free_func (m, buffer);
 
       /* and free the slice */
-      g_slice_free1 (ITEM_SIZE (info), walk);
+      _meta_item_free (buffer, walk, ITEM_SIZE (info));
     } else {
       prev = walk;
     }
@@ -64,26 +64,13 @@
 #include "gst_private.h"
 #include "glib-compat-private.h"
 
-#include <errno.h>
-#ifdef HAVE_UNISTD_H
-#  include <unistd.h>
-#endif
-#include <sys/types.h>
-
 #include "gstatomicqueue.h"
-#include "gstpoll.h"
 #include "gstinfo.h"
 #include "gstquark.h"
 #include "gstvalue.h"
 
 #include "gstbufferpool.h"
 
-#ifdef G_OS_WIN32
-#  ifndef EWOULDBLOCK
-#  define EWOULDBLOCK EAGAIN    /* This is just to placate gcc */
-#  endif
-#endif /* G_OS_WIN32 */
-
 GST_DEBUG_CATEGORY_STATIC (gst_buffer_pool_debug);
 #define GST_CAT_DEFAULT gst_buffer_pool_debug
 
@@ -93,7 +80,12 @@ GST_DEBUG_CATEGORY_STATIC (gst_buffer_pool_debug);
 struct _GstBufferPoolPrivate
 {
   GstAtomicQueue *queue;
-  GstPoll *poll;
+
+  /* acquirers wait on the cond when the pool is empty, releasers only take
+   * the lock when there are waiters */
+  GMutex wait_lock;
+  GCond wait_cond;
+  gint waiters;
 
   GRecMutex rec_lock;
 
@@ -110,6 +102,14 @@ struct _GstBufferPoolPrivate
   guint cur_buffers;
   GstAllocator *allocator;
   GstAllocationParams params;
+
+  /* statistics */
+  gsize hits;
+  gsize allocations;
+  guint64 waits;                /* with the wait lock */
+  GstClockTime wait_time;       /* with the wait lock */
+  gint in_use;
+  gint high_water_mark;
 };
 
 static void gst_buffer_pool_dispose (GObject * object);
@@ -158,8 +158,9 @@ gst_buffer_pool_init (GstBufferPool * pool)
   priv = pool->priv = gst_buffer_pool_get_instance_private (pool);
 
   g_rec_mutex_init (&priv->rec_lock);
+  g_mutex_init (&priv->wait_lock);
+  g_cond_init (&priv->wait_cond);
 
-  priv->poll = gst_poll_new_timer ();
   priv->queue = gst_atomic_queue_new (16);
   pool->flushing = 1;
   priv->active = FALSE;
@@ -171,10 +172,6 @@ gst_buffer_pool_init (GstBufferPool * pool)
   gst_allocation_params_init (&priv->params);
   gst_buffer_pool_config_set_allocator (priv->config, priv->allocator,
       &priv->params);
-  /* 1 control write for flushing - the flush token */
-  gst_poll_write_control (priv->poll);
-  /* 1 control write for marking that we are not waiting for poll - the wait token */
-  gst_poll_write_control (priv->poll);
 
   GST_DEBUG_OBJECT (pool, "created");
 }
@@ -208,8 +205,9 @@ gst_buffer_pool_finalize (GObject * object)
   GST_DEBUG_OBJECT (pool, "%p finalize", pool);
 
   gst_atomic_queue_unref (priv->queue);
-  gst_poll_free (priv->poll);
   gst_structure_free (priv->config);
+  g_cond_clear (&priv->wait_cond);
+  g_mutex_clear (&priv->wait_lock);
   g_rec_mutex_clear (&priv->rec_lock);
 
   G_OBJECT_CLASS (gst_buffer_pool_parent_class)->finalize (object);
@@ -262,6 +260,24 @@ mark_meta_pooled (GstBuffer * buffer, GstMeta ** meta, gpointer user_data)
   return TRUE;
 }
 
+/* wake up an acquirer waiting for a free buffer, or all of them when
+ * @all is set */
+static inline void
+wake_waiters (GstBufferPool * pool, gboolean all)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+
+  if (g_atomic_int_get (&priv->waiters) == 0)
+    return;
+
+  g_mutex_lock (&priv->wait_lock);
+  if (all)
+    g_cond_broadcast (&priv->wait_cond);
+  else
+    g_cond_signal (&priv->wait_cond);
+  g_mutex_unlock (&priv->wait_lock);
+}
+
 static GstFlowReturn
 do_alloc_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     GstBufferPoolAcquireParams * params)
@@ -296,6 +312,8 @@ do_alloc_buffer (GstBufferPool * pool, GstBuffer ** buffer,
    * released again */
   GST_BUFFER_FLAG_UNSET (*buffer, GST_BUFFER_FLAG_TAG_MEMORY);
 
+  g_atomic_pointer_add (&priv->allocations, 1);
+
   GST_LOG_OBJECT (pool, "allocated buffer %d/%d, %p", cur_buffers,
       max_buffers, *buffer);
 
@@ -407,20 +425,9 @@ default_stop (GstBufferPool * pool)
   GstBuffer *buffer;
 
   /* clear the pool */
-  while ((buffer = gst_atomic_queue_pop (priv->queue))) {
-    while (!gst_poll_read_control (priv->poll)) {
-      if (errno == EWOULDBLOCK) {
-        /* We put the buffer into the queue but did not finish writing control
-         * yet, let's wait a bit and retry */
-        g_thread_yield ();
-        continue;
-      } else {
-        /* Critical error but GstPoll already complained */
-        break;
-      }
-    }
+  while ((buffer = gst_atomic_queue_pop (priv->queue)))
     do_free_buffer (pool, buffer);
-  }
+
   return priv->cur_buffers == 0;
 }
 
@@ -441,6 +448,15 @@ do_stop (GstBufferPool * pool)
         return FALSE;
     }
     priv->started = FALSE;
+
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+    if (GST_TRACER_IS_ENABLED) {
+      GstStructure *stats = gst_buffer_pool_get_stats (pool);
+
+      GST_TRACER_BUFFER_POOL_STATS (pool, stats);
+      gst_structure_free (stats);
+    }
+#endif
   }
   return TRUE;
 }
@@ -449,7 +465,6 @@ do_stop (GstBufferPool * pool)
 static void
 do_set_flushing (GstBufferPool * pool, gboolean flushing)
 {
-  GstBufferPoolPrivate *priv = pool->priv;
   GstBufferPoolClass *pclass;
 
   pclass = GST_BUFFER_POOL_GET_CLASS (pool);
@@ -459,8 +474,8 @@ do_set_flushing (GstBufferPool * pool, gboolean flushing)
 
   if (flushing) {
     g_atomic_int_set (&pool->flushing, 1);
-    /* Write the flush token to wake up any waiters */
-    gst_poll_write_control (priv->poll);
+    /* wake up any waiters, they will see the flushing flag */
+    wake_waiters (pool, TRUE);
 
     if (pclass->flush_start)
       pclass->flush_start (pool);
@@ -468,19 +483,6 @@ do_set_flushing (GstBufferPool * pool, gboolean flushing)
     if (pclass->flush_stop)
       pclass->flush_stop (pool);
 
-    while (!gst_poll_read_control (priv->poll)) {
-      if (errno == EWOULDBLOCK) {
-        /* This should not really happen unless flushing and unflushing
-         * happens on different threads. Let's wait a bit to get back flush
-         * token from the thread that was setting it to flushing */
-        g_thread_yield ();
-        continue;
-      } else {
-        /* Critical error but GstPoll already complained */
-        break;
-      }
-    }
-
     g_atomic_int_set (&pool->flushing, 0);
   }
 }
@@ -1105,12 +1107,25 @@ gst_buffer_pool_config_validate_params (GstStructure * config, GstCaps * caps,
   return ret;
 }
 
+/* called with the wait lock, checks if an acquirer can stop waiting */
+static inline gboolean
+can_acquire (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+
+  return GST_BUFFER_POOL_IS_FLUSHING (pool)
+      || gst_atomic_queue_length (priv->queue) > 0
+      || priv->max_buffers == 0
+      || (guint) g_atomic_int_get (&priv->cur_buffers) < priv->max_buffers;
+}
+
 static GstFlowReturn
 default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     GstBufferPoolAcquireParams * params)
 {
   GstFlowReturn result;
   GstBufferPoolPrivate *priv = pool->priv;
+  GstClockTime start;
 
   while (TRUE) {
     if (G_UNLIKELY (GST_BUFFER_POOL_IS_FLUSHING (pool)))
@@ -1119,17 +1134,7 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     /* try to get a buffer from the queue */
     *buffer = gst_atomic_queue_pop (priv->queue);
     if (G_LIKELY (*buffer)) {
-      while (!gst_poll_read_control (priv->poll)) {
-        if (errno == EWOULDBLOCK) {
-          /* We put the buffer into the queue but did not finish writing control
-           * yet, let's wait a bit and retry */
-          g_thread_yield ();
-          continue;
-        } else {
-          /* Critical error but GstPoll already complained */
-          break;
-        }
-      }
+      g_atomic_pointer_add (&priv->hits, 1);
       result = GST_FLOW_OK;
       GST_LOG_OBJECT (pool, "acquired buffer %p", *buffer);
       break;
@@ -1152,35 +1157,20 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
       break;
     }
 
-    /* now we release the control socket, we wait for a buffer release or
-     * flushing */
-    if (!gst_poll_read_control (pool->priv->poll)) {
-      if (errno == EWOULDBLOCK) {
-        /* This means that we have two threads trying to allocate buffers
-         * already, and the other one already got the wait token. This
-         * means that we only have to wait for the poll now and not write the
-         * token afterwards: we will be woken up once the other thread is
-         * woken up and that one will write the wait token it removed */
-        GST_LOG_OBJECT (pool, "waiting for free buffers or flushing");
-        gst_poll_wait (priv->poll, GST_CLOCK_TIME_NONE);
-      } else {
-        /* This is a critical error, GstPoll already gave a warning */
-        result = GST_FLOW_ERROR;
-        break;
-      }
-    } else {
-      /* We're the first thread waiting, we got the wait token and have to
-       * write it again later
-       * OR
-       * We're a second thread and just consumed the flush token and block all
-       * other threads, in which case we must not wait and give it back
-       * immediately */
-      if (!GST_BUFFER_POOL_IS_FLUSHING (pool)) {
-        GST_LOG_OBJECT (pool, "waiting for free buffers or flushing");
-        gst_poll_wait (priv->poll, GST_CLOCK_TIME_NONE);
-      }
-      gst_poll_write_control (pool->priv->poll);
+    /* wait for a buffer release or flushing. We announce ourselves as a
+     * waiter before checking again, releasers check for waiters after
+     * returning the buffer, so one of us is guaranteed to see the other */
+    g_mutex_lock (&priv->wait_lock);
+    g_atomic_int_inc (&priv->waiters);
+    if (!can_acquire (pool)) {
+      GST_LOG_OBJECT (pool, "waiting for free buffers or flushing");
+      priv->waits++;
+      start = gst_util_get_timestamp ();
+      g_cond_wait (&priv->wait_cond, &priv->wait_lock);
+      priv->wait_time += gst_util_get_timestamp () - start;
     }
+    g_atomic_int_add (&priv->waiters, -1);
+    g_mutex_unlock (&priv->wait_lock);
   }
 
   return result;
@@ -1291,9 +1281,20 @@ gst_buffer_pool_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     result = GST_FLOW_NOT_SUPPORTED;
 
   if (G_LIKELY (result == GST_FLOW_OK)) {
+    gint in_use, hwm;
+
     /* all buffers from the pool point to the pool and have the refcount of the
      * pool incremented */
     (*buffer)->pool = gst_object_ref (pool);
+
+    /* outstanding also counts the acquires in progress, only count the
+     * buffers that were handed out */
+    in_use = g_atomic_int_add (&pool->priv->in_use, 1) + 1;
+    do {
+      hwm = g_atomic_int_get (&pool->priv->high_water_mark);
+    } while (G_UNLIKELY (in_use > hwm)
+        && !g_atomic_int_compare_and_exchange (&pool->priv->high_water_mark,
+            hwm, in_use));
   } else {
     dec_outstanding (pool);
   }
@@ -1322,7 +1323,7 @@ default_release_buffer (GstBufferPool * pool, GstBuffer * buffer)
 
   /* keep it around in our queue */
   gst_atomic_queue_push (pool->priv->queue, buffer);
-  gst_poll_write_control (pool->priv->poll);
+  wake_waiters (pool, FALSE);
 
   return;
 
@@ -1348,7 +1349,8 @@ not_writable:
 discard:
   {
     do_free_buffer (pool, buffer);
-    gst_poll_write_control (pool->priv->poll);
+    /* a new buffer can be allocated now */
+    wake_waiters (pool, FALSE);
     return;
   }
 }
@@ -1377,6 +1379,8 @@ gst_buffer_pool_release_buffer (GstBufferPool * pool, GstBuffer * buffer)
   if (!g_atomic_pointer_compare_and_exchange (&buffer->pool, pool, NULL))
     return;
 
+  g_atomic_int_add (&pool->priv->in_use, -1);
+
   pclass = GST_BUFFER_POOL_GET_CLASS (pool);
 
   /* reset the buffer when needed */
@@ -1425,3 +1429,58 @@ gst_buffer_pool_set_flushing (GstBufferPool * pool, gboolean flushing)
 done:
   GST_BUFFER_POOL_UNLOCK (pool);
 }
+
+/**
+ * gst_buffer_pool_get_stats:
+ * @pool: a #GstBufferPool
+ *
+ * Gets the usage statistics of @pool since it was created. The returned
+ * structure contains the following fields:
+ *
+ * * `hits`: #G_TYPE_UINT64, the number of buffers acquired from the free
+ *   buffers of the pool
+ * * `allocations`: #G_TYPE_UINT64, the number of buffers the pool allocated
+ * * `waits`: #G_TYPE_UINT64, the number of times an acquire had to wait for
+ *   a buffer to be released
+ * * `wait-time`: #G_TYPE_UINT64, the total time in nanoseconds spent in
+ *   those waits
+ * * `high-water-mark`: #G_TYPE_UINT, the maximum number of buffers that
+ *   were in use at the same time
+ *
+ * The statistics are only collected by the default acquire and release
+ * implementations. Tracers get them from the "buffer-pool-stats" hook when
+ * the pool is stopped.
+ *
+ * Returns: (transfer full): a new #GstStructure with the statistics of
+ * @pool.
+ *
+ * Since: 1.22
+ */
+GstStructure *
+gst_buffer_pool_get_stats (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv;
+  GstStructure *stats;
+  guint64 waits;
+  GstClockTime wait_time;
+
+  g_return_val_if_fail (GST_IS_BUFFER_POOL (pool), NULL);
+
+  priv = pool->priv;
+
+  g_mutex_lock (&priv->wait_lock);
+  waits = priv->waits;
+  wait_time = priv->wait_time;
+  g_mutex_unlock (&priv->wait_lock);
+
+  stats = gst_structure_new ("buffer-pool-stats",
+      "hits", G_TYPE_UINT64, (guint64) g_atomic_pointer_get (&priv->hits),
+      "allocations", G_TYPE_UINT64,
+      (guint64) g_atomic_pointer_get (&priv->allocations),
+      "waits", G_TYPE_UINT64, waits,
+      "wait-time", G_TYPE_UINT64, wait_time,
+      "high-water-mark", G_TYPE_UINT,
+      (guint) g_atomic_int_get (&priv->high_water_mark), NULL);
+
+  return stats;
+}
@@ -300,6 +300,9 @@ gboolean         gst_buffer_pool_has_option      (GstBufferPool *pool, const gch
 GST_API
 void             gst_buffer_pool_set_flushing    (GstBufferPool *pool, gboolean flushing);
 
+GST_API
+GstStructure *   gst_buffer_pool_get_stats       (GstBufferPool *pool);
+
 /* helpers for configuring the config structure */
 
 GST_API
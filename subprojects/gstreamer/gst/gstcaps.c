@@ -58,6 +58,12 @@
  * support one level of nesting. Using more levels would lead to unexpected
  * behavior when using serialization features, such as gst_caps_to_string() or
  * gst_value_serialize() and their counterparts.
+ *
+ * Since 1.22, the results of gst_caps_intersect(), gst_caps_can_intersect()
+ * and gst_caps_is_subset() on caps that are not writable can be remembered
+ * in a cache. It is disabled by default and enabled by setting the
+ * `GST_CAPS_CACHE_SIZE` environment variable to the number of results to keep.
+ * The intersections returned from the cache are shared and thus not writable.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -136,11 +142,179 @@ GstCaps *_gst_caps_none;
 
 GST_DEFINE_MINI_OBJECT_TYPE (GstCaps, gst_caps);
 
+/* Cache of operations on caps that are not writable. Entries keep a
+ * reference to both caps so that they can't be modified or freed, which
+ * makes their address a valid key for their content. The cache is a direct
+ * mapped table, a new result simply replaces whatever was in its slot. */
+typedef enum
+{
+  CAPS_CACHE_INTERSECT_ZIG_ZAG,
+  CAPS_CACHE_INTERSECT_FIRST,
+  CAPS_CACHE_CAN_INTERSECT,
+  CAPS_CACHE_IS_SUBSET
+} GstCapsCacheOp;
+
+typedef struct
+{
+  GstCaps *caps1;
+  GstCaps *caps2;
+  GstCapsCacheOp op;
+  gboolean result;
+  GstCaps *intersection;
+} GstCapsCacheEntry;
+
+#define CAPS_CACHE_MAX_SIZE 65536
+
+static GMutex caps_cache_lock;
+static GstCapsCacheEntry *caps_cache;   /* NULL when disabled */
+static guint caps_cache_mask;
+static guint64 caps_cache_hits;
+static guint64 caps_cache_misses;
+
+#define CAPS_CACHE_USABLE(caps1,caps2) \
+  (caps_cache != NULL && !IS_WRITABLE (caps1) && !IS_WRITABLE (caps2))
+
+static inline guint
+gst_caps_cache_index (const GstCaps * caps1, const GstCaps * caps2,
+    GstCapsCacheOp op)
+{
+  guint h;
+
+  h = (guint) (GPOINTER_TO_SIZE (caps1) >> 4);
+  h = h * 31 + (guint) (GPOINTER_TO_SIZE (caps2) >> 4);
+  h = h * 31 + op;
+
+  return (h * 2654435761u) & caps_cache_mask;
+}
+
+/* Returns %TRUE and the cached result of @op when present. For
+ * intersections, @intersection receives a new reference. */
+static gboolean
+gst_caps_cache_lookup (const GstCaps * caps1, const GstCaps * caps2,
+    GstCapsCacheOp op, gboolean * result, GstCaps ** intersection)
+{
+  GstCapsCacheEntry *entry;
+  gboolean found;
+
+  g_mutex_lock (&caps_cache_lock);
+  entry = &caps_cache[gst_caps_cache_index (caps1, caps2, op)];
+  found = entry->caps1 == caps1 && entry->caps2 == caps2 && entry->op == op;
+  if (found) {
+    if (result)
+      *result = entry->result;
+    if (intersection)
+      *intersection = gst_caps_ref (entry->intersection);
+    caps_cache_hits++;
+  } else {
+    caps_cache_misses++;
+  }
+  g_mutex_unlock (&caps_cache_lock);
+
+  return found;
+}
+
+static void
+gst_caps_cache_store (GstCaps * caps1, GstCaps * caps2, GstCapsCacheOp op,
+    gboolean result, GstCaps * intersection)
+{
+  GstCapsCacheEntry *entry, old;
+
+  g_mutex_lock (&caps_cache_lock);
+  entry = &caps_cache[gst_caps_cache_index (caps1, caps2, op)];
+  old = *entry;
+  entry->caps1 = gst_caps_ref (caps1);
+  entry->caps2 = gst_caps_ref (caps2);
+  entry->op = op;
+  entry->result = result;
+  entry->intersection = intersection ? gst_caps_ref (intersection) : NULL;
+  g_mutex_unlock (&caps_cache_lock);
+
+  /* might free caps, don't do that with the lock */
+  if (old.caps1) {
+    gst_caps_unref (old.caps1);
+    gst_caps_unref (old.caps2);
+    if (old.intersection)
+      gst_caps_unref (old.intersection);
+  }
+}
+
+/* Clears the cache, with the caps_cache_lock */
+static void
+gst_caps_cache_clear_locked (void)
+{
+  guint i;
+
+  for (i = 0; i <= caps_cache_mask; i++) {
+    GstCapsCacheEntry *entry = &caps_cache[i];
+
+    if (entry->caps1) {
+      gst_caps_unref (entry->caps1);
+      gst_caps_unref (entry->caps2);
+      if (entry->intersection)
+        gst_caps_unref (entry->intersection);
+    }
+  }
+  memset (caps_cache, 0, (caps_cache_mask + 1) * sizeof (GstCapsCacheEntry));
+}
+
+/* Returns a newly allocated structure with the cache counters */
+GstStructure *
+_priv_gst_caps_cache_get_stats (void)
+{
+  GstStructure *stats;
+  guint i, used = 0;
+
+  g_mutex_lock (&caps_cache_lock);
+  for (i = 0; caps_cache && i <= caps_cache_mask; i++) {
+    if (caps_cache[i].caps1)
+      used++;
+  }
+  stats = gst_structure_new ("caps-cache-stats",
+      "hits", G_TYPE_UINT64, caps_cache_hits,
+      "misses", G_TYPE_UINT64, caps_cache_misses,
+      "size", G_TYPE_UINT, caps_cache ? caps_cache_mask + 1 : 0,
+      "used", G_TYPE_UINT, used, NULL);
+  g_mutex_unlock (&caps_cache_lock);
+
+  return stats;
+}
+
+/* Called before the tracers are finalized so that the leaks tracer doesn't
+ * report the caps kept alive by the cache */
+void
+_priv_gst_caps_cache_cleanup (void)
+{
+  g_mutex_lock (&caps_cache_lock);
+  if (caps_cache) {
+    /* unreffing caps can't reenter the cache */
+    gst_caps_cache_clear_locked ();
+    g_free (caps_cache);
+    caps_cache = NULL;
+  }
+  g_mutex_unlock (&caps_cache_lock);
+}
+
 void
 _priv_gst_caps_initialize (void)
 {
+  const gchar *env;
+
   _gst_caps_type = gst_caps_get_type ();
 
+  g_mutex_init (&caps_cache_lock);
+  if ((env = g_getenv ("GST_CAPS_CACHE_SIZE"))) {
+    guint64 size = g_ascii_strtoull (env, NULL, 10);
+
+    if (size > 0) {
+      size = MIN (size, CAPS_CACHE_MAX_SIZE);
+      /* round up to a power of 2 for the index mask */
+      caps_cache_mask = (1u << g_bit_storage ((gulong) size - 1)) - 1;
+      caps_cache = g_new0 (GstCapsCacheEntry, caps_cache_mask + 1);
+      GST_CAT_INFO (GST_CAT_CAPS, "caps cache with %u entries",
+          caps_cache_mask + 1);
+    }
+  }
+
   _gst_caps_any = gst_caps_new_any ();
   _gst_caps_none = gst_caps_new_empty ();
 
@@ -1314,6 +1488,7 @@ gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
   GstStructure *s1, *s2;
   GstCapsFeatures *f1, *f2;
   gboolean ret = TRUE;
+  gboolean use_cache = FALSE;
   gint i, j;
 
   g_return_val_if_fail (subset != NULL, FALSE);
@@ -1324,6 +1499,13 @@ gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
   if (CAPS_IS_ANY (subset) || CAPS_IS_EMPTY (superset))
     return FALSE;
 
+  if (CAPS_CACHE_USABLE (subset, superset)) {
+    if (gst_caps_cache_lookup (subset, superset, CAPS_CACHE_IS_SUBSET, &ret,
+            NULL))
+      return ret;
+    use_cache = TRUE;
+  }
+
   for (i = GST_CAPS_LEN (subset) - 1; i >= 0; i--) {
     s1 = gst_caps_get_structure_unchecked (subset, i);
     f1 = gst_caps_get_features_unchecked (subset, i);
@@ -1352,6 +1534,10 @@ gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
     }
   }
 
+  if (use_cache)
+    gst_caps_cache_store ((GstCaps *) subset, (GstCaps *) superset,
+        CAPS_CACHE_IS_SUBSET, ret, NULL);
+
   return ret;
 }
 
@@ -1525,15 +1711,13 @@ gst_caps_is_strictly_equal (const GstCaps * caps1, const GstCaps * caps2)
  *
  * Returns: %TRUE if intersection would be not empty
  */
+static gboolean gst_caps_can_intersect_zig_zag (const GstCaps * caps1,
+    const GstCaps * caps2);
+
 gboolean
 gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
 {
-  guint64 i;                    /* index can be up to 2 * G_MAX_UINT */
-  guint j, k, len1, len2;
-  GstStructure *struct1;
-  GstStructure *struct2;
-  GstCapsFeatures *features1;
-  GstCapsFeatures *features2;
+  gboolean ret;
 
   g_return_val_if_fail (GST_IS_CAPS (caps1), FALSE);
   g_return_val_if_fail (GST_IS_CAPS (caps2), FALSE);
@@ -1550,6 +1734,29 @@ gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
   if (G_UNLIKELY (CAPS_IS_ANY (caps1) || CAPS_IS_ANY (caps2)))
     return TRUE;
 
+  if (!CAPS_CACHE_USABLE (caps1, caps2))
+    return gst_caps_can_intersect_zig_zag (caps1, caps2);
+
+  if (!gst_caps_cache_lookup (caps1, caps2, CAPS_CACHE_CAN_INTERSECT, &ret,
+          NULL)) {
+    ret = gst_caps_can_intersect_zig_zag (caps1, caps2);
+    gst_caps_cache_store ((GstCaps *) caps1, (GstCaps *) caps2,
+        CAPS_CACHE_CAN_INTERSECT, ret, NULL);
+  }
+
+  return ret;
+}
+
+static gboolean
+gst_caps_can_intersect_zig_zag (const GstCaps * caps1, const GstCaps * caps2)
+{
+  guint64 i;                    /* index can be up to 2 * G_MAX_UINT */
+  guint j, k, len1, len2;
+  GstStructure *struct1;
+  GstStructure *struct2;
+  GstCapsFeatures *features1;
+  GstCapsFeatures *features2;
+
   /* run zigzag on top line then right line, this preserves the caps order
    * much better than a simple loop.
    *
@@ -1745,6 +1952,10 @@ GstCaps *
 gst_caps_intersect_full (GstCaps * caps1, GstCaps * caps2,
     GstCapsIntersectMode mode)
 {
+  GstCapsCacheOp op;
+  GstCaps *result;
+  gboolean use_cache = FALSE;
+
   g_return_val_if_fail (GST_IS_CAPS (caps1), NULL);
   g_return_val_if_fail (GST_IS_CAPS (caps2), NULL);
 
@@ -1766,13 +1977,31 @@ gst_caps_intersect_full (GstCaps * caps1, GstCaps * caps2,
 
   switch (mode) {
     case GST_CAPS_INTERSECT_FIRST:
-      return gst_caps_intersect_first (caps1, caps2);
+      op = CAPS_CACHE_INTERSECT_FIRST;
+      break;
     default:
       g_warning ("Unknown caps intersect mode: %d", mode);
       /* fallthrough */
     case GST_CAPS_INTERSECT_ZIG_ZAG:
-      return gst_caps_intersect_zig_zag (caps1, caps2);
+      op = CAPS_CACHE_INTERSECT_ZIG_ZAG;
+      break;
+  }
+
+  if (CAPS_CACHE_USABLE (caps1, caps2)) {
+    if (gst_caps_cache_lookup (caps1, caps2, op, NULL, &result))
+      return result;
+    use_cache = TRUE;
   }
+
+  if (op == CAPS_CACHE_INTERSECT_FIRST)
+    result = gst_caps_intersect_first (caps1, caps2);
+  else
+    result = gst_caps_intersect_zig_zag (caps1, caps2);
+
+  if (use_cache)
+    gst_caps_cache_store (caps1, caps2, op, FALSE, result);
+
+  return result;
 }
 
 /**
@@ -151,6 +151,10 @@ gst_element_factory_cleanup (GstElementFactory * factory)
 {
   GList *item;
 
+  /* first, a load of the details in another thread must not run while
+   * they are freed */
+  _priv_gst_registry_chunks_unload_details (GST_PLUGIN_FEATURE_CAST (factory));
+
   if (factory->metadata) {
     gst_structure_free ((GstStructure *) factory->metadata);
     factory->metadata = NULL;
@@ -862,6 +866,8 @@ gst_element_factory_get_metadata (GstElementFactory * factory,
 {
   g_return_val_if_fail (GST_IS_ELEMENT_FACTORY (factory), NULL);
 
+  GST_FACTORY_LOAD_DETAILS (factory);
+
   return gst_structure_get_string ((GstStructure *) factory->metadata, key);
 }
 
@@ -884,6 +890,8 @@ gst_element_factory_get_metadata_keys (GstElementFactory * factory)
 
   g_return_val_if_fail (GST_IS_ELEMENT_FACTORY (factory), NULL);
 
+  GST_FACTORY_LOAD_DETAILS (factory);
+
   metadata = (GstStructure *) factory->metadata;
   if (metadata == NULL)
     return NULL;
@@ -913,6 +921,8 @@ gst_element_factory_get_num_pad_templates (GstElementFactory * factory)
 {
   g_return_val_if_fail (GST_IS_ELEMENT_FACTORY (factory), 0);
 
+  GST_FACTORY_LOAD_DETAILS (factory);
+
   return factory->numpadtemplates;
 }
 
@@ -951,6 +961,8 @@ gst_element_factory_get_static_pad_templates (GstElementFactory * factory)
 {
   g_return_val_if_fail (GST_IS_ELEMENT_FACTORY (factory), NULL);
 
+  GST_FACTORY_LOAD_DETAILS (factory);
+
   return factory->staticpadtemplates;
 }
 
@@ -967,6 +979,8 @@ gst_element_factory_get_uri_type (GstElementFactory * factory)
 {
   g_return_val_if_fail (GST_IS_ELEMENT_FACTORY (factory), GST_URI_UNKNOWN);
 
+  GST_FACTORY_LOAD_DETAILS (factory);
+
   return factory->uri_type;
 }
 
@@ -987,6 +1001,8 @@ gst_element_factory_get_uri_protocols (GstElementFactory * factory)
 {
   g_return_val_if_fail (GST_IS_ELEMENT_FACTORY (factory), NULL);
 
+  GST_FACTORY_LOAD_DETAILS (factory);
+
   return (const gchar * const *) factory->uri_protocols;
 }
 
@@ -1007,6 +1023,8 @@ gst_element_factory_has_interface (GstElementFactory * factory,
 
   g_return_val_if_fail (GST_IS_ELEMENT_FACTORY (factory), FALSE);
 
+  GST_FACTORY_LOAD_DETAILS (factory);
+
   for (walk = factory->interfaces; walk; walk = g_list_next (walk)) {
     gchar *iname = (gchar *) walk->data;
 
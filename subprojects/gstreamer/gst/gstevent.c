@@ -234,7 +234,8 @@ _gst_event_free (GstEvent * event)
   memset (event, 0xff, sizeof (GstEventImpl));
 #endif
 
-  g_slice_free1 (sizeof (GstEventImpl), event);
+  _priv_gst_slice_cache_free (GST_SLICE_CACHE_EVENT, sizeof (GstEventImpl),
+      event);
 }
 
 static void gst_event_init (GstEventImpl * event, GstEventType type);
@@ -245,7 +246,9 @@ _gst_event_copy (GstEvent * event)
   GstEventImpl *copy;
   GstStructure *s;
 
-  copy = g_slice_new0 (GstEventImpl);
+  copy = _priv_gst_slice_cache_alloc (GST_SLICE_CACHE_EVENT,
+      sizeof (GstEventImpl));
+  memset (copy, 0, sizeof (GstEventImpl));
 
   gst_event_init (copy, GST_EVENT_TYPE (event));
 
@@ -305,7 +308,9 @@ gst_event_new_custom (GstEventType type, GstStructure * structure)
 {
   GstEventImpl *event;
 
-  event = g_slice_new0 (GstEventImpl);
+  event = _priv_gst_slice_cache_alloc (GST_SLICE_CACHE_EVENT,
+      sizeof (GstEventImpl));
+  memset (event, 0, sizeof (GstEventImpl));
 
   GST_CAT_DEBUG (GST_CAT_EVENT, "creating new event %p %s %d", event,
       gst_event_type_get_name (type), type);
@@ -326,7 +331,8 @@ gst_event_new_custom (GstEventType type, GstStructure * structure)
   /* ERRORS */
 had_parent:
   {
-    g_slice_free1 (sizeof (GstEventImpl), event);
+    _priv_gst_slice_cache_free (GST_SLICE_CACHE_EVENT, sizeof (GstEventImpl),
+        event);
     g_warning ("structure is already owned by another object");
     return NULL;
   }
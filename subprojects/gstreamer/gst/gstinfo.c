@@ -300,6 +300,8 @@ dladdr (void *address, Dl_info * dl)
 
 static void gst_debug_reset_threshold (gpointer category, gpointer unused);
 static void gst_debug_reset_all_thresholds (void);
+static void gst_debug_async_start (FILE * log_file, const gchar * env);
+static void gst_debug_async_stop (void);
 
 struct _GstDebugMessage
 {
@@ -400,6 +402,10 @@ _priv_gst_debug_init (void)
     }
 
     gst_debug_add_log_function (gst_debug_log_default, log_file, NULL);
+
+    env = g_getenv ("GST_DEBUG_ASYNC");
+    if (env != NULL && *env != '\0' && strcmp (env, "0") != 0)
+      gst_debug_async_start (log_file, env);
   }
 
   __gst_printf_pointer_extension_set_func
@@ -1314,39 +1320,14 @@ _gst_debug_fprintf (FILE * file, const gchar * format, ...)
 }
 #endif
 
-/**
- * gst_debug_log_default:
- * @category: category to log
- * @level: level of the message
- * @file: the file that emitted the message, usually the __FILE__ identifier
- * @function: the function that emitted the message
- * @line: the line from that the message was emitted, usually __LINE__
- * @message: the actual message
- * @object: (transfer none) (allow-none): the object this message relates to,
- *     or %NULL if none
- * @user_data: the FILE* to log to
- *
- * The default logging handler used by GStreamer. Logging functions get called
- * whenever a macro like GST_DEBUG or similar is used. By default this function
- * is setup to output the message and additional info to stderr (or the log file
- * specified via the GST_DEBUG_FILE environment variable) as received via
- * @user_data.
- *
- * You can add other handlers by using gst_debug_add_log_function().
- * And you can remove this handler by calling
- * gst_debug_remove_log_function(gst_debug_log_default);
- */
-void
-gst_debug_log_default (GstDebugCategory * category, GstDebugLevel level,
-    const gchar * file, const gchar * function, gint line,
-    GObject * object, GstDebugMessage * message, gpointer user_data)
+static void
+gst_debug_log_write (FILE * log_file, GstClockTime elapsed, GThread * thread,
+    GstDebugCategory * category, GstDebugLevel level, const gchar * file,
+    const gchar * function, gint line, const gchar * obj,
+    const gchar * message_str)
 {
   gint pid;
-  GstClockTime elapsed;
-  gchar *obj = NULL;
   GstDebugColorMode color_mode;
-  const gchar *message_str;
-  FILE *log_file = user_data ? user_data : stderr;
 #ifdef G_OS_WIN32
 #define FPRINTF_DEBUG _gst_debug_fprintf
 /* _gst_debug_fprintf will do fflush if it's required */
@@ -1358,13 +1339,6 @@ gst_debug_log_default (GstDebugCategory * category, GstDebugLevel level,
   } G_STMT_END
 #endif
 
-#ifdef GST_ENABLE_EXTRA_CHECKS
-  g_warn_if_fail (object == NULL || G_IS_OBJECT (object));
-#endif
-
-  _gst_debug_log_preamble (message, object, &file, &message_str, &obj,
-      &elapsed);
-
   pid = _gst_getpid ();
   color_mode = gst_debug_get_color_mode ();
 
@@ -1387,7 +1361,7 @@ gst_debug_log_default (GstDebugCategory * category, GstDebugLevel level,
 
 #define PRINT_FMT " %s"PID_FMT"%s "PTR_FMT" %s%s%s %s"CAT_FMT"%s %s\n"
       FPRINTF_DEBUG (log_file, "%" GST_TIME_FORMAT PRINT_FMT,
-          GST_TIME_ARGS (elapsed), pidcolor, pid, clear, g_thread_self (),
+          GST_TIME_ARGS (elapsed), pidcolor, pid, clear, thread,
           levelcolor, gst_debug_level_get_name (level), clear, color,
           gst_debug_category_get_name (category), file, line, function, obj,
           clear, message_str);
@@ -1410,7 +1384,7 @@ gst_debug_log_default (GstDebugCategory * category, GstDebugLevel level,
       FPRINTF_DEBUG (log_file, PID_FMT, pid);
       /* thread */
       SET_COLOR (clear);
-      FPRINTF_DEBUG (log_file, " " PTR_FMT " ", g_thread_self ());
+      FPRINTF_DEBUG (log_file, " " PTR_FMT " ", thread);
       /* level */
       SET_COLOR (levelcolormap_w32[level]);
       FPRINTF_DEBUG (log_file, "%s ", gst_debug_level_get_name (level));
@@ -1428,12 +1402,344 @@ gst_debug_log_default (GstDebugCategory * category, GstDebugLevel level,
   } else {
     /* no color, all platforms */
     FPRINTF_DEBUG (log_file, "%" GST_TIME_FORMAT NOCOLOR_PRINT_FMT,
-        GST_TIME_ARGS (elapsed), pid, g_thread_self (),
+        GST_TIME_ARGS (elapsed), pid, thread,
         gst_debug_level_get_name (level),
         gst_debug_category_get_name (category), file, line, function, obj,
         message_str);
     FFLUSH_DEBUG (log_file);
   }
+#undef FPRINTF_DEBUG
+#undef FFLUSH_DEBUG
+}
+
+/* Asynchronous logging, enabled with the GST_DEBUG_ASYNC environment variable.
+ *
+ * Every logging thread owns a ring of records that only it writes to and that
+ * only the writer thread reads from, so that no locking is needed on either
+ * side. The message and the object description have to be formatted by the
+ * logging thread as the arguments are not guaranteed to be valid afterwards,
+ * everything else, including formatting the line and writing it out, is done
+ * by the writer thread. When a ring is full, messages are dropped and the
+ * number of dropped messages is logged by the writer once there is space
+ * again.
+ *
+ * The writer merges the rings by timestamp and frees the ring of a thread
+ * that exited once it is empty. */
+#define ASYNC_RING_SIZE_DEFAULT   4096
+#define ASYNC_RING_SIZE_MAX       (1 << 20)
+#define ASYNC_WRITER_INTERVAL     (10 * G_TIME_SPAN_MILLISECOND)
+
+typedef struct
+{
+  GstClockTime elapsed;
+  GstDebugCategory *category;
+  GstDebugLevel level;
+  gint line;
+  /* file, function, object and message, each nul-terminated */
+  gchar *strings;
+} GstDebugAsyncRecord;
+
+typedef struct
+{
+  GstDebugAsyncRecord *records;
+  guint mask;
+  GThread *thread;
+
+  /* written by the logging thread */
+  gint head;
+  gint dropped;
+  gint dead;
+
+  /* written by the writer thread */
+  gint tail;
+  guint reported;
+} GstDebugAsyncRing;
+
+static FILE *async_log_file = NULL;
+static guint async_ring_size;
+static GThread *async_writer = NULL;
+static GMutex async_lock;
+static GCond async_cond;
+static gboolean async_stop;
+static GList *async_rings = NULL;
+
+static void
+gst_debug_async_ring_release (GstDebugAsyncRing * ring)
+{
+  g_atomic_int_set (&ring->dead, TRUE);
+}
+
+static GPrivate async_thread_ring =
+G_PRIVATE_INIT ((GDestroyNotify) gst_debug_async_ring_release);
+
+static GstDebugAsyncRing *
+gst_debug_async_get_ring (void)
+{
+  GstDebugAsyncRing *ring = g_private_get (&async_thread_ring);
+
+  if (G_UNLIKELY (ring == NULL)) {
+    ring = g_new0 (GstDebugAsyncRing, 1);
+    ring->records = g_new (GstDebugAsyncRecord, async_ring_size);
+    ring->mask = async_ring_size - 1;
+    ring->thread = g_thread_self ();
+    g_private_set (&async_thread_ring, ring);
+
+    g_mutex_lock (&async_lock);
+    async_rings = g_list_prepend (async_rings, ring);
+    g_mutex_unlock (&async_lock);
+  }
+  return ring;
+}
+
+static void
+gst_debug_async_push (GstDebugCategory * category, GstDebugLevel level,
+    const gchar * file, const gchar * function, gint line, GObject * object,
+    GstDebugMessage * message)
+{
+  GstDebugAsyncRing *ring = gst_debug_async_get_ring ();
+  GstDebugAsyncRecord *record;
+  GstClockTime elapsed;
+  const gchar *message_str;
+  gchar *obj = NULL, *p;
+  gsize file_len, function_len, obj_len, message_len;
+  guint head, tail;
+
+  head = (guint) ring->head;
+  tail = (guint) g_atomic_int_get (&ring->tail);
+  if (G_UNLIKELY (head - tail > ring->mask)) {
+    g_atomic_int_set (&ring->dropped, ring->dropped + 1);
+    return;
+  }
+
+  _gst_debug_log_preamble (message, object, &file, &message_str, &obj,
+      &elapsed);
+
+  file_len = strlen (file) + 1;
+  function_len = strlen (function) + 1;
+  obj_len = strlen (obj) + 1;
+  message_len = strlen (message_str) + 1;
+
+  record = &ring->records[head & ring->mask];
+  record->elapsed = elapsed;
+  record->category = category;
+  record->level = level;
+  record->line = line;
+  record->strings = p =
+      g_malloc (file_len + function_len + obj_len + message_len);
+  memcpy (p, file, file_len);
+  memcpy (p += file_len, function, function_len);
+  memcpy (p += function_len, obj, obj_len);
+  memcpy (p + obj_len, message_str, message_len);
+
+  if (object != NULL)
+    g_free (obj);
+
+  /* publishes the record to the writer */
+  g_atomic_int_set (&ring->head, head + 1);
+}
+
+static void
+gst_debug_async_write_record (FILE * log_file, GstDebugAsyncRing * ring)
+{
+  guint tail = (guint) ring->tail;
+  GstDebugAsyncRecord *record = &ring->records[tail & ring->mask];
+  const gchar *file, *function, *obj, *message_str;
+
+  file = record->strings;
+  function = file + strlen (file) + 1;
+  obj = function + strlen (function) + 1;
+  message_str = obj + strlen (obj) + 1;
+
+  gst_debug_log_write (log_file, record->elapsed, ring->thread,
+      record->category, record->level, file, function, record->line, obj,
+      message_str);
+  g_free (record->strings);
+
+  /* hands the slot back to the logging thread */
+  g_atomic_int_set (&ring->tail, tail + 1);
+}
+
+/* writes out everything that is in the rings at the time of the call,
+ * interleaving the rings by timestamp. Returns the number of records
+ * written. */
+static guint
+gst_debug_async_drain (FILE * log_file)
+{
+  GstDebugAsyncRing **rings;
+  guint *heads;
+  guint i, n_rings, n_written = 0;
+  GList *l;
+
+  g_mutex_lock (&async_lock);
+  n_rings = g_list_length (async_rings);
+  rings = g_newa (GstDebugAsyncRing *, n_rings + 1);
+  heads = g_newa (guint, n_rings + 1);
+  for (i = 0, l = async_rings; l; l = l->next, i++) {
+    rings[i] = l->data;
+    heads[i] = (guint) g_atomic_int_get (&rings[i]->head);
+  }
+  g_mutex_unlock (&async_lock);
+
+  while (TRUE) {
+    GstDebugAsyncRing *next = NULL;
+    GstClockTime next_time = GST_CLOCK_TIME_NONE;
+
+    for (i = 0; i < n_rings; i++) {
+      GstDebugAsyncRing *ring = rings[i];
+      GstClockTime time;
+
+      if ((guint) ring->tail == heads[i])
+        continue;
+
+      time = ring->records[ring->tail & ring->mask].elapsed;
+      if (next == NULL || time < next_time) {
+        next = ring;
+        next_time = time;
+      }
+    }
+    if (next == NULL)
+      break;
+
+    gst_debug_async_write_record (log_file, next);
+    n_written++;
+  }
+
+  for (i = 0; i < n_rings; i++) {
+    GstDebugAsyncRing *ring = rings[i];
+    guint dropped = (guint) g_atomic_int_get (&ring->dropped);
+
+    if (dropped != ring->reported) {
+      fprintf (log_file, "*** dropped %u debug messages of thread " PTR_FMT
+          "\n", dropped - ring->reported, ring->thread);
+      ring->reported = dropped;
+      n_written++;
+    }
+  }
+
+  if (n_written)
+    fflush (log_file);
+
+  /* free the rings of threads that exited once they are empty */
+  g_mutex_lock (&async_lock);
+  for (i = 0; i < n_rings; i++) {
+    GstDebugAsyncRing *ring = rings[i];
+
+    if (g_atomic_int_get (&ring->dead) &&
+        (guint) g_atomic_int_get (&ring->head) == (guint) ring->tail) {
+      async_rings = g_list_remove (async_rings, ring);
+      g_free (ring->records);
+      g_free (ring);
+    }
+  }
+  g_mutex_unlock (&async_lock);
+
+  return n_written;
+}
+
+static gpointer
+gst_debug_async_writer_func (FILE * log_file)
+{
+  gboolean stop;
+
+  do {
+    g_mutex_lock (&async_lock);
+    stop = async_stop;
+    if (!stop)
+      g_cond_wait_until (&async_cond, &async_lock,
+          g_get_monotonic_time () + ASYNC_WRITER_INTERVAL);
+    g_mutex_unlock (&async_lock);
+
+    /* drain once more after being stopped to get everything written */
+    gst_debug_async_drain (log_file);
+  } while (!stop);
+
+  return NULL;
+}
+
+static void
+gst_debug_async_start (FILE * log_file, const gchar * env)
+{
+  guint64 size = g_ascii_strtoull (env, NULL, 10);
+
+  if (size < 16)
+    size = ASYNC_RING_SIZE_DEFAULT;
+  /* round up to a power of two */
+  async_ring_size = 1 << g_bit_storage (MIN (size, ASYNC_RING_SIZE_MAX) - 1);
+
+  async_stop = FALSE;
+  async_log_file = log_file;
+  async_writer = g_thread_new ("gst-debug-writer",
+      (GThreadFunc) gst_debug_async_writer_func, log_file);
+}
+
+static void
+gst_debug_async_stop (void)
+{
+  if (async_writer == NULL)
+    return;
+
+  /* log synchronously from now on */
+  g_atomic_pointer_set (&async_log_file, NULL);
+  g_private_replace (&async_thread_ring, NULL);
+
+  g_mutex_lock (&async_lock);
+  async_stop = TRUE;
+  g_cond_signal (&async_cond);
+  g_mutex_unlock (&async_lock);
+
+  /* the writer drains the rings once more before exiting, the rings of
+   * threads that are still running are kept until they exit */
+  g_thread_join (async_writer);
+  async_writer = NULL;
+}
+
+/**
+ * gst_debug_log_default:
+ * @category: category to log
+ * @level: level of the message
+ * @file: the file that emitted the message, usually the __FILE__ identifier
+ * @function: the function that emitted the message
+ * @line: the line from that the message was emitted, usually __LINE__
+ * @message: the actual message
+ * @object: (transfer none) (allow-none): the object this message relates to,
+ *     or %NULL if none
+ * @user_data: the FILE* to log to
+ *
+ * The default logging handler used by GStreamer. Logging functions get called
+ * whenever a macro like GST_DEBUG or similar is used. By default this function
+ * is setup to output the message and additional info to stderr (or the log file
+ * specified via the GST_DEBUG_FILE environment variable) as received via
+ * @user_data.
+ *
+ * You can add other handlers by using gst_debug_add_log_function().
+ * And you can remove this handler by calling
+ * gst_debug_remove_log_function(gst_debug_log_default);
+ */
+void
+gst_debug_log_default (GstDebugCategory * category, GstDebugLevel level,
+    const gchar * file, const gchar * function, gint line,
+    GObject * object, GstDebugMessage * message, gpointer user_data)
+{
+  GstClockTime elapsed;
+  gchar *obj = NULL;
+  const gchar *message_str;
+  FILE *log_file = user_data ? user_data : stderr;
+
+#ifdef GST_ENABLE_EXTRA_CHECKS
+  g_warn_if_fail (object == NULL || G_IS_OBJECT (object));
+#endif
+
+  if (G_UNLIKELY (log_file == g_atomic_pointer_get (&async_log_file))) {
+    gst_debug_async_push (category, level, file, function, line, object,
+        message);
+    return;
+  }
+
+  _gst_debug_log_preamble (message, object, &file, &message_str, &obj,
+      &elapsed);
+
+  gst_debug_log_write (log_file, elapsed, g_thread_self (), category, level,
+      file, function, line, obj, message_str);
 
   if (object != NULL)
     g_free (obj);
@@ -2275,6 +2581,8 @@ _gst_debug_register_funcptr (GstDebugFuncPtr func, const gchar * ptrname)
 void
 _priv_gst_debug_cleanup (void)
 {
+  gst_debug_async_stop ();
+
   g_mutex_lock (&__dbg_functions_mutex);
 
   if (__gst_function_pointers) {
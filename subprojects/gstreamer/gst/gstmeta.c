@@ -54,6 +54,8 @@
 
 static GHashTable *metainfo = NULL;
 static GRWLock lock;
+/* size of the largest registered meta */
+static guint max_meta_size = 0; /* ATOMIC */
 
 GQuark _gst_meta_transform_copy;
 GQuark _gst_meta_tag_memory;
@@ -407,11 +409,20 @@ gst_meta_register (GType api, const gchar * impl, gsize size,
   g_rw_lock_writer_lock (&lock);
   g_hash_table_insert (metainfo, (gpointer) g_intern_string (impl),
       (gpointer) info);
+  if (size > max_meta_size)
+    g_atomic_int_set (&max_meta_size, size);
   g_rw_lock_writer_unlock (&lock);
 
   return info;
 }
 
+/* used by GstBuffer to size the storage of its metas */
+gsize
+_priv_gst_meta_get_max_size (void)
+{
+  return g_atomic_int_get (&max_meta_size);
+}
+
 /**
  * gst_meta_get_info:
  * @impl: the name
@@ -137,6 +137,9 @@ struct _GstPadPrivate
   GArray *events;
   guint last_cookie;
 
+  /* number of threads pushing or pulling through the pad and the
+   * PAD_USING_IDLE_PENDING flag, changed with atomic operations. Only
+   * gst_pad_push() lowers it without the LOCK, see pad_leave_unlocked() */
   gint using;
   guint probe_list_cookie;
 
@@ -1390,7 +1393,63 @@ cleanup_hook (GstPad * pad, GHook * hook)
     }
   }
   g_hook_destroy_link (&pad->probes, hook);
-  pad->num_probes--;
+  g_atomic_int_add (&pad->num_probes, -1);
+}
+
+/* set in priv->using when an idle probe was added while the pad was in use
+ * and has to be called by the last thread leaving the pad */
+#define PAD_USING_IDLE_PENDING (1 << 30)
+#define PAD_USING_COUNT(using) ((using) & ~PAD_USING_IDLE_PENDING)
+
+/* called with LOCK. Returns FALSE if the pad is idle, otherwise flags the
+ * pad so that the last thread leaving it calls the idle probes */
+static gboolean
+pad_mark_idle_pending (GstPad * pad)
+{
+  gint old;
+
+  do {
+    old = g_atomic_int_get (&pad->priv->using);
+    if (PAD_USING_COUNT (old) == 0)
+      return FALSE;
+  } while (!g_atomic_int_compare_and_exchange (&pad->priv->using, old,
+          old | PAD_USING_IDLE_PENDING));
+
+  return TRUE;
+}
+
+/* called with LOCK. Returns TRUE if the calling thread was the last one
+ * using the pad and has to call the idle probes */
+static inline gboolean
+pad_leave_locked (GstPad * pad)
+{
+  if (PAD_USING_COUNT (g_atomic_int_add (&pad->priv->using, -1)) == 1) {
+    g_atomic_int_and ((guint *) & pad->priv->using, ~PAD_USING_IDLE_PENDING);
+    return TRUE;
+  }
+  return FALSE;
+}
+
+/* called without LOCK. Only leaves the pad if there are no probes and no idle
+ * probe is pending, otherwise returns FALSE and the caller has to take the
+ * LOCK and use pad_leave_locked(). The compare-and-exchange fails if
+ * gst_pad_add_probe() flagged a pending idle probe in the meantime, so an
+ * idle probe is either called directly by gst_pad_add_probe() or by the
+ * leaving thread, never by both. */
+static inline gboolean
+pad_leave_unlocked (GstPad * pad)
+{
+  gint old;
+
+  do {
+    old = g_atomic_int_get (&pad->priv->using);
+    if ((old & PAD_USING_IDLE_PENDING) ||
+        g_atomic_int_get (&pad->num_probes) > 0)
+      return FALSE;
+  } while (!g_atomic_int_compare_and_exchange (&pad->priv->using, old,
+          old - 1));
+
+  return TRUE;
 }
 
 /**
@@ -1453,7 +1512,7 @@ gst_pad_add_probe (GstPad * pad, GstPadProbeType mask,
 
   /* add the probe */
   g_hook_append (&pad->probes, hook);
-  pad->num_probes++;
+  g_atomic_int_inc (&pad->num_probes);
   /* incremenent cookie so that the new hook gets called */
   pad->priv->probe_list_cookie++;
 
@@ -1476,7 +1535,9 @@ gst_pad_add_probe (GstPad * pad, GstPadProbeType mask,
 
   /* call the callback if we need to be called for idle callbacks */
   if ((mask & GST_PAD_PROBE_TYPE_IDLE) && (callback != NULL)) {
-    if (pad->priv->using > 0) {
+    /* gst_pad_push() can leave the pad without the LOCK, flagging the
+     * pending probe makes it take the LOCK and call the probe instead */
+    if (pad_mark_idle_pending (pad)) {
       /* the pad is in use, we can't signal the idle callback yet. Since we set the
        * flag above, the last thread to leave the push will do the callback. New
        * threads going into the push will block. */
@@ -4702,7 +4763,7 @@ gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
 
   /* take ref to peer pad before releasing the lock */
   gst_object_ref (peer);
-  pad->priv->using++;
+  g_atomic_int_inc (&pad->priv->using);
   GST_OBJECT_UNLOCK (pad);
 
   ret = gst_pad_chain_data_unchecked (peer, type, data);
@@ -4710,10 +4771,16 @@ gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
 
   gst_object_unref (peer);
 
+  /* without probes there are no idle callbacks to trigger and the lock
+   * is not needed again */
+  if (G_LIKELY (pad_leave_unlocked (pad))) {
+    g_atomic_int_set ((gint *) & pad->ABI.abi.last_flowret, ret);
+    return ret;
+  }
+
   GST_OBJECT_LOCK (pad);
   pad->ABI.abi.last_flowret = ret;
-  pad->priv->using--;
-  if (pad->priv->using == 0) {
+  if (pad_leave_locked (pad)) {
     /* pad is not active anymore, trigger idle callbacks */
     PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PUSH | GST_PAD_PROBE_TYPE_IDLE,
         probe_stopped, ret);
@@ -5156,7 +5223,7 @@ gst_pad_pull_range (GstPad * pad, guint64 offset, guint size,
     goto not_linked;
 
   gst_object_ref (peer);
-  pad->priv->using++;
+  g_atomic_int_inc (&pad->priv->using);
   GST_OBJECT_UNLOCK (pad);
 
   ret = gst_pad_get_range_unchecked (peer, offset, size, &res_buf);
@@ -5164,9 +5231,8 @@ gst_pad_pull_range (GstPad * pad, guint64 offset, guint size,
   gst_object_unref (peer);
 
   GST_OBJECT_LOCK (pad);
-  pad->priv->using--;
   pad->ABI.abi.last_flowret = ret;
-  if (pad->priv->using == 0) {
+  if (pad_leave_locked (pad)) {
     /* pad is not active anymore, trigger idle callbacks */
     PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PULL | GST_PAD_PROBE_TYPE_IDLE,
         probe_stopped_unref, ret);
@@ -5532,7 +5598,7 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
     goto not_linked;
 
   gst_object_ref (peerpad);
-  pad->priv->using++;
+  g_atomic_int_inc (&pad->priv->using);
   GST_OBJECT_UNLOCK (pad);
 
   GST_LOG_OBJECT (pad, "sending event %p (%s) to peerpad %" GST_PTR_FORMAT,
@@ -5549,8 +5615,7 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
   gst_object_unref (peerpad);
 
   GST_OBJECT_LOCK (pad);
-  pad->priv->using--;
-  if (pad->priv->using == 0) {
+  if (pad_leave_locked (pad)) {
     /* pad is not active anymore, trigger idle callbacks */
     PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PUSH | GST_PAD_PROBE_TYPE_IDLE,
         idle_probe_stopped, ret);
@@ -6545,8 +6610,9 @@ gst_pad_get_last_flow_return (GstPad * pad)
 {
   GstFlowReturn ret;
 
+  /* gst_pad_push() stores it atomically when it doesn't take the LOCK */
   GST_OBJECT_LOCK (pad);
-  ret = GST_PAD_LAST_FLOW_RETURN (pad);
+  ret = g_atomic_int_get ((gint *) & GST_PAD_LAST_FLOW_RETURN (pad));
   GST_OBJECT_UNLOCK (pad);
 
   return ret;
@@ -46,6 +46,9 @@
 
 #define GST_CAT_DEFAULT GST_CAT_REGISTRY
 
+/* protects loading the details of factories from the registry cache */
+static GMutex details_lock;
+
 /* count string length, but return -1 if we hit the eof */
 #ifdef HAVE_STRNLEN
 static inline gint
@@ -108,6 +111,19 @@ _strnlen (const gchar * str, gint maxlen)
   inptr += _len + 1; \
 }G_STMT_END
 
+#define skip_element(inptr, element, endptr, error_label) G_STMT_START{ \
+  if (inptr + sizeof(element) > endptr) \
+    goto error_label; \
+  inptr += sizeof (element); \
+}G_STMT_END
+
+#define skip_string(inptr, endptr, error_label)  G_STMT_START{\
+  gint _len = _strnlen (inptr, (endptr-inptr)); \
+  if (_len == -1) \
+    goto error_label; \
+  inptr += _len + 1; \
+}G_STMT_END
+
 #define ALIGNMENT            (sizeof (void *))
 #define alignment(_address)  (gsize)_address%ALIGNMENT
 #define align(_ptr)          _ptr += (( alignment(_ptr) == 0) ? 0 : ALIGNMENT-alignment(_ptr))
@@ -248,6 +264,8 @@ gst_registry_chunks_save_feature (GList ** list, GstPluginFeature * feature)
     GstRegistryChunkElementFactory *ef;
     GstElementFactory *factory = GST_ELEMENT_FACTORY (feature);
 
+    GST_FACTORY_LOAD_DETAILS (factory);
+
     /* Initialize with zeroes because of struct padding and
      * valgrind complaining about copying uninitialized memory
      */
@@ -308,6 +326,8 @@ gst_registry_chunks_save_feature (GList ** list, GstPluginFeature * feature)
     GstTypeFindFactory *factory = GST_TYPE_FIND_FACTORY (feature);
     gchar *str;
 
+    GST_FACTORY_LOAD_DETAILS (factory);
+
     /* Initialize with zeroes because of struct padding and
      * valgrind complaining about copying uninitialized memory
      */
@@ -547,6 +567,258 @@ fail:
   return FALSE;
 }
 
+/*
+ * gst_registry_chunks_load_element_factory:
+ *
+ * Load the metadata, pad templates, uri protocols and interfaces following
+ * the GstRegistryChunkElementFactory @ef into @factory.
+ */
+static gboolean
+gst_registry_chunks_load_element_factory (GstElementFactory * factory,
+    GstRegistryChunkElementFactory * ef, gchar ** in, gchar * end)
+{
+  const gchar *meta_data_str, *const_str;
+  gchar *str;
+  guint i, n;
+
+  /* unpack element factory strings */
+  unpack_string_nocopy (*in, meta_data_str, end, fail);
+  if (meta_data_str && *meta_data_str) {
+    factory->metadata = gst_structure_from_string (meta_data_str, NULL);
+    if (!factory->metadata) {
+      GST_ERROR
+          ("Error when trying to deserialize structure for metadata '%s'",
+          meta_data_str);
+      goto fail;
+    }
+  }
+  n = ef->npadtemplates;
+  GST_DEBUG ("Element factory : npadtemplates=%d", n);
+
+  /* load pad templates */
+  for (i = 0; i < n; i++) {
+    if (G_UNLIKELY (!gst_registry_chunks_load_pad_template (factory, in,
+                end))) {
+      GST_ERROR ("Error while loading binary pad template");
+      goto fail;
+    }
+  }
+
+  /* load uritypes */
+  if (G_UNLIKELY ((n = ef->nuriprotocols))) {
+    GST_DEBUG ("Reading %d UriTypes at address %p", n, *in);
+
+    align (*in);
+    factory->uri_type = *((guint *) * in);
+    *in += sizeof (factory->uri_type);
+    /*unpack_element(*in, &factory->uri_type, factory->uri_type, end, fail); */
+
+    factory->uri_protocols = g_new0 (gchar *, n + 1);
+    for (i = 0; i < n; i++) {
+      unpack_string (*in, str, end, fail);
+      factory->uri_protocols[i] = str;
+    }
+  }
+  /* load interfaces */
+  if (G_UNLIKELY ((n = ef->ninterfaces))) {
+    GST_DEBUG ("Reading %d Interfaces at address %p", n, *in);
+    for (i = 0; i < n; i++) {
+      unpack_string_nocopy (*in, const_str, end, fail);
+      __gst_element_factory_add_interface (factory, const_str);
+    }
+  }
+  return TRUE;
+
+fail:
+  GST_INFO ("Reading element factory details failed");
+  return FALSE;
+}
+
+/*
+ * gst_registry_chunks_skip_element_factory:
+ *
+ * Check that the data following the GstRegistryChunkElementFactory @ef is
+ * complete and move @in past it without loading anything.
+ */
+static gboolean
+gst_registry_chunks_skip_element_factory (GstRegistryChunkElementFactory * ef,
+    gchar ** in, gchar * end)
+{
+  guint i;
+
+  skip_string (*in, end, fail);
+  for (i = 0; i < ef->npadtemplates; i++) {
+    align (*in);
+    skip_element (*in, GstRegistryChunkPadTemplate, end, fail);
+    skip_string (*in, end, fail);
+    skip_string (*in, end, fail);
+  }
+  if (ef->nuriprotocols) {
+    align (*in);
+    skip_element (*in, GstURIType, end, fail);
+    for (i = 0; i < ef->nuriprotocols; i++)
+      skip_string (*in, end, fail);
+  }
+  for (i = 0; i < ef->ninterfaces; i++)
+    skip_string (*in, end, fail);
+  return TRUE;
+
+fail:
+  GST_INFO ("Reading element factory details failed");
+  return FALSE;
+}
+
+/*
+ * gst_registry_chunks_load_type_find_factory:
+ *
+ * Load the caps and extensions following the GstRegistryChunkTypeFindFactory
+ * @tff into @factory.
+ */
+static gboolean
+gst_registry_chunks_load_type_find_factory (GstTypeFindFactory * factory,
+    GstRegistryChunkTypeFindFactory * tff, gchar ** in, gchar * end)
+{
+  const gchar *const_str;
+  gchar *str;
+  guint i;
+
+  /* load typefinder caps */
+  unpack_string_nocopy (*in, const_str, end, fail);
+  if (const_str != NULL && *const_str != '\0')
+    factory->caps = gst_caps_from_string (const_str);
+  else
+    factory->caps = NULL;
+
+  /* load extensions */
+  if (tff->nextensions) {
+    GST_DEBUG ("Reading %d Typefind extensions at address %p",
+        tff->nextensions, *in);
+    factory->extensions = g_new0 (gchar *, tff->nextensions + 1);
+    /* unpack in reverse order to maintain the correct order */
+    for (i = tff->nextensions; i > 0; i--) {
+      unpack_string (*in, str, end, fail);
+      factory->extensions[i - 1] = str;
+    }
+  }
+  return TRUE;
+
+fail:
+  GST_INFO ("Reading typefind factory details failed");
+  return FALSE;
+}
+
+/*
+ * gst_registry_chunks_skip_type_find_factory:
+ *
+ * Check that the data following the GstRegistryChunkTypeFindFactory @tff is
+ * complete and move @in past it without loading anything.
+ */
+static gboolean
+gst_registry_chunks_skip_type_find_factory (GstRegistryChunkTypeFindFactory *
+    tff, gchar ** in, gchar * end)
+{
+  guint i;
+
+  skip_string (*in, end, fail);
+  for (i = 0; i < tff->nextensions; i++)
+    skip_string (*in, end, fail);
+  return TRUE;
+
+fail:
+  GST_INFO ("Reading typefind factory details failed");
+  return FALSE;
+}
+
+/*
+ * _priv_gst_registry_chunks_load_details:
+ *
+ * Load the details of an element or typefind factory that were skipped when
+ * reading the registry cache, see GST_FACTORY_LOAD_DETAILS().
+ */
+static gboolean
+gst_registry_chunks_get_details (GstPluginFeature * feature, GBytes *** cache,
+    gpointer ** chunk)
+{
+  if (GST_IS_ELEMENT_FACTORY (feature)) {
+    *cache = &GST_ELEMENT_FACTORY_CAST (feature)->registry_cache;
+    *chunk = &GST_ELEMENT_FACTORY_CAST (feature)->registry_chunk;
+  } else if (GST_IS_TYPE_FIND_FACTORY (feature)) {
+    *cache = &GST_TYPE_FIND_FACTORY (feature)->registry_cache;
+    *chunk = &GST_TYPE_FIND_FACTORY (feature)->registry_chunk;
+  } else {
+    return FALSE;
+  }
+  return TRUE;
+}
+
+void
+_priv_gst_registry_chunks_load_details (GstPluginFeature * feature)
+{
+  GBytes **cache, *data = NULL;
+  gpointer *chunk;
+
+  if (!gst_registry_chunks_get_details (feature, &cache, &chunk))
+    g_return_if_reached ();
+
+  g_mutex_lock (&details_lock);
+  if (*chunk) {
+    gsize size;
+    gchar *end, *in;
+    gboolean res;
+
+    end = (gchar *) g_bytes_get_data (*cache, &size) + size;
+    if (GST_IS_ELEMENT_FACTORY (feature)) {
+      GstRegistryChunkElementFactory *ef = *chunk;
+
+      in = (gchar *) (ef + 1);
+      res = gst_registry_chunks_load_element_factory
+          (GST_ELEMENT_FACTORY_CAST (feature), ef, &in, end);
+    } else {
+      GstRegistryChunkTypeFindFactory *tff = *chunk;
+
+      in = (gchar *) (tff + 1);
+      res = gst_registry_chunks_load_type_find_factory
+          (GST_TYPE_FIND_FACTORY (feature), tff, &in, end);
+    }
+    if (G_UNLIKELY (!res))
+      GST_ERROR_OBJECT (feature, "Error while loading details from registry");
+
+    data = *cache;
+    *cache = NULL;
+    g_atomic_pointer_set (chunk, NULL);
+  }
+  g_mutex_unlock (&details_lock);
+
+  if (data)
+    g_bytes_unref (data);
+}
+
+/*
+ * _priv_gst_registry_chunks_unload_details:
+ *
+ * Drop the details of an element or typefind factory that were not loaded
+ * yet, when the factory is cleaned up. A load running in another thread is
+ * finished first.
+ */
+void
+_priv_gst_registry_chunks_unload_details (GstPluginFeature * feature)
+{
+  GBytes **cache, *data;
+  gpointer *chunk;
+
+  if (!gst_registry_chunks_get_details (feature, &cache, &chunk))
+    g_return_if_reached ();
+
+  g_mutex_lock (&details_lock);
+  data = *cache;
+  *cache = NULL;
+  g_atomic_pointer_set (chunk, NULL);
+  g_mutex_unlock (&details_lock);
+
+  if (data)
+    g_bytes_unref (data);
+}
+
 /*
  * gst_registry_chunks_load_feature:
  *
@@ -556,16 +828,14 @@ fail:
  */
 static gboolean
 gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
-    gchar * end, GstPlugin * plugin)
+    gchar * end, GstPlugin * plugin, GBytes * cache)
 {
   GstRegistryChunkPluginFeature *pf = NULL;
   GstPluginFeature *feature = NULL;
-  const gchar *const_str, *type_name;
+  const gchar *type_name;
   const gchar *feature_name;
   const gchar *plugin_name;
-  gchar *str;
   GType type;
-  guint i;
 
   plugin_name = plugin->desc.name;
 
@@ -601,10 +871,7 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
 
   if (GST_IS_ELEMENT_FACTORY (feature)) {
     GstRegistryChunkElementFactory *ef;
-    guint n;
     GstElementFactory *factory = GST_ELEMENT_FACTORY_CAST (feature);
-    gchar *str;
-    const gchar *meta_data_str;
 
     align (*in);
     GST_LOG ("Reading/casting for GstRegistryChunkElementFactory at address %p",
@@ -612,51 +879,15 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
     unpack_element (*in, ef, GstRegistryChunkElementFactory, end, fail);
     pf = (GstRegistryChunkPluginFeature *) ef;
 
-    /* unpack element factory strings */
-    unpack_string_nocopy (*in, meta_data_str, end, fail);
-    if (meta_data_str && *meta_data_str) {
-      factory->metadata = gst_structure_from_string (meta_data_str, NULL);
-      if (!factory->metadata) {
-        GST_ERROR
-            ("Error when trying to deserialize structure for metadata '%s'",
-            meta_data_str);
+    if (cache) {
+      if (G_UNLIKELY (!gst_registry_chunks_skip_element_factory (ef, in,
+                  end)))
         goto fail;
-      }
-    }
-    n = ef->npadtemplates;
-    GST_DEBUG ("Element factory : npadtemplates=%d", n);
-
-    /* load pad templates */
-    for (i = 0; i < n; i++) {
-      if (G_UNLIKELY (!gst_registry_chunks_load_pad_template (factory, in,
-                  end))) {
-        GST_ERROR ("Error while loading binary pad template");
-        goto fail;
-      }
-    }
-
-    /* load uritypes */
-    if (G_UNLIKELY ((n = ef->nuriprotocols))) {
-      GST_DEBUG ("Reading %d UriTypes at address %p", n, *in);
-
-      align (*in);
-      factory->uri_type = *((guint *) * in);
-      *in += sizeof (factory->uri_type);
-      /*unpack_element(*in, &factory->uri_type, factory->uri_type, end, fail); */
-
-      factory->uri_protocols = g_new0 (gchar *, n + 1);
-      for (i = 0; i < n; i++) {
-        unpack_string (*in, str, end, fail);
-        factory->uri_protocols[i] = str;
-      }
-    }
-    /* load interfaces */
-    if (G_UNLIKELY ((n = ef->ninterfaces))) {
-      GST_DEBUG ("Reading %d Interfaces at address %p", n, *in);
-      for (i = 0; i < n; i++) {
-        unpack_string_nocopy (*in, const_str, end, fail);
-        __gst_element_factory_add_interface (factory, const_str);
-      }
+      factory->registry_cache = g_bytes_ref (cache);
+      factory->registry_chunk = ef;
+    } else if (G_UNLIKELY (!gst_registry_chunks_load_element_factory (factory,
+                ef, in, end))) {
+      goto fail;
     }
   } else if (GST_IS_TYPE_FIND_FACTORY (feature)) {
     GstRegistryChunkTypeFindFactory *tff;
@@ -669,23 +900,15 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
     unpack_element (*in, tff, GstRegistryChunkTypeFindFactory, end, fail);
     pf = (GstRegistryChunkPluginFeature *) tff;
 
-    /* load typefinder caps */
-    unpack_string_nocopy (*in, const_str, end, fail);
-    if (const_str != NULL && *const_str != '\0')
-      factory->caps = gst_caps_from_string (const_str);
-    else
-      factory->caps = NULL;
-
-    /* load extensions */
-    if (tff->nextensions) {
-      GST_DEBUG ("Reading %d Typefind extensions at address %p",
-          tff->nextensions, *in);
-      factory->extensions = g_new0 (gchar *, tff->nextensions + 1);
-      /* unpack in reverse order to maintain the correct order */
-      for (i = tff->nextensions; i > 0; i--) {
-        unpack_string (*in, str, end, fail);
-        factory->extensions[i - 1] = str;
-      }
+    if (cache) {
+      if (G_UNLIKELY (!gst_registry_chunks_skip_type_find_factory (tff, in,
+                  end)))
+        goto fail;
+      factory->registry_cache = g_bytes_ref (cache);
+      factory->registry_chunk = tff;
+    } else if (G_UNLIKELY (!gst_registry_chunks_load_type_find_factory
+            (factory, tff, in, end))) {
+      goto fail;
     }
   } else if (GST_IS_DEVICE_PROVIDER_FACTORY (feature)) {
     GstRegistryChunkDeviceProviderFactory *dmf;
@@ -820,10 +1043,13 @@ fail:
  * Make a new GstPlugin from current GstRegistryChunkPluginElement structure
  * and add it to the GstRegistry. Return an offset to the next
  * GstRegistryChunkPluginElement structure.
+ *
+ * When @cache holds the data @in points into, the details of element and
+ * typefind factories are only loaded from it when they are first used.
  */
 gboolean
 _priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
-    gchar * end, GstPlugin ** out_plugin)
+    gchar * end, GstPlugin ** out_plugin, GBytes * cache)
 {
 #ifndef GST_DISABLE_GST_DEBUG
   gchar *start = *in;
@@ -890,7 +1116,7 @@ _priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
   /* Load plugin features */
   for (i = 0; i < n; i++) {
     if (G_UNLIKELY (!gst_registry_chunks_load_feature (registry, in, end,
-                plugin))) {
+                plugin, cache))) {
       GST_ERROR ("Error while loading binary feature for plugin '%s'",
           GST_STR_NULL (plugin->desc.name));
       gst_registry_remove_plugin (registry, plugin);
@@ -173,7 +173,7 @@ _priv_gst_registry_chunks_save_plugin (GList ** list, GstRegistry * registry,
 
 gboolean
 _priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
-    gchar *end, GstPlugin **out_plugin);
+    gchar *end, GstPlugin **out_plugin, GBytes * cache);
 
 void
 _priv_gst_registry_chunks_save_global_header (GList ** list,
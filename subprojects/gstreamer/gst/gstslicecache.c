@@ -0,0 +1,316 @@
+/* GStreamer
+ * Copyright (C) 2022 GStreamer developers
+ *
+ * gstslicecache.c: per-thread recycling of fixed-size structures
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The structures of the most frequently created mini objects are recycled
+ * through a magazine cache. Every thread owns one magazine per cache, a
+ * singly linked list of up to MAGAZINE_SIZE free blocks, which it allocates
+ * from and frees to without any locking.
+ *
+ * Objects are often allocated in one thread and freed in another one. To make
+ * this work, a thread that fills its magazine hands it over to the depot of
+ * the cache, from which a thread with an empty magazine takes it again. The
+ * depot holds at most DEPOT_SIZE magazines; when it is full, the blocks are
+ * released to the system allocator.
+ *
+ * Free blocks are linked through their first pointer. The first block of a
+ * magazine in the depot links to the next magazine with its second pointer.
+ */
+
+#include "gst_private.h"
+
+#define MAGAZINE_SIZE   32
+#define DEPOT_SIZE      16
+
+#define NEXT_BLOCK(b)    (((gpointer *) (b))[0])
+#define NEXT_MAGAZINE(b) (((gpointer *) (b))[1])
+
+typedef struct
+{
+  gpointer head;
+  guint n_blocks;
+  gsize size;
+
+  /* counters not yet added to the cache totals */
+  guint64 hits;
+  guint64 misses;
+} GstSliceMagazine;
+
+typedef struct
+{
+  GstSliceMagazine magazines[GST_SLICE_CACHE_LAST];
+} GstSliceThreadCache;
+
+typedef struct
+{
+  const gchar *name;
+
+  GMutex lock;
+  gpointer depot;
+  guint n_depot;
+  gsize size;
+
+  guint64 hits;
+  guint64 misses;
+  guint64 released;
+} GstSliceCache;
+
+static GstSliceCache caches[GST_SLICE_CACHE_LAST] = {
+  {"buffer",},
+  {"event",},
+  {"memory",},
+};
+
+static gboolean cache_enabled = FALSE;
+
+static void gst_slice_thread_cache_free (GstSliceThreadCache * tcache);
+
+static GPrivate thread_cache =
+G_PRIVATE_INIT ((GDestroyNotify) gst_slice_thread_cache_free);
+
+static void
+release_blocks (gpointer head, gsize size)
+{
+  gpointer next;
+
+  for (; head; head = next) {
+    next = NEXT_BLOCK (head);
+    g_slice_free1 (size, head);
+  }
+}
+
+/* with the cache lock */
+static inline void
+flush_counters (GstSliceCache * cache, GstSliceMagazine * mag)
+{
+  cache->hits += mag->hits;
+  cache->misses += mag->misses;
+  mag->hits = mag->misses = 0;
+}
+
+/* hand a full magazine to the depot or release its blocks when the depot is
+ * full. Leaves @mag empty. With the cache lock. */
+static void
+put_magazine (GstSliceCache * cache, GstSliceMagazine * mag)
+{
+  if (mag->n_blocks == MAGAZINE_SIZE && cache->n_depot < DEPOT_SIZE) {
+    cache->size = mag->size;
+    NEXT_MAGAZINE (mag->head) = cache->depot;
+    cache->depot = mag->head;
+    cache->n_depot++;
+  } else {
+    release_blocks (mag->head, mag->size);
+    cache->released += mag->n_blocks;
+  }
+  mag->head = NULL;
+  mag->n_blocks = 0;
+}
+
+static void
+gst_slice_thread_cache_free (GstSliceThreadCache * tcache)
+{
+  gint i;
+
+  for (i = 0; i < GST_SLICE_CACHE_LAST; i++) {
+    GstSliceCache *cache = &caches[i];
+    GstSliceMagazine *mag = &tcache->magazines[i];
+
+    g_mutex_lock (&cache->lock);
+    flush_counters (cache, mag);
+    if (mag->head)
+      put_magazine (cache, mag);
+    g_mutex_unlock (&cache->lock);
+  }
+  g_free (tcache);
+}
+
+static inline GstSliceMagazine *
+get_magazine (GstSliceCacheId id)
+{
+  GstSliceThreadCache *tcache = g_private_get (&thread_cache);
+
+  if (G_UNLIKELY (tcache == NULL)) {
+    tcache = g_new0 (GstSliceThreadCache, 1);
+    g_private_set (&thread_cache, tcache);
+  }
+  return &tcache->magazines[id];
+}
+
+void
+_priv_gst_slice_cache_initialize (void)
+{
+  const gchar *env = g_getenv ("G_SLICE");
+  gint i;
+
+  for (i = 0; i < GST_SLICE_CACHE_LAST; i++)
+    g_mutex_init (&caches[i].lock);
+
+  /* keep every allocation visible to memory checkers */
+  cache_enabled = !(env && (strstr (env, "always-malloc")
+          || strstr (env, "debug-blocks")));
+}
+
+void
+_priv_gst_slice_cache_cleanup (void)
+{
+  GstSliceThreadCache *tcache;
+  gint i;
+
+  if ((tcache = g_private_get (&thread_cache))) {
+    g_private_set (&thread_cache, NULL);
+    gst_slice_thread_cache_free (tcache);
+  }
+
+  for (i = 0; i < GST_SLICE_CACHE_LAST; i++) {
+    GstSliceCache *cache = &caches[i];
+    gpointer mag, next;
+
+    g_mutex_lock (&cache->lock);
+    for (mag = cache->depot; mag; mag = next) {
+      next = NEXT_MAGAZINE (mag);
+      release_blocks (mag, cache->size);
+    }
+    cache->depot = NULL;
+    cache->n_depot = 0;
+    g_mutex_unlock (&cache->lock);
+  }
+}
+
+/*
+ * _priv_gst_slice_cache_alloc:
+ * @id: the cache to use
+ * @size: the size of the blocks of @id
+ *
+ * Allocates a block of @size bytes, preferably from the magazine of the
+ * current thread.
+ */
+gpointer
+_priv_gst_slice_cache_alloc (GstSliceCacheId id, gsize size)
+{
+  GstSliceMagazine *mag;
+  gpointer block;
+
+  if (G_UNLIKELY (!cache_enabled))
+    return g_slice_alloc (size);
+
+  mag = get_magazine (id);
+  if (G_UNLIKELY (mag->head == NULL)) {
+    GstSliceCache *cache = &caches[id];
+
+    /* racy check, we just allocate when we miss a magazine that is being
+     * put into the depot */
+    if (g_atomic_int_get (&cache->n_depot) == 0) {
+      mag->misses++;
+      return g_slice_alloc (size);
+    }
+
+    g_mutex_lock (&cache->lock);
+    flush_counters (cache, mag);
+    if (cache->depot) {
+      mag->head = cache->depot;
+      mag->n_blocks = MAGAZINE_SIZE;
+      mag->size = size;
+      cache->depot = NEXT_MAGAZINE (mag->head);
+      cache->n_depot--;
+    }
+    g_mutex_unlock (&cache->lock);
+
+    if (mag->head == NULL) {
+      mag->misses++;
+      return g_slice_alloc (size);
+    }
+  }
+
+  block = mag->head;
+  mag->head = NEXT_BLOCK (block);
+  mag->n_blocks--;
+  mag->hits++;
+
+  return block;
+}
+
+/*
+ * _priv_gst_slice_cache_free:
+ * @id: the cache to use
+ * @size: the size of the blocks of @id
+ * @block: a block of @size bytes
+ *
+ * Puts @block into the magazine of the current thread for reuse. @block must
+ * have been allocated with _priv_gst_slice_cache_alloc() or g_slice_alloc()
+ * with the same @size.
+ */
+void
+_priv_gst_slice_cache_free (GstSliceCacheId id, gsize size, gpointer block)
+{
+  GstSliceMagazine *mag;
+
+  if (G_UNLIKELY (!cache_enabled)) {
+    g_slice_free1 (size, block);
+    return;
+  }
+
+  mag = get_magazine (id);
+  if (G_UNLIKELY (mag->n_blocks == MAGAZINE_SIZE)) {
+    GstSliceCache *cache = &caches[id];
+
+    g_mutex_lock (&cache->lock);
+    flush_counters (cache, mag);
+    put_magazine (cache, mag);
+    g_mutex_unlock (&cache->lock);
+  }
+
+  NEXT_BLOCK (block) = mag->head;
+  mag->head = block;
+  mag->n_blocks++;
+  mag->size = size;
+}
+
+/* Returns a newly allocated structure with the counters of all caches */
+GstStructure *
+_priv_gst_slice_cache_get_stats (void)
+{
+  GstStructure *stats;
+  GstSliceThreadCache *tcache;
+  gint i;
+
+  tcache = cache_enabled ? g_private_get (&thread_cache) : NULL;
+
+  stats = gst_structure_new_empty ("slice-cache-stats");
+  for (i = 0; i < GST_SLICE_CACHE_LAST; i++) {
+    GstSliceCache *cache = &caches[i];
+    GstStructure *s;
+
+    g_mutex_lock (&cache->lock);
+    /* other threads add their counters when they exchange a magazine with the
+     * depot, include those of the current thread to be exact for it */
+    if (tcache)
+      flush_counters (cache, &tcache->magazines[i]);
+    s = gst_structure_new (cache->name,
+        "hits", G_TYPE_UINT64, cache->hits,
+        "misses", G_TYPE_UINT64, cache->misses,
+        "released", G_TYPE_UINT64, cache->released,
+        "cached", G_TYPE_UINT, cache->n_depot * MAGAZINE_SIZE, NULL);
+    g_mutex_unlock (&cache->lock);
+
+    gst_structure_set (stats, cache->name, GST_TYPE_STRUCTURE, s, NULL);
+    gst_structure_free (s);
+  }
+  return stats;
+}
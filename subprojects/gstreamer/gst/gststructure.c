@@ -171,6 +171,12 @@ typedef struct
    *  else it's a pointer to the arr field. */
   GstStructureField *fields;
 
+  /* Hash index of the fields once there are STRUCTURE_INDEX_MIN_FIELDS of
+   * them, NULL before. Open addressing with linear probing, each slot holds
+   * the position in fields plus one, or 0 when it is free. */
+  guint32 *index;
+  guint index_shift;            /* 32 - log2 (number of slots) */
+
   GstStructureField arr[1];
 } GstStructureImpl;
 
@@ -190,6 +196,97 @@ typedef struct
 #define IS_TAGLIST(structure) \
     (structure->name == GST_QUARK (TAGLIST))
 
+/* Looking through a few fields is faster than hashing, and most structures
+ * are small */
+#define STRUCTURE_INDEX_MIN_FIELDS 16
+
+#define INDEX_SIZE(impl) (1u << (32 - (impl)->index_shift))
+
+static inline guint
+_structure_index_slot (GstStructureImpl * impl, GQuark name)
+{
+  return ((guint32) name * 0x9E3779B1u) >> impl->index_shift;
+}
+
+static void
+_structure_index_insert (GstStructureImpl * impl, guint idx)
+{
+  guint mask = INDEX_SIZE (impl) - 1;
+  guint slot = _structure_index_slot (impl, impl->fields[idx].name);
+
+  while (impl->index[slot])
+    slot = (slot + 1) & mask;
+  impl->index[slot] = idx + 1;
+}
+
+/* (re)builds the index with at most half of the slots used */
+static void
+_structure_index_build (GstStructureImpl * impl)
+{
+  guint i, bits = 5;
+
+  while ((1u << bits) < impl->fields_len * 2)
+    bits++;
+
+  g_free (impl->index);
+  impl->index = g_new0 (guint32, 1u << bits);
+  impl->index_shift = 32 - bits;
+
+  for (i = 0; i < impl->fields_len; i++)
+    _structure_index_insert (impl, i);
+}
+
+static inline GstStructureField *
+_structure_index_lookup (GstStructureImpl * impl, GQuark name)
+{
+  guint mask = INDEX_SIZE (impl) - 1;
+  guint slot = _structure_index_slot (impl, name);
+  guint32 entry;
+
+  while ((entry = impl->index[slot])) {
+    GstStructureField *field = &impl->fields[entry - 1];
+
+    if (field->name == name)
+      return field;
+    slot = (slot + 1) & mask;
+  }
+
+  return NULL;
+}
+
+/* Removes the field at @idx from the index and renumbers the fields after it,
+ * before it is removed from the fields */
+static void
+_structure_index_remove (GstStructureImpl * impl, guint idx)
+{
+  guint mask = INDEX_SIZE (impl) - 1;
+  guint i, j, home;
+
+  i = _structure_index_slot (impl, impl->fields[idx].name);
+  while (impl->index[i] != idx + 1)
+    i = (i + 1) & mask;
+
+  /* move later entries of the probe sequence into the hole, so that lookups
+   * don't stop at it */
+  j = i;
+  while (TRUE) {
+    j = (j + 1) & mask;
+    if (!impl->index[j])
+      break;
+    home = _structure_index_slot (impl, impl->fields[impl->index[j] - 1].name);
+    if (i <= j ? (home <= i || home > j) : (home <= i && home > j)) {
+      impl->index[i] = impl->index[j];
+      i = j;
+    }
+  }
+  impl->index[i] = 0;
+
+  for (i = 0; i <= mask; i++) {
+    if (impl->index[i] > idx + 1)
+      impl->index[i]--;
+  }
+}
+
 /* Replacement for g_array_append_val */
 static void
 _structure_append_val (GstStructure * s, GstStructureField * val)
@@ -218,6 +315,15 @@ _structure_append_val (GstStructure * s, GstStructureField * val)
 
   /* Finally set value */
   impl->fields[impl->fields_len++] = *val;
+
+  if (impl->index) {
+    if (impl->fields_len * 2 > INDEX_SIZE (impl))
+      _structure_index_build (impl);
+    else
+      _structure_index_insert (impl, impl->fields_len - 1);
+  } else if (impl->fields_len >= STRUCTURE_INDEX_MIN_FIELDS) {
+    _structure_index_build (impl);
+  }
 }
 
 /* Replacement for g_array_remove_index */
@@ -230,6 +336,15 @@ _structure_remove_index (GstStructure * s, guint idx)
   if (idx >= impl->fields_len)
     return;
 
+  if (impl->index) {
+    if (impl->fields_len - 1 < STRUCTURE_INDEX_MIN_FIELDS / 2) {
+      g_free (impl->index);
+      impl->index = NULL;
+    } else {
+      _structure_index_remove (impl, idx);
+    }
+  }
+
   /* Shift everything if it's not the last item */
   if (idx != impl->fields_len)
     memmove (&impl->fields[idx],
@@ -540,6 +655,7 @@ gst_structure_free (GstStructure * structure)
   }
   if (GST_STRUCTURE_IS_USING_DYNAMIC_ARRAY (structure))
     g_free (((GstStructureImpl *) structure)->fields);
+  g_free (((GstStructureImpl *) structure)->index);
 
 #ifdef USE_POISONING
   memset (structure, 0xff, sizeof (GstStructure));
@@ -1010,9 +1126,6 @@ gst_structure_set_field (GstStructure * structure, GstStructureField * field)
 {
   GstStructureField *f;
   GType field_value_type;
-  guint i, len;
-
-  len = GST_STRUCTURE_LEN (structure);
 
   field_value_type = G_VALUE_TYPE (&field->value);
   if (field_value_type == G_TYPE_STRING) {
@@ -1063,14 +1176,11 @@ gst_structure_set_field (GstStructure * structure, GstStructureField * field)
     }
   }
 
-  for (i = 0; i < len; i++) {
-    f = GST_STRUCTURE_FIELD (structure, i);
-
-    if (G_UNLIKELY (f->name == field->name)) {
-      g_value_unset (&f->value);
-      memcpy (f, field, sizeof (GstStructureField));
-      return;
-    }
+  f = gst_structure_id_get_field (structure, field->name);
+  if (f) {
+    g_value_unset (&f->value);
+    memcpy (f, field, sizeof (GstStructureField));
+    return;
   }
 
   _structure_append_val (structure, field);
@@ -1081,9 +1191,13 @@ gst_structure_set_field (GstStructure * structure, GstStructureField * field)
 static GstStructureField *
 gst_structure_id_get_field (const GstStructure * structure, GQuark field_id)
 {
+  GstStructureImpl *impl = (GstStructureImpl *) structure;
   GstStructureField *field;
   guint i, len;
 
+  if (impl->index)
+    return _structure_index_lookup (impl, field_id);
+
   len = GST_STRUCTURE_LEN (structure);
 
   for (i = 0; i < len; i++) {
@@ -1172,26 +1286,21 @@ gst_structure_remove_field (GstStructure * structure, const gchar * fieldname)
 {
   GstStructureField *field;
   GQuark id;
-  guint i, len;
 
   g_return_if_fail (structure != NULL);
   g_return_if_fail (fieldname != NULL);
   g_return_if_fail (IS_MUTABLE (structure));
 
   id = g_quark_from_string (fieldname);
-  len = GST_STRUCTURE_LEN (structure);
-
-  for (i = 0; i < len; i++) {
-    field = GST_STRUCTURE_FIELD (structure, i);
+  field = gst_structure_id_get_field (structure, id);
+  if (field == NULL)
+    return;
 
-    if (field->name == id) {
-      if (G_IS_VALUE (&field->value)) {
-        g_value_unset (&field->value);
-      }
-      _structure_remove_index (structure, i);
-      return;
-    }
+  if (G_IS_VALUE (&field->value)) {
+    g_value_unset (&field->value);
   }
+  _structure_remove_index (structure, field - GST_STRUCTURE_FIELD (structure,
+          0));
 }
 
 /**
@@ -3138,6 +3247,7 @@ gst_structure_intersect (const GstStructure * struct1,
 {
   guint it1, len1, it2, len2;
   GstStructure *dest;
+  GstStructureField *field1, *field2;
 
   g_assert (struct1 != NULL);
   g_assert (struct2 != NULL);
@@ -3154,44 +3264,30 @@ gst_structure_intersect (const GstStructure * struct1,
   /* copy fields from struct1 which we have not in struct2 to target
    * intersect if we have the field in both */
   for (it1 = 0; it1 < len1; it1++) {
-    GstStructureField *field1 = GST_STRUCTURE_FIELD (struct1, it1);
-    gboolean seenother = FALSE;
-    for (it2 = 0; it2 < len2; it2++) {
-      GstStructureField *field2 = GST_STRUCTURE_FIELD (struct2, it2);
-      if (field1->name == field2->name) {
-        GValue dest_value = { 0 };
-        seenother = TRUE;
-        /* Get the intersection if any */
-        if (gst_value_intersect (&dest_value, &field1->value, &field2->value)) {
-          gst_structure_id_take_value (dest, field1->name, &dest_value);
-          break;
-        } else {
-          /* No intersection, return nothing */
-          goto error;
-        }
+    field1 = GST_STRUCTURE_FIELD (struct1, it1);
+    field2 = gst_structure_id_get_field (struct2, field1->name);
+    if (field2) {
+      GValue dest_value = { 0 };
+      /* Get the intersection if any */
+      if (gst_value_intersect (&dest_value, &field1->value, &field2->value)) {
+        gst_structure_id_take_value (dest, field1->name, &dest_value);
+      } else {
+        /* No intersection, return nothing */
+        goto error;
       }
-    }
-    /* Field1 was only present in struct1, copy it over */
-    if (!seenother)
+    } else {
+      /* Field1 was only present in struct1, copy it over */
       gst_structure_id_set_value (dest, field1->name, &field1->value);
+    }
   }
 
   /* Now iterate over the 2nd struct and copy over everything which
    * isn't present in the 1st struct (we've already taken care of
    * values being present in both just above) */
   for (it2 = 0; it2 < len2; it2++) {
-    GstStructureField *field2 = GST_STRUCTURE_FIELD (struct2, it2);
-    gboolean seenother = FALSE;
-    for (it1 = 0; it1 < len1; it1++) {
-      GstStructureField *field1 = GST_STRUCTURE_FIELD (struct1, it1);
-      if (field1->name == field2->name) {
-        seenother = TRUE;
-        break;
-      }
-    }
-    if (!seenother)
+    field2 = GST_STRUCTURE_FIELD (struct2, it2);
+    if (!gst_structure_id_get_field (struct1, field2->name))
       gst_structure_id_set_value (dest, field2->name, &field2->value);
-
   }
 
   return dest;
@@ -3268,7 +3364,7 @@ gboolean
 gst_structure_is_subset (const GstStructure * subset,
     const GstStructure * superset)
 {
-  guint it1, len1, it2, len2;
+  guint len1, it2, len2;
 
   g_assert (superset);
 
@@ -3282,32 +3378,27 @@ gst_structure_is_subset (const GstStructure * subset,
 
   for (it2 = 0; it2 < len2; it2++) {
     GstStructureField *superfield = GST_STRUCTURE_FIELD (superset, it2);
-    gboolean seenother = FALSE;
-    for (it1 = 0; it1 < len1; it1++) {
-      GstStructureField *subfield = GST_STRUCTURE_FIELD (subset, it1);
-      if (subfield->name == superfield->name) {
-        int comparison =
-            gst_value_compare (&subfield->value, &superfield->value);
-        seenother = TRUE;
-
-        /* If present and equal, stop iterating */
-        if (comparison == GST_VALUE_EQUAL)
-          break;
-
-        /* Stop everything if ordered but unequal */
-        if (comparison != GST_VALUE_UNORDERED)
-          return FALSE;
+    GstStructureField *subfield;
+    int comparison;
 
-        /* Stop everything if not a subset */
-        if (!gst_value_is_subset (&subfield->value, &superfield->value))
-          return FALSE;
-
-        break;
-      }
-    }
+    subfield = gst_structure_id_get_field (subset, superfield->name);
 
     /* We did not see superfield in subfield */
-    if (!seenother)
+    if (!subfield)
+      return FALSE;
+
+    comparison = gst_value_compare (&subfield->value, &superfield->value);
+
+    /* If present and equal, go on with the next field */
+    if (comparison == GST_VALUE_EQUAL)
+      continue;
+
+    /* Stop everything if ordered but unequal */
+    if (comparison != GST_VALUE_UNORDERED)
+      return FALSE;
+
+    /* Stop everything if not a subset */
+    if (!gst_value_is_subset (&subfield->value, &superfield->value))
       return FALSE;
   }
 
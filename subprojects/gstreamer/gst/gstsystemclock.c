@@ -100,6 +100,10 @@ struct _GstClockEntryFutex
 
   gboolean initialized;
 
+  /* index + 1 in the heap of async entries, 0 when not in it */
+  guint heap_index;
+  guint64 heap_seq;
+
   GMutex lock;
   guint cond_val;
 };
@@ -173,6 +177,10 @@ struct _GstClockEntryPThread
 
   gboolean initialized;
 
+  /* index + 1 in the heap of async entries, 0 when not in it */
+  guint heap_index;
+  guint64 heap_seq;
+
   pthread_cond_t cond;
   pthread_mutex_t lock;
 };
@@ -305,6 +313,10 @@ struct _GstClockEntryGLib
 
   gboolean initialized;
 
+  /* index + 1 in the heap of async entries, 0 when not in it */
+  guint heap_index;
+  guint64 heap_seq;
+
   GMutex lock;
   GCond cond;
 };
@@ -345,7 +357,8 @@ struct _GstSystemClockPrivate
   GThread *thread;              /* thread for async notify */
   gboolean stopping;
 
-  GList *entries;
+  GPtrArray *entries;           /* binary min-heap of GstClockEntryImpl */
+  guint64 entries_seq;
   GCond entries_changed;
 
   GstClockType clock_type;
@@ -358,6 +371,103 @@ struct _GstSystemClockPrivate
 #endif
 };
 
+/* The pending async entries are kept in a binary min-heap ordered by time,
+ * entries with the same time are ordered by the time they were scheduled
+ * at. Every entry knows its position in the heap so that unscheduling it
+ * is O(log n) too. All functions must be called with the clock lock. */
+#define HEAP_ENTRY(priv,i) \
+    ((GstClockEntryImpl *) g_ptr_array_index ((priv)->entries, (i)))
+
+static inline gboolean
+heap_entry_before (GstClockEntryImpl * a, GstClockEntryImpl * b)
+{
+  GstClockTime ta = GST_CLOCK_ENTRY_TIME ((GstClockEntry *) a);
+  GstClockTime tb = GST_CLOCK_ENTRY_TIME ((GstClockEntry *) b);
+
+  if (ta != tb)
+    return ta < tb;
+  return a->heap_seq < b->heap_seq;
+}
+
+static inline void
+heap_set (GstSystemClockPrivate * priv, guint i, GstClockEntryImpl * entry)
+{
+  g_ptr_array_index (priv->entries, i) = entry;
+  entry->heap_index = i + 1;
+}
+
+static void
+heap_sift_up (GstSystemClockPrivate * priv, guint i)
+{
+  GstClockEntryImpl *entry = HEAP_ENTRY (priv, i);
+
+  while (i > 0) {
+    guint parent = (i - 1) / 2;
+
+    if (!heap_entry_before (entry, HEAP_ENTRY (priv, parent)))
+      break;
+    heap_set (priv, i, HEAP_ENTRY (priv, parent));
+    i = parent;
+  }
+  heap_set (priv, i, entry);
+}
+
+static void
+heap_sift_down (GstSystemClockPrivate * priv, guint i)
+{
+  GstClockEntryImpl *entry = HEAP_ENTRY (priv, i);
+  guint len = priv->entries->len;
+
+  for (;;) {
+    guint child = 2 * i + 1;
+
+    if (child >= len)
+      break;
+    if (child + 1 < len &&
+        heap_entry_before (HEAP_ENTRY (priv, child + 1), HEAP_ENTRY (priv,
+                child)))
+      child++;
+    if (!heap_entry_before (HEAP_ENTRY (priv, child), entry))
+      break;
+    heap_set (priv, i, HEAP_ENTRY (priv, child));
+    i = child;
+  }
+  heap_set (priv, i, entry);
+}
+
+static void
+heap_push (GstSystemClockPrivate * priv, GstClockEntryImpl * entry)
+{
+  entry->heap_seq = priv->entries_seq++;
+  g_ptr_array_add (priv->entries, entry);
+  heap_sift_up (priv, priv->entries->len - 1);
+}
+
+/* to be called after the time of @entry changed */
+static void
+heap_update (GstSystemClockPrivate * priv, GstClockEntryImpl * entry)
+{
+  entry->heap_seq = priv->entries_seq++;
+  heap_sift_up (priv, entry->heap_index - 1);
+  heap_sift_down (priv, entry->heap_index - 1);
+}
+
+static void
+heap_remove (GstSystemClockPrivate * priv, GstClockEntryImpl * entry)
+{
+  guint i = entry->heap_index - 1;
+
+  entry->heap_index = 0;
+  g_ptr_array_remove_index_fast (priv->entries, i);
+  if (i < priv->entries->len) {
+    GstClockEntryImpl *moved = HEAP_ENTRY (priv, i);
+
+    /* the last entry was moved to @i, it can belong higher or lower */
+    heap_sift_up (priv, i);
+    heap_sift_down (priv, moved->heap_index - 1);
+  }
+}
+
 #ifdef HAVE_POSIX_TIMERS
 # ifdef HAVE_MONOTONIC_CLOCK
 #  define DEFAULT_CLOCK_TYPE GST_CLOCK_TYPE_MONOTONIC
@@ -451,7 +561,7 @@ gst_system_clock_init (GstSystemClock * clock)
 
   priv->clock_type = DEFAULT_CLOCK_TYPE;
 
-  priv->entries = NULL;
+  priv->entries = g_ptr_array_new ();
   g_cond_init (&priv->entries_changed);
 
 #ifdef G_OS_WIN32
@@ -476,14 +586,17 @@ gst_system_clock_dispose (GObject * object)
   GstClock *clock = (GstClock *) object;
   GstSystemClock *sysclock = GST_SYSTEM_CLOCK_CAST (clock);
   GstSystemClockPrivate *priv = sysclock->priv;
-  GList *entries;
+  guint i;
+
+  if (priv->entries == NULL)
+    goto done;
 
   /* else we have to stop the thread */
   GST_SYSTEM_CLOCK_LOCK (clock);
   priv->stopping = TRUE;
   /* unschedule all entries */
-  for (entries = priv->entries; entries; entries = g_list_next (entries)) {
-    GstClockEntryImpl *entry = (GstClockEntryImpl *) entries->data;
+  for (i = 0; i < priv->entries->len; i++) {
+    GstClockEntryImpl *entry = HEAP_ENTRY (priv, i);
 
     /* We don't need to take the entry lock here because the async thread
      * would only ever look at the head entry, which is locked below and only
@@ -493,11 +606,9 @@ gst_system_clock_dispose (GObject * object)
 
     /* Wake up only the head entry: the async thread would only be waiting for
      * this one, not all of them. Once the head entry is unscheduled it tries
-     * to get the system clock lock (which we hold here) and then look for the
-     * next entry. Once it gets the lock it will notice that all further
-     * entries are unscheduled, would remove them one by one from the list and
-     * then shut down. */
-    if (!entries->prev) {
+     * to get the system clock lock (which we hold here) and then notices
+     * that it has to shut down. */
+    if (i == 0) {
       /* it was initialized before adding to the list */
       g_assert (entry->initialized);
 
@@ -516,12 +627,18 @@ gst_system_clock_dispose (GObject * object)
   priv->thread = NULL;
   GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock, "joined thread");
 
-  g_list_foreach (priv->entries, (GFunc) gst_clock_id_unref, NULL);
-  g_list_free (priv->entries);
+  for (i = 0; i < priv->entries->len; i++) {
+    GstClockEntryImpl *entry = HEAP_ENTRY (priv, i);
+
+    entry->heap_index = 0;
+    gst_clock_id_unref ((GstClockID) entry);
+  }
+  g_ptr_array_unref (priv->entries);
   priv->entries = NULL;
 
   g_cond_clear (&priv->entries_changed);
 
+done:
   G_OBJECT_CLASS (parent_class)->dispose (object);
 
   if (_the_system_clock == clock) {
@@ -643,12 +760,12 @@ gst_system_clock_obtain (void)
   return clock;
 }
 
-/* this thread reads the sorted clock entries from the queue.
+/* this thread takes the earliest clock entry from the heap.
  *
  * It waits on each of them and fires the callback when the timeout occurs.
  *
- * When an entry in the queue was canceled before we wait for it, it is
- * simply skipped.
+ * Entries are removed from the heap when they are canceled, except when
+ * the clock is disposed. Then they are skipped here.
  *
  * When waiting for an entry, it can become canceled, in that case we don't
  * call the callback but move to the next item in the queue.
@@ -674,7 +791,7 @@ gst_system_clock_async_thread (GstClock * clock)
     GstClockReturn res;
 
     /* check if something to be done */
-    while (priv->entries == NULL) {
+    while (priv->entries->len == 0) {
       GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock,
           "no clock entries, waiting..");
       /* wait for work to do */
@@ -685,10 +802,12 @@ gst_system_clock_async_thread (GstClock * clock)
         goto exit;
     }
 
-    /* pick the next entry */
-    entry = priv->entries->data;
+    /* pick the next entry, keep it alive while it is unscheduled and removed
+     * from the heap */
+    entry = (GstClockEntry *) HEAP_ENTRY (priv, 0);
+    gst_clock_id_ref ((GstClockID) entry);
 
-    /* it was initialized before adding to the list */
+    /* it was initialized before adding to the heap */
     g_assert (((GstClockEntryImpl *) entry)->initialized);
 
     /* unlocked before the next loop iteration at latest */
@@ -755,11 +874,13 @@ gst_system_clock_async_thread (GstClock * clock)
               "updating periodic entry %p", entry);
 
           GST_SYSTEM_CLOCK_LOCK (clock);
-          /* adjust time now */
-          entry->time = requested + entry->interval;
-          /* and resort the list now */
-          priv->entries =
-              g_list_sort (priv->entries, gst_clock_id_compare_func);
+          /* adjust time now and move it in the heap, unless it was
+           * unscheduled from the callback */
+          if (((GstClockEntryImpl *) entry)->heap_index) {
+            entry->time = requested + entry->interval;
+            heap_update (priv, (GstClockEntryImpl *) entry);
+          }
+          gst_clock_id_unref ((GstClockID) entry);
           /* and restart */
           continue;
         } else {
@@ -781,6 +902,7 @@ gst_system_clock_async_thread (GstClock * clock)
         if (entry_needs_unlock)
           GST_SYSTEM_CLOCK_ENTRY_UNLOCK ((GstClockEntryImpl *) entry);
         GST_SYSTEM_CLOCK_LOCK (clock);
+        gst_clock_id_unref ((GstClockID) entry);
         continue;
       default:
         GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock,
@@ -794,8 +916,11 @@ gst_system_clock_async_thread (GstClock * clock)
       GST_SYSTEM_CLOCK_ENTRY_UNLOCK ((GstClockEntryImpl *) entry);
     GST_SYSTEM_CLOCK_LOCK (clock);
 
-    /* we remove the current entry and unref it */
-    priv->entries = g_list_remove (priv->entries, entry);
+    /* we remove the current entry if it is still in the heap and unref it */
+    if (((GstClockEntryImpl *) entry)->heap_index) {
+      heap_remove (priv, (GstClockEntryImpl *) entry);
+      gst_clock_id_unref ((GstClockID) entry);
+    }
     gst_clock_id_unref ((GstClockID) entry);
   }
 exit:
@@ -1159,10 +1284,9 @@ no_thread:
   return FALSE;
 }
 
-/* Add an entry to the list of pending async waits. The entry is inserted
- * in sorted order. If we inserted the entry at the head of the list, we
- * need to signal the thread as it might either be waiting on it or waiting
- * for a new entry.
+/* Add an entry to the heap of pending async waits. If the entry became the
+ * head of the heap, we need to signal the thread as it might either be
+ * waiting on the previous head or waiting for a new entry.
  *
  * MT safe.
  */
@@ -1172,6 +1296,7 @@ gst_system_clock_id_wait_async (GstClock * clock, GstClockEntry * entry)
   GstSystemClock *sysclock;
   GstSystemClockPrivate *priv;
   GstClockEntry *head;
+  GstClockEntryImpl *entry_impl = (GstClockEntryImpl *) entry;
 
   sysclock = GST_SYSTEM_CLOCK_CAST (clock);
   priv = sysclock->priv;
@@ -1189,22 +1314,24 @@ gst_system_clock_id_wait_async (GstClock * clock, GstClockEntry * entry)
     goto was_unscheduled;
   GST_SYSTEM_CLOCK_ENTRY_UNLOCK ((GstClockEntryImpl *) entry);
 
-  if (priv->entries)
-    head = priv->entries->data;
+  if (priv->entries->len)
+    head = (GstClockEntry *) HEAP_ENTRY (priv, 0);
   else
     head = NULL;
 
-  /* need to take a ref */
-  gst_clock_id_ref ((GstClockID) entry);
-
-  /* insert the entry in sorted order */
-  priv->entries = g_list_insert_sorted (priv->entries, entry,
-      gst_clock_id_compare_func);
+  if (G_UNLIKELY (entry_impl->heap_index)) {
+    /* already pending, move it to its new time */
+    heap_update (priv, entry_impl);
+  } else {
+    /* need to take a ref */
+    gst_clock_id_ref ((GstClockID) entry);
+    heap_push (priv, entry_impl);
+  }
 
-  /* only need to send the signal if the entry was added to the
-   * front, else the thread is just waiting for another entry and
-   * will get to this entry automatically. */
-  if (priv->entries->data == entry) {
+  /* only need to send the signal if the head of the heap changed, else
+   * the thread is just waiting for another entry and will get to this
+   * entry automatically. */
+  if (HEAP_ENTRY (priv, 0) != (GstClockEntryImpl *) head) {
     GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock,
         "async entry added to head %p", head);
     if (head == NULL) {
@@ -1216,7 +1343,7 @@ gst_system_clock_id_wait_async (GstClock * clock, GstClockEntry * entry)
     } else {
       GstClockReturn status;
 
-      /* it was initialized before adding to the list */
+      /* it was initialized before adding to the heap */
       g_assert (((GstClockEntryImpl *) head)->initialized);
 
       GST_SYSTEM_CLOCK_ENTRY_LOCK ((GstClockEntryImpl *) head);
@@ -1253,7 +1380,8 @@ was_unscheduled:
   }
 }
 
-/* unschedule an entry. This will set the state of the entry to GST_CLOCK_UNSCHEDULED
+/* unschedule an entry. This will set the state of the entry to GST_CLOCK_UNSCHEDULED,
+ * remove it from the heap of async entries
  * and will signal any thread waiting for entries to recheck their entry.
  * We cannot really decide if the signal is needed or not because the entry
  * could be waited on in async or sync mode.
@@ -1283,5 +1411,12 @@ gst_system_clock_id_unschedule (GstClock * clock, GstClockEntry * entry)
     GST_SYSTEM_CLOCK_ENTRY_BROADCAST ((GstClockEntryImpl *) entry);
   }
   GST_SYSTEM_CLOCK_ENTRY_UNLOCK ((GstClockEntryImpl *) entry);
+
+  /* the caller holds a ref, so this is never the last one */
+  if (((GstClockEntryImpl *) entry)->heap_index) {
+    heap_remove (GST_SYSTEM_CLOCK_CAST (clock)->priv,
+        (GstClockEntryImpl *) entry);
+    gst_clock_id_unref ((GstClockID) entry);
+  }
   GST_SYSTEM_CLOCK_UNLOCK (clock);
 }
@@ -26,6 +26,7 @@
 #include <glib-object.h>
 #include <gst/gstobject.h>
 #include <gst/gstconfig.h>
+#include <gst/gststructure.h>
 
 G_BEGIN_DECLS
 
@@ -75,6 +76,12 @@ gboolean gst_tracer_register (GstPlugin * plugin, const gchar * name, GType type
 GST_API
 GList* gst_tracing_get_active_tracers (void);
 
+GST_API
+GstStructure * gst_tracing_get_slice_cache_stats (void);
+
+GST_API
+GstStructure * gst_tracing_get_caps_cache_stats (void);
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstTracer, gst_object_unref)
 
 G_END_DECLS
@@ -35,18 +35,55 @@
 #include "gstinfo.h"
 #include "gststructure.h"
 #include "gsttracerrecord.h"
+#include "gstutils.h"
 #include "gstvalue.h"
 #include <gobject/gvaluecollector.h>
 
+#include <errno.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#include <glib/gstdio.h>
+
 GST_DEBUG_CATEGORY_EXTERN (tracer_debug);
 #define GST_CAT_DEFAULT tracer_debug
 
+/* kinds of values in binary records */
+typedef enum
+{
+  BINARY_KIND_INT32 = 1,
+  BINARY_KIND_UINT32,
+  BINARY_KIND_INT64,
+  BINARY_KIND_UINT64,
+  BINARY_KIND_DOUBLE,
+  BINARY_KIND_POINTER,
+  BINARY_KIND_STRING,
+  /* written as BINARY_KIND_STRING */
+  BINARY_KIND_WRAPPED
+} GstTracerBinaryKind;
+
+typedef struct
+{
+  GQuark name;
+  GType type;
+  GstTracerBinaryKind kind;
+} GstTracerBinaryField;
+
 struct _GstTracerRecord
 {
   GstObject parent;
 
   GstStructure *spec;
   gchar *format;
+
+  /* the fields in the order they are logged and the id of the schema in the
+   * binary trace file, 0 if logging to the debug log */
+  GArray *fields;
+  guint16 binary_id;
 };
 
 struct _GstTracerRecordClass
@@ -57,10 +94,51 @@ struct _GstTracerRecordClass
 #define gst_tracer_record_parent_class parent_class
 G_DEFINE_TYPE (GstTracerRecord, gst_tracer_record, GST_TYPE_OBJECT);
 
+static GstTracerBinaryKind
+binary_kind_for_type (GType type)
+{
+  /* this needs to match the conversions used in
+   * priv__gst_structure_append_template_to_gstring() */
+  if (type == G_TYPE_INT || type == G_TYPE_BOOLEAN
+      || g_type_is_a (type, G_TYPE_ENUM) || g_type_is_a (type, G_TYPE_FLAGS))
+    return BINARY_KIND_INT32;
+  if (type == G_TYPE_UINT)
+    return BINARY_KIND_UINT32;
+  if (type == G_TYPE_INT64)
+    return BINARY_KIND_INT64;
+  if (type == G_TYPE_UINT64)
+    return BINARY_KIND_UINT64;
+  if (type == G_TYPE_FLOAT || type == G_TYPE_DOUBLE)
+    return BINARY_KIND_DOUBLE;
+  if (type == G_TYPE_STRING || type == G_TYPE_GTYPE)
+    return BINARY_KIND_STRING;
+  if (type == G_TYPE_POINTER)
+    return BINARY_KIND_POINTER;
+  return BINARY_KIND_WRAPPED;
+}
+
+static void
+add_field (GArray * fields, GQuark name, GType type)
+{
+  GstTracerBinaryField field;
+
+  field.name = name;
+  field.type = type;
+  field.kind = binary_kind_for_type (type);
+  g_array_append_val (fields, field);
+}
+
+typedef struct
+{
+  GString *s;
+  GArray *fields;
+} BuildFormatCtx;
+
 static gboolean
 build_field_template (GQuark field_id, const GValue * value, gpointer user_data)
 {
-  GString *s = (GString *) user_data;
+  BuildFormatCtx *ctx = (BuildFormatCtx *) user_data;
+  GString *s = ctx->s;
   const GstStructure *sub;
   GValue template_value = { 0, };
   GType type = G_TYPE_INVALID;
@@ -85,6 +163,7 @@ build_field_template (GQuark field_id, const GValue * value, gpointer user_data)
     priv__gst_structure_append_template_to_gstring (g_quark_from_string
         (opt_name), &template_value, s);
     g_value_unset (&template_value);
+    add_field (ctx->fields, g_quark_from_string (opt_name), G_TYPE_BOOLEAN);
     g_free (opt_name);
   }
 
@@ -92,6 +171,7 @@ build_field_template (GQuark field_id, const GValue * value, gpointer user_data)
   res = priv__gst_structure_append_template_to_gstring (field_id,
       &template_value, s);
   g_value_unset (&template_value);
+  add_field (ctx->fields, field_id, type);
   return res;
 }
 
@@ -99,6 +179,7 @@ static void
 gst_tracer_record_build_format (GstTracerRecord * self)
 {
   GstStructure *structure = self->spec;
+  BuildFormatCtx ctx;
   GString *s;
   gchar *name = (gchar *) g_quark_to_string (structure->name);
   gchar *p;
@@ -116,7 +197,10 @@ gst_tracer_record_build_format (GstTracerRecord * self)
 
   s = g_string_sized_new (STRUCTURE_ESTIMATED_STRING_LEN (structure));
   g_string_append (s, name);
-  gst_structure_foreach (structure, build_field_template, s);
+  self->fields = g_array_new (FALSE, FALSE, sizeof (GstTracerBinaryField));
+  ctx.s = s;
+  ctx.fields = self->fields;
+  gst_structure_foreach (structure, build_field_template, &ctx);
   g_string_append_c (s, ';');
 
   self->format = g_string_free (s, FALSE);
@@ -124,6 +208,456 @@ gst_tracer_record_build_format (GstTracerRecord * self)
   g_free (name);
 }
 
+/* Binary trace file, enabled with the GST_TRACER_BINARY_FILE environment
+ * variable.
+ *
+ * Formatting each record as text in the debug log is expensive, so instead
+ * the values are copied into a ring that is memory-mapped from the given
+ * file. The file starts with a header, followed by an area with one schema
+ * per record, describing its fields, and the ring of blocks with records.
+ * Records never cross block boundaries and each block starts with its
+ * sequence number, so that the blocks that were not overwritten yet can be
+ * put in order again when decoding. A block is only reused once all the
+ * records of its previous round are complete, records that come in before
+ * that are dropped and counted in the header.
+ *
+ * A record has a 16 byte header with its size, the schema id and the block
+ * sequence number, to detect stale records from earlier rounds, followed by
+ * the timestamp, the thread and the values, without any padding. Strings are
+ * stored as their length followed by the characters.
+ *
+ * All values are in host byte order, the header contains a byte order mark.
+ * gst-devtools/tracer/tracer/binary.py decodes the file. */
+#define BINARY_MAGIC              "GSTTRBIN"
+#define BINARY_VERSION            2
+#define BINARY_HEADER_SIZE        4096
+#define BINARY_SCHEMA_AREA_SIZE   (256 * 1024)
+#define BINARY_BLOCK_SIZE         (64 * 1024)
+#define BINARY_BLOCK_HEADER_SIZE  8
+#define BINARY_RECORD_HEADER_SIZE 32
+#define BINARY_RING_SIZE_DEFAULT  (16 * 1024 * 1024)
+
+typedef struct
+{
+  gchar magic[8];
+  guint32 version;
+  guint32 byte_order;
+  guint32 header_size;
+  guint32 schema_area_size;
+  guint32 block_size;
+  guint32 n_blocks;
+  guint64 pid;
+  /* bytes used in the schema area */
+  guint32 schema_used;
+  /* records that could not be written */
+  guint32 dropped;
+} GstTracerBinaryHeader;
+
+static guint8 *binary_data = NULL;
+
+#ifdef HAVE_SYS_MMAN_H
+static gsize binary_size;
+static guint32 binary_n_blocks;
+/* bytes written to the ring since the start, including the block headers */
+static gsize binary_pos = 0;
+/* writers that reserved space in each block and did not commit yet */
+static gint *binary_block_writers = NULL;
+static GMutex binary_lock;
+static guint16 binary_next_id = 1;
+
+static GstTracerBinaryHeader *
+binary_header (void)
+{
+  return (GstTracerBinaryHeader *) binary_data;
+}
+
+static gboolean
+binary_open (void)
+{
+  const gchar *location = g_getenv ("GST_TRACER_BINARY_FILE");
+  const gchar *env;
+  GstTracerBinaryHeader *header;
+  guint64 ring_size = BINARY_RING_SIZE_DEFAULT;
+  gint fd;
+
+  if (location == NULL || *location == '\0')
+    return FALSE;
+
+  env = g_getenv ("GST_TRACER_BINARY_SIZE");
+  if (env)
+    ring_size = g_ascii_strtoull (env, NULL, 10);
+  binary_n_blocks = MAX (ring_size / BINARY_BLOCK_SIZE, 2);
+  binary_size = BINARY_HEADER_SIZE + BINARY_SCHEMA_AREA_SIZE +
+      (gsize) binary_n_blocks * BINARY_BLOCK_SIZE;
+
+  fd = g_open (location, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    goto open_failed;
+
+  if (ftruncate (fd, binary_size) < 0)
+    goto map_failed;
+
+  binary_data = mmap (NULL, binary_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+      fd, 0);
+  if (binary_data == MAP_FAILED) {
+    binary_data = NULL;
+    goto map_failed;
+  }
+  close (fd);
+
+  header = binary_header ();
+  memcpy (header->magic, BINARY_MAGIC, sizeof (header->magic));
+  header->version = BINARY_VERSION;
+  header->byte_order = 0x01020304;
+  header->header_size = BINARY_HEADER_SIZE;
+  header->schema_area_size = BINARY_SCHEMA_AREA_SIZE;
+  header->block_size = BINARY_BLOCK_SIZE;
+  header->n_blocks = binary_n_blocks;
+  header->pid = getpid ();
+  header->schema_used = 0;
+  header->dropped = 0;
+
+  binary_block_writers = g_new0 (gint, binary_n_blocks);
+
+  GST_INFO ("writing binary trace records to %s", location);
+  return TRUE;
+
+open_failed:
+  {
+    g_warning ("Could not open binary tracer file '%s': %s", location,
+        g_strerror (errno));
+    return FALSE;
+  }
+map_failed:
+  {
+    g_warning ("Could not map binary tracer file '%s': %s", location,
+        g_strerror (errno));
+    close (fd);
+    return FALSE;
+  }
+}
+
+static gboolean
+binary_enabled (void)
+{
+  static gsize opened = 0;
+
+  if (g_once_init_enter (&opened)) {
+    gsize res = binary_open ()? 2 : 1;
+    g_once_init_leave (&opened, res);
+  }
+  return opened == 2 && binary_data != NULL;
+}
+
+static guint
+binary_string_size (const gchar * str)
+{
+  return 4 + (str ? strlen (str) : 0);
+}
+
+static guint8 *
+binary_write_string (guint8 * p, const gchar * str)
+{
+  guint32 len = str ? strlen (str) : 0;
+
+  memcpy (p, &len, 4);
+  memcpy (p + 4, str, len);
+  return p + 4 + len;
+}
+
+/* Stores the schema of @self in the schema area:
+ * u32 size, u16 id, u16 n_fields, u64 timestamp, name, class description and
+ * for each field: u8 kind, name and type name, with the strings
+ * nul-terminated. Returns the id or 0 when the area is full. */
+static guint16
+binary_add_schema (GstTracerRecord * self)
+{
+  GstTracerBinaryHeader *header = binary_header ();
+  gchar *name, *desc;
+  guint8 *p;
+  guint32 size;
+  guint16 id = 0, n_fields;
+  guint64 ts;
+  guint i;
+
+  name = g_strdup (g_quark_to_string (self->spec->name));
+  *strrchr (name, '.') = '\0';
+  desc = gst_structure_to_string (self->spec);
+
+  size = 16 + strlen (name) + 1 + strlen (desc) + 1;
+  for (i = 0; i < self->fields->len; i++) {
+    GstTracerBinaryField *f =
+        &g_array_index (self->fields, GstTracerBinaryField, i);
+    size += 1 + strlen (g_quark_to_string (f->name)) + 1 +
+        strlen (_priv_gst_value_gtype_to_abbr (f->type)) + 1;
+  }
+  size = GST_ROUND_UP_8 (size);
+
+  g_mutex_lock (&binary_lock);
+  if (header->schema_used + size > BINARY_SCHEMA_AREA_SIZE
+      || binary_next_id == G_MAXUINT16) {
+    GST_WARNING ("no space for the schema of %s, logging as text", name);
+    goto done;
+  }
+
+  id = binary_next_id++;
+  n_fields = self->fields->len;
+  ts = GST_CLOCK_DIFF (_priv_gst_start_time, gst_util_get_timestamp ());
+
+  p = binary_data + BINARY_HEADER_SIZE + header->schema_used;
+  memcpy (p, &size, 4);
+  memcpy (p + 4, &id, 2);
+  memcpy (p + 6, &n_fields, 2);
+  memcpy (p + 8, &ts, 8);
+  p += 16;
+  p = (guint8 *) g_stpcpy ((gchar *) p, name) + 1;
+  p = (guint8 *) g_stpcpy ((gchar *) p, desc) + 1;
+  for (i = 0; i < self->fields->len; i++) {
+    GstTracerBinaryField *f =
+        &g_array_index (self->fields, GstTracerBinaryField, i);
+
+    *p++ = f->kind == BINARY_KIND_WRAPPED ? BINARY_KIND_STRING : f->kind;
+    p = (guint8 *) g_stpcpy ((gchar *) p, g_quark_to_string (f->name)) + 1;
+    p = (guint8 *) g_stpcpy ((gchar *) p,
+        _priv_gst_value_gtype_to_abbr (f->type)) + 1;
+  }
+  /* publish the schema */
+  g_atomic_int_set ((gint *) & header->schema_used,
+      header->schema_used + size);
+
+done:
+  g_mutex_unlock (&binary_lock);
+  g_free (name);
+  g_free (desc);
+
+  return id;
+}
+
+/* reserves @size bytes in the ring. Returns the position in the ring and the
+ * block sequence number in @seq, or %NULL when the block is still being
+ * written from the previous round. The record must be completed with
+ * binary_commit(). */
+static guint8 *
+binary_reserve (guint32 size, guint64 * seq)
+{
+  gsize old, start;
+  guint8 *ring = binary_data + BINARY_HEADER_SIZE + BINARY_SCHEMA_AREA_SIZE;
+  gsize ring_size = (gsize) binary_n_blocks * BINARY_BLOCK_SIZE;
+  gint *writers, *prev_writers;
+  gboolean skipped;
+
+  do {
+    old = (gsize) g_atomic_pointer_get ((gpointer *) & binary_pos);
+    start = old;
+    /* records don't cross blocks */
+    if (start % BINARY_BLOCK_SIZE + size > BINARY_BLOCK_SIZE)
+      start += BINARY_BLOCK_SIZE - start % BINARY_BLOCK_SIZE;
+    if (start % BINARY_BLOCK_SIZE == 0)
+      start += BINARY_BLOCK_HEADER_SIZE;
+    skipped = old / BINARY_BLOCK_SIZE != start / BINARY_BLOCK_SIZE &&
+        old % BINARY_BLOCK_SIZE != 0;
+
+    /* count ourselves before taking the space, so that the first writer of
+     * the next round of this block sees us */
+    writers = &binary_block_writers[(start / BINARY_BLOCK_SIZE) %
+        binary_n_blocks];
+    g_atomic_int_inc (writers);
+    if (start % BINARY_BLOCK_SIZE == BINARY_BLOCK_HEADER_SIZE &&
+        g_atomic_int_get (writers) > 1) {
+      /* a record of the previous round is still being written here */
+      g_atomic_int_add (writers, -1);
+      return NULL;
+    }
+    /* same for the end of the previous block, which we mark as unused */
+    prev_writers = &binary_block_writers[(old / BINARY_BLOCK_SIZE) %
+        binary_n_blocks];
+    if (skipped)
+      g_atomic_int_inc (prev_writers);
+
+    if (g_atomic_pointer_compare_and_exchange ((gpointer *) & binary_pos,
+            (gpointer) old, (gpointer) (start + size)))
+      break;
+
+    if (skipped)
+      g_atomic_int_add (prev_writers, -1);
+    g_atomic_int_add (writers, -1);
+  } while (TRUE);
+
+  *seq = start / BINARY_BLOCK_SIZE + 1;
+
+  if (skipped) {
+    memset (ring + old % ring_size, 0, 4);
+    g_atomic_int_add (prev_writers, -1);
+  }
+  if (start % BINARY_BLOCK_SIZE == BINARY_BLOCK_HEADER_SIZE) {
+    /* we are the first in this block */
+    memcpy (ring + (start - BINARY_BLOCK_HEADER_SIZE) % ring_size, seq, 8);
+  }
+  return ring + start % ring_size;
+}
+
+/* the record reserved in the block with sequence number @seq is complete */
+static void
+binary_commit (guint64 seq)
+{
+  g_atomic_int_add (&binary_block_writers[(seq - 1) % binary_n_blocks], -1);
+}
+
+typedef union
+{
+  gint32 i;
+  guint32 u;
+  gint64 i64;
+  guint64 u64;
+  gdouble d;
+  const gchar *s;
+  gchar *wrapped;
+} GstTracerBinaryValue;
+
+static void
+binary_log_valist (GstTracerRecord * self, va_list var_args)
+{
+  GstTracerBinaryValue *values;
+  GstTracerBinaryField *fields = (GstTracerBinaryField *) self->fields->data;
+  guint i, n_fields = self->fields->len;
+  guint32 size = BINARY_RECORD_HEADER_SIZE;
+  guint64 ts, thread, seq;
+  guint8 *p, *record;
+
+  ts = GST_CLOCK_DIFF (_priv_gst_start_time, gst_util_get_timestamp ());
+  thread = (guint64) (guintptr) g_thread_self ();
+
+  values = g_newa (GstTracerBinaryValue, n_fields);
+  for (i = 0; i < n_fields; i++) {
+    switch (fields[i].kind) {
+      case BINARY_KIND_INT32:
+        values[i].i = va_arg (var_args, gint);
+        size += 4;
+        break;
+      case BINARY_KIND_UINT32:
+        values[i].u = va_arg (var_args, guint);
+        size += 4;
+        break;
+      case BINARY_KIND_INT64:
+        values[i].i64 = va_arg (var_args, gint64);
+        size += 8;
+        break;
+      case BINARY_KIND_UINT64:
+        values[i].u64 = va_arg (var_args, guint64);
+        size += 8;
+        break;
+      case BINARY_KIND_DOUBLE:
+        values[i].d = va_arg (var_args, gdouble);
+        size += 8;
+        break;
+      case BINARY_KIND_POINTER:
+        values[i].u64 = (guint64) (guintptr) va_arg (var_args, gpointer);
+        size += 8;
+        break;
+      case BINARY_KIND_STRING:
+        values[i].s = va_arg (var_args, const gchar *);
+        size += binary_string_size (values[i].s);
+        break;
+      case BINARY_KIND_WRAPPED:
+        values[i].wrapped = gst_info_strdup_printf ("%" GST_WRAPPED_PTR_FORMAT,
+            va_arg (var_args, gpointer));
+        size += binary_string_size (values[i].wrapped);
+        break;
+    }
+  }
+  size = GST_ROUND_UP_8 (size);
+
+  if (G_LIKELY (size <= BINARY_BLOCK_SIZE - BINARY_BLOCK_HEADER_SIZE)) {
+    record = binary_reserve (size, &seq);
+  } else {
+    GST_WARNING ("dropping %" G_GUINT32_FORMAT " bytes record", size);
+    record = NULL;
+  }
+
+  if (G_LIKELY (record)) {
+    p = record + 16;
+    memcpy (p, &ts, 8);
+    memcpy (p + 8, &thread, 8);
+    p += 16;
+    for (i = 0; i < n_fields; i++) {
+      switch (fields[i].kind) {
+        case BINARY_KIND_INT32:
+        case BINARY_KIND_UINT32:
+          memcpy (p, &values[i].u, 4);
+          p += 4;
+          break;
+        case BINARY_KIND_INT64:
+        case BINARY_KIND_UINT64:
+        case BINARY_KIND_DOUBLE:
+        case BINARY_KIND_POINTER:
+          memcpy (p, &values[i].u64, 8);
+          p += 8;
+          break;
+        case BINARY_KIND_STRING:
+          p = binary_write_string (p, values[i].s);
+          break;
+        case BINARY_KIND_WRAPPED:
+          p = binary_write_string (p, values[i].wrapped);
+          break;
+      }
+    }
+
+    /* the header goes last so that the record is only valid once complete */
+    memcpy (record + 4, &self->binary_id, 2);
+    memset (record + 6, 0, 2);
+    memcpy (record + 8, &seq, 8);
+    g_atomic_int_set ((gint *) record, size);
+    binary_commit (seq);
+  } else {
+    g_atomic_int_inc ((gint *) & binary_header ()->dropped);
+  }
+
+  for (i = 0; i < n_fields; i++) {
+    if (fields[i].kind == BINARY_KIND_WRAPPED)
+      g_free (values[i].wrapped);
+  }
+}
+
+void
+_priv_gst_tracer_record_cleanup (void)
+{
+  if (binary_data) {
+    munmap (binary_data, binary_size);
+    binary_data = NULL;
+    g_free (binary_block_writers);
+    binary_block_writers = NULL;
+  }
+}
+#else /* !HAVE_SYS_MMAN_H */
+static gboolean
+binary_enabled (void)
+{
+  static gboolean warned = FALSE;
+
+  if (!warned && g_getenv ("GST_TRACER_BINARY_FILE")) {
+    g_warning ("Binary tracer files are not supported on this platform");
+    warned = TRUE;
+  }
+  return FALSE;
+}
+
+static guint16
+binary_add_schema (GstTracerRecord * self)
+{
+  return 0;
+}
+
+static void
+binary_log_valist (GstTracerRecord * self, va_list var_args)
+{
+}
+
+void
+_priv_gst_tracer_record_cleanup (void)
+{
+}
+#endif /* HAVE_SYS_MMAN_H */
+
 static void
 gst_tracer_record_dispose (GObject * object)
 {
@@ -135,6 +669,10 @@ gst_tracer_record_dispose (GObject * object)
   }
   g_free (self->format);
   self->format = NULL;
+  if (self->fields) {
+    g_array_free (self->fields, TRUE);
+    self->fields = NULL;
+  }
 }
 
 static void
@@ -233,6 +771,9 @@ gst_tracer_record_new (const gchar * name, const gchar * firstfield, ...)
   self->spec = structure;
   gst_tracer_record_build_format (self);
 
+  if (binary_enabled ())
+    self->binary_id = binary_add_schema (self);
+
   return self;
 }
 
@@ -245,7 +786,9 @@ gst_tracer_record_new (const gchar * name, const gchar * firstfield, ...)
  * Serialzes the trace event into the log.
  *
  * Right now this is using the gstreamer debug log with the level TRACE (7) and
- * the category "GST_TRACER".
+ * the category "GST_TRACER". When the GST_TRACER_BINARY_FILE environment
+ * variable is set, the values are written to that file in a binary format
+ * instead, see gst-devtools/tracer for a decoder.
  *
  * > Please note that this is still under discussion and subject to change.
  *
@@ -269,7 +812,9 @@ gst_tracer_record_log (GstTracerRecord * self, ...)
    */
 
   va_start (var_args, self);
-  if (G_LIKELY (GST_LEVEL_TRACE <= _gst_debug_min)) {
+  if (self->binary_id && binary_data) {
+    binary_log_valist (self, var_args);
+  } else if (G_LIKELY (GST_LEVEL_TRACE <= _gst_debug_min)) {
     gst_debug_log_valist (GST_CAT_DEFAULT, GST_LEVEL_TRACE, "", "", 0, NULL,
         self->format, var_args);
   }
@@ -54,7 +54,8 @@ static const gchar *_quark_strings[] = {
   "element-change-state-pre", "element-change-state-post",
   "mini-object-created", "mini-object-destroyed", "object-created",
   "object-destroyed", "mini-object-reffed", "mini-object-unreffed",
-  "object-reffed", "object-unreffed", "plugin-feature-loaded"
+  "object-reffed", "object-unreffed", "plugin-feature-loaded",
+  "buffer-pool-stats"
 };
 
 GQuark _priv_gst_tracer_quark_table[GST_TRACER_QUARK_MAX];
@@ -248,3 +249,51 @@ gst_tracing_get_active_tracers (void)
   return NULL;
 }
 #endif /* GST_DISABLE_GST_TRACER_HOOKS */
+
+/**
+ * gst_tracing_get_slice_cache_stats:
+ *
+ * Get the counters of the per-thread caches that recycle the structures of
+ * #GstBuffer, #GstEvent and system memory #GstMemory objects.
+ *
+ * The returned structure has one #GstStructure field per cache, named
+ * "buffer", "event" and "memory". Each of them has the #guint64 fields
+ * "hits" (allocations served from a cache), "misses" (allocations that
+ * went to the system allocator) and "released" (freed structures given
+ * back to the system allocator because the cache was full), and the
+ * #guint field "cached" with the number of structures shared between
+ * threads.
+ *
+ * Threads add their counters to the totals in batches, only the counters
+ * of the calling thread are always up to date.
+ *
+ * Returns: (transfer full): a #GstStructure with the cache counters
+ *
+ * Since: 1.22
+ */
+GstStructure *
+gst_tracing_get_slice_cache_stats (void)
+{
+  return _priv_gst_slice_cache_get_stats ();
+}
+
+/**
+ * gst_tracing_get_caps_cache_stats:
+ *
+ * Get the counters of the cache of caps intersection and subset results
+ * that is enabled with the `GST_CAPS_CACHE_SIZE` environment variable.
+ *
+ * The returned structure has the #guint64 fields "hits" and "misses", counting
+ * the lookups for caps that could be cached, and the #guint fields "size"
+ * and "used" with the number of entries of the cache and how many of them are
+ * filled. "size" is 0 when the cache is disabled.
+ *
+ * Returns: (transfer full): a #GstStructure with the cache counters
+ *
+ * Since: 1.22
+ */
+GstStructure *
+gst_tracing_get_caps_cache_stats (void)
+{
+  return _priv_gst_caps_cache_get_stats ();
+}
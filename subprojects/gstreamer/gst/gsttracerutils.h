@@ -27,6 +27,7 @@
 #include <glib-object.h>
 #include <gst/gstconfig.h>
 #include <gst/gstbin.h>
+#include <gst/gstbufferpool.h>
 #include <gst/gstutils.h>
 
 G_BEGIN_DECLS
@@ -80,6 +81,7 @@ typedef enum /*< skip >*/
   GST_TRACER_QUARK_HOOK_OBJECT_REFFED,
   GST_TRACER_QUARK_HOOK_OBJECT_UNREFFED,
   GST_TRACER_QUARK_HOOK_PLUGIN_FEATURE_LOADED,
+  GST_TRACER_QUARK_HOOK_BUFFER_POOL_STATS,
   GST_TRACER_QUARK_MAX
 } GstTracerQuarkId;
 
@@ -722,6 +724,33 @@ typedef void (*GstTracerHookPluginFeatureLoaded) (GObject *self, GstClockTime ts
     GstTracerHookPluginFeatureLoaded, (GST_TRACER_ARGS, feature)); \
 }G_STMT_END
 
+/**
+ * GstTracerHookBufferPoolStats:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @pool: the buffer pool that stopped
+ * @stats: the statistics of @pool, as returned by gst_buffer_pool_get_stats()
+ *
+ * Hook called when a #GstBufferPool is stopped named "buffer-pool-stats".
+ *
+ * Since: 1.22
+ */
+typedef void (*GstTracerHookBufferPoolStats) (GObject *self, GstClockTime ts,
+    GstBufferPool *pool, const GstStructure *stats);
+/**
+ * GST_TRACER_BUFFER_POOL_STATS:
+ * @pool: the buffer pool that stopped
+ * @stats: the statistics of @pool
+ *
+ * Add a tracepoint when a buffer pool is stopped.
+ *
+ * Since: 1.22
+ */
+#define GST_TRACER_BUFFER_POOL_STATS(pool, stats) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_BUFFER_POOL_STATS), \
+    GstTracerHookBufferPoolStats, (GST_TRACER_ARGS, pool, stats)); \
+}G_STMT_END
+
 
 #else /* !GST_DISABLE_GST_TRACER_HOOKS */
 
@@ -772,6 +801,7 @@ _priv_gst_tracing_deinit (void)
 #define GST_TRACER_OBJECT_REFFED(object, new_refcount)
 #define GST_TRACER_OBJECT_UNREFFED(object, new_refcount)
 #define GST_TRACER_PLUGIN_FEATURE_LOADED(feature)
+#define GST_TRACER_BUFFER_POOL_STATS(pool, stats)
 
 #endif /* GST_DISABLE_GST_TRACER_HOOKS */
 
@@ -116,6 +116,10 @@ gst_type_find_factory_dispose (GObject * object)
 {
   GstTypeFindFactory *factory = GST_TYPE_FIND_FACTORY (object);
 
+  /* first, a load of the details in another thread must not run while
+   * they are freed */
+  _priv_gst_registry_chunks_unload_details (GST_PLUGIN_FEATURE_CAST (factory));
+
   if (factory->caps) {
     gst_caps_unref (factory->caps);
     factory->caps = NULL;
@@ -166,6 +170,8 @@ gst_type_find_factory_get_caps (GstTypeFindFactory * factory)
 {
   g_return_val_if_fail (GST_IS_TYPE_FIND_FACTORY (factory), NULL);
 
+  GST_FACTORY_LOAD_DETAILS (factory);
+
   return factory->caps;
 }
 
@@ -186,6 +192,8 @@ gst_type_find_factory_get_extensions (GstTypeFindFactory * factory)
 {
   g_return_val_if_fail (GST_IS_TYPE_FIND_FACTORY (factory), NULL);
 
+  GST_FACTORY_LOAD_DETAILS (factory);
+
   return (const gchar * const *) factory->extensions;
 }
 
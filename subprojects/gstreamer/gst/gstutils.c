@@ -1378,6 +1378,8 @@ gst_element_factory_can_accept_all_caps_in_direction (GstElementFactory *
   g_return_val_if_fail (factory != NULL, FALSE);
   g_return_val_if_fail (caps != NULL, FALSE);
 
+  GST_FACTORY_LOAD_DETAILS (factory);
+
   templates = factory->staticpadtemplates;
 
   while (templates) {
@@ -1407,6 +1409,8 @@ gst_element_factory_can_accept_any_caps_in_direction (GstElementFactory *
   g_return_val_if_fail (factory != NULL, FALSE);
   g_return_val_if_fail (caps != NULL, FALSE);
 
+  GST_FACTORY_LOAD_DETAILS (factory);
+
   templates = factory->staticpadtemplates;
 
   while (templates) {
@@ -131,6 +131,12 @@
  *
  *   * Implied %TRUE if no transform function is implemented.
  *   * Implied %FALSE if ONLY transform function is implemented.
+ *
+ * * stateless
+ *   * Set with gst_base_transform_set_stateless() when the transform
+ *     functions can run for several buffers at the same time. The
+ *     #GstBaseTransform:parallel-depth property then controls how many
+ *     buffers are transformed in parallel.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -156,13 +162,30 @@ enum
 };
 
 #define DEFAULT_PROP_QOS	FALSE
+#define DEFAULT_PROP_PARALLEL_DEPTH	1
 
 enum
 {
   PROP_0,
-  PROP_QOS
+  PROP_QOS,
+  PROP_PARALLEL_DEPTH,
+  PROP_PARALLEL_JOBS
 };
 
+/* A buffer that is being transformed by the parallel task pool */
+typedef struct
+{
+  GstBaseTransform *trans;
+  GstBuffer *inbuf;
+  GstBuffer *outbuf;
+  /* end position of the input buffer */
+  GstClockTime position;
+  gboolean discont;
+  GstFlowReturn ret;
+  gint done;
+  gpointer id;
+} GstBaseTransformJob;
+
 struct _GstBaseTransformPrivate
 {
   /* Set by sub-class */
@@ -200,6 +223,20 @@ struct _GstBaseTransformPrivate
   GstAllocator *allocator;
   GstAllocationParams params;
   GstQuery *query;
+
+  /* parallel processing, with LOCK */
+  gboolean stateless;
+  guint parallel_depth;
+
+  /* with STREAM_LOCK */
+  GstTaskPool *parallel_pool;
+  guint parallel_threads;
+  /* the GstBaseTransformJob in flight, oldest first */
+  GQueue parallel_jobs;
+  /* error of the last drain, returned by the next chain call */
+  GstFlowReturn parallel_flow;
+  /* length of parallel_jobs, ATOMIC */
+  gint parallel_n_jobs;
 };
 
 
@@ -308,12 +345,26 @@ static gboolean
 gst_base_transform_default_transform_meta (GstBaseTransform * trans,
     GstBuffer * outbuf, GstMeta * meta, GstBuffer * inbuf);
 
+static guint gst_base_transform_get_parallel_depth (GstBaseTransform * trans);
+static GstFlowReturn gst_base_transform_drain_jobs (GstBaseTransform * trans);
+static void gst_base_transform_drain_failed (GstBaseTransform * trans,
+    GstFlowReturn ret);
+static void gst_base_transform_discard_jobs (GstBaseTransform * trans);
+
 /* static guint gst_base_transform_signals[LAST_SIGNAL] = { 0 }; */
 
 
 static void
 gst_base_transform_finalize (GObject * object)
 {
+  GstBaseTransform *trans = GST_BASE_TRANSFORM_CAST (object);
+  GstBaseTransformPrivate *priv = trans->priv;
+
+  if (priv->parallel_pool) {
+    gst_task_pool_cleanup (priv->parallel_pool);
+    gst_object_unref (priv->parallel_pool);
+  }
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -341,6 +392,40 @@ gst_base_transform_class_init (GstBaseTransformClass * klass)
       g_param_spec_boolean ("qos", "QoS", "Handle Quality-of-Service events",
           DEFAULT_PROP_QOS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstBaseTransform:parallel-depth:
+   *
+   * The maximum number of buffers that are transformed at the same time
+   * when the sub-class declared itself stateless with
+   * gst_base_transform_set_stateless(). 0 uses as many buffers as there are
+   * processors, 1 disables parallel processing.
+   *
+   * The output buffers are pushed in the order of the input buffers, so
+   * every buffer waits for the ones that came before it. This adds latency
+   * and holds up to this many more buffers from the allocation pool.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_PARALLEL_DEPTH,
+      g_param_spec_uint ("parallel-depth", "Parallel depth",
+          "Maximum number of buffers transformed at the same time by "
+          "stateless transforms (0 = number of processors, 1 = disabled)",
+          0, G_MAXUINT, DEFAULT_PROP_PARALLEL_DEPTH,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstBaseTransform:parallel-jobs:
+   *
+   * The number of buffers that are currently being transformed in parallel
+   * or wait to be pushed, at most #GstBaseTransform:parallel-depth.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_PARALLEL_JOBS,
+      g_param_spec_uint ("parallel-jobs", "Parallel jobs",
+          "Number of buffers currently being transformed in parallel",
+          0, G_MAXUINT, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   gobject_class->finalize = gst_base_transform_finalize;
 
   klass->passthrough_on_same_caps = FALSE;
@@ -411,6 +496,9 @@ gst_base_transform_init (GstBaseTransform * trans,
   gst_element_add_pad (GST_ELEMENT (trans), trans->srcpad);
 
   priv->qos_enabled = DEFAULT_PROP_QOS;
+  priv->parallel_depth = DEFAULT_PROP_PARALLEL_DEPTH;
+  g_queue_init (&priv->parallel_jobs);
+  priv->parallel_flow = GST_FLOW_OK;
   priv->cache_caps1 = NULL;
   priv->cache_caps2 = NULL;
   priv->pad_mode = GST_PAD_MODE_NONE;
@@ -797,6 +885,7 @@ gst_base_transform_default_decide_allocation (GstBaseTransform * trans,
   GstAllocationParams params;
   GstStructure *config;
   gboolean update_allocator;
+  guint depth;
 
   klass = GST_BASE_TRANSFORM_GET_CLASS (trans);
 
@@ -860,6 +949,14 @@ gst_base_transform_default_decide_allocation (GstBaseTransform * trans,
     size = min = max = 0;
   }
 
+  /* in parallel mode every buffer in flight holds one more buffer */
+  depth = gst_base_transform_get_parallel_depth (trans);
+  if (pool && depth > 1) {
+    min += depth;
+    if (max != 0)
+      max += depth;
+  }
+
   /* now configure */
   if (pool) {
     config = gst_buffer_pool_get_config (pool);
@@ -1619,6 +1716,26 @@ gst_base_transform_query (GstPad * pad, GstObject * parent, GstQuery * query)
   trans = GST_BASE_TRANSFORM_CAST (parent);
   bclass = GST_BASE_TRANSFORM_GET_CLASS (trans);
 
+  /* serialized queries on the sinkpad must see all buffers that came before
+   * them. Unlike for serialized events, the pad does not take the stream
+   * lock for queries, and they can be sent from any thread. Jobs are only
+   * queued in parallel mode, and stay queued until the next serialized
+   * event or query when it gets disabled. */
+  if (GST_PAD_IS_SINK (pad) && GST_QUERY_IS_SERIALIZED (query) &&
+      (g_atomic_int_get (&trans->priv->parallel_n_jobs) > 0 ||
+          gst_base_transform_get_parallel_depth (trans) > 1)) {
+    GstFlowReturn res;
+
+    GST_PAD_STREAM_LOCK (pad);
+    res = gst_base_transform_drain_jobs (trans);
+    GST_PAD_STREAM_UNLOCK (pad);
+
+    if (res != GST_FLOW_OK) {
+      gst_base_transform_drain_failed (trans, res);
+      return FALSE;
+    }
+  }
+
   if (bclass->query)
     ret = bclass->query (trans, GST_PAD_DIRECTION (pad), query);
 
@@ -1900,6 +2017,21 @@ gst_base_transform_sink_event (GstPad * pad, GstObject * parent,
   trans = GST_BASE_TRANSFORM_CAST (parent);
   bclass = GST_BASE_TRANSFORM_GET_CLASS (trans);
 
+  /* buffers that are still being transformed in parallel go before any
+   * serialized event */
+  if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP) {
+    gst_base_transform_discard_jobs (trans);
+    trans->priv->parallel_flow = GST_FLOW_OK;
+  } else if (GST_EVENT_IS_SERIALIZED (event)) {
+    GstFlowReturn res = gst_base_transform_drain_jobs (trans);
+
+    if (res != GST_FLOW_OK) {
+      gst_base_transform_drain_failed (trans, res);
+      gst_event_unref (event);
+      return FALSE;
+    }
+  }
+
   if (bclass->sink_event)
     ret = bclass->sink_event (trans, event);
   else
@@ -2130,15 +2262,53 @@ not_negotiated:
   }
 }
 
+/* performs the configured transform of @inbuf into @outbuf, this can be
+ * called from the parallel task pool for stateless sub-classes */
 static GstFlowReturn
-default_generate_output (GstBaseTransform * trans, GstBuffer ** outbuf)
+gst_base_transform_do_transform (GstBaseTransform * trans, GstBuffer * inbuf,
+    GstBuffer * outbuf)
 {
   GstBaseTransformClass *bclass = GST_BASE_TRANSFORM_GET_CLASS (trans);
   GstBaseTransformPrivate *priv = trans->priv;
   GstFlowReturn ret = GST_FLOW_OK;
-  GstBuffer *inbuf;
   gboolean want_in_place;
 
+  if (priv->passthrough) {
+    /* In passthrough mode, give transform_ip a look at the
+     * buffer, without making it writable, or just push the
+     * data through */
+    if (bclass->transform_ip_on_passthrough && bclass->transform_ip) {
+      GST_DEBUG_OBJECT (trans, "doing passthrough transform_ip");
+      ret = bclass->transform_ip (trans, outbuf);
+    } else {
+      GST_DEBUG_OBJECT (trans, "element is in passthrough");
+    }
+  } else {
+    want_in_place = (bclass->transform_ip != NULL) && priv->always_in_place;
+
+    if (want_in_place) {
+      GST_DEBUG_OBJECT (trans, "doing inplace transform");
+      ret = bclass->transform_ip (trans, outbuf);
+    } else {
+      GST_DEBUG_OBJECT (trans, "doing non-inplace transform");
+
+      if (bclass->transform)
+        ret = bclass->transform (trans, inbuf, outbuf);
+      else
+        ret = GST_FLOW_NOT_SUPPORTED;
+    }
+  }
+
+  return ret;
+}
+
+static GstFlowReturn
+default_generate_output (GstBaseTransform * trans, GstBuffer ** outbuf)
+{
+  GstBaseTransformClass *bclass = GST_BASE_TRANSFORM_GET_CLASS (trans);
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstBuffer *inbuf;
+
   /* Retrieve stashed input buffer, if the default submit_input_buffer
    * was run. Takes ownership back from there */
   inbuf = trans->queued_buf;
@@ -2165,31 +2335,7 @@ default_generate_output (GstBaseTransform * trans, GstBuffer ** outbuf)
       *outbuf);
 
   /* now perform the needed transform */
-  if (priv->passthrough) {
-    /* In passthrough mode, give transform_ip a look at the
-     * buffer, without making it writable, or just push the
-     * data through */
-    if (bclass->transform_ip_on_passthrough && bclass->transform_ip) {
-      GST_DEBUG_OBJECT (trans, "doing passthrough transform_ip");
-      ret = bclass->transform_ip (trans, *outbuf);
-    } else {
-      GST_DEBUG_OBJECT (trans, "element is in passthrough");
-    }
-  } else {
-    want_in_place = (bclass->transform_ip != NULL) && priv->always_in_place;
-
-    if (want_in_place) {
-      GST_DEBUG_OBJECT (trans, "doing inplace transform");
-      ret = bclass->transform_ip (trans, *outbuf);
-    } else {
-      GST_DEBUG_OBJECT (trans, "doing non-inplace transform");
-
-      if (bclass->transform)
-        ret = bclass->transform (trans, inbuf, *outbuf);
-      else
-        ret = GST_FLOW_NOT_SUPPORTED;
-    }
-  }
+  ret = gst_base_transform_do_transform (trans, inbuf, *outbuf);
 
   /* only unref input buffer if we allocated a new outbuf buffer. If we reused
    * the input buffer, no refcount is changed to keep the input buffer writable
@@ -2217,6 +2363,254 @@ no_buffer:
   }
 }
 
+/* returns the number of buffers that can be transformed at the same time,
+ * 1 when the sub-class is not stateless */
+static guint
+gst_base_transform_get_parallel_depth (GstBaseTransform * trans)
+{
+  GstBaseTransformPrivate *priv = trans->priv;
+  guint depth;
+
+  GST_OBJECT_LOCK (trans);
+  depth = priv->stateless ? priv->parallel_depth : 1;
+  GST_OBJECT_UNLOCK (trans);
+
+  if (depth == 0)
+    depth = g_get_num_processors ();
+
+  return depth;
+}
+
+/* parallel processing only replaces the transform step of the default
+ * processing, sub-classes with their own submit_input_buffer or
+ * generate_output and passthrough without transform_ip are sequential */
+static gboolean
+gst_base_transform_can_parallel (GstBaseTransform * trans)
+{
+  GstBaseTransformClass *bclass = GST_BASE_TRANSFORM_GET_CLASS (trans);
+  GstBaseTransformPrivate *priv = trans->priv;
+
+  if (bclass->submit_input_buffer != default_submit_input_buffer ||
+      bclass->generate_output != default_generate_output ||
+      bclass->prepare_output_buffer == NULL)
+    return FALSE;
+
+  if (priv->passthrough)
+    return bclass->transform_ip_on_passthrough && bclass->transform_ip;
+
+  return TRUE;
+}
+
+static void
+gst_base_transform_job_func (GstBaseTransformJob * job)
+{
+  job->ret = gst_base_transform_do_transform (job->trans, job->inbuf,
+      job->outbuf);
+
+  if (job->outbuf != job->inbuf)
+    gst_buffer_unref (job->inbuf);
+  job->inbuf = NULL;
+
+  g_atomic_int_set (&job->done, 1);
+}
+
+/* waits for the oldest job and pushes its output buffer,
+ * with STREAM_LOCK */
+static GstFlowReturn
+gst_base_transform_finish_job (GstBaseTransform * trans)
+{
+  GstBaseTransformPrivate *priv = trans->priv;
+  GstBaseTransformJob *job, *next;
+  GstFlowReturn ret;
+  GstBuffer *outbuf;
+
+  job = g_queue_pop_head (&priv->parallel_jobs);
+  if (job->id)
+    gst_task_pool_join (priv->parallel_pool, job->id);
+  g_atomic_int_add (&priv->parallel_n_jobs, -1);
+
+  ret = job->ret;
+  outbuf = job->outbuf;
+
+  if (ret == GST_FLOW_OK) {
+    GstClockTime position_out = GST_CLOCK_TIME_NONE;
+
+    /* Remember last stop position */
+    if (job->position != GST_CLOCK_TIME_NONE &&
+        trans->segment.format == GST_FORMAT_TIME)
+      trans->segment.position = job->position;
+
+    if (GST_BUFFER_TIMESTAMP_IS_VALID (outbuf)) {
+      position_out = GST_BUFFER_TIMESTAMP (outbuf);
+      if (GST_BUFFER_DURATION_IS_VALID (outbuf))
+        position_out += GST_BUFFER_DURATION (outbuf);
+    } else if (job->position != GST_CLOCK_TIME_NONE) {
+      position_out = job->position;
+    }
+    if (position_out != GST_CLOCK_TIME_NONE
+        && trans->segment.format == GST_FORMAT_TIME)
+      priv->position_out = position_out;
+
+    if (job->discont && !GST_BUFFER_IS_DISCONT (outbuf)) {
+      GST_DEBUG_OBJECT (trans, "marking DISCONT on output buffer");
+      outbuf = gst_buffer_make_writable (outbuf);
+      GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
+    }
+    priv->processed++;
+
+    ret = gst_pad_push (trans->srcpad, outbuf);
+  } else {
+    GST_DEBUG_OBJECT (trans, "we got return %s", gst_flow_get_name (ret));
+    gst_buffer_unref (outbuf);
+
+    if (ret == GST_BASE_TRANSFORM_FLOW_DROPPED) {
+      GST_DEBUG_OBJECT (trans, "dropped a buffer, marking DISCONT");
+      next = g_queue_peek_head (&priv->parallel_jobs);
+      if (next)
+        next->discont = TRUE;
+      else
+        priv->discont = TRUE;
+      ret = GST_FLOW_OK;
+    }
+  }
+
+  g_free (job);
+
+  return ret;
+}
+
+/* throws away all jobs in flight, with STREAM_LOCK */
+static void
+gst_base_transform_discard_jobs (GstBaseTransform * trans)
+{
+  GstBaseTransformPrivate *priv = trans->priv;
+  GstBaseTransformJob *job;
+
+  while ((job = g_queue_pop_head (&priv->parallel_jobs))) {
+    if (job->id)
+      gst_task_pool_join (priv->parallel_pool, job->id);
+    gst_buffer_unref (job->outbuf);
+    g_free (job);
+  }
+  g_atomic_int_set (&priv->parallel_n_jobs, 0);
+}
+
+/* pushes the output of all jobs in flight, with STREAM_LOCK */
+static GstFlowReturn
+gst_base_transform_drain_jobs (GstBaseTransform * trans)
+{
+  GstBaseTransformPrivate *priv = trans->priv;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  while (ret == GST_FLOW_OK && !g_queue_is_empty (&priv->parallel_jobs))
+    ret = gst_base_transform_finish_job (trans);
+
+  if (ret != GST_FLOW_OK) {
+    GST_DEBUG_OBJECT (trans, "draining failed: %s", gst_flow_get_name (ret));
+    gst_base_transform_discard_jobs (trans);
+  }
+
+  return ret;
+}
+
+/* a drain for a serialized event or query failed, the next chain call returns
+ * the error too. Errors are posted here because, unlike for chain, the
+ * upstream element does not get the flow return to post them itself. */
+static void
+gst_base_transform_drain_failed (GstBaseTransform * trans, GstFlowReturn ret)
+{
+  trans->priv->parallel_flow = ret;
+
+  if (ret == GST_FLOW_NOT_LINKED || ret < GST_FLOW_EOS)
+    GST_ELEMENT_FLOW_ERROR (trans, ret);
+}
+
+/* Takes the buffer queued by the default submit_input_buffer, allocates
+ * the output buffer and hands the transform to the task pool. Then pushes
+ * the output of all jobs that are done, in order. */
+static GstFlowReturn
+gst_base_transform_dispatch_job (GstBaseTransform * trans,
+    GstClockTime position, guint depth)
+{
+  GstBaseTransformClass *bclass = GST_BASE_TRANSFORM_GET_CLASS (trans);
+  GstBaseTransformPrivate *priv = trans->priv;
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstBaseTransformJob *job;
+  GstBuffer *inbuf, *outbuf = NULL;
+
+  inbuf = trans->queued_buf;
+  trans->queued_buf = NULL;
+
+  if (inbuf == NULL)
+    return GST_FLOW_OK;
+
+  /* make room first, the jobs in flight hold output buffers that can only
+   * return to the pool after they were pushed */
+  while (g_queue_get_length (&priv->parallel_jobs) >= depth) {
+    ret = gst_base_transform_finish_job (trans);
+    if (ret != GST_FLOW_OK)
+      goto push_failed;
+  }
+
+  ret = bclass->prepare_output_buffer (trans, inbuf, &outbuf);
+  if (ret != GST_FLOW_OK || outbuf == NULL)
+    goto no_buffer;
+
+  if (priv->parallel_pool == NULL) {
+    priv->parallel_pool = gst_shared_task_pool_new ();
+    gst_task_pool_prepare (priv->parallel_pool, NULL);
+  }
+  if (priv->parallel_threads != depth) {
+    gst_shared_task_pool_set_max_threads (GST_SHARED_TASK_POOL
+        (priv->parallel_pool), depth);
+    priv->parallel_threads = depth;
+  }
+
+  job = g_new0 (GstBaseTransformJob, 1);
+  job->trans = trans;
+  job->inbuf = inbuf;
+  job->outbuf = outbuf;
+  job->position = position;
+  job->discont = priv->discont;
+  priv->discont = FALSE;
+
+  GST_LOG_OBJECT (trans, "dispatching %p, %u jobs in flight", inbuf,
+      g_queue_get_length (&priv->parallel_jobs));
+
+  g_queue_push_tail (&priv->parallel_jobs, job);
+  g_atomic_int_add (&priv->parallel_n_jobs, 1);
+  job->id = gst_task_pool_push (priv->parallel_pool,
+      (GstTaskPoolFunction) gst_base_transform_job_func, job, NULL);
+  /* no thread available, do it here */
+  if (job->id == NULL)
+    gst_base_transform_job_func (job);
+
+  /* push everything that is done already */
+  while (ret == GST_FLOW_OK && (job = g_queue_peek_head (&priv->parallel_jobs))
+      && g_atomic_int_get (&job->done))
+    ret = gst_base_transform_finish_job (trans);
+
+  if (ret != GST_FLOW_OK)
+    gst_base_transform_discard_jobs (trans);
+
+  return ret;
+
+  /* ERRORS */
+push_failed:
+  {
+    gst_buffer_unref (inbuf);
+    gst_base_transform_discard_jobs (trans);
+    return ret;
+  }
+no_buffer:
+  {
+    gst_buffer_unref (inbuf);
+    GST_WARNING_OBJECT (trans, "could not get buffer from pool: %s",
+        gst_flow_get_name (ret));
+    return ret;
+  }
+}
+
 /* FIXME, getrange is broken, need to pull range from the other
  * end based on the transform_size result.
  */
@@ -2309,6 +2703,8 @@ gst_base_transform_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   GstClockTime position = GST_CLOCK_TIME_NONE;
   GstClockTime timestamp, duration;
   GstBuffer *outbuf = NULL;
+  gboolean parallel;
+  guint depth;
 
   timestamp = GST_BUFFER_TIMESTAMP (buffer);
   duration = GST_BUFFER_DURATION (buffer);
@@ -2330,11 +2726,38 @@ gst_base_transform_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     priv->discont = TRUE;
   }
 
+  /* a previous drain failed, report it now */
+  if (G_UNLIKELY (priv->parallel_flow != GST_FLOW_OK)) {
+    ret = priv->parallel_flow;
+    priv->parallel_flow = GST_FLOW_OK;
+    gst_buffer_unref (buffer);
+    goto done;
+  }
+
+  depth = gst_base_transform_get_parallel_depth (trans);
+  parallel = depth > 1 && gst_base_transform_can_parallel (trans);
+
+  /* renegotiation changes the output format and pool, push what was
+   * produced with the previous configuration first */
+  if (!g_queue_is_empty (&priv->parallel_jobs) &&
+      (!parallel || gst_pad_needs_reconfigure (trans->srcpad))) {
+    ret = gst_base_transform_drain_jobs (trans);
+    if (ret != GST_FLOW_OK) {
+      gst_buffer_unref (buffer);
+      goto done;
+    }
+  }
+
   /* Takes ownership of input buffer */
   ret = klass->submit_input_buffer (trans, priv->discont, buffer);
   if (ret != GST_FLOW_OK)
     goto done;
 
+  if (parallel) {
+    ret = gst_base_transform_dispatch_job (trans, position, depth);
+    goto done;
+  }
+
   do {
     outbuf = NULL;
 
@@ -2405,6 +2828,13 @@ gst_base_transform_set_property (GObject * object, guint prop_id,
     case PROP_QOS:
       gst_base_transform_set_qos_enabled (trans, g_value_get_boolean (value));
       break;
+    case PROP_PARALLEL_DEPTH:
+      GST_OBJECT_LOCK (trans);
+      trans->priv->parallel_depth = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (trans);
+      /* the allocation pool needs room for the buffers in flight */
+      gst_pad_mark_reconfigure (trans->srcpad);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2423,6 +2853,15 @@ gst_base_transform_get_property (GObject * object, guint prop_id,
     case PROP_QOS:
       g_value_set_boolean (value, gst_base_transform_is_qos_enabled (trans));
       break;
+    case PROP_PARALLEL_DEPTH:
+      GST_OBJECT_LOCK (trans);
+      g_value_set_uint (value, trans->priv->parallel_depth);
+      GST_OBJECT_UNLOCK (trans);
+      break;
+    case PROP_PARALLEL_JOBS:
+      g_value_set_uint (value,
+          g_atomic_int_get (&trans->priv->parallel_n_jobs));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2474,6 +2913,8 @@ gst_base_transform_activate (GstBaseTransform * trans, gboolean active)
     /* We must make sure streaming has finished before resetting things
      * and calling the ::stop vfunc */
     GST_PAD_STREAM_LOCK (trans->sinkpad);
+    gst_base_transform_discard_jobs (trans);
+    priv->parallel_flow = GST_FLOW_OK;
     GST_PAD_STREAM_UNLOCK (trans->sinkpad);
 
     priv->have_same_caps = FALSE;
@@ -2809,6 +3250,62 @@ gst_base_transform_set_prefer_passthrough (GstBaseTransform * trans,
   GST_OBJECT_UNLOCK (trans);
 }
 
+/**
+ * gst_base_transform_set_stateless:
+ * @trans: a #GstBaseTransform
+ * @stateless: New state
+ *
+ * If @stateless is %TRUE, the sub-class declares that its transform and
+ * transform_ip functions only depend on the buffers they are given and on
+ * the negotiated configuration, so that they can be called for several
+ * buffers at the same time from different threads. The default is %FALSE.
+ *
+ * A stateless transform processes up to #GstBaseTransform:parallel-depth
+ * buffers in parallel. Output buffers are allocated and pushed in order
+ * from the streaming thread, and serialized events and queries wait for
+ * all buffers before them to be pushed.
+ *
+ * MT safe.
+ *
+ * Since: 1.22
+ */
+void
+gst_base_transform_set_stateless (GstBaseTransform * trans, gboolean stateless)
+{
+  g_return_if_fail (GST_IS_BASE_TRANSFORM (trans));
+
+  GST_OBJECT_LOCK (trans);
+  trans->priv->stateless = stateless;
+  GST_DEBUG_OBJECT (trans, "set stateless %d", stateless);
+  GST_OBJECT_UNLOCK (trans);
+}
+
+/**
+ * gst_base_transform_is_stateless:
+ * @trans: a #GstBaseTransform
+ *
+ * See gst_base_transform_set_stateless().
+ *
+ * Returns: %TRUE if the transform declared itself stateless.
+ *
+ * MT safe.
+ *
+ * Since: 1.22
+ */
+gboolean
+gst_base_transform_is_stateless (GstBaseTransform * trans)
+{
+  gboolean result;
+
+  g_return_val_if_fail (GST_IS_BASE_TRANSFORM (trans), FALSE);
+
+  GST_OBJECT_LOCK (trans);
+  result = trans->priv->stateless;
+  GST_OBJECT_UNLOCK (trans);
+
+  return result;
+}
+
 /**
  * gst_base_transform_reconfigure_sink:
  * @trans: a #GstBaseTransform
@@ -345,6 +345,12 @@ void            gst_base_transform_set_gap_aware    (GstBaseTransform *trans,
 GST_BASE_API
 void            gst_base_transform_set_prefer_passthrough (GstBaseTransform *trans,
                                                            gboolean prefer_passthrough);
+GST_BASE_API
+void            gst_base_transform_set_stateless    (GstBaseTransform *trans,
+                                                     gboolean stateless);
+GST_BASE_API
+gboolean        gst_base_transform_is_stateless     (GstBaseTransform *trans);
+
 GST_BASE_API
 GstBufferPool * gst_base_transform_get_buffer_pool  (GstBaseTransform *trans);
 
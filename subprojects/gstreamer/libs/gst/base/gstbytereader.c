@@ -29,6 +29,21 @@
 #include "gst/glib-compat-private.h"
 #include <string.h>
 
+#if defined (__SSE2__) || defined (_M_X64) || \
+    (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAVE_SCAN_SSE2 1
+#include <emmintrin.h>
+/* AVX2 is selected at runtime, this needs the target attribute */
+#if defined (__GNUC__) && (defined (__clang__) || __GNUC__ > 4 || \
+    (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define HAVE_SCAN_AVX2 1
+#include <immintrin.h>
+#endif
+#elif defined (__ARM_NEON) && defined (__aarch64__)
+#define HAVE_SCAN_NEON 1
+#include <arm_neon.h>
+#endif
+
 /**
  * SECTION:gstbytereader
  * @title: GstByteReader
@@ -862,11 +877,12 @@ gst_byte_reader_dup_data (GstByteReader * reader, guint size, guint8 ** val)
   return _gst_byte_reader_dup_data_inline (reader, size, val);
 }
 
-/* Special optimized scan for mask 0xffffff00 and pattern 0x00000100 */
-static inline gint
-_scan_for_start_code (const guint8 * data, guint size)
+/* Special optimized scan for mask 0xffffff00 and pattern 0x00000100,
+ * starting at @start. A match needs one byte after the 00 00 01. */
+static gint
+_scan_for_start_code_c (const guint8 * data, guint start, guint size)
 {
-  guint8 *pdata = (guint8 *) data;
+  guint8 *pdata = (guint8 *) data + start;
   guint8 *pend = (guint8 *) (data + size - 4);
 
   while (pdata <= pend) {
@@ -885,6 +901,137 @@ _scan_for_start_code (const guint8 * data, guint size)
   return -1;
 }
 
+/* The vector versions compare the blocks at i, i + 1 and i + 2 against
+ * 00, 00 and 01, every lane that matches all three is a start code. A
+ * match at the last lane of a block reads up to 3 bytes after the block,
+ * the rest of the data is done by the C version. */
+#ifdef HAVE_SCAN_SSE2
+static gint
+_scan_for_start_code_sse2 (const guint8 * data, guint size)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i one = _mm_set1_epi8 (1);
+  guint i = 0;
+
+  while (i + 16 + 3 <= size) {
+    __m128i a, b, c;
+    guint mask;
+
+    c = _mm_loadu_si128 ((const __m128i *) (data + i + 2));
+    c = _mm_cmpeq_epi8 (c, one);
+    /* most blocks don't have a 01 byte */
+    if (_mm_movemask_epi8 (c) != 0) {
+      a = _mm_loadu_si128 ((const __m128i *) (data + i));
+      b = _mm_loadu_si128 ((const __m128i *) (data + i + 1));
+      a = _mm_and_si128 (_mm_cmpeq_epi8 (a, zero), _mm_cmpeq_epi8 (b, zero));
+      mask = _mm_movemask_epi8 (_mm_and_si128 (a, c));
+      if (mask != 0)
+        return i + g_bit_nth_lsf (mask, -1);
+    }
+    i += 16;
+  }
+
+  return _scan_for_start_code_c (data, i, size);
+}
+#endif
+
+#ifdef HAVE_SCAN_AVX2
+__attribute__ ((target ("avx2")))
+static gint
+_scan_for_start_code_avx2 (const guint8 * data, guint size)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  const __m256i one = _mm256_set1_epi8 (1);
+  guint i = 0;
+  gint ret;
+
+  while (i + 32 + 3 <= size) {
+    __m256i a, b, c;
+    guint32 mask;
+
+    c = _mm256_loadu_si256 ((const __m256i *) (data + i + 2));
+    c = _mm256_cmpeq_epi8 (c, one);
+    if (_mm256_movemask_epi8 (c) != 0) {
+      a = _mm256_loadu_si256 ((const __m256i *) (data + i));
+      b = _mm256_loadu_si256 ((const __m256i *) (data + i + 1));
+      a = _mm256_and_si256 (_mm256_cmpeq_epi8 (a, zero),
+          _mm256_cmpeq_epi8 (b, zero));
+      mask = (guint32) _mm256_movemask_epi8 (_mm256_and_si256 (a, c));
+      if (mask != 0)
+        return i + g_bit_nth_lsf (mask, -1);
+    }
+    i += 32;
+  }
+
+  ret = _scan_for_start_code_sse2 (data + i, size - i);
+
+  return ret == -1 ? -1 : ret + i;
+}
+#endif
+
+#ifdef HAVE_SCAN_NEON
+static gint
+_scan_for_start_code_neon (const guint8 * data, guint size)
+{
+  const uint8x16_t zero = vdupq_n_u8 (0);
+  const uint8x16_t one = vdupq_n_u8 (1);
+  guint i = 0;
+
+  while (i + 16 + 3 <= size) {
+    uint8x16_t a, b, c;
+
+    c = vceqq_u8 (vld1q_u8 (data + i + 2), one);
+    if (vmaxvq_u8 (c) != 0) {
+      a = vceqq_u8 (vld1q_u8 (data + i), zero);
+      b = vceqq_u8 (vld1q_u8 (data + i + 1), zero);
+      /* there is a start code in this block, let the C version find it */
+      if (vmaxvq_u8 (vandq_u8 (vandq_u8 (a, b), c)) != 0)
+        return _scan_for_start_code_c (data, i, i + 16 + 3);
+    }
+    i += 16;
+  }
+
+  return _scan_for_start_code_c (data, i, size);
+}
+#endif
+
+static gint
+_scan_for_start_code_default (const guint8 * data, guint size)
+{
+  return _scan_for_start_code_c (data, 0, size);
+}
+
+typedef gint (*ScanForStartCodeFunc) (const guint8 * data, guint size);
+
+static ScanForStartCodeFunc
+_get_scan_for_start_code_func (void)
+{
+  static gsize initialized = 0;
+  static ScanForStartCodeFunc func;
+
+  if (g_once_init_enter (&initialized)) {
+    func = _scan_for_start_code_default;
+#if defined (HAVE_SCAN_SSE2)
+    func = _scan_for_start_code_sse2;
+#elif defined (HAVE_SCAN_NEON)
+    func = _scan_for_start_code_neon;
+#endif
+#ifdef HAVE_SCAN_AVX2
+    if (__builtin_cpu_supports ("avx2"))
+      func = _scan_for_start_code_avx2;
+#endif
+    g_once_init_leave (&initialized, 1);
+  }
+
+  return func;
+}
+
+static inline gint
+_scan_for_start_code (const guint8 * data, guint size)
+{
+  return _get_scan_for_start_code_func () (data, size);
+}
+
 static inline guint
 _masked_scan_uint32_peek (const GstByteReader * reader,
     guint32 mask, guint32 pattern, guint offset, guint size, guint32 * value)
@@ -32,12 +32,30 @@
  * gst-launch-1.0 v4l2src num-buffers=1 ! jpegenc ! filesink location=capture1.jpeg
  * ]| Capture one frame from a v4l2 camera and save as jpeg image.
  *
+ * When #GstFileSink:max-write-behind is set, buffers are handed to a writer
+ * thread instead of being written on the streaming thread, so that a slow
+ * write or sync only blocks upstream once that many bytes are waiting. The
+ * writer thread combines what is queued into writes of up to
+ * #GstFileSink:buffer-size bytes. Seeks, buffers with the
+ * %GST_BUFFER_FLAG_SYNC_AFTER flag and EOS wait until everything queued
+ * before them is written.
+ *
+ * |[
+ * gst-launch-1.0 v4l2src ! x264enc ! mp4mux ! filesink location=rec.mp4 max-write-behind=67108864 buffer-size=4194304 direct-io=true sync-interval=1000000000
+ * ]| Record with up to 64MB of pending writes, written in blocks of 4MB
+ * that bypass the page cache, and sync the file to disk every second.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
 #  include "config.h"
 #endif
 
+/* for O_DIRECT */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1
+#endif
+
 #include <glib/gi18n-lib.h>
 
 #include <gst/gst.h>
@@ -111,6 +129,13 @@ GST_DEBUG_CATEGORY_STATIC (gst_file_sink_debug);
 #define DEFAULT_APPEND		FALSE
 #define DEFAULT_O_SYNC		FALSE
 #define DEFAULT_MAX_TRANSIENT_ERROR_TIMEOUT	0
+#define DEFAULT_MAX_WRITE_BEHIND	0
+#define DEFAULT_DIRECT_IO	FALSE
+#define DEFAULT_SYNC_INTERVAL	0
+
+/* offset, size and memory alignment that works for O_DIRECT on all common
+ * file systems and devices */
+#define GST_FILE_SINK_ALIGN	4096
 
 enum
 {
@@ -121,6 +146,10 @@ enum
   PROP_APPEND,
   PROP_O_SYNC,
   PROP_MAX_TRANSIENT_ERROR_TIMEOUT,
+  PROP_MAX_WRITE_BEHIND,
+  PROP_DIRECT_IO,
+  PROP_SYNC_INTERVAL,
+  PROP_STATS,
   PROP_LAST
 };
 
@@ -162,6 +191,7 @@ gst_fopen (const gchar * filename, const gchar * mode, gboolean o_sync)
 }
 
 static void gst_file_sink_dispose (GObject * object);
+static void gst_file_sink_finalize (GObject * object);
 
 static void gst_file_sink_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
@@ -192,6 +222,7 @@ static void gst_file_sink_uri_handler_init (gpointer g_iface,
     gpointer iface_data);
 
 static GstFlowReturn gst_file_sink_flush_buffer (GstFileSink * filesink);
+static GstStructure *gst_file_sink_create_stats (GstFileSink * sink);
 
 #define _do_init \
   G_IMPLEMENT_INTERFACE (GST_TYPE_URI_HANDLER, gst_file_sink_uri_handler_init); \
@@ -210,6 +241,7 @@ gst_file_sink_class_init (GstFileSinkClass * klass)
   GstBaseSinkClass *gstbasesink_class = GST_BASE_SINK_CLASS (klass);
 
   gobject_class->dispose = gst_file_sink_dispose;
+  gobject_class->finalize = gst_file_sink_finalize;
 
   gobject_class->set_property = gst_file_sink_set_property;
   gobject_class->get_property = gst_file_sink_get_property;
@@ -253,6 +285,85 @@ gst_file_sink_class_init (GstFileSinkClass * klass)
           G_MAXINT, DEFAULT_MAX_TRANSIENT_ERROR_TIMEOUT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstFileSink:max-write-behind:
+   *
+   * Write from a separate thread and let up to this many bytes wait for it
+   * before the streaming thread blocks. 0 writes on the streaming thread
+   * with the configured #GstFileSink:buffer-mode.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_WRITE_BEHIND,
+      g_param_spec_uint64 ("max-write-behind", "Max write-behind",
+          "Maximum number of bytes waiting for the writer thread "
+          "(0 = write on the streaming thread)", 0, G_MAXUINT64,
+          DEFAULT_MAX_WRITE_BEHIND, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+          | GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFileSink:direct-io:
+   *
+   * With #GstFileSink:max-write-behind, write whole aligned blocks of
+   * #GstFileSink:buffer-size bytes with O_DIRECT, so that a huge recording
+   * does not evict other data from the page cache. Data that does not fill
+   * an aligned block is written normally. When the file system does not
+   * support it, everything is written normally.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_DIRECT_IO,
+      g_param_spec_boolean ("direct-io", "Direct I/O",
+          "Bypass the page cache when writing behind", DEFAULT_DIRECT_IO,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFileSink:sync-interval:
+   *
+   * With #GstFileSink:max-write-behind, sync the written data to disk at
+   * this interval.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_SYNC_INTERVAL,
+      g_param_spec_uint64 ("sync-interval", "Sync interval",
+          "Interval in nanoseconds to sync the file when writing behind "
+          "(0 = never)", 0, G_MAXUINT64, DEFAULT_SYNC_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFileSink:stats:
+   *
+   * Statistics of the writer thread when #GstFileSink:max-write-behind is
+   * set:
+   *
+   * * #guint64 `queued-bytes`: bytes waiting to be written
+   * * #guint `queued-buffers`: buffers waiting to be written
+   * * #guint64 `max-queued-bytes`: the most bytes that were waiting
+   * * #guint64 `num-writes`: number of writes, each one of up to
+   *   #GstFileSink:buffer-size bytes
+   * * #guint64 `bytes-written`: bytes written to the file, data that is
+   *   still waiting for a whole #GstFileSink:direct-io block is not counted
+   * * #guint64 `direct-bytes-written`: the part of `bytes-written` that was
+   *   written with direct I/O
+   * * #guint64 `num-syncs`: number of syncs done for
+   *   #GstFileSink:sync-interval
+   * * #guint64 `average-latency`: average time from queueing a buffer
+   *   until it was written, in nanoseconds
+   * * #guint64 `max-latency`: longest time from queueing a buffer until it
+   *   was written, in nanoseconds
+   * * #guint64 `wait-time`: time the streaming thread waited for the writer
+   *   thread, in nanoseconds
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Statistics of the writer thread", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (gstelement_class,
       "File Sink",
       "Sink/File", "Write stream to a file",
@@ -287,6 +398,12 @@ gst_file_sink_init (GstFileSink * filesink)
   filesink->buffer_mode = DEFAULT_BUFFER_MODE;
   filesink->buffer_size = DEFAULT_BUFFER_SIZE;
   filesink->append = FALSE;
+  filesink->max_write_behind = DEFAULT_MAX_WRITE_BEHIND;
+  filesink->direct_io = DEFAULT_DIRECT_IO;
+  filesink->sync_interval = DEFAULT_SYNC_INTERVAL;
+  g_mutex_init (&filesink->writer_lock);
+  g_cond_init (&filesink->writer_cond);
+  g_queue_init (&filesink->write_queue);
 
   gst_base_sink_set_sync (GST_BASE_SINK (filesink), FALSE);
 }
@@ -304,6 +421,17 @@ gst_file_sink_dispose (GObject * object)
   sink->filename = NULL;
 }
 
+static void
+gst_file_sink_finalize (GObject * object)
+{
+  GstFileSink *sink = GST_FILE_SINK (object);
+
+  g_mutex_clear (&sink->writer_lock);
+  g_cond_clear (&sink->writer_cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static gboolean
 gst_file_sink_set_location (GstFileSink * sink, const gchar * location,
     GError ** error)
@@ -364,6 +492,15 @@ gst_file_sink_set_property (GObject * object, guint prop_id,
     case PROP_MAX_TRANSIENT_ERROR_TIMEOUT:
       sink->max_transient_error_timeout = g_value_get_int (value);
       break;
+    case PROP_MAX_WRITE_BEHIND:
+      sink->max_write_behind = g_value_get_uint64 (value);
+      break;
+    case PROP_DIRECT_IO:
+      sink->direct_io = g_value_get_boolean (value);
+      break;
+    case PROP_SYNC_INTERVAL:
+      sink->sync_interval = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -395,12 +532,551 @@ gst_file_sink_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_MAX_TRANSIENT_ERROR_TIMEOUT:
       g_value_set_int (value, sink->max_transient_error_timeout);
       break;
+    case PROP_MAX_WRITE_BEHIND:
+      g_value_set_uint64 (value, sink->max_write_behind);
+      break;
+    case PROP_DIRECT_IO:
+      g_value_set_boolean (value, sink->direct_io);
+      break;
+    case PROP_SYNC_INTERVAL:
+      g_value_set_uint64 (value, sink->sync_interval);
+      break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_file_sink_create_stats (sink));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+/* A buffer waiting for the writer thread */
+typedef struct
+{
+  GstBuffer *buffer;
+  gint64 queued;
+} GstFileSinkWrite;
+
+static void
+gst_file_sink_write_free (GstFileSinkWrite * write)
+{
+  gst_buffer_unref (write->buffer);
+  g_free (write);
+}
+
+/* with writer_lock. A batch the writer thread is currently writing stays
+ * accounted in queued_bytes, the writer subtracts it when it is done */
+static void
+gst_file_sink_clear_queue (GstFileSink * sink)
+{
+  GstFileSinkWrite *write;
+
+  while ((write = g_queue_pop_head (&sink->write_queue))) {
+    sink->queued_bytes -= gst_buffer_get_size (write->buffer);
+    gst_file_sink_write_free (write);
+  }
+}
+
+static gboolean
+gst_file_sink_set_direct_io (GstFileSink * sink, gboolean direct)
+{
+#ifdef O_DIRECT
+  gint fd = fileno (sink->file);
+  gint flags;
+
+  if (direct == sink->direct_active)
+    return TRUE;
+
+  flags = fcntl (fd, F_GETFL);
+  if (flags < 0)
+    return FALSE;
+  flags = direct ? flags | O_DIRECT : flags & ~O_DIRECT;
+  if (fcntl (fd, F_SETFL, flags) < 0)
+    return FALSE;
+
+  sink->direct_active = direct;
+  return TRUE;
+#else
+  return !direct;
+#endif
+}
+
+/* Write @size bytes of @data at the write position. When a direct write
+ * fails, the rest is written normally and direct I/O is not used anymore.
+ * Runs on the writer thread. */
+static GstFlowReturn
+gst_file_sink_write_mem (GstFileSink * sink, const guint8 * data, gsize size,
+    gboolean direct)
+{
+  guint64 bytes_written = 0;
+  GstFlowReturn flow = GST_FLOW_OK;
+  gsize done = 0;
+  gssize ret;
+
+  direct = direct && sink->use_direct_io;
+  if (!gst_file_sink_set_direct_io (sink, direct)) {
+    GST_WARNING_OBJECT (sink, "could not %s direct I/O: %s",
+        direct ? "enable" : "disable", g_strerror (errno));
+    sink->use_direct_io = FALSE;
+    direct = FALSE;
+  }
+
+  while (direct && done < size) {
+    ret = write (fileno (sink->file), data + done, size - done);
+    if (ret < 0 && errno == EINTR)
+      continue;
+    if (ret <= 0) {
+      GST_WARNING_OBJECT (sink, "direct write failed, disabling direct I/O: "
+          "%s", g_strerror (errno));
+      sink->use_direct_io = FALSE;
+      gst_file_sink_set_direct_io (sink, FALSE);
+      break;
+    }
+    done += ret;
+    sink->write_pos += ret;
+  }
+
+  if (done < size) {
+    flow = gst_writev_mem (GST_OBJECT_CAST (sink), fileno (sink->file), NULL,
+        data + done, size - done, &bytes_written, 0,
+        sink->max_transient_error_timeout, sink->write_pos, &sink->flushing);
+    sink->write_pos += bytes_written;
+  }
+
+  g_mutex_lock (&sink->writer_lock);
+  sink->bytes_written += done + bytes_written;
+  sink->direct_bytes_written += done;
+  g_mutex_unlock (&sink->writer_lock);
+
+  return flow;
+}
+
+/* Write the staged data with direct writes of whole aligned blocks. What
+ * is left stays staged, unless @all is set. Runs on the writer thread. */
+static GstFlowReturn
+gst_file_sink_write_staged (GstFileSink * sink, gboolean all)
+{
+  guint8 *data = sink->staging_map.data;
+  GstFlowReturn flow;
+  gboolean direct;
+  gsize n, head;
+
+  while (sink->staged > 0) {
+    head = sink->write_pos % GST_FILE_SINK_ALIGN;
+
+    if (!sink->use_direct_io) {
+      n = sink->staged;
+      direct = FALSE;
+    } else if (head == 0) {
+      n = sink->staged - sink->staged % GST_FILE_SINK_ALIGN;
+      direct = TRUE;
+    } else {
+      /* after a seek, write up to the next aligned position first */
+      n = MIN (sink->staged, GST_FILE_SINK_ALIGN - head);
+      direct = FALSE;
+    }
+
+    if (n == 0) {
+      if (!all)
+        break;
+      n = sink->staged;
+      direct = FALSE;
+    }
+
+    flow = gst_file_sink_write_mem (sink, data, n, direct);
+    if (flow != GST_FLOW_OK)
+      return flow;
+
+    sink->staged -= n;
+    memmove (data, data + n, sink->staged);
+  }
+
+  return GST_FLOW_OK;
+}
+
+/* copy the buffers to the aligned staging memory, runs on the writer
+ * thread */
+static GstFlowReturn
+gst_file_sink_write_list_staged (GstFileSink * sink, GstBufferList * list)
+{
+  GstFlowReturn flow;
+  guint i, len;
+
+  len = gst_buffer_list_length (list);
+  for (i = 0; i < len; i++) {
+    GstBuffer *buffer = gst_buffer_list_get (list, i);
+    gsize n, offset = 0, size = gst_buffer_get_size (buffer);
+
+    while (offset < size) {
+      n = gst_buffer_extract (buffer, offset,
+          sink->staging_map.data + sink->staged,
+          sink->staging_map.size - sink->staged);
+      offset += n;
+      sink->staged += n;
+
+      if (sink->staged == sink->staging_map.size) {
+        flow = gst_file_sink_write_staged (sink, FALSE);
+        if (flow != GST_FLOW_OK)
+          return flow;
+      }
+    }
+  }
+
+  return GST_FLOW_OK;
+}
+
+/* runs on the writer thread */
+static GstFlowReturn
+gst_file_sink_writer_sync (GstFileSink * sink)
+{
+  GstFlowReturn flow = GST_FLOW_OK;
+  gint ret;
+
+  if (sink->staging)
+    flow = gst_file_sink_write_staged (sink, TRUE);
+  if (flow != GST_FLOW_OK)
+    return flow;
+
+  GST_LOG_OBJECT (sink, "syncing %" G_GUINT64_FORMAT " bytes",
+      sink->unsynced_bytes);
+
+  do {
+#ifdef HAVE_FDATASYNC
+    ret = fdatasync (fileno (sink->file));
+#else
+    ret = fsync (fileno (sink->file));
+#endif
+  } while (ret < 0 && errno == EINTR);
+
+  sink->last_sync = g_get_monotonic_time ();
+  sink->unsynced_bytes = 0;
+
+  g_mutex_lock (&sink->writer_lock);
+  sink->num_syncs++;
+  g_mutex_unlock (&sink->writer_lock);
+
+  if (ret) {
+    GST_ELEMENT_ERROR (sink, RESOURCE, WRITE,
+        (_("Error while writing to file \"%s\"."), sink->filename),
+        ("%s", g_strerror (errno)));
+    return GST_FLOW_ERROR;
+  }
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+gst_file_sink_sync_due (GstFileSink * sink)
+{
+  return sink->sync_interval > 0 && sink->unsynced_bytes > 0 &&
+      g_get_monotonic_time () >= sink->last_sync +
+      (gint64) (sink->sync_interval / GST_USECOND);
+}
+
+static gpointer
+gst_file_sink_writer_func (GstFileSink * sink)
+{
+  GstBufferList *list = gst_buffer_list_new ();
+  GArray *queued = g_array_new (FALSE, FALSE, sizeof (gint64));
+  GstFileSinkWrite *write;
+  GstFlowReturn flow;
+  guint64 bytes_written;
+  gsize batch;
+  gint64 now;
+  guint i, len;
+
+  g_mutex_lock (&sink->writer_lock);
+  while (TRUE) {
+    if (g_queue_is_empty (&sink->write_queue)) {
+      if (sink->writer_drain) {
+        sink->writing = TRUE;
+        g_mutex_unlock (&sink->writer_lock);
+        flow = sink->staging ? gst_file_sink_write_staged (sink, TRUE) :
+            GST_FLOW_OK;
+        g_mutex_lock (&sink->writer_lock);
+        sink->writing = FALSE;
+        if (flow != GST_FLOW_OK && sink->write_flow == GST_FLOW_OK)
+          sink->write_flow = flow;
+        sink->writer_drain = FALSE;
+        g_cond_broadcast (&sink->writer_cond);
+        continue;
+      }
+      if (sink->writer_stop)
+        break;
+
+      if (gst_file_sink_sync_due (sink)) {
+        sink->writing = TRUE;
+        g_mutex_unlock (&sink->writer_lock);
+        flow = gst_file_sink_writer_sync (sink);
+        g_mutex_lock (&sink->writer_lock);
+        sink->writing = FALSE;
+        if (flow != GST_FLOW_OK && sink->write_flow == GST_FLOW_OK)
+          sink->write_flow = flow;
+        g_cond_broadcast (&sink->writer_cond);
+      } else if (sink->sync_interval > 0 && sink->unsynced_bytes > 0) {
+        g_cond_wait_until (&sink->writer_cond, &sink->writer_lock,
+            sink->last_sync + sink->sync_interval / GST_USECOND);
+      } else {
+        g_cond_wait (&sink->writer_cond, &sink->writer_lock);
+      }
+      continue;
+    }
+
+    /* coalesce what is queued into one write of up to buffer-size bytes */
+    batch = 0;
+    while ((write = g_queue_peek_head (&sink->write_queue))) {
+      gsize size = gst_buffer_get_size (write->buffer);
+
+      if (batch > 0 && batch + size > sink->buffer_size)
+        break;
+
+      g_queue_pop_head (&sink->write_queue);
+      gst_buffer_list_add (list, write->buffer);
+      g_array_append_val (queued, write->queued);
+      batch += size;
+      g_free (write);
+    }
+    sink->writing = TRUE;
+    g_mutex_unlock (&sink->writer_lock);
+
+    GST_LOG_OBJECT (sink, "writing %" G_GSIZE_FORMAT " bytes at position %"
+        G_GUINT64_FORMAT, batch, sink->write_pos);
+
+    /* staged data is counted by gst_file_sink_write_mem() */
+    bytes_written = 0;
+    if (sink->staging) {
+      flow = gst_file_sink_write_list_staged (sink, list);
+    } else {
+      flow = gst_writev_buffer_list (GST_OBJECT_CAST (sink),
+          fileno (sink->file), NULL, list, &bytes_written, 0,
+          sink->max_transient_error_timeout, sink->write_pos, &sink->flushing);
+      sink->write_pos += bytes_written;
+    }
+    sink->unsynced_bytes += batch;
+    if (flow == GST_FLOW_OK && gst_file_sink_sync_due (sink))
+      flow = gst_file_sink_writer_sync (sink);
+
+    len = gst_buffer_list_length (list);
+    gst_buffer_list_remove (list, 0, len);
+    now = g_get_monotonic_time ();
+
+    g_mutex_lock (&sink->writer_lock);
+    sink->writing = FALSE;
+    sink->queued_bytes -= batch;
+    sink->num_writes++;
+    sink->bytes_written += bytes_written;
+    sink->buffers_written += len;
+    for (i = 0; i < len; i++) {
+      GstClockTime latency =
+          (now - g_array_index (queued, gint64, i)) * GST_USECOND;
+
+      sink->total_latency += latency;
+      sink->max_latency = MAX (sink->max_latency, latency);
+    }
+    g_array_set_size (queued, 0);
+
+    if (flow != GST_FLOW_OK) {
+      GST_DEBUG_OBJECT (sink, "write failed: %s", gst_flow_get_name (flow));
+      if (sink->write_flow == GST_FLOW_OK)
+        sink->write_flow = flow;
+      gst_file_sink_clear_queue (sink);
+      sink->staged = 0;
+    }
+    g_cond_broadcast (&sink->writer_cond);
+  }
+  g_mutex_unlock (&sink->writer_lock);
+
+  gst_buffer_list_unref (list);
+  g_array_free (queued, TRUE);
+
+  return NULL;
+}
+
+static void
+gst_file_sink_start_writer (GstFileSink * sink)
+{
+  GstAllocationParams params;
+
+  sink->write_flow = GST_FLOW_OK;
+  sink->queued_bytes = 0;
+  sink->writing = FALSE;
+  sink->writer_drain = FALSE;
+  sink->writer_stop = FALSE;
+  sink->write_pos = sink->current_pos;
+  sink->staged = 0;
+  sink->use_direct_io = FALSE;
+  sink->direct_active = FALSE;
+  sink->last_sync = g_get_monotonic_time ();
+  sink->unsynced_bytes = 0;
+
+  sink->max_queued_bytes = 0;
+  sink->num_writes = 0;
+  sink->bytes_written = 0;
+  sink->direct_bytes_written = 0;
+  sink->num_syncs = 0;
+  sink->buffers_written = 0;
+  sink->total_latency = 0;
+  sink->max_latency = 0;
+  sink->wait_time = 0;
+
+  if (sink->direct_io) {
+#ifdef O_DIRECT
+    if (sink->append) {
+      GST_WARNING_OBJECT (sink, "direct I/O is not used in append mode");
+    } else {
+      gst_allocation_params_init (&params);
+      params.align = GST_FILE_SINK_ALIGN - 1;
+      sink->staging = gst_allocator_alloc (NULL,
+          GST_ROUND_UP_N (MAX (sink->buffer_size, GST_FILE_SINK_ALIGN),
+              GST_FILE_SINK_ALIGN), &params);
+      gst_memory_map (sink->staging, &sink->staging_map, GST_MAP_WRITE);
+      sink->use_direct_io = TRUE;
+    }
+#else
+    GST_WARNING_OBJECT (sink, "direct I/O is not supported on this platform");
+#endif
+  }
+
+  GST_DEBUG_OBJECT (sink, "starting writer, %" G_GUINT64_FORMAT
+      " bytes write-behind%s", sink->max_write_behind,
+      sink->use_direct_io ? ", direct I/O" : "");
+
+  sink->writer = g_thread_new ("filesink-writer",
+      (GThreadFunc) gst_file_sink_writer_func, sink);
+}
+
+static void
+gst_file_sink_stop_writer (GstFileSink * sink)
+{
+  if (sink->writer == NULL)
+    return;
+
+  g_mutex_lock (&sink->writer_lock);
+  sink->writer_stop = TRUE;
+  g_cond_broadcast (&sink->writer_cond);
+  g_mutex_unlock (&sink->writer_lock);
+
+  g_thread_join (sink->writer);
+  sink->writer = NULL;
+
+  g_mutex_lock (&sink->writer_lock);
+  gst_file_sink_clear_queue (sink);
+  g_mutex_unlock (&sink->writer_lock);
+
+  if (sink->staging) {
+    gst_memory_unmap (sink->staging, &sink->staging_map);
+    gst_memory_unref (sink->staging);
+    sink->staging = NULL;
+  }
+}
+
+/* hand @buffer to the writer thread, waits while the write-behind is full */
+static GstFlowReturn
+gst_file_sink_queue_buffer (GstFileSink * sink, GstBuffer * buffer)
+{
+  gsize size = gst_buffer_get_size (buffer);
+  GstFileSinkWrite *write;
+  GstFlowReturn flow;
+  gint64 wait_start = 0;
+
+  if (size == 0)
+    return GST_FLOW_OK;
+
+  g_mutex_lock (&sink->writer_lock);
+  while (sink->write_flow == GST_FLOW_OK && sink->queued_bytes > 0 &&
+      sink->queued_bytes + size > sink->max_write_behind) {
+    if (g_atomic_int_get (&sink->flushing)) {
+      g_mutex_unlock (&sink->writer_lock);
+      flow = gst_base_sink_wait_preroll (GST_BASE_SINK (sink));
+      if (flow != GST_FLOW_OK)
+        return flow;
+      g_mutex_lock (&sink->writer_lock);
+      continue;
+    }
+    if (wait_start == 0)
+      wait_start = g_get_monotonic_time ();
+    g_cond_wait (&sink->writer_cond, &sink->writer_lock);
+  }
+  if (wait_start)
+    sink->wait_time += (g_get_monotonic_time () - wait_start) * GST_USECOND;
+
+  flow = sink->write_flow;
+  if (flow == GST_FLOW_OK) {
+    write = g_new (GstFileSinkWrite, 1);
+    write->buffer = gst_buffer_ref (buffer);
+    write->queued = g_get_monotonic_time ();
+    g_queue_push_tail (&sink->write_queue, write);
+
+    sink->queued_bytes += size;
+    sink->max_queued_bytes = MAX (sink->max_queued_bytes, sink->queued_bytes);
+    sink->current_pos += size;
+    g_cond_broadcast (&sink->writer_cond);
+  }
+  g_mutex_unlock (&sink->writer_lock);
+
+  return flow;
+}
+
+/* wait until everything that was queued is written, or until flushing */
+static GstFlowReturn
+gst_file_sink_drain (GstFileSink * sink)
+{
+  GstFlowReturn flow;
+
+  g_mutex_lock (&sink->writer_lock);
+  sink->writer_drain = TRUE;
+  g_cond_broadcast (&sink->writer_cond);
+  while (sink->writer_drain && !g_atomic_int_get (&sink->flushing))
+    g_cond_wait (&sink->writer_cond, &sink->writer_lock);
+  if (sink->writer_drain)
+    flow = GST_FLOW_FLUSHING;
+  else
+    flow = sink->write_flow;
+  g_mutex_unlock (&sink->writer_lock);
+
+  return flow;
+}
+
+/* drop everything that was not written yet */
+static void
+gst_file_sink_discard_writes (GstFileSink * sink)
+{
+  g_mutex_lock (&sink->writer_lock);
+  gst_file_sink_clear_queue (sink);
+  /* a drain that was interrupted by the flush is not wanted anymore */
+  sink->writer_drain = FALSE;
+  while (sink->writing)
+    g_cond_wait (&sink->writer_cond, &sink->writer_lock);
+  /* the writer has subtracted what it was writing */
+  g_assert (sink->queued_bytes == 0);
+  sink->staged = 0;
+  sink->write_flow = GST_FLOW_OK;
+  g_mutex_unlock (&sink->writer_lock);
+}
+
+static GstStructure *
+gst_file_sink_create_stats (GstFileSink * sink)
+{
+  GstStructure *s;
+
+  g_mutex_lock (&sink->writer_lock);
+  s = gst_structure_new ("application/x-file-sink-stats",
+      "queued-bytes", G_TYPE_UINT64, sink->queued_bytes,
+      "queued-buffers", G_TYPE_UINT, g_queue_get_length (&sink->write_queue),
+      "max-queued-bytes", G_TYPE_UINT64, sink->max_queued_bytes,
+      "num-writes", G_TYPE_UINT64, sink->num_writes,
+      "bytes-written", G_TYPE_UINT64, sink->bytes_written,
+      "direct-bytes-written", G_TYPE_UINT64, sink->direct_bytes_written,
+      "num-syncs", G_TYPE_UINT64, sink->num_syncs,
+      "average-latency", G_TYPE_UINT64, sink->buffers_written ?
+      sink->total_latency / sink->buffers_written : 0,
+      "max-latency", G_TYPE_UINT64, sink->max_latency,
+      "wait-time", G_TYPE_UINT64, sink->wait_time, NULL);
+  g_mutex_unlock (&sink->writer_lock);
+
+  return s;
+}
+
 static gboolean
 gst_file_sink_open_file (GstFileSink * sink)
 {
@@ -426,7 +1102,13 @@ gst_file_sink_open_file (GstFileSink * sink)
     gst_buffer_list_unref (sink->buffer_list);
   sink->buffer_list = NULL;
 
-  if (sink->buffer_mode != GST_FILE_SINK_BUFFER_MODE_UNBUFFERED) {
+  if (sink->max_write_behind > 0) {
+    if (sink->buffer_size == 0) {
+      sink->buffer_size = DEFAULT_BUFFER_SIZE;
+      g_object_notify (G_OBJECT (sink), "buffer-size");
+    }
+    gst_file_sink_start_writer (sink);
+  } else if (sink->buffer_mode != GST_FILE_SINK_BUFFER_MODE_UNBUFFERED) {
     if (sink->buffer_size == 0) {
       sink->buffer_size = DEFAULT_BUFFER_SIZE;
       g_object_notify (G_OBJECT (sink), "buffer-size");
@@ -470,6 +1152,8 @@ gst_file_sink_close_file (GstFileSink * sink)
       GST_ELEMENT_ERROR (sink, RESOURCE, CLOSE,
           (_("Error closing file \"%s\"."), sink->filename), NULL);
 
+    gst_file_sink_stop_writer (sink);
+
     if (fclose (sink->file) != 0)
       GST_ELEMENT_ERROR (sink, RESOURCE, CLOSE,
           (_("Error closing file \"%s\"."), sink->filename), GST_ERROR_SYSTEM);
@@ -577,6 +1261,10 @@ gst_file_sink_do_seek (GstFileSink * filesink, guint64 new_offset)
    * presumably this should basically yield new_offset */
   gst_file_sink_get_current_offset (filesink, &filesink->current_pos);
 
+  /* the writer is idle after flushing */
+  if (filesink->writer)
+    filesink->write_pos = filesink->current_pos;
+
   return TRUE;
 
   /* ERRORS */
@@ -632,6 +1320,12 @@ gst_file_sink_event (GstBaseSink * sink, GstEvent * event)
       break;
     }
     case GST_EVENT_FLUSH_STOP:
+      if (filesink->writer) {
+        gst_file_sink_discard_writes (filesink);
+        /* the writer is idle now, the base class would only clear this
+         * after we return but the seek below has to drain the writer */
+        g_atomic_int_set (&filesink->flushing, FALSE);
+      }
       if (filesink->current_pos != 0 && filesink->seekable) {
         gst_file_sink_do_seek (filesink, 0);
         if (ftruncate (fileno (filesink->file), 0))
@@ -753,6 +1447,9 @@ gst_file_sink_flush_buffer (GstFileSink * filesink)
 {
   GstFlowReturn flow_ret = GST_FLOW_OK;
 
+  if (filesink->writer)
+    return gst_file_sink_drain (filesink);
+
   GST_DEBUG_OBJECT (filesink, "Flushing out buffer of size %" G_GSIZE_FORMAT,
       filesink->current_buffer_size);
 
@@ -866,7 +1563,14 @@ gst_file_sink_render_list (GstBaseSink * bsink, GstBufferList * buffer_list)
 
   gst_buffer_list_foreach (buffer_list, has_sync_after_buffer, &sync_after);
 
-  if (sync_after || (!sink->buffer && !sink->buffer_list)) {
+  if (sink->writer) {
+    flow = GST_FLOW_OK;
+    for (i = 0; i < num_buffers && flow == GST_FLOW_OK; i++)
+      flow = gst_file_sink_queue_buffer (sink,
+          gst_buffer_list_get (buffer_list, i));
+    if (flow == GST_FLOW_OK && sync_after)
+      flow = gst_file_sink_flush_buffer (sink);
+  } else if (sync_after || (!sink->buffer && !sink->buffer_list)) {
     flow = gst_file_sink_flush_buffer (sink);
     if (flow == GST_FLOW_OK)
       flow = gst_file_sink_render_list_internal (sink, buffer_list);
@@ -955,7 +1659,11 @@ gst_file_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 
   n_mem = gst_buffer_n_memory (buffer);
 
-  if (n_mem > 0 && (sync_after || (!filesink->buffer
+  if (n_mem > 0 && filesink->writer) {
+    flow = gst_file_sink_queue_buffer (filesink, buffer);
+    if (flow == GST_FLOW_OK && sync_after)
+      flow = gst_file_sink_flush_buffer (filesink);
+  } else if (n_mem > 0 && (sync_after || (!filesink->buffer
               && !filesink->buffer_list))) {
     flow = gst_file_sink_flush_buffer (filesink);
     if (flow == GST_FLOW_OK) {
@@ -1048,6 +1756,11 @@ gst_file_sink_unlock (GstBaseSink * basesink)
   filesink = GST_FILE_SINK_CAST (basesink);
   g_atomic_int_set (&filesink->flushing, TRUE);
 
+  /* wake up the streaming thread if it waits for the writer */
+  g_mutex_lock (&filesink->writer_lock);
+  g_cond_broadcast (&filesink->writer_cond);
+  g_mutex_unlock (&filesink->writer_lock);
+
   return TRUE;
 }
 
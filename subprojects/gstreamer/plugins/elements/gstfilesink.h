@@ -96,6 +96,42 @@ struct _GstFileSink {
   gint max_transient_error_timeout;
 
   gboolean flushing;
+
+  guint64 max_write_behind;
+  gboolean direct_io;
+  GstClockTime sync_interval;
+
+  /* write-behind, protected by writer_lock */
+  GThread *writer;
+  GMutex writer_lock;
+  GCond writer_cond;
+  GQueue write_queue;
+  guint64 queued_bytes;
+  gboolean writing;
+  gboolean writer_drain;
+  gboolean writer_stop;
+  GstFlowReturn write_flow;
+
+  /* only used by the writer thread, or while it is idle */
+  guint64 write_pos;
+  GstMemory *staging;
+  GstMapInfo staging_map;
+  gsize staged;
+  gboolean use_direct_io;
+  gboolean direct_active;
+  gint64 last_sync;
+  guint64 unsynced_bytes;
+
+  /* statistics, protected by writer_lock */
+  guint64 max_queued_bytes;
+  guint64 num_writes;
+  guint64 bytes_written;
+  guint64 direct_bytes_written;
+  guint64 num_syncs;
+  guint64 buffers_written;
+  GstClockTime total_latency;
+  GstClockTime max_latency;
+  GstClockTime wait_time;
 };
 
 struct _GstFileSinkClass {
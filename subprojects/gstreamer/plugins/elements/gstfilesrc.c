@@ -31,12 +31,29 @@
  * gst-launch-1.0 filesrc location=song.ogg ! decodebin ! audioconvert ! audioresample ! autoaudiosink
  * ]| Play song.ogg audio file which must be in the current working directory.
  *
+ * When #GstFileSrc:prefetch is set on a regular file, the file is read in
+ * blocks of #GstFileSrc:prefetch-size bytes by a pool of threads. As long as
+ * the requested offsets move forward, as when pushing or when a demuxer
+ * pulls the samples of an interleaved file, up to #GstFileSrc:prefetch
+ * blocks after the current one are read ahead and the streaming thread only
+ * copies from blocks that are already there. A jump to an offset that is not
+ * cached stops the read-ahead until the access is sequential again.
+ *
+ * |[
+ * gst-launch-1.0 filesrc location=movie.mp4 prefetch=4 direct-io=true ! qtdemux ! ...
+ * ]| Read movie.mp4 with four 1MB reads in flight, bypassing the page cache.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
 #  include "config.h"
 #endif
 
+/* for O_DIRECT */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1
+#endif
+
 #include <gst/gst.h>
 #include <glib/gstdio.h>
 #include "gstfilesrc.h"
@@ -110,11 +127,44 @@ enum
 };
 
 #define DEFAULT_BLOCKSIZE       4*1024
+#define DEFAULT_PREFETCH        0
+#define DEFAULT_PREFETCH_SIZE   (1024 * 1024)
+#define DEFAULT_DIRECT_IO       FALSE
+
+/* offset, size and memory alignment that works for O_DIRECT on all common
+ * file systems and devices */
+#define GST_FILE_SRC_ALIGN      4096
 
 enum
 {
   PROP_0,
-  PROP_LOCATION
+  PROP_LOCATION,
+  PROP_PREFETCH,
+  PROP_PREFETCH_SIZE,
+  PROP_DIRECT_IO
+};
+
+typedef enum
+{
+  BLOCK_EMPTY,
+  BLOCK_PENDING,
+  BLOCK_DONE
+} GstFileSrcBlockState;
+
+/* One aligned block of the file. The streaming thread owns all blocks that
+ * are not pending, only the read of a pending block runs on a pool
+ * thread. */
+struct _GstFileSrcBlock
+{
+  GstFileSrc *src;
+  GstMemory *mem;
+  GstMapInfo map;
+
+  GstFileSrcBlockState state;
+  guint64 offset;
+  gsize filled;
+  gint error;
+  guint64 last_use;
 };
 
 static void gst_file_src_finalize (GObject * object);
@@ -163,6 +213,53 @@ gst_file_src_class_init (GstFileSrcClass * klass)
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
           GST_PARAM_MUTABLE_READY));
 
+  /**
+   * GstFileSrc:prefetch:
+   *
+   * Number of blocks that are read ahead of the current read position while
+   * the file is read sequentially. 0 reads the data on the streaming thread
+   * when it is requested.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_PREFETCH,
+      g_param_spec_uint ("prefetch", "Prefetch",
+          "Number of blocks to read ahead (0 = disabled)", 0, 64,
+          DEFAULT_PREFETCH, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFileSrc:prefetch-size:
+   *
+   * Size of the blocks that are read ahead, rounded up to a multiple of
+   * 4096 bytes.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_PREFETCH_SIZE,
+      g_param_spec_uint ("prefetch-size", "Prefetch size",
+          "Size in bytes of one read ahead", GST_FILE_SRC_ALIGN,
+          G_MAXINT / 2, DEFAULT_PREFETCH_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFileSrc:direct-io:
+   *
+   * Read regular files with O_DIRECT, so that the data does not go through
+   * and evict other data from the page cache. This is useful when a huge
+   * file is read only once. All reads are done in aligned blocks of
+   * #GstFileSrc:prefetch-size bytes. When the file system does not support
+   * it, the file is read normally.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_DIRECT_IO,
+      g_param_spec_boolean ("direct-io", "Direct I/O",
+          "Bypass the page cache when reading regular files",
+          DEFAULT_DIRECT_IO, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
   gobject_class->finalize = gst_file_src_finalize;
 
   gst_element_class_set_static_metadata (gstelement_class,
@@ -193,6 +290,12 @@ gst_file_src_init (GstFileSrc * src)
 
   src->is_regular = FALSE;
 
+  src->prefetch = DEFAULT_PREFETCH;
+  src->prefetch_size = DEFAULT_PREFETCH_SIZE;
+  src->direct_io = DEFAULT_DIRECT_IO;
+  g_mutex_init (&src->prefetch_lock);
+  g_cond_init (&src->prefetch_cond);
+
   gst_base_src_set_blocksize (GST_BASE_SRC (src), DEFAULT_BLOCKSIZE);
 }
 
@@ -205,6 +308,8 @@ gst_file_src_finalize (GObject * object)
 
   g_free (src->filename);
   g_free (src->uri);
+  g_mutex_clear (&src->prefetch_lock);
+  g_cond_clear (&src->prefetch_cond);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -270,6 +375,15 @@ gst_file_src_set_property (GObject * object, guint prop_id,
     case PROP_LOCATION:
       gst_file_src_set_location (src, g_value_get_string (value), NULL);
       break;
+    case PROP_PREFETCH:
+      src->prefetch = g_value_get_uint (value);
+      break;
+    case PROP_PREFETCH_SIZE:
+      src->prefetch_size = g_value_get_uint (value);
+      break;
+    case PROP_DIRECT_IO:
+      src->direct_io = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -290,12 +404,387 @@ gst_file_src_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_LOCATION:
       g_value_set_string (value, src->filename);
       break;
+    case PROP_PREFETCH:
+      g_value_set_uint (value, src->prefetch);
+      break;
+    case PROP_PREFETCH_SIZE:
+      g_value_set_uint (value, src->prefetch_size);
+      break;
+    case PROP_DIRECT_IO:
+      g_value_set_boolean (value, src->direct_io);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+#ifdef HAVE_PREAD
+/* read @size bytes at @offset, stops early at the end of the file. Returns 0
+ * or the errno of the failed read */
+static gint
+gst_file_src_pread (GstFileSrc * src, guint8 * data, gsize size,
+    guint64 offset, gsize * filled)
+{
+  gssize ret;
+
+  *filled = 0;
+  while (*filled < size) {
+    ret = pread (src->fd, data + *filled, size - *filled,
+        (off_t) (offset + *filled));
+    if (G_UNLIKELY (ret < 0)) {
+      if (errno == EAGAIN || errno == EINTR)
+        continue;
+      return errno;
+    }
+    if (ret == 0)
+      break;
+
+    *filled += ret;
+
+    /* with O_DIRECT the next read would be unaligned, this can only be the
+     * end of the file */
+    if (src->using_direct_io && *filled % GST_FILE_SRC_ALIGN != 0)
+      break;
+  }
+
+  return 0;
+}
+
+static void
+gst_file_src_block_read (GstFileSrcBlock * block)
+{
+  GstFileSrc *src = block->src;
+  gsize filled;
+  gint error;
+
+  error = gst_file_src_pread (src, block->map.data, src->block_size,
+      block->offset, &filled);
+
+  g_mutex_lock (&src->prefetch_lock);
+  block->filled = filled;
+  block->error = error;
+  block->state = BLOCK_DONE;
+  g_cond_broadcast (&src->prefetch_cond);
+  g_mutex_unlock (&src->prefetch_lock);
+}
+
+/* with prefetch_lock */
+static GstFileSrcBlock *
+gst_file_src_find_block (GstFileSrc * src, guint64 offset)
+{
+  guint i;
+
+  for (i = 0; i < src->n_blocks; i++) {
+    GstFileSrcBlock *block = &src->blocks[i];
+
+    if (block->state != BLOCK_EMPTY && block->offset == offset)
+      return block;
+  }
+  return NULL;
+}
+
+/* Get a block that can be reused, never one of the blocks between @start and
+ * @end that are about to be read. When @wait is set and all other blocks are
+ * still being read, wait until one of them is done. With prefetch_lock. */
+static GstFileSrcBlock *
+gst_file_src_get_free_block (GstFileSrc * src, guint64 start, guint64 end,
+    gboolean wait)
+{
+  GstFileSrcBlock *best;
+  guint i;
+
+  while (TRUE) {
+    best = NULL;
+    for (i = 0; i < src->n_blocks; i++) {
+      GstFileSrcBlock *block = &src->blocks[i];
+
+      if (block->state == BLOCK_EMPTY)
+        return block;
+      if (block->state == BLOCK_PENDING)
+        continue;
+      if (block->offset >= start && block->offset < end)
+        continue;
+      if (best == NULL || block->last_use < best->last_use)
+        best = block;
+    }
+    if (best || !wait)
+      return best;
+
+    g_cond_wait (&src->prefetch_cond, &src->prefetch_lock);
+  }
+}
+
+/* start reading @block at @offset, with prefetch_lock */
+static void
+gst_file_src_submit_block (GstFileSrc * src, GstFileSrcBlock * block,
+    guint64 offset)
+{
+  gpointer id = NULL;
+
+  GST_LOG_OBJECT (src, "reading block at offset 0x%" G_GINT64_MODIFIER "x",
+      offset);
+
+  block->state = BLOCK_PENDING;
+  block->offset = offset;
+  block->filled = 0;
+  block->error = 0;
+  block->last_use = ++src->use_count;
+
+  if (src->prefetch_pool)
+    id = gst_task_pool_push (src->prefetch_pool,
+        (GstTaskPoolFunction) gst_file_src_block_read, block, NULL);
+
+  if (id) {
+    gst_task_pool_dispose_handle (src->prefetch_pool, id);
+  } else {
+    /* no thread available, read it here */
+    g_mutex_unlock (&src->prefetch_lock);
+    gst_file_src_block_read (block);
+    g_mutex_lock (&src->prefetch_lock);
+  }
+}
+
+static GstFlowReturn
+gst_file_src_fill_blocks (GstFileSrc * src, guint64 offset, guint length,
+    GstBuffer * buf)
+{
+  GstFileSrcBlock *block;
+  guint64 block_offset, window, refreshed = -1;
+  gsize bytes_read, skip, filled, n;
+  gboolean sequential;
+  GstMapInfo info;
+  gint error;
+  guint i;
+
+  /* moving forward, possibly skipping a bit, is what we read ahead for */
+  sequential = offset >= src->last_offset
+      && offset <= src->last_end + src->block_size;
+  if (sequential != src->sequential)
+    GST_DEBUG_OBJECT (src, "%s access at offset 0x%" G_GINT64_MODIFIER "x",
+        sequential ? "sequential" : "random", offset);
+  src->sequential = sequential;
+  window = (guint64) src->n_blocks * src->block_size;
+
+  if (!gst_buffer_map (buf, &info, GST_MAP_WRITE))
+    goto buffer_write_fail;
+
+  block_offset = offset - offset % src->block_size;
+  g_mutex_lock (&src->prefetch_lock);
+  block = gst_file_src_find_block (src, block_offset);
+  g_mutex_unlock (&src->prefetch_lock);
+
+  /* a random read of data that is not cached goes straight into the buffer,
+   * unless the reads have to be aligned */
+  if (!sequential && block == NULL && !src->using_direct_io) {
+    error = gst_file_src_pread (src, info.data, length, offset, &bytes_read);
+    if (G_UNLIKELY (error))
+      goto could_not_read;
+    goto done;
+  }
+
+  bytes_read = 0;
+  while (bytes_read < length) {
+    guint64 pos = offset + bytes_read;
+
+    block_offset = pos - pos % src->block_size;
+
+    g_mutex_lock (&src->prefetch_lock);
+    block = gst_file_src_find_block (src, block_offset);
+    if (block == NULL) {
+      block = gst_file_src_get_free_block (src, block_offset,
+          block_offset + window, TRUE);
+      gst_file_src_submit_block (src, block, block_offset);
+    }
+
+    if (sequential) {
+      for (i = 1; i <= src->prefetch; i++) {
+        guint64 ahead = block_offset + i * src->block_size;
+        GstFileSrcBlock *next;
+
+        /* no need to read beyond the end of the file */
+        if (block->state == BLOCK_DONE && block->filled < src->block_size)
+          break;
+        if (gst_file_src_find_block (src, ahead))
+          continue;
+        next = gst_file_src_get_free_block (src, block_offset,
+            block_offset + window, FALSE);
+        if (next == NULL)
+          break;
+        gst_file_src_submit_block (src, next, ahead);
+      }
+    }
+
+    while (block->state == BLOCK_PENDING)
+      g_cond_wait (&src->prefetch_cond, &src->prefetch_lock);
+    block->last_use = ++src->use_count;
+    filled = block->filled;
+    error = block->error;
+    /* read it again next time */
+    if (G_UNLIKELY (error))
+      block->state = BLOCK_EMPTY;
+    g_mutex_unlock (&src->prefetch_lock);
+
+    if (G_UNLIKELY (error))
+      goto could_not_read;
+
+    skip = pos - block_offset;
+    if (skip >= filled) {
+      /* the block ended at the end of the file, which might have grown
+       * since the block was read */
+      if (refreshed != block_offset) {
+        refreshed = block_offset;
+        block->state = BLOCK_EMPTY;
+        continue;
+      }
+      break;
+    }
+
+    /* the block is not pending, so it's ours and only the streaming thread
+     * can reuse it */
+    n = MIN (filled - skip, length - bytes_read);
+    memcpy (info.data + bytes_read, block->map.data + skip, n);
+    bytes_read += n;
+  }
+
+done:
+  gst_buffer_unmap (buf, &info);
+
+  /* files should eos if they read 0 and more was requested */
+  if (G_UNLIKELY (bytes_read == 0 && length > 0))
+    goto eos;
+
+  if (bytes_read != length)
+    gst_buffer_resize (buf, 0, bytes_read);
+
+  src->last_offset = offset;
+  src->last_end = offset + bytes_read;
+
+  GST_BUFFER_OFFSET (buf) = offset;
+  GST_BUFFER_OFFSET_END (buf) = offset + bytes_read;
+
+  return GST_FLOW_OK;
+
+  /* ERROR */
+could_not_read:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, READ, (NULL), ("system error: %s",
+            g_strerror (error)));
+    gst_buffer_unmap (buf, &info);
+    gst_buffer_resize (buf, 0, 0);
+    return GST_FLOW_ERROR;
+  }
+eos:
+  {
+    GST_DEBUG ("EOS");
+    gst_buffer_resize (buf, 0, 0);
+    return GST_FLOW_EOS;
+  }
+buffer_write_fail:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, WRITE, (NULL), ("Can't write to buffer"));
+    return GST_FLOW_ERROR;
+  }
+}
+
+static void
+gst_file_src_start_prefetch (GstFileSrc * src)
+{
+  GstAllocationParams params;
+  guint i;
+
+  gst_allocation_params_init (&params);
+  params.align = GST_FILE_SRC_ALIGN - 1;
+
+#ifdef O_DIRECT
+  if (src->direct_io) {
+    int flags = fcntl (src->fd, F_GETFL);
+
+    if (flags >= 0 && fcntl (src->fd, F_SETFL, flags | O_DIRECT) == 0)
+      src->using_direct_io = TRUE;
+    else
+      GST_WARNING_OBJECT (src, "could not enable direct I/O: %s",
+          g_strerror (errno));
+  }
+#else
+  if (src->direct_io)
+    GST_WARNING_OBJECT (src, "direct I/O is not supported on this platform");
+#endif
+
+  if (src->prefetch == 0 && !src->using_direct_io)
+    return;
+
+  src->block_size = GST_ROUND_UP_N (src->prefetch_size, GST_FILE_SRC_ALIGN);
+  /* the current block and the ones read ahead */
+  src->n_blocks = src->prefetch + 1;
+  src->blocks = g_new0 (GstFileSrcBlock, src->n_blocks);
+  for (i = 0; i < src->n_blocks; i++) {
+    GstFileSrcBlock *block = &src->blocks[i];
+
+    block->src = src;
+    block->mem = gst_allocator_alloc (NULL, src->block_size, &params);
+    gst_memory_map (block->mem, &block->map, GST_MAP_WRITE);
+  }
+  src->use_count = 0;
+  src->last_offset = 0;
+  src->last_end = 0;
+  src->sequential = TRUE;
+
+  if (src->prefetch > 0) {
+    GError *err = NULL;
+
+    src->prefetch_pool = gst_shared_task_pool_new ();
+    gst_shared_task_pool_set_max_threads (GST_SHARED_TASK_POOL
+        (src->prefetch_pool), src->prefetch);
+    gst_task_pool_prepare (src->prefetch_pool, &err);
+    if (err) {
+      /* everything will be read on the streaming thread */
+      GST_WARNING_OBJECT (src, "could not start prefetching: %s",
+          err->message);
+      g_clear_error (&err);
+      gst_object_unref (src->prefetch_pool);
+      src->prefetch_pool = NULL;
+    }
+  }
+
+  GST_DEBUG_OBJECT (src, "reading blocks of %u bytes, %u ahead%s",
+      src->block_size, src->prefetch,
+      src->using_direct_io ? ", direct I/O" : "");
+}
+#endif
+
+static void
+gst_file_src_stop_prefetch (GstFileSrc * src)
+{
+  guint i;
+
+  if (src->blocks == NULL)
+    return;
+
+  /* the reads still use the fd and the blocks */
+  g_mutex_lock (&src->prefetch_lock);
+  for (i = 0; i < src->n_blocks; i++) {
+    while (src->blocks[i].state == BLOCK_PENDING)
+      g_cond_wait (&src->prefetch_cond, &src->prefetch_lock);
+  }
+  g_mutex_unlock (&src->prefetch_lock);
+
+  if (src->prefetch_pool) {
+    gst_task_pool_cleanup (src->prefetch_pool);
+    gst_object_unref (src->prefetch_pool);
+    src->prefetch_pool = NULL;
+  }
+
+  for (i = 0; i < src->n_blocks; i++) {
+    gst_memory_unmap (src->blocks[i].mem, &src->blocks[i].map);
+    gst_memory_unref (src->blocks[i].mem);
+  }
+  g_free (src->blocks);
+  src->blocks = NULL;
+  src->n_blocks = 0;
+  src->using_direct_io = FALSE;
+}
+
 /***
  * read code below
  * that is to say, you shouldn't read the code below, but the code that reads
@@ -318,6 +807,11 @@ gst_file_src_fill (GstBaseSrc * basesrc, guint64 offset, guint length,
 
   src = GST_FILE_SRC_CAST (basesrc);
 
+#ifdef HAVE_PREAD
+  if (src->blocks)
+    return gst_file_src_fill_blocks (src, offset, length, buf);
+#endif
+
   if (G_UNLIKELY (offset != -1 && src->read_position != offset)) {
     off_t res;
 
@@ -537,6 +1031,12 @@ gst_file_src_start (GstBaseSrc * basesrc)
 
   gst_base_src_set_dynamic_size (basesrc, src->seekable);
 
+  /* blocks are read with pread(), which needs a regular file */
+#ifdef HAVE_PREAD
+  if (src->seekable)
+    gst_file_src_start_prefetch (src);
+#endif
+
   return TRUE;
 
   /* ERROR */
@@ -600,6 +1100,8 @@ gst_file_src_stop (GstBaseSrc * basesrc)
 {
   GstFileSrc *src = GST_FILE_SRC (basesrc);
 
+  gst_file_src_stop_prefetch (src);
+
   /* close the file */
   g_close (src->fd, NULL);
 
@@ -45,6 +45,7 @@ G_BEGIN_DECLS
 
 typedef struct _GstFileSrc GstFileSrc;
 typedef struct _GstFileSrcClass GstFileSrcClass;
+typedef struct _GstFileSrcBlock GstFileSrcBlock;
 
 /**
  * GstFileSrc:
@@ -63,6 +64,25 @@ struct _GstFileSrc {
   gboolean seekable;                    /* whether the file is seekable */
   gboolean is_regular;                  /* whether it's a (symlink to a)
                                            regular file */
+
+  guint prefetch;                       /* number of reads ahead */
+  guint prefetch_size;                  /* size of one prefetch read */
+  gboolean direct_io;                   /* bypass the page cache */
+  gboolean using_direct_io;             /* O_DIRECT is set on fd */
+
+  /* prefetching, protected by prefetch_lock */
+  GMutex prefetch_lock;
+  GCond prefetch_cond;
+  GstTaskPool *prefetch_pool;
+  GstFileSrcBlock *blocks;
+  guint n_blocks;
+  guint block_size;
+  guint64 use_count;
+
+  /* access pattern, only used from the streaming thread */
+  guint64 last_offset;
+  guint64 last_end;
+  gboolean sequential;
 };
 
 struct _GstFileSrcClass {
@@ -110,6 +110,37 @@
  */
 typedef struct _GstSingleQueue GstSingleQueue;
 
+/* GstMultiQueueHeap:
+ *
+ * Binary heap of single queues. Every queue stores its position in the heap
+ * (plus one, 0 when it is not in the heap) in the guint at @index_offset, so
+ * that it can be moved or removed when its values change.
+ */
+typedef gboolean (*GstMultiQueueHeapBefore) (GstSingleQueue * a,
+    GstSingleQueue * b);
+
+struct _GstMultiQueueHeap
+{
+  GPtrArray *items;
+  GstMultiQueueHeapBefore before;
+  goffset index_offset;
+};
+
+/* GstMultiQueueGroup:
+ *
+ * The queues with the same group-id, with their own ordering of the times
+ * for computing the high time of the group.
+ */
+typedef struct
+{
+  guint groupid;
+  guint count;
+  GstClockTimeDiff high_time;
+
+  GstMultiQueueHeap *waiting_times;
+  GstMultiQueueHeap *linked_times;
+} GstMultiQueueGroup;
+
 struct _GstSingleQueue
 {
   gint refcount;
@@ -118,7 +149,8 @@ struct _GstSingleQueue
   guint id;
   /* group of streams to which this queue belongs to */
   guint groupid;
-  GstClockTimeDiff group_high_time;
+  /* Protected by global lock, NULL once released */
+  GstMultiQueueGroup *group;
 
   GWeakRef mqueue;
   GWeakRef sinkpad;
@@ -165,6 +197,12 @@ struct _GstSingleQueue
   GstClockTimeDiff last_time;   /* Start running time of last pushed buffer */
   GCond turn;                   /* SingleQueue turn waiting conditional */
 
+  /* Protected by global lock, positions in the heaps of the multiqueue and
+   * of the group */
+  guint waiting_id_idx, linked_id_idx;
+  guint waiting_time_idx, linked_time_idx;
+  guint group_waiting_time_idx, group_linked_time_idx;
+
   /* for serialized queries */
   GCond query_handled;
   gboolean last_query;
@@ -191,13 +229,182 @@ struct _GstMultiQueueItem
   gboolean is_query;
 };
 
+#define HEAP_INDEX(heap, sq) \
+    G_STRUCT_MEMBER (guint, (sq), (heap)->index_offset)
+#define HEAP_ITEM(heap, i) \
+    ((GstSingleQueue *) g_ptr_array_index ((heap)->items, (i)))
+
+static GstMultiQueueHeap *
+gst_multi_queue_heap_new (GstMultiQueueHeapBefore before, goffset index_offset)
+{
+  GstMultiQueueHeap *heap = g_new0 (GstMultiQueueHeap, 1);
+
+  heap->items = g_ptr_array_new ();
+  heap->before = before;
+  heap->index_offset = index_offset;
+
+  return heap;
+}
+
+static void
+gst_multi_queue_heap_free (GstMultiQueueHeap * heap)
+{
+  guint i;
+
+  /* the queues can outlive the heap */
+  for (i = 0; i < heap->items->len; i++)
+    HEAP_INDEX (heap, HEAP_ITEM (heap, i)) = 0;
+
+  g_ptr_array_free (heap->items, TRUE);
+  g_free (heap);
+}
+
+static inline GstSingleQueue *
+gst_multi_queue_heap_top (GstMultiQueueHeap * heap)
+{
+  return heap->items->len ? HEAP_ITEM (heap, 0) : NULL;
+}
+
+static inline void
+gst_multi_queue_heap_set (GstMultiQueueHeap * heap, guint i,
+    GstSingleQueue * sq)
+{
+  g_ptr_array_index (heap->items, i) = sq;
+  HEAP_INDEX (heap, sq) = i + 1;
+}
+
+/* returns TRUE if the queue at @i moved */
+static gboolean
+gst_multi_queue_heap_sift_up (GstMultiQueueHeap * heap, guint i)
+{
+  GstSingleQueue *sq = HEAP_ITEM (heap, i);
+  guint start = i;
+
+  while (i > 0) {
+    guint parent = (i - 1) / 2;
+    GstSingleQueue *psq = HEAP_ITEM (heap, parent);
+
+    if (!heap->before (sq, psq))
+      break;
+    gst_multi_queue_heap_set (heap, i, psq);
+    i = parent;
+  }
+  gst_multi_queue_heap_set (heap, i, sq);
+
+  return i != start;
+}
+
+static void
+gst_multi_queue_heap_sift_down (GstMultiQueueHeap * heap, guint i)
+{
+  GstSingleQueue *sq = HEAP_ITEM (heap, i);
+  guint len = heap->items->len;
+
+  while (2 * i + 1 < len) {
+    guint child = 2 * i + 1;
+    GstSingleQueue *csq;
+
+    if (child + 1 < len
+        && heap->before (HEAP_ITEM (heap, child + 1), HEAP_ITEM (heap, child)))
+      child++;
+    csq = HEAP_ITEM (heap, child);
+
+    if (!heap->before (csq, sq))
+      break;
+    gst_multi_queue_heap_set (heap, i, csq);
+    i = child;
+  }
+  gst_multi_queue_heap_set (heap, i, sq);
+}
+
+/* Adds @sq to @heap or moves it to its new place when @member is TRUE,
+ * removes it from @heap otherwise */
+static void
+gst_multi_queue_heap_update (GstMultiQueueHeap * heap, GstSingleQueue * sq,
+    gboolean member)
+{
+  guint idx = HEAP_INDEX (heap, sq);
+
+  if (member) {
+    if (idx == 0) {
+      g_ptr_array_add (heap->items, sq);
+      idx = heap->items->len;
+    }
+    if (!gst_multi_queue_heap_sift_up (heap, idx - 1))
+      gst_multi_queue_heap_sift_down (heap, idx - 1);
+  } else if (idx != 0) {
+    GstSingleQueue *last;
+
+    HEAP_INDEX (heap, sq) = 0;
+    last = g_ptr_array_remove_index (heap->items, heap->items->len - 1);
+    if (last != sq) {
+      gst_multi_queue_heap_set (heap, idx - 1, last);
+      if (!gst_multi_queue_heap_sift_up (heap, idx - 1))
+        gst_multi_queue_heap_sift_down (heap, idx - 1);
+    }
+  }
+}
+
+static gboolean
+nextid_before (GstSingleQueue * a, GstSingleQueue * b)
+{
+  return a->nextid < b->nextid;
+}
+
+static gboolean
+oldid_before (GstSingleQueue * a, GstSingleQueue * b)
+{
+  return a->oldid > b->oldid;
+}
+
+static gboolean
+next_time_before (GstSingleQueue * a, GstSingleQueue * b)
+{
+  return a->next_time < b->next_time;
+}
+
+static gboolean
+last_time_before (GstSingleQueue * a, GstSingleQueue * b)
+{
+  return a->last_time > b->last_time;
+}
+
+static GstMultiQueueGroup *
+gst_multi_queue_group_new (guint groupid)
+{
+  GstMultiQueueGroup *group = g_new0 (GstMultiQueueGroup, 1);
+
+  group->groupid = groupid;
+  group->high_time = GST_CLOCK_STIME_NONE;
+  group->waiting_times = gst_multi_queue_heap_new (next_time_before,
+      G_STRUCT_OFFSET (GstSingleQueue, group_waiting_time_idx));
+  group->linked_times = gst_multi_queue_heap_new (last_time_before,
+      G_STRUCT_OFFSET (GstSingleQueue, group_linked_time_idx));
+
+  return group;
+}
+
+static void
+gst_multi_queue_group_free (GstMultiQueueGroup * group)
+{
+  gst_multi_queue_heap_free (group->waiting_times);
+  gst_multi_queue_heap_free (group->linked_times);
+  g_free (group);
+}
+
+#define SQ_GROUP_HIGH_TIME(sq) \
+    ((sq)->group ? (sq)->group->high_time : GST_CLOCK_STIME_NONE)
+
 static GstSingleQueue *gst_single_queue_new (GstMultiQueue * mqueue, guint id);
 static void gst_single_queue_unref (GstSingleQueue * squeue);
 static GstSingleQueue *gst_single_queue_ref (GstSingleQueue * squeue);
 
 static void wake_up_next_non_linked (GstMultiQueue * mq);
 static void compute_high_id (GstMultiQueue * mq);
-static void compute_high_time (GstMultiQueue * mq, guint groupid);
+static void compute_high_time (GstMultiQueue * mq, GstMultiQueueGroup * group);
+static void update_tracking (GstMultiQueue * mq, GstSingleQueue * sq);
+static void track_single_queue (GstMultiQueue * mq, GstSingleQueue * sq);
+static void untrack_single_queue (GstMultiQueue * mq, GstSingleQueue * sq);
 static void single_queue_overrun_cb (GstDataQueue * dq, GstSingleQueue * sq);
 static void single_queue_underrun_cb (GstDataQueue * dq, GstSingleQueue * sq);
 
@@ -369,13 +576,13 @@ gst_multiqueue_pad_get_group_id (GstMultiQueuePad * pad)
   mq = g_weak_ref_get (&pad->sq->mqueue);
 
   if (mq) {
-    GST_OBJECT_LOCK (mq);
+    GST_MULTI_QUEUE_MUTEX_LOCK (mq);
   }
 
   ret = pad->sq->groupid;
 
   if (mq) {
-    GST_OBJECT_UNLOCK (mq);
+    GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
     gst_object_unref (mq);
   }
 
@@ -502,14 +709,20 @@ gst_multiqueue_pad_set_property (GObject * object, guint prop_id,
       if (pad->sq) {
         GstMultiQueue *mqueue = g_weak_ref_get (&pad->sq->mqueue);
 
-        if (mqueue)
-          GST_OBJECT_LOCK (mqueue);
-
-        pad->sq->groupid = g_value_get_uint (value);
-
         if (mqueue) {
-          GST_OBJECT_UNLOCK (mqueue);
+          GST_MULTI_QUEUE_MUTEX_LOCK (mqueue);
+          /* move the queue over to its new group */
+          if (pad->sq->group) {
+            untrack_single_queue (mqueue, pad->sq);
+            pad->sq->groupid = g_value_get_uint (value);
+            track_single_queue (mqueue, pad->sq);
+          } else {
+            pad->sq->groupid = g_value_get_uint (value);
+          }
+          GST_MULTI_QUEUE_MUTEX_UNLOCK (mqueue);
           gst_object_unref (mqueue);
+        } else {
+          pad->sq->groupid = g_value_get_uint (value);
         }
       }
       break;
@@ -875,6 +1088,18 @@ gst_multi_queue_init (GstMultiQueue * mqueue)
   mqueue->highid = -1;
   mqueue->high_time = GST_CLOCK_STIME_NONE;
 
+  mqueue->waiting_ids = gst_multi_queue_heap_new (nextid_before,
+      G_STRUCT_OFFSET (GstSingleQueue, waiting_id_idx));
+  mqueue->linked_ids = gst_multi_queue_heap_new (oldid_before,
+      G_STRUCT_OFFSET (GstSingleQueue, linked_id_idx));
+  mqueue->waiting_times = gst_multi_queue_heap_new (next_time_before,
+      G_STRUCT_OFFSET (GstSingleQueue, waiting_time_idx));
+  mqueue->linked_times = gst_multi_queue_heap_new (last_time_before,
+      G_STRUCT_OFFSET (GstSingleQueue, linked_time_idx));
+  mqueue->groups =
+      g_ptr_array_new_with_free_func ((GDestroyNotify)
+      gst_multi_queue_group_free);
+
   g_mutex_init (&mqueue->qlock);
   g_mutex_init (&mqueue->buffering_post_lock);
 }
@@ -883,12 +1108,21 @@ static void
 gst_multi_queue_finalize (GObject * object)
 {
   GstMultiQueue *mqueue = GST_MULTI_QUEUE (object);
+  GList *tmp;
 
+  /* the queues can outlive us through their pads */
+  for (tmp = mqueue->queues; tmp; tmp = g_list_next (tmp))
+    untrack_single_queue (mqueue, (GstSingleQueue *) tmp->data);
   g_list_free_full (mqueue->queues, (GDestroyNotify) gst_single_queue_unref);
   mqueue->queues = NULL;
   mqueue->queues_cookie++;
 
   /* free/unref instance data */
+  gst_multi_queue_heap_free (mqueue->waiting_ids);
+  gst_multi_queue_heap_free (mqueue->linked_ids);
+  gst_multi_queue_heap_free (mqueue->waiting_times);
+  gst_multi_queue_heap_free (mqueue->linked_times);
+  g_ptr_array_free (mqueue->groups, TRUE);
   g_mutex_clear (&mqueue->qlock);
   g_mutex_clear (&mqueue->buffering_post_lock);
 
@@ -1242,7 +1476,11 @@ gst_multi_queue_release_pad (GstElement * element, GstPad * pad)
   mqueue->queues = g_list_delete_link (mqueue->queues, tmp);
   mqueue->queues_cookie++;
 
-  /* FIXME : recompute next-non-linked */
+  /* recompute next-non-linked without this queue */
+  untrack_single_queue (mqueue, sq);
+  compute_high_id (mqueue);
+  compute_high_time (mqueue, NULL);
+  wake_up_next_non_linked (mqueue);
   GST_MULTI_QUEUE_MUTEX_UNLOCK (mqueue);
 
   /* delete SingleQueue */
@@ -1371,6 +1609,7 @@ gst_single_queue_flush (GstMultiQueue * mq, GstSingleQueue * sq, gboolean flush,
   if (flush) {
     GST_MULTI_QUEUE_MUTEX_LOCK (mq);
     sq->srcresult = GST_FLOW_FLUSHING;
+    update_tracking (mq, sq);
     gst_data_queue_set_flushing (sq->queue, TRUE);
 
     sq->flushing = TRUE;
@@ -1402,7 +1641,9 @@ gst_single_queue_flush (GstMultiQueue * mq, GstSingleQueue * sq, gboolean flush,
     sq->next_time = GST_CLOCK_STIME_NONE;
     sq->last_time = GST_CLOCK_STIME_NONE;
     sq->cached_sinktime = GST_CLOCK_STIME_NONE;
-    sq->group_high_time = GST_CLOCK_STIME_NONE;
+    if (sq->group)
+      sq->group->high_time = GST_CLOCK_STIME_NONE;
+    update_tracking (mq, sq);
     gst_data_queue_set_flushing (sq->queue, FALSE);
 
     /* We will become active again on the next buffer/gap */
@@ -1480,10 +1721,12 @@ update_buffering (GstMultiQueue * mq, GstSingleQueue * sq)
     percent = MAX (mq->buffering_percent, percent);
 
     SET_PERCENT (mq, percent);
-  } else {
+  } else if (buffering_level < mq->low_watermark) {
     GList *iter;
     gboolean is_buffering = TRUE;
 
+    /* only look at the other queues when this one dropped below the low
+     * watermark, which keeps this cheap for the common case */
     for (iter = mq->queues; iter; iter = g_list_next (iter)) {
       GstSingleQueue *oq = (GstSingleQueue *) iter->data;
 
@@ -1494,7 +1737,7 @@ update_buffering (GstMultiQueue * mq, GstSingleQueue * sq)
       }
     }
 
-    if (is_buffering && buffering_level < mq->low_watermark) {
+    if (is_buffering) {
       mq->buffering = TRUE;
       SET_PERCENT (mq, percent);
     }
@@ -1698,6 +1941,7 @@ update_time_level (GstMultiQueue * mq, GstSingleQueue * sq)
        * In order for the high_time computation to be as efficient as possible,
        * we set the last_time */
       sq->last_time = sink_time;
+      update_tracking (mq, sq);
     }
     if (G_UNLIKELY (sink_time != GST_CLOCK_STIME_NONE)) {
       /* if we have a time, we become untainted and use the time */
@@ -2187,29 +2431,32 @@ next:
     /* Update the oldid (the last ID we output) for highid tracking */
     if (sq->last_oldid != G_MAXUINT32)
       sq->oldid = sq->last_oldid;
+    update_tracking (mq, sq);
 
     if (sq->srcresult == GST_FLOW_NOT_LINKED) {
       gboolean should_wait;
+      GstClockTimeDiff group_high_time;
       /* Go to sleep until it's time to push this buffer */
 
       /* Recompute the highid */
       compute_high_id (mq);
       /* Recompute the high time */
-      compute_high_time (mq, sq->groupid);
+      compute_high_time (mq, sq->group);
+      group_high_time = SQ_GROUP_HIGH_TIME (sq);
 
       GST_DEBUG_OBJECT (mq,
           "groupid %d high_time %" GST_STIME_FORMAT " next_time %"
-          GST_STIME_FORMAT, sq->groupid, GST_STIME_ARGS (sq->group_high_time),
+          GST_STIME_FORMAT, sq->groupid, GST_STIME_ARGS (group_high_time),
           GST_STIME_ARGS (next_time));
 
       if (mq->sync_by_running_time) {
-        if (sq->group_high_time == GST_CLOCK_STIME_NONE) {
+        if (group_high_time == GST_CLOCK_STIME_NONE) {
           should_wait = GST_CLOCK_STIME_IS_VALID (next_time) &&
               (mq->high_time == GST_CLOCK_STIME_NONE
               || next_time > mq->high_time);
         } else {
           should_wait = GST_CLOCK_STIME_IS_VALID (next_time) &&
-              next_time > sq->group_high_time;
+              next_time > group_high_time;
         }
       } else
         should_wait = newid > mq->highid;
@@ -2220,7 +2467,7 @@ next:
             "queue %d sleeping for not-linked wakeup with "
             "newid %u, highid %u, next_time %" GST_STIME_FORMAT
             ", high_time %" GST_STIME_FORMAT, sq->id, newid, mq->highid,
-            GST_STIME_ARGS (next_time), GST_STIME_ARGS (sq->group_high_time));
+            GST_STIME_ARGS (next_time), GST_STIME_ARGS (group_high_time));
 
         /* Wake up all non-linked pads before we sleep */
         wake_up_next_non_linked (mq);
@@ -2235,24 +2482,25 @@ next:
         }
 
         /* Recompute the high time and ID */
-        compute_high_time (mq, sq->groupid);
+        compute_high_time (mq, sq->group);
         compute_high_id (mq);
+        group_high_time = SQ_GROUP_HIGH_TIME (sq);
 
         GST_DEBUG_OBJECT (mq, "queue %d woken from sleeping for not-linked "
             "wakeup with newid %u, highid %u, next_time %" GST_STIME_FORMAT
             ", high_time %" GST_STIME_FORMAT " mq high_time %" GST_STIME_FORMAT,
             sq->id, newid, mq->highid,
-            GST_STIME_ARGS (next_time), GST_STIME_ARGS (sq->group_high_time),
+            GST_STIME_ARGS (next_time), GST_STIME_ARGS (group_high_time),
             GST_STIME_ARGS (mq->high_time));
 
         if (mq->sync_by_running_time) {
-          if (sq->group_high_time == GST_CLOCK_STIME_NONE) {
+          if (group_high_time == GST_CLOCK_STIME_NONE) {
             should_wait = GST_CLOCK_STIME_IS_VALID (next_time) &&
                 (mq->high_time == GST_CLOCK_STIME_NONE
                 || next_time > mq->high_time);
           } else {
             should_wait = GST_CLOCK_STIME_IS_VALID (next_time) &&
-                next_time > sq->group_high_time;
+                next_time > group_high_time;
           }
         } else
           should_wait = newid > mq->highid;
@@ -2260,16 +2508,17 @@ next:
 
       /* Re-compute the high_id in case someone else pushed */
       compute_high_id (mq);
-      compute_high_time (mq, sq->groupid);
+      compute_high_time (mq, sq->group);
     } else {
       compute_high_id (mq);
-      compute_high_time (mq, sq->groupid);
+      compute_high_time (mq, sq->group);
       /* Wake up all non-linked pads */
       wake_up_next_non_linked (mq);
     }
     /* We're done waiting, we can clear the nextid and nexttime */
     sq->nextid = 0;
     sq->next_time = GST_CLOCK_STIME_NONE;
+    update_tracking (mq, sq);
   }
   GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
 
@@ -2283,8 +2532,10 @@ next:
   GST_MULTI_QUEUE_MUTEX_LOCK (mq);
   next_time = get_running_time (&sq->src_segment, object, TRUE);
   if (GST_CLOCK_STIME_IS_VALID (next_time)) {
-    if (sq->last_time == GST_CLOCK_STIME_NONE || sq->last_time < next_time)
+    if (sq->last_time == GST_CLOCK_STIME_NONE || sq->last_time < next_time) {
       sq->last_time = next_time;
+      update_tracking (mq, sq);
+    }
     if (mq->high_time == GST_CLOCK_STIME_NONE || mq->high_time <= next_time) {
       /* Wake up all non-linked pads now that we advanced the high time */
       mq->high_time = next_time;
@@ -2314,7 +2565,7 @@ next:
         sq->id);
 
     compute_high_id (mq);
-    compute_high_time (mq, sq->groupid);
+    compute_high_time (mq, sq->group);
     do_update_buffering = TRUE;
 
     /* maybe no-one is waiting */
@@ -2327,6 +2578,7 @@ next:
           GST_LOG_OBJECT (mq, "Waking up singlequeue %d", sq2->id);
           sq2->pushed = FALSE;
           sq2->srcresult = GST_FLOW_OK;
+          update_tracking (mq, sq2);
           g_cond_signal (&sq2->turn);
         }
       }
@@ -2356,6 +2608,7 @@ next:
   }
   sq->srcresult = result;
   sq->last_oldid = newid;
+  update_tracking (mq, sq);
 
   if (do_update_buffering)
     update_buffering (mq, sq);
@@ -2370,7 +2623,7 @@ next:
   GST_MULTI_QUEUE_MUTEX_LOCK (mq);
   if (mq->numwaiting > 0 && (GST_PAD_IS_EOS (srcpad)
           || sq->srcresult == GST_FLOW_EOS)) {
-    compute_high_time (mq, sq->groupid);
+    compute_high_time (mq, sq->group);
     compute_high_id (mq);
     wake_up_next_non_linked (mq);
   }
@@ -2569,6 +2822,7 @@ gst_multi_queue_sink_activate_mode (GstPad * pad, GstObject * parent,
   }
 
   if (mq) {
+    update_tracking (mq, sq);
     GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
     gst_object_unref (mq);
   }
@@ -2730,8 +2984,10 @@ gst_multi_queue_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       /* a new segment allows us to accept more buffers if we got EOS
        * from downstream */
       GST_MULTI_QUEUE_MUTEX_LOCK (mq);
-      if (sq->srcresult == GST_FLOW_EOS)
+      if (sq->srcresult == GST_FLOW_EOS) {
         sq->srcresult = GST_FLOW_OK;
+        update_tracking (mq, sq);
+      }
       GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
       break;
     case GST_EVENT_GAP:
@@ -2902,6 +3158,7 @@ gst_multi_queue_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
       GST_MULTI_QUEUE_MUTEX_LOCK (mq);
       if (sq->srcresult == GST_FLOW_NOT_LINKED) {
         sq->srcresult = GST_FLOW_OK;
+        update_tracking (mq, sq);
         g_cond_signal (&sq->turn);
       }
       GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
@@ -2938,11 +3195,141 @@ gst_multi_queue_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
  * Next-non-linked functions
  */
 
+/* WITH LOCK TAKEN
+ * Puts @sq into the heaps it belongs to, must be called whenever anything
+ * that the high-id and high-time computations look at changed */
+static void
+update_tracking (GstMultiQueue * mq, GstSingleQueue * sq)
+{
+  GstMultiQueueGroup *group = sq->group;
+  GstPad *srcpad;
+  gboolean not_linked = FALSE, linked = FALSE;
+  gboolean waiting_time, linked_time;
+
+  /* released */
+  if (!group)
+    return;
+
+  srcpad = g_weak_ref_get (&sq->srcpad);
+  if (srcpad) {
+    not_linked = sq->srcresult == GST_FLOW_NOT_LINKED;
+    /* queues whose output is at EOS are ignored */
+    linked = !not_linked && sq->srcresult != GST_FLOW_EOS
+        && !GST_PAD_IS_EOS (srcpad);
+    gst_object_unref (srcpad);
+  }
+
+  /* queues without nextid or next_time are not waiting */
+  gst_multi_queue_heap_update (mq->waiting_ids, sq, not_linked
+      && sq->nextid != 0);
+  gst_multi_queue_heap_update (mq->linked_ids, sq, linked && sq->nextid != 0);
+
+  waiting_time = not_linked && GST_CLOCK_STIME_IS_VALID (sq->next_time);
+  linked_time = linked && GST_CLOCK_STIME_IS_VALID (sq->last_time);
+  gst_multi_queue_heap_update (mq->waiting_times, sq, waiting_time);
+  gst_multi_queue_heap_update (mq->linked_times, sq, linked_time);
+  gst_multi_queue_heap_update (group->waiting_times, sq, waiting_time);
+  gst_multi_queue_heap_update (group->linked_times, sq, linked_time);
+}
+
+/* WITH LOCK TAKEN */
+static void
+track_single_queue (GstMultiQueue * mq, GstSingleQueue * sq)
+{
+  GstMultiQueueGroup *group = NULL;
+  guint i;
+
+  for (i = 0; i < mq->groups->len; i++) {
+    GstMultiQueueGroup *g = g_ptr_array_index (mq->groups, i);
+
+    if (g->groupid == sq->groupid) {
+      group = g;
+      break;
+    }
+  }
+
+  if (!group) {
+    group = gst_multi_queue_group_new (sq->groupid);
+    g_ptr_array_add (mq->groups, group);
+  }
+
+  group->count++;
+  sq->group = group;
+  update_tracking (mq, sq);
+}
+
+/* WITH LOCK TAKEN */
+static void
+untrack_single_queue (GstMultiQueue * mq, GstSingleQueue * sq)
+{
+  GstMultiQueueGroup *group = sq->group;
+
+  if (!group)
+    return;
+
+  gst_multi_queue_heap_update (mq->waiting_ids, sq, FALSE);
+  gst_multi_queue_heap_update (mq->linked_ids, sq, FALSE);
+  gst_multi_queue_heap_update (mq->waiting_times, sq, FALSE);
+  gst_multi_queue_heap_update (mq->linked_times, sq, FALSE);
+  gst_multi_queue_heap_update (group->waiting_times, sq, FALSE);
+  gst_multi_queue_heap_update (group->linked_times, sq, FALSE);
+  sq->group = NULL;
+
+  if (--group->count == 0)
+    g_ptr_array_remove_fast (mq->groups, group);
+}
+
+/* WITH LOCK TAKEN
+ * Wakes up the queues of the subtree at @i of the waiting_ids heap whose
+ * nextid is at most the high-id. The heap is ordered by nextid, so the
+ * subtrees starting with a later id can be skipped */
+static void
+wake_up_waiting_ids (GstMultiQueue * mq, guint i)
+{
+  GstMultiQueueHeap *heap = mq->waiting_ids;
+  GstSingleQueue *sq;
+
+  if (i >= heap->items->len)
+    return;
+
+  sq = HEAP_ITEM (heap, i);
+  if (sq->nextid > mq->highid)
+    return;
+
+  GST_LOG_OBJECT (mq, "Waking up singlequeue %d", sq->id);
+  g_cond_signal (&sq->turn);
+
+  wake_up_waiting_ids (mq, 2 * i + 1);
+  wake_up_waiting_ids (mq, 2 * i + 2);
+}
+
+/* WITH LOCK TAKEN
+ * Same as above with the next_time of the waiting_times heap of a group */
+static void
+wake_up_waiting_times (GstMultiQueue * mq, GstMultiQueueHeap * heap, guint i,
+    GstClockTimeDiff high_time)
+{
+  GstSingleQueue *sq;
+
+  if (i >= heap->items->len)
+    return;
+
+  sq = HEAP_ITEM (heap, i);
+  if (sq->next_time > high_time)
+    return;
+
+  GST_LOG_OBJECT (mq, "Waking up singlequeue %d", sq->id);
+  g_cond_signal (&sq->turn);
+
+  wake_up_waiting_times (mq, heap, 2 * i + 1, high_time);
+  wake_up_waiting_times (mq, heap, 2 * i + 2, high_time);
+}
+
 /* WITH LOCK TAKEN */
 static void
 wake_up_next_non_linked (GstMultiQueue * mq)
 {
-  GList *tmp;
+  guint i;
 
   /* maybe no-one is waiting */
   if (mq->numwaiting < 1)
@@ -2950,34 +3337,20 @@ wake_up_next_non_linked (GstMultiQueue * mq)
 
   if (mq->sync_by_running_time && GST_CLOCK_STIME_IS_VALID (mq->high_time)) {
     /* Else figure out which singlequeue(s) need waking up */
-    for (tmp = mq->queues; tmp; tmp = tmp->next) {
-      GstSingleQueue *sq = (GstSingleQueue *) tmp->data;
-      if (sq->srcresult == GST_FLOW_NOT_LINKED) {
-        GstClockTimeDiff high_time;
-
-        if (GST_CLOCK_STIME_IS_VALID (sq->group_high_time))
-          high_time = sq->group_high_time;
-        else
-          high_time = mq->high_time;
-
-        if (GST_CLOCK_STIME_IS_VALID (sq->next_time) &&
-            GST_CLOCK_STIME_IS_VALID (high_time)
-            && sq->next_time <= high_time) {
-          GST_LOG_OBJECT (mq, "Waking up singlequeue %d", sq->id);
-          g_cond_signal (&sq->turn);
-        }
-      }
+    for (i = 0; i < mq->groups->len; i++) {
+      GstMultiQueueGroup *group = g_ptr_array_index (mq->groups, i);
+      GstClockTimeDiff high_time;
+
+      if (GST_CLOCK_STIME_IS_VALID (group->high_time))
+        high_time = group->high_time;
+      else
+        high_time = mq->high_time;
+
+      wake_up_waiting_times (mq, group->waiting_times, 0, high_time);
     }
   } else {
     /* Else figure out which singlequeue(s) need waking up */
-    for (tmp = mq->queues; tmp; tmp = tmp->next) {
-      GstSingleQueue *sq = (GstSingleQueue *) tmp->data;
-      if (sq->srcresult == GST_FLOW_NOT_LINKED &&
-          sq->nextid != 0 && sq->nextid <= mq->highid) {
-        GST_LOG_OBJECT (mq, "Waking up singlequeue %d", sq->id);
-        g_cond_signal (&sq->turn);
-      }
-    }
+    wake_up_waiting_ids (mq, 0);
   }
 }
 
@@ -2987,43 +3360,18 @@ compute_high_id (GstMultiQueue * mq)
 {
   /* The high-id is either the highest id among the linked pads, or if all
    * pads are not-linked, it's the lowest not-linked pad */
-  GList *tmp;
+  GstSingleQueue *sq;
   guint32 lowest = G_MAXUINT32;
   guint32 highid = G_MAXUINT32;
 
-  for (tmp = mq->queues; tmp; tmp = g_list_next (tmp)) {
-    GstSingleQueue *sq = (GstSingleQueue *) tmp->data;
-    GstPad *srcpad = g_weak_ref_get (&sq->srcpad);
-
-    if (!srcpad) {
-      GST_INFO_OBJECT (mq,
-          "srcpad has been removed already... ignoring single queue");
-
-      continue;
-    }
-
-    GST_LOG_OBJECT (mq, "inspecting sq:%d , nextid:%d, oldid:%d, srcresult:%s",
-        sq->id, sq->nextid, sq->oldid, gst_flow_get_name (sq->srcresult));
+  /* the lowest nextid of the not-linked queues */
+  if ((sq = gst_multi_queue_heap_top (mq->waiting_ids)))
+    lowest = sq->nextid;
 
-    /* No need to consider queues which are not waiting */
-    if (sq->nextid == 0) {
-      GST_LOG_OBJECT (mq, "sq:%d is not waiting - ignoring", sq->id);
-      gst_object_unref (srcpad);
-      continue;
-    }
-
-    if (sq->srcresult == GST_FLOW_NOT_LINKED) {
-      if (sq->nextid < lowest)
-        lowest = sq->nextid;
-    } else if (!GST_PAD_IS_EOS (srcpad) && sq->srcresult != GST_FLOW_EOS) {
-      /* If we don't have a global highid, or the global highid is lower than
-       * this single queue's last outputted id, store the queue's one,
-       * unless the singlequeue output is at EOS */
-      if ((highid == G_MAXUINT32) || (sq->oldid > highid))
-        highid = sq->oldid;
-    }
-    gst_object_unref (srcpad);
-  }
+  /* the highest last outputted id of the linked queues, unless their output
+   * is at EOS */
+  if ((sq = gst_multi_queue_heap_top (mq->linked_ids)))
+    highid = sq->oldid;
 
   if (highid == G_MAXUINT32 || lowest < highid)
     mq->highid = lowest;
@@ -3036,105 +3384,60 @@ compute_high_id (GstMultiQueue * mq)
 
 /* WITH LOCK TAKEN */
 static void
-compute_high_time (GstMultiQueue * mq, guint groupid)
+compute_high_time (GstMultiQueue * mq, GstMultiQueueGroup * group)
 {
   /* The high-time is either the highest last time among the linked
    * pads, or if all pads are not-linked, it's the lowest nex time of
    * not-linked pad */
-  GList *tmp;
+  GstSingleQueue *sq;
   GstClockTimeDiff highest = GST_CLOCK_STIME_NONE;
   GstClockTimeDiff lowest = GST_CLOCK_STIME_NONE;
   GstClockTimeDiff group_high = GST_CLOCK_STIME_NONE;
   GstClockTimeDiff group_low = GST_CLOCK_STIME_NONE;
   GstClockTimeDiff res;
-  /* Number of streams which belong to groupid */
-  guint group_count = 0;
 
   if (!mq->sync_by_running_time)
     /* return GST_CLOCK_STIME_NONE; */
     return;
 
-  for (tmp = mq->queues; tmp; tmp = tmp->next) {
-    GstSingleQueue *sq = (GstSingleQueue *) tmp->data;
-    GstPad *srcpad = g_weak_ref_get (&sq->srcpad);
-
-    if (!srcpad) {
-      GST_INFO_OBJECT (mq,
-          "srcpad has been removed already... ignoring single queue");
-
-      continue;
-    }
-
-    GST_LOG_OBJECT (mq,
-        "inspecting sq:%d (group:%d) , next_time:%" GST_STIME_FORMAT
-        ", last_time:%" GST_STIME_FORMAT ", srcresult:%s", sq->id, sq->groupid,
-        GST_STIME_ARGS (sq->next_time), GST_STIME_ARGS (sq->last_time),
-        gst_flow_get_name (sq->srcresult));
-
-    if (sq->groupid == groupid)
-      group_count++;
-
-    if (sq->srcresult == GST_FLOW_NOT_LINKED) {
-      /* No need to consider queues which are not waiting */
-      if (!GST_CLOCK_STIME_IS_VALID (sq->next_time)) {
-        GST_LOG_OBJECT (mq, "sq:%d is not waiting - ignoring", sq->id);
-        gst_object_unref (srcpad);
-        continue;
-      }
-
-      if (lowest == GST_CLOCK_STIME_NONE || sq->next_time < lowest)
-        lowest = sq->next_time;
-      if (sq->groupid == groupid && (group_low == GST_CLOCK_STIME_NONE
-              || sq->next_time < group_low))
-        group_low = sq->next_time;
-    } else if (!GST_PAD_IS_EOS (srcpad) && sq->srcresult != GST_FLOW_EOS) {
-      /* If we don't have a global high time, or the global high time
-       * is lower than this single queue's last outputted time, store
-       * the queue's one, unless the singlequeue output is at EOS. */
-      if (highest == GST_CLOCK_STIME_NONE
-          || (sq->last_time != GST_CLOCK_STIME_NONE && sq->last_time > highest))
-        highest = sq->last_time;
-      if (sq->groupid == groupid && (group_high == GST_CLOCK_STIME_NONE
-              || (sq->last_time != GST_CLOCK_STIME_NONE
-                  && sq->last_time > group_high)))
-        group_high = sq->last_time;
-    }
-    GST_LOG_OBJECT (mq,
-        "highest now %" GST_STIME_FORMAT " lowest %" GST_STIME_FORMAT,
-        GST_STIME_ARGS (highest), GST_STIME_ARGS (lowest));
-    if (sq->groupid == groupid)
-      GST_LOG_OBJECT (mq,
-          "grouphigh %" GST_STIME_FORMAT " grouplow %" GST_STIME_FORMAT,
-          GST_STIME_ARGS (group_high), GST_STIME_ARGS (group_low));
-
-    gst_object_unref (srcpad);
-  }
+  if ((sq = gst_multi_queue_heap_top (mq->linked_times)))
+    highest = sq->last_time;
+  if ((sq = gst_multi_queue_heap_top (mq->waiting_times)))
+    lowest = sq->next_time;
 
   if (highest == GST_CLOCK_STIME_NONE)
     mq->high_time = lowest;
   else
     mq->high_time = highest;
 
+  GST_LOG_OBJECT (mq,
+      "MQ High time is now : %" GST_STIME_FORMAT ", lowest non-linked %"
+      GST_STIME_FORMAT, GST_STIME_ARGS (mq->high_time),
+      GST_STIME_ARGS (lowest));
+
+  /* released queue */
+  if (!group)
+    return;
+
+  if ((sq = gst_multi_queue_heap_top (group->linked_times)))
+    group_high = sq->last_time;
+  if ((sq = gst_multi_queue_heap_top (group->waiting_times)))
+    group_low = sq->next_time;
+
   /* If there's only one stream of a given type, use the global high */
-  if (group_count < 2)
+  if (group->count < 2)
     res = GST_CLOCK_STIME_NONE;
   else if (group_high == GST_CLOCK_STIME_NONE)
     res = group_low;
   else
     res = group_high;
 
-  GST_LOG_OBJECT (mq, "group count %d for groupid %u", group_count, groupid);
-  GST_LOG_OBJECT (mq,
-      "MQ High time is now : %" GST_STIME_FORMAT ", group %d high time %"
-      GST_STIME_FORMAT ", lowest non-linked %" GST_STIME_FORMAT,
-      GST_STIME_ARGS (mq->high_time), groupid, GST_STIME_ARGS (mq->high_time),
-      GST_STIME_ARGS (lowest));
+  group->high_time = res;
 
-  for (tmp = mq->queues; tmp; tmp = tmp->next) {
-    GstSingleQueue *sq = (GstSingleQueue *) tmp->data;
-    if (groupid == sq->groupid)
-      sq->group_high_time = res;
-  }
+  GST_LOG_OBJECT (mq, "group %u count %u high time %" GST_STIME_FORMAT
+      ", grouphigh %" GST_STIME_FORMAT " grouplow %" GST_STIME_FORMAT,
+      group->groupid, group->count, GST_STIME_ARGS (res),
+      GST_STIME_ARGS (group_high), GST_STIME_ARGS (group_low));
 }
 
 #define IS_FILLED(q, format, value) (((q)->max_size.format) != 0 && \
@@ -3429,7 +3732,6 @@ gst_single_queue_new (GstMultiQueue * mqueue, guint id)
   mqueue->nbqueues++;
   sq->id = temp_id;
   sq->groupid = DEFAULT_PAD_GROUP_ID;
-  sq->group_high_time = GST_CLOCK_STIME_NONE;
 
   mqueue->queues = g_list_insert_before (mqueue->queues, tmp, sq);
   mqueue->queues_cookie++;
@@ -3514,6 +3816,8 @@ gst_single_queue_new (GstMultiQueue * mqueue, guint id)
       GST_DEBUG_FUNCPTR (gst_multi_queue_iterate_internal_links));
   GST_OBJECT_FLAG_SET (srcpad, GST_PAD_FLAG_PROXY_CAPS);
 
+  track_single_queue (mqueue, sq);
+
   GST_MULTI_QUEUE_MUTEX_UNLOCK (mqueue);
 
   /* only activate the pads when we are not in the NULL state
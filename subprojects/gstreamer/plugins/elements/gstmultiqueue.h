@@ -45,6 +45,8 @@ typedef struct _GstMultiQueueClass GstMultiQueueClass;
 typedef struct _GstMultiQueuePad GstMultiQueuePad;
 typedef struct _GstMultiQueuePadClass GstMultiQueuePadClass;
 
+typedef struct _GstMultiQueueHeap GstMultiQueueHeap;
+
 /**
  * GstMultiQueue:
  *
@@ -80,6 +82,15 @@ struct _GstMultiQueue {
 
   gint numwaiting;	/* number of not-linked pads waiting */
 
+  /* Protected by the global queue lock. Queues ordered by the values that
+   * highid and high_time are computed from, so that these don't have to
+   * look at every queue */
+  GstMultiQueueHeap *waiting_ids;	/* not-linked queues by nextid */
+  GstMultiQueueHeap *linked_ids;	/* linked queues by oldid */
+  GstMultiQueueHeap *waiting_times;	/* not-linked queues by next_time */
+  GstMultiQueueHeap *linked_times;	/* linked queues by last_time */
+  GPtrArray *groups;	/* the groups of the queues, see group-id */
+
   gboolean buffering_percent_changed;
   GMutex buffering_post_lock; /* assures only one posted at a time */
 
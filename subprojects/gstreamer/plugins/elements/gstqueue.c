@@ -54,6 +54,12 @@
  * the specified minimum thresholds require (by default: when the queue is
  * empty). The #GstQueue::overrun signal is emitted when the queue is filled
  * up. Both signals are emitted from the context of the streaming thread.
+ *
+ * When #GstQueue:lockless is enabled, buffers are passed from the upstream
+ * streaming thread to the queue's source pad thread through a lock-free queue
+ * and the threads only synchronize when one of them has to wait for the other.
+ * This reduces the per-buffer overhead for pipelines with many queues and
+ * high buffer rates.
  */
 
 #include "gst/gst_private.h"
@@ -122,13 +128,15 @@ enum
   PROP_MIN_THRESHOLD_TIME,
   PROP_LEAKY,
   PROP_SILENT,
-  PROP_FLUSH_ON_EOS
+  PROP_FLUSH_ON_EOS,
+  PROP_LOCKLESS
 };
 
 /* default property values */
 #define DEFAULT_MAX_SIZE_BUFFERS  200   /* 200 buffers */
 #define DEFAULT_MAX_SIZE_BYTES    (10 * 1024 * 1024)    /* 10 MB       */
 #define DEFAULT_MAX_SIZE_TIME     GST_SECOND    /* 1 second    */
+#define DEFAULT_LOCKLESS          FALSE
 
 #define GST_QUEUE_MUTEX_LOCK(q) G_STMT_START {                          \
   g_mutex_lock (&q->qlock);                                              \
@@ -175,6 +183,11 @@ enum
   }                                                                     \
 } G_STMT_END
 
+/* serialized queries stay owned by the thread waiting for them, which might
+ * give up on them while flushing. The ring only contains a marker for the
+ * (single) pending query. */
+#define RING_QUERY(q) ((gpointer) &(q)->ring_query)
+
 #define GST_QUEUE_SIGNAL_ADD(q) G_STMT_START {                          \
   if (q->waiting_add) {                                                 \
     STATUS (q, q->sinkpad, "signal ADD");                               \
@@ -405,6 +418,30 @@ gst_queue_class_init (GstQueueClass * klass)
           G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
           G_PARAM_STATIC_STRINGS));
 
+  /**
+   * queue:lockless:
+   *
+   * Pass buffers between the upstream streaming thread and the source pad
+   * thread without taking the queue lock. The queue lock is then only used
+   * when one of the threads has to wait for the other one, or to handle
+   * serialized events and queries. The levels, thresholds and
+   * #GstQueue:leaky modes keep working as usual.
+   *
+   * As only the source pad thread can remove data from the queue in this
+   * mode, a queue that is leaky on the downstream end uses the regular mode.
+   * Changing #GstQueue:leaky to downstream while the lockless mode is in use
+   * only takes effect the next time the queue is activated, until then the
+   * queue blocks when it is full.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_LOCKLESS,
+      g_param_spec_boolean ("lockless", "Lockless",
+          "Pass buffers between the streaming threads without locking",
+          DEFAULT_LOCKLESS,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+
   gobject_class->finalize = gst_queue_finalize;
 
   gst_element_class_set_static_metadata (gstelement_class,
@@ -478,6 +515,8 @@ gst_queue_init (GstQueue * queue)
 
   queue->newseg_applied_to_src = FALSE;
 
+  queue->lockless = DEFAULT_LOCKLESS;
+
   GST_DEBUG_OBJECT (queue,
       "initialized queue's not_empty & not_full conditions");
 }
@@ -498,6 +537,16 @@ gst_queue_finalize (GObject * object)
   }
   gst_queue_array_free (queue->queue);
 
+  if (queue->ring) {
+    GstMiniObject *item;
+
+    while ((item = gst_atomic_queue_pop (queue->ring))) {
+      if (item != RING_QUERY (queue))
+        gst_mini_object_unref (item);
+    }
+    gst_atomic_queue_unref (queue->ring);
+  }
+
   g_mutex_clear (&queue->qlock);
   g_cond_clear (&queue->item_add);
   g_cond_clear (&queue->item_del);
@@ -523,13 +572,71 @@ my_segment_to_running_time (GstSegment * segment, GstClockTime val)
   return res;
 }
 
+/* seqlocks for the positions of both ends of the queue in lockless mode. Each
+ * position only has one writer, the streaming thread owning that end. */
+static inline void
+write_position (GstQueuePosition * pos, GstClockTimeDiff time)
+{
+  g_atomic_int_inc (&pos->pre_count);
+  pos->time = time;
+  g_atomic_int_inc (&pos->post_count);
+}
+
+static inline GstClockTimeDiff
+read_position (GstQueuePosition * pos)
+{
+  GstClockTimeDiff time;
+  gint seq;
+
+  do {
+    seq = g_atomic_int_get (&pos->post_count);
+    time = pos->time;
+  } while (seq != g_atomic_int_get (&pos->pre_count));
+
+  return time;
+}
+
+/* calculate the diff between the published running times on the sink and src
+ * of the queue in lockless mode */
+static guint64
+gst_queue_lockless_time_level (GstQueue * queue)
+{
+  GstClockTimeDiff sink_time, src_time;
+
+  sink_time = read_position (&queue->sink_position);
+  src_time = read_position (&queue->src_position);
+
+  if (GST_CLOCK_STIME_IS_VALID (src_time)
+      && GST_CLOCK_STIME_IS_VALID (sink_time) && sink_time >= src_time)
+    return sink_time - src_time;
+
+  return 0;
+}
+
 /* calculate the diff between running time on the sink and src of the queue.
  * This is the total amount of time in the queue. */
 static void
-update_time_level (GstQueue * queue)
+update_time_level (GstQueue * queue, gboolean sink)
 {
   gint64 sink_time, src_time;
 
+  if (queue->use_lockless) {
+    /* the other end belongs to the other streaming thread, only publish the
+     * position of our end. The level is calculated from both when needed. */
+    if (sink) {
+      queue->sinktime = my_segment_to_running_time (&queue->sink_segment,
+          queue->sink_segment.position);
+      queue->sink_tainted = FALSE;
+      write_position (&queue->sink_position, queue->sinktime);
+    } else {
+      queue->srctime = my_segment_to_running_time (&queue->src_segment,
+          queue->src_segment.position);
+      queue->src_tainted = FALSE;
+      write_position (&queue->src_position, queue->srctime);
+    }
+    return;
+  }
+
   if (queue->sink_tainted) {
     GST_LOG_OBJECT (queue, "update sink time");
     queue->sinktime =
@@ -584,7 +691,7 @@ apply_segment (GstQueue * queue, GstEvent * event, GstSegment * segment,
   GST_DEBUG_OBJECT (queue, "configured SEGMENT %" GST_SEGMENT_FORMAT, segment);
 
   /* segment can update the time level of the queue */
-  update_time_level (queue);
+  update_time_level (queue, sink);
 }
 
 static void
@@ -610,7 +717,7 @@ apply_gap (GstQueue * queue, GstEvent * event,
       queue->src_tainted = TRUE;
 
     /* calc diff with other end */
-    update_time_level (queue);
+    update_time_level (queue, is_sink);
   }
 }
 
@@ -646,7 +753,7 @@ apply_buffer (GstQueue * queue, GstBuffer * buffer, GstSegment * segment,
 
 
   /* calc diff with other end */
-  update_time_level (queue);
+  update_time_level (queue, sink);
 }
 
 static gboolean
@@ -695,7 +802,25 @@ apply_buffer_list (GstQueue * queue, GstBufferList * buffer_list,
     queue->src_tainted = TRUE;
 
   /* calc diff with other end */
-  update_time_level (queue);
+  update_time_level (queue, sink);
+}
+
+static void
+gst_queue_flush_item (GstQueue * queue, GstMiniObject * item,
+    gboolean is_query, gboolean full)
+{
+  /* the query might already be gone, don't touch it */
+  if (is_query)
+    return;
+
+  /* Then lose another reference because we are supposed to destroy that
+     data when flushing */
+  if (!full && GST_IS_EVENT (item) && GST_EVENT_IS_STICKY (item)
+      && GST_EVENT_TYPE (item) != GST_EVENT_SEGMENT
+      && GST_EVENT_TYPE (item) != GST_EVENT_EOS) {
+    gst_pad_store_sticky_event (queue->srcpad, GST_EVENT_CAST (item));
+  }
+  gst_mini_object_unref (item);
 }
 
 static void
@@ -704,18 +829,17 @@ gst_queue_locked_flush (GstQueue * queue, gboolean full)
   GstQueueItem *qitem;
 
   while ((qitem = gst_queue_array_pop_head_struct (queue->queue))) {
-    /* Then lose another reference because we are supposed to destroy that
-       data when flushing */
-    if (!full && !qitem->is_query && GST_IS_EVENT (qitem->item)
-        && GST_EVENT_IS_STICKY (qitem->item)
-        && GST_EVENT_TYPE (qitem->item) != GST_EVENT_SEGMENT
-        && GST_EVENT_TYPE (qitem->item) != GST_EVENT_EOS) {
-      gst_pad_store_sticky_event (queue->srcpad, GST_EVENT_CAST (qitem->item));
-    }
-    if (!qitem->is_query)
-      gst_mini_object_unref (qitem->item);
+    gst_queue_flush_item (queue, qitem->item, qitem->is_query, full);
     memset (qitem, 0, sizeof (GstQueueItem));
   }
+  if (queue->ring) {
+    GstMiniObject *item;
+
+    while ((item = gst_atomic_queue_pop (queue->ring)))
+      gst_queue_flush_item (queue, item, item == RING_QUERY (queue), full);
+    queue->ring_query = NULL;
+  }
+  queue->pending_eos_flush = 0;
   queue->last_query = FALSE;
   g_cond_signal (&queue->query_handled);
   GST_QUEUE_CLEAR_LEVEL (queue->cur_level);
@@ -728,6 +852,10 @@ gst_queue_locked_flush (GstQueue * queue, gboolean full)
 
   queue->sinktime = queue->srctime = GST_CLOCK_STIME_NONE;
   queue->sink_tainted = queue->src_tainted = TRUE;
+  if (queue->use_lockless) {
+    update_time_level (queue, TRUE);
+    update_time_level (queue, FALSE);
+  }
 
   /* we deleted a lot of something */
   GST_QUEUE_SIGNAL_DEL (queue);
@@ -785,17 +913,24 @@ gst_queue_locked_enqueue_event (GstQueue * queue, gpointer item)
       GST_CAT_LOG_OBJECT (queue_dataflow, queue, "got EOS from upstream");
       /* Zero the thresholds, this makes sure the queue is completely
        * filled and we can read all data from the queue. */
-      if (queue->flush_on_eos)
-        gst_queue_locked_flush (queue, FALSE);
-      else
+      if (queue->flush_on_eos) {
+        /* in lockless mode only the srcpad task can remove items, let it
+         * discard everything up to this EOS */
+        if (queue->use_lockless)
+          g_atomic_int_inc (&queue->pending_eos_flush);
+        else
+          gst_queue_locked_flush (queue, FALSE);
+      } else {
         GST_QUEUE_CLEAR_LEVEL (queue->min_threshold);
+      }
       /* mark the queue as EOS. This prevents us from accepting more data. */
       queue->eos = TRUE;
       break;
     case GST_EVENT_SEGMENT:
       apply_segment (queue, event, &queue->sink_segment, TRUE);
-      /* if the queue is empty, apply sink segment on the source */
-      if (gst_queue_array_is_empty (queue->queue)) {
+      /* if the queue is empty, apply sink segment on the source. The srcpad
+       * task owns the source segment in lockless mode */
+      if (!queue->use_lockless && gst_queue_array_is_empty (queue->queue)) {
         GST_CAT_LOG_OBJECT (queue_dataflow, queue, "Apply segment on srcpad");
         apply_segment (queue, event, &queue->src_segment, FALSE);
         queue->newseg_applied_to_src = TRUE;
@@ -811,13 +946,90 @@ gst_queue_locked_enqueue_event (GstQueue * queue, gpointer item)
       break;
   }
 
-  qitem.item = item;
-  qitem.is_query = FALSE;
-  qitem.size = 0;
-  gst_queue_array_push_tail_struct (queue->queue, &qitem);
+  if (queue->use_lockless) {
+    gst_atomic_queue_push (queue->ring, item);
+    g_atomic_int_set (&queue->tail_is_data, FALSE);
+  } else {
+    qitem.item = item;
+    qitem.is_query = FALSE;
+    qitem.size = 0;
+    gst_queue_array_push_tail_struct (queue->queue, &qitem);
+  }
   GST_QUEUE_SIGNAL_ADD (queue);
 }
 
+/* dequeue an item from the ring and update level stats in lockless mode. Only
+ * called from the srcpad task, with or without QUEUE_LOCK. The caller has to
+ * wake up the chain function if it is waiting for space. */
+static GstMiniObject *
+gst_queue_lockless_dequeue (GstQueue * queue)
+{
+  GstMiniObject *item;
+
+  item = gst_atomic_queue_pop (queue->ring);
+  if (item == NULL) {
+    GST_CAT_DEBUG_OBJECT (queue_dataflow, queue, "the queue is empty");
+    return NULL;
+  }
+
+  if (item == RING_QUERY (queue)) {
+    item = GST_MINI_OBJECT_CAST (queue->ring_query);
+    queue->ring_query = NULL;
+
+    GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+        "retrieved query %p from queue", item);
+  } else if (GST_IS_BUFFER (item)) {
+    GstBuffer *buffer = GST_BUFFER_CAST (item);
+
+    GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+        "retrieved buffer %p from queue", buffer);
+
+    /* publish the new position before giving back the space */
+    apply_buffer (queue, buffer, &queue->src_segment, FALSE);
+    g_atomic_int_add (&queue->cur_level.bytes,
+        -(gint) gst_buffer_get_size (buffer));
+    g_atomic_int_add (&queue->cur_level.buffers, -1);
+  } else if (GST_IS_BUFFER_LIST (item)) {
+    GstBufferList *buffer_list = GST_BUFFER_LIST_CAST (item);
+
+    GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+        "retrieved buffer list %p from queue", buffer_list);
+
+    apply_buffer_list (queue, buffer_list, &queue->src_segment, FALSE);
+    g_atomic_int_add (&queue->cur_level.bytes,
+        -(gint) gst_buffer_list_calculate_size (buffer_list));
+    g_atomic_int_add (&queue->cur_level.buffers,
+        -(gint) gst_buffer_list_length (buffer_list));
+  } else if (GST_IS_EVENT (item)) {
+    GstEvent *event = GST_EVENT_CAST (item);
+
+    GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+        "retrieved event %p from queue", event);
+
+    switch (GST_EVENT_TYPE (event)) {
+      case GST_EVENT_EOS:
+        if (g_atomic_int_get (&queue->pending_eos_flush) > 0)
+          g_atomic_int_add (&queue->pending_eos_flush, -1);
+        break;
+      case GST_EVENT_SEGMENT:
+        apply_segment (queue, event, &queue->src_segment, FALSE);
+        break;
+      case GST_EVENT_GAP:
+        apply_gap (queue, event, &queue->src_segment, FALSE);
+        break;
+      default:
+        break;
+    }
+  } else {
+    g_warning
+        ("Unexpected item %p dequeued from queue %s (refcounting problem?)",
+        item, GST_OBJECT_NAME (queue));
+    item = NULL;
+  }
+
+  return item;
+}
+
 /* dequeue an item from the queue and update level stats, with QUEUE_LOCK */
 static GstMiniObject *
 gst_queue_locked_dequeue (GstQueue * queue)
@@ -826,6 +1038,12 @@ gst_queue_locked_dequeue (GstQueue * queue)
   GstMiniObject *item;
   gsize bufsize;
 
+  if (queue->use_lockless) {
+    item = gst_queue_lockless_dequeue (queue);
+    GST_QUEUE_SIGNAL_DEL (queue);
+    return item;
+  }
+
   qitem = gst_queue_array_pop_head_struct (queue->queue);
   if (qitem == NULL)
     goto no_item;
@@ -1066,10 +1284,16 @@ gst_queue_handle_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
         GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
         GST_LOG_OBJECT (queue, "queuing query %p (%s)", query,
             GST_QUERY_TYPE_NAME (query));
-        qitem.item = GST_MINI_OBJECT_CAST (query);
-        qitem.is_query = TRUE;
-        qitem.size = 0;
-        gst_queue_array_push_tail_struct (queue->queue, &qitem);
+        if (queue->use_lockless) {
+          queue->ring_query = query;
+          gst_atomic_queue_push (queue->ring, RING_QUERY (queue));
+          g_atomic_int_set (&queue->tail_is_data, FALSE);
+        } else {
+          qitem.item = GST_MINI_OBJECT_CAST (query);
+          qitem.is_query = TRUE;
+          qitem.size = 0;
+          gst_queue_array_push_tail_struct (queue->queue, &qitem);
+        }
         GST_QUEUE_SIGNAL_ADD (queue);
         while (queue->srcresult == GST_FLOW_OK &&
             queue->last_handled_query != query)
@@ -1095,43 +1319,75 @@ out_flushing:
   }
 }
 
+/* get the current level of the queue. In lockless mode it is updated by both
+ * streaming threads so we can only take a snapshot of it. */
+static void
+gst_queue_get_level (GstQueue * queue, GstQueueSize * level)
+{
+  if (queue->use_lockless) {
+    level->buffers = g_atomic_int_get (&queue->cur_level.buffers);
+    level->bytes = g_atomic_int_get (&queue->cur_level.bytes);
+    level->time = gst_queue_lockless_time_level (queue);
+  } else {
+    *level = queue->cur_level;
+  }
+}
+
 static gboolean
 gst_queue_is_empty (GstQueue * queue)
 {
-  GstQueueItem *tail;
-
-  tail = gst_queue_array_peek_tail_struct (queue->queue);
-
-  if (tail == NULL)
-    return TRUE;
+  GstQueueSize level;
+  guint min_buffers, min_bytes;
 
   /* Only consider the queue empty if the minimum thresholds
    * are not reached and data is at the queue tail. Otherwise
    * we would block forever on serialized queries.
    */
-  if (!GST_IS_BUFFER (tail->item) && !GST_IS_BUFFER_LIST (tail->item))
-    return FALSE;
+  if (queue->use_lockless) {
+    if (gst_atomic_queue_length (queue->ring) == 0)
+      return TRUE;
+
+    if (!g_atomic_int_get (&queue->tail_is_data))
+      return FALSE;
+  } else {
+    GstQueueItem *tail;
+
+    tail = gst_queue_array_peek_tail_struct (queue->queue);
+
+    if (tail == NULL)
+      return TRUE;
+
+    if (!GST_IS_BUFFER (tail->item) && !GST_IS_BUFFER_LIST (tail->item))
+      return FALSE;
+  }
+
+  gst_queue_get_level (queue, &level);
+
+  /* the thresholds are cleared on EOS by the chain function in lockless mode */
+  min_buffers = g_atomic_int_get ((gint *) & queue->min_threshold.buffers);
+  min_bytes = g_atomic_int_get ((gint *) & queue->min_threshold.bytes);
 
   /* It is possible that a max size is reached before all min thresholds are.
    * Therefore, only consider it empty if it is not filled. */
-  return ((queue->min_threshold.buffers > 0 &&
-          queue->cur_level.buffers < queue->min_threshold.buffers) ||
-      (queue->min_threshold.bytes > 0 &&
-          queue->cur_level.bytes < queue->min_threshold.bytes) ||
+  return ((min_buffers > 0 && level.buffers < min_buffers) ||
+      (min_bytes > 0 && level.bytes < min_bytes) ||
       (queue->min_threshold.time > 0 &&
-          queue->cur_level.time < queue->min_threshold.time)) &&
+          level.time < queue->min_threshold.time)) &&
       !gst_queue_is_filled (queue);
 }
 
 static gboolean
 gst_queue_is_filled (GstQueue * queue)
 {
+  GstQueueSize level;
+
+  gst_queue_get_level (queue, &level);
+
   return (((queue->max_size.buffers > 0 &&
-              queue->cur_level.buffers >= queue->max_size.buffers) ||
+              level.buffers >= queue->max_size.buffers) ||
           (queue->max_size.bytes > 0 &&
-              queue->cur_level.bytes >= queue->max_size.bytes) ||
-          (queue->max_size.time > 0 &&
-              queue->cur_level.time >= queue->max_size.time)));
+              level.bytes >= queue->max_size.bytes) ||
+          (queue->max_size.time > 0 && level.time >= queue->max_size.time)));
 }
 
 static void
@@ -1178,6 +1434,149 @@ discont_first_buffer (GstBuffer ** buffer, guint i, gpointer user_data)
   return FALSE;
 }
 
+/* mark the (first) buffer of a buffer or buffer list as DISCONT */
+static GstMiniObject *
+gst_queue_mark_discont (GstQueue * queue, GstMiniObject * obj,
+    gboolean is_list)
+{
+  if (!is_list) {
+    GstBuffer *buffer = GST_BUFFER_CAST (obj);
+    GstBuffer *subbuffer = gst_buffer_make_writable (buffer);
+
+    if (subbuffer) {
+      buffer = subbuffer;
+      GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DISCONT);
+    } else {
+      GST_DEBUG_OBJECT (queue, "Could not mark buffer as DISCONT");
+    }
+
+    return GST_MINI_OBJECT_CAST (buffer);
+  } else {
+    GstBufferList *buffer_list = GST_BUFFER_LIST_CAST (obj);
+
+    buffer_list = gst_buffer_list_make_writable (buffer_list);
+    gst_buffer_list_foreach (buffer_list, discont_first_buffer, queue);
+
+    return GST_MINI_OBJECT_CAST (buffer_list);
+  }
+}
+
+/* chain function for the lockless mode. The sink segment, the tail of the ring
+ * and the DISCONT flag for the tail are only touched by this thread, so
+ * QUEUE_LOCK is only needed to wait for space and to wake up the srcpad task
+ * when it is waiting for data. */
+static GstFlowReturn
+gst_queue_lockless_chain (GstQueue * queue, GstMiniObject * obj,
+    gboolean is_list)
+{
+  GstFlowReturn ret;
+  guint n_buffers;
+  gsize bsize;
+
+  ret = g_atomic_int_get ((gint *) & queue->srcresult);
+  if (ret != GST_FLOW_OK)
+    goto out_flushing;
+  /* when we received EOS, we refuse any more data */
+  if (g_atomic_int_get (&queue->eos) || g_atomic_int_get (&queue->unexpected))
+    goto out_eos;
+
+  while (gst_queue_is_filled (queue)) {
+    if (!queue->silent) {
+      g_signal_emit (queue, gst_queue_signals[SIGNAL_OVERRUN], 0);
+      /* we recheck, the signal could have changed the thresholds */
+      if (!gst_queue_is_filled (queue))
+        break;
+    }
+
+    if (queue->leaky == GST_QUEUE_LEAK_UPSTREAM) {
+      /* next buffer needs to get a DISCONT flag */
+      queue->tail_needs_discont = TRUE;
+      /* leak current buffer */
+      GST_CAT_DEBUG_OBJECT (queue_dataflow, queue,
+          "queue is full, leaking buffer on upstream end");
+      gst_mini_object_unref (obj);
+      return GST_FLOW_OK;
+    }
+
+    /* we can't leak on the downstream end from this thread, wait for space to
+     * be available like a non-leaky queue. The srcpad task checks
+     * waiting_del after giving back space, and we check the level again after
+     * setting it, so we can't miss its wakeup. */
+    GST_CAT_DEBUG_OBJECT (queue_dataflow, queue,
+        "queue is full, waiting for free space");
+
+    GST_QUEUE_MUTEX_LOCK (queue);
+    g_atomic_int_set (&queue->waiting_del, TRUE);
+    while (queue->srcresult == GST_FLOW_OK && gst_queue_is_filled (queue)) {
+      STATUS (queue, queue->sinkpad, "wait for DEL");
+      g_cond_wait (&queue->item_del, &queue->qlock);
+    }
+    g_atomic_int_set (&queue->waiting_del, FALSE);
+    ret = queue->srcresult;
+    GST_QUEUE_MUTEX_UNLOCK (queue);
+
+    if (ret != GST_FLOW_OK)
+      goto out_flushing;
+
+    GST_CAT_DEBUG_OBJECT (queue_dataflow, queue, "queue is not full");
+
+    if (!queue->silent)
+      g_signal_emit (queue, gst_queue_signals[SIGNAL_RUNNING], 0);
+  }
+
+  if (queue->tail_needs_discont) {
+    obj = gst_queue_mark_discont (queue, obj, is_list);
+    queue->tail_needs_discont = FALSE;
+  }
+
+  if (is_list) {
+    GstBufferList *buffer_list = GST_BUFFER_LIST_CAST (obj);
+
+    n_buffers = gst_buffer_list_length (buffer_list);
+    bsize = gst_buffer_list_calculate_size (buffer_list);
+    apply_buffer_list (queue, buffer_list, &queue->sink_segment, TRUE);
+  } else {
+    GstBuffer *buffer = GST_BUFFER_CAST (obj);
+
+    n_buffers = 1;
+    bsize = gst_buffer_get_size (buffer);
+    apply_buffer (queue, buffer, &queue->sink_segment, TRUE);
+  }
+
+  /* add the data to the statistics before the srcpad task can dequeue it */
+  g_atomic_int_add (&queue->cur_level.buffers, n_buffers);
+  g_atomic_int_add (&queue->cur_level.bytes, bsize);
+  gst_atomic_queue_push (queue->ring, obj);
+  g_atomic_int_set (&queue->tail_is_data, TRUE);
+
+  /* only wake up the srcpad task if it is waiting for data, it sets
+   * waiting_add before checking the queue again so it can't miss this item */
+  if (g_atomic_int_get (&queue->waiting_add)) {
+    GST_QUEUE_MUTEX_LOCK (queue);
+    GST_QUEUE_SIGNAL_ADD (queue);
+    GST_QUEUE_MUTEX_UNLOCK (queue);
+  }
+
+  return GST_FLOW_OK;
+
+  /* special conditions */
+out_flushing:
+  {
+    GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+        "exit because task paused, reason: %s", gst_flow_get_name (ret));
+    gst_mini_object_unref (obj);
+
+    return ret;
+  }
+out_eos:
+  {
+    GST_CAT_LOG_OBJECT (queue_dataflow, queue, "exit because we received EOS");
+    gst_mini_object_unref (obj);
+
+    return GST_FLOW_EOS;
+  }
+}
+
 static GstFlowReturn
 gst_queue_chain_buffer_or_list (GstPad * pad, GstObject * parent,
     GstMiniObject * obj, gboolean is_list)
@@ -1186,6 +1585,9 @@ gst_queue_chain_buffer_or_list (GstPad * pad, GstObject * parent,
 
   queue = GST_QUEUE_CAST (parent);
 
+  if (queue->use_lockless)
+    return gst_queue_lockless_chain (queue, obj, is_list);
+
   /* we have to lock the queue since we span threads */
   GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
   /* when we received EOS, we refuse any more data */
@@ -1264,25 +1666,7 @@ gst_queue_chain_buffer_or_list (GstPad * pad, GstObject * parent,
   }
 
   if (queue->tail_needs_discont) {
-    if (!is_list) {
-      GstBuffer *buffer = GST_BUFFER_CAST (obj);
-      GstBuffer *subbuffer = gst_buffer_make_writable (buffer);
-
-      if (subbuffer) {
-        buffer = subbuffer;
-        GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DISCONT);
-      } else {
-        GST_DEBUG_OBJECT (queue, "Could not mark buffer as DISCONT");
-      }
-
-      obj = GST_MINI_OBJECT_CAST (buffer);
-    } else {
-      GstBufferList *buffer_list = GST_BUFFER_LIST_CAST (obj);
-
-      buffer_list = gst_buffer_list_make_writable (buffer_list);
-      gst_buffer_list_foreach (buffer_list, discont_first_buffer, queue);
-      obj = GST_MINI_OBJECT_CAST (buffer_list);
-    }
+    obj = gst_queue_mark_discont (queue, obj, is_list);
     queue->tail_needs_discont = FALSE;
   }
 
@@ -1350,104 +1734,88 @@ gst_queue_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
       GST_MINI_OBJECT_CAST (buffer), FALSE);
 }
 
-/* dequeue an item from the queue an push it downstream. This functions returns
+/* downstream returned EOS: stop pushing buffers, we dequeue all items until we
+ * see an item that we can push again, which is EOS or SEGMENT. Returns that
+ * item, or NULL after setting a flag to make the sinkpad refuse more buffers
+ * with an EOS return value if there is nothing in the queue we can push. With
+ * QUEUE_LOCK. */
+static GstMiniObject *
+gst_queue_locked_drop_until_pushable (GstQueue * queue)
+{
+  GstMiniObject *data;
+
+  while ((data = gst_queue_locked_dequeue (queue))) {
+    if (GST_IS_BUFFER (data)) {
+      GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+          "dropping EOS buffer %p", data);
+      gst_buffer_unref (GST_BUFFER_CAST (data));
+    } else if (GST_IS_BUFFER_LIST (data)) {
+      GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+          "dropping EOS buffer list %p", data);
+      gst_buffer_list_unref (GST_BUFFER_LIST_CAST (data));
+    } else if (GST_IS_EVENT (data)) {
+      GstEvent *event = GST_EVENT_CAST (data);
+      GstEventType type = GST_EVENT_TYPE (event);
+
+      if (type == GST_EVENT_EOS || type == GST_EVENT_SEGMENT
+          || type == GST_EVENT_STREAM_START) {
+        /* we found a pushable item in the queue, push it out */
+        GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+            "pushing pushable event %s after EOS",
+            GST_EVENT_TYPE_NAME (event));
+        return data;
+      }
+      GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+          "dropping EOS event %p", event);
+      gst_event_unref (event);
+    } else if (GST_IS_QUERY (data)) {
+      GstQuery *query = GST_QUERY_CAST (data);
+
+      GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+          "dropping query %p because of EOS", query);
+      queue->last_query = FALSE;
+      g_cond_signal (&queue->query_handled);
+    }
+  }
+  /* no more items in the queue. Set the unexpected flag so that upstream
+   * make us refuse any more buffers on the sinkpad. Since we will still
+   * accept EOS and SEGMENT the caller returns _FLOW_OK so that the task
+   * function does not shut down. */
+  queue->unexpected = TRUE;
+
+  return NULL;
+}
+
+/* push a dequeued item downstream, with QUEUE_LOCK. This functions returns
  * the result of the push. */
 static GstFlowReturn
-gst_queue_push_one (GstQueue * queue)
+gst_queue_push_item (GstQueue * queue, GstMiniObject * data)
 {
   GstFlowReturn result = queue->srcresult;
-  GstMiniObject *data;
   gboolean is_list;
 
-  data = gst_queue_locked_dequeue (queue);
-  if (data == NULL)
-    goto no_item;
-
 next:
   is_list = GST_IS_BUFFER_LIST (data);
 
   if (GST_IS_BUFFER (data) || is_list) {
-    if (!is_list) {
-      GstBuffer *buffer;
-
-      buffer = GST_BUFFER_CAST (data);
-
-      if (queue->head_needs_discont) {
-        GstBuffer *subbuffer = gst_buffer_make_writable (buffer);
-
-        if (subbuffer) {
-          buffer = subbuffer;
-          GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DISCONT);
-        } else {
-          GST_DEBUG_OBJECT (queue, "Could not mark buffer as DISCONT");
-        }
-        queue->head_needs_discont = FALSE;
-      }
-
-      GST_QUEUE_MUTEX_UNLOCK (queue);
-      result = gst_pad_push (queue->srcpad, buffer);
-    } else {
-      GstBufferList *buffer_list;
-
-      buffer_list = GST_BUFFER_LIST_CAST (data);
-
-      if (queue->head_needs_discont) {
-        buffer_list = gst_buffer_list_make_writable (buffer_list);
-        gst_buffer_list_foreach (buffer_list, discont_first_buffer, queue);
-        queue->head_needs_discont = FALSE;
-      }
-
-      GST_QUEUE_MUTEX_UNLOCK (queue);
-      result = gst_pad_push_list (queue->srcpad, buffer_list);
+    if (queue->head_needs_discont) {
+      data = gst_queue_mark_discont (queue, data, is_list);
+      queue->head_needs_discont = FALSE;
     }
 
+    GST_QUEUE_MUTEX_UNLOCK (queue);
+    if (!is_list)
+      result = gst_pad_push (queue->srcpad, GST_BUFFER_CAST (data));
+    else
+      result = gst_pad_push_list (queue->srcpad, GST_BUFFER_LIST_CAST (data));
+
     /* need to check for srcresult here as well */
     GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
 
     if (result == GST_FLOW_EOS) {
       GST_CAT_LOG_OBJECT (queue_dataflow, queue, "got EOS from downstream");
-      /* stop pushing buffers, we dequeue all items until we see an item that we
-       * can push again, which is EOS or SEGMENT. If there is nothing in the
-       * queue we can push, we set a flag to make the sinkpad refuse more
-       * buffers with an EOS return value. */
-      while ((data = gst_queue_locked_dequeue (queue))) {
-        if (GST_IS_BUFFER (data)) {
-          GST_CAT_LOG_OBJECT (queue_dataflow, queue,
-              "dropping EOS buffer %p", data);
-          gst_buffer_unref (GST_BUFFER_CAST (data));
-        } else if (GST_IS_BUFFER_LIST (data)) {
-          GST_CAT_LOG_OBJECT (queue_dataflow, queue,
-              "dropping EOS buffer list %p", data);
-          gst_buffer_list_unref (GST_BUFFER_LIST_CAST (data));
-        } else if (GST_IS_EVENT (data)) {
-          GstEvent *event = GST_EVENT_CAST (data);
-          GstEventType type = GST_EVENT_TYPE (event);
-
-          if (type == GST_EVENT_EOS || type == GST_EVENT_SEGMENT
-              || type == GST_EVENT_STREAM_START) {
-            /* we found a pushable item in the queue, push it out */
-            GST_CAT_LOG_OBJECT (queue_dataflow, queue,
-                "pushing pushable event %s after EOS",
-                GST_EVENT_TYPE_NAME (event));
-            goto next;
-          }
-          GST_CAT_LOG_OBJECT (queue_dataflow, queue,
-              "dropping EOS event %p", event);
-          gst_event_unref (event);
-        } else if (GST_IS_QUERY (data)) {
-          GstQuery *query = GST_QUERY_CAST (data);
-
-          GST_CAT_LOG_OBJECT (queue_dataflow, queue,
-              "dropping query %p because of EOS", query);
-          queue->last_query = FALSE;
-          g_cond_signal (&queue->query_handled);
-        }
-      }
-      /* no more items in the queue. Set the unexpected flag so that upstream
-       * make us refuse any more buffers on the sinkpad. Since we will still
-       * accept EOS and SEGMENT we return _FLOW_OK to the caller so that the
-       * task function does not shut down. */
-      queue->unexpected = TRUE;
+      if ((data = gst_queue_locked_drop_until_pushable (queue)))
+        goto next;
       result = GST_FLOW_OK;
     }
   } else if (GST_IS_EVENT (data)) {
@@ -1481,12 +1849,6 @@ next:
   return result;
 
   /* ERRORS */
-no_item:
-  {
-    GST_CAT_ERROR_OBJECT (queue_dataflow, queue,
-        "exit because we have no item in the queue");
-    return GST_FLOW_ERROR;
-  }
 out_flushing:
   {
     GstFlowReturn ret = queue->srcresult;
@@ -1505,6 +1867,152 @@ out_flushing_query:
   }
 }
 
+/* dequeue an item from the queue an push it downstream. This functions returns
+ * the result of the push. */
+static GstFlowReturn
+gst_queue_push_one (GstQueue * queue)
+{
+  GstMiniObject *data;
+
+  data = gst_queue_locked_dequeue (queue);
+  if (data == NULL)
+    goto no_item;
+
+  return gst_queue_push_item (queue, data);
+
+  /* ERRORS */
+no_item:
+  {
+    GST_CAT_ERROR_OBJECT (queue_dataflow, queue,
+        "exit because we have no item in the queue");
+    return GST_FLOW_ERROR;
+  }
+}
+
+/* flush-on-eos in lockless mode: discard everything in front of the EOS event
+ * the sinkpad received, with QUEUE_LOCK */
+static void
+gst_queue_locked_flush_until_eos (GstQueue * queue)
+{
+  GstMiniObject *item;
+
+  while ((item = gst_atomic_queue_peek (queue->ring))) {
+    gboolean is_query = (item == RING_QUERY (queue));
+
+    if (!is_query && GST_IS_EVENT (item)
+        && GST_EVENT_TYPE (item) == GST_EVENT_EOS)
+      break;
+
+    item = gst_queue_lockless_dequeue (queue);
+    gst_queue_flush_item (queue, item, is_query, FALSE);
+  }
+  GST_QUEUE_SIGNAL_DEL (queue);
+}
+
+/* wake up the chain function if it is waiting for space in lockless mode,
+ * without QUEUE_LOCK */
+static inline void
+gst_queue_lockless_signal_del (GstQueue * queue)
+{
+  if (g_atomic_int_get (&queue->waiting_del)) {
+    GST_QUEUE_MUTEX_LOCK (queue);
+    GST_QUEUE_SIGNAL_DEL (queue);
+    GST_QUEUE_MUTEX_UNLOCK (queue);
+  }
+}
+
+/* srcpad task for the lockless mode. Buffers are dequeued and pushed without
+ * QUEUE_LOCK, it is only taken to wait for data, to handle events and queries
+ * and when pushing a buffer did not return GST_FLOW_OK. */
+static gboolean
+gst_queue_lockless_loop (GstQueue * queue)
+{
+  GstMiniObject *data;
+  GstFlowReturn ret;
+  gboolean is_list;
+
+  if (g_atomic_int_get ((gint *) & queue->srcresult) != GST_FLOW_OK) {
+    GST_QUEUE_MUTEX_LOCK (queue);
+    goto out_flushing;
+  }
+
+  while (gst_queue_is_empty (queue)) {
+    GST_CAT_DEBUG_OBJECT (queue_dataflow, queue, "queue is empty");
+    if (!queue->silent)
+      g_signal_emit (queue, gst_queue_signals[SIGNAL_UNDERRUN], 0);
+
+    /* the chain function checks waiting_add after adding an item, and we check
+     * the queue again after setting it, so we can't miss its wakeup */
+    GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
+    g_atomic_int_set (&queue->waiting_add, TRUE);
+    /* we recheck, the signal could have changed the thresholds */
+    while (queue->srcresult == GST_FLOW_OK && gst_queue_is_empty (queue)) {
+      STATUS (queue, queue->srcpad, "wait for ADD");
+      g_cond_wait (&queue->item_add, &queue->qlock);
+    }
+    g_atomic_int_set (&queue->waiting_add, FALSE);
+    if (queue->srcresult != GST_FLOW_OK)
+      goto out_flushing;
+    GST_QUEUE_MUTEX_UNLOCK (queue);
+
+    GST_CAT_DEBUG_OBJECT (queue_dataflow, queue, "queue is not empty");
+    if (!queue->silent) {
+      g_signal_emit (queue, gst_queue_signals[SIGNAL_RUNNING], 0);
+      g_signal_emit (queue, gst_queue_signals[SIGNAL_PUSHING], 0);
+    }
+  }
+
+  data = gst_atomic_queue_peek (queue->ring);
+  is_list = (data != RING_QUERY (queue) && GST_IS_BUFFER_LIST (data));
+
+  if (data != RING_QUERY (queue) && (GST_IS_BUFFER (data) || is_list)
+      && g_atomic_int_get (&queue->pending_eos_flush) == 0) {
+    data = gst_queue_lockless_dequeue (queue);
+    gst_queue_lockless_signal_del (queue);
+
+    if (queue->head_needs_discont) {
+      data = gst_queue_mark_discont (queue, data, is_list);
+      queue->head_needs_discont = FALSE;
+    }
+
+    if (!is_list)
+      ret = gst_pad_push (queue->srcpad, GST_BUFFER_CAST (data));
+    else
+      ret = gst_pad_push_list (queue->srcpad, GST_BUFFER_LIST_CAST (data));
+
+    if (G_LIKELY (ret == GST_FLOW_OK))
+      return TRUE;
+
+    GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
+    if (ret == GST_FLOW_EOS) {
+      GST_CAT_LOG_OBJECT (queue_dataflow, queue, "got EOS from downstream");
+      if ((data = gst_queue_locked_drop_until_pushable (queue)))
+        ret = gst_queue_push_item (queue, data);
+      else
+        ret = GST_FLOW_OK;
+    }
+  } else {
+    GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
+    if (queue->pending_eos_flush > 0)
+      gst_queue_locked_flush_until_eos (queue);
+    ret = gst_queue_push_one (queue);
+  }
+
+  queue->srcresult = ret;
+  if (ret != GST_FLOW_OK)
+    goto out_flushing;
+
+  GST_QUEUE_MUTEX_UNLOCK (queue);
+
+  return TRUE;
+
+out_flushing:
+  {
+    /* with QUEUE_LOCK, the caller pauses the task */
+    return FALSE;
+  }
+}
+
 static void
 gst_queue_loop (GstPad * pad)
 {
@@ -1513,6 +2021,12 @@ gst_queue_loop (GstPad * pad)
 
   queue = (GstQueue *) GST_PAD_PARENT (pad);
 
+  if (queue->use_lockless) {
+    if (G_LIKELY (gst_queue_lockless_loop (queue)))
+      return;
+    goto out_flushing;
+  }
+
   /* have to lock for thread-safety */
   GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
 
@@ -1633,19 +2147,21 @@ gst_queue_handle_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
     {
       gint64 peer_pos;
       GstFormat format;
+      GstQueueSize level;
 
       /* get peer position */
       gst_query_parse_position (query, &format, &peer_pos);
+      gst_queue_get_level (queue, &level);
 
       /* FIXME: this code assumes that there's no discont in the queue */
       switch (format) {
         case GST_FORMAT_BYTES:
-          peer_pos -= queue->cur_level.bytes;
+          peer_pos -= level.bytes;
           if (peer_pos < 0)     /* Clamp result to 0 */
             peer_pos = 0;
           break;
         case GST_FORMAT_TIME:
-          peer_pos -= queue->cur_level.time;
+          peer_pos -= level.time;
           if (peer_pos < 0)     /* Clamp result to 0 */
             peer_pos = 0;
           break;
@@ -1750,6 +2266,19 @@ gst_queue_src_activate_mode (GstPad * pad, GstObject * parent, GstPadMode mode,
         queue->srcresult = GST_FLOW_OK;
         queue->eos = FALSE;
         queue->unexpected = FALSE;
+        /* only the srcpad task can leak on the downstream end in lockless
+         * mode, so don't use it for such queues */
+        queue->use_lockless = queue->lockless
+            && queue->leaky != GST_QUEUE_LEAK_DOWNSTREAM;
+        if (queue->use_lockless) {
+          if (queue->ring == NULL)
+            queue->ring =
+                gst_atomic_queue_new (DEFAULT_MAX_SIZE_BUFFERS * 3 / 2);
+          update_time_level (queue, TRUE);
+          update_time_level (queue, FALSE);
+        }
+        GST_DEBUG_OBJECT (queue, "using %s mode",
+            queue->use_lockless ? "lockless" : "locked");
         result =
             gst_pad_start_task (pad, (GstTaskFunction) gst_queue_loop, pad,
             NULL);
@@ -1780,7 +2309,8 @@ gst_queue_src_activate_mode (GstPad * pad, GstObject * parent, GstPadMode mode,
 static void
 queue_capacity_change (GstQueue * queue)
 {
-  if (queue->leaky == GST_QUEUE_LEAK_DOWNSTREAM) {
+  /* only the srcpad task can remove data in lockless mode */
+  if (queue->leaky == GST_QUEUE_LEAK_DOWNSTREAM && !queue->use_lockless) {
     gst_queue_leak_downstream (queue);
   }
 
@@ -1844,6 +2374,9 @@ gst_queue_set_property (GObject * object,
     case PROP_FLUSH_ON_EOS:
       queue->flush_on_eos = g_value_get_boolean (value);
       break;
+    case PROP_LOCKLESS:
+      queue->lockless = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1857,18 +2390,22 @@ gst_queue_get_property (GObject * object,
     guint prop_id, GValue * value, GParamSpec * pspec)
 {
   GstQueue *queue = GST_QUEUE (object);
+  GstQueueSize level;
 
   GST_QUEUE_MUTEX_LOCK (queue);
 
   switch (prop_id) {
     case PROP_CUR_LEVEL_BYTES:
-      g_value_set_uint (value, queue->cur_level.bytes);
+      gst_queue_get_level (queue, &level);
+      g_value_set_uint (value, level.bytes);
       break;
     case PROP_CUR_LEVEL_BUFFERS:
-      g_value_set_uint (value, queue->cur_level.buffers);
+      gst_queue_get_level (queue, &level);
+      g_value_set_uint (value, level.buffers);
       break;
     case PROP_CUR_LEVEL_TIME:
-      g_value_set_uint64 (value, queue->cur_level.time);
+      gst_queue_get_level (queue, &level);
+      g_value_set_uint64 (value, level.time);
       break;
     case PROP_MAX_SIZE_BYTES:
       g_value_set_uint (value, queue->max_size.bytes);
@@ -1897,6 +2434,9 @@ gst_queue_get_property (GObject * object,
     case PROP_FLUSH_ON_EOS:
       g_value_set_boolean (value, queue->flush_on_eos);
       break;
+    case PROP_LOCKLESS:
+      g_value_set_boolean (value, queue->lockless);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
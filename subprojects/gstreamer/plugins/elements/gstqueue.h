@@ -75,10 +75,28 @@ struct _GstQueueSize {
     guint64 time;
 };
 
+/*
+ * GstQueuePosition:
+ * @pre_count: incremented before updating @time
+ * @post_count: incremented after updating @time
+ * @time: running time of one end of the queue
+ *
+ * Running time position of one end of the queue, protected by a seqlock so
+ * that the other streaming thread can read it in lockless mode.
+ */
+typedef struct {
+    gint pre_count;
+    gint post_count;
+    GstClockTimeDiff time;
+} GstQueuePosition;
+
+/* buffers and bytes are read by the other streaming thread in lockless mode.
+ * The time level is calculated from the GstQueuePosition of both ends there,
+ * so @time is only accessed with QUEUE_LOCK. */
 #define GST_QUEUE_CLEAR_LEVEL(l) G_STMT_START {         \
-  l.buffers = 0;                                        \
-  l.bytes = 0;                                          \
-  l.time = 0;                                           \
+  g_atomic_int_set ((gint *) &(l).buffers, 0);          \
+  g_atomic_int_set ((gint *) &(l).bytes, 0);            \
+  (l).time = 0;                                         \
 } G_STMT_END
 
 /**
@@ -138,6 +156,19 @@ struct _GstQueue {
   GstQuery *last_handled_query;
 
   gboolean flush_on_eos; /* flush on EOS */
+
+  /* lockless mode: items are passed from the sinkpad streaming thread to the
+   * srcpad task through @ring and each thread only touches its own end. The
+   * level is updated atomically and qlock is only taken to wait for data or
+   * space and for handling events and queries */
+  gboolean lockless;        /* lockless property */
+  gboolean use_lockless;    /* lockless mode configured at activation */
+  GstAtomicQueue *ring;
+  GstQuery *ring_query;     /* pending serialized query in @ring */
+  gboolean tail_is_data;    /* last item pushed into @ring was data */
+  gint pending_eos_flush;   /* flush-on-eos EOS events the srcpad task has to
+                             * discard data up to */
+  GstQueuePosition sink_position, src_position;
 };
 
 struct _GstQueueClass {
@@ -50,6 +50,11 @@
  * The temp-location property will be used to notify the application of the
  * allocated filename.
  *
+ * When #GstQueue2:ring-buffer-max-size is set and #GstQueue2:use-mmap is
+ * enabled, the ring buffer (in memory or in the temp file) is mapped into
+ * memory and the buffers pushed downstream reference it directly instead of
+ * containing a copy of the data.
+ *
  * If the #GstQueue2:use-buffering property is set to TRUE, and any writable
  * property is modified, #GstQueue2 will attempt to post a buffering message
  * if the changes to the properties also cause the buffering percentage to be
@@ -70,6 +75,11 @@
 #include "gst/glib-compat-private.h"
 
 #include <string.h>
+#include <errno.h>
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
 
 #ifdef G_OS_WIN32
 #include <io.h>                 /* lseek, open, close, read */
@@ -126,6 +136,7 @@ enum
 #define DEFAULT_TEMP_REMOVE        TRUE
 #define DEFAULT_RING_BUFFER_MAX_SIZE 0
 #define DEFAULT_USE_BITRATE_QUERY  TRUE
+#define DEFAULT_USE_MMAP           FALSE
 
 enum
 {
@@ -150,6 +161,7 @@ enum
   PROP_AVG_IN_RATE,
   PROP_USE_BITRATE_QUERY,
   PROP_BITRATE,
+  PROP_USE_MMAP,
   PROP_LAST
 };
 static GParamSpec *obj_props[PROP_LAST] = { NULL, };
@@ -467,6 +479,25 @@ gst_queue2_class_init (GstQueue2Class * klass)
       "Conversion value between data size and time",
       0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * GstQueue2:use-mmap
+   *
+   * Map the ring buffer into memory and push buffers that reference it
+   * instead of copies of the data. Only used when
+   * #GstQueue2:ring-buffer-max-size is set.
+   *
+   * Data that is still referenced by a buffer downstream is copied out of the
+   * ring buffer before it is overwritten. If the buffer is mapped at that
+   * time, the whole ring buffer is copied to a new allocation instead, so
+   * holding on to mapped buffers temporarily needs up to twice the memory.
+   *
+   * Since: 1.22
+   */
+  obj_props[PROP_USE_MMAP] = g_param_spec_boolean ("use-mmap",
+      "Use mmap", "Map the ring buffer and push zero-copy buffers",
+      DEFAULT_USE_MMAP,
+      G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, PROP_LAST, obj_props);
 
   /* set several parent class virtual functions */
@@ -562,6 +593,8 @@ gst_queue2_init (GstQueue2 * queue)
 
   queue->ring_buffer = NULL;
   queue->ring_buffer_max_size = DEFAULT_RING_BUFFER_MAX_SIZE;
+  queue->use_mmap = DEFAULT_USE_MMAP;
+  queue->ring = NULL;
 
   queue->use_bitrate_query = DEFAULT_USE_BITRATE_QUERY;
 
@@ -1466,6 +1499,416 @@ gst_queue2_have_data (GstQueue2 * queue, guint64 offset, guint length)
   return FALSE;
 }
 
+/* When use-mmap is set, the ring buffer is a GstQueue2Ring that is shared
+ * with the buffers pushed downstream. Those buffers contain a
+ * GstQueue2Memory for every contiguous part of the ring buffer they cover.
+ * The ring keeps a list of these memories, and before the writer overwrites
+ * a part of the ring buffer, it gives the memories that still reference it
+ * a private copy of their data. When such a memory is mapped at that time
+ * the queue moves on to a new ring with a copy of the data instead, and the
+ * old one stays around until the last memory referencing it is freed. */
+struct _GstQueue2Ring
+{
+  gint refcount;
+
+  GMutex lock;
+  guint8 *data;
+  guint64 size;
+  gboolean mapped;
+
+  /* mapping of the temp file at file_offset */
+  gboolean in_file;
+  guint64 file_offset;
+
+  /* memories referencing data, with the lock */
+  GQueue memories;
+};
+
+typedef struct
+{
+  GstMemory mem;
+
+  /* NULL for shared memories, which map their parent */
+  GstQueue2Ring *ring;
+  guint64 offset;
+  GList link;
+
+  /* with the ring lock */
+  guint8 *data;
+  gboolean copied;
+  gint map_count;
+} GstQueue2Memory;
+
+typedef GstAllocator GstQueue2Allocator;
+typedef GstAllocatorClass GstQueue2AllocatorClass;
+
+static GType gst_queue2_allocator_get_type (void);
+G_DEFINE_TYPE (GstQueue2Allocator, gst_queue2_allocator, GST_TYPE_ALLOCATOR);
+
+static GstQueue2Ring *
+gst_queue2_ring_new (GstQueue2 * queue, gint fd, guint64 file_offset,
+    guint64 size)
+{
+  GstQueue2Ring *ring;
+  guint8 *data = NULL;
+  gboolean mapped = FALSE;
+
+  if (size > G_MAXSIZE)
+    return NULL;
+
+#ifdef HAVE_SYS_MMAN_H
+  if (fd != -1) {
+    if (ftruncate (fd, (off_t) (file_offset + size)) == 0) {
+      data = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+          (off_t) file_offset);
+      if (data == MAP_FAILED)
+        data = NULL;
+    }
+  } else {
+#ifdef MAP_ANONYMOUS
+    data = mmap (NULL, size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED)
+      data = NULL;
+#endif
+  }
+  mapped = data != NULL;
+#endif
+
+  /* the temp file can only be shared when it is mapped */
+  if (data == NULL && fd != -1)
+    return NULL;
+  if (data == NULL && !(data = g_try_malloc (size)))
+    return NULL;
+
+  ring = g_slice_new0 (GstQueue2Ring);
+  ring->refcount = 1;
+  g_mutex_init (&ring->lock);
+  ring->data = data;
+  ring->size = size;
+  ring->mapped = mapped;
+  ring->in_file = fd != -1;
+  ring->file_offset = file_offset;
+  g_queue_init (&ring->memories);
+
+  GST_DEBUG_OBJECT (queue, "created ring of %" G_GUINT64_FORMAT " bytes, %s",
+      size, ring->in_file ? "in the temp file" : mapped ? "mapped" :
+      "allocated");
+
+  return ring;
+}
+
+static GstQueue2Ring *
+gst_queue2_ring_ref (GstQueue2Ring * ring)
+{
+  g_atomic_int_inc (&ring->refcount);
+  return ring;
+}
+
+static void
+gst_queue2_ring_unref (GstQueue2Ring * ring)
+{
+  if (!g_atomic_int_dec_and_test (&ring->refcount))
+    return;
+
+#ifdef HAVE_SYS_MMAN_H
+  if (ring->mapped)
+    munmap (ring->data, ring->size);
+  else
+#endif
+    g_free (ring->data);
+  g_mutex_clear (&ring->lock);
+  g_slice_free (GstQueue2Ring, ring);
+}
+
+/* with the queue lock */
+static void
+gst_queue2_ring_release (GstQueue2 * queue)
+{
+  GstQueue2Ring *ring = queue->ring;
+
+  if (ring == NULL)
+    return;
+
+  gst_queue2_ring_unref (ring);
+
+  queue->ring = NULL;
+  queue->ring_buffer = NULL;
+}
+
+static inline gboolean
+ring_memory_overlaps (GstQueue2Memory * qmem, guint64 offset, guint64 length)
+{
+  return qmem->offset < offset + length
+      && offset < qmem->offset + qmem->mem.maxsize;
+}
+
+/* with the queue lock. Makes sure no memory references the @length bytes
+ * at @offset in the ring anymore. Returns FALSE when a memory referencing
+ * them is mapped, the ring can then not be written to anymore. */
+static gboolean
+gst_queue2_ring_reclaim (GstQueue2Ring * ring, guint64 offset, guint64 length)
+{
+  guint64 wrapped = 0;
+  GList *walk, *next;
+  gboolean res = TRUE;
+
+  if (offset + length > ring->size) {
+    wrapped = offset + length - ring->size;
+    length -= wrapped;
+  }
+
+  g_mutex_lock (&ring->lock);
+  for (walk = ring->memories.head; walk; walk = next) {
+    GstQueue2Memory *qmem = walk->data;
+
+    next = walk->next;
+
+    if (!ring_memory_overlaps (qmem, offset, length)
+        && !ring_memory_overlaps (qmem, 0, wrapped))
+      continue;
+
+    if (qmem->map_count > 0) {
+      res = FALSE;
+      continue;
+    }
+
+    GST_CAT_LOG (queue_dataflow, "copying %" G_GSIZE_FORMAT " bytes at %"
+        G_GUINT64_FORMAT " out of the ring", qmem->mem.maxsize, qmem->offset);
+    qmem->data = g_memdup2 (qmem->data, qmem->mem.maxsize);
+    qmem->copied = TRUE;
+    g_queue_unlink (&ring->memories, walk);
+  }
+  g_mutex_unlock (&ring->lock);
+
+  return res;
+}
+
+/* with the queue lock. Replaces the ring of @queue with a new one, for when
+ * downstream still has part of the old one mapped. Waiting for the unmap
+ * could take forever, e.g. when a typefinder keeps the buffer it pulled. The
+ * old ring is freed with the last memory referencing it.
+ *
+ * Only the data between the reading and the writing position of the current
+ * range is copied, the rest of the ring and the other ranges are dropped. A
+ * ring in the temp file moves to the part of the file after the old ring,
+ * overwriting the old part would change the data that is still mapped. The
+ * file grows by the ring size every time this happens. */
+static gboolean
+gst_queue2_ring_detach (GstQueue2 * queue)
+{
+  GstQueue2Ring *old = queue->ring, *ring;
+  GstQueue2Range *range = queue->current, *walk, *next;
+  guint64 rpos, start, length, first, file_offset = 0;
+  gint fd = -1;
+
+#ifdef HAVE_SYS_MMAN_H
+  if (old->in_file) {
+    guint64 page_size = sysconf (_SC_PAGESIZE);
+
+    fd = fileno (queue->temp_file);
+    file_offset = old->file_offset +
+        (old->size + page_size - 1) / page_size * page_size;
+  }
+#endif
+
+  ring = gst_queue2_ring_new (queue, fd, file_offset, old->size);
+  if (ring == NULL)
+    return FALSE;
+
+  rpos = CLAMP (range->reading_pos, range->offset, range->writing_pos);
+  start = (range->rb_offset + (rpos - range->offset)) % old->size;
+  length = range->writing_pos - rpos;
+  first = MIN (length, old->size - start);
+
+  GST_DEBUG_OBJECT (queue, "ring still mapped downstream, copying %"
+      G_GUINT64_FORMAT " bytes at %" G_GUINT64_FORMAT " to a new one", length,
+      start);
+  memcpy (ring->data + start, old->data + start, first);
+  memcpy (ring->data, old->data, length - first);
+
+  range->offset = rpos;
+  range->rb_offset = start;
+  for (walk = queue->ranges; walk; walk = next) {
+    next = walk->next;
+    if (walk != range)
+      g_slice_free (GstQueue2Range, walk);
+  }
+  range->next = NULL;
+  queue->ranges = range;
+
+  queue->ring = ring;
+  queue->ring_buffer = ring->data;
+  gst_queue2_ring_unref (old);
+
+  return TRUE;
+}
+
+/* with the queue lock. Returns a read-only memory referencing @size bytes at
+ * @offset in @ring. */
+static GstMemory *
+gst_queue2_ring_share (GstQueue2Ring * ring, guint64 offset, gsize size)
+{
+  static GstAllocator *allocator = NULL;
+  GstQueue2Memory *qmem;
+
+  if (g_once_init_enter (&allocator)) {
+    GstAllocator *alloc;
+
+    alloc = g_object_new (gst_queue2_allocator_get_type (), NULL);
+    gst_object_ref_sink (alloc);
+    GST_OBJECT_FLAG_SET (alloc, GST_OBJECT_FLAG_MAY_BE_LEAKED);
+    g_once_init_leave (&allocator, alloc);
+  }
+
+  qmem = g_slice_new0 (GstQueue2Memory);
+  gst_memory_init (GST_MEMORY_CAST (qmem), GST_MEMORY_FLAG_READONLY,
+      allocator, NULL, size, 0, 0, size);
+  qmem->ring = gst_queue2_ring_ref (ring);
+  qmem->offset = offset;
+  qmem->link.data = qmem;
+  qmem->data = ring->data + offset;
+
+  g_mutex_lock (&ring->lock);
+  g_queue_push_tail_link (&ring->memories, &qmem->link);
+  g_mutex_unlock (&ring->lock);
+
+  return GST_MEMORY_CAST (qmem);
+}
+
+static gpointer
+gst_queue2_memory_map (GstMemory * mem, gsize maxsize, GstMapFlags flags)
+{
+  GstQueue2Memory *qmem = (GstQueue2Memory *) mem;
+  gpointer data;
+
+  if (mem->parent)
+    return gst_queue2_memory_map (mem->parent, maxsize, flags);
+
+  g_mutex_lock (&qmem->ring->lock);
+  qmem->map_count++;
+  data = qmem->data;
+  g_mutex_unlock (&qmem->ring->lock);
+
+  return data;
+}
+
+static void
+gst_queue2_memory_unmap (GstMemory * mem)
+{
+  GstQueue2Memory *qmem = (GstQueue2Memory *) mem;
+
+  if (mem->parent) {
+    gst_queue2_memory_unmap (mem->parent);
+    return;
+  }
+
+  g_mutex_lock (&qmem->ring->lock);
+  qmem->map_count--;
+  g_mutex_unlock (&qmem->ring->lock);
+}
+
+static GstMemory *
+gst_queue2_memory_share (GstMemory * mem, gssize offset, gssize size)
+{
+  GstQueue2Memory *sub;
+  GstMemory *parent;
+
+  if ((parent = mem->parent) == NULL)
+    parent = mem;
+
+  if (size == -1)
+    size = mem->size - offset;
+
+  sub = g_slice_new0 (GstQueue2Memory);
+  gst_memory_init (GST_MEMORY_CAST (sub),
+      GST_MINI_OBJECT_FLAGS (parent) | GST_MINI_OBJECT_FLAG_LOCK_READONLY,
+      mem->allocator, parent, mem->maxsize, mem->align, mem->offset + offset,
+      size);
+
+  return GST_MEMORY_CAST (sub);
+}
+
+static GstMemory *
+gst_queue2_memory_copy (GstMemory * mem, gssize offset, gssize size)
+{
+  GstMemory *copy;
+  GstMapInfo in, out;
+
+  if (size == -1)
+    size = mem->size > offset ? mem->size - offset : 0;
+
+  copy = gst_allocator_alloc (NULL, size, NULL);
+  if (!gst_memory_map (mem, &in, GST_MAP_READ))
+    goto map_failed;
+  if (!gst_memory_map (copy, &out, GST_MAP_WRITE)) {
+    gst_memory_unmap (mem, &in);
+    goto map_failed;
+  }
+  memcpy (out.data, in.data + offset, size);
+  gst_memory_unmap (copy, &out);
+  gst_memory_unmap (mem, &in);
+
+  return copy;
+
+map_failed:
+  {
+    gst_memory_unref (copy);
+    return NULL;
+  }
+}
+
+static gboolean
+gst_queue2_memory_is_span (GstMemory * mem1, GstMemory * mem2, gsize * offset)
+{
+  return FALSE;
+}
+
+static GstMemory *
+gst_queue2_allocator_alloc (GstAllocator * allocator, gsize size,
+    GstAllocationParams * params)
+{
+  return NULL;
+}
+
+static void
+gst_queue2_allocator_free (GstAllocator * allocator, GstMemory * mem)
+{
+  GstQueue2Memory *qmem = (GstQueue2Memory *) mem;
+  GstQueue2Ring *ring = qmem->ring;
+
+  if (ring) {
+    g_mutex_lock (&ring->lock);
+    if (qmem->copied)
+      g_free (qmem->data);
+    else
+      g_queue_unlink (&ring->memories, &qmem->link);
+    g_mutex_unlock (&ring->lock);
+    gst_queue2_ring_unref (ring);
+  }
+  g_slice_free (GstQueue2Memory, qmem);
+}
+
+static void
+gst_queue2_allocator_class_init (GstQueue2AllocatorClass * klass)
+{
+  klass->alloc = gst_queue2_allocator_alloc;
+  klass->free = gst_queue2_allocator_free;
+}
+
+static void
+gst_queue2_allocator_init (GstQueue2Allocator * allocator)
+{
+  allocator->mem_type = "Queue2Memory";
+  allocator->mem_map = gst_queue2_memory_map;
+  allocator->mem_unmap = gst_queue2_memory_unmap;
+  allocator->mem_share = gst_queue2_memory_share;
+  allocator->mem_copy = gst_queue2_memory_copy;
+  allocator->mem_is_span = gst_queue2_memory_is_span;
+
+  GST_OBJECT_FLAG_SET (allocator, GST_ALLOCATOR_FLAG_CUSTOM_ALLOC);
+}
+
 #ifdef HAVE_FSEEKO
 #define FSEEK_FILE(file,offset)  (fseeko (file, (off_t) offset, SEEK_SET) != 0)
 #elif defined (G_OS_UNIX) || defined (G_OS_WIN32)
@@ -1474,49 +1917,68 @@ gst_queue2_have_data (GstQueue2 * queue, guint64 offset, guint length)
 #define FSEEK_FILE(file,offset)  (fseek (file, offset, SEEK_SET) != 0)
 #endif
 
+/* pread() and pwrite() on the file descriptor avoid the seeks and the extra
+ * copy into the stdio buffer, the FILE is then only used to manage the
+ * temp file */
+#if defined (HAVE_PREAD) && defined (HAVE_PWRITE)
+#define QUEUE_USE_PREAD_PWRITE 1
+#endif
+
+/* the data is in the temp file and not in a mapping of it */
+#define QUEUE_IS_USING_FILE_IO(queue) \
+  (QUEUE_IS_USING_TEMP_FILE (queue) && (queue)->ring == NULL)
+
 static GstFlowReturn
 gst_queue2_read_data_at_offset (GstQueue2 * queue, guint64 offset, guint length,
     guint8 * dst, gint64 * read_return)
 {
-  guint8 *ring_buffer;
-  size_t res;
-
-  ring_buffer = queue->ring_buffer;
-
-  if (QUEUE_IS_USING_TEMP_FILE (queue) && FSEEK_FILE (queue->temp_file, offset))
-    goto seek_failed;
+  gssize res;
 
   /* this should not block */
   GST_LOG_OBJECT (queue, "Reading %d bytes from offset %" G_GUINT64_FORMAT,
       length, offset);
-  if (QUEUE_IS_USING_TEMP_FILE (queue)) {
-    res = fread (dst, 1, length, queue->temp_file);
-  } else {
-    memcpy (dst, ring_buffer + offset, length);
+  if (!QUEUE_IS_USING_FILE_IO (queue)) {
+    memcpy (dst, queue->ring_buffer + offset, length);
     res = length;
-  }
-
-  GST_LOG_OBJECT (queue, "read %" G_GSIZE_FORMAT " bytes", res);
+  } else {
+#ifdef QUEUE_USE_PREAD_PWRITE
+    do {
+      res = pread (fileno (queue->temp_file), dst, length, (off_t) offset);
+    } while (res < 0 && errno == EINTR);
 
-  if (G_UNLIKELY (res < length)) {
-    if (!QUEUE_IS_USING_TEMP_FILE (queue))
-      goto could_not_read;
-    /* check for errors or EOF */
-    if (ferror (queue->temp_file))
+    if (res < 0)
       goto could_not_read;
-    if (feof (queue->temp_file) && length > 0)
+    if (res == 0 && length > 0)
       goto eos;
+#else
+    if (FSEEK_FILE (queue->temp_file, offset))
+      goto seek_failed;
+
+    res = fread (dst, 1, length, queue->temp_file);
+
+    if (G_UNLIKELY ((gsize) res < length)) {
+      /* check for errors or EOF */
+      if (ferror (queue->temp_file))
+        goto could_not_read;
+      if (feof (queue->temp_file) && length > 0)
+        goto eos;
+    }
+#endif
   }
 
+  GST_LOG_OBJECT (queue, "read %" G_GSSIZE_FORMAT " bytes", res);
+
   *read_return = res;
 
   return GST_FLOW_OK;
 
+#ifndef QUEUE_USE_PREAD_PWRITE
 seek_failed:
   {
     GST_ELEMENT_ERROR (queue, RESOURCE, SEEK, (NULL), GST_ERROR_SYSTEM);
     return GST_FLOW_ERROR;
   }
+#endif
 could_not_read:
   {
     GST_ELEMENT_ERROR (queue, RESOURCE, READ, (NULL), GST_ERROR_SYSTEM);
@@ -1541,17 +2003,27 @@ gst_queue2_create_read (GstQueue2 * queue, guint64 offset, guint length,
   guint64 rb_size;
   guint64 max_size;
   guint64 rpos;
+  gboolean share;
   GstFlowReturn ret = GST_FLOW_OK;
 
+  /* reference the ring instead of copying from it when we can */
+  share = queue->ring != NULL && *buffer == NULL;
+
   /* allocate the output buffer of the requested size */
-  if (*buffer == NULL)
+  if (share)
+    buf = gst_buffer_new ();
+  else if (*buffer == NULL)
     buf = gst_buffer_new_allocate (NULL, length, NULL);
   else
     buf = *buffer;
 
-  if (!gst_buffer_map (buf, &info, GST_MAP_WRITE))
+  if (share) {
+    data = NULL;
+  } else if (gst_buffer_map (buf, &info, GST_MAP_WRITE)) {
+    data = info.data;
+  } else {
     goto buffer_write_fail;
-  data = info.data;
+  }
 
   GST_DEBUG_OBJECT (queue, "Reading %u bytes from %" G_GUINT64_FORMAT, length,
       offset);
@@ -1644,17 +2116,23 @@ gst_queue2_create_read (GstQueue2 * queue, guint64 offset, guint length,
     while (read_length > 0) {
       gint64 read_return;
 
-      ret =
-          gst_queue2_read_data_at_offset (queue, file_offset, block_length,
-          data, &read_return);
-      if (ret != GST_FLOW_OK)
-        goto read_error;
+      if (share) {
+        gst_buffer_append_memory (buf,
+            gst_queue2_ring_share (queue->ring, file_offset, block_length));
+        read_return = block_length;
+      } else {
+        ret =
+            gst_queue2_read_data_at_offset (queue, file_offset, block_length,
+            data, &read_return);
+        if (ret != GST_FLOW_OK)
+          goto read_error;
+        data += read_return;
+      }
 
       file_offset += read_return;
       if (QUEUE_IS_USING_RING_BUFFER (queue))
         file_offset %= rb_size;
 
-      data += read_return;
       read_length -= read_return;
       block_length = read_length;
       remaining -= read_return;
@@ -1666,7 +2144,8 @@ gst_queue2_create_read (GstQueue2 * queue, guint64 offset, guint length,
     GST_DEBUG_OBJECT (queue, "%u bytes left to read", remaining);
   }
 
-  gst_buffer_unmap (buf, &info);
+  if (!share)
+    gst_buffer_unmap (buf, &info);
   gst_buffer_resize (buf, 0, length);
 
   GST_BUFFER_OFFSET (buf) = offset;
@@ -1680,7 +2159,8 @@ gst_queue2_create_read (GstQueue2 * queue, guint64 offset, guint length,
 hit_eos:
   {
     GST_DEBUG_OBJECT (queue, "EOS hit and we don't have any requested data");
-    gst_buffer_unmap (buf, &info);
+    if (!share)
+      gst_buffer_unmap (buf, &info);
     if (*buffer == NULL)
       gst_buffer_unref (buf);
     return GST_FLOW_EOS;
@@ -1688,7 +2168,8 @@ hit_eos:
 out_flushing:
   {
     GST_DEBUG_OBJECT (queue, "we are flushing");
-    gst_buffer_unmap (buf, &info);
+    if (!share)
+      gst_buffer_unmap (buf, &info);
     if (*buffer == NULL)
       gst_buffer_unref (buf);
     return GST_FLOW_FLUSHING;
@@ -1696,7 +2177,8 @@ out_flushing:
 read_error:
   {
     GST_DEBUG_OBJECT (queue, "we have a read error");
-    gst_buffer_unmap (buf, &info);
+    if (!share)
+      gst_buffer_unmap (buf, &info);
     if (*buffer == NULL)
       gst_buffer_unref (buf);
     return ret;
@@ -1786,6 +2268,15 @@ gst_queue2_open_temp_location_file (GstQueue2 * queue)
   if (queue->temp_file == NULL)
     goto open_failed;
 
+  if (QUEUE_IS_USING_RING_BUFFER (queue) && queue->use_mmap) {
+    queue->ring =
+        gst_queue2_ring_new (queue, fd, 0, queue->ring_buffer_max_size);
+    if (queue->ring)
+      queue->ring_buffer = queue->ring->data;
+    else
+      GST_WARNING_OBJECT (queue, "could not map temp file, copying data");
+  }
+
   g_free (queue->temp_location);
   queue->temp_location = name;
 
@@ -1840,6 +2331,8 @@ gst_queue2_close_temp_location_file (GstQueue2 * queue)
 
   GST_DEBUG_OBJECT (queue, "closing temp file");
 
+  gst_queue2_ring_release (queue);
+
   fflush (queue->temp_file);
   fclose (queue->temp_file);
 
@@ -1860,6 +2353,11 @@ gst_queue2_flush_temp_file (GstQueue2 * queue)
   if (queue->temp_file == NULL)
     return;
 
+  /* buffers downstream might still reference the mapping, which does not
+   * survive truncating the file, the data is overwritten anyway */
+  if (queue->ring)
+    return;
+
   GST_DEBUG_OBJECT (queue, "flushing temp file");
 
   queue->temp_file = g_freopen (queue->temp_location, "wb+", queue->temp_file);
@@ -1942,11 +2440,43 @@ out_flushing:
   }
 }
 
+/* writes @length bytes of @data at @offset in the temp file or the ring
+ * buffer, returns FALSE and sets errno on errors */
+static gboolean
+gst_queue2_write_data_at_offset (GstQueue2 * queue, guint64 offset,
+    const guint8 * data, guint length)
+{
+  if (!QUEUE_IS_USING_FILE_IO (queue)) {
+    memcpy (queue->ring_buffer + offset, data, length);
+    return TRUE;
+  }
+#ifdef QUEUE_USE_PREAD_PWRITE
+  while (length > 0) {
+    gssize res;
+
+    res = pwrite (fileno (queue->temp_file), data, length, (off_t) offset);
+    if (res < 0) {
+      if (errno == EINTR)
+        continue;
+      return FALSE;
+    }
+    offset += res;
+    data += res;
+    length -= res;
+  }
+  return TRUE;
+#else
+  if (FSEEK_FILE (queue->temp_file, offset))
+    return FALSE;
+  return fwrite (data, length, 1, queue->temp_file) == 1;
+#endif
+}
+
 static gboolean
 gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
 {
   GstMapInfo info;
-  guint8 *data, *ring_buffer;
+  guint8 *data;
   guint size, rb_size;
   guint64 writing_pos, new_writing_pos;
   GstQueue2Range *range, *prev, *next;
@@ -1956,7 +2486,6 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
     writing_pos = queue->current->rb_writing_pos;
   else
     writing_pos = queue->current->writing_pos;
-  ring_buffer = queue->ring_buffer;
   rb_size = queue->ring_buffer_max_size;
 
   if (!gst_buffer_map (buffer, &info, GST_MAP_READ))
@@ -1995,6 +2524,15 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
        * buffer now */
       to_write = MIN (size, space);
 
+      /* buffers we pushed might still reference the data we are going to
+       * overwrite */
+      if (queue->ring
+          && !gst_queue2_ring_reclaim (queue->ring, writing_pos, to_write)
+          && !gst_queue2_ring_detach (queue)) {
+        errno = ENOMEM;
+        goto handle_error;
+      }
+
       /* the writing position in the ring buffer after writing (part
        * or all of) the buffer */
       new_writing_pos = (writing_pos + to_write) % rb_size;
@@ -2099,22 +2637,14 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
       new_writing_pos = writing_pos + to_write;
     }
 
-    if (QUEUE_IS_USING_TEMP_FILE (queue)
-        && FSEEK_FILE (queue->temp_file, writing_pos))
-      goto seek_failed;
-
     if (new_writing_pos > writing_pos) {
       GST_INFO_OBJECT (queue,
           "writing %u bytes to range [%" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT
           "] (rb wpos %" G_GUINT64_FORMAT ")", to_write, queue->current->offset,
           queue->current->writing_pos, queue->current->rb_writing_pos);
       /* either not using ring buffer or no wrapping, just write */
-      if (QUEUE_IS_USING_TEMP_FILE (queue)) {
-        if (fwrite (data, to_write, 1, queue->temp_file) != 1)
-          goto handle_error;
-      } else {
-        memcpy (ring_buffer + writing_pos, data, to_write);
-      }
+      if (!gst_queue2_write_data_at_offset (queue, writing_pos, data, to_write))
+        goto handle_error;
 
       if (!QUEUE_IS_USING_RING_BUFFER (queue)) {
         /* try to merge with next range */
@@ -2154,25 +2684,16 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
       if (block_one > 0) {
         GST_INFO_OBJECT (queue, "writing %u bytes", block_one);
         /* write data to end of ring buffer */
-        if (QUEUE_IS_USING_TEMP_FILE (queue)) {
-          if (fwrite (data, block_one, 1, queue->temp_file) != 1)
-            goto handle_error;
-        } else {
-          memcpy (ring_buffer + writing_pos, data, block_one);
-        }
+        if (!gst_queue2_write_data_at_offset (queue, writing_pos, data,
+                block_one))
+          goto handle_error;
       }
 
-      if (QUEUE_IS_USING_TEMP_FILE (queue) && FSEEK_FILE (queue->temp_file, 0))
-        goto seek_failed;
-
       if (block_two > 0) {
         GST_INFO_OBJECT (queue, "writing %u bytes", block_two);
-        if (QUEUE_IS_USING_TEMP_FILE (queue)) {
-          if (fwrite (data + block_one, block_two, 1, queue->temp_file) != 1)
-            goto handle_error;
-        } else {
-          memcpy (ring_buffer, data + block_one, block_two);
-        }
+        if (!gst_queue2_write_data_at_offset (queue, 0, data + block_one,
+                block_two))
+          goto handle_error;
       }
     }
 
@@ -2246,12 +2767,6 @@ out_flushing:
     /* FIXME - GST_FLOW_EOS ? */
     return FALSE;
   }
-seek_failed:
-  {
-    GST_ELEMENT_ERROR (queue, RESOURCE, SEEK, (NULL), GST_ERROR_SYSTEM);
-    gst_buffer_unmap (buffer, &info);
-    return FALSE;
-  }
 handle_error:
   {
     switch (errno) {
@@ -3709,6 +4224,34 @@ gst_queue2_src_activate_push (GstPad * pad, GstObject * parent, gboolean active)
   return result;
 }
 
+/* with the queue lock */
+static gboolean
+gst_queue2_alloc_ring_buffer (GstQueue2 * queue)
+{
+  if (queue->use_mmap) {
+    queue->ring =
+        gst_queue2_ring_new (queue, -1, 0, queue->ring_buffer_max_size);
+    if (queue->ring)
+      queue->ring_buffer = queue->ring->data;
+  } else {
+    queue->ring_buffer = g_malloc (queue->ring_buffer_max_size);
+  }
+
+  return queue->ring_buffer != NULL;
+}
+
+/* with the queue lock */
+static void
+gst_queue2_free_ring_buffer (GstQueue2 * queue)
+{
+  if (queue->ring) {
+    gst_queue2_ring_release (queue);
+  } else {
+    g_free (queue->ring_buffer);
+    queue->ring_buffer = NULL;
+  }
+}
+
 /* pull mode, downstream will call our getrange function */
 static gboolean
 gst_queue2_src_activate_pull (GstPad * pad, GstObject * parent, gboolean active)
@@ -3725,8 +4268,7 @@ gst_queue2_src_activate_pull (GstPad * pad, GstObject * parent, gboolean active)
         /* open the temp file now */
         result = gst_queue2_open_temp_location_file (queue);
       } else if (!queue->ring_buffer) {
-        queue->ring_buffer = g_malloc (queue->ring_buffer_max_size);
-        result = ! !queue->ring_buffer;
+        result = gst_queue2_alloc_ring_buffer (queue);
       } else {
         result = TRUE;
       }
@@ -3800,11 +4342,8 @@ gst_queue2_change_state (GstElement * element, GstStateChange transition)
           if (!gst_queue2_open_temp_location_file (queue))
             ret = GST_STATE_CHANGE_FAILURE;
         } else {
-          if (queue->ring_buffer) {
-            g_free (queue->ring_buffer);
-            queue->ring_buffer = NULL;
-          }
-          if (!(queue->ring_buffer = g_malloc (queue->ring_buffer_max_size)))
+          gst_queue2_free_ring_buffer (queue);
+          if (!gst_queue2_alloc_ring_buffer (queue))
             ret = GST_STATE_CHANGE_FAILURE;
         }
         init_ranges (queue);
@@ -3840,9 +4379,8 @@ gst_queue2_change_state (GstElement * element, GstStateChange transition)
       if (!QUEUE_IS_USING_QUEUE (queue)) {
         if (QUEUE_IS_USING_TEMP_FILE (queue)) {
           gst_queue2_close_temp_location_file (queue);
-        } else if (queue->ring_buffer) {
-          g_free (queue->ring_buffer);
-          queue->ring_buffer = NULL;
+        } else {
+          gst_queue2_free_ring_buffer (queue);
         }
         clean_ranges (queue);
       }
@@ -3982,6 +4520,9 @@ gst_queue2_set_property (GObject * object,
     case PROP_USE_BITRATE_QUERY:
       queue->use_bitrate_query = g_value_get_boolean (value);
       break;
+    case PROP_USE_MMAP:
+      queue->use_mmap = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -4069,6 +4610,9 @@ gst_queue2_get_property (GObject * object,
     case PROP_USE_BITRATE_QUERY:
       g_value_set_boolean (value, queue->use_bitrate_query);
       break;
+    case PROP_USE_MMAP:
+      g_value_set_boolean (value, queue->use_mmap);
+      break;
     case PROP_BITRATE:{
       guint64 bitrate = 0;
       if (bitrate == 0 && queue->use_tags_bitrate) {
@@ -47,6 +47,7 @@ typedef struct _GstQueue2 GstQueue2;
 typedef struct _GstQueue2Size GstQueue2Size;
 typedef struct _GstQueue2Class GstQueue2Class;
 typedef struct _GstQueue2Range GstQueue2Range;
+typedef struct _GstQueue2Ring GstQueue2Ring;
 
 /* used to keep track of sizes (current and max) */
 struct _GstQueue2Size
@@ -163,6 +164,9 @@ struct _GstQueue2
 
   guint64 ring_buffer_max_size;
   guint8 * ring_buffer;
+  /* ring buffer shared with the buffers we push when use_mmap is set */
+  gboolean use_mmap;
+  GstQueue2Ring *ring;
 
   gint downstream_may_block;
 
@@ -35,6 +35,12 @@
  * provide separate threads for each branch. Otherwise a blocked dataflow in one
  * branch would stall the other branches.
  *
+ * Since 1.22, setting #GstTee:parallel makes tee push each buffer to all
+ * branches at the same time from a pool of threads, and wait for all of them
+ * before accepting the next buffer. The time spent in tee is then that of the
+ * slowest branch instead of the sum of all branches, without adding queues
+ * and their buffering. A blocked branch still stalls the other ones.
+ *
  * ## Example launch line
  * |[
  * gst-launch-1.0 filesrc location=song.ogg ! decodebin ! tee name=t ! queue ! audioconvert ! audioresample ! autoaudiosink t. ! queue ! audioconvert ! goom ! videoconvert ! autovideosink
@@ -88,6 +94,7 @@ gst_tee_pull_mode_get_type (void)
 #define DEFAULT_PROP_LAST_MESSAGE	NULL
 #define DEFAULT_PULL_MODE		GST_TEE_PULL_MODE_NEVER
 #define DEFAULT_PROP_ALLOW_NOT_LINKED	FALSE
+#define DEFAULT_PROP_PARALLEL		FALSE
 
 enum
 {
@@ -99,6 +106,7 @@ enum
   PROP_PULL_MODE,
   PROP_ALLOC_PAD,
   PROP_ALLOW_NOT_LINKED,
+  PROP_PARALLEL,
 };
 
 static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src_%u",
@@ -225,6 +233,12 @@ gst_tee_finalize (GObject * object)
 
   g_free (tee->last_message);
 
+  if (tee->push_pool) {
+    gst_task_pool_cleanup (tee->push_pool);
+    gst_object_unref (tee->push_pool);
+  }
+  g_cond_clear (&tee->push_cond);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -288,6 +302,22 @@ gst_tee_class_init (GstTeeClass * klass)
           "all unlinked", DEFAULT_PROP_ALLOW_NOT_LINKED,
           G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstTee:parallel
+   *
+   * Push each buffer to all source pads concurrently from a pool of threads
+   * instead of one after the other from the streaming thread. The flow
+   * returns are combined in the same way as in sequential mode, but all pads
+   * get the buffer even when one of them returns an error.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_PARALLEL,
+      g_param_spec_boolean ("parallel", "Parallel",
+          "Push to all source pads concurrently", DEFAULT_PROP_PARALLEL,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (gstelement_class,
       "Tee pipe fitting",
       "Generic",
@@ -324,6 +354,9 @@ gst_tee_init (GstTee * tee)
   tee->pad_indexes = g_hash_table_new (NULL, NULL);
 
   tee->last_message = NULL;
+
+  tee->parallel = DEFAULT_PROP_PARALLEL;
+  g_cond_init (&tee->push_cond);
 }
 
 static void
@@ -508,6 +541,9 @@ gst_tee_set_property (GObject * object, guint prop_id, const GValue * value,
     case PROP_ALLOW_NOT_LINKED:
       tee->allow_not_linked = g_value_get_boolean (value);
       break;
+    case PROP_PARALLEL:
+      tee->parallel = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -544,6 +580,9 @@ gst_tee_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_ALLOW_NOT_LINKED:
       g_value_set_boolean (value, tee->allow_not_linked);
       break;
+    case PROP_PARALLEL:
+      g_value_set_boolean (value, tee->parallel);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -865,6 +904,113 @@ clear_pads (GstPad * pad, GstTee * tee)
   GST_TEE_PAD_CAST (pad)->result = GST_FLOW_NOT_LINKED;
 }
 
+typedef struct
+{
+  GstTee *tee;
+  GstPad *pad;
+  gpointer data;
+  gboolean is_list;
+} GstTeePushJob;
+
+static void
+gst_tee_push_job (GstTeePushJob * job)
+{
+  GstTee *tee = job->tee;
+  GstPad *pad = job->pad;
+  GstFlowReturn ret;
+
+  GST_LOG_OBJECT (pad, "Starting to push %s %p",
+      job->is_list ? "list" : "buffer", job->data);
+
+  ret = gst_tee_do_push (tee, pad, job->data, job->is_list);
+
+  GST_LOG_OBJECT (pad, "Pushing item %p yielded result %s", job->data,
+      gst_flow_get_name (ret));
+
+  GST_OBJECT_LOCK (tee);
+  if (GST_TEE_PAD_CAST (pad)->removed)
+    ret = GST_FLOW_NOT_LINKED;
+  GST_TEE_PAD_CAST (pad)->pushed = TRUE;
+  GST_TEE_PAD_CAST (pad)->result = ret;
+  if (--tee->pending_pushes == 0)
+    g_cond_signal (&tee->push_cond);
+  GST_OBJECT_UNLOCK (tee);
+
+  gst_object_unref (pad);
+  g_slice_free (GstTeePushJob, job);
+}
+
+/* Pushes @data on all src pads at the same time, the last one from the
+ * calling thread, and waits until all pushes are done. The pads are marked
+ * as pushed with their result so that the caller only has to combine the
+ * results. Must be called with the OBJECT_LOCK, which is released while
+ * pushing. */
+static void
+gst_tee_push_parallel (GstTee * tee, gpointer data, gboolean is_list)
+{
+  GList *pads, *jobs = NULL, *l;
+
+  if (G_UNLIKELY (tee->push_pool == NULL)) {
+    GError *err = NULL;
+
+    tee->push_pool = gst_task_pool_new ();
+    gst_task_pool_prepare (tee->push_pool, &err);
+    if (err) {
+      GST_WARNING_OBJECT (tee, "failed to prepare thread pool: %s",
+          err->message);
+      g_clear_error (&err);
+      gst_object_unref (tee->push_pool);
+      tee->push_pool = NULL;
+      return;
+    }
+  }
+
+  for (pads = GST_ELEMENT_CAST (tee)->srcpads; pads; pads = pads->next) {
+    GstPad *pad = GST_PAD_CAST (pads->data);
+    GstTeePushJob *job;
+
+    if (pad == tee->pull_pad)
+      continue;
+
+    job = g_slice_new (GstTeePushJob);
+    job->tee = tee;
+    job->pad = gst_object_ref (pad);
+    job->data = data;
+    job->is_list = is_list;
+    jobs = g_list_prepend (jobs, job);
+    tee->pending_pushes++;
+  }
+  GST_OBJECT_UNLOCK (tee);
+
+  /* the caller keeps a ref on data until all jobs are done */
+  for (l = jobs; l; l = l->next) {
+    GstTeePushJob *job = l->data;
+    GError *err = NULL;
+    gpointer handle;
+
+    if (l->next == NULL) {
+      gst_tee_push_job (job);
+      break;
+    }
+
+    handle = gst_task_pool_push (tee->push_pool,
+        (GstTaskPoolFunction) gst_tee_push_job, job, &err);
+    if (err) {
+      GST_WARNING_OBJECT (tee, "failed to push to thread pool: %s",
+          err->message);
+      g_clear_error (&err);
+      gst_tee_push_job (job);
+    } else {
+      gst_task_pool_dispose_handle (tee->push_pool, handle);
+    }
+  }
+  g_list_free (jobs);
+
+  GST_OBJECT_LOCK (tee);
+  while (tee->pending_pushes > 0)
+    g_cond_wait (&tee->push_cond, GST_OBJECT_GET_LOCK (tee));
+}
+
 static GstFlowReturn
 gst_tee_handle_data (GstTee * tee, gpointer data, gboolean is_list)
 {
@@ -916,6 +1062,11 @@ gst_tee_handle_data (GstTee * tee, gpointer data, gboolean is_list)
   /* mark all pads as 'not pushed on yet' */
   g_list_foreach (pads, (GFunc) clear_pads, tee);
 
+  /* push to all pads at once, the loop below then only combines the results
+   * and pushes to pads that were added in the meantime */
+  if (tee->parallel)
+    gst_tee_push_parallel (tee, data, is_list);
+
 restart:
   if (tee->allow_not_linked) {
     cret = GST_FLOW_OK;
@@ -81,6 +81,11 @@ struct _GstTee {
   GstPad         *pull_pad;
 
   gboolean        allow_not_linked;
+
+  gboolean        parallel;
+  GstTaskPool    *push_pool;
+  guint           pending_pushes;
+  GCond           push_cond;
 };
 
 struct _GstTeeClass {
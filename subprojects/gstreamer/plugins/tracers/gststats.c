@@ -54,6 +54,7 @@ static GstTracerRecord *tr_element_query;
 static GstTracerRecord *tr_event;
 static GstTracerRecord *tr_message;
 static GstTracerRecord *tr_query;
+static GstTracerRecord *tr_buffer_pool;
 
 typedef struct
 {
@@ -473,6 +474,22 @@ do_post_message_pre (GstStatsTracer * self, guint64 ts, GstElement * elem,
     gst_structure_free (s);
 }
 
+static void
+do_buffer_pool_stats (GstStatsTracer * self, guint64 ts, GstBufferPool * pool,
+    const GstStructure * stats)
+{
+  guint64 hits = 0, allocations = 0, waits = 0, wait_time = 0;
+  guint hwm = 0;
+
+  gst_structure_get (stats, "hits", G_TYPE_UINT64, &hits,
+      "allocations", G_TYPE_UINT64, &allocations,
+      "waits", G_TYPE_UINT64, &waits,
+      "wait-time", G_TYPE_UINT64, &wait_time,
+      "high-water-mark", G_TYPE_UINT, &hwm, NULL);
+  gst_tracer_record_log (tr_buffer_pool, (guint64) (guintptr) g_thread_self (),
+      ts, GST_OBJECT_NAME (pool), hits, allocations, waits, wait_time, hwm);
+}
+
 static void
 do_element_new (GstStatsTracer * self, guint64 ts, GstElement * elem)
 {
@@ -773,6 +790,40 @@ gst_stats_tracer_class_init (GstStatsTracerClass * klass)
           "description", G_TYPE_STRING, "ipad direction",
           NULL),
       NULL);
+  tr_buffer_pool = gst_tracer_record_new ("buffer-pool.class",
+      "thread-id", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_THREAD,
+          NULL),
+      "ts", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "event ts",
+          NULL),
+      "name", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "description", G_TYPE_STRING, "name of the buffer pool",
+          NULL),
+      "hits", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "buffers acquired from the free buffers",
+          NULL),
+      "allocations", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "buffers allocated by the pool",
+          NULL),
+      "waits", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "acquires that waited for a buffer",
+          NULL),
+      "wait-time", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "time spent waiting in ns",
+          NULL),
+      "high-water-mark", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT,
+          "description", G_TYPE_STRING, "most buffers in use at the same time",
+          NULL),
+      NULL);
   /* *INDENT-ON* */
 
   GST_OBJECT_FLAG_SET (tr_buffer, GST_OBJECT_FLAG_MAY_BE_LEAKED);
@@ -782,6 +833,7 @@ gst_stats_tracer_class_init (GstStatsTracerClass * klass)
   GST_OBJECT_FLAG_SET (tr_query, GST_OBJECT_FLAG_MAY_BE_LEAKED);
   GST_OBJECT_FLAG_SET (tr_new_element, GST_OBJECT_FLAG_MAY_BE_LEAKED);
   GST_OBJECT_FLAG_SET (tr_new_pad, GST_OBJECT_FLAG_MAY_BE_LEAKED);
+  GST_OBJECT_FLAG_SET (tr_buffer_pool, GST_OBJECT_FLAG_MAY_BE_LEAKED);
 }
 
 static void
@@ -813,4 +865,6 @@ gst_stats_tracer_init (GstStatsTracer * self)
       G_CALLBACK (do_query_pre));
   gst_tracing_register_hook (tracer, "pad-query-post",
       G_CALLBACK (do_query_post));
+  gst_tracing_register_hook (tracer, "buffer-pool-stats",
+      G_CALLBACK (do_buffer_pool_stats));
 }
@@ -40,6 +40,60 @@
   "rate = (int) [ 1, MAX ], " \
   "channels = (int) [ 1, MAX ]"
 
+#define PEER_CAPS \
+  "audio/x-raw, format = (string) { S16LE, S32LE, F32LE }, " \
+  "rate = (int) { 44100, 48000 }, channels = (int) [ 1, 2 ], " \
+  "layout = (string) interleaved; " \
+  "audio/x-raw, format = (string) F64LE, rate = (int) [ 8000, 96000 ], " \
+  "channels = (int) [ 1, 8 ], layout = (string) non-interleaved"
+
+/* Repeated operations on the same caps, as done by negotiation in pipelines
+ * with many elements. Run with GST_CAPS_CACHE_SIZE=1024 to compare. */
+static void
+run_negotiation (GstCaps * templcaps)
+{
+  GstCaps *peercaps, *res;
+  GstClockTime start, end;
+  GstStructure *stats;
+  gchar *str;
+  gint i;
+
+  peercaps = gst_caps_from_string (PEER_CAPS);
+  /* like pad template caps, they are shared and not writable */
+  gst_caps_ref (peercaps);
+  gst_caps_ref (templcaps);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_CAPS; i++) {
+    res = gst_caps_intersect (peercaps, templcaps);
+    gst_caps_unref (res);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - %d intersections\n",
+      GST_TIME_ARGS (end - start), i);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_CAPS; i++) {
+    if (!gst_caps_can_intersect (peercaps, templcaps))
+      g_assert_not_reached ();
+    if (!gst_caps_is_subset (peercaps, templcaps))
+      g_assert_not_reached ();
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - %d can-intersect and subset checks\n",
+      GST_TIME_ARGS (end - start), i);
+
+  stats = gst_tracing_get_caps_cache_stats ();
+  str = gst_structure_to_string (stats);
+  g_print ("%s\n", str);
+  g_free (str);
+  gst_structure_free (stats);
+
+  gst_caps_unref (templcaps);
+  gst_caps_unref (peercaps);
+  gst_caps_unref (peercaps);
+}
+
 
 gint
 main (gint argc, gchar * argv[])
@@ -69,6 +123,9 @@ main (gint argc, gchar * argv[])
       GST_TIME_ARGS (end - start), i);
 
   g_free (capses);
+
+  run_negotiation (protocaps);
+
   gst_caps_unref (protocaps);
 
   return 0;
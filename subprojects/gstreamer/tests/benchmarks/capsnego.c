@@ -28,6 +28,7 @@
  *  -c children: is the number of branches on each level
  *  -f <flavour>: can be "audio" or "video" and is controlling the kind of
  *                elements that are used.
+ *  -C entries: enables the caps cache with this many entries
  */
 
 #include <gst/gst.h>
@@ -133,6 +134,28 @@ create_nodes (GstBin * bin, GstElement * sink, gint depth, gint children,
   return TRUE;
 }
 
+static gboolean
+set_caps_cache_size (const gchar * option_name, const gchar * value,
+    gpointer data, GError ** error)
+{
+  /* must be set before gst_init() runs at the end of the option parsing */
+  g_setenv ("GST_CAPS_CACHE_SIZE", value, TRUE);
+  return TRUE;
+}
+
+static void
+print_caps_cache_stats (void)
+{
+  GstStructure *stats;
+  gchar *str;
+
+  stats = gst_tracing_get_caps_cache_stats ();
+  str = gst_structure_to_string (stats);
+  g_print ("%s\n", str);
+  g_free (str);
+  gst_structure_free (stats);
+}
+
 static void
 event_loop (GstElement * bin)
 {
@@ -206,6 +229,9 @@ main (gint argc, gchar * argv[])
     {"loops", 'l', 0, G_OPTION_ARG_INT, &loops,
         "How many loops to run (default: 50)", NULL}
     ,
+    {"caps-cache", 'C', 0, G_OPTION_ARG_CALLBACK, set_caps_cache_size,
+        "Number of entries of the caps cache (default: disabled)", NULL}
+    ,
     {NULL}
   };
   GError *err = NULL;
@@ -265,6 +291,7 @@ main (gint argc, gchar * argv[])
   end = gst_util_get_timestamp ();
   g_print ("%" GST_TIME_FORMAT " reached PAUSED state (%d loop iterations)\n",
       GST_TIME_ARGS (end - start), loops);
+  print_caps_cache_stats ();
   /* clean up */
 Error:
   gst_element_set_state (GST_ELEMENT (bin), GST_STATE_NULL);
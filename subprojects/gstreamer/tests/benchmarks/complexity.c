@@ -111,6 +111,9 @@ main (gint argc, gchar * argv[])
   gst_message_unref (msg);
   g_print ("%" GST_TIME_FORMAT " - putting %d buffers through\n",
       GST_TIME_ARGS (end - start), BUFFER_COUNT);
+  /* every element was linked once, so every buffer is pushed on each link */
+  g_print ("%" G_GUINT64_FORMAT " ns per buffer and link\n",
+      (end - start) / MAX ((guint64) BUFFER_COUNT * n_elements, 1));
 
   start = gst_util_get_timestamp ();
   if (gst_element_set_state (pipeline,
@@ -0,0 +1,192 @@
+/* GStreamer
+ * Copyright (C) 2022 GStreamer developers
+ *
+ * gstbuffermeta.c: benchmark buffers with and without metas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <gst/gst.h>
+
+#define BUFFER_SIZE (1400)
+
+/* reference of the timestamp metas added to the buffers */
+static GstCaps *reference;
+
+/* resident memory in bytes, or 0 when it is unknown */
+static gsize
+get_resident_size (void)
+{
+#ifdef __linux__
+  gulong pages = 0, resident = 0;
+  FILE *f;
+
+  f = fopen ("/proc/self/statm", "r");
+  if (f == NULL)
+    return 0;
+  if (fscanf (f, "%lu %lu", &pages, &resident) != 2)
+    resident = 0;
+  fclose (f);
+
+  return resident * 4096;
+#else
+  return 0;
+#endif
+}
+
+static void
+print_result (const gchar * name, GstClockTime start, guint64 n)
+{
+  GstClockTimeDiff dur = GST_CLOCK_DIFF (start, gst_util_get_timestamp ());
+
+  g_print ("*** %-32s total %" GST_TIME_FORMAT " - average %" G_GINT64_FORMAT
+      " ns\n", name, GST_TIME_ARGS (dur), dur / (gint64) n);
+}
+
+/* keep @n buffers alive at the same time and report the memory they use */
+static void
+run_resident (guint64 n, gboolean with_meta)
+{
+  GstBuffer **buffers;
+  gsize before, after;
+  guint64 i;
+
+  buffers = g_new (GstBuffer *, n);
+
+  before = get_resident_size ();
+  for (i = 0; i < n; i++) {
+    buffers[i] = gst_buffer_new ();
+    if (with_meta)
+      gst_buffer_add_reference_timestamp_meta (buffers[i], reference, i, 0);
+  }
+  after = get_resident_size ();
+
+  if (before && after)
+    g_print ("*** %-32s %" G_GUINT64_FORMAT " bytes per buffer\n",
+        with_meta ? "resident, one meta" : "resident, no meta",
+        (guint64) (after - before) / n);
+
+  for (i = 0; i < n; i++)
+    gst_buffer_unref (buffers[i]);
+  g_free (buffers);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstBufferPool *pool;
+  GstStructure *conf;
+  GstClockTime start;
+  GstBuffer *buf;
+  GType api;
+  guint64 i, n;
+
+  gst_init (&argc, &argv);
+
+  if (argc != 2) {
+    g_print ("usage: %s <nbuffers>\n", argv[0]);
+    exit (-1);
+  }
+
+  n = g_ascii_strtoull (argv[1], NULL, 10);
+  if (n == 0) {
+    g_print ("number of buffers must be greater than 0\n");
+    exit (-3);
+  }
+
+  api = GST_REFERENCE_TIMESTAMP_META_API_TYPE;
+  reference = gst_caps_new_empty_simple ("timestamp/x-benchmark");
+
+  /* make sure the classes are loaded */
+  buf = gst_buffer_new ();
+  gst_buffer_add_reference_timestamp_meta (buf, reference, 0, 0);
+  gst_buffer_unref (buf);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n; i++) {
+    buf = gst_buffer_new ();
+    gst_buffer_unref (buf);
+  }
+  print_result ("new/unref, no meta", start, n);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n; i++) {
+    buf = gst_buffer_new_allocate (NULL, BUFFER_SIZE, NULL);
+    gst_buffer_unref (buf);
+  }
+  print_result ("new_allocate/unref, no meta", start, n);
+
+  buf = gst_buffer_new ();
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n; i++) {
+    if (gst_buffer_get_meta (buf, api) != NULL)
+      g_assert_not_reached ();
+  }
+  print_result ("get_meta, no meta", start, n);
+  gst_buffer_unref (buf);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n; i++) {
+    buf = gst_buffer_new ();
+    gst_buffer_add_reference_timestamp_meta (buf, reference, i, 0);
+    gst_buffer_unref (buf);
+  }
+  print_result ("new/add_meta/unref", start, n);
+
+  buf = gst_buffer_new ();
+  gst_buffer_add_reference_timestamp_meta (buf, reference, 0, 0);
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n; i++) {
+    if (gst_buffer_get_meta (buf, api) == NULL)
+      g_assert_not_reached ();
+  }
+  print_result ("get_meta, one meta", start, n);
+  gst_buffer_unref (buf);
+
+  /* buffers from a pool keep their meta storage */
+  pool = gst_buffer_pool_new ();
+  conf = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (conf, NULL, BUFFER_SIZE, 0, 0);
+  gst_buffer_pool_set_config (pool, conf);
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n; i++) {
+    gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+    gst_buffer_unref (buf);
+  }
+  print_result ("pool acquire/release, no meta", start, n);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n; i++) {
+    gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+    gst_buffer_add_reference_timestamp_meta (buf, reference, i, 0);
+    gst_buffer_unref (buf);
+  }
+  print_result ("pool acquire/add_meta/release", start, n);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+
+  run_resident (n, FALSE);
+  run_resident (n, TRUE);
+
+  gst_caps_unref (reference);
+
+  return 0;
+}
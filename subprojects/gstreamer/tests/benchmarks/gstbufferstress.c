@@ -19,6 +19,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <gst/gst.h>
 #include "gst/glib-compat-private.h"
 
@@ -27,6 +28,39 @@
 static guint64 nbbuffers;
 static GMutex mutex;
 
+/* in cross-thread mode, odd threads free the buffers allocated by the even
+ * thread before them, like a streaming thread after a queue would */
+static gboolean cross;
+static GstAtomicQueue *queues[MAX_THREADS / 2];
+
+static void
+run_alloc (gint threadid)
+{
+  GstAtomicQueue *queue = queues[threadid / 2];
+  guint64 nb;
+
+  for (nb = nbbuffers; nb; nb--) {
+    gst_atomic_queue_push (queue, gst_buffer_new ());
+    /* don't let the freeing thread fall behind too far */
+    while (gst_atomic_queue_length (queue) > 1024)
+      g_thread_yield ();
+  }
+}
+
+static void
+run_free (gint threadid)
+{
+  GstAtomicQueue *queue = queues[threadid / 2];
+  GstBuffer *buf;
+  guint64 nb;
+
+  for (nb = nbbuffers; nb; nb--) {
+    while (!(buf = gst_atomic_queue_pop (queue)))
+      g_thread_yield ();
+    gst_buffer_unref (buf);
+  }
+}
+
 
 static void *
 run_test (void *user_data)
@@ -43,9 +77,15 @@ run_test (void *user_data)
 
   g_assert (nbbuffers > 0);
 
-  for (nb = nbbuffers; nb; nb--) {
-    buf = gst_buffer_new ();
-    gst_buffer_unref (buf);
+  if (!cross) {
+    for (nb = nbbuffers; nb; nb--) {
+      buf = gst_buffer_new ();
+      gst_buffer_unref (buf);
+    }
+  } else if (threadid % 2 == 0) {
+    run_alloc (threadid);
+  } else {
+    run_free (threadid);
   }
 
   end = gst_util_get_timestamp ();
@@ -66,17 +106,21 @@ main (gint argc, gchar * argv[])
   gint t;
   GstBuffer *tmp;
   GstClockTime start, end;
+  guint64 total;
+  GstStructure *stats;
+  gchar *str;
 
   gst_init (&argc, &argv);
   g_mutex_init (&mutex);
 
-  if (argc != 3) {
-    g_print ("usage: %s <num_threads> <nbbuffers>\n", argv[0]);
+  if (argc != 3 && !(argc == 4 && !strcmp (argv[3], "cross"))) {
+    g_print ("usage: %s <num_threads> <nbbuffers> [cross]\n", argv[0]);
     exit (-1);
   }
 
   num_threads = atoi (argv[1]);
   nbbuffers = atoi (argv[2]);
+  cross = (argc == 4);
 
   if (num_threads <= 0 || num_threads > MAX_THREADS) {
     g_print ("number of threads must be between 0 and %d\n", MAX_THREADS);
@@ -88,6 +132,14 @@ main (gint argc, gchar * argv[])
     exit (-3);
   }
 
+  if (cross && num_threads % 2) {
+    g_print ("number of threads must be even in cross-thread mode\n");
+    exit (-4);
+  }
+
+  for (t = 0; cross && t < num_threads / 2; t++)
+    queues[t] = gst_atomic_queue_new (1024);
+
   g_mutex_lock (&mutex);
   /* Let's just make sure the GstBufferClass is loaded ... */
   tmp = gst_buffer_new ();
@@ -116,12 +168,20 @@ main (gint argc, gchar * argv[])
   }
 
   end = gst_util_get_timestamp ();
+  total = (cross ? num_threads / 2 : num_threads) * nbbuffers;
   g_print ("*** total %" GST_TIME_FORMAT " - average %" GST_TIME_FORMAT
       "  - Done creating %" G_GUINT64_FORMAT " buffers\n",
-      GST_TIME_ARGS (end - start),
-      GST_TIME_ARGS ((end - start) / (num_threads * nbbuffers)),
-      num_threads * nbbuffers);
+      GST_TIME_ARGS (end - start), GST_TIME_ARGS ((end - start) / total),
+      total);
+
+  stats = gst_tracing_get_slice_cache_stats ();
+  str = gst_structure_to_string (stats);
+  g_print ("*** slice cache: %s\n", str);
+  g_free (str);
+  gst_structure_free (stats);
 
+  for (t = 0; cross && t < num_threads / 2; t++)
+    gst_atomic_queue_unref (queues[t]);
 
   gst_buffer_unref (tmp);
 
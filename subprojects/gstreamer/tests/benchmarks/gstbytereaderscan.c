@@ -0,0 +1,178 @@
+/* GStreamer
+ * Copyright (C) 2022 GStreamer developers
+ *
+ * gstbytereaderscan.c: benchmark the 00 00 01 start code scan
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Finds all start codes in an Annex B bitstream given on the command line,
+ * or in generated data that looks like a stream of large intra frames, with
+ * the byte by byte loop GstByteReader used before and with
+ * gst_byte_reader_masked_scan_uint32(). */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+#include <gst/base/gstbytereader.h>
+
+#define GENERATED_SIZE (64 * 1024 * 1024)
+#define GENERATED_NAL_SIZE (256 * 1024)
+#define RUNS 10
+
+/* the scan as it was before it used vector instructions */
+static gint
+scan_bytewise (const guint8 * data, guint size)
+{
+  const guint8 *pdata = data;
+  const guint8 *pend = data + size - 4;
+
+  while (pdata <= pend) {
+    if (pdata[2] > 1) {
+      pdata += 3;
+    } else if (pdata[1]) {
+      pdata += 2;
+    } else if (pdata[0] || pdata[2] != 1) {
+      pdata++;
+    } else {
+      return (pdata - data);
+    }
+  }
+
+  return -1;
+}
+
+static guint
+count_bytewise (const guint8 * data, gsize size)
+{
+  guint count = 0;
+  gsize offset = 0;
+  gint found;
+
+  while (size - offset >= 4
+      && (found = scan_bytewise (data + offset, size - offset)) != -1) {
+    count++;
+    offset += found + 3;
+  }
+
+  return count;
+}
+
+static guint
+count_byte_reader (const guint8 * data, gsize size)
+{
+  GstByteReader reader;
+  guint count = 0;
+  gint found;
+
+  gst_byte_reader_init (&reader, data, size);
+
+  while (gst_byte_reader_get_remaining (&reader) >= 4) {
+    found = gst_byte_reader_masked_scan_uint32 (&reader, 0xffffff00,
+        0x00000100, 0, gst_byte_reader_get_remaining (&reader));
+    if (found == -1)
+      break;
+    count++;
+    gst_byte_reader_skip_unchecked (&reader, found + 3);
+  }
+
+  return count;
+}
+
+/* random payload with emulation prevention, so that the only start codes
+ * are the ones in front of every NAL */
+static guint8 *
+generate_stream (gsize * size)
+{
+  guint8 *data = g_malloc (GENERATED_SIZE);
+  gsize i, zeros = 0;
+
+  for (i = 0; i < GENERATED_SIZE; i++) {
+    guint8 byte;
+
+    if (i % GENERATED_NAL_SIZE < 4) {
+      static const guint8 sc[] = { 0x00, 0x00, 0x01, 0x25 };
+      data[i] = sc[i % GENERATED_NAL_SIZE];
+      zeros = 0;
+      continue;
+    }
+
+    /* make zero bytes more common than in really random data */
+    byte = g_random_int_range (0, 8) == 0 ? 0 : g_random_int_range (0, 256);
+    if (zeros >= 2 && byte <= 3) {
+      byte = 3;
+      zeros = 0;
+    } else if (byte == 0) {
+      zeros++;
+    } else {
+      zeros = 0;
+    }
+    data[i] = byte;
+  }
+
+  *size = GENERATED_SIZE;
+  return data;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstClockTime start, bytewise = 0, byte_reader = 0;
+  guint8 *data;
+  gsize size;
+  guint i, count_old = 0, count_new = 0;
+  GError *err = NULL;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1) {
+    if (!g_file_get_contents (argv[1], (gchar **) & data, &size, &err)) {
+      g_printerr ("failed to read %s: %s\n", argv[1], err->message);
+      g_clear_error (&err);
+      return 1;
+    }
+  } else {
+    data = generate_stream (&size);
+  }
+
+  for (i = 0; i < RUNS; i++) {
+    start = gst_util_get_timestamp ();
+    count_old = count_bytewise (data, size);
+    bytewise += gst_util_get_timestamp () - start;
+
+    start = gst_util_get_timestamp ();
+    count_new = count_byte_reader (data, size);
+    byte_reader += gst_util_get_timestamp () - start;
+  }
+
+  if (count_old != count_new) {
+    g_printerr ("found %u start codes bytewise but %u with GstByteReader\n",
+        count_old, count_new);
+    g_free (data);
+    return 1;
+  }
+
+  g_print ("%" G_GSIZE_FORMAT " bytes, %u start codes\n", size, count_new);
+  g_print ("bytewise:      %" GST_TIME_FORMAT ", %.1f MB/s\n",
+      GST_TIME_ARGS (bytewise / RUNS),
+      (gdouble) size * RUNS * GST_SECOND / bytewise / 1e6);
+  g_print ("GstByteReader: %" GST_TIME_FORMAT ", %.1f MB/s\n",
+      GST_TIME_ARGS (byte_reader / RUNS),
+      (gdouble) size * RUNS * GST_SECOND / byte_reader / 1e6);
+
+  g_free (data);
+
+  return 0;
+}
@@ -0,0 +1,123 @@
+/* GStreamer
+ * Copyright (C) 2022 GStreamer developers
+ *
+ * gstclocktimers.c: benchmark many async timers on the system clock
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <gst/gst.h>
+
+#define INTERVAL (100 * GST_MSECOND)
+#define RUN_TIME (5 * GST_SECOND)
+
+static gint fired = 0;
+static gint64 lateness = 0;
+
+static gboolean
+timer_cb (GstClock * clock, GstClockTime time, GstClockID id,
+    gpointer user_data)
+{
+  GstClockTimeDiff late = GST_CLOCK_DIFF (time, gst_clock_get_time (clock));
+
+  g_atomic_int_inc (&fired);
+  /* only the callback thread updates this */
+  lateness += MAX (late, 0);
+
+  return TRUE;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstClock *sysclock;
+  GstClockID *ids;
+  GstClockTime start, end, base;
+  gint i, num_timers;
+
+  gst_init (&argc, &argv);
+
+  if (argc != 2) {
+    g_print ("usage: %s <num_timers>\n", argv[0]);
+    exit (-1);
+  }
+
+  num_timers = atoi (argv[1]);
+
+  if (num_timers <= 0) {
+    g_print ("number of timers must be greater than 0\n");
+    exit (-2);
+  }
+
+  sysclock = gst_system_clock_obtain ();
+  ids = g_new (GstClockID, num_timers);
+
+  /* schedule and cancel single shot timers far in the future, in random
+   * order, this is what the bookkeeping of the clock costs */
+  base = gst_clock_get_time (sysclock) + 3600 * GST_SECOND;
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < num_timers; i++) {
+    ids[i] = gst_clock_new_single_shot_id (sysclock,
+        base + g_random_int_range (0, 1000) * GST_MSECOND);
+    gst_clock_id_wait_async (ids[i], timer_cb, NULL, NULL);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("scheduled %d single shot timers in %" GST_TIME_FORMAT "\n",
+      num_timers, GST_TIME_ARGS (end - start));
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < num_timers; i++) {
+    gst_clock_id_unschedule (ids[i]);
+    gst_clock_id_unref (ids[i]);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("unscheduled %d single shot timers in %" GST_TIME_FORMAT "\n",
+      num_timers, GST_TIME_ARGS (end - start));
+
+  /* periodic timers spread over one interval, like RTCP or jitterbuffer
+   * timers of many sessions */
+  base = gst_clock_get_time (sysclock) + 10 * GST_MSECOND;
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < num_timers; i++) {
+    ids[i] = gst_clock_new_periodic_id (sysclock,
+        base + g_random_int_range (0, INTERVAL / GST_USECOND) * GST_USECOND,
+        INTERVAL);
+    gst_clock_id_wait_async (ids[i], timer_cb, NULL, NULL);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("scheduled %d periodic timers in %" GST_TIME_FORMAT "\n",
+      num_timers, GST_TIME_ARGS (end - start));
+
+  g_usleep (RUN_TIME / GST_USECOND);
+
+  for (i = 0; i < num_timers; i++) {
+    gst_clock_id_unschedule (ids[i]);
+    gst_clock_id_unref (ids[i]);
+  }
+
+  i = g_atomic_int_get (&fired);
+  g_print ("fired %d of %" G_GUINT64_FORMAT " expected callbacks, average "
+      "lateness %" GST_TIME_FORMAT "\n", i,
+      (guint64) num_timers * (RUN_TIME / INTERVAL),
+      GST_TIME_ARGS (i ? lateness / i : 0));
+
+  g_free (ids);
+  gst_object_unref (sysclock);
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+/* GStreamer
+ * Copyright (C) 2022 GStreamer developers
+ *
+ * gstmultiqueuestress.c: push buffers through a multiqueue with many pads
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Every run pushes the same total number of buffers through one multiqueue,
+ * spread over 1, 16 and 128 streams, so that the time per buffer shows how
+ * the cost of the multiqueue bookkeeping grows with the number of streams. */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+
+#define BUFFER_COUNT (128 * 1000)
+
+static const guint n_pads[] = { 1, 16, 128 };
+
+static GstClockTime
+run_pipeline (guint pads, guint buffers, gboolean sync_by_running_time)
+{
+  GstElement *pipeline, *mq;
+  GstMessage *msg;
+  GstBus *bus;
+  GstClockTime start, end;
+  guint i;
+
+  pipeline = gst_pipeline_new (NULL);
+  mq = gst_element_factory_make ("multiqueue", NULL);
+  g_assert (mq);
+  g_object_set (mq, "sync-by-running-time", sync_by_running_time, NULL);
+  gst_bin_add (GST_BIN (pipeline), mq);
+
+  for (i = 0; i < pads; i++) {
+    GstElement *src, *sink;
+    GstPad *sinkpad, *srcpad;
+
+    src = gst_element_factory_make ("fakesrc", NULL);
+    sink = gst_element_factory_make ("fakesink", NULL);
+    g_assert (src && sink);
+    /* timestamped buffers of 10ms, so that there are running times */
+    g_object_set (src, "num-buffers", buffers / pads, "sizemax", 64,
+        "datarate", 64 * 100, NULL);
+    gst_util_set_object_arg (G_OBJECT (src), "sizetype", "fixed");
+    gst_util_set_object_arg (G_OBJECT (src), "format", "time");
+    gst_bin_add_many (GST_BIN (pipeline), src, sink, NULL);
+
+    sinkpad = gst_element_request_pad_simple (mq, "sink_%u");
+    srcpad = gst_element_get_static_pad (src, "src");
+    if (gst_pad_link (srcpad, sinkpad) != GST_PAD_LINK_OK)
+      g_assert_not_reached ();
+    gst_object_unref (srcpad);
+
+    srcpad = gst_pad_get_single_internal_link (sinkpad);
+    gst_object_unref (sinkpad);
+    sinkpad = gst_element_get_static_pad (sink, "sink");
+    if (gst_pad_link (srcpad, sinkpad) != GST_PAD_LINK_OK)
+      g_assert_not_reached ();
+    gst_object_unref (srcpad);
+    gst_object_unref (sinkpad);
+  }
+
+  start = gst_util_get_timestamp ();
+  if (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+    g_assert_not_reached ();
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_poll (bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+  end = gst_util_get_timestamp ();
+  gst_object_unref (bus);
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR)
+    g_assert_not_reached ();
+  gst_message_unref (msg);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return end - start;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint i, buffers = BUFFER_COUNT;
+  gint sync;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    buffers = atoi (argv[1]);
+
+  for (sync = 0; sync < 2; sync++) {
+    g_print ("*** sync-by-running-time=%s, %u buffers in total\n",
+        sync ? "true" : "false", buffers);
+
+    for (i = 0; i < G_N_ELEMENTS (n_pads); i++) {
+      GstClockTime elapsed = run_pipeline (n_pads[i], buffers, sync);
+      guint pushed = (buffers / n_pads[i]) * n_pads[i];
+
+      g_print ("%4u pads: %" GST_TIME_FORMAT ", %" G_GUINT64_FORMAT
+          " ns per buffer\n", n_pads[i], GST_TIME_ARGS (elapsed),
+          pushed ? elapsed / pushed : 0);
+    }
+  }
+
+  return 0;
+}
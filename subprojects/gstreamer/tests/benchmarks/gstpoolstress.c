@@ -23,6 +23,70 @@
 #include "gst/glib-compat-private.h"
 
 #define BUFFER_SIZE (1400)
+#define MAX_THREADS (32)
+
+typedef struct
+{
+  GstBufferPool *pool;
+  guint64 nbuffers;
+} ThreadData;
+
+static gpointer
+run_thread (gpointer user_data)
+{
+  ThreadData *data = user_data;
+  GstBuffer *tmp;
+  guint64 i;
+
+  for (i = 0; i < data->nbuffers; i++) {
+    gst_buffer_pool_acquire_buffer (data->pool, &tmp, NULL);
+    gst_buffer_unref (tmp);
+  }
+  return NULL;
+}
+
+/* every thread acquires and releases @nbuffers buffers from a pool that
+ * has fewer buffers than there are threads, so that threads also wait */
+static void
+run_threads (guint64 nbuffers)
+{
+  GThread *threads[MAX_THREADS];
+  GstClockTime start, end;
+  GstClockTimeDiff dur;
+  GstBufferPool *pool;
+  GstStructure *conf, *stats;
+  ThreadData data;
+  gint n, t;
+
+  for (n = 1; n <= MAX_THREADS; n *= 2) {
+    pool = gst_buffer_pool_new ();
+    conf = gst_buffer_pool_get_config (pool);
+    gst_buffer_pool_config_set_params (conf, NULL, BUFFER_SIZE, 0,
+        MAX_THREADS / 2);
+    gst_buffer_pool_set_config (pool, conf);
+    gst_buffer_pool_set_active (pool, TRUE);
+
+    data.pool = pool;
+    data.nbuffers = MAX (nbuffers / n, 1);
+
+    start = gst_util_get_timestamp ();
+    for (t = 0; t < n; t++)
+      threads[t] = g_thread_new ("poolstress", run_thread, &data);
+    for (t = 0; t < n; t++)
+      g_thread_join (threads[t]);
+    end = gst_util_get_timestamp ();
+    dur = GST_CLOCK_DIFF (start, end);
+
+    stats = gst_buffer_pool_get_stats (pool);
+    g_print ("*** %2d threads: total %" GST_TIME_FORMAT " - average %"
+        GST_TIME_FORMAT " - %" GST_PTR_FORMAT "\n", n, GST_TIME_ARGS (dur),
+        GST_TIME_ARGS (dur / (data.nbuffers * n)), stats);
+    gst_structure_free (stats);
+
+    gst_buffer_pool_set_active (pool, FALSE);
+    gst_object_unref (pool);
+  }
+}
 
 gint
 main (gint argc, gchar * argv[])
@@ -90,5 +154,8 @@ main (gint argc, gchar * argv[])
   gst_buffer_pool_set_active (pool, FALSE);
   gst_object_unref (pool);
 
+  /* acquire and release from several threads at once */
+  run_threads (nbuffers);
+
   return 0;
 }
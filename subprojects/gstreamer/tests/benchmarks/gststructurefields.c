@@ -0,0 +1,138 @@
+/* GStreamer
+ * Copyright (C) 2022 GStreamer developers
+ *
+ * gststructurefields.c: benchmark field access on structures of some sizes
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Gets, sets and iterates the fields of structures with 4 up to 256 fields,
+ * like the ones of caps, tag lists or stats. Every size does the same number
+ * of field accesses, so the time per access shows how the lookup cost grows
+ * with the number of fields. Structures with 16 or more fields get an index
+ * for the lookups. */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+
+#define ACCESS_COUNT (4 * 1000 * 1000)
+
+static const guint n_fields[] = { 4, 8, 16, 32, 64, 128, 256 };
+
+static gboolean
+sum_field (GQuark field_id, const GValue * value, gpointer user_data)
+{
+  gint *sum = user_data;
+
+  *sum += g_value_get_int (value);
+
+  return TRUE;
+}
+
+static void
+run (guint fields, guint accesses)
+{
+  GstStructure *s, *copy;
+  GstClockTime start, end;
+  GQuark *quarks;
+  guint i, rounds;
+  gint val, sum = 0;
+
+  quarks = g_new (GQuark, fields);
+  for (i = 0; i < fields; i++) {
+    gchar *name = g_strdup_printf ("field-%u", i);
+
+    quarks[i] = g_quark_from_string (name);
+    g_free (name);
+  }
+
+  start = gst_util_get_timestamp ();
+  s = gst_structure_new_empty ("test");
+  for (i = 0; i < fields; i++)
+    gst_structure_id_set (s, quarks[i], G_TYPE_INT, i, NULL);
+  end = gst_util_get_timestamp ();
+  g_print ("%4u fields: build %" G_GUINT64_FORMAT " ns per field", fields,
+      (end - start) / fields);
+
+  /* visit the fields in a different order than they were added */
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < accesses; i++) {
+    gst_structure_id_get (s, quarks[(i * 7) % fields], G_TYPE_INT, &val,
+        NULL);
+    sum += val;
+  }
+  end = gst_util_get_timestamp ();
+  g_print (", get %" G_GUINT64_FORMAT " ns", (end - start) / accesses);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < accesses; i++)
+    gst_structure_id_set (s, quarks[(i * 7) % fields], G_TYPE_INT, i, NULL);
+  end = gst_util_get_timestamp ();
+  g_print (", set %" G_GUINT64_FORMAT " ns", (end - start) / accesses);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < accesses; i++)
+    gst_structure_has_field (s, "not-there");
+  end = gst_util_get_timestamp ();
+  g_print (", miss %" G_GUINT64_FORMAT " ns", (end - start) / accesses);
+
+  rounds = MAX (accesses / fields, 1);
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < rounds; i++)
+    gst_structure_foreach (s, sum_field, &sum);
+  end = gst_util_get_timestamp ();
+  g_print (", iterate %" G_GUINT64_FORMAT " ns", (end - start) /
+      (rounds * fields));
+
+  rounds = MAX (accesses / (fields * 16), 1);
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < rounds; i++) {
+    copy = gst_structure_copy (s);
+    if (!gst_structure_is_subset (copy, s))
+      g_assert_not_reached ();
+    gst_structure_free (copy);
+  }
+  end = gst_util_get_timestamp ();
+  g_print (", copy+subset %" G_GUINT64_FORMAT " ns per field\n",
+      (end - start) / (rounds * fields));
+
+  gst_structure_free (s);
+  g_free (quarks);
+
+  /* keep the compiler from optimizing the reads away */
+  if (sum == 42)
+    g_print (" ");
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint i, accesses = ACCESS_COUNT;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    accesses = atoi (argv[1]);
+  if (accesses == 0)
+    accesses = 1;
+
+  g_print ("*** %u accesses per size\n", accesses);
+
+  for (i = 0; i < G_N_ELEMENTS (n_fields); i++)
+    run (n_fields[i], accesses);
+
+  return 0;
+}
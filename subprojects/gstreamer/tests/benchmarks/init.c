@@ -19,13 +19,123 @@
  * Boston, MA 02110-1301, USA.
  */
 
+/* gst_init() can only be measured once per process, so the benchmark runs
+ * itself as a child process: first with a registry file that does not exist
+ * yet (cold, all plugins are scanned) and then repeatedly with the registry
+ * the first run wrote (warm). Every child reports the time gst_init() took
+ * and the time needed to look up all element factories and their details.
+ */
 
+#include <glib/gstdio.h>
 #include <gst/gst.h>
 
+#define WARM_RUNS 10
+
+static void
+run_child (gint argc, gchar * argv[])
+{
+  GstClockTime start, init, lookup;
+  GList *factories, *walk;
+
+  start = gst_util_get_timestamp ();
+  gst_init (&argc, &argv);
+  init = gst_util_get_timestamp ();
+
+  factories = gst_element_factory_list_get_elements
+      (GST_ELEMENT_FACTORY_TYPE_ANY, GST_RANK_NONE);
+  for (walk = factories; walk; walk = walk->next) {
+    GstElementFactory *factory = walk->data;
+
+    gst_element_factory_get_metadata (factory, GST_ELEMENT_METADATA_KLASS);
+    gst_element_factory_get_static_pad_templates (factory);
+  }
+  lookup = gst_util_get_timestamp ();
+
+  g_print ("%" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT " %u\n", init - start,
+      lookup - init, g_list_length (factories));
+  gst_plugin_feature_list_free (factories);
+}
+
+static gboolean
+spawn_child (const gchar * self, gchar ** envp, GstClockTime * init,
+    GstClockTime * lookup, guint * n_factories)
+{
+  gchar *argv[] = { (gchar *) self, (gchar *) "--child", NULL };
+  gchar *out = NULL, **fields;
+  GError *err = NULL;
+  gint status;
+  gboolean res;
+
+  if (!g_spawn_sync (NULL, argv, envp, G_SPAWN_SEARCH_PATH, NULL, NULL, &out,
+          NULL, &status, &err)) {
+    g_printerr ("failed to run %s: %s\n", self, err->message);
+    g_clear_error (&err);
+    return FALSE;
+  }
+
+  fields = g_strsplit (out, " ", -1);
+  res = g_strv_length (fields) == 3;
+  if (res) {
+    *init = g_ascii_strtoull (fields[0], NULL, 10);
+    *lookup = g_ascii_strtoull (fields[1], NULL, 10);
+    *n_factories = g_ascii_strtoull (fields[2], NULL, 10);
+  } else {
+    g_printerr ("unexpected output from child: %s\n", out);
+  }
+  g_strfreev (fields);
+  g_free (out);
+
+  return res;
+}
+
 gint
 main (gint argc, gchar * argv[])
 {
-  gst_init (&argc, &argv);
+  GstClockTime init, lookup, warm_init = 0, warm_lookup = 0;
+  gchar *dir, *registry, **envp;
+  guint n_factories, i;
+  gint res = 0;
+
+  if (argc > 1 && g_str_equal (argv[1], "--child")) {
+    run_child (argc, argv);
+    return 0;
+  }
+
+  dir = g_dir_make_tmp ("gst-init-XXXXXX", NULL);
+  if (dir == NULL) {
+    g_printerr ("failed to create a temporary directory\n");
+    return 1;
+  }
+  registry = g_build_filename (dir, "registry.bin", NULL);
+  envp = g_environ_setenv (g_get_environ (), "GST_REGISTRY", registry, TRUE);
+
+  if (!spawn_child (argv[0], envp, &init, &lookup, &n_factories)) {
+    res = 1;
+    goto done;
+  }
+  g_print ("cold init: %" GST_TIME_FORMAT ", lookup of %u factories: %"
+      GST_TIME_FORMAT "\n", GST_TIME_ARGS (init), n_factories,
+      GST_TIME_ARGS (lookup));
+
+  for (i = 0; i < WARM_RUNS; i++) {
+    if (!spawn_child (argv[0], envp, &init, &lookup, &n_factories)) {
+      res = 1;
+      goto done;
+    }
+    warm_init += init;
+    warm_lookup += lookup;
+  }
+  g_print ("warm init: %" GST_TIME_FORMAT ", lookup of %u factories: %"
+      GST_TIME_FORMAT " (average of %d runs)\n",
+      GST_TIME_ARGS (warm_init / WARM_RUNS), n_factories,
+      GST_TIME_ARGS (warm_lookup / WARM_RUNS), WARM_RUNS);
+
+done:
+  g_unlink (registry);
+  g_rmdir (dir);
+  g_strfreev (envp);
+  g_free (registry);
+  g_free (dir);
 
-  return 0;
+  return res;
 }
@@ -99,6 +99,9 @@ main (gint argc, gchar * argv[])
   gst_message_unref (msg);
   g_print ("%" GST_TIME_FORMAT " - putting %u buffers through\n",
       GST_TIME_ARGS (end - start), buffers);
+  /* every buffer is pushed once by the source and by every identity */
+  g_print ("%" G_GUINT64_FORMAT " ns per buffer and element\n",
+      (end - start) / MAX ((guint64) buffers * (identities + 1), 1));
 
   start = gst_util_get_timestamp ();
   if (gst_element_set_state (pipeline,
@@ -26,6 +26,10 @@
  * grep "log_gst_structure" trace.log >tracerserialize.gststructure.log
  * grep "log_g_variant" trace.log >tracerserialize.gvariant.log
  *
+ * and to compare with the binary tracer records:
+ *
+ * GST_DEBUG="GST_TRACER:7" GST_DEBUG_FILE=trace.log ./tracerserialize
+ * GST_TRACER_BINARY_FILE=trace.bin ./tracerserialize
  */
 
 #include <gst/gst.h>
@@ -81,6 +85,7 @@ gint
 main (gint argc, gchar * argv[])
 {
   GstClockTime start, end;
+  GstTracerRecord *record;
   gint i;
 
   gst_init (&argc, &argv);
@@ -107,6 +112,29 @@ main (gint argc, gchar * argv[])
   g_print ("%" GST_TIME_FORMAT ": GstStructure template\n",
       GST_TIME_ARGS (end - start));
 
+  record = gst_tracer_record_new ("name.class",
+      "ts", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64, NULL),
+      "index", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT, NULL),
+      "test", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING, NULL),
+      "bool", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_BOOLEAN, NULL),
+      "flag", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, GST_TYPE_PAD_DIRECTION, NULL), NULL);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_LOOPS; i++) {
+    gst_tracer_record_log (record, (guint64) 0, 10, "hallo", TRUE,
+        GST_PAD_SRC);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT ": GstTracerRecord%s\n",
+      GST_TIME_ARGS (end - start),
+      g_getenv ("GST_TRACER_BINARY_FILE") ? " (binary)" : "");
+  gst_object_unref (record);
+
   start = gst_util_get_timestamp ();
   for (i = 0; i < NUM_LOOPS; i++) {
     log_g_variant ("(stusbu)", "name", (guint64) 0, 10, "hallo", TRUE,
@@ -23,7 +23,16 @@
 #include "config.h"
 #endif
 
+/* for O_DIRECT */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1
+#endif
+
 #include <stdio.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 
 #include <glib.h>
 #include <glib/gstdio.h>
@@ -381,6 +390,204 @@ GST_START_TEST (test_flush)
 
 GST_END_TEST;
 
+/* whether direct I/O can be used for @filename, tmpfs can't do it */
+static gboolean
+supports_direct_io (const gchar * filename)
+{
+#if defined (O_DIRECT) && defined (HAVE_UNISTD_H)
+  gint fd = g_open (filename, O_WRONLY | O_DIRECT, 0);
+
+  if (fd < 0)
+    return FALSE;
+  close (fd);
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
+GST_START_TEST (test_write_behind)
+{
+  GstElement *filesink;
+  GstStructure *stats;
+  GstSegment segment;
+  GByteArray *expected;
+  guint64 bytes_written, direct_bytes_written, queued_bytes;
+  gboolean direct;
+  gchar *tmp_fn, *data;
+  GRand *rand;
+  gsize len;
+  guint i, j;
+
+  tmp_fn = create_temporary_file ();
+  if (tmp_fn == NULL)
+    return;
+  direct = supports_direct_io (tmp_fn);
+  GST_INFO ("direct I/O is %ssupported for %s", direct ? "" : "not ", tmp_fn);
+  filesink = setup_filesink ();
+
+  /* less write-behind than what is pushed, so that the streaming thread has
+   * to wait for the writer */
+  g_object_set (filesink, "location", tmp_fn, "max-write-behind",
+      (guint64) 32768, "buffer-size", 8192, "direct-io", TRUE, NULL);
+
+  fail_unless_equals_int (gst_element_set_state (filesink, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_stream_start ("test")));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+
+  expected = g_byte_array_new ();
+  rand = g_rand_new_with_seed (42);
+  for (i = 0; i < 200; i++) {
+    guint size = g_rand_int_range (rand, 1, 6000);
+    GstBuffer *buf = gst_buffer_new_and_alloc (size);
+    GstMapInfo info;
+
+    fail_unless (gst_buffer_map (buf, &info, GST_MAP_WRITE));
+    for (j = 0; j < size; j++)
+      info.data[j] = g_rand_int (rand);
+    g_byte_array_append (expected, info.data, size);
+    gst_buffer_unmap (buf, &info);
+
+    fail_unless_equals_int (gst_pad_push (mysrcpad, buf), GST_FLOW_OK);
+  }
+  g_rand_free (rand);
+
+  /* the position includes what is still queued */
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, expected->len);
+
+  /* rewrite a header, like muxers do at the end */
+  segment.start = 5;
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 5);
+  fail_unless_equals_int (gst_pad_push (mysrcpad,
+          gst_buffer_new_wrapped (g_strdup ("header"), 6)), GST_FLOW_OK);
+  memcpy (expected->data + 5, "header", 6);
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  g_object_get (filesink, "stats", &stats, NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "bytes-written",
+          &bytes_written));
+  fail_unless (gst_structure_get_uint64 (stats, "direct-bytes-written",
+          &direct_bytes_written));
+  fail_unless (gst_structure_get_uint64 (stats, "queued-bytes",
+          &queued_bytes));
+  fail_unless_equals_uint64 (bytes_written, expected->len + 6);
+  fail_unless_equals_uint64 (queued_bytes, 0);
+  /* direct writes are whole blocks, the rest is written normally */
+  if (direct) {
+    fail_unless (direct_bytes_written > 0);
+    fail_unless (direct_bytes_written < bytes_written);
+    fail_unless_equals_uint64 (direct_bytes_written % 4096, 0);
+  } else {
+    fail_unless_equals_uint64 (direct_bytes_written, 0);
+  }
+  gst_structure_free (stats);
+
+  fail_unless_equals_int (gst_element_set_state (filesink, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+  cleanup_filesink (filesink);
+
+  fail_unless (g_file_get_contents (tmp_fn, &data, &len, NULL));
+  fail_unless_equals_int (len, expected->len);
+  fail_unless (memcmp (data, expected->data, len) == 0);
+  g_free (data);
+
+  g_byte_array_unref (expected);
+  g_remove (tmp_fn);
+  g_free (tmp_fn);
+}
+
+GST_END_TEST;
+
+static GstBuffer *
+write_behind_buffer (guint size, guint8 value)
+{
+  GstBuffer *buf = gst_buffer_new_and_alloc (size);
+
+  gst_buffer_memset (buf, 0, value, size);
+  return buf;
+}
+
+/* a flush while the writer thread is writing must not break the accounting
+ * of queued bytes, otherwise the next push waits forever */
+GST_START_TEST (test_write_behind_flush)
+{
+  GstElement *filesink;
+  GstStructure *stats;
+  GstSegment segment;
+  guint64 queued_bytes;
+  gchar *tmp_fn, *data;
+  gsize len;
+  guint i;
+
+  tmp_fn = create_temporary_file ();
+  if (tmp_fn == NULL)
+    return;
+  filesink = setup_filesink ();
+
+  g_object_set (filesink, "location", tmp_fn, "max-write-behind",
+      (guint64) 262144, "buffer-size", 131072, NULL);
+
+  fail_unless_equals_int (gst_element_set_state (filesink, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_stream_start ("test")));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+
+  /* keep the writer busy so that the flush finds a write in flight */
+  for (i = 0; i < 32; i++)
+    fail_unless_equals_int (gst_pad_push (mysrcpad,
+            write_behind_buffer (65536, 'a')), GST_FLOW_OK);
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_flush_start ()));
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_flush_stop (TRUE)));
+
+  g_object_get (filesink, "stats", &stats, NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "queued-bytes",
+          &queued_bytes));
+  fail_unless_equals_uint64 (queued_bytes, 0);
+  gst_structure_free (stats);
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+  fail_unless_equals_int (gst_element_set_state (filesink, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  /* more than max-write-behind, so this has to wait for the writer */
+  for (i = 0; i < 32; i++)
+    fail_unless_equals_int (gst_pad_push (mysrcpad,
+            write_behind_buffer (65536, 'b')), GST_FLOW_OK);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  g_object_get (filesink, "stats", &stats, NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "queued-bytes",
+          &queued_bytes));
+  fail_unless_equals_uint64 (queued_bytes, 0);
+  gst_structure_free (stats);
+
+  fail_unless_equals_int (gst_element_set_state (filesink, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+  cleanup_filesink (filesink);
+
+  /* only what was pushed after the flush is in the file */
+  fail_unless (g_file_get_contents (tmp_fn, &data, &len, NULL));
+  fail_unless_equals_int (len, 32 * 65536);
+  for (i = 0; i < len; i++)
+    fail_unless (data[i] == 'b');
+  g_free (data);
+
+  g_remove (tmp_fn);
+  g_free (tmp_fn);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_coverage)
 {
   GstElement *filesink;
@@ -496,6 +703,8 @@ filesink_suite (void)
   tcase_add_test (tc_chain, test_uri_interface);
   tcase_add_test (tc_chain, test_seeking);
   tcase_add_test (tc_chain, test_flush);
+  tcase_add_test (tc_chain, test_write_behind);
+  tcase_add_test (tc_chain, test_write_behind_flush);
 
   return s;
 }
@@ -21,6 +21,7 @@
 #include "config.h"
 #endif
 
+#include <glib/gstdio.h>
 #include <gst/check/gstcheck.h>
 
 static gboolean have_eos = FALSE;
@@ -303,6 +304,145 @@ GST_START_TEST (test_pull)
 
 GST_END_TEST;
 
+#define PREFETCH_FILE_SIZE 300001
+
+static gchar *
+create_prefetch_file (guint8 ** contents)
+{
+  gchar *filename;
+  guint i;
+  gint fd;
+
+  fd = g_file_open_tmp ("filesrc-XXXXXX", &filename, NULL);
+  fail_unless (fd >= 0);
+  g_close (fd, NULL);
+
+  *contents = g_malloc (PREFETCH_FILE_SIZE);
+  for (i = 0; i < PREFETCH_FILE_SIZE; i++)
+    (*contents)[i] = g_random_int ();
+  fail_unless (g_file_set_contents (filename, (gchar *) * contents,
+          PREFETCH_FILE_SIZE, NULL));
+
+  return filename;
+}
+
+static void
+check_range (GstPad * pad, const guint8 * contents, guint64 offset,
+    guint length)
+{
+  GstBuffer *buffer = NULL;
+  GstFlowReturn ret;
+  guint expected;
+
+  expected = MIN (length, PREFETCH_FILE_SIZE - offset);
+  ret = gst_pad_get_range (pad, offset, length, &buffer);
+  fail_unless_equals_int (ret, GST_FLOW_OK);
+  fail_unless_equals_int (gst_buffer_get_size (buffer), expected);
+  fail_unless (gst_buffer_memcmp (buffer, 0, contents + offset,
+          expected) == 0);
+  gst_buffer_unref (buffer);
+}
+
+GST_START_TEST (test_pull_prefetch)
+{
+  const struct
+  {
+    guint prefetch;
+    gboolean direct_io;
+  } configs[] = { {
+  3, FALSE}, {
+  0, TRUE}, {
+  3, TRUE}};
+  GstElement *src;
+  GstBuffer *buffer;
+  guint8 *contents;
+  gchar *filename;
+  guint64 offset;
+  GstPad *pad;
+  guint i, j;
+
+  filename = create_prefetch_file (&contents);
+
+  for (i = 0; i < G_N_ELEMENTS (configs); i++) {
+    src = setup_filesrc ();
+    g_object_set (src, "location", filename, "prefetch", configs[i].prefetch,
+        "prefetch-size", 16384, "direct-io", configs[i].direct_io, NULL);
+    fail_unless (gst_element_set_state (src,
+            GST_STATE_READY) == GST_STATE_CHANGE_SUCCESS);
+
+    pad = gst_element_get_static_pad (src, "src");
+    fail_unless (gst_pad_activate_mode (pad, GST_PAD_MODE_PULL, TRUE));
+    fail_unless (gst_element_set_state (src,
+            GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+
+    /* sequential, reads ahead and crosses blocks */
+    for (offset = 0; offset < PREFETCH_FILE_SIZE; offset += 3000)
+      check_range (pad, contents, offset, 3000);
+
+    /* random, partly from blocks that were read ahead */
+    for (j = 0; j < 200; j++) {
+      offset = g_random_int_range (0, PREFETCH_FILE_SIZE);
+      check_range (pad, contents, offset, g_random_int_range (1, 70000));
+    }
+
+    /* one read that is larger than all blocks together */
+    check_range (pad, contents, 100, PREFETCH_FILE_SIZE);
+
+    buffer = NULL;
+    fail_unless_equals_int (gst_pad_get_range (pad, PREFETCH_FILE_SIZE, 10,
+            &buffer), GST_FLOW_EOS);
+
+    fail_unless (gst_element_set_state (src,
+            GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+    gst_object_unref (pad);
+    cleanup_filesrc (src);
+  }
+
+  g_unlink (filename);
+  g_free (filename);
+  g_free (contents);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_push_prefetch)
+{
+  GstElement *src;
+  guint8 *contents;
+  gchar *filename;
+  guint64 offset = 0;
+  GList *l;
+
+  filename = create_prefetch_file (&contents);
+
+  src = setup_filesrc ();
+  g_object_set (src, "location", filename, "prefetch", 2, "prefetch-size",
+      8192, "blocksize", 3000, NULL);
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+  wait_eos ();
+
+  for (l = buffers; l; l = l->next) {
+    GstBuffer *buffer = l->data;
+    gsize size = gst_buffer_get_size (buffer);
+
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buffer), offset);
+    fail_unless (gst_buffer_memcmp (buffer, 0, contents + offset, size) == 0);
+    offset += size;
+  }
+  fail_unless_equals_uint64 (offset, PREFETCH_FILE_SIZE);
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+  cleanup_filesrc (src);
+
+  g_unlink (filename);
+  g_free (filename);
+  g_free (contents);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_coverage)
 {
   GstElement *src;
@@ -554,6 +694,8 @@ filesrc_suite (void)
   tcase_add_test (tc_chain, test_seeking);
   tcase_add_test (tc_chain, test_reverse);
   tcase_add_test (tc_chain, test_pull);
+  tcase_add_test (tc_chain, test_pull_prefetch);
+  tcase_add_test (tc_chain, test_push_prefetch);
   tcase_add_test (tc_chain, test_coverage);
   tcase_add_test (tc_chain, test_uri_interface);
   tcase_add_test (tc_chain, test_uri_query);
@@ -1181,6 +1181,338 @@ GST_START_TEST (test_initial_events_nodelay)
 
 GST_END_TEST;
 
+/* push more buffers than fit in a lockless queue and check that they all come
+ * out in order, followed by the EOS event, with an empty queue in the end */
+GST_START_TEST (test_lockless)
+{
+  GstSegment segment;
+  GstBuffer *buffer;
+  GstEvent *event;
+  guint64 level_time;
+  guint level_buffers;
+  gint i;
+
+  g_object_set (G_OBJECT (queue), "lockless", TRUE, "max-size-buffers", 2,
+      NULL);
+  mysinkpad = gst_check_setup_sink_pad (queue, &sinktemplate);
+  gst_pad_set_event_function (mysinkpad, event_func);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+
+  for (i = 0; i < 20; i++) {
+    buffer = gst_buffer_new_and_alloc (4);
+    GST_BUFFER_PTS (buffer) = i * 10 * GST_MSECOND;
+    GST_BUFFER_DURATION (buffer) = 10 * GST_MSECOND;
+    fail_unless_equals_int (gst_pad_push (mysrcpad, buffer), GST_FLOW_OK);
+  }
+  gst_pad_push_event (mysrcpad, gst_event_new_eos ());
+
+  g_mutex_lock (&events_lock);
+  while (events_count < 3) {
+    g_cond_wait (&events_cond, &events_lock);
+  }
+  g_mutex_unlock (&events_lock);
+
+  event = g_list_nth_data (events, 2);
+  fail_unless_equals_int (GST_EVENT_TYPE (event), GST_EVENT_EOS);
+
+  fail_unless_equals_int (g_list_length (buffers), 20);
+  for (i = 0; i < 20; i++) {
+    buffer = g_list_nth_data (buffers, i);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), i * 10 * GST_MSECOND);
+  }
+
+  g_object_get (G_OBJECT (queue), "current-level-buffers", &level_buffers,
+      "current-level-time", &level_time, NULL);
+  fail_unless_equals_int (level_buffers, 0);
+  fail_unless_equals_uint64 (level_time, 0);
+
+  gst_element_set_state (queue, GST_STATE_NULL);
+}
+
+GST_END_TEST;
+
+static void
+wait_for_eos (void)
+{
+  g_mutex_lock (&events_lock);
+  while (events == NULL
+      || GST_EVENT_TYPE (g_list_last (events)->data) != GST_EVENT_EOS) {
+    g_cond_wait (&events_cond, &events_lock);
+  }
+  g_mutex_unlock (&events_lock);
+}
+
+static void
+setup_lockless_queue (void)
+{
+  GstSegment segment;
+
+  mysinkpad = gst_check_setup_sink_pad (queue, &sinktemplate);
+  gst_pad_set_event_function (mysinkpad, event_func);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+}
+
+/* flushing drops the queued buffers and resets the level */
+GST_START_TEST (test_lockless_flush)
+{
+  GstSegment segment;
+  GstBuffer *buffer;
+  guint level_buffers, level_bytes;
+  gint i;
+
+  g_object_set (G_OBJECT (queue), "lockless", TRUE, NULL);
+  /* the srcpad task blocks on the stream-start event */
+  block_src ();
+  setup_lockless_queue ();
+
+  for (i = 0; i < 3; i++) {
+    fail_unless_equals_int (gst_pad_push (mysrcpad,
+            gst_buffer_new_and_alloc (4)), GST_FLOW_OK);
+  }
+  g_object_get (G_OBJECT (queue), "current-level-buffers", &level_buffers,
+      "current-level-bytes", &level_bytes, NULL);
+  fail_unless_equals_int (level_buffers, 3);
+  fail_unless_equals_int (level_bytes, 12);
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_flush_start ()));
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_flush_stop (TRUE)));
+
+  g_object_get (G_OBJECT (queue), "current-level-buffers", &level_buffers,
+      "current-level-bytes", &level_bytes, NULL);
+  fail_unless_equals_int (level_buffers, 0);
+  fail_unless_equals_int (level_bytes, 0);
+
+  unblock_src ();
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+  buffer = gst_buffer_new_and_alloc (4);
+  fail_unless_equals_int (gst_pad_push (mysrcpad, gst_buffer_ref (buffer)),
+      GST_FLOW_OK);
+  gst_pad_push_event (mysrcpad, gst_event_new_eos ());
+
+  wait_for_eos ();
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  fail_unless (g_list_nth_data (buffers, 0) == buffer);
+  gst_buffer_unref (buffer);
+
+  gst_element_set_state (queue, GST_STATE_NULL);
+}
+
+GST_END_TEST;
+
+static gint query_buffers;
+
+static gboolean
+drain_query_func (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) != GST_QUERY_DRAIN)
+    return gst_pad_query_default (pad, parent, query);
+
+  g_mutex_lock (&check_mutex);
+  query_buffers = g_list_length (buffers);
+  g_mutex_unlock (&check_mutex);
+
+  return TRUE;
+}
+
+/* serialized queries are answered after the data in front of them was pushed,
+ * even when the min threshold is not reached */
+GST_START_TEST (test_lockless_serialized_query)
+{
+  GstQuery *query;
+  gint i;
+
+  g_object_set (G_OBJECT (queue), "lockless", TRUE, "min-threshold-buffers",
+      10, NULL);
+  query_buffers = -1;
+  setup_lockless_queue ();
+  gst_pad_set_query_function (mysinkpad, drain_query_func);
+
+  for (i = 0; i < 3; i++) {
+    fail_unless_equals_int (gst_pad_push (mysrcpad,
+            gst_buffer_new_and_alloc (4)), GST_FLOW_OK);
+  }
+
+  query = gst_query_new_drain ();
+  fail_unless (gst_pad_peer_query (mysrcpad, query));
+  gst_query_unref (query);
+
+  fail_unless_equals_int (query_buffers, 3);
+
+  gst_element_set_state (queue, GST_STATE_NULL);
+}
+
+GST_END_TEST;
+
+/* a lockless leaky upstream queue drops the new buffers when it is full */
+GST_START_TEST (test_lockless_leaky_upstream)
+{
+  GstBuffer *buffer[4];
+  guint level_buffers;
+  gint i;
+
+  g_signal_connect (queue, "overrun", G_CALLBACK (queue_overrun), NULL);
+  g_object_set (G_OBJECT (queue), "lockless", TRUE, "max-size-buffers", 2,
+      "leaky", 1, NULL);
+  block_src ();
+  setup_lockless_queue ();
+
+  for (i = 0; i < 4; i++) {
+    buffer[i] = gst_buffer_new_and_alloc (4);
+    fail_unless_equals_int (gst_pad_push (mysrcpad,
+            gst_buffer_ref (buffer[i])), GST_FLOW_OK);
+  }
+  fail_unless_equals_int (overrun_count, 2);
+  g_object_get (G_OBJECT (queue), "current-level-buffers", &level_buffers,
+      NULL);
+  fail_unless_equals_int (level_buffers, 2);
+
+  /* the leaked buffers are gone */
+  ASSERT_BUFFER_REFCOUNT (buffer[2], "buffer", 1);
+  ASSERT_BUFFER_REFCOUNT (buffer[3], "buffer", 1);
+
+  unblock_src ();
+  gst_pad_push_event (mysrcpad, gst_event_new_eos ());
+  wait_for_eos ();
+
+  fail_unless_equals_int (g_list_length (buffers), 2);
+  fail_unless (g_list_nth_data (buffers, 0) == buffer[0]);
+  fail_unless (g_list_nth_data (buffers, 1) == buffer[1]);
+
+  for (i = 0; i < 4; i++)
+    gst_buffer_unref (buffer[i]);
+
+  gst_element_set_state (queue, GST_STATE_NULL);
+}
+
+GST_END_TEST;
+
+/* the lockless mode is not used for leaky downstream queues, they have to
+ * keep dropping the oldest buffers */
+GST_START_TEST (test_lockless_leaky_downstream)
+{
+  GstBuffer *buffer[4];
+  gint i;
+
+  g_object_set (G_OBJECT (queue), "lockless", TRUE, "max-size-buffers", 2,
+      "leaky", 2, NULL);
+  block_src ();
+  setup_lockless_queue ();
+
+  for (i = 0; i < 4; i++) {
+    buffer[i] = gst_buffer_new_and_alloc (4);
+    fail_unless_equals_int (gst_pad_push (mysrcpad,
+            gst_buffer_ref (buffer[i])), GST_FLOW_OK);
+  }
+  ASSERT_BUFFER_REFCOUNT (buffer[0], "buffer", 1);
+  ASSERT_BUFFER_REFCOUNT (buffer[1], "buffer", 1);
+
+  unblock_src ();
+  gst_pad_push_event (mysrcpad, gst_event_new_eos ());
+  wait_for_eos ();
+
+  fail_unless_equals_int (g_list_length (buffers), 2);
+  fail_unless (g_list_nth_data (buffers, 0) == buffer[2]);
+  fail_unless (g_list_nth_data (buffers, 1) == buffer[3]);
+
+  for (i = 0; i < 4; i++)
+    gst_buffer_unref (buffer[i]);
+
+  gst_element_set_state (queue, GST_STATE_NULL);
+}
+
+GST_END_TEST;
+
+/* nothing is pushed before the min threshold is reached, EOS clears it so the
+ * remaining buffers are drained */
+GST_START_TEST (test_lockless_min_threshold_eos)
+{
+  guint level_buffers;
+  gint i;
+
+  g_object_set (G_OBJECT (queue), "lockless", TRUE, "min-threshold-buffers",
+      5, NULL);
+  setup_lockless_queue ();
+
+  for (i = 0; i < 3; i++) {
+    fail_unless_equals_int (gst_pad_push (mysrcpad,
+            gst_buffer_new_and_alloc (4)), GST_FLOW_OK);
+  }
+
+  /* give the srcpad task a chance to push something it should not */
+  g_usleep (G_USEC_PER_SEC / 20);
+  g_mutex_lock (&check_mutex);
+  fail_unless_equals_int (g_list_length (buffers), 0);
+  g_mutex_unlock (&check_mutex);
+  g_object_get (G_OBJECT (queue), "current-level-buffers", &level_buffers,
+      NULL);
+  fail_unless_equals_int (level_buffers, 3);
+
+  gst_pad_push_event (mysrcpad, gst_event_new_eos ());
+  wait_for_eos ();
+
+  fail_unless_equals_int (g_list_length (buffers), 3);
+  g_object_get (G_OBJECT (queue), "current-level-buffers", &level_buffers,
+      NULL);
+  fail_unless_equals_int (level_buffers, 0);
+
+  /* no data is accepted after EOS */
+  fail_unless_equals_int (gst_pad_push (mysrcpad,
+          gst_buffer_new_and_alloc (4)), GST_FLOW_EOS);
+
+  gst_element_set_state (queue, GST_STATE_NULL);
+}
+
+GST_END_TEST;
+
+/* with flush-on-eos, the buffers in front of EOS are dropped by the srcpad
+ * task */
+GST_START_TEST (test_lockless_flush_on_eos)
+{
+  guint level_buffers;
+  gint i;
+
+  g_object_set (G_OBJECT (queue), "lockless", TRUE, "flush-on-eos", TRUE,
+      NULL);
+  block_src ();
+  setup_lockless_queue ();
+
+  for (i = 0; i < 3; i++) {
+    fail_unless_equals_int (gst_pad_push (mysrcpad,
+            gst_buffer_new_and_alloc (4)), GST_FLOW_OK);
+  }
+  gst_pad_push_event (mysrcpad, gst_event_new_eos ());
+
+  unblock_src ();
+  wait_for_eos ();
+
+  fail_unless_equals_int (g_list_length (buffers), 0);
+  g_object_get (G_OBJECT (queue), "current-level-buffers", &level_buffers,
+      NULL);
+  fail_unless_equals_int (level_buffers, 0);
+
+  gst_element_set_state (queue, GST_STATE_NULL);
+}
+
+GST_END_TEST;
+
 static Suite *
 queue_suite (void)
 {
@@ -1204,6 +1536,13 @@ queue_suite (void)
   tcase_add_test (tc_chain, test_sticky_not_linked);
   tcase_add_test (tc_chain, test_time_level_buffer_list);
   tcase_add_test (tc_chain, test_initial_events_nodelay);
+  tcase_add_test (tc_chain, test_lockless);
+  tcase_add_test (tc_chain, test_lockless_flush);
+  tcase_add_test (tc_chain, test_lockless_serialized_query);
+  tcase_add_test (tc_chain, test_lockless_leaky_upstream);
+  tcase_add_test (tc_chain, test_lockless_leaky_downstream);
+  tcase_add_test (tc_chain, test_lockless_min_threshold_eos);
+  tcase_add_test (tc_chain, test_lockless_flush_on_eos);
 
   return s;
 }
@@ -21,6 +21,7 @@
 #include "config.h"
 #endif
 
+#include <glib/gstdio.h>
 #include <gst/check/gstcheck.h>
 
 static GstElement *
@@ -449,6 +450,200 @@ GST_START_TEST (test_filled_read)
 GST_END_TEST;
 
 
+static GstBuffer *
+new_filled_buffer (gsize size, guint8 value)
+{
+  GstBuffer *buffer;
+
+  buffer = gst_buffer_new_and_alloc (size);
+  gst_buffer_memset (buffer, 0, value, size);
+
+  return buffer;
+}
+
+static gboolean
+buffer_is_filled (GstBuffer * buffer, guint8 value)
+{
+  GstMapInfo info;
+  gboolean res = TRUE;
+  gsize i;
+
+  fail_unless (gst_buffer_map (buffer, &info, GST_MAP_READ));
+  for (i = 0; i < info.size && res; i++)
+    res = info.data[i] == value;
+  gst_buffer_unmap (buffer, &info);
+
+  return res;
+}
+
+GST_START_TEST (test_mmap_read)
+{
+  GstElement *queue2;
+  GstBuffer *first, *second;
+  GstMemory *mem;
+  GstPad *sinkpad, *srcpad;
+  GstSegment segment;
+
+  queue2 = gst_element_factory_make ("queue2", NULL);
+  sinkpad = gst_element_get_static_pad (queue2, "sink");
+  srcpad = gst_element_get_static_pad (queue2, "src");
+
+  g_object_set (queue2, "ring-buffer-max-size", (guint64) 4 * 1024,
+      "use-mmap", TRUE, "use-buffering", FALSE,
+      "max-size-buffers", (guint) 0, "max-size-time", (guint64) 0,
+      "max-size-bytes", (guint) 4 * 1024, NULL);
+
+  gst_pad_activate_mode (srcpad, GST_PAD_MODE_PULL, TRUE);
+  gst_element_set_state (queue2, GST_STATE_PLAYING);
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_send_event (sinkpad, gst_event_new_stream_start ("test"));
+  gst_pad_send_event (sinkpad, gst_event_new_segment (&segment));
+
+  fail_unless (gst_pad_chain (sinkpad,
+          new_filled_buffer (2 * 1024, 0xaa)) == GST_FLOW_OK);
+
+  /* the buffers reference the ring buffer */
+  first = NULL;
+  fail_unless (gst_pad_get_range (srcpad, 0, 1024, &first) == GST_FLOW_OK);
+  fail_unless_equals_int (gst_buffer_get_size (first), 1024);
+  mem = gst_buffer_peek_memory (first, 0);
+  fail_unless (gst_memory_is_type (mem, "Queue2Memory"));
+  fail_unless (GST_MEMORY_IS_READONLY (mem));
+  fail_unless (buffer_is_filled (first, 0xaa));
+
+  second = NULL;
+  fail_unless (gst_pad_get_range (srcpad, 1024, 1024,
+          &second) == GST_FLOW_OK);
+  gst_buffer_unref (second);
+
+  /* wraps around and overwrites the data of the first buffer, which must
+   * keep its content */
+  fail_unless (gst_pad_chain (sinkpad,
+          new_filled_buffer (3 * 1024, 0xbb)) == GST_FLOW_OK);
+  fail_unless (buffer_is_filled (first, 0xaa));
+
+  second = NULL;
+  fail_unless (gst_pad_get_range (srcpad, 2 * 1024, 3 * 1024,
+          &second) == GST_FLOW_OK);
+  fail_unless_equals_int (gst_buffer_get_size (second), 3 * 1024);
+  fail_unless_equals_int (gst_buffer_n_memory (second), 2);
+  fail_unless (buffer_is_filled (second, 0xbb));
+
+  gst_buffer_unref (first);
+  gst_buffer_unref (second);
+
+  gst_element_set_state (queue2, GST_STATE_NULL);
+
+  gst_object_unref (sinkpad);
+  gst_object_unref (srcpad);
+  gst_object_unref (queue2);
+}
+
+GST_END_TEST;
+
+/* a reader keeping a pulled buffer mapped, like typefind does with its
+ * cache, must not block the writer */
+static void
+check_read_while_mapped (const gchar * temp_template)
+{
+  GstElement *queue2;
+  GstBuffer *first, *second, *third;
+  GstMapInfo info;
+  GstPad *sinkpad, *srcpad;
+  GstSegment segment;
+  gchar *location = NULL;
+  GStatBuf st;
+  gsize i;
+
+  queue2 = gst_element_factory_make ("queue2", NULL);
+  sinkpad = gst_element_get_static_pad (queue2, "sink");
+  srcpad = gst_element_get_static_pad (queue2, "src");
+
+  g_object_set (queue2, "ring-buffer-max-size", (guint64) 4 * 1024,
+      "use-mmap", TRUE, "use-buffering", FALSE,
+      "max-size-buffers", (guint) 0, "max-size-time", (guint64) 0,
+      "max-size-bytes", (guint) 4 * 1024, "temp-template", temp_template,
+      NULL);
+
+  gst_pad_activate_mode (srcpad, GST_PAD_MODE_PULL, TRUE);
+  gst_element_set_state (queue2, GST_STATE_PLAYING);
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_send_event (sinkpad, gst_event_new_stream_start ("test"));
+  gst_pad_send_event (sinkpad, gst_event_new_segment (&segment));
+
+  fail_unless (gst_pad_chain (sinkpad,
+          new_filled_buffer (2 * 1024, 0xaa)) == GST_FLOW_OK);
+
+  first = NULL;
+  fail_unless (gst_pad_get_range (srcpad, 0, 1024, &first) == GST_FLOW_OK);
+  fail_unless (gst_buffer_map (first, &info, GST_MAP_READ));
+
+  second = NULL;
+  fail_unless (gst_pad_get_range (srcpad, 1024, 1024,
+          &second) == GST_FLOW_OK);
+  gst_buffer_unref (second);
+
+  /* overwrites the mapped data of the first buffer, the queue moves on to a
+   * new ring instead of waiting for the unmap */
+  fail_unless (gst_pad_chain (sinkpad,
+          new_filled_buffer (3 * 1024, 0xbb)) == GST_FLOW_OK);
+
+  second = NULL;
+  fail_unless (gst_pad_get_range (srcpad, 2 * 1024, 3 * 1024,
+          &second) == GST_FLOW_OK);
+  fail_unless (buffer_is_filled (second, 0xbb));
+
+  /* a ring in the temp file stays in it, after the old ring */
+  if (temp_template) {
+    g_object_get (queue2, "temp-location", &location, NULL);
+    fail_unless (location != NULL);
+    fail_unless (g_stat (location, &st) == 0);
+    fail_unless (st.st_size > 4 * 1024);
+  }
+
+  /* and wraps around the new ring, copying out the unmapped second buffer */
+  fail_unless (gst_pad_chain (sinkpad,
+          new_filled_buffer (3 * 1024, 0xcc)) == GST_FLOW_OK);
+
+  third = NULL;
+  fail_unless (gst_pad_get_range (srcpad, 5 * 1024, 3 * 1024,
+          &third) == GST_FLOW_OK);
+  fail_unless (buffer_is_filled (third, 0xcc));
+  fail_unless (buffer_is_filled (second, 0xbb));
+
+  /* the mapping stayed valid all the time */
+  for (i = 0; i < info.size; i++)
+    fail_unless_equals_int (info.data[i], 0xaa);
+  gst_buffer_unmap (first, &info);
+  fail_unless (buffer_is_filled (first, 0xaa));
+
+  gst_buffer_unref (first);
+  gst_buffer_unref (second);
+  gst_buffer_unref (third);
+
+  gst_element_set_state (queue2, GST_STATE_NULL);
+
+  g_free (location);
+  gst_object_unref (sinkpad);
+  gst_object_unref (srcpad);
+  gst_object_unref (queue2);
+}
+
+GST_START_TEST (test_mmap_read_while_mapped)
+{
+  gchar *tmpl;
+
+  check_read_while_mapped (NULL);
+
+  tmpl = g_build_filename (g_get_tmp_dir (), "queue2-test-XXXXXX", NULL);
+  check_read_while_mapped (tmpl);
+  g_free (tmpl);
+}
+
+GST_END_TEST;
+
 static GstPadProbeReturn
 block_callback (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
 {
@@ -729,6 +924,8 @@ queue2_suite (void)
   tcase_add_test (tc_chain, test_simple_shutdown_while_running_ringbuffer);
   tcase_add_test (tc_chain, test_watermark_and_fill_level);
   tcase_add_test (tc_chain, test_filled_read);
+  tcase_add_test (tc_chain, test_mmap_read);
+  tcase_add_test (tc_chain, test_mmap_read_while_mapped);
   tcase_add_test (tc_chain, test_percent_overflow);
   tcase_add_test (tc_chain, test_small_ring_buffer);
   tcase_add_test (tc_chain, test_bitrate_query);
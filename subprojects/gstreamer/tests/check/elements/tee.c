@@ -465,6 +465,8 @@ GST_START_TEST (test_flow_aggregation)
 
   tee = gst_element_factory_make ("tee", NULL);
   fail_unless (tee != NULL);
+  /* run once sequentially and once with parallel pushing */
+  g_object_set (tee, "parallel", __i__ == 1, NULL);
   teesink = gst_element_get_static_pad (tee, "sink");
   fail_unless (teesink != NULL);
   teesrc1 = gst_element_request_pad_simple (tee, "src_%u");
@@ -595,6 +597,113 @@ GST_START_TEST (test_flow_aggregation)
 
 GST_END_TEST;
 
+static GMutex rendezvous_lock;
+static GCond rendezvous_cond;
+static guint rendezvous_count;
+
+/* Only returns OK when both sinks are inside their chain function at the same
+ * time, which requires tee to push to them concurrently */
+static GstFlowReturn
+_rendezvous_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  gint64 end_time;
+
+  gst_buffer_unref (buffer);
+
+  end_time = g_get_monotonic_time () + 5 * G_TIME_SPAN_SECOND;
+
+  g_mutex_lock (&rendezvous_lock);
+  rendezvous_count++;
+  g_cond_broadcast (&rendezvous_cond);
+  while (rendezvous_count % 2 != 0) {
+    if (!g_cond_wait_until (&rendezvous_cond, &rendezvous_lock, end_time)) {
+      ret = GST_FLOW_ERROR;
+      break;
+    }
+  }
+  g_mutex_unlock (&rendezvous_lock);
+
+  return ret;
+}
+
+GST_START_TEST (test_parallel_push)
+{
+  GstPad *mysrc, *mysink1, *mysink2;
+  GstPad *teesink, *teesrc1, *teesrc2;
+  GstElement *tee;
+  GstSegment segment;
+  GstCaps *caps;
+  gboolean parallel;
+  gint i;
+
+  g_mutex_init (&rendezvous_lock);
+  g_cond_init (&rendezvous_cond);
+  rendezvous_count = 0;
+
+  caps = gst_caps_new_empty_simple ("test/test");
+
+  tee = gst_element_factory_make ("tee", NULL);
+  fail_unless (tee != NULL);
+  g_object_set (tee, "parallel", TRUE, NULL);
+  g_object_get (tee, "parallel", &parallel, NULL);
+  fail_unless (parallel);
+  teesink = gst_element_get_static_pad (tee, "sink");
+  teesrc1 = gst_element_request_pad_simple (tee, "src_%u");
+  teesrc2 = gst_element_request_pad_simple (tee, "src_%u");
+
+  mysink1 = gst_pad_new ("mysink1", GST_PAD_SINK);
+  gst_pad_set_chain_function (mysink1, _rendezvous_chain);
+  gst_pad_set_active (mysink1, TRUE);
+
+  mysink2 = gst_pad_new ("mysink2", GST_PAD_SINK);
+  gst_pad_set_chain_function (mysink2, _rendezvous_chain);
+  gst_pad_set_active (mysink2, TRUE);
+
+  mysrc = gst_pad_new ("mysrc", GST_PAD_SRC);
+  gst_pad_set_active (mysrc, TRUE);
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (mysrc, gst_event_new_stream_start ("test"));
+  gst_pad_set_caps (mysrc, caps);
+  gst_pad_push_event (mysrc, gst_event_new_segment (&segment));
+
+  fail_unless (gst_pad_link (mysrc, teesink) == GST_PAD_LINK_OK);
+  fail_unless (gst_pad_link (teesrc1, mysink1) == GST_PAD_LINK_OK);
+  fail_unless (gst_pad_link (teesrc2, mysink2) == GST_PAD_LINK_OK);
+
+  fail_unless (gst_element_set_state (tee,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+
+  for (i = 0; i < 10; i++)
+    fail_unless (gst_pad_push (mysrc, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless_equals_int (rendezvous_count, 20);
+
+  fail_unless (gst_element_set_state (tee,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+
+  fail_unless (gst_pad_unlink (mysrc, teesink) == TRUE);
+  fail_unless (gst_pad_unlink (teesrc1, mysink1) == TRUE);
+  fail_unless (gst_pad_unlink (teesrc2, mysink2) == TRUE);
+
+  gst_object_unref (teesink);
+  gst_object_unref (teesrc1);
+  gst_object_unref (teesrc2);
+  gst_element_release_request_pad (tee, teesrc1);
+  gst_element_release_request_pad (tee, teesrc2);
+  gst_object_unref (tee);
+
+  gst_object_unref (mysink1);
+  gst_object_unref (mysink2);
+  gst_object_unref (mysrc);
+  gst_caps_unref (caps);
+
+  g_cond_clear (&rendezvous_cond);
+  g_mutex_clear (&rendezvous_lock);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_request_pads)
 {
   GstElement *tee;
@@ -955,7 +1064,8 @@ tee_suite (void)
   tcase_add_test (tc_chain, test_release_while_buffer_alloc);
   tcase_add_test (tc_chain, test_release_while_second_buffer_alloc);
   tcase_add_test (tc_chain, test_internal_links);
-  tcase_add_test (tc_chain, test_flow_aggregation);
+  tcase_add_loop_test (tc_chain, test_flow_aggregation, 0, 2);
+  tcase_add_test (tc_chain, test_parallel_push);
   tcase_add_test (tc_chain, test_request_pads);
   tcase_add_test (tc_chain, test_allow_not_linked);
   tcase_add_test (tc_chain, test_allocation_query_aggregation);
@@ -944,6 +944,51 @@ GST_START_TEST (test_new_memdup)
 
 GST_END_TEST;
 
+static guint64
+get_cache_counter (const gchar * cache, const gchar * counter)
+{
+  GstStructure *stats, *s;
+  guint64 val;
+
+  stats = gst_tracing_get_slice_cache_stats ();
+  fail_unless (gst_structure_get (stats, cache, GST_TYPE_STRUCTURE, &s, NULL));
+  fail_unless (gst_structure_get_uint64 (s, counter, &val));
+  gst_structure_free (s);
+  gst_structure_free (stats);
+
+  return val;
+}
+
+GST_START_TEST (test_slice_cache)
+{
+  const gchar *env = g_getenv ("G_SLICE");
+  guint64 hits, misses;
+  GstBuffer *buf;
+  gint i;
+
+  hits = get_cache_counter ("buffer", "hits");
+  misses = get_cache_counter ("buffer", "misses");
+
+  for (i = 0; i < 100; i++) {
+    buf = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+        (gpointer) ro_memory, sizeof (ro_memory), 0, sizeof (ro_memory), NULL,
+        NULL);
+    gst_buffer_unref (buf);
+  }
+
+  /* the cache is disabled when GLib is asked to use malloc for everything */
+  if (env && strstr (env, "always-malloc")) {
+    fail_unless_equals_uint64 (get_cache_counter ("buffer", "hits"), hits);
+  } else {
+    /* all but the first buffer and its memory are recycled */
+    fail_unless (get_cache_counter ("buffer", "hits") >= hits + 99);
+    fail_unless (get_cache_counter ("buffer", "misses") <= misses + 1);
+    fail_unless (get_cache_counter ("memory", "hits") >= 99);
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_buffer_suite (void)
 {
@@ -970,6 +1015,7 @@ gst_buffer_suite (void)
   tcase_add_test (tc_chain, test_writable_memory);
   tcase_add_test (tc_chain, test_wrapped_bytes);
   tcase_add_test (tc_chain, test_new_memdup);
+  tcase_add_test (tc_chain, test_slice_cache);
 
   return s;
 }
@@ -336,6 +336,164 @@ GST_START_TEST (test_no_deadlock_for_buffer_discard)
 
 GST_END_TEST;
 
+/* releases the buffer once the acquire in the main thread waits for it */
+static gpointer
+release_buf_when_waiting (gpointer p)
+{
+  GstBuffer *buf = GST_BUFFER_CAST (p);
+  GstBufferPool *pool = gst_object_ref (buf->pool);
+  guint64 waits = 0;
+
+  while (waits == 0) {
+    GstStructure *stats = gst_buffer_pool_get_stats (pool);
+
+    fail_unless (gst_structure_get_uint64 (stats, "waits", &waits));
+    gst_structure_free (stats);
+    if (waits == 0)
+      g_usleep (1000);
+  }
+  gst_buffer_unref (buf);
+  gst_object_unref (pool);
+
+  return NULL;
+}
+
+static void
+check_pool_stats (const GstStructure * stats, guint64 hits,
+    guint64 allocations, guint64 waits, guint hwm)
+{
+  guint64 val, wait_time;
+  guint uval;
+
+  fail_unless_equals_string (gst_structure_get_name (stats),
+      "buffer-pool-stats");
+  fail_unless (gst_structure_get_uint64 (stats, "hits", &val));
+  fail_unless_equals_uint64 (val, hits);
+  fail_unless (gst_structure_get_uint64 (stats, "allocations", &val));
+  fail_unless_equals_uint64 (val, allocations);
+  fail_unless (gst_structure_get_uint64 (stats, "waits", &val));
+  fail_unless_equals_uint64 (val, waits);
+  fail_unless (gst_structure_get_uint64 (stats, "wait-time", &wait_time));
+  if (waits)
+    fail_unless (wait_time > 0);
+  else
+    fail_unless_equals_uint64 (wait_time, 0);
+  fail_unless (gst_structure_get_uint (stats, "high-water-mark", &uval));
+  fail_unless_equals_int (uval, hwm);
+}
+
+GST_START_TEST (test_pool_stats)
+{
+  GstBufferPool *pool = create_pool (10, 1, 2);
+  GstBufferPoolAcquireParams params = { 0, };
+  GstBuffer *buf1, *buf2, *buf3;
+  GstStructure *stats;
+  GThread *thread;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  stats = gst_buffer_pool_get_stats (pool);
+  check_pool_stats (stats, 0, 1, 0, 0);
+  gst_structure_free (stats);
+
+  /* the preallocated buffer, then a new one */
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf1,
+          NULL) == GST_FLOW_OK);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf2,
+          NULL) == GST_FLOW_OK);
+
+  /* not a wait */
+  params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf3,
+          &params) == GST_FLOW_EOS);
+
+  stats = gst_buffer_pool_get_stats (pool);
+  check_pool_stats (stats, 1, 2, 0, 2);
+  gst_structure_free (stats);
+
+  /* blocks until the buffer is released */
+  thread = g_thread_new (NULL, release_buf_when_waiting, buf1);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf3,
+          NULL) == GST_FLOW_OK);
+  g_thread_join (thread);
+
+  /* only two buffers were ever handed out at the same time */
+  stats = gst_buffer_pool_get_stats (pool);
+  check_pool_stats (stats, 2, 2, 1, 2);
+  gst_structure_free (stats);
+
+  gst_buffer_unref (buf2);
+  gst_buffer_unref (buf3);
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+typedef GstTracer TestPoolTracer;
+typedef GstTracerClass TestPoolTracerClass;
+
+G_DEFINE_TYPE (TestPoolTracer, test_pool_tracer, GST_TYPE_TRACER);
+
+static GstBufferPool *traced_pool;
+static GstStructure *traced_stats;
+
+static void
+on_buffer_pool_stats (GObject * self, GstClockTime ts, GstBufferPool * pool,
+    const GstStructure * stats)
+{
+  traced_pool = pool;
+  if (traced_stats)
+    gst_structure_free (traced_stats);
+  traced_stats = gst_structure_copy (stats);
+}
+
+static void
+test_pool_tracer_class_init (TestPoolTracerClass * klass)
+{
+}
+
+static void
+test_pool_tracer_init (TestPoolTracer * self)
+{
+  gst_tracing_register_hook (GST_TRACER (self), "buffer-pool-stats",
+      G_CALLBACK (on_buffer_pool_stats));
+}
+
+GST_START_TEST (test_pool_stats_tracer_hook)
+{
+  GstBufferPool *pool = create_pool (10, 1, 2);
+  GstTracer *tracer;
+  GstBuffer *buf1, *buf2;
+
+  tracer = g_object_new (test_pool_tracer_get_type (), NULL);
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf1,
+          NULL) == GST_FLOW_OK);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf2,
+          NULL) == GST_FLOW_OK);
+  gst_buffer_unref (buf1);
+  gst_buffer_unref (buf2);
+  fail_unless (traced_stats == NULL);
+
+  /* the statistics are traced when the pool stops */
+  gst_buffer_pool_set_active (pool, FALSE);
+  fail_unless (traced_pool == pool);
+  fail_unless (traced_stats != NULL);
+  check_pool_stats (traced_stats, 1, 2, 0, 2);
+
+  gst_structure_free (traced_stats);
+  traced_stats = NULL;
+  traced_pool = NULL;
+  gst_object_unref (pool);
+  gst_object_unref (tracer);
+}
+
+GST_END_TEST;
+#endif
+
 static Suite *
 gst_buffer_pool_suite (void)
 {
@@ -355,6 +513,10 @@ gst_buffer_pool_suite (void)
   tcase_add_test (tc_chain, test_pool_config_validate);
   tcase_add_test (tc_chain, test_flushing_pool_returns_flushing);
   tcase_add_test (tc_chain, test_no_deadlock_for_buffer_discard);
+  tcase_add_test (tc_chain, test_pool_stats);
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+  tcase_add_test (tc_chain, test_pool_stats_tracer_hook);
+#endif
 
   return s;
 }
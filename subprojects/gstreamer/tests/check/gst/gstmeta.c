@@ -688,6 +688,164 @@ GST_START_TEST (test_meta_seqnum)
 
 GST_END_TEST;
 
+GST_START_TEST (test_meta_many)
+{
+  GstBuffer *buffer, *copy;
+  GstMetaTest *tests[6];
+  GstMetaFoo *foo;
+  GstMeta *m;
+  gpointer state;
+  guint i;
+
+  buffer = gst_buffer_new_and_alloc (4);
+  fail_unless (GST_META_TEST_GET (buffer) == NULL);
+  fail_unless (GST_META_FOO_GET (buffer) == NULL);
+
+  /* more metas than fit in the buffer itself */
+  for (i = 0; i < G_N_ELEMENTS (tests); i++) {
+    tests[i] = GST_META_TEST_ADD (buffer);
+    fail_unless (tests[i] != NULL);
+    tests[i]->pts = i;
+  }
+  fail_unless (GST_META_FOO_GET (buffer) == NULL);
+  foo = GST_META_FOO_ADD (buffer);
+  fail_unless (GST_META_FOO_GET (buffer) == foo);
+  fail_unless_equals_int (count_buffer_meta (buffer), 7);
+
+  /* lookup always returns the first one added */
+  for (i = 0; i < G_N_ELEMENTS (tests); i++) {
+    fail_unless (GST_META_TEST_GET (buffer) == tests[i]);
+    fail_unless (gst_buffer_remove_meta (buffer, (GstMeta *) tests[i]));
+  }
+  fail_unless (GST_META_TEST_GET (buffer) == NULL);
+  fail_unless (GST_META_FOO_GET (buffer) == foo);
+
+  /* re-add in freed storage, order is kept */
+  for (i = 0; i < G_N_ELEMENTS (tests); i++) {
+    tests[i] = GST_META_TEST_ADD (buffer);
+    tests[i]->pts = i;
+  }
+  state = NULL;
+  fail_unless (gst_buffer_iterate_meta (buffer, &state) == (GstMeta *) foo);
+  for (i = 0; i < G_N_ELEMENTS (tests); i++) {
+    m = gst_buffer_iterate_meta (buffer, &state);
+    fail_unless (m == (GstMeta *) tests[i]);
+  }
+  fail_unless (gst_buffer_iterate_meta (buffer, &state) == NULL);
+
+  /* remove from the middle */
+  gst_buffer_foreach_meta (buffer, foreach_meta_remove_one, tests[2]);
+  gst_buffer_foreach_meta (buffer, foreach_meta_remove_one, foo);
+  fail_unless (GST_META_FOO_GET (buffer) == NULL);
+  fail_unless_equals_int (gst_buffer_get_n_meta (buffer,
+          GST_META_TEST_API_TYPE), 5);
+
+  copy = gst_buffer_copy (buffer);
+  fail_unless (GST_META_FOO_GET (copy) == NULL);
+  state = NULL;
+  for (i = 0; i < G_N_ELEMENTS (tests); i++) {
+    if (i == 2)
+      continue;
+    m = gst_buffer_iterate_meta_filtered (copy, &state,
+        GST_META_TEST_API_TYPE);
+    fail_unless (m != NULL);
+    fail_unless_equals_uint64 (((GstMetaTest *) m)->pts, i);
+  }
+  fail_unless (gst_buffer_iterate_meta_filtered (copy, &state,
+          GST_META_TEST_API_TYPE) == NULL);
+
+  gst_buffer_unref (copy);
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
+/* a meta bigger than the inline storage of the buffer */
+typedef struct
+{
+  GstMeta meta;
+
+  guint8 data[1024];
+} GstMetaBig;
+
+static gboolean
+big_init_func (GstMeta * meta, gpointer params, GstBuffer * buffer)
+{
+  GstMetaBig *big = (GstMetaBig *) meta;
+
+  memset (big->data, 0, sizeof (big->data));
+  return TRUE;
+}
+
+static GType
+gst_meta_big_api_get_type (void)
+{
+  static GType type;
+  static const gchar *tags[] = { NULL };
+
+  if (g_once_init_enter (&type)) {
+    GType _type = gst_meta_api_type_register ("GstMetaBigAPI", tags);
+    g_once_init_leave (&type, _type);
+  }
+  return type;
+}
+
+static const GstMetaInfo *
+gst_meta_big_get_info (void)
+{
+  static const GstMetaInfo *meta_big_info = NULL;
+
+  if (g_once_init_enter ((GstMetaInfo **) & meta_big_info)) {
+    const GstMetaInfo *mi = gst_meta_register (gst_meta_big_api_get_type (),
+        "GstMetaBig", sizeof (GstMetaBig), big_init_func, NULL, NULL);
+    g_once_init_leave ((GstMetaInfo **) & meta_big_info, (GstMetaInfo *) mi);
+  }
+  return meta_big_info;
+}
+
+/* metas of any size can be mixed, the big ones don't fit in the inline
+ * storage and are allocated separately */
+GST_START_TEST (test_meta_big)
+{
+  GstBuffer *buffer;
+  GstMetaBig *big[3];
+  GstMetaTest *test[3];
+  guint i;
+
+  buffer = gst_buffer_new ();
+  for (i = 0; i < G_N_ELEMENTS (big); i++) {
+    big[i] = (GstMetaBig *) gst_buffer_add_meta (buffer,
+        gst_meta_big_get_info (), NULL);
+    fail_unless (big[i] != NULL);
+    memset (big[i]->data, i + 1, sizeof (big[i]->data));
+
+    test[i] = GST_META_TEST_ADD (buffer);
+    fail_unless (test[i] != NULL);
+    test[i]->pts = i;
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (big); i++) {
+    fail_unless_equals_int (big[i]->data[0], i + 1);
+    fail_unless_equals_int (big[i]->data[sizeof (big[i]->data) - 1], i + 1);
+    fail_unless_equals_uint64 (test[i]->pts, i);
+  }
+  fail_unless (gst_buffer_get_meta (buffer,
+          gst_meta_big_api_get_type ()) == (GstMeta *) big[0]);
+  fail_unless (GST_META_TEST_GET (buffer) == test[0]);
+
+  fail_unless (gst_buffer_remove_meta (buffer, (GstMeta *) big[0]));
+  fail_unless (gst_buffer_remove_meta (buffer, (GstMeta *) test[0]));
+  fail_unless (gst_buffer_get_meta (buffer,
+          gst_meta_big_api_get_type ()) == (GstMeta *) big[1]);
+  fail_unless (GST_META_TEST_GET (buffer) == test[1]);
+  fail_unless_equals_int (gst_buffer_get_n_meta (buffer,
+          gst_meta_big_api_get_type ()), 2);
+
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_meta_custom)
 {
   GstBuffer *buffer;
@@ -814,6 +972,8 @@ gst_buffermeta_suite (void)
   tcase_add_test (tc_chain, test_meta_foreach_remove_several);
   tcase_add_test (tc_chain, test_meta_iterate);
   tcase_add_test (tc_chain, test_meta_seqnum);
+  tcase_add_test (tc_chain, test_meta_many);
+  tcase_add_test (tc_chain, test_meta_big);
   tcase_add_test (tc_chain, test_meta_custom);
   tcase_add_test (tc_chain, test_meta_custom_transform);
 
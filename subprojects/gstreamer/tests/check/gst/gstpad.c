@@ -1495,6 +1495,184 @@ GST_START_TEST (test_pad_blocking_with_probe_type_idle)
 
 GST_END_TEST;
 
+static GMutex idle_chain_lock;
+static GCond idle_chain_cond;
+static gboolean idle_chain_entered;
+static gboolean idle_chain_release;
+static gint idle_deferred_calls;
+
+static GstFlowReturn
+idle_deferred_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  g_mutex_lock (&idle_chain_lock);
+  idle_chain_entered = TRUE;
+  g_cond_broadcast (&idle_chain_cond);
+  while (!idle_chain_release)
+    g_cond_wait (&idle_chain_cond, &idle_chain_lock);
+  g_mutex_unlock (&idle_chain_lock);
+
+  gst_buffer_unref (buf);
+  return GST_FLOW_OK;
+}
+
+static GstPadProbeReturn
+idle_deferred_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  g_atomic_int_inc (&idle_deferred_calls);
+
+  return GST_PAD_PROBE_REMOVE;
+}
+
+/* an idle probe added while a buffer is in the peer's chain function must
+ * be called by the pushing thread when gst_pad_push() returns */
+GST_START_TEST (test_pad_probe_idle_deferred)
+{
+  GstPad *srcpad, *sinkpad;
+  GThread *thread;
+  GstFlowReturn ret;
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  fail_unless (srcpad != NULL);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  fail_unless (sinkpad != NULL);
+
+  gst_pad_set_chain_function (sinkpad, idle_deferred_chain);
+
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_pad_set_active (srcpad, TRUE);
+
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_stream_start ("test")) == TRUE);
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_segment (&dummy_segment)) == TRUE);
+
+  idle_chain_entered = FALSE;
+  idle_chain_release = FALSE;
+  idle_deferred_calls = 0;
+
+  thread = g_thread_try_new ("gst-check", (GThreadFunc) push_buffer_async,
+      gst_object_ref (srcpad), NULL);
+
+  g_mutex_lock (&idle_chain_lock);
+  while (!idle_chain_entered)
+    g_cond_wait (&idle_chain_cond, &idle_chain_lock);
+  g_mutex_unlock (&idle_chain_lock);
+
+  /* the pad is in use, the probe is not called from here */
+  fail_unless (gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_IDLE,
+          idle_deferred_probe, NULL, NULL) != 0);
+  fail_unless_equals_int (g_atomic_int_get (&idle_deferred_calls), 0);
+
+  g_mutex_lock (&idle_chain_lock);
+  idle_chain_release = TRUE;
+  g_cond_broadcast (&idle_chain_cond);
+  g_mutex_unlock (&idle_chain_lock);
+
+  ret = GPOINTER_TO_INT (g_thread_join (thread));
+  fail_unless_equals_int (ret, GST_FLOW_OK);
+  fail_unless_equals_int (g_atomic_int_get (&idle_deferred_calls), 1);
+
+  /* the probe removed itself, the next push is not affected */
+  fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_new ()),
+      GST_FLOW_OK);
+  fail_unless_equals_int (g_atomic_int_get (&idle_deferred_calls), 1);
+
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+}
+
+GST_END_TEST;
+
+#define N_IDLE_PROBES 1000
+
+static gint idle_stress_calls[N_IDLE_PROBES];
+static gint idle_stress_running;
+static gboolean idle_stress_concurrent;
+static gint idle_stress_stop;
+
+static GstFlowReturn
+idle_stress_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  gst_buffer_unref (buf);
+  return GST_FLOW_OK;
+}
+
+static GstPadProbeReturn
+idle_stress_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  gint *calls = user_data;
+
+  if (g_atomic_int_add (&idle_stress_running, 1) != 0)
+    idle_stress_concurrent = TRUE;
+  g_atomic_int_inc (calls);
+  g_thread_yield ();
+  g_atomic_int_add (&idle_stress_running, -1);
+
+  return GST_PAD_PROBE_REMOVE;
+}
+
+static gpointer
+idle_stress_push (GstPad * pad)
+{
+  while (!g_atomic_int_get (&idle_stress_stop)) {
+    if (gst_pad_push (pad, gst_buffer_new ()) != GST_FLOW_OK)
+      return GINT_TO_POINTER (FALSE);
+  }
+
+  return GINT_TO_POINTER (TRUE);
+}
+
+/* idle probes added while another thread keeps pushing must each be called
+ * exactly once, either from gst_pad_add_probe() or by the pushing thread */
+GST_START_TEST (test_pad_probe_idle_while_pushing)
+{
+  GstPad *srcpad, *sinkpad;
+  GThread *thread;
+  gint i;
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, idle_stress_chain);
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_pad_set_active (srcpad, TRUE);
+
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_stream_start ("test")) == TRUE);
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_segment (&dummy_segment)) == TRUE);
+
+  memset (idle_stress_calls, 0, sizeof (idle_stress_calls));
+  idle_stress_running = 0;
+  idle_stress_concurrent = FALSE;
+  idle_stress_stop = 0;
+
+  thread = g_thread_new ("gst-check", (GThreadFunc) idle_stress_push, srcpad);
+
+  for (i = 0; i < N_IDLE_PROBES; i++)
+    gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_IDLE, idle_stress_probe,
+        &idle_stress_calls[i], NULL);
+
+  g_atomic_int_set (&idle_stress_stop, 1);
+  fail_unless (GPOINTER_TO_INT (g_thread_join (thread)));
+
+  /* calls the probes that are still pending, if any */
+  fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_new ()),
+      GST_FLOW_OK);
+
+  for (i = 0; i < N_IDLE_PROBES; i++)
+    fail_unless_equals_int (g_atomic_int_get (&idle_stress_calls[i]), 1);
+  fail_if (idle_stress_concurrent);
+
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+}
+
+GST_END_TEST;
+
 static gboolean pull_probe_called;
 static gboolean pull_probe_called_with_bad_type;
 static gboolean pull_probe_called_with_bad_data;
@@ -3408,6 +3586,8 @@ gst_pad_suite (void)
   tcase_add_test (tc_chain, test_pad_blocking_with_probe_type_block);
   tcase_add_test (tc_chain, test_pad_blocking_with_probe_type_blocking);
   tcase_add_test (tc_chain, test_pad_blocking_with_probe_type_idle);
+  tcase_add_test (tc_chain, test_pad_probe_idle_deferred);
+  tcase_add_test (tc_chain, test_pad_probe_idle_while_pushing);
   tcase_add_test (tc_chain, test_pad_probe_pull);
   tcase_add_test (tc_chain, test_pad_probe_pull_idle);
   tcase_add_test (tc_chain, test_pad_probe_pull_buffer);
@@ -22,6 +22,7 @@
 # include <config.h>
 #endif
 
+#include <glib/gstdio.h>
 #include <gst/check/gstcheck.h>
 #include <string.h>
 
@@ -203,6 +204,130 @@ GST_START_TEST (test_registry_update)
 
 GST_END_TEST;
 
+#define N_DETAILS_THREADS 8
+
+static GMutex details_mutex;
+static GCond details_cond;
+static gboolean details_go;
+
+/* reads the details of all factories, at the same time as the other threads */
+static gpointer
+read_details_thread (gpointer data)
+{
+  GList *factories = data, *l;
+
+  g_mutex_lock (&details_mutex);
+  while (!details_go)
+    g_cond_wait (&details_cond, &details_mutex);
+  g_mutex_unlock (&details_mutex);
+
+  for (l = factories; l; l = l->next) {
+    if (GST_IS_ELEMENT_FACTORY (l->data)) {
+      GstElementFactory *factory = l->data;
+      const GList *templates;
+
+      fail_unless (gst_element_factory_get_metadata (factory,
+              GST_ELEMENT_METADATA_LONGNAME) != NULL);
+      templates = gst_element_factory_get_static_pad_templates (factory);
+      fail_unless_equals_int (g_list_length ((GList *) templates),
+          gst_element_factory_get_num_pad_templates (factory));
+      gst_element_factory_get_uri_protocols (factory);
+    } else if (GST_IS_TYPE_FIND_FACTORY (l->data)) {
+      GstTypeFindFactory *factory = l->data;
+
+      GstCaps *caps;
+
+      gst_type_find_factory_get_extensions (factory);
+      caps = gst_type_find_factory_get_caps (factory);
+      if (caps)
+        fail_unless (GST_IS_CAPS (caps));
+    }
+  }
+
+  return NULL;
+}
+
+static void
+read_details_from_threads (void)
+{
+  GThread *threads[N_DETAILS_THREADS];
+  GList *factories;
+  guint i;
+
+  factories = gst_registry_get_feature_list (gst_registry_get (),
+      GST_TYPE_ELEMENT_FACTORY);
+  factories = g_list_concat (factories,
+      gst_registry_get_feature_list (gst_registry_get (),
+          GST_TYPE_TYPE_FIND_FACTORY));
+  fail_unless (factories != NULL);
+
+  details_go = FALSE;
+  for (i = 0; i < N_DETAILS_THREADS; i++)
+    threads[i] = g_thread_new ("details", read_details_thread, factories);
+
+  g_mutex_lock (&details_mutex);
+  details_go = TRUE;
+  g_cond_broadcast (&details_cond);
+  g_mutex_unlock (&details_mutex);
+
+  for (i = 0; i < N_DETAILS_THREADS; i++)
+    g_thread_join (threads[i]);
+
+  gst_plugin_feature_list_free (factories);
+}
+
+/* The details of factories read from the registry cache are only loaded on
+ * first use. This process has a registry that might have been scanned, so
+ * run the test in children with a registry of their own: the first one
+ * writes it, the second one reads it from the cache. */
+GST_START_TEST (test_registry_lazy_details)
+{
+#ifdef __linux__
+  gchar *exe, *dir, *registry, **envp;
+  gchar *argv[2] = { NULL, NULL };
+  guint i;
+
+  if (g_getenv ("GST_REGISTRY_TEST_CHILD")) {
+    read_details_from_threads ();
+    return;
+  }
+
+  exe = g_file_read_link ("/proc/self/exe", NULL);
+  fail_unless (exe != NULL);
+  dir = g_dir_make_tmp ("gst-registry-XXXXXX", NULL);
+  fail_unless (dir != NULL);
+  registry = g_build_filename (dir, "registry.bin", NULL);
+
+  envp = g_get_environ ();
+  envp = g_environ_setenv (envp, "GST_REGISTRY", registry, TRUE);
+  envp = g_environ_setenv (envp, "GST_REGISTRY_TEST_CHILD", "1", TRUE);
+  envp = g_environ_setenv (envp, "GST_CHECKS", "test_registry_lazy_details",
+      TRUE);
+  argv[0] = exe;
+
+  for (i = 0; i < 2; i++) {
+    GError *err = NULL;
+    gint status;
+
+    fail_unless (g_spawn_sync (NULL, argv, envp, G_SPAWN_DEFAULT, NULL, NULL,
+            NULL, NULL, &status, &err), "failed to run %s: %s", exe,
+        err ? err->message : "");
+    fail_unless (g_spawn_check_exit_status (status, NULL),
+        "run %u with the registry %s failed", i, registry);
+  }
+  fail_unless (g_file_test (registry, G_FILE_TEST_EXISTS));
+
+  g_unlink (registry);
+  g_rmdir (dir);
+  g_strfreev (envp);
+  g_free (registry);
+  g_free (dir);
+  g_free (exe);
+#endif
+}
+
+GST_END_TEST;
+
 static Suite *
 registry_suite (void)
 {
@@ -212,6 +337,7 @@ registry_suite (void)
   suite_add_tcase (s, tc_chain);
 
   tcase_add_test (tc_chain, test_registry_update);
+  tcase_add_test (tc_chain, test_registry_lazy_details);
 
   return s;
 }
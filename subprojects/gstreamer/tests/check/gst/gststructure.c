@@ -1018,6 +1018,94 @@ GST_START_TEST (test_flagset)
 
 GST_END_TEST;
 
+static gboolean
+remove_odd_func (GQuark field_id, GValue * value, gpointer user_data)
+{
+  return g_value_get_int (value) % 2 == 0;
+}
+
+/* enough fields for the structure to look them up through its index */
+GST_START_TEST (test_many_fields)
+{
+  GstStructure *s, *s2, *s3;
+  gchar name[16];
+  gint i, val;
+
+  s = gst_structure_new_empty ("test");
+  for (i = 0; i < 100; i++) {
+    g_snprintf (name, sizeof (name), "f%d", i);
+    gst_structure_set (s, name, G_TYPE_INT, i, NULL);
+  }
+  fail_unless_equals_int (gst_structure_n_fields (s), 100);
+
+  /* overwriting keeps the number and order of the fields */
+  gst_structure_set (s, "f50", G_TYPE_INT, 50, NULL);
+  fail_unless_equals_int (gst_structure_n_fields (s), 100);
+  for (i = 0; i < 100; i++) {
+    g_snprintf (name, sizeof (name), "f%d", i);
+    fail_unless_equals_string (gst_structure_nth_field_name (s, i), name);
+    fail_unless (gst_structure_get_int (s, name, &val));
+    fail_unless_equals_int (val, i);
+  }
+  fail_if (gst_structure_has_field (s, "f100"));
+
+  s2 = gst_structure_copy (s);
+  fail_unless (gst_structure_is_equal (s, s2));
+  fail_unless (gst_structure_is_subset (s, s2));
+
+  /* remove all odd fields, the others must still be found */
+  for (i = 1; i < 100; i += 2) {
+    g_snprintf (name, sizeof (name), "f%d", i);
+    gst_structure_remove_field (s, name);
+  }
+  fail_unless_equals_int (gst_structure_n_fields (s), 50);
+  for (i = 0; i < 100; i++) {
+    g_snprintf (name, sizeof (name), "f%d", i);
+    fail_unless (gst_structure_get_int (s, name, &val) == (i % 2 == 0));
+    if (i % 2 == 0)
+      fail_unless_equals_int (val, i);
+  }
+  fail_unless (gst_structure_is_subset (s2, s));
+  fail_if (gst_structure_is_subset (s, s2));
+
+  s3 = gst_structure_intersect (s, s2);
+  fail_unless (s3 != NULL);
+  fail_unless (gst_structure_is_equal (s3, s2));
+  gst_structure_free (s3);
+
+  gst_structure_set (s, "f0", G_TYPE_INT, 1, NULL);
+  fail_unless (gst_structure_intersect (s, s2) == NULL);
+
+  gst_structure_filter_and_map_in_place (s2, remove_odd_func, NULL);
+  fail_unless_equals_int (gst_structure_n_fields (s2), 50);
+  fail_unless (gst_structure_has_field (s2, "f98"));
+  fail_if (gst_structure_has_field (s2, "f99"));
+
+  /* shrink below the size where the index is used and grow again */
+  for (i = 0; i < 98; i += 2) {
+    g_snprintf (name, sizeof (name), "f%d", i);
+    gst_structure_remove_field (s2, name);
+  }
+  fail_unless_equals_int (gst_structure_n_fields (s2), 1);
+  for (i = 0; i < 40; i++) {
+    g_snprintf (name, sizeof (name), "g%d", i);
+    gst_structure_set (s2, name, G_TYPE_INT, i, NULL);
+  }
+  fail_unless (gst_structure_get_int (s2, "f98", &val));
+  fail_unless_equals_int (val, 98);
+  fail_unless (gst_structure_get_int (s2, "g39", &val));
+  fail_unless_equals_int (val, 39);
+
+  gst_structure_remove_all_fields (s2);
+  fail_unless_equals_int (gst_structure_n_fields (s2), 0);
+  fail_if (gst_structure_has_field (s2, "g0"));
+
+  gst_structure_free (s);
+  gst_structure_free (s2);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_structure_suite (void)
 {
@@ -1050,6 +1138,7 @@ gst_structure_suite (void)
   tcase_add_test (tc_chain, test_map_in_place);
   tcase_add_test (tc_chain, test_filter_and_map_in_place);
   tcase_add_test (tc_chain, test_flagset);
+  tcase_add_test (tc_chain, test_many_fields);
   return s;
 }
 
@@ -25,6 +25,8 @@
 
 #include <gst/check/gstcheck.h>
 #include <gst/gsttracerrecord.h>
+#include <glib/gstdio.h>
+#include <string.h>
 
 static GList *messages;         /* NULL */
 static gboolean save_messages;  /* FALSE */
@@ -153,6 +155,186 @@ GST_START_TEST (serialize_static_record)
 GST_END_TEST;
 
 
+/* layout of the binary trace file, see gsttracerrecord.c */
+#define BINARY_HEADER_SIZE        4096
+#define BINARY_SCHEMA_AREA_SIZE   (256 * 1024)
+#define BINARY_BLOCK_SIZE         (64 * 1024)
+#define BINARY_BLOCK_HEADER_SIZE  8
+#define BINARY_RECORD_HEADER_SIZE 32
+
+typedef struct
+{
+  gchar magic[8];
+  guint32 version;
+  guint32 byte_order;
+  guint32 header_size;
+  guint32 schema_area_size;
+  guint32 block_size;
+  guint32 n_blocks;
+  guint64 pid;
+  guint32 schema_used;
+  guint32 dropped;
+} BinaryHeader;
+
+#define BINARY_N_THREADS 4
+#define BINARY_N_RECORDS 50000
+
+typedef struct
+{
+  GstTracerRecord *tr;
+  guint thread;
+} BinaryWriter;
+
+static gpointer
+log_binary_records (gpointer data)
+{
+  BinaryWriter *writer = data;
+  guint64 i;
+
+  for (i = 0; i < BINARY_N_RECORDS; i++)
+    gst_tracer_record_log (writer->tr, writer->thread, i,
+        i * 31 + writer->thread);
+
+  return NULL;
+}
+
+/* logs from several threads into a ring of two blocks and checks that all
+ * records that can be decoded are intact */
+static void
+check_binary_ring_wrap (const gchar * location)
+{
+  GstTracerRecord *tr;
+  GThread *threads[BINARY_N_THREADS];
+  BinaryWriter writers[BINARY_N_THREADS];
+  BinaryHeader header;
+  guint64 seqs[2], last[BINARY_N_THREADS];
+  guint8 *data, *block;
+  gsize len;
+  guint i, j, n_records = 0;
+
+  /* *INDENT-OFF* */
+  tr = gst_tracer_record_new ("ring.class",
+      "thread", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT,
+          NULL),
+      "index", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          NULL),
+      "check", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          NULL),
+      NULL);
+  /* *INDENT-ON* */
+
+  for (i = 0; i < BINARY_N_THREADS; i++) {
+    writers[i].tr = tr;
+    writers[i].thread = i;
+    threads[i] = g_thread_new ("binary-writer", log_binary_records,
+        &writers[i]);
+  }
+  for (i = 0; i < BINARY_N_THREADS; i++)
+    g_thread_join (threads[i]);
+  gst_object_unref (tr);
+
+  fail_unless (g_file_get_contents (location, (gchar **) & data, &len, NULL));
+  fail_unless (len >= BINARY_HEADER_SIZE + BINARY_SCHEMA_AREA_SIZE +
+      2 * BINARY_BLOCK_SIZE);
+  memcpy (&header, data, sizeof (header));
+  fail_unless (memcmp (header.magic, "GSTTRBIN", 8) == 0);
+  fail_unless_equals_int (header.version, 2);
+  fail_unless_equals_int (header.n_blocks, 2);
+  fail_unless (header.dropped < BINARY_N_THREADS * BINARY_N_RECORDS);
+  GST_INFO ("%u records were dropped", header.dropped);
+
+  for (i = 0; i < 2; i++) {
+    gsize pos = BINARY_BLOCK_HEADER_SIZE;
+
+    for (j = 0; j < BINARY_N_THREADS; j++)
+      last[j] = G_MAXUINT64;
+
+    block = data + BINARY_HEADER_SIZE + BINARY_SCHEMA_AREA_SIZE +
+        i * BINARY_BLOCK_SIZE;
+    memcpy (&seqs[i], block, 8);
+    fail_unless (seqs[i] > 2, "the ring did not wrap");
+
+    while (pos + BINARY_RECORD_HEADER_SIZE <= BINARY_BLOCK_SIZE) {
+      guint32 size, thread;
+      guint64 seq, index, check;
+
+      memcpy (&size, block + pos, 4);
+      memcpy (&seq, block + pos + 8, 8);
+      /* the end of the block, or stale records from earlier rounds */
+      if (size == 0 || seq != seqs[i])
+        break;
+      fail_unless (size >= BINARY_RECORD_HEADER_SIZE + 20);
+      fail_unless (pos + size <= BINARY_BLOCK_SIZE);
+
+      memcpy (&thread, block + pos + BINARY_RECORD_HEADER_SIZE, 4);
+      memcpy (&index, block + pos + BINARY_RECORD_HEADER_SIZE + 4, 8);
+      memcpy (&check, block + pos + BINARY_RECORD_HEADER_SIZE + 12, 8);
+      fail_unless (thread < BINARY_N_THREADS);
+      fail_unless_equals_uint64 (check, index * 31 + thread);
+      /* records of a thread are in order within a block */
+      if (last[thread] != G_MAXUINT64)
+        fail_unless (index > last[thread]);
+      last[thread] = index;
+
+      n_records++;
+      pos += size;
+    }
+  }
+  fail_unless_equals_uint64 (MAX (seqs[0], seqs[1]) - MIN (seqs[0], seqs[1]),
+      1);
+  fail_unless (n_records > 0);
+
+  g_free (data);
+}
+
+GST_START_TEST (serialize_binary_ring_wrap)
+{
+#ifdef __linux__
+  gchar *exe, *dir, *location, **envp;
+  gchar *argv[2] = { NULL, NULL };
+  GError *err = NULL;
+  gint status;
+
+  /* the binary file is opened once per process, in a child */
+  if (g_getenv ("GST_TRACER_BINARY_FILE")) {
+    check_binary_ring_wrap (g_getenv ("GST_TRACER_BINARY_FILE"));
+    return;
+  }
+
+  exe = g_file_read_link ("/proc/self/exe", NULL);
+  fail_unless (exe != NULL);
+  dir = g_dir_make_tmp ("gst-tracer-XXXXXX", NULL);
+  fail_unless (dir != NULL);
+  location = g_build_filename (dir, "trace.bin", NULL);
+
+  envp = g_get_environ ();
+  envp = g_environ_setenv (envp, "GST_TRACER_BINARY_FILE", location, TRUE);
+  envp = g_environ_setenv (envp, "GST_TRACER_BINARY_SIZE", "131072", TRUE);
+  envp = g_environ_setenv (envp, "GST_CHECKS", "serialize_binary_ring_wrap",
+      TRUE);
+  argv[0] = exe;
+
+  fail_unless (g_spawn_sync (NULL, argv, envp, G_SPAWN_DEFAULT, NULL, NULL,
+          NULL, NULL, &status, &err), "failed to run %s: %s", exe,
+      err ? err->message : "");
+  fail_unless (g_spawn_check_exit_status (status, NULL),
+      "writing the binary trace file %s failed", location);
+
+  g_unlink (location);
+  g_rmdir (dir);
+  g_strfreev (envp);
+  g_free (location);
+  g_free (dir);
+  g_free (exe);
+#endif
+}
+
+GST_END_TEST;
+
+
 static Suite *
 gst_tracer_record_suite (void)
 {
@@ -163,6 +345,7 @@ gst_tracer_record_suite (void)
   tcase_add_checked_fixture (tc_chain, setup, cleanup);
   tcase_add_test (tc_chain, serialize_message_logging);
   tcase_add_test (tc_chain, serialize_static_record);
+  tcase_add_test (tc_chain, serialize_binary_ring_wrap);
 
   /* FIXME: add more tests, e.g. enums, pointer types and optional fields */
 
@@ -608,6 +608,42 @@ GST_START_TEST (test_scan)
 
 GST_END_TEST;
 
+/* the 00 00 01 scan works on blocks, check start codes at every position
+ * relative to the block boundaries and near the end of the data */
+GST_START_TEST (test_scan_start_code)
+{
+  GstByteReader reader;
+  guint8 data[100];
+  guint32 val;
+  guint pos, size;
+  gint found;
+
+  for (size = 4; size <= sizeof (data); size++) {
+    for (pos = 0; pos + 4 <= size; pos++) {
+      /* 01 bytes without 00 00 before them must be skipped */
+      memset (data, 0x01, sizeof (data));
+      data[pos] = 0x00;
+      data[pos + 1] = 0x00;
+      data[pos + 3] = 0xb3;
+      if (pos > 0)
+        data[pos - 1] = 0x00;
+
+      gst_byte_reader_init (&reader, data, size);
+      found = gst_byte_reader_masked_scan_uint32_peek (&reader, 0xffffff00,
+          0x00000100, 0, size, &val);
+      fail_unless_equals_int (found, pos);
+      fail_unless_equals_int (val, 0x000001b3);
+
+      /* no byte after the start code */
+      found = gst_byte_reader_masked_scan_uint32 (&reader, 0xffffff00,
+          0x00000100, 0, pos + 3);
+      fail_unless_equals_int (found, -1);
+    }
+  }
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_string_funcs)
 {
   GstByteReader reader, backup;
@@ -836,6 +872,7 @@ gst_byte_reader_suite (void)
   tcase_add_test (tc_chain, test_get_float_be);
   tcase_add_test (tc_chain, test_position_tracking);
   tcase_add_test (tc_chain, test_scan);
+  tcase_add_test (tc_chain, test_scan_start_code);
   tcase_add_test (tc_chain, test_string_funcs);
   tcase_add_test (tc_chain, test_dup_string);
   tcase_add_test (tc_chain, test_sub_reader);
@@ -941,6 +941,334 @@ GST_START_TEST (basetransform_invalid_fixatecaps_impl)
 
 GST_END_TEST;
 
+#define PARALLEL_DEPTH 4
+#define PARALLEL_BUFFERS 32
+
+static GMutex parallel_lock;
+static gint transform_ip_parallel_running;
+static gint transform_ip_parallel_max;
+
+static GstFlowReturn
+transform_ip_parallel (GstBaseTransform * trans, GstBuffer * buf)
+{
+  g_mutex_lock (&parallel_lock);
+  transform_ip_parallel_running++;
+  transform_ip_parallel_max =
+      MAX (transform_ip_parallel_max, transform_ip_parallel_running);
+  g_mutex_unlock (&parallel_lock);
+
+  /* later buffers of a group finish earlier */
+  g_usleep ((PARALLEL_DEPTH - GST_BUFFER_OFFSET (buf) % PARALLEL_DEPTH) *
+      2000);
+
+  g_mutex_lock (&parallel_lock);
+  transform_ip_parallel_running--;
+  g_mutex_unlock (&parallel_lock);
+
+  return GST_FLOW_OK;
+}
+
+/* stateless in place transform, buffers are transformed in parallel and
+ * must come out in order */
+GST_START_TEST (basetransform_chain_parallel)
+{
+  TestTransData *trans;
+  GstBuffer *buffer;
+  GstFlowReturn res;
+  guint i;
+
+  klass_transform_ip = transform_ip_parallel;
+  trans = gst_test_trans_new ();
+  gst_base_transform_set_stateless (GST_BASE_TRANSFORM (trans->trans), TRUE);
+  g_object_set (trans->trans, "parallel-depth", PARALLEL_DEPTH, NULL);
+
+  gst_test_trans_push_segment (trans);
+
+  transform_ip_parallel_running = 0;
+  transform_ip_parallel_max = 0;
+
+  for (i = 0; i < PARALLEL_BUFFERS; i++) {
+    buffer = gst_buffer_new_and_alloc (20);
+    GST_BUFFER_OFFSET (buffer) = i;
+    GST_BUFFER_PTS (buffer) = i * GST_MSECOND;
+    GST_BUFFER_DURATION (buffer) = GST_MSECOND;
+    if (i == PARALLEL_BUFFERS / 2)
+      GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DISCONT);
+
+    res = gst_test_trans_push (trans, buffer);
+    fail_unless (res == GST_FLOW_OK);
+  }
+
+  /* EOS is serialized and waits for all buffers in flight */
+  gst_pad_push_event (trans->srcpad, gst_event_new_eos ());
+
+  fail_unless (g_list_length (trans->buffers) == PARALLEL_BUFFERS);
+  g_mutex_lock (&parallel_lock);
+  fail_unless (transform_ip_parallel_max > 1);
+  fail_unless (transform_ip_parallel_max <= PARALLEL_DEPTH);
+  g_mutex_unlock (&parallel_lock);
+
+  for (i = 0; i < PARALLEL_BUFFERS; i++) {
+    buffer = gst_test_trans_pop (trans);
+    fail_unless (buffer != NULL);
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buffer), i);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), i * GST_MSECOND);
+    fail_unless (GST_BUFFER_IS_DISCONT (buffer) ==
+        (i == PARALLEL_BUFFERS / 2));
+    gst_buffer_unref (buffer);
+  }
+
+  gst_test_trans_free (trans);
+}
+
+GST_END_TEST;
+
+/* jobs wait for the gate to be opened, so that they are all still in flight
+ * until the test opens it */
+static GMutex gate_lock;
+static GCond gate_cond;
+static gboolean gate_open;
+static guint64 gate_error_offset;
+
+static void
+gate_set_open (gboolean open)
+{
+  g_mutex_lock (&gate_lock);
+  gate_open = open;
+  g_cond_broadcast (&gate_cond);
+  g_mutex_unlock (&gate_lock);
+}
+
+static GstFlowReturn
+transform_ip_gated (GstBaseTransform * trans, GstBuffer * buf)
+{
+  g_mutex_lock (&gate_lock);
+  while (!gate_open)
+    g_cond_wait (&gate_cond, &gate_lock);
+  g_mutex_unlock (&gate_lock);
+
+  if (GST_BUFFER_OFFSET (buf) == gate_error_offset)
+    return GST_FLOW_ERROR;
+
+  return GST_FLOW_OK;
+}
+
+static TestTransData *
+gst_test_trans_new_gated (void)
+{
+  TestTransData *trans;
+
+  klass_transform_ip = transform_ip_gated;
+  trans = gst_test_trans_new ();
+  gst_base_transform_set_stateless (GST_BASE_TRANSFORM (trans->trans), TRUE);
+  g_object_set (trans->trans, "parallel-depth", PARALLEL_DEPTH, NULL);
+  gst_test_trans_push_segment (trans);
+
+  gate_open = FALSE;
+  gate_error_offset = GST_BUFFER_OFFSET_NONE;
+
+  return trans;
+}
+
+static void
+push_offset_buffers (TestTransData * trans, guint64 first, guint n)
+{
+  GstBuffer *buffer;
+  guint i;
+
+  for (i = 0; i < n; i++) {
+    buffer = gst_buffer_new_and_alloc (20);
+    GST_BUFFER_OFFSET (buffer) = first + i;
+    fail_unless_equals_int (gst_test_trans_push (trans, buffer), GST_FLOW_OK);
+  }
+}
+
+static guint
+get_parallel_jobs (TestTransData * trans)
+{
+  guint jobs;
+
+  g_object_get (trans->trans, "parallel-jobs", &jobs, NULL);
+
+  return jobs;
+}
+
+/* FLUSH_STOP throws away the buffers that are still being transformed */
+GST_START_TEST (basetransform_parallel_flush)
+{
+  TestTransData *trans;
+  GstBuffer *buffer;
+
+  trans = gst_test_trans_new_gated ();
+
+  push_offset_buffers (trans, 0, PARALLEL_DEPTH - 1);
+  fail_unless_equals_int (get_parallel_jobs (trans), PARALLEL_DEPTH - 1);
+
+  gst_pad_push_event (trans->srcpad, gst_event_new_flush_start ());
+  gate_set_open (TRUE);
+  gst_pad_push_event (trans->srcpad, gst_event_new_flush_stop (TRUE));
+
+  fail_unless_equals_int (get_parallel_jobs (trans), 0);
+  fail_unless (trans->buffers == NULL);
+
+  gst_test_trans_push_segment (trans);
+  push_offset_buffers (trans, 100, 1);
+  gst_pad_push_event (trans->srcpad, gst_event_new_eos ());
+
+  fail_unless_equals_int (g_list_length (trans->buffers), 1);
+  buffer = gst_test_trans_pop (trans);
+  fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buffer), 100);
+  gst_buffer_unref (buffer);
+
+  gst_test_trans_free (trans);
+}
+
+GST_END_TEST;
+
+static gint drain_query_buffers;
+
+static gboolean
+drain_query_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  TestTransData *data = gst_pad_get_element_private (pad);
+
+  if (GST_QUERY_TYPE (query) == GST_QUERY_DRAIN) {
+    drain_query_buffers = g_list_length (data->buffers);
+    return TRUE;
+  }
+
+  return gst_pad_query_default (pad, parent, query);
+}
+
+/* serialized queries wait for the buffers in flight to be pushed */
+GST_START_TEST (basetransform_parallel_query)
+{
+  TestTransData *trans;
+  GstQuery *query;
+
+  trans = gst_test_trans_new_gated ();
+  gst_pad_set_query_function (trans->sinkpad, drain_query_sink_query);
+  drain_query_buffers = -1;
+
+  push_offset_buffers (trans, 0, PARALLEL_DEPTH - 1);
+  gate_set_open (TRUE);
+
+  query = gst_query_new_drain ();
+  fail_unless (gst_pad_peer_query (trans->srcpad, query));
+  gst_query_unref (query);
+
+  fail_unless_equals_int (drain_query_buffers, PARALLEL_DEPTH - 1);
+  fail_unless_equals_int (get_parallel_jobs (trans), 0);
+
+  gst_test_trans_free (trans);
+}
+
+GST_END_TEST;
+
+static GstFlowReturn
+transform_parallel_ct (GstBaseTransform * trans, GstBuffer * in,
+    GstBuffer * out)
+{
+  /* later buffers of a group finish earlier */
+  g_usleep ((PARALLEL_DEPTH - GST_BUFFER_OFFSET (in) % PARALLEL_DEPTH) * 2000);
+
+  gst_buffer_memset (out, 0, GST_BUFFER_OFFSET (in),
+      gst_buffer_get_size (out));
+  GST_BUFFER_OFFSET (out) = GST_BUFFER_OFFSET (in);
+
+  return GST_FLOW_OK;
+}
+
+/* copy transform, output buffers are allocated before the transform runs in
+ * parallel and are pushed in order */
+GST_START_TEST (basetransform_parallel_ct)
+{
+  TestTransData *trans;
+  GstBuffer *buffer;
+  GstCaps *incaps;
+  guint i, jobs, max_jobs = 0;
+  guint8 data;
+
+  sink_template = &sink_template_ct1;
+  klass_transform = transform_parallel_ct;
+  klass_transform_caps = transform_caps_ct1;
+  klass_transform_size = transform_size_ct1;
+
+  trans = gst_test_trans_new ();
+  gst_base_transform_set_stateless (GST_BASE_TRANSFORM (trans->trans), TRUE);
+  g_object_set (trans->trans, "parallel-depth", PARALLEL_DEPTH, NULL);
+
+  incaps = gst_caps_new_empty_simple ("baz/x-foo");
+  gst_test_trans_setcaps (trans, incaps);
+  gst_test_trans_push_segment (trans);
+
+  for (i = 0; i < PARALLEL_BUFFERS; i++) {
+    buffer = gst_buffer_new_and_alloc (20);
+    GST_BUFFER_OFFSET (buffer) = i;
+    fail_unless_equals_int (gst_test_trans_push (trans, buffer), GST_FLOW_OK);
+
+    jobs = get_parallel_jobs (trans);
+    fail_unless (jobs <= PARALLEL_DEPTH);
+    max_jobs = MAX (max_jobs, jobs);
+  }
+  fail_unless (max_jobs > 1);
+
+  gst_pad_push_event (trans->srcpad, gst_event_new_eos ());
+  fail_unless_equals_int (g_list_length (trans->buffers), PARALLEL_BUFFERS);
+
+  for (i = 0; i < PARALLEL_BUFFERS; i++) {
+    buffer = gst_test_trans_pop (trans);
+    fail_unless_equals_int (gst_buffer_get_size (buffer), 40);
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buffer), i);
+    gst_buffer_extract (buffer, 39, &data, 1);
+    fail_unless_equals_int (data, i);
+    gst_buffer_unref (buffer);
+  }
+
+  gst_caps_unref (incaps);
+  gst_test_trans_free (trans);
+}
+
+GST_END_TEST;
+
+/* a transform error is returned by a later chain call or, when no buffer
+ * comes anymore, posted by the EOS that drains the jobs */
+GST_START_TEST (basetransform_parallel_error)
+{
+  TestTransData *trans;
+  GstMessage *msg;
+  GError *err;
+  GstBus *bus;
+
+  trans = gst_test_trans_new_gated ();
+  bus = gst_bus_new ();
+  gst_element_set_bus (trans->trans, bus);
+
+  gate_error_offset = 1;
+  push_offset_buffers (trans, 0, PARALLEL_DEPTH - 1);
+  gate_set_open (TRUE);
+
+  fail_if (gst_pad_push_event (trans->srcpad, gst_event_new_eos ()));
+
+  /* only the buffer before the failed one is pushed */
+  fail_unless_equals_int (g_list_length (trans->buffers), 1);
+  fail_unless_equals_int (get_parallel_jobs (trans), 0);
+
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_ERROR);
+  fail_unless (msg != NULL);
+  gst_message_parse_error (msg, &err, NULL);
+  fail_unless (g_error_matches (err, GST_STREAM_ERROR,
+          GST_STREAM_ERROR_FAILED));
+  g_error_free (err);
+  gst_message_unref (msg);
+
+  gst_element_set_bus (trans->trans, NULL);
+  gst_object_unref (bus);
+  gst_test_trans_free (trans);
+}
+
+GST_END_TEST;
+
 static void
 transform1_setup (void)
 {
@@ -981,6 +1309,12 @@ gst_basetransform_suite (void)
   tcase_add_test (tc, basetransform_chain_ct1);
   tcase_add_test (tc, basetransform_chain_ct2);
   tcase_add_test (tc, basetransform_chain_ct3);
+  /* parallel */
+  tcase_add_test (tc, basetransform_chain_parallel);
+  tcase_add_test (tc, basetransform_parallel_flush);
+  tcase_add_test (tc, basetransform_parallel_query);
+  tcase_add_test (tc, basetransform_parallel_ct);
+  tcase_add_test (tc, basetransform_parallel_error);
 
   tcase_add_test (tc, basetransform_invalid_fixatecaps_impl);
 